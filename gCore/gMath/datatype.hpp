@@ -779,7 +779,7 @@ protected:
 // this typeinfo system unless you know PRECISELY what you are doing.
 // Mixing macros and templates is spooky stuff.
 template< typename T >
-G_TYPE( mat2_t<T>, 4 * type<T>().n_c(), type<T>().component_size(), type<T>().component_to_GL(), type<T>().mapping() );
+G_TYPE( mat2_t<T>, 4 * type<T>().n_components(), type<T>().component_size(), type<T>().component_to_GL(), type<T>().mapping() );
 
 template< typename T >
 class mat3_t : public raw_mappable {
@@ -881,7 +881,7 @@ protected:
 // this typeinfo system unless you know PRECISELY what you are doing.
 // Mixing macros and templates is spooky stuff.
 template< typename T >
-G_TYPE( mat3_t<T>, 9 * type<T>().n_c(), type<T>().component_size(), type<T>().component_to_GL(), type<T>().mapping() );
+G_TYPE( mat3_t<T>, 9 * type<T>().n_components(), type<T>().component_size(), type<T>().component_to_GL(), type<T>().mapping() );
 
 template< typename T >
 class mat4_t : public raw_mappable {
@@ -990,7 +990,7 @@ protected:
 // this typeinfo system unless you know PRECISELY what you are doing.
 // Mixing macros and templates is spooky stuff.
 template< typename T >
-G_TYPE( mat4_t<T>, 16 * type<T>().n_c(), type<T>().component_size(), type<T>().component_to_GL(), type<T>().mapping() );
+G_TYPE( mat4_t<T>, 16 * type<T>().n_components(), type<T>().component_size(), type<T>().component_to_GL(), type<T>().mapping() );
 
 template< typename T >
 class mat2x3_t : public raw_mappable {
@@ -1074,7 +1074,7 @@ protected:
 // this typeinfo system unless you know PRECISELY what you are doing.
 // Mixing macros and templates is spooky stuff.
 template< typename T >
-G_TYPE( mat2x3_t<T>, 6 * type<T>().n_c(), type<T>().component_size(), type<T>().component_to_GL(), type<T>().mapping() );
+G_TYPE( mat2x3_t<T>, 6 * type<T>().n_components(), type<T>().component_size(), type<T>().component_to_GL(), type<T>().mapping() );
 
 template< typename T >
 class mat3x2_t : public raw_mappable {
@@ -1157,7 +1157,7 @@ protected:
 // this typeinfo system unless you know PRECISELY what you are doing.
 // Mixing macros and templates is spooky stuff.
 template< typename T >
-G_TYPE( mat3x2_t<T>, 6 * type<T>().n_c(), type<T>().component_size(), type<T>().component_to_GL(), type<T>().mapping() );
+G_TYPE( mat3x2_t<T>, 6 * type<T>().n_components(), type<T>().component_size(), type<T>().component_to_GL(), type<T>().mapping() );
 
 template< typename T >
 class mat2x4_t : public raw_mappable {
@@ -1244,7 +1244,7 @@ protected:
 // this typeinfo system unless you know PRECISELY what you are doing.
 // Mixing macros and templates is spooky stuff.
 template< typename T >
-G_TYPE( mat2x4_t<T>, 8 * type<T>().n_c(), type<T>().component_size(), type<T>().component_to_GL(), type<T>().mapping() );
+G_TYPE( mat2x4_t<T>, 8 * type<T>().n_components(), type<T>().component_size(), type<T>().component_to_GL(), type<T>().mapping() );
 
 template< typename T >
 class mat4x2_t : public raw_mappable {
@@ -1329,7 +1329,7 @@ protected:
 // this typeinfo system unless you know PRECISELY what you are doing.
 // Mixing macros and templates is spooky stuff.
 template< typename T >
-G_TYPE( mat4x2_t<T>, 8 * type<T>().n_c(), type<T>().component_size(), type<T>().component_to_GL(), type<T>().mapping() );
+G_TYPE( mat4x2_t<T>, 8 * type<T>().n_components(), type<T>().component_size(), type<T>().component_to_GL(), type<T>().mapping() );
 
 template< typename T >
 class mat3x4_t : public raw_mappable {
@@ -1418,7 +1418,7 @@ protected:
 // this typeinfo system unless you know PRECISELY what you are doing.
 // Mixing macros and templates is spooky stuff.
 template< typename T >
-G_TYPE( mat3x4_t<T>, 12 * type<T>().n_c(), type<T>().component_size(), type<T>().component_to_GL(), type<T>().mapping() );
+G_TYPE( mat3x4_t<T>, 12 * type<T>().n_components(), type<T>().component_size(), type<T>().component_to_GL(), type<T>().mapping() );
 
 template< typename T >
 class mat4x3_t : public raw_mappable {
@@ -1505,7 +1505,7 @@ protected:
 // this typeinfo system unless you know PRECISELY what you are doing.
 // Mixing macros and templates is spooky stuff.
 template< typename T >
-G_TYPE( mat4x3_t<T>, 12 * type<T>().n_c(), type<T>().component_size(), type<T>().component_to_GL(), type<T>().mapping() );
+G_TYPE( mat4x3_t<T>, 12 * type<T>().n_components(), type<T>().component_size(), type<T>().component_to_GL(), type<T>().mapping() );
 
 typedef     mat_t<float>            mat;
 typedef     mat2_t<float>           mat2;
@@ -1,4 +1,5 @@
 #include "./buffer.hpp"
+#include "./gl_state.hpp"
 
 namespace gfx {
     /**
@@ -44,6 +45,7 @@ namespace gfx {
     buffer::~buffer()
     {
         // Don't need to know about buffers!
+        gl_state::forget_buffer( buff_ID );
         gl::DeleteBuffers( 1, &buff_ID );
         attrib_vector::iterator i;
         for( i = attributes->begin(); i != attributes->end(); ++i )
@@ -143,7 +145,7 @@ namespace gfx {
      */
     void    buffer::upload_data()
     {
-        gl::BindBuffer( intended_target, buff_ID );
+        gl_state::current().bind_buffer( intended_target, buff_ID );
         // TODO Add logic to use gl::BufferSubData() if the number of blocks
         // and the specification hasn't changed
         gl::BufferData( intended_target, n_blocks * stride, data, usage );
@@ -135,6 +135,10 @@ namespace gfx {
         virtual void                upload_data();
         virtual void                align() = 0;
         friend std::ostream&        operator <<( std::ostream& out, buffer const& rhs );
+        friend                      class texture_atlas;
+        friend                      class command_list;
+        friend                      class bounds;
+        friend                      class occlusion_buffer;
     protected:
         unsigned char*              data;
         GLsizeiptr                  n_blocks;
@@ -278,8 +282,13 @@ namespace gfx {
      */
     inline  buffer::settings&     buffer::settings::for_transform_feedback()
     { intended_target = gl::TRANSFORM_FEEDBACK_BUFFER; return *this; }
-    //inline  buffer::settings&     buffer::settings::for_uniform()
-    //{ intended_target = gl::UNIFORM_BUFFER; return *this; }
+    /**
+     * \brief Set the \ref gfx::buffer "buffer" to use the uniform
+     * buffer target.
+     * \return This settings object
+     */
+    inline  buffer::settings&     buffer::settings::for_uniform()
+    { intended_target = gl::UNIFORM_BUFFER; return *this; }
     /**
      * \brief Query the \ref gfx::buffer "buffer" for its size.
      * \return The number of blocks in the buffer
@@ -0,0 +1,703 @@
+#include "bvh.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <thread>
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+namespace gfx {
+
+    namespace {
+        unsigned int const  no_child = ~0u;
+        size_t const        bins = 16;
+        /* Below this many items a subtree is not worth a thread. */
+        size_t const        parallel_items = 4096;
+
+        /* Half the surface area of a box, which is all SAH compares. */
+        inline float    half_area( float const* low, float const* high )
+        {
+            float const dx = high[0] - low[0];
+            float const dy = high[1] - low[1];
+            float const dz = high[2] - low[2];
+            return dx * dy + dy * dz + dz * dx;
+        }
+
+        /* Entry and exit of a ray through a box, with the inverse direction. */
+        inline bool     slab( float const* low, float const* high,
+                              float const* origin, float const* inverse,
+                              float& entry )
+        {
+            float near = 0.0f;
+            float far = FLT_MAX;
+            for ( size_t a = 0; a < 3; ++a ) {
+                float t0 = ( low[a] - origin[a] ) * inverse[a];
+                float t1 = ( high[a] - origin[a] ) * inverse[a];
+                if ( t0 > t1 ) { std::swap( t0, t1 ); }
+                near = t0 > near ? t0 : near;
+                far = t1 < far ? t1 : far;
+            }
+            entry = near;
+            return near <= far;
+        }
+    }
+
+    size_t const bvh::no_item;
+
+    /**
+     * \brief Construct a new, empty bvh.
+     * \param set The settings for the bvh
+     */
+    bvh::bvh( settings const& set ) : threads_v ( set.threads_v ),
+                                      leaf_size_v ( set.leaf_size_v ) {}
+    /**
+     * \brief Build the tree over a set of bounds, replacing whatever was
+     * there.
+     *
+     * Items are named by their index in the vector. Empty bounds are
+     * left out of the tree and never found until the next build.
+     * \param volumes The bounds of the items
+     */
+    void    bvh::build( std::vector<bounds> const& volumes )
+    {
+        items = volumes;
+        tree.clear();
+        order.clear();
+        slots.assign( items.size(), no_item );
+        boxes.resize( items.size() );
+        centroids.resize( items.size() * 3 );
+        for ( size_t n = 0; n < items.size(); ++n ) {
+            if ( items[n].empty() ) { continue; }
+            vec3 const low = items[n].low();
+            vec3 const high = items[n].high();
+            for ( size_t a = 0; a < 3; ++a ) {
+                boxes[n].low[a] = low[a];
+                boxes[n].high[a] = high[a];
+                centroids[n * 3 + a] = ( low[a] + high[a] ) * 0.5f;
+            }
+            order.push_back( n );
+        }
+        if ( order.size() >= size_t( no_child ) ) {
+            throw std::invalid_argument( "Too many items to build a bvh over." );
+        }
+
+        if ( not order.empty() ) {
+            build_node( 0, order.size(), 0, tree );
+        }
+
+        // From here on boxes are kept in leaf order
+        std::vector<box> sorted ( order.size() );
+        for ( size_t s = 0; s < order.size(); ++s ) {
+            sorted[s] = boxes[order[s]];
+            slots[order[s]] = s;
+        }
+        boxes.swap( sorted );
+        centroids.clear();
+    }
+    /**
+     * \brief Change the bounds of an item.
+     *
+     * The tree only takes the change into account after the next
+     * \ref refit() "refit()" or \ref build() "build()". Items that were
+     * empty at the last build stay out of the tree.
+     * \param n The item
+     * \param volume Its new bounds
+     */
+    void    bvh::bound( size_t const n, bounds const& volume )
+    {
+        if ( n >= items.size() ) {
+            throw std::invalid_argument( "Index given to bvh is out of range." );
+        }
+        items[n] = volume;
+        if ( slots[n] == no_item ) { return; }
+
+        box& found = boxes[slots[n]];
+        if ( volume.empty() ) {
+            for ( size_t a = 0; a < 3; ++a ) {
+                found.low[a] = FLT_MAX;
+                found.high[a] = -FLT_MAX;
+            }
+            return;
+        }
+        vec3 const low = volume.low();
+        vec3 const high = volume.high();
+        for ( size_t a = 0; a < 3; ++a ) {
+            found.low[a] = low[a];
+            found.high[a] = high[a];
+        }
+    }
+    /**
+     * \brief Bring the boxes of the tree up to date with the bounds of
+     * its items.
+     *
+     * Children always come after their parents, so one pass from the
+     * back of the tree reaches every child before its parent.
+     */
+    void    bvh::refit()
+    {
+        for ( size_t n = tree.size(); n-- > 0; ) {
+            node& parent = tree[n];
+            for ( size_t k = 0; k < 4; ++k ) {
+                if ( parent.first[k] == no_child ) { continue; }
+                float low[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+                float high[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+                if ( parent.count[k] > 0 ) {
+                    size_t const end = parent.first[k] + parent.count[k];
+                    for ( size_t s = parent.first[k]; s < end; ++s ) {
+                        for ( size_t a = 0; a < 3; ++a ) {
+                            low[a] = std::min( low[a], boxes[s].low[a] );
+                            high[a] = std::max( high[a], boxes[s].high[a] );
+                        }
+                    }
+                } else {
+                    node const& child = tree[parent.first[k]];
+                    for ( size_t j = 0; j < 4; ++j ) {
+                        for ( size_t a = 0; a < 3; ++a ) {
+                            low[a] = std::min( low[a], child.low[a][j] );
+                            high[a] = std::max( high[a], child.high[a][j] );
+                        }
+                    }
+                }
+                for ( size_t a = 0; a < 3; ++a ) {
+                    parent.low[a][k] = low[a];
+                    parent.high[a][k] = high[a];
+                }
+            }
+        }
+    }
+    /**
+     * \brief Find the items whose bounds might be inside a frustum.
+     *
+     * The result is the same as testing every item with
+     * \ref gfx::frustum::intersects() "frustum::intersects()", though
+     * not in the same order. Whole subtrees found to be inside every
+     * plane are taken without testing their items.
+     * \param view The frustum
+     * \param found Cleared, then given the items
+     */
+    void    bvh::visible( frustum const& view,
+                          std::vector<size_t>& found ) const
+    {
+        found.clear();
+        if ( tree.empty() ) { return; }
+
+        float planes[6][4];
+        for ( size_t p = 0; p < 6; ++p ) {
+            float const* plane = view.plane( frustum::side( p ) );
+            for ( size_t a = 0; a < 4; ++a ) { planes[p][a] = plane[a]; }
+        }
+        std::vector<unsigned int> stack ( 1, 0u );
+        while ( not stack.empty() ) {
+            node const& next = tree[stack.back()];
+            stack.pop_back();
+
+            int touched = 0xF;
+            int inside = 0xF;
+#ifdef __SSE__
+            __m128 const zero = _mm_setzero_ps();
+            for ( size_t p = 0; p < 6; ++p ) {
+                // The corner farthest along the normal, and the nearest
+                __m128 far = _mm_set1_ps( planes[p][3] );
+                __m128 near = far;
+                for ( size_t a = 0; a < 3; ++a ) {
+                    __m128 const normal = _mm_set1_ps( planes[p][a] );
+                    __m128 const low = _mm_loadu_ps( next.low[a] );
+                    __m128 const high = _mm_loadu_ps( next.high[a] );
+                    bool const ahead = planes[p][a] > 0.0f;
+                    far = _mm_add_ps( far, _mm_mul_ps( normal, ahead ? high : low ) );
+                    near = _mm_add_ps( near, _mm_mul_ps( normal, ahead ? low : high ) );
+                }
+                touched &= _mm_movemask_ps( _mm_cmpge_ps( far, zero ) );
+                inside &= _mm_movemask_ps( _mm_cmpge_ps( near, zero ) );
+            }
+#else
+            for ( size_t k = 0; k < 4; ++k ) {
+                for ( size_t p = 0; p < 6; ++p ) {
+                    float far = planes[p][3];
+                    float near = planes[p][3];
+                    for ( size_t a = 0; a < 3; ++a ) {
+                        bool const ahead = planes[p][a] > 0.0f;
+                        far += planes[p][a] * ( ahead ? next.high[a][k] : next.low[a][k] );
+                        near += planes[p][a] * ( ahead ? next.low[a][k] : next.high[a][k] );
+                    }
+                    if ( far < 0.0f ) { touched &= ~( 1 << k ); }
+                    if ( near < 0.0f ) { inside &= ~( 1 << k ); }
+                }
+            }
+#endif
+            for ( size_t k = 0; k < 4; ++k ) {
+                if ( not ( touched & ( 1 << k ) ) or next.first[k] == no_child ) {
+                    continue;
+                }
+                if ( next.count[k] == 0 ) {
+                    if ( inside & ( 1 << k ) ) {
+                        gather( next.first[k], found );
+                    } else {
+                        stack.push_back( next.first[k] );
+                    }
+                    continue;
+                }
+                size_t const end = next.first[k] + next.count[k];
+                for ( size_t s = next.first[k]; s < end; ++s ) {
+                    if ( inside & ( 1 << k ) or view.intersects( items[order[s]] ) ) {
+                        found.push_back( order[s] );
+                    }
+                }
+            }
+        }
+    }
+    /**
+     * \brief Find the items whose boxes touch a sphere.
+     * \param center The center of the sphere
+     * \param radius The radius of the sphere
+     * \param found Cleared, then given the items
+     */
+    void    bvh::touching( vec3 const& center,
+                           float const radius,
+                           std::vector<size_t>& found ) const
+    {
+        found.clear();
+        if ( tree.empty() ) { return; }
+
+        float const c[3] = { center[0], center[1], center[2] };
+        float const reach = radius * radius;
+        std::vector<unsigned int> stack ( 1, 0u );
+        while ( not stack.empty() ) {
+            node const& next = tree[stack.back()];
+            stack.pop_back();
+
+            int touched = 0;
+#ifdef __SSE__
+            __m128 const zero = _mm_setzero_ps();
+            __m128 distance = zero;
+            for ( size_t a = 0; a < 3; ++a ) {
+                __m128 const point = _mm_set1_ps( c[a] );
+                // How far the point is outside the box along this axis
+                __m128 const out = _mm_max_ps( _mm_max_ps( _mm_sub_ps( _mm_loadu_ps( next.low[a] ), point ),
+                                                           _mm_sub_ps( point, _mm_loadu_ps( next.high[a] ) ) ),
+                                               zero );
+                distance = _mm_add_ps( distance, _mm_mul_ps( out, out ) );
+            }
+            touched = _mm_movemask_ps( _mm_cmple_ps( distance, _mm_set1_ps( reach ) ) );
+#else
+            for ( size_t k = 0; k < 4; ++k ) {
+                float distance = 0.0f;
+                for ( size_t a = 0; a < 3; ++a ) {
+                    float const out = std::max( std::max( next.low[a][k] - c[a],
+                                                          c[a] - next.high[a][k] ),
+                                                0.0f );
+                    distance += out * out;
+                }
+                if ( distance <= reach ) { touched |= 1 << k; }
+            }
+#endif
+            for ( size_t k = 0; k < 4; ++k ) {
+                if ( not ( touched & ( 1 << k ) ) or next.first[k] == no_child ) {
+                    continue;
+                }
+                if ( next.count[k] == 0 ) {
+                    stack.push_back( next.first[k] );
+                    continue;
+                }
+                size_t const end = next.first[k] + next.count[k];
+                for ( size_t s = next.first[k]; s < end; ++s ) {
+                    float distance = 0.0f;
+                    for ( size_t a = 0; a < 3; ++a ) {
+                        float const out = std::max( std::max( boxes[s].low[a] - c[a],
+                                                              c[a] - boxes[s].high[a] ),
+                                                    0.0f );
+                        distance += out * out;
+                    }
+                    if ( distance <= reach ) { found.push_back( order[s] ); }
+                }
+            }
+        }
+    }
+    /**
+     * \brief Find the items whose boxes overlap a box.
+     * \param low The corner of the box with the smallest coordinates
+     * \param high The corner of the box with the largest coordinates
+     * \param found Cleared, then given the items
+     */
+    void    bvh::overlapping( vec3 const& low,
+                              vec3 const& high,
+                              std::vector<size_t>& found ) const
+    {
+        found.clear();
+        if ( tree.empty() ) { return; }
+
+        float const l[3] = { low[0], low[1], low[2] };
+        float const h[3] = { high[0], high[1], high[2] };
+        std::vector<unsigned int> stack ( 1, 0u );
+        while ( not stack.empty() ) {
+            node const& next = tree[stack.back()];
+            stack.pop_back();
+
+            int touched = 0xF;
+#ifdef __SSE__
+            for ( size_t a = 0; a < 3; ++a ) {
+                touched &= _mm_movemask_ps( _mm_and_ps( _mm_cmple_ps( _mm_loadu_ps( next.low[a] ),
+                                                                      _mm_set1_ps( h[a] ) ),
+                                                        _mm_cmpge_ps( _mm_loadu_ps( next.high[a] ),
+                                                                      _mm_set1_ps( l[a] ) ) ) );
+            }
+#else
+            for ( size_t k = 0; k < 4; ++k ) {
+                for ( size_t a = 0; a < 3; ++a ) {
+                    if ( next.low[a][k] > h[a] or next.high[a][k] < l[a] ) {
+                        touched &= ~( 1 << k );
+                    }
+                }
+            }
+#endif
+            for ( size_t k = 0; k < 4; ++k ) {
+                if ( not ( touched & ( 1 << k ) ) or next.first[k] == no_child ) {
+                    continue;
+                }
+                if ( next.count[k] == 0 ) {
+                    stack.push_back( next.first[k] );
+                    continue;
+                }
+                size_t const end = next.first[k] + next.count[k];
+                for ( size_t s = next.first[k]; s < end; ++s ) {
+                    bool hit = true;
+                    for ( size_t a = 0; a < 3; ++a ) {
+                        hit = hit and boxes[s].low[a] <= h[a] and boxes[s].high[a] >= l[a];
+                    }
+                    if ( hit ) { found.push_back( order[s] ); }
+                }
+            }
+        }
+    }
+    /**
+     * \brief Find the items whose boxes a ray passes through.
+     * \param origin Where the ray starts
+     * \param direction Which way the ray goes; it need not be of unit
+     * length
+     * \param found Cleared, then given the items
+     */
+    void    bvh::crossing( vec3 const& origin,
+                           vec3 const& direction,
+                           std::vector<size_t>& found ) const
+    {
+        found.clear();
+        if ( tree.empty() ) { return; }
+
+        float const o[3] = { origin[0], origin[1], origin[2] };
+        float const inverse[3] = { 1.0f / direction[0],
+                                   1.0f / direction[1],
+                                   1.0f / direction[2] };
+        std::vector<unsigned int> stack ( 1, 0u );
+        while ( not stack.empty() ) {
+            node const& next = tree[stack.back()];
+            stack.pop_back();
+
+            for ( size_t k = 0; k < 4; ++k ) {
+                if ( next.first[k] == no_child ) { continue; }
+                float const low[3] = { next.low[0][k], next.low[1][k], next.low[2][k] };
+                float const high[3] = { next.high[0][k], next.high[1][k], next.high[2][k] };
+                float entry;
+                if ( not slab( low, high, o, inverse, entry ) ) { continue; }
+                if ( next.count[k] == 0 ) {
+                    stack.push_back( next.first[k] );
+                    continue;
+                }
+                size_t const end = next.first[k] + next.count[k];
+                for ( size_t s = next.first[k]; s < end; ++s ) {
+                    if ( slab( boxes[s].low, boxes[s].high, o, inverse, entry ) ) {
+                        found.push_back( order[s] );
+                    }
+                }
+            }
+        }
+    }
+    /**
+     * \brief Find the item whose box a ray enters first, for picking.
+     *
+     * Children are visited nearest first and anything farther than the
+     * best so far is skipped. An origin inside a box enters it at zero.
+     * \param origin Where the ray starts
+     * \param direction Which way the ray goes
+     * \param distance If not null, given how far along the ray the box
+     * was entered, in lengths of direction
+     * \return The item, or no_item if the ray misses everything
+     */
+    size_t  bvh::nearest( vec3 const& origin,
+                          vec3 const& direction,
+                          float* distance ) const
+    {
+        size_t best = no_item;
+        float best_t = FLT_MAX;
+        if ( tree.empty() ) { return best; }
+
+        float const o[3] = { origin[0], origin[1], origin[2] };
+        float const inverse[3] = { 1.0f / direction[0],
+                                   1.0f / direction[1],
+                                   1.0f / direction[2] };
+        std::vector< std::pair<float, unsigned int> > stack ( 1, std::make_pair( 0.0f, 0u ) );
+        while ( not stack.empty() ) {
+            std::pair<float, unsigned int> const top = stack.back();
+            stack.pop_back();
+            if ( top.first > best_t ) { continue; }
+            node const& next = tree[top.second];
+
+            std::pair<float, unsigned int> inner[4];
+            size_t inners = 0;
+            for ( size_t k = 0; k < 4; ++k ) {
+                if ( next.first[k] == no_child ) { continue; }
+                float const low[3] = { next.low[0][k], next.low[1][k], next.low[2][k] };
+                float const high[3] = { next.high[0][k], next.high[1][k], next.high[2][k] };
+                float entry;
+                if ( not slab( low, high, o, inverse, entry ) or entry > best_t ) {
+                    continue;
+                }
+                if ( next.count[k] == 0 ) {
+                    // Kept sorted as they come; there are at most four
+                    size_t i = inners++;
+                    for ( ; i > 0 and entry < inner[i - 1].first; --i ) {
+                        inner[i] = inner[i - 1];
+                    }
+                    inner[i] = std::make_pair( entry, next.first[k] );
+                    continue;
+                }
+                size_t const end = next.first[k] + next.count[k];
+                for ( size_t s = next.first[k]; s < end; ++s ) {
+                    if ( slab( boxes[s].low, boxes[s].high, o, inverse, entry )
+                         and ( entry < best_t or ( entry == best_t and order[s] < best ) ) ) {
+                        best_t = entry;
+                        best = order[s];
+                    }
+                }
+            }
+            // Farthest pushed first so the nearest comes off the stack next
+            for ( size_t i = inners; i-- > 0; ) {
+                stack.push_back( inner[i] );
+            }
+        }
+        if ( distance != 0 and best != no_item ) { *distance = best_t; }
+        return best;
+    }
+    /*
+     * Sorts order[begin, end) about the best split found by binning
+     * centroids along the axis they spread furthest on, and returns where
+     * the second half starts. Centroids all in one spot are split down
+     * the middle.
+     */
+    size_t  bvh::split( size_t const begin, size_t const end )
+    {
+        float low[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+        float high[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+        for ( size_t s = begin; s < end; ++s ) {
+            float const* c = &centroids[order[s] * 3];
+            for ( size_t a = 0; a < 3; ++a ) {
+                low[a] = std::min( low[a], c[a] );
+                high[a] = std::max( high[a], c[a] );
+            }
+        }
+        size_t axis = 0;
+        for ( size_t a = 1; a < 3; ++a ) {
+            if ( high[a] - low[a] > high[axis] - low[axis] ) { axis = a; }
+        }
+        float const spread = high[axis] - low[axis];
+        if ( spread <= 0.0f ) {
+            return begin + ( end - begin ) / 2;
+        }
+
+        float const scale = float( bins ) / spread;
+        float const start = low[axis];
+        std::vector<float> const& centers = centroids;
+        struct binner {
+            std::vector<float> const&   centers;
+            float                       start;
+            float                       scale;
+            size_t                      axis;
+            size_t  operator()( size_t const item ) const
+            {
+                size_t const b = size_t( ( centers[item * 3 + axis] - start ) * scale );
+                return b < bins ? b : bins - 1;
+            }
+        } const bin_of = { centers, start, scale, axis };
+
+        size_t counts[bins] = { 0 };
+        box bin_boxes[bins];
+        for ( size_t b = 0; b < bins; ++b ) {
+            for ( size_t a = 0; a < 3; ++a ) {
+                bin_boxes[b].low[a] = FLT_MAX;
+                bin_boxes[b].high[a] = -FLT_MAX;
+            }
+        }
+        for ( size_t s = begin; s < end; ++s ) {
+            size_t const b = bin_of( order[s] );
+            ++counts[b];
+            for ( size_t a = 0; a < 3; ++a ) {
+                bin_boxes[b].low[a] = std::min( bin_boxes[b].low[a], boxes[order[s]].low[a] );
+                bin_boxes[b].high[a] = std::max( bin_boxes[b].high[a], boxes[order[s]].high[a] );
+            }
+        }
+
+        // Cost of everything left of each split, then sweep from the right
+        float left_costs[bins];
+        box grown = bin_boxes[0];
+        size_t count = 0;
+        for ( size_t b = 0; b + 1 < bins; ++b ) {
+            count += counts[b];
+            for ( size_t a = 0; a < 3; ++a ) {
+                grown.low[a] = std::min( grown.low[a], bin_boxes[b].low[a] );
+                grown.high[a] = std::max( grown.high[a], bin_boxes[b].high[a] );
+            }
+            left_costs[b] = count == 0 ? 0.0f : float( count ) * half_area( grown.low, grown.high );
+        }
+        size_t best = 0;
+        float best_cost = FLT_MAX;
+        grown = bin_boxes[bins - 1];
+        count = 0;
+        size_t left_count = end - begin;
+        for ( size_t b = bins - 1; b > 0; --b ) {
+            count += counts[b];
+            left_count -= counts[b];
+            for ( size_t a = 0; a < 3; ++a ) {
+                grown.low[a] = std::min( grown.low[a], bin_boxes[b].low[a] );
+                grown.high[a] = std::max( grown.high[a], bin_boxes[b].high[a] );
+            }
+            if ( count == 0 or left_count == 0 ) { continue; }
+            float const cost = left_costs[b - 1]
+                               + float( count ) * half_area( grown.low, grown.high );
+            if ( cost < best_cost ) {
+                best_cost = cost;
+                best = b;
+            }
+        }
+
+        if ( best == 0 ) {
+            return begin + ( end - begin ) / 2;
+        }
+        size_t const* middle = std::partition( &order[0] + begin, &order[0] + end,
+                                               [&bin_of, best]( size_t const item ) {
+                                                   return bin_of( item ) < best;
+                                               } );
+        return size_t( middle - &order[0] );
+    }
+    /*
+     * Makes a node for order[begin, end) in out and returns its index.
+     * The range is split in two, and each half in two again if it is too
+     * big for a leaf, giving up to four children. Near the top of the
+     * tree the inner children are built on threads of their own into
+     * separate arrays, which are then appended with their node indices
+     * moved along.
+     */
+    size_t  bvh::build_node( size_t const begin,
+                             size_t const end,
+                             size_t const depth,
+                             std::vector<node>& out )
+    {
+        size_t const index = out.size();
+        node fresh;
+        for ( size_t k = 0; k < 4; ++k ) {
+            for ( size_t a = 0; a < 3; ++a ) {
+                fresh.low[a][k] = FLT_MAX;
+                fresh.high[a][k] = -FLT_MAX;
+            }
+            fresh.first[k] = no_child;
+            fresh.count[k] = 0;
+        }
+        out.push_back( fresh );
+
+        size_t starts[5] = { begin, end };
+        size_t children = 1;
+        if ( end - begin > leaf_size_v ) {
+            size_t const middle = split( begin, end );
+            size_t const halves[3] = { begin, middle, end };
+            children = 0;
+            for ( size_t h = 0; h < 2; ++h ) {
+                starts[children++] = halves[h];
+                if ( halves[h + 1] - halves[h] > leaf_size_v ) {
+                    starts[children++] = split( halves[h], halves[h + 1] );
+                }
+            }
+            starts[children] = end;
+        }
+
+        // Spread subtrees over threads until there is one per thread
+        size_t fan_out = 1;
+        for ( size_t d = 0; d <= depth; ++d ) { fan_out *= 4; }
+        bool const parallel = threads_v > 1 and fan_out / 4 < threads_v
+                              and end - begin >= parallel_items;
+        std::vector< std::vector<node> > subtrees ( parallel ? children : 0 );
+        std::vector<std::thread> workers;
+
+        for ( size_t k = 0; k < children; ++k ) {
+            size_t const first = starts[k];
+            size_t const last = starts[k + 1];
+            box const around = range_box( first, last );
+            for ( size_t a = 0; a < 3; ++a ) {
+                out[index].low[a][k] = around.low[a];
+                out[index].high[a][k] = around.high[a];
+            }
+            if ( last - first <= leaf_size_v ) {
+                out[index].first[k] = (unsigned int) first;
+                out[index].count[k] = (unsigned int)( last - first );
+            } else if ( parallel ) {
+                workers.push_back( std::thread( [this, first, last, depth, &subtrees, k]() {
+                    build_node( first, last, depth + 1, subtrees[k] );
+                } ) );
+            } else {
+                size_t const child = build_node( first, last, depth + 1, out );
+                out[index].first[k] = (unsigned int) child;
+            }
+        }
+        for ( size_t w = 0; w < workers.size(); ++w ) {
+            workers[w].join();
+        }
+        for ( size_t k = 0; k < subtrees.size(); ++k ) {
+            if ( subtrees[k].empty() ) { continue; }
+            unsigned int const offset = (unsigned int) out.size();
+            out[index].first[k] = offset;
+            for ( size_t n = 0; n < subtrees[k].size(); ++n ) {
+                node moved = subtrees[k][n];
+                for ( size_t j = 0; j < 4; ++j ) {
+                    if ( moved.count[j] == 0 and moved.first[j] != no_child ) {
+                        moved.first[j] += offset;
+                    }
+                }
+                out.push_back( moved );
+            }
+        }
+        return index;
+    }
+    /* The box around order[begin, end), while building. */
+    bvh::box    bvh::range_box( size_t const begin, size_t const end ) const
+    {
+        box around;
+        for ( size_t a = 0; a < 3; ++a ) {
+            around.low[a] = FLT_MAX;
+            around.high[a] = -FLT_MAX;
+        }
+        for ( size_t s = begin; s < end; ++s ) {
+            box const& next = boxes[order[s]];
+            for ( size_t a = 0; a < 3; ++a ) {
+                around.low[a] = std::min( around.low[a], next.low[a] );
+                around.high[a] = std::max( around.high[a], next.high[a] );
+            }
+        }
+        return around;
+    }
+    /* Every item under node n that is not empty, without testing them. */
+    void    bvh::gather( size_t const n, std::vector<size_t>& found ) const
+    {
+        node const& next = tree[n];
+        for ( size_t k = 0; k < 4; ++k ) {
+            if ( next.first[k] == no_child ) { continue; }
+            if ( next.count[k] == 0 ) {
+                gather( next.first[k], found );
+                continue;
+            }
+            size_t const end = next.first[k] + next.count[k];
+            for ( size_t s = next.first[k]; s < end; ++s ) {
+                if ( not items[order[s]].empty() ) { found.push_back( order[s] ); }
+            }
+        }
+    }
+
+}
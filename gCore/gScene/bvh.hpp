@@ -0,0 +1,153 @@
+#ifndef BVH_HPP
+#define BVH_HPP
+
+#include <stdexcept>
+#include <vector>
+
+#include "../gMath/datatype.hpp"
+#include "culling.hpp"
+
+namespace gfx {
+    /**
+     * \class gfx::bvh bvh.hpp "gCore/gScene/bvh.hpp"
+     * \brief A bounding volume hierarchy over a set of
+     * \ref gfx::bounds "bounds", for finding the ones in a frustum, near
+     * a point, inside a box or along a ray without looking at them all.
+     *
+     * The tree is built with the surface area heuristic, picking splits
+     * that keep the area of child boxes small. Every node has up to four
+     * children whose boxes are stored component by component, so one
+     * SSE test covers the whole node. The bounds in each leaf sit next
+     * to each other in memory.
+     *
+     * For geometry that moves, \ref bound() "bound()" changes the bounds
+     * of an item and \ref refit() "refit()" grows and shrinks the boxes
+     * of the tree to match without changing its shape. That is much
+     * cheaper than building again, but the tree gets slower to search
+     * the further things move from where they were at the last
+     * \ref build() "build()".
+     */
+    class bvh {
+    public:
+        static size_t const no_item = ~size_t( 0 );
+
+        /**
+         * \class gfx::bvh::settings
+         * \brief Used to configure a \ref gfx::bvh "bvh".
+         */
+        class settings {
+        public:
+                            settings();
+            settings&       threads( size_t const count );
+            settings&       leaf_size( size_t const count );
+        private:
+            friend          class bvh;
+            size_t          threads_v;
+            size_t          leaf_size_v;
+        };
+
+                            bvh( settings const& set = settings() );
+        void                build( std::vector<bounds> const& volumes );
+        void                bound( size_t const n, bounds const& volume );
+        void                refit();
+        size_t              size() const;
+        size_t              nodes() const;
+        void                visible( frustum const& view,
+                                     std::vector<size_t>& found ) const;
+        void                touching( vec3 const& center,
+                                      float const radius,
+                                      std::vector<size_t>& found ) const;
+        void                overlapping( vec3 const& low,
+                                         vec3 const& high,
+                                         std::vector<size_t>& found ) const;
+        void                crossing( vec3 const& origin,
+                                      vec3 const& direction,
+                                      std::vector<size_t>& found ) const;
+        size_t              nearest( vec3 const& origin,
+                                     vec3 const& direction,
+                                     float* distance = 0 ) const;
+    private:
+        /*
+         * Four children, their boxes one component at a time. A child
+         * with a count is a leaf holding that many slots from first; one
+         * without is the node at first. Unused children have boxes
+         * inside out, so nothing ever reaches them.
+         */
+        struct node {
+            float           low[3][4];
+            float           high[3][4];
+            unsigned int    first[4];
+            unsigned int    count[4];
+        };
+        /* A box kept as its low and then its high corner. */
+        struct box {
+            float           low[3];
+            float           high[3];
+        };
+
+        size_t              split( size_t const begin, size_t const end );
+        size_t              build_node( size_t const begin,
+                                        size_t const end,
+                                        size_t const depth,
+                                        std::vector<node>& out );
+        box                 range_box( size_t const begin, size_t const end ) const;
+        void                gather( size_t const n,
+                                    std::vector<size_t>& found ) const;
+
+        std::vector<node>   tree;
+        std::vector<bounds> items;
+        /* Indexed by slot, in leaf order. */
+        std::vector<size_t> order;
+        std::vector<box>    boxes;
+        /* Indexed by item; no_item for items left out of the tree. */
+        std::vector<size_t> slots;
+        /* Only used while building. */
+        std::vector<float>  centroids;
+        size_t              threads_v;
+        size_t              leaf_size_v;
+    };
+    /**
+     * \brief Construct a new bvh settings object with default settings.
+     *
+     * By default the tree is built on the calling thread alone and a
+     * leaf holds up to four items.
+     */
+    inline bvh::settings::settings() : threads_v ( 1 ),
+                                       leaf_size_v ( 4 ) {}
+    /**
+     * \brief Set how many threads \ref build() "build()" may use.
+     *
+     * The calling thread is one of them. The top of the tree is split on
+     * one thread, and then its subtrees are built side by side.
+     * \param count The number of threads; zero is taken as one
+     * \return This settings object
+     */
+    inline bvh::settings&   bvh::settings::threads( size_t const count )
+    {
+        threads_v = count == 0 ? 1 : count;
+        return *this;
+    }
+    /**
+     * \brief Set how many items a leaf may hold.
+     * \param count The largest leaf; zero is taken as one
+     * \return This settings object
+     */
+    inline bvh::settings&   bvh::settings::leaf_size( size_t const count )
+    {
+        leaf_size_v = count == 0 ? 1 : count;
+        return *this;
+    }
+    /**
+     * \brief Return the number of items given to the last
+     * \ref build() "build()".
+     */
+    inline size_t   bvh::size() const
+    { return items.size(); }
+    /**
+     * \brief Return the number of nodes in the tree.
+     */
+    inline size_t   bvh::nodes() const
+    { return tree.size(); }
+}
+
+#endif
@@ -0,0 +1,146 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "../gMath/datatype.hpp"
+#include "bvh.hpp"
+#include "culling.hpp"
+
+using namespace gfx;
+
+/*
+ * Builds a bvh over a field of small bounds on one thread and then on
+ * several, and times frustum, sphere and ray queries against a culler
+ * and a plain scan over every bound. The sphere queries are small, like
+ * finding the objects a point light reaches; the rays are picking rays
+ * across the whole field.
+ *
+ * Usage: bvh_benchmark [bounds] [queries] [threads]
+ */
+namespace {
+    typedef std::chrono::high_resolution_clock  bench_clock;
+
+    double  since( bench_clock::time_point const start )
+    {
+        return std::chrono::duration<double, std::milli>( bench_clock::now() - start ).count();
+    }
+}
+
+int main( int argc, char** argv )
+{
+    size_t count = ( argc > 1 ) ? std::strtoul( argv[1], 0, 10 ) : 100000;
+    size_t queries = ( argc > 2 ) ? std::strtoul( argv[2], 0, 10 ) : 100;
+    size_t threads = ( argc > 3 ) ? std::strtoul( argv[3], 0, 10 ) : 4;
+    if ( queries == 0 ) { queries = 1; }
+
+    std::vector<bounds> all;
+    all.reserve( count );
+    std::srand( 7 );
+    for ( size_t n = 0; n < count; ++n ) {
+        vec3 center ( float( std::rand() % 4000 ) * 0.05f - 100.0f,
+                      float( std::rand() % 400 ) * 0.05f - 10.0f,
+                      float( std::rand() % 4000 ) * 0.05f - 100.0f );
+        all.push_back( bounds( center, 0.5f + float( std::rand() % 10 ) * 0.1f ) );
+    }
+
+    bvh serial;
+    bench_clock::time_point start = bench_clock::now();
+    serial.build( all );
+    double const serial_ms = since( start );
+    bvh threaded ( bvh::settings().threads( threads ) );
+    start = bench_clock::now();
+    threaded.build( all );
+    double const threaded_ms = since( start );
+
+    culler field;
+    for ( size_t n = 0; n < count; ++n ) { field.add( all[n] ); }
+    mat4 const projection = mat4::perspective( d_angle::in_degs( 60.0 ),
+                                               1.33, 0.1, 150.0 );
+    std::vector<frustum> views;
+    std::vector<vec3> points;
+    for ( size_t q = 0; q < queries; ++q ) {
+        views.push_back( frustum( projection
+                                  * mat4::rotation( vec3( 0.0f, 1.0f, 0.0f ),
+                                                    d_angle::in_degs( double( q ) * 3.6 ) ) ) );
+        points.push_back( vec3( float( std::rand() % 200 ) - 100.0f, 0.0f,
+                                float( std::rand() % 200 ) - 100.0f ) );
+    }
+
+    std::vector<size_t> found;
+    size_t seen = 0;
+    start = bench_clock::now();
+    for ( size_t q = 0; q < queries; ++q ) {
+        serial.visible( views[q], found );
+        seen += found.size();
+    }
+    double const tree_view_ms = since( start );
+    start = bench_clock::now();
+    for ( size_t q = 0; q < queries; ++q ) {
+        seen += field.cull( views[q] ).size();
+    }
+    double const scan_view_ms = since( start );
+
+    start = bench_clock::now();
+    for ( size_t q = 0; q < queries; ++q ) {
+        serial.touching( points[q], 5.0f, found );
+        seen += found.size();
+    }
+    double const tree_sphere_ms = since( start );
+    start = bench_clock::now();
+    for ( size_t q = 0; q < queries; ++q ) {
+        for ( size_t n = 0; n < count; ++n ) {
+            vec3 const& c = all[n].center();
+            float const dx = c[0] - points[q][0];
+            float const dy = c[1] - points[q][1];
+            float const dz = c[2] - points[q][2];
+            float const reach = 5.0f + all[n].radius();
+            seen += dx * dx + dy * dy + dz * dz <= reach * reach ? 1 : 0;
+        }
+    }
+    double const scan_sphere_ms = since( start );
+
+    size_t hits = 0;
+    start = bench_clock::now();
+    for ( size_t q = 0; q < queries; ++q ) {
+        vec3 const origin ( -150.0f, 0.0f, points[q][2] );
+        hits += serial.nearest( origin, vec3( 1.0f, 0.0f, 0.001f ) ) != bvh::no_item ? 1 : 0;
+    }
+    double const tree_ray_ms = since( start );
+    start = bench_clock::now();
+    for ( size_t q = 0; q < queries; ++q ) {
+        vec3 const origin ( -150.0f, 0.0f, points[q][2] );
+        float const inverse[3] = { 1.0f, 1.0e30f, 1000.0f };
+        float best = 1.0e30f;
+        for ( size_t n = 0; n < count; ++n ) {
+            vec3 const low = all[n].low();
+            vec3 const high = all[n].high();
+            float near = 0.0f;
+            float far = best;
+            for ( size_t a = 0; a < 3; ++a ) {
+                float t0 = ( low[a] - origin[a] ) * inverse[a];
+                float t1 = ( high[a] - origin[a] ) * inverse[a];
+                if ( t0 > t1 ) { float const t = t0; t0 = t1; t1 = t; }
+                near = t0 > near ? t0 : near;
+                far = t1 < far ? t1 : far;
+            }
+            best = near <= far ? near : best;
+        }
+        seen += best < 1.0e30f ? 1 : 0;
+    }
+    double const scan_ray_ms = since( start );
+
+    std::cout << count << " bounds, " << queries << " queries\n"
+              << "build, 1 thread:             " << serial_ms << " ms, "
+              << serial.nodes() << " nodes\n"
+              << "build, " << threads << " thread(s):          " << threaded_ms << " ms\n"
+              << "frustum, bvh:                " << tree_view_ms / queries << " ms/query\n"
+              << "frustum, culler over all:    " << scan_view_ms / queries << " ms/query\n"
+              << "sphere, bvh:                 " << tree_sphere_ms / queries << " ms/query\n"
+              << "sphere, scan over all:       " << scan_sphere_ms / queries << " ms/query\n"
+              << "nearest along a ray, bvh:    " << tree_ray_ms / queries << " ms/query, "
+              << hits << " hits\n"
+              << "nearest along a ray, scan:   " << scan_ray_ms / queries << " ms/query\n"
+              << "(" << seen << ")\n";
+    return 0;
+}
@@ -0,0 +1,181 @@
+#include <algorithm>
+#include <cfloat>
+#include <cstdlib>
+#include <vector>
+
+#include "../../UnitTest++_src/UnitTest++.h"
+
+#include "../gMath/datatype.hpp"
+#include "bvh.hpp"
+#include "culling.hpp"
+
+using namespace gfx;
+
+namespace {
+    /* A scattering of boxes and spheres, with a few empty ones. */
+    std::vector<bounds> scatter( size_t const count, unsigned int const seed )
+    {
+        std::srand( seed );
+        std::vector<bounds> all;
+        for ( size_t n = 0; n < count; ++n ) {
+            vec3 center ( float( std::rand() % 2000 ) * 0.05f - 50.0f,
+                          float( std::rand() % 400 ) * 0.05f - 10.0f,
+                          float( std::rand() % 2000 ) * 0.05f - 50.0f );
+            if ( n % 97 == 5 ) {
+                all.push_back( bounds() );
+            } else if ( n % 2 == 0 ) {
+                all.push_back( bounds( center, 0.2f + float( std::rand() % 10 ) * 0.1f ) );
+            } else {
+                all.push_back( bounds( center - vec3( 0.5f ),
+                                       center + vec3( float( std::rand() % 10 ) * 0.2f ) ) );
+            }
+        }
+        return all;
+    }
+
+    bool    box_touches( bounds const& item, vec3 const& center, float const radius )
+    {
+        if ( item.empty() ) { return false; }
+        float distance = 0.0f;
+        for ( size_t a = 0; a < 3; ++a ) {
+            float const out = std::max( std::max( item.low()[a] - center[a],
+                                                  center[a] - item.high()[a] ),
+                                        0.0f );
+            distance += out * out;
+        }
+        return distance <= radius * radius;
+    }
+
+    /* Where a ray enters a box, or a negative number if it misses. */
+    float   box_entry( bounds const& item, vec3 const& origin, vec3 const& direction )
+    {
+        if ( item.empty() ) { return -1.0f; }
+        float near = 0.0f;
+        float far = FLT_MAX;
+        for ( size_t a = 0; a < 3; ++a ) {
+            float t0 = ( item.low()[a] - origin[a] ) / direction[a];
+            float t1 = ( item.high()[a] - origin[a] ) / direction[a];
+            if ( t0 > t1 ) { std::swap( t0, t1 ); }
+            near = std::max( near, t0 );
+            far = std::min( far, t1 );
+        }
+        return near <= far ? near : -1.0f;
+    }
+
+    std::vector<size_t>     sorted( std::vector<size_t> found )
+    {
+        std::sort( found.begin(), found.end() );
+        return found;
+    }
+
+    /* Every query on the tree against testing every item by hand. */
+    void    check_queries( bvh const& tree, std::vector<bounds> const& all )
+    {
+        frustum view ( mat4::perspective( d_angle::in_degs( 60.0 ), 1.33, 0.5, 60.0 )
+                       * mat4::rotation( vec3( 0.0f, 1.0f, 0.0f ), d_angle::in_degs( 30.0 ) ) );
+        vec3 const center ( 5.0f, 0.0f, -5.0f );
+        vec3 const low ( -10.0f, -2.0f, 0.0f );
+        vec3 const high ( 0.0f, 2.0f, 15.0f );
+        vec3 const origin ( -60.0f, 0.5f, 3.0f );
+        vec3 const direction ( 1.0f, 0.01f, -0.05f );
+
+        std::vector<size_t> in_view, near_center, in_box, on_ray;
+        size_t first = bvh::no_item;
+        float first_t = FLT_MAX;
+        for ( size_t n = 0; n < all.size(); ++n ) {
+            if ( view.intersects( all[n] ) ) { in_view.push_back( n ); }
+            if ( box_touches( all[n], center, 8.0f ) ) { near_center.push_back( n ); }
+            if ( not all[n].empty() ) {
+                bool inside = true;
+                for ( size_t a = 0; a < 3; ++a ) {
+                    inside = inside and all[n].low()[a] <= high[a]
+                                    and all[n].high()[a] >= low[a];
+                }
+                if ( inside ) { in_box.push_back( n ); }
+            }
+            float const t = box_entry( all[n], origin, direction );
+            if ( t >= 0.0f ) {
+                on_ray.push_back( n );
+                if ( t < first_t ) {
+                    first_t = t;
+                    first = n;
+                }
+            }
+        }
+        CHECK( not in_view.empty() and not near_center.empty() and not in_box.empty() );
+
+        std::vector<size_t> found;
+        tree.visible( view, found );
+        CHECK( in_view == sorted( found ) );
+        tree.touching( center, 8.0f, found );
+        CHECK( near_center == sorted( found ) );
+        tree.overlapping( low, high, found );
+        CHECK( in_box == sorted( found ) );
+        tree.crossing( origin, direction, found );
+        CHECK( on_ray == sorted( found ) );
+        float distance = 0.0f;
+        CHECK_EQUAL( first, tree.nearest( origin, direction, &distance ) );
+        if ( first != bvh::no_item ) {
+            CHECK_CLOSE( first_t, distance, 0.0001f );
+        }
+    }
+}
+
+SUITE( BVHTests )
+{
+    TEST( QueriesMatchBruteForce )
+    {
+        std::vector<bounds> all = scatter( 3000, 11 );
+        bvh tree;
+        tree.build( all );
+        CHECK_EQUAL( all.size(), tree.size() );
+        CHECK( tree.nodes() > 1 );
+        check_queries( tree, all );
+
+        bvh wide ( bvh::settings().leaf_size( 1 ) );
+        wide.build( all );
+        check_queries( wide, all );
+    }
+
+    TEST( ThreadsMatchOneThread )
+    {
+        std::vector<bounds> all = scatter( 20000, 23 );
+        bvh threaded ( bvh::settings().threads( 4 ) );
+        threaded.build( all );
+        check_queries( threaded, all );
+    }
+
+    TEST( RefitFollowsMovement )
+    {
+        std::vector<bounds> all = scatter( 2000, 5 );
+        bvh tree;
+        tree.build( all );
+        for ( size_t n = 0; n < all.size(); n += 3 ) {
+            if ( all[n].empty() ) { continue; }
+            all[n] = bounds( all[n].low() + vec3( 7.0f, -1.0f, 3.0f ),
+                             all[n].high() + vec3( 7.0f, -1.0f, 3.0f ) );
+            tree.bound( n, all[n] );
+        }
+        all[1] = bounds();
+        tree.bound( 1, all[1] );
+        tree.refit();
+        check_queries( tree, all );
+        CHECK_THROW( tree.bound( all.size(), bounds() ), std::invalid_argument );
+    }
+
+    TEST( EmptyTree )
+    {
+        bvh tree;
+        std::vector<size_t> found ( 3, 0 );
+        tree.touching( vec3( 0.0f ), 1.0f, found );
+        CHECK( found.empty() );
+        CHECK_EQUAL( bvh::no_item, tree.nearest( vec3( 0.0f ), vec3( 1.0f, 0.0f, 0.0f ) ) );
+        tree.build( std::vector<bounds>( 4 ) );
+        CHECK_EQUAL( 0u, tree.nodes() );
+    }
+}
+
+int main( int argc, char* argv[] )
+{
+    return UnitTest::RunAllTests();
+}
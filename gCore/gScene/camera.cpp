@@ -17,20 +17,18 @@ namespace gfx {
     /**
      * \brief Upload this camera as a uniform to the program given.
      * 
-     * At the moment, this function requires that you have first specified
-     * the names of the fields in a camera manually in the program
-     * object.
-     * \todo Fix this uniform problem
+     * The field handles are resolved on the first upload and reused
+     * afterwards.
      * \param prgm The program to upload the uniform to
      * \param name The name of the camera variable in the shader source
      */
     void    camera::upload_uniform( program& prgm,
                                     std::string const& name )
     {
+        static char const* const fields[] = { ".view" };
         check_program( prgm );
-        std::string mod_name = name;
-        mod_name += ".view";
-        prgm.upload_uniform( mod_name, view );
+        uniform_handle const* field = handles.resolve( prgm, name, fields, 1 );
+        prgm.upload_uniform( field[0], view );
     }
     /**
      * \brief Return the view matrix of this camera
@@ -43,6 +41,26 @@ namespace gfx {
         }
         return view;
     }
+    /**
+     * \brief Return the std140 layout of the camera struct, for declaring
+     * a camera in a uniform block.
+     * \return The layout of the camera struct
+     */
+    std140_block const&     camera::layout()
+    {
+        static std140_block const fields = std140_block()
+                                           .member<mat4>( "view" );
+        return fields;
+    }
+    /**
+     * \brief Write the camera into a uniform block laid out with
+     * \ref layout() "layout()".
+     * \param block The block to write into
+     * \param member The index of the first field of the camera in the block
+     */
+    void    camera::serialize( std140_block& block,
+                               size_t const member )
+    { block.write( member, view_matrix() ); }
     /**
      * \brief Construct a new projection camera.
      * \param set The settings for the new projection camera
@@ -134,6 +152,20 @@ namespace gfx {
         proj_changed = true;
         return *this;
     }
+    /**
+     * \brief Return the distance to the projection camera's near
+     * clipping plane.
+     * \return The distance to the near clipping plane
+     */
+    double        proj_cam::near_plane() const
+    { return near; }
+    /**
+     * \brief Return the distance to the projection camera's far
+     * clipping plane.
+     * \return The distance to the far clipping plane
+     */
+    double        proj_cam::far_plane() const
+    { return far; }
     /**
      * \brief Update the view matrix of the projection camera.
      * Used internally.
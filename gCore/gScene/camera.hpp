@@ -7,6 +7,7 @@
 #include "../gMath/datatype.hpp"
 #include "../gMath/constant.hpp"
 #include "uniform.hpp"
+#include "std140.hpp"
 
 namespace gfx {
 
@@ -28,9 +29,13 @@ namespace gfx {
         virtual void    upload_uniform( program& prgm,
                                         std::string const& name );
         mat4 const&     view_matrix();
+        static std140_block const&  layout();
+        void            serialize( std140_block& block,
+                                   size_t const member );
     protected:
         bool            view_changed;
         mat4            view;
+        uniform_cache   handles;
         virtual void    update_view() = 0;
     };
     
@@ -80,7 +85,9 @@ namespace gfx {
         proj_cam&       field_of_view( d_angle const& vert );
         proj_cam&       aspect_ratio( double ar );
         proj_cam&       near_plane( double np );
+        double          near_plane() const;
         proj_cam&       far_plane( double fp );
+        double          far_plane() const;
     protected:
         vec3            pos;
         vec3            look;
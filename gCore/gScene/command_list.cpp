@@ -0,0 +1,605 @@
+#include "command_list.hpp"
+#include "gl_state.hpp"
+#include "texture_units.hpp"
+
+namespace gfx {
+    namespace {
+        /*
+         * The part of a buffer update payload before the bytes.
+         */
+        struct sub_data_header {
+            GLintptr        offset;
+            GLsizeiptr      size;
+        };
+        size_t const    sub_data_bytes = 16;
+    }
+    /**
+     * \brief Record making the given program the one in use.
+     * \param prgm The program
+     */
+    void    command_list::use( program& prgm )
+    { push( use_op, &prgm ); }
+    /**
+     * \brief Record aligning the given buffer, which for a vertex buffer
+     * binds its vertex array.
+     * \param bffr The buffer
+     */
+    void    command_list::align( buffer& bffr )
+    { push( align_op, &bffr ); }
+    /**
+     * \brief Record binding a one dimensional texture to a unit.
+     * \param unit The texture unit, counted from zero
+     * \param tex The texture
+     */
+    void    command_list::bind( GLuint const unit,
+                                texture_1D const& tex )
+    { push( bind_1D_op, const_cast<texture_1D*>( &tex ), unit ); }
+    /**
+     * \brief Record binding a two dimensional texture to a unit.
+     * \param unit The texture unit, counted from zero
+     * \param tex The texture
+     */
+    void    command_list::bind( GLuint const unit,
+                                texture_2D const& tex )
+    { push( bind_2D_op, const_cast<texture_2D*>( &tex ), unit ); }
+    /**
+     * \brief Record binding a buffer by name.
+     * \param target The buffer target, such as ARRAY_BUFFER
+     * \param buff_ID The OpenGL name of the buffer
+     */
+    void    command_list::bind_buffer( GLenum const target,
+                                       GLuint const buff_ID )
+    { push( bind_buffer_op, 0, target, buff_ID ); }
+    /**
+     * \brief Record replacing part of the buffer bound to a target.
+     *
+     * The bytes are copied, so they may change or go away once this
+     * returns.
+     * \param target The buffer target
+     * \param offset Where in the buffer the bytes go
+     * \param bytes The new contents
+     * \param size The number of bytes
+     */
+    void    command_list::buffer_sub_data( GLenum const target,
+                                           GLintptr const offset,
+                                           void const* bytes,
+                                           GLsizeiptr const size )
+    {
+        size_t at = allocate( sub_data_bytes + size );
+        sub_data_header* head = new ( &arena[at] ) sub_data_header();
+        head->offset = offset;
+        head->size = size;
+        if ( size > 0 ) {
+            std::memcpy( &arena[at + sub_data_bytes], bytes, size );
+        }
+        push( sub_data_op, 0, target, 0, 0, at );
+    }
+    /**
+     * \brief Record replacing part of the given buffer's OpenGL storage.
+     *
+     * The buffer's own copy of its data is not touched.
+     * \param bffr The buffer
+     * \param offset Where in the buffer the bytes go
+     * \param bytes The new contents
+     * \param size The number of bytes
+     */
+    void    command_list::update( buffer& bffr,
+                                  GLintptr const offset,
+                                  void const* bytes,
+                                  GLsizeiptr const size )
+    {
+        bind_buffer( bffr.intended_target, bffr.buff_ID );
+        buffer_sub_data( bffr.intended_target, offset, bytes, size );
+    }
+    /**
+     * \brief Record drawing from the bound vertex array.
+     * \param mode The primitive type, such as TRIANGLES
+     * \param first The first vertex
+     * \param count The number of vertices
+     */
+    void    command_list::draw_arrays( GLenum const mode,
+                                       GLint const first,
+                                       GLsizei const count )
+    { push( draw_arrays_op, 0, mode, first, count ); }
+    /**
+     * \brief Record drawing with the bound element array buffer.
+     * \param mode The primitive type, such as TRIANGLES
+     * \param count The number of indices
+     * \param index_type The type of the indices, such as UNSIGNED_SHORT
+     * \param offset The byte offset of the first index
+     */
+    void    command_list::draw_elements( GLenum const mode,
+                                         GLsizei const count,
+                                         GLenum const index_type,
+                                         GLsizeiptr const offset )
+    { push( draw_elements_op, 0, mode, count, index_type, offset ); }
+    /**
+     * \brief Add every command of another list to the end of this one.
+     *
+     * Lists recorded on separate threads can be joined this way and
+     * executed as one.
+     * \param rhs The list to copy from
+     */
+    void    command_list::append( command_list const& rhs )
+    {
+        size_t base = allocate( rhs.arena.size() );
+        if ( not rhs.arena.empty() ) {
+            std::memcpy( &arena[base], &rhs.arena[0], rhs.arena.size() );
+        }
+        commands.reserve( commands.size() + rhs.commands.size() );
+        for ( size_t i = 0; i < rhs.commands.size(); ++i ) {
+            command moved = rhs.commands[i];
+            if ( moved.op == uniform_op or moved.op == sub_data_op ) {
+                moved.payload += base;
+            }
+            commands.push_back( moved );
+        }
+    }
+    /**
+     * \brief Replay every command in the order recorded.
+     *
+     * Call this from the thread that owns the context.
+     */
+    void    command_list::execute() const
+    {
+        if ( commands.empty() ) {
+            return;
+        }
+        gl_state& state = gl_state::current();
+        command const* cmd = &commands[0];
+        command const* end = cmd + commands.size();
+        for ( ; cmd != end; ++cmd ) {
+            switch ( cmd->op ) {
+            case use_op :
+                static_cast<program*>( cmd->object )->use();
+                break;
+            case align_op :
+                static_cast<buffer*>( cmd->object )->align();
+                break;
+            case bind_1D_op :
+                texture_units::current().bind( cmd->arg[0],
+                                               *static_cast<texture_1D const*>( cmd->object ) );
+                break;
+            case bind_2D_op :
+                texture_units::current().bind( cmd->arg[0],
+                                               *static_cast<texture_2D const*>( cmd->object ) );
+                break;
+            case bind_buffer_op :
+                state.bind_buffer( cmd->arg[0], cmd->arg[1] );
+                break;
+            case uniform_op : {
+                uniform_payload const* head =
+                        reinterpret_cast<uniform_payload const*>( &arena[cmd->payload] );
+                head->upload( *static_cast<program*>( cmd->object ), *head,
+                              &arena[cmd->payload + value_offset()] );
+                break;
+            }
+            case sub_data_op : {
+                sub_data_header const* head =
+                        reinterpret_cast<sub_data_header const*>( &arena[cmd->payload] );
+                gl::BufferSubData( cmd->arg[0], head->offset, head->size,
+                                   &arena[cmd->payload + sub_data_bytes] );
+                break;
+            }
+            case draw_arrays_op :
+                gl::DrawArrays( cmd->arg[0], GLint( cmd->arg[1] ), GLsizei( cmd->arg[2] ) );
+                break;
+            case draw_elements_op :
+                gl::DrawElements( cmd->arg[0], GLsizei( cmd->arg[1] ), cmd->arg[2],
+                                  reinterpret_cast<void const*>( cmd->payload ) );
+                break;
+            default :
+                break;
+            }
+        }
+    }
+    /**
+     * \brief Forget every recorded command, keeping the memory for the
+     * next recording.
+     */
+    void    command_list::clear()
+    {
+        commands.clear();
+        arena.clear();
+    }
+    /**
+     * \brief Add a command to the list.
+     * \param op The opcode
+     * \param object The object the command acts on, if any
+     * \param arg_0 The first argument
+     * \param arg_1 The second argument
+     * \param arg_2 The third argument
+     * \param payload The arena offset of the payload, or for indexed draws
+     * the index offset
+     */
+    void    command_list::push( GLuint const op,
+                                void* object,
+                                GLuint const arg_0,
+                                GLuint const arg_1,
+                                GLuint const arg_2,
+                                size_t const payload )
+    {
+        command cmd;
+        cmd.op = op;
+        cmd.arg[0] = arg_0;
+        cmd.arg[1] = arg_1;
+        cmd.arg[2] = arg_2;
+        cmd.object = object;
+        cmd.payload = payload;
+        commands.push_back( cmd );
+    }
+    /**
+     * \brief Reserve space at the end of the arena.
+     * \param bytes The size of the payload
+     * \return The offset of the payload, a multiple of the payload
+     * alignment
+     */
+    size_t  command_list::allocate( size_t const bytes )
+    {
+        size_t at = ( arena.size() + payload_align - 1 ) & ~( payload_align - 1 );
+        arena.resize( at + bytes );
+        return at;
+    }
+    /*
+     * Copy a taken apart uniform value into the arena and add the command
+     * that uploads it.
+     */
+    void    command_list::record_uniform( program& prgm,
+                                          uniform_handle const& handle,
+                                          uniform_value const& value )
+    {
+        size_t const bytes = value.cols * value.rows * sizeof( GLfloat );
+        size_t at = allocate( value_offset() + bytes );
+        uniform_payload* head = new ( &arena[at] ) uniform_payload();
+        head->upload = value.upload;
+        head->handle = handle;
+        head->cols = value.cols;
+        head->rows = value.rows;
+        std::memcpy( &arena[at + value_offset()], value.f, bytes );
+        push( uniform_op, &prgm, 0, 0, 0, at );
+    }
+    /*
+     * Take a float32 uniform apart for recording.
+     */
+    void    command_list::flatten( float32 const& val, uniform_value& out )
+    {
+        out.upload = &command_list::upload_floats;
+        out.cols = 1;
+        out.rows = 1;
+        out.f[0] = val;
+    }
+    /*
+     * Take a float uniform apart for recording.
+     */
+    void    command_list::flatten( float const& val, uniform_value& out )
+    {
+        out.upload = &command_list::upload_floats;
+        out.cols = 1;
+        out.rows = 1;
+        out.f[0] = val;
+    }
+    /*
+     * Take a vec2 uniform apart for recording.
+     */
+    void    command_list::flatten( vec2 const& val, uniform_value& out )
+    {
+        out.upload = &command_list::upload_floats;
+        out.cols = 2;
+        out.rows = 1;
+        for ( size_t c = 0; c < 2; ++c ) {
+            out.f[c] = GLfloat( val[c] );
+        }
+    }
+    /*
+     * Take a vec3 uniform apart for recording.
+     */
+    void    command_list::flatten( vec3 const& val, uniform_value& out )
+    {
+        out.upload = &command_list::upload_floats;
+        out.cols = 3;
+        out.rows = 1;
+        for ( size_t c = 0; c < 3; ++c ) {
+            out.f[c] = GLfloat( val[c] );
+        }
+    }
+    /*
+     * Take a vec4 uniform apart for recording.
+     */
+    void    command_list::flatten( vec4 const& val, uniform_value& out )
+    {
+        out.upload = &command_list::upload_floats;
+        out.cols = 4;
+        out.rows = 1;
+        for ( size_t c = 0; c < 4; ++c ) {
+            out.f[c] = GLfloat( val[c] );
+        }
+    }
+    /*
+     * Take a int32 uniform apart for recording.
+     */
+    void    command_list::flatten( int32 const& val, uniform_value& out )
+    {
+        out.upload = &command_list::upload_ints;
+        out.cols = 1;
+        out.rows = 1;
+        out.i[0] = val;
+    }
+    /*
+     * Take a int uniform apart for recording.
+     */
+    void    command_list::flatten( int const& val, uniform_value& out )
+    {
+        out.upload = &command_list::upload_ints;
+        out.cols = 1;
+        out.rows = 1;
+        out.i[0] = val;
+    }
+    /*
+     * Take a ivec2 uniform apart for recording.
+     */
+    void    command_list::flatten( ivec2 const& val, uniform_value& out )
+    {
+        out.upload = &command_list::upload_ints;
+        out.cols = 2;
+        out.rows = 1;
+        for ( size_t c = 0; c < 2; ++c ) {
+            out.i[c] = GLint( val[c] );
+        }
+    }
+    /*
+     * Take a ivec3 uniform apart for recording.
+     */
+    void    command_list::flatten( ivec3 const& val, uniform_value& out )
+    {
+        out.upload = &command_list::upload_ints;
+        out.cols = 3;
+        out.rows = 1;
+        for ( size_t c = 0; c < 3; ++c ) {
+            out.i[c] = GLint( val[c] );
+        }
+    }
+    /*
+     * Take a ivec4 uniform apart for recording.
+     */
+    void    command_list::flatten( ivec4 const& val, uniform_value& out )
+    {
+        out.upload = &command_list::upload_ints;
+        out.cols = 4;
+        out.rows = 1;
+        for ( size_t c = 0; c < 4; ++c ) {
+            out.i[c] = GLint( val[c] );
+        }
+    }
+    /*
+     * Take a uint32 uniform apart for recording.
+     */
+    void    command_list::flatten( uint32 const& val, uniform_value& out )
+    {
+        out.upload = &command_list::upload_uints;
+        out.cols = 1;
+        out.rows = 1;
+        out.u[0] = val;
+    }
+    /*
+     * Take a uint32_t uniform apart for recording.
+     */
+    void    command_list::flatten( uint32_t const& val, uniform_value& out )
+    {
+        out.upload = &command_list::upload_uints;
+        out.cols = 1;
+        out.rows = 1;
+        out.u[0] = val;
+    }
+    /*
+     * Take a uvec2 uniform apart for recording.
+     */
+    void    command_list::flatten( uvec2 const& val, uniform_value& out )
+    {
+        out.upload = &command_list::upload_uints;
+        out.cols = 2;
+        out.rows = 1;
+        for ( size_t c = 0; c < 2; ++c ) {
+            out.u[c] = GLuint( val[c] );
+        }
+    }
+    /*
+     * Take a uvec3 uniform apart for recording.
+     */
+    void    command_list::flatten( uvec3 const& val, uniform_value& out )
+    {
+        out.upload = &command_list::upload_uints;
+        out.cols = 3;
+        out.rows = 1;
+        for ( size_t c = 0; c < 3; ++c ) {
+            out.u[c] = GLuint( val[c] );
+        }
+    }
+    /*
+     * Take a uvec4 uniform apart for recording.
+     */
+    void    command_list::flatten( uvec4 const& val, uniform_value& out )
+    {
+        out.upload = &command_list::upload_uints;
+        out.cols = 4;
+        out.rows = 1;
+        for ( size_t c = 0; c < 4; ++c ) {
+            out.u[c] = GLuint( val[c] );
+        }
+    }
+    /*
+     * Take a mat2 uniform apart for recording.
+     */
+    void    command_list::flatten( mat2 const& val, uniform_value& out )
+    {
+        out.upload = &command_list::upload_matrix;
+        out.cols = 2;
+        out.rows = 2;
+        program::column_major( val, 2, 2, out.f );
+    }
+    /*
+     * Take a mat3 uniform apart for recording.
+     */
+    void    command_list::flatten( mat3 const& val, uniform_value& out )
+    {
+        out.upload = &command_list::upload_matrix;
+        out.cols = 3;
+        out.rows = 3;
+        program::column_major( val, 3, 3, out.f );
+    }
+    /*
+     * Take a mat4 uniform apart for recording.
+     */
+    void    command_list::flatten( mat4 const& val, uniform_value& out )
+    {
+        out.upload = &command_list::upload_matrix;
+        out.cols = 4;
+        out.rows = 4;
+        program::column_major( val, 4, 4, out.f );
+    }
+    /*
+     * Take a mat2x3 uniform apart for recording.
+     */
+    void    command_list::flatten( mat2x3 const& val, uniform_value& out )
+    {
+        out.upload = &command_list::upload_matrix;
+        out.cols = 2;
+        out.rows = 3;
+        program::column_major( val, 2, 3, out.f );
+    }
+    /*
+     * Take a mat3x2 uniform apart for recording.
+     */
+    void    command_list::flatten( mat3x2 const& val, uniform_value& out )
+    {
+        out.upload = &command_list::upload_matrix;
+        out.cols = 3;
+        out.rows = 2;
+        program::column_major( val, 3, 2, out.f );
+    }
+    /*
+     * Take a mat2x4 uniform apart for recording.
+     */
+    void    command_list::flatten( mat2x4 const& val, uniform_value& out )
+    {
+        out.upload = &command_list::upload_matrix;
+        out.cols = 2;
+        out.rows = 4;
+        program::column_major( val, 2, 4, out.f );
+    }
+    /*
+     * Take a mat4x2 uniform apart for recording.
+     */
+    void    command_list::flatten( mat4x2 const& val, uniform_value& out )
+    {
+        out.upload = &command_list::upload_matrix;
+        out.cols = 4;
+        out.rows = 2;
+        program::column_major( val, 4, 2, out.f );
+    }
+    /*
+     * Take a mat3x4 uniform apart for recording.
+     */
+    void    command_list::flatten( mat3x4 const& val, uniform_value& out )
+    {
+        out.upload = &command_list::upload_matrix;
+        out.cols = 3;
+        out.rows = 4;
+        program::column_major( val, 3, 4, out.f );
+    }
+    /*
+     * Take a mat4x3 uniform apart for recording.
+     */
+    void    command_list::flatten( mat4x3 const& val, uniform_value& out )
+    {
+        out.upload = &command_list::upload_matrix;
+        out.cols = 4;
+        out.rows = 3;
+        program::column_major( val, 4, 3, out.f );
+    }
+    /*
+     * Upload recorded float components, unless the program's shadow
+     * already holds them.
+     */
+    void    command_list::upload_floats( program& prgm,
+                                         uniform_payload const& head,
+                                         void const* components )
+    {
+        GLfloat const* v = static_cast<GLfloat const*>( components );
+        if ( not prgm.shadow_changed( head.handle, v, head.cols * sizeof( GLfloat ) ) ) {
+            return;
+        }
+        GLint const loc = head.handle.location();
+        switch ( head.cols ) {
+        case 1 : gl::Uniform1fv( loc, 1, v ); break;
+        case 2 : gl::Uniform2fv( loc, 1, v ); break;
+        case 3 : gl::Uniform3fv( loc, 1, v ); break;
+        default : gl::Uniform4fv( loc, 1, v ); break;
+        }
+    }
+    /*
+     * Upload recorded integer components, unless the program's shadow
+     * already holds them.
+     */
+    void    command_list::upload_ints( program& prgm,
+                                       uniform_payload const& head,
+                                       void const* components )
+    {
+        GLint const* v = static_cast<GLint const*>( components );
+        if ( not prgm.shadow_changed( head.handle, v, head.cols * sizeof( GLint ) ) ) {
+            return;
+        }
+        GLint const loc = head.handle.location();
+        switch ( head.cols ) {
+        case 1 : gl::Uniform1iv( loc, 1, v ); break;
+        case 2 : gl::Uniform2iv( loc, 1, v ); break;
+        case 3 : gl::Uniform3iv( loc, 1, v ); break;
+        default : gl::Uniform4iv( loc, 1, v ); break;
+        }
+    }
+    /*
+     * Upload recorded unsigned components, unless the program's shadow
+     * already holds them.
+     */
+    void    command_list::upload_uints( program& prgm,
+                                        uniform_payload const& head,
+                                        void const* components )
+    {
+        GLuint const* v = static_cast<GLuint const*>( components );
+        if ( not prgm.shadow_changed( head.handle, v, head.cols * sizeof( GLuint ) ) ) {
+            return;
+        }
+        GLint const loc = head.handle.location();
+        switch ( head.cols ) {
+        case 1 : gl::Uniform1uiv( loc, 1, v ); break;
+        case 2 : gl::Uniform2uiv( loc, 1, v ); break;
+        case 3 : gl::Uniform3uiv( loc, 1, v ); break;
+        default : gl::Uniform4uiv( loc, 1, v ); break;
+        }
+    }
+    /*
+     * Upload a recorded column major matrix, unless the program's shadow
+     * already holds it.
+     */
+    void    command_list::upload_matrix( program& prgm,
+                                         uniform_payload const& head,
+                                         void const* components )
+    {
+        GLfloat const* m = static_cast<GLfloat const*>( components );
+        size_t const bytes = head.cols * head.rows * sizeof( GLfloat );
+        if ( not prgm.shadow_changed( head.handle, m, bytes ) ) {
+            return;
+        }
+        GLint const loc = head.handle.location();
+        switch ( head.cols * 10 + head.rows ) {
+        case 22 : gl::UniformMatrix2fv( loc, 1, gl::FALSE_, m ); break;
+        case 33 : gl::UniformMatrix3fv( loc, 1, gl::FALSE_, m ); break;
+        case 44 : gl::UniformMatrix4fv( loc, 1, gl::FALSE_, m ); break;
+        case 23 : gl::UniformMatrix2x3fv( loc, 1, gl::FALSE_, m ); break;
+        case 32 : gl::UniformMatrix3x2fv( loc, 1, gl::FALSE_, m ); break;
+        case 24 : gl::UniformMatrix2x4fv( loc, 1, gl::FALSE_, m ); break;
+        case 42 : gl::UniformMatrix4x2fv( loc, 1, gl::FALSE_, m ); break;
+        case 34 : gl::UniformMatrix3x4fv( loc, 1, gl::FALSE_, m ); break;
+        default : gl::UniformMatrix4x3fv( loc, 1, gl::FALSE_, m ); break;
+        }
+    }
+}
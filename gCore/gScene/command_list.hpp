@@ -0,0 +1,236 @@
+#ifndef COMMAND_LIST_HPP
+#define COMMAND_LIST_HPP
+
+#include <new>
+#include <vector>
+#include <cstring>
+
+#include "../gVideo/gl_core_3_3.hpp"
+#include "buffer.hpp"
+#include "program.hpp"
+#include "texture.hpp"
+
+namespace gfx {
+    /**
+     * \class gfx::command_list command_list.hpp "gCore/gScene/command_list.hpp"
+     * \brief A recorded sequence of binds, uniform uploads, buffer updates
+     * and draws, replayed later on the thread that owns the context.
+     *
+     * Recording makes no OpenGL calls, so any thread may record, and
+     * several threads may record at once as long as each has its own list.
+     * The thread that owns the context then calls \ref execute()
+     * "execute()" on each list in the order the work should happen.
+     *
+     * Commands are small fixed-size records. Anything larger, such as a
+     * uniform value or the bytes of a buffer update, is copied into one
+     * linear arena owned by the list. Only plain data goes in the arena:
+     * a uniform value is recorded as the components OpenGL is handed,
+     * not as the vector or matrix object it came from. \ref clear()
+     * "clear()" empties both but keeps their memory, so a list reused
+     * every frame stops allocating once it has grown to the frame's size.
+     *
+     * Objects named in a list are referred to, not copied, and must
+     * outlive its execution. Binds go through \ref gfx::gl_state
+     * "gl_state" and \ref gfx::texture_units "texture_units", so
+     * replaying a bind that changes nothing costs nothing.
+     */
+    class command_list {
+    public:
+                            command_list();
+        void                use( program& prgm );
+        void                align( buffer& bffr );
+        void                bind( GLuint const unit,
+                                  texture_1D const& tex );
+        void                bind( GLuint const unit,
+                                  texture_2D const& tex );
+        void                bind_buffer( GLenum const target,
+                                         GLuint const buff_ID );
+        template< typename T >
+        void                upload_uniform( program& prgm,
+                                            uniform_handle const& handle,
+                                            T const& val );
+        void                buffer_sub_data( GLenum const target,
+                                             GLintptr const offset,
+                                             void const* bytes,
+                                             GLsizeiptr const size );
+        void                update( buffer& bffr,
+                                    GLintptr const offset,
+                                    void const* bytes,
+                                    GLsizeiptr const size );
+        void                draw_arrays( GLenum const mode,
+                                         GLint const first,
+                                         GLsizei const count );
+        void                draw_elements( GLenum const mode,
+                                           GLsizei const count,
+                                           GLenum const index_type,
+                                           GLsizeiptr const offset );
+        void                append( command_list const& rhs );
+        void                execute() const;
+        void                clear();
+        size_t              size() const;
+        bool                empty() const;
+        size_t              arena_size() const;
+    private:
+        enum opcode {
+            use_op,
+            align_op,
+            bind_1D_op,
+            bind_2D_op,
+            bind_buffer_op,
+            uniform_op,
+            sub_data_op,
+            draw_arrays_op,
+            draw_elements_op
+        };
+        /*
+         * One recorded command. The meaning of the arguments depends on
+         * the opcode; payload is an offset into the arena, except for an
+         * indexed draw, where it is the offset of the first index.
+         */
+        struct command {
+            GLuint          op;
+            GLuint          arg[3];
+            void*           object;
+            size_t          payload;
+        };
+        struct uniform_payload;
+        typedef void    (*uniform_upload)( program& prgm,
+                                           uniform_payload const& head,
+                                           void const* components );
+        /*
+         * The part of a uniform payload before the components; cols is
+         * the number of components of a vector, or the columns of a
+         * matrix, and rows is one for a vector.
+         */
+        struct uniform_payload {
+            uniform_upload  upload;
+            uniform_handle  handle;
+            GLuint          cols;
+            GLuint          rows;
+        };
+        /*
+         * A uniform value taken apart into what OpenGL is handed, columns
+         * first for a matrix.
+         */
+        struct uniform_value {
+            uniform_upload  upload;
+            GLuint          cols;
+            GLuint          rows;
+            union {
+                GLfloat     f[16];
+                GLint       i[4];
+                GLuint      u[4];
+            };
+        };
+        /*
+         * Payloads start on this boundary, enough for any value a uniform
+         * or buffer update needs.
+         */
+        static size_t const payload_align = 16;
+
+        std::vector<command>        commands;
+        std::vector<unsigned char>  arena;
+
+        void                push( GLuint const op,
+                                  void* object,
+                                  GLuint const arg_0 = 0,
+                                  GLuint const arg_1 = 0,
+                                  GLuint const arg_2 = 0,
+                                  size_t const payload = 0 );
+        size_t              allocate( size_t const bytes );
+        void                record_uniform( program& prgm,
+                                            uniform_handle const& handle,
+                                            uniform_value const& value );
+        static size_t       value_offset();
+        static void         flatten( float32 const& val, uniform_value& out );
+        static void         flatten( float const& val, uniform_value& out );
+        static void         flatten( vec2 const& val, uniform_value& out );
+        static void         flatten( vec3 const& val, uniform_value& out );
+        static void         flatten( vec4 const& val, uniform_value& out );
+        static void         flatten( int32 const& val, uniform_value& out );
+        static void         flatten( int const& val, uniform_value& out );
+        static void         flatten( ivec2 const& val, uniform_value& out );
+        static void         flatten( ivec3 const& val, uniform_value& out );
+        static void         flatten( ivec4 const& val, uniform_value& out );
+        static void         flatten( uint32 const& val, uniform_value& out );
+        static void         flatten( uint32_t const& val, uniform_value& out );
+        static void         flatten( uvec2 const& val, uniform_value& out );
+        static void         flatten( uvec3 const& val, uniform_value& out );
+        static void         flatten( uvec4 const& val, uniform_value& out );
+        static void         flatten( mat2 const& val, uniform_value& out );
+        static void         flatten( mat3 const& val, uniform_value& out );
+        static void         flatten( mat4 const& val, uniform_value& out );
+        static void         flatten( mat2x3 const& val, uniform_value& out );
+        static void         flatten( mat3x2 const& val, uniform_value& out );
+        static void         flatten( mat2x4 const& val, uniform_value& out );
+        static void         flatten( mat4x2 const& val, uniform_value& out );
+        static void         flatten( mat3x4 const& val, uniform_value& out );
+        static void         flatten( mat4x3 const& val, uniform_value& out );
+        static void         upload_floats( program& prgm,
+                                           uniform_payload const& head,
+                                           void const* components );
+        static void         upload_ints( program& prgm,
+                                         uniform_payload const& head,
+                                         void const* components );
+        static void         upload_uints( program& prgm,
+                                          uniform_payload const& head,
+                                          void const* components );
+        static void         upload_matrix( program& prgm,
+                                           uniform_payload const& head,
+                                           void const* components );
+    };
+    /**
+     * \brief Construct an empty command list.
+     */
+    inline  command_list::command_list() :
+                                       commands (),
+                                       arena () {}
+    /**
+     * \brief Return the number of recorded commands.
+     * \return The number of commands
+     */
+    inline  size_t  command_list::size() const
+    { return commands.size(); }
+    /**
+     * \brief Query whether nothing has been recorded.
+     * \return Whether the list is empty
+     */
+    inline  bool    command_list::empty() const
+    { return commands.empty(); }
+    /**
+     * \brief Return the number of payload bytes recorded.
+     * \return The size of the arena in use
+     */
+    inline  size_t  command_list::arena_size() const
+    { return arena.size(); }
+    /**
+     * \brief Return where a uniform's value starts, relative to its
+     * payload.
+     * \return The offset of the value
+     */
+    inline  size_t  command_list::value_offset()
+    { return ( sizeof( uniform_payload ) + payload_align - 1 ) & ~( payload_align - 1 ); }
+    /**
+     * \brief Record a uniform upload through the given program.
+     *
+     * The value's components are copied, so it may change or go away once
+     * this returns. On replay they are checked against the program's
+     * shadow copy just as \ref gfx::program::upload_uniform()
+     * "upload_uniform()" does, so unchanged values are still skipped. The
+     * type must be one the program can upload.
+     * \param prgm The program the uniform belongs to
+     * \param handle The handle of the uniform
+     * \param val The value to upload
+     */
+    template< typename T > inline
+    void    command_list::upload_uniform( program& prgm,
+                                          uniform_handle const& handle,
+                                          T const& val )
+    {
+        uniform_value value;
+        flatten( val, value );
+        record_uniform( prgm, handle, value );
+    }
+}
+
+#endif
@@ -0,0 +1,106 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "command_list.hpp"
+
+using namespace gfx;
+
+/*
+ * Measures how recording command lists scales with the number of threads.
+ * Each object gets a transform computed on the CPU, a buffer update with
+ * that transform and an indexed draw, which is the shape of the per-object
+ * work done while traversing a scene. Replay is not timed; it needs a
+ * context and happens on one thread regardless.
+ *
+ * Usage: command_list_benchmark [objects] [frames] [max threads]
+ */
+namespace {
+    typedef std::chrono::high_resolution_clock  bench_clock;
+
+    void    record( command_list& cmds,
+                    size_t const first,
+                    size_t const last,
+                    size_t const frame )
+    {
+        cmds.clear();
+        float matrix[16];
+        for ( size_t i = first; i < last; ++i ) {
+            float angle = 0.001f * float( i + frame );
+            float c = std::cos( angle );
+            float s = std::sin( angle );
+            for ( size_t j = 0; j < 16; ++j ) {
+                matrix[j] = ( j % 5 == 0 ) ? 1.0f : 0.0f;
+            }
+            matrix[0] = c;
+            matrix[1] = s;
+            matrix[4] = -s;
+            matrix[5] = c;
+            matrix[12] = float( i % 100 );
+            matrix[13] = float( i / 100 );
+            cmds.bind_buffer( gl::UNIFORM_BUFFER, GLuint( i % 8 + 1 ) );
+            cmds.buffer_sub_data( gl::UNIFORM_BUFFER, 0, matrix, sizeof( matrix ) );
+            cmds.draw_elements( gl::TRIANGLES, 36, gl::UNSIGNED_SHORT, 0 );
+        }
+    }
+
+    double  run( size_t const threads,
+                 size_t const objects,
+                 size_t const frames,
+                 size_t& commands )
+    {
+        std::vector<command_list> lists ( threads );
+        bench_clock::time_point start = bench_clock::now();
+        for ( size_t frame = 0; frame < frames; ++frame ) {
+            std::vector<std::thread> workers;
+            size_t share = ( objects + threads - 1 ) / threads;
+            for ( size_t t = 0; t < threads; ++t ) {
+                size_t first = t * share;
+                size_t last = std::min( objects, first + share );
+                workers.push_back( std::thread( record, std::ref( lists[t] ),
+                                                first, last, frame ) );
+            }
+            for ( size_t t = 0; t < threads; ++t ) {
+                workers[t].join();
+            }
+        }
+        double elapsed = std::chrono::duration<double, std::milli>(
+                                bench_clock::now() - start ).count();
+        commands = 0;
+        for ( size_t t = 0; t < threads; ++t ) {
+            commands += lists[t].size();
+        }
+        return elapsed / double( frames );
+    }
+}
+
+int main( int argc, char** argv )
+{
+    size_t objects = ( argc > 1 ) ? std::strtoul( argv[1], 0, 10 ) : 200000;
+    size_t frames = ( argc > 2 ) ? std::strtoul( argv[2], 0, 10 ) : 20;
+    size_t cores = ( argc > 3 ) ? std::strtoul( argv[3], 0, 10 )
+                                : std::thread::hardware_concurrency();
+    if ( cores == 0 ) {
+        cores = 1;
+    }
+
+    std::cout << objects << " objects, " << frames << " frames, "
+              << cores << " threads at most" << std::endl;
+    std::cout << "threads\tms/frame\tspeedup\tcommands" << std::endl;
+    double single = 0.0;
+    for ( size_t threads = 1; threads <= cores; threads *= 2 ) {
+        size_t commands = 0;
+        double ms = run( threads, objects, frames, commands );
+        if ( threads == 1 ) {
+            single = ms;
+        }
+        std::cout << threads << "\t" << ms << "\t\t"
+                  << single / ms << "\t" << commands << std::endl;
+    }
+    return 0;
+}
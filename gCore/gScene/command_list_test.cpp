@@ -0,0 +1,142 @@
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "../gVideo/video.hpp"
+#include "vertex_buffer.hpp"
+#include "program.hpp"
+#include "gl_state.hpp"
+#include "command_list.hpp"
+#include "../../UnitTest++_src/UnitTest++.h"
+
+using namespace gfx;
+
+SUITE( CommandListTests )
+{
+    TEST( CommandListRecording )
+    {
+        command_list cmds;
+        CHECK( cmds.empty() );
+
+        float matrix[16] = { 1.0f };
+        cmds.bind_buffer( gl::ARRAY_BUFFER, 1 );
+        cmds.buffer_sub_data( gl::ARRAY_BUFFER, 0, matrix, sizeof( matrix ) );
+        cmds.draw_elements( gl::TRIANGLES, 36, gl::UNSIGNED_SHORT, 0 );
+        CHECK_EQUAL( 3u, cmds.size() );
+        size_t first = cmds.arena_size();
+        CHECK( first >= sizeof( matrix ) );
+
+        // A second payload starts on the payload boundary
+        cmds.buffer_sub_data( gl::ARRAY_BUFFER, 64, matrix, 4 );
+        CHECK_EQUAL( 4u, cmds.size() );
+        CHECK( cmds.arena_size() >= ( ( first + 15 ) & ~size_t( 15 ) ) + 4 );
+    }
+
+    TEST( CommandListClear )
+    {
+        command_list cmds;
+        float matrix[16] = { 0.0f };
+        for ( size_t i = 0; i < 100; ++i ) {
+            cmds.buffer_sub_data( gl::ARRAY_BUFFER, 0, matrix, sizeof( matrix ) );
+        }
+        size_t used = cmds.arena_size();
+        cmds.clear();
+        CHECK( cmds.empty() );
+        CHECK_EQUAL( 0u, cmds.arena_size() );
+        for ( size_t i = 0; i < 100; ++i ) {
+            cmds.buffer_sub_data( gl::ARRAY_BUFFER, 0, matrix, sizeof( matrix ) );
+        }
+        CHECK_EQUAL( used, cmds.arena_size() );
+    }
+
+    TEST( CommandListAppend )
+    {
+        command_list first;
+        command_list second;
+        float matrix[16] = { 0.0f };
+        first.buffer_sub_data( gl::ARRAY_BUFFER, 0, matrix, 12 );
+        second.bind_buffer( gl::ARRAY_BUFFER, 2 );
+        second.buffer_sub_data( gl::ARRAY_BUFFER, 0, matrix, sizeof( matrix ) );
+        second.draw_arrays( gl::TRIANGLES, 0, 3 );
+
+        first.append( second );
+        CHECK_EQUAL( 4u, first.size() );
+        CHECK_EQUAL( 3u, second.size() );
+        CHECK( first.arena_size() >= 16 + second.arena_size() );
+    }
+
+    TEST( CommandListReplay )
+    {
+        window test_wndw ( window::settings()
+                            .has_3D()         );
+        context test_cntx ( test_wndw );
+
+        program test_prgm ( program::settings()
+                            .vertex_path( "./shader/testVert.glsl" )
+                            .fragment_path( "./shader/testFrag.glsl" ) );
+        test_prgm.compile();
+        test_prgm.link();
+
+        vertex_buffer test_vbo ( vertex_buffer::settings()
+                                 .blocks( 3 )      );
+        test_vbo.block_format( block_spec()
+                               .attribute( type<vec2>() ) );
+        test_vbo.upload_data();
+
+        command_list cmds;
+        cmds.use( test_prgm );
+        cmds.align( test_vbo );
+        float corner[2] = { 0.5f, 0.5f };
+        cmds.update( test_vbo, 0, corner, sizeof( corner ) );
+        cmds.draw_arrays( gl::TRIANGLES, 0, 3 );
+
+        gl_state& state = gl_state::current();
+        state.begin_frame();
+        cmds.execute();
+        size_t issued = state.stats().issued;
+        // Replaying again changes no bindings
+        cmds.execute();
+        CHECK_EQUAL( issued, state.stats().issued );
+        state.verify();
+    }
+
+    TEST( CommandListUniforms )
+    {
+        window test_wndw ( window::settings()
+                            .has_3D()         );
+        context test_cntx ( test_wndw );
+
+        program test_prgm ( program::settings()
+                            .vertex_path( "./shader/uniform_array_vert.glsl" )
+                            .fragment_path( "./shader/testFrag.glsl" ) );
+        test_prgm.compile();
+        test_prgm.link();
+        uniform_handle weights = test_prgm.find_uniform( "weights" );
+
+        // Values are copied as they are recorded
+        command_list first;
+        command_list second;
+        float weight = 3.0f;
+        first.use( test_prgm );
+        first.upload_uniform( test_prgm, weights, weight );
+        weight = 4.0f;
+        second.upload_uniform( test_prgm, weights, 3.0f );
+        second.upload_uniform( test_prgm, test_prgm.find_uniform( "no_such_uniform" ), mat4() );
+        first.append( second );
+        CHECK_EQUAL( 4u, first.size() );
+
+        // The repeated value is caught by the program's shadow on replay
+        test_prgm.reset_upload_counts();
+        first.execute();
+        CHECK_EQUAL( 1u, test_prgm.uploads_issued() );
+        CHECK_EQUAL( 1u, test_prgm.uploads_skipped() );
+        test_prgm.upload_uniform( weights, 3.0f );
+        CHECK_EQUAL( 2u, test_prgm.uploads_skipped() );
+    }
+}
+
+int main( int argc, char** argv )
+{
+    video_system::get().initialize( video_system::settings() );
+    return UnitTest::RunAllTests();
+}
@@ -0,0 +1,466 @@
+#include "culling.hpp"
+
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <thread>
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+namespace gfx {
+
+    /**
+     * \brief Construct empty bounds.
+     */
+    bounds::bounds() : center_v ( 0.0f ),
+                       extent_v ( 0.0f ),
+                       radius_v ( -1.0f ) {}
+    /**
+     * \brief Construct bounds from the corners of a box.
+     *
+     * The sphere is the one passing through the box's corners.
+     * \param low The corner with the smallest coordinates
+     * \param high The corner with the largest coordinates
+     */
+    bounds::bounds( vec3 const& low, vec3 const& high ) :
+                    center_v ( ( low + high ) * 0.5f ),
+                    extent_v ( ( high - low ) * 0.5f ),
+                    radius_v ( 0.0f )
+    {
+        for ( size_t s = 0; s < 3; ++s ) {
+            if ( extent_v[s] < 0.0f ) {
+                throw std::invalid_argument( "The low corner of bounds must not be above the high corner." );
+            }
+        }
+        radius_v = std::sqrt( extent_v[0] * extent_v[0]
+                              + extent_v[1] * extent_v[1]
+                              + extent_v[2] * extent_v[2] );
+    }
+    /**
+     * \brief Construct bounds from a sphere.
+     *
+     * The box is the one just holding the sphere.
+     * \param center The center of the sphere
+     * \param radius The radius of the sphere
+     */
+    bounds::bounds( vec3 const& center, float const radius ) :
+                    center_v ( center ),
+                    extent_v ( radius ),
+                    radius_v ( radius )
+    {
+        if ( radius < 0.0f ) {
+            throw std::invalid_argument( "The radius of bounds must not be negative." );
+        }
+    }
+    /**
+     * \brief Find the bounds of a list of points.
+     *
+     * The box is the smallest holding every point, and the sphere is
+     * centered on the box and just reaches the farthest point, which is
+     * usually tighter than the box's corners.
+     * \param points The first coordinate of the first point
+     * \param count The number of points
+     * \param stride The number of bytes from one point to the next
+     * \return The bounds of the points, empty if there are none
+     */
+    bounds  bounds::of_points( float const* points,
+                               size_t const count,
+                               size_t const stride )
+    {
+        bounds found;
+        if ( count == 0 ) { return found; }
+
+        unsigned char const* first = reinterpret_cast<unsigned char const*>( points );
+        float low[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+        float high[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+        for ( size_t n = 0; n < count; ++n ) {
+            float p[3];
+            std::memcpy( p, first + n * stride, sizeof( p ) );
+            for ( size_t s = 0; s < 3; ++s ) {
+                low[s] = p[s] < low[s] ? p[s] : low[s];
+                high[s] = p[s] > high[s] ? p[s] : high[s];
+            }
+        }
+
+        float center[3];
+        for ( size_t s = 0; s < 3; ++s ) {
+            center[s] = ( low[s] + high[s] ) * 0.5f;
+            found.center_v[s] = center[s];
+            found.extent_v[s] = ( high[s] - low[s] ) * 0.5f;
+        }
+        float farthest = 0.0f;
+        for ( size_t n = 0; n < count; ++n ) {
+            float p[3];
+            std::memcpy( p, first + n * stride, sizeof( p ) );
+            float const dx = p[0] - center[0];
+            float const dy = p[1] - center[1];
+            float const dz = p[2] - center[2];
+            float const distance = dx * dx + dy * dy + dz * dz;
+            farthest = distance > farthest ? distance : farthest;
+        }
+        found.radius_v = std::sqrt( farthest );
+        return found;
+    }
+    /**
+     * \brief Find the bounds of one attribute of a buffer.
+     *
+     * The attribute must hold \ref gfx::vec3 "vec3" positions and the
+     * buffer must have had them loaded. Every block counts, so any
+     * blocks never loaded are taken to be at the origin.
+     * \param buff The buffer holding the points
+     * \param index The index of the position attribute
+     * \return The bounds of the points, empty if the buffer has no blocks
+     */
+    bounds  bounds::of_buffer( buffer const& buff, GLuint const index )
+    {
+        if ( not buff.verts_specified or index >= buff.attributes->size() ) {
+            throw std::invalid_argument( "Bounds asked of a buffer attribute that does not exist." );
+        }
+        if ( (*(*buff.attributes)[index]) != type< vec3 >() ) {
+            std::string msg = "Bounds can only be found of vec3 attributes, but buffer index ";
+            msg += std::to_string( index );
+            msg += " holds ";
+            msg += (*buff.attributes)[index]->name();
+            msg += ".";
+            throw std::invalid_argument( msg );
+        }
+        if ( buff.data == 0 ) {
+            throw std::logic_error( "Bounds asked of a buffer with no data loaded." );
+        }
+        unsigned char const* first = buff.data + buff.attribute_offset( index );
+        return of_points( reinterpret_cast<float const*>( first ),
+                          size_t( buff.n_blocks ),
+                          size_t( buff.stride ) );
+    }
+    /**
+     * \brief Return these bounds moved into another space.
+     *
+     * The box of the result holds the transformed box, and the sphere is
+     * grown by the largest scale in the matrix. Neither is any tighter
+     * than it has to be; both stay conservative.
+     * \param matrix Sixteen column major floats with no projection
+     * \return The transformed bounds
+     */
+    bounds  bounds::transformed( float const* matrix ) const
+    {
+        if ( empty() ) { return *this; }
+
+        bounds moved;
+        float scale = 0.0f;
+        for ( size_t row = 0; row < 3; ++row ) {
+            moved.center_v[row] = matrix[12 + row];
+            moved.extent_v[row] = 0.0f;
+        }
+        for ( size_t col = 0; col < 3; ++col ) {
+            float const* axis = matrix + col * 4;
+            for ( size_t row = 0; row < 3; ++row ) {
+                moved.center_v[row] = moved.center_v[row] + axis[row] * center_v[col];
+                moved.extent_v[row] = moved.extent_v[row]
+                                      + std::fabs( axis[row] ) * extent_v[col];
+            }
+            float const length = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+            scale = length > scale ? length : scale;
+        }
+        moved.radius_v = radius_v * std::sqrt( scale );
+        return moved;
+    }
+    /**
+     * \brief Return these bounds moved into another space.
+     * \param matrix A matrix with no projection
+     * \return The transformed bounds
+     */
+    bounds  bounds::transformed( mat4 const& matrix ) const
+    {
+        float c[16];
+        for ( size_t col = 0; col < 4; ++col ) {
+            for ( size_t row = 0; row < 4; ++row ) {
+                c[col * 4 + row] = matrix( col, row );
+            }
+        }
+        return transformed( c );
+    }
+
+    /**
+     * \brief Construct the frustum of a combined view and projection
+     * matrix.
+     * \param view_projection The matrix taking world space to clip space
+     */
+    frustum::frustum( mat4 const& view_projection )
+    {
+        extract( view_projection );
+    }
+    /**
+     * \brief Construct the frustum of a camera.
+     *
+     * A camera's view matrix already has its projection, perspective or
+     * orthographic, folded in.
+     * \param cam The camera
+     */
+    frustum::frustum( camera& cam )
+    {
+        extract( cam.view_matrix() );
+    }
+    /**
+     * \brief Return whether a point lies inside the frustum.
+     * \param point The point
+     */
+    bool    frustum::contains( vec3 const& point ) const
+    {
+        for ( size_t p = 0; p < 6; ++p ) {
+            if ( planes[p][0] * point[0] + planes[p][1] * point[1]
+                 + planes[p][2] * point[2] + planes[p][3] < 0.0f ) {
+                return false;
+            }
+        }
+        return true;
+    }
+    /**
+     * \brief Return whether bounds might be inside the frustum.
+     *
+     * This is the same test a \ref gfx::culler "culler" makes, one bound
+     * at a time. Bounds near a corner of the frustum can pass without
+     * being inside.
+     * \param volume The bounds
+     */
+    bool    frustum::intersects( bounds const& volume ) const
+    {
+        if ( volume.empty() ) { return false; }
+
+        vec3 const& c = volume.center();
+        vec3 const& e = volume.extent();
+        for ( size_t p = 0; p < 6; ++p ) {
+            float const distance = planes[p][0] * c[0] + planes[p][1] * c[1]
+                                   + planes[p][2] * c[2] + planes[p][3];
+            float const reach = std::fabs( planes[p][0] ) * e[0]
+                                + std::fabs( planes[p][1] ) * e[1]
+                                + std::fabs( planes[p][2] ) * e[2];
+            if ( distance < -( reach < volume.radius() ? reach : volume.radius() ) ) {
+                return false;
+            }
+        }
+        return true;
+    }
+    /*
+     * Points in clip space are inside when -w <= x, y, z <= w. With the
+     * matrix's rows r0 to r3 and a world point p, that is r3.p + r0.p >= 0
+     * for the left plane, r3.p - r0.p >= 0 for the right, and so on.
+     */
+    void    frustum::extract( mat4 const& view_projection )
+    {
+        float const signs[6] = { 1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f };
+        for ( size_t p = 0; p < 6; ++p ) {
+            size_t const row = p / 2;
+            for ( size_t col = 0; col < 4; ++col ) {
+                planes[p][col] = view_projection( col, 3 )
+                                 + signs[p] * view_projection( col, row );
+            }
+            float const length = std::sqrt( planes[p][0] * planes[p][0]
+                                            + planes[p][1] * planes[p][1]
+                                            + planes[p][2] * planes[p][2] );
+            if ( length == 0.0f ) {
+                throw std::invalid_argument( "A frustum cannot be made from a matrix with a degenerate plane." );
+            }
+            for ( size_t col = 0; col < 4; ++col ) {
+                planes[p][col] /= length;
+            }
+        }
+    }
+
+    /**
+     * \brief Construct a new culler with no bounds.
+     * \param set The settings for the culler
+     */
+    culler::culler( settings const& set ) : threads_v ( set.threads_v ),
+                                            tested_v ( 0 )
+    {
+        xs.reserve( set.reserve_v );
+        ys.reserve( set.reserve_v );
+        zs.reserve( set.reserve_v );
+        radii.reserve( set.reserve_v );
+        x_exts.reserve( set.reserve_v );
+        y_exts.reserve( set.reserve_v );
+        z_exts.reserve( set.reserve_v );
+        visible_v.reserve( set.reserve_v );
+    }
+    /**
+     * \brief Add bounds to be culled.
+     * \param volume The bounds
+     * \return The index the bounds will have in visible lists
+     */
+    size_t  culler::add( bounds const& volume )
+    {
+        xs.push_back( 0.0f );
+        ys.push_back( 0.0f );
+        zs.push_back( 0.0f );
+        radii.push_back( 0.0f );
+        x_exts.push_back( 0.0f );
+        y_exts.push_back( 0.0f );
+        z_exts.push_back( 0.0f );
+        bound( xs.size() - 1, volume );
+        return xs.size() - 1;
+    }
+    /**
+     * \brief Replace the bounds at an index, such as after their object
+     * has moved.
+     * \param n The index of the bounds
+     * \param volume The new bounds
+     */
+    void    culler::bound( size_t const n, bounds const& volume )
+    {
+        if ( n >= xs.size() ) {
+            throw std::invalid_argument( "Index given to culler is out of range." );
+        }
+        vec3 const& c = volume.center();
+        vec3 const& e = volume.extent();
+        xs[n] = c[0];
+        ys[n] = c[1];
+        zs[n] = c[2];
+        x_exts[n] = e[0];
+        y_exts[n] = e[1];
+        z_exts[n] = e[2];
+        // Nothing is far enough in front of a plane to reach back this far
+        radii[n] = volume.empty() ? -FLT_MAX : volume.radius();
+    }
+    /**
+     * \brief Replace the bounds at an index with object space bounds
+     * moved into world space.
+     * \param n The index of the bounds
+     * \param volume The bounds in object space
+     * \param matrix The object's world matrix, sixteen column major floats
+     * as a \ref gfx::scene_graph "scene graph" gives them
+     */
+    void    culler::bound( size_t const n,
+                           bounds const& volume,
+                           float const* matrix )
+    {
+        bound( n, volume.transformed( matrix ) );
+    }
+    /**
+     * \brief Remove all bounds.
+     */
+    void    culler::clear()
+    {
+        xs.clear();
+        ys.clear();
+        zs.clear();
+        radii.clear();
+        x_exts.clear();
+        y_exts.clear();
+        z_exts.clear();
+        visible_v.clear();
+        tested_v = 0;
+    }
+    /**
+     * \brief Test every bound against a frustum.
+     *
+     * Afterwards \ref drawn() "drawn()" and \ref culled() "culled()"
+     * report how the bounds were split.
+     * \param view The frustum
+     * \return The indices of the visible bounds, in ascending order
+     */
+    std::vector<size_t> const&  culler::cull( frustum const& view )
+    {
+        size_t const count = xs.size();
+        visible_v.clear();
+        tested_v = count;
+
+        // Runs are whole multiples of four so only the last has a tail
+        size_t threads = threads_v;
+        size_t per_thread = ( ( count + threads - 1 ) / threads + 3 ) & ~size_t( 3 );
+        if ( per_thread == 0 ) { per_thread = 4; }
+        threads = ( count + per_thread - 1 ) / per_thread;
+        if ( threads <= 1 ) {
+            cull_range( view, 0, count, visible_v );
+            return visible_v;
+        }
+
+        runs.resize( threads - 1 );
+        std::vector<std::thread> workers;
+        workers.reserve( threads - 1 );
+        for ( size_t t = 1; t < threads; ++t ) {
+            size_t const begin = t * per_thread;
+            size_t const end = begin + per_thread < count ? begin + per_thread : count;
+            runs[t - 1].clear();
+            workers.push_back( std::thread( &culler::cull_range, this,
+                                            std::cref( view ), begin, end,
+                                            std::ref( runs[t - 1] ) ) );
+        }
+        cull_range( view, 0, per_thread, visible_v );
+        for ( size_t t = 0; t < workers.size(); ++t ) {
+            workers[t].join();
+            visible_v.insert( visible_v.end(), runs[t].begin(), runs[t].end() );
+        }
+        return visible_v;
+    }
+    /*
+     * A bound is outside a plane when its center is farther behind it
+     * than the bound reaches toward it. The sphere reaches by its radius
+     * and the box by its extent along the plane's normal; either being
+     * behind is enough, so the smaller reach is the one tested.
+     */
+    void    culler::cull_range( frustum const& view,
+                                size_t const begin,
+                                size_t const end,
+                                std::vector<size_t>& out ) const
+    {
+        size_t n = begin;
+#ifdef __SSE__
+        __m128 const sign_mask = _mm_set1_ps( -0.0f );
+        __m128 normals[6][3];
+        __m128 reaches[6][3];
+        __m128 distances[6];
+        for ( size_t p = 0; p < 6; ++p ) {
+            float const* plane = view.plane( frustum::side( p ) );
+            for ( size_t s = 0; s < 3; ++s ) {
+                normals[p][s] = _mm_set1_ps( plane[s] );
+                reaches[p][s] = _mm_andnot_ps( sign_mask, normals[p][s] );
+            }
+            distances[p] = _mm_set1_ps( plane[3] );
+        }
+        for ( ; n + 4 <= end; n += 4 ) {
+            __m128 const x = _mm_loadu_ps( &xs[n] );
+            __m128 const y = _mm_loadu_ps( &ys[n] );
+            __m128 const z = _mm_loadu_ps( &zs[n] );
+            __m128 const r = _mm_loadu_ps( &radii[n] );
+            __m128 const ex = _mm_loadu_ps( &x_exts[n] );
+            __m128 const ey = _mm_loadu_ps( &y_exts[n] );
+            __m128 const ez = _mm_loadu_ps( &z_exts[n] );
+            __m128 inside = _mm_cmpeq_ps( r, r );
+            for ( size_t p = 0; p < 6; ++p ) {
+                __m128 const distance = _mm_add_ps( _mm_add_ps( _mm_mul_ps( normals[p][0], x ),
+                                                                _mm_mul_ps( normals[p][1], y ) ),
+                                                    _mm_add_ps( _mm_mul_ps( normals[p][2], z ),
+                                                                distances[p] ) );
+                __m128 const box = _mm_add_ps( _mm_add_ps( _mm_mul_ps( reaches[p][0], ex ),
+                                                           _mm_mul_ps( reaches[p][1], ey ) ),
+                                               _mm_mul_ps( reaches[p][2], ez ) );
+                __m128 const reach = _mm_min_ps( box, r );
+                inside = _mm_and_ps( inside,
+                                     _mm_cmpge_ps( _mm_add_ps( distance, reach ),
+                                                   _mm_setzero_ps() ) );
+            }
+            int const lanes = _mm_movemask_ps( inside );
+            for ( size_t l = 0; l < 4; ++l ) {
+                if ( lanes & ( 1 << l ) ) { out.push_back( n + l ); }
+            }
+        }
+#endif
+        for ( ; n < end; ++n ) {
+            bool inside = true;
+            for ( size_t p = 0; p < 6 and inside; ++p ) {
+                float const* plane = view.plane( frustum::side( p ) );
+                float const distance = plane[0] * xs[n] + plane[1] * ys[n]
+                                       + plane[2] * zs[n] + plane[3];
+                float const box = std::fabs( plane[0] ) * x_exts[n]
+                                  + std::fabs( plane[1] ) * y_exts[n]
+                                  + std::fabs( plane[2] ) * z_exts[n];
+                inside = distance + ( box < radii[n] ? box : radii[n] ) >= 0.0f;
+            }
+            if ( inside ) { out.push_back( n ); }
+        }
+    }
+
+}
@@ -0,0 +1,223 @@
+#ifndef CULLING_HPP
+#define CULLING_HPP
+
+#include <stdexcept>
+#include <vector>
+
+#include "../gMath/datatype.hpp"
+#include "buffer.hpp"
+#include "camera.hpp"
+
+namespace gfx {
+    /**
+     * \class gfx::bounds culling.hpp "gCore/gScene/culling.hpp"
+     * \brief A bounding sphere and an axis aligned bounding box around
+     * the same geometry.
+     *
+     * Both volumes share a center. The box is kept as the half of its
+     * size along each axis, and the sphere as its radius. Bounds with no
+     * points in them are empty and are never visible.
+     */
+    class bounds {
+    public:
+                            bounds();
+                            bounds( vec3 const& low, vec3 const& high );
+                            bounds( vec3 const& center, float const radius );
+        static bounds       of_points( float const* points,
+                                       size_t const count,
+                                       size_t const stride = sizeof( float ) * 3 );
+        static bounds       of_buffer( buffer const& buff, GLuint const index );
+        bounds              transformed( float const* matrix ) const;
+        bounds              transformed( mat4 const& matrix ) const;
+        bool                empty() const;
+        vec3 const&         center() const;
+        vec3 const&         extent() const;
+        float               radius() const;
+        vec3                low() const;
+        vec3                high() const;
+    private:
+        vec3                center_v;
+        vec3                extent_v;
+        float               radius_v;
+    };
+    /**
+     * \brief Return whether the bounds hold no points at all.
+     */
+    inline bool         bounds::empty() const
+    { return radius_v < 0.0f; }
+    /**
+     * \brief Return the center shared by the sphere and the box.
+     */
+    inline vec3 const&  bounds::center() const
+    { return center_v; }
+    /**
+     * \brief Return half the size of the box along each axis.
+     */
+    inline vec3 const&  bounds::extent() const
+    { return extent_v; }
+    /**
+     * \brief Return the radius of the sphere.
+     */
+    inline float        bounds::radius() const
+    { return radius_v; }
+    /**
+     * \brief Return the corner of the box with the smallest coordinates.
+     */
+    inline vec3         bounds::low() const
+    { return center_v - extent_v; }
+    /**
+     * \brief Return the corner of the box with the largest coordinates.
+     */
+    inline vec3         bounds::high() const
+    { return center_v + extent_v; }
+
+    /**
+     * \class gfx::frustum culling.hpp "gCore/gScene/culling.hpp"
+     * \brief The six planes bounding what a camera can see.
+     *
+     * The planes are pulled straight out of a combined view and
+     * projection matrix. Each is kept as a normal pointing into the
+     * frustum and a distance, scaled so the normal has unit length.
+     */
+    class frustum {
+    public:
+        enum side { left, right, bottom, top, near, far };
+
+        explicit            frustum( mat4 const& view_projection );
+        explicit            frustum( camera& cam );
+        float const*        plane( side const s ) const;
+        bool                contains( vec3 const& point ) const;
+        bool                intersects( bounds const& volume ) const;
+    private:
+        void                extract( mat4 const& view_projection );
+        float               planes[6][4];
+    };
+    /**
+     * \brief Return one of the planes as four floats: the normal, then
+     * the distance.
+     * \param s Which plane
+     */
+    inline float const*     frustum::plane( side const s ) const
+    { return planes[s]; }
+
+    /**
+     * \class gfx::culler culling.hpp "gCore/gScene/culling.hpp"
+     * \brief Tests many bounds against a frustum at once and lists the
+     * ones that can be seen.
+     *
+     * Bounds are kept component by component, so the test runs on four
+     * of them at a time with SSE where it is available. A bound is culled
+     * when its sphere or its box lies wholly behind any plane. The result
+     * is a list of the indices of the visible bounds in ascending order,
+     * ready to walk when drawing. With more than one thread in the
+     * settings the bounds are split into even runs, one per thread, and
+     * the runs' lists are joined afterwards.
+     */
+    class culler {
+    public:
+        /**
+         * \class gfx::culler::settings
+         * \brief Used to configure a \ref gfx::culler "culler".
+         */
+        class settings {
+        public:
+                            settings();
+            settings&       threads( size_t const count );
+            settings&       reserve( size_t const count );
+        private:
+            friend          class culler;
+            size_t          threads_v;
+            size_t          reserve_v;
+        };
+
+                                    culler( settings const& set = settings() );
+        size_t                      add( bounds const& volume );
+        void                        bound( size_t const n, bounds const& volume );
+        void                        bound( size_t const n,
+                                           bounds const& volume,
+                                           float const* matrix );
+        void                        clear();
+        size_t                      size() const;
+        std::vector<size_t> const&  cull( frustum const& view );
+        std::vector<size_t> const&  visible() const;
+        size_t                      drawn() const;
+        size_t                      culled() const;
+    private:
+        void                        cull_range( frustum const& view,
+                                                size_t const begin,
+                                                size_t const end,
+                                                std::vector<size_t>& out ) const;
+
+        /* One entry per bound: the center, sphere radius and box extent. */
+        std::vector<float>          xs;
+        std::vector<float>          ys;
+        std::vector<float>          zs;
+        std::vector<float>          radii;
+        std::vector<float>          x_exts;
+        std::vector<float>          y_exts;
+        std::vector<float>          z_exts;
+        std::vector<size_t>         visible_v;
+        /* The lists found by the other threads, kept to reuse their room. */
+        std::vector< std::vector<size_t> >  runs;
+        size_t                      threads_v;
+        size_t                      tested_v;
+    };
+    /**
+     * \brief Construct a new culler settings object with default
+     * settings.
+     *
+     * By default culling runs on the calling thread alone and no room is
+     * reserved up front.
+     */
+    inline culler::settings::settings() : threads_v ( 1 ),
+                                          reserve_v ( 0 ) {}
+    /**
+     * \brief Set how many threads \ref cull() "cull()" may use.
+     *
+     * The calling thread is one of them. Testing a bound takes a few
+     * nanoseconds, so more threads only pay off for many thousands of
+     * bounds.
+     * \param count The number of threads; zero is taken as one
+     * \return This settings object
+     */
+    inline culler::settings&    culler::settings::threads( size_t const count )
+    {
+        threads_v = count == 0 ? 1 : count;
+        return *this;
+    }
+    /**
+     * \brief Set how many bounds to make room for up front.
+     * \param count The number of bounds
+     * \return This settings object
+     */
+    inline culler::settings&    culler::settings::reserve( size_t const count )
+    {
+        reserve_v = count;
+        return *this;
+    }
+    /**
+     * \brief Return the number of bounds held.
+     */
+    inline size_t   culler::size() const
+    { return xs.size(); }
+    /**
+     * \brief Return the visible list found by the last
+     * \ref cull() "cull()".
+     */
+    inline std::vector<size_t> const&   culler::visible() const
+    { return visible_v; }
+    /**
+     * \brief Return how many bounds the last \ref cull() "cull()" found
+     * visible.
+     */
+    inline size_t   culler::drawn() const
+    { return visible_v.size(); }
+    /**
+     * \brief Return how many bounds the last \ref cull() "cull()" threw
+     * away.
+     */
+    inline size_t   culler::culled() const
+    { return tested_v - visible_v.size(); }
+}
+
+#endif
@@ -0,0 +1,81 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "../gMath/datatype.hpp"
+#include "culling.hpp"
+
+using namespace gfx;
+
+/*
+ * Measures culler::cull() on a field of bounds spread around a camera
+ * that turns a little every frame, so the visible set keeps changing.
+ * Prints the time per frame and the average split between drawn and
+ * culled bounds, then the same work one bound at a time through
+ * frustum::intersects() for comparison.
+ *
+ * Usage: culling_benchmark [bounds] [frames] [threads]
+ */
+namespace {
+    typedef std::chrono::high_resolution_clock  bench_clock;
+}
+
+int main( int argc, char** argv )
+{
+    size_t count = ( argc > 1 ) ? std::strtoul( argv[1], 0, 10 ) : 100000;
+    size_t frames = ( argc > 2 ) ? std::strtoul( argv[2], 0, 10 ) : 100;
+    size_t threads = ( argc > 3 ) ? std::strtoul( argv[3], 0, 10 ) : 1;
+    if ( frames == 0 ) { frames = 1; }
+
+    culler field ( culler::settings()
+                   .threads( threads )
+                   .reserve( count ) );
+    std::vector<bounds> all;
+    all.reserve( count );
+    std::srand( 7 );
+    for ( size_t n = 0; n < count; ++n ) {
+        vec3 center ( float( std::rand() % 2000 ) * 0.1f - 100.0f,
+                      float( std::rand() % 200 ) * 0.1f - 10.0f,
+                      float( std::rand() % 2000 ) * 0.1f - 100.0f );
+        all.push_back( bounds( center, 0.5f + float( std::rand() % 10 ) * 0.1f ) );
+        field.add( all.back() );
+    }
+
+    mat4 const projection = mat4::perspective( d_angle::in_degs( 60.0 ),
+                                               1.33, 0.1, 150.0 );
+    std::vector<frustum> views;
+    for ( size_t frame = 0; frame < frames; ++frame ) {
+        views.push_back( frustum( projection
+                                  * mat4::rotation( vec3( 0.0f, 1.0f, 0.0f ),
+                                                    d_angle::in_degs( double( frame ) ) ) ) );
+    }
+
+    double total_ms = 0.0;
+    size_t drawn = 0;
+    size_t culled = 0;
+    for ( size_t frame = 0; frame < frames; ++frame ) {
+        bench_clock::time_point start = bench_clock::now();
+        field.cull( views[frame] );
+        total_ms += std::chrono::duration<double, std::milli>( bench_clock::now() - start ).count();
+        drawn += field.drawn();
+        culled += field.culled();
+    }
+
+    size_t seen = 0;
+    bench_clock::time_point start = bench_clock::now();
+    for ( size_t frame = 0; frame < frames; ++frame ) {
+        for ( size_t n = 0; n < count; ++n ) {
+            seen += views[frame].intersects( all[n] ) ? 1 : 0;
+        }
+    }
+    double single_ms = std::chrono::duration<double, std::milli>( bench_clock::now() - start ).count();
+
+    std::cout << count << " bounds, " << frames << " frames, "
+              << threads << " thread(s)\n"
+              << "culler::cull():          " << total_ms / frames << " ms/frame, "
+              << drawn / frames << " drawn, " << culled / frames << " culled\n"
+              << "frustum::intersects():   " << single_ms / frames << " ms/frame, "
+              << seen / frames << " drawn\n";
+    return 0;
+}
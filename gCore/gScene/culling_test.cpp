@@ -0,0 +1,139 @@
+#include <stdexcept>
+#include <vector>
+
+#include "../../UnitTest++_src/UnitTest++.h"
+
+#include "../gMath/datatype.hpp"
+#include "camera.hpp"
+#include "culling.hpp"
+
+using namespace gfx;
+
+SUITE( CullingTests )
+{
+    TEST( PlanesOfCamera )
+    {
+        proj_cam cam ( proj_cam::settings()
+                       .field_of_view( d_angle::in_degs( 90.0 ) )
+                       .near_plane( 1.0 )
+                       .far_plane( 100.0 ) );
+        frustum view ( cam );
+
+        float const* near = view.plane( frustum::near );
+        CHECK_CLOSE( -1.0f, near[2], 0.0001f );
+        CHECK_CLOSE( -1.0f, near[3], 0.0001f );
+        float const* left = view.plane( frustum::left );
+        CHECK_CLOSE( 0.7071068f, left[0], 0.0001f );
+        CHECK_CLOSE( -0.7071068f, left[2], 0.0001f );
+
+        CHECK( view.contains( vec3( 0.0f, 0.0f, -10.0f ) ) );
+        CHECK( view.contains( vec3( 9.0f, -9.0f, -10.0f ) ) );
+        CHECK( not view.contains( vec3( 11.0f, 0.0f, -10.0f ) ) );
+        CHECK( not view.contains( vec3( 0.0f, 0.0f, 10.0f ) ) );
+        CHECK( not view.contains( vec3( 0.0f, 0.0f, -0.5f ) ) );
+        CHECK( not view.contains( vec3( 0.0f, 0.0f, -101.0f ) ) );
+
+        // Bounds poking in from outside still count
+        CHECK( view.intersects( bounds( vec3( 11.0f, 0.0f, -10.0f ), 1.5f ) ) );
+        CHECK( not view.intersects( bounds( vec3( 12.0f, 0.0f, -10.0f ), 1.0f ) ) );
+        CHECK( not view.intersects( bounds() ) );
+    }
+
+    TEST( BoundsOfPoints )
+    {
+        std::vector<vec3> corners;
+        corners.push_back( vec3( -1.0f, 0.0f, 2.0f ) );
+        corners.push_back( vec3( 3.0f, 1.0f, 2.0f ) );
+        corners.push_back( vec3( 1.0f, -1.0f, 4.0f ) );
+        std::vector<float> packed;
+        for ( size_t n = 0; n < corners.size(); ++n ) {
+            for ( size_t s = 0; s < 3; ++s ) {
+                packed.push_back( corners[n][s] );
+            }
+        }
+        bounds found = bounds::of_points( &packed[0], corners.size() );
+        CHECK( found.low() == vec3( -1.0f, -1.0f, 2.0f ) );
+        CHECK( found.high() == vec3( 3.0f, 1.0f, 4.0f ) );
+        CHECK_CLOSE( 2.449490f, found.radius(), 0.0001f );
+        CHECK( bounds::of_points( &packed[0], 0 ).empty() );
+
+        // Scaled by two about the origin and then moved along x
+        bounds moved = found.transformed( mat4::translate( vec3( 5.0f, 0.0f, 0.0f ) )
+                                          * mat4::scale( vec3( 2.0f, 2.0f, 2.0f ) ) );
+        CHECK( moved.center() == vec3( 7.0f, 0.0f, 6.0f ) );
+        CHECK( moved.extent() == vec3( 4.0f, 2.0f, 2.0f ) );
+        CHECK_CLOSE( 4.898979f, moved.radius(), 0.0001f );
+
+        CHECK_THROW( bounds( vec3( 1.0f ), vec3( 0.0f ) ), std::invalid_argument );
+    }
+
+    TEST( CullerMatchesOneAtATime )
+    {
+        proj_cam cam ( proj_cam::settings()
+                       .position( vec3( 0.0f, 2.0f, 5.0f ) )
+                       .look_at( vec3( 3.0f, 0.0f, -20.0f ) )
+                       .field_of_view( d_angle::in_degs( 60.0 ) )
+                       .near_plane( 0.5 )
+                       .far_plane( 50.0 ) );
+        frustum view ( cam );
+
+        // A grid of bounds around the camera, with a tail past the last four
+        culler serial;
+        culler threaded ( culler::settings().threads( 3 ) );
+        std::vector<bounds> all;
+        for ( size_t n = 0; n < 1003; ++n ) {
+            vec3 center ( float( n % 10 ) * 6.0f - 30.0f,
+                          float( ( n / 10 ) % 10 ) * 2.0f - 10.0f,
+                          -float( n / 100 ) * 8.0f + 10.0f );
+            all.push_back( n % 2 == 0 ? bounds( center, 0.5f + float( n % 7 ) )
+                                      : bounds( center - vec3( 1.0f ),
+                                                center + vec3( 1.0f, 3.0f, 0.2f ) ) );
+            CHECK_EQUAL( n, serial.add( all.back() ) );
+            threaded.add( all.back() );
+        }
+        serial.bound( 1002, bounds() );
+        threaded.bound( 1002, bounds() );
+        all[1002] = bounds();
+
+        std::vector<size_t> expected;
+        for ( size_t n = 0; n < all.size(); ++n ) {
+            if ( view.intersects( all[n] ) ) { expected.push_back( n ); }
+        }
+        CHECK( not expected.empty() );
+        CHECK( expected.size() < all.size() );
+
+        std::vector<size_t> const& found = serial.cull( view );
+        CHECK( expected == found );
+        CHECK( expected == threaded.cull( view ) );
+        CHECK_EQUAL( expected.size(), serial.drawn() );
+        CHECK_EQUAL( all.size() - expected.size(), serial.culled() );
+        CHECK_EQUAL( serial.culled(), threaded.culled() );
+        CHECK_THROW( serial.bound( 1003, bounds() ), std::invalid_argument );
+    }
+
+    TEST( MovedIntoWorld )
+    {
+        ortho_cam cam;
+        frustum view ( cam );
+        culler visible;
+        float world[16] = { 1.0f, 0.0f, 0.0f, 0.0f,
+                            0.0f, 1.0f, 0.0f, 0.0f,
+                            0.0f, 0.0f, 1.0f, 0.0f,
+                            0.0f, 0.0f, 0.0f, 1.0f };
+        bounds unit ( vec3( 0.0f, 0.0f, -5.0f ), 0.25f );
+        visible.add( unit );
+        visible.cull( view );
+        CHECK_EQUAL( 1u, visible.drawn() );
+
+        world[12] = 1000.0f;
+        visible.bound( 0, unit, world );
+        visible.cull( view );
+        CHECK_EQUAL( 0u, visible.drawn() );
+        CHECK_EQUAL( 1u, visible.culled() );
+    }
+}
+
+int main( int argc, char* argv[] )
+{
+    return UnitTest::RunAllTests();
+}
@@ -0,0 +1,383 @@
+#include "gl_state.hpp"
+
+namespace gfx {
+    namespace {
+        /*
+         * Compare one piece of the shadow with what OpenGL reports. An
+         * unknown shadow value agrees with anything.
+         */
+        void    check_value( GLuint const shadow,
+                             GLint const actual,
+                             char const* name )
+        {
+            if ( shadow != GLuint( -1 ) and shadow != GLuint( actual ) ) {
+                throw std::logic_error( std::string( "State shadow out of step with OpenGL: " ) +
+                                        name + "." );
+            }
+        }
+
+        void    check_flag( int const shadow,
+                            bool const actual,
+                            char const* name )
+        {
+            if ( shadow != -1 and ( shadow == 1 ) != actual ) {
+                throw std::logic_error( std::string( "State shadow out of step with OpenGL: " ) +
+                                        name + "." );
+            }
+        }
+    }
+    /**
+     * \brief Return the state shadow of the active context.
+     * \return The state shadow of the active context
+     * \exception std::logic_error If there is no active context
+     */
+    gl_state&   gl_state::current()
+    {
+        if ( not video_system::get().context_present() ) {
+            throw std::logic_error( "No OpenGL context available to set state in." );
+        }
+        size_t serial = video_system::get().get_active_context().serial();
+        context_map& states = contexts();
+        context_map::iterator found = states.find( serial );
+        if ( found == states.end() ) {
+            found = states.insert( std::make_pair( serial,
+                                                   new gl_state() ) ).first;
+        }
+        return *(found->second);
+    }
+    /**
+     * \brief Drop a deleted program from the shadow of every context.
+     * \param prog_ID The OpenGL name of the deleted program
+     */
+    void    gl_state::forget_program( GLuint const prog_ID )
+    {
+        context_map& states = contexts();
+        for ( context_map::iterator it = states.begin();
+              it != states.end(); ++it ) {
+            if ( it->second->prog_ID == prog_ID ) {
+                it->second->prog_ID = unknown;
+            }
+        }
+    }
+    /**
+     * \brief Drop a deleted vertex array from the shadow of every context.
+     * \param vao_ID The OpenGL name of the deleted vertex array
+     */
+    void    gl_state::forget_vertex_array( GLuint const vao_ID )
+    {
+        context_map& states = contexts();
+        for ( context_map::iterator it = states.begin();
+              it != states.end(); ++it ) {
+            if ( it->second->vao_ID == vao_ID ) {
+                it->second->vao_ID = unknown;
+            }
+            it->second->element_IDs.erase( vao_ID );
+        }
+    }
+    /**
+     * \brief Drop a deleted buffer from the shadow of every context.
+     *
+     * Deleting a buffer unbinds it, and its name may be handed out again,
+     * so the shadow must not go on believing it is bound.
+     * \param buff_ID The OpenGL name of the deleted buffer
+     */
+    void    gl_state::forget_buffer( GLuint const buff_ID )
+    {
+        context_map& states = contexts();
+        for ( context_map::iterator it = states.begin();
+              it != states.end(); ++it ) {
+            gl_state& state = *(it->second);
+            if ( state.array_ID == buff_ID ) {
+                state.array_ID = unknown;
+            }
+            std::map<GLuint, GLuint>::iterator e = state.element_IDs.begin();
+            while ( e != state.element_IDs.end() ) {
+                if ( e->second == buff_ID ) {
+                    state.element_IDs.erase( e++ );
+                } else {
+                    ++e;
+                }
+            }
+        }
+    }
+    /**
+     * \brief Use the given program for drawing.
+     * \param prog_ID The OpenGL name of the program
+     */
+    void    gl_state::use_program( GLuint const prog_ID )
+    {
+        if ( changes( this->prog_ID, prog_ID ) ) {
+            gl::UseProgram( prog_ID );
+            issued();
+        }
+    }
+    /**
+     * \brief Bind the given vertex array.
+     * \param vao_ID The OpenGL name of the vertex array
+     */
+    void    gl_state::bind_vertex_array( GLuint const vao_ID )
+    {
+        if ( changes( this->vao_ID, vao_ID ) ) {
+            gl::BindVertexArray( vao_ID );
+            issued();
+        }
+    }
+    /**
+     * \brief Bind a buffer to the given target.
+     *
+     * Only the array and element array buffers are shadowed; binds to
+     * any other target always reach OpenGL.
+     * \param target The buffer target, such as ARRAY_BUFFER
+     * \param buff_ID The OpenGL name of the buffer
+     */
+    void    gl_state::bind_buffer( GLenum const target,
+                                   GLuint const buff_ID )
+    {
+        if ( target == gl::ARRAY_BUFFER ) {
+            if ( not changes( array_ID, buff_ID ) ) {
+                return;
+            }
+        } else if ( target == gl::ELEMENT_ARRAY_BUFFER and vao_ID != unknown ) {
+            std::map<GLuint, GLuint>::iterator found = element_IDs.find( vao_ID );
+            if ( found != element_IDs.end() and found->second == buff_ID ) {
+                ++this_frame.skipped;
+                return;
+            }
+            element_IDs[vao_ID] = buff_ID;
+        }
+        gl::BindBuffer( target, buff_ID );
+        issued();
+    }
+    /**
+     * \brief Turn blending on or off.
+     * \param enabled Whether to blend
+     */
+    void    gl_state::blend( bool const enabled )
+    { toggle( gl::BLEND, blend_v, enabled ); }
+    /**
+     * \brief Set the blend factors for colour and alpha alike.
+     * \param src The source factor
+     * \param dst The destination factor
+     */
+    void    gl_state::blend_func( GLenum const src,
+                                  GLenum const dst )
+    {
+        if ( src == blend_src and dst == blend_dst ) {
+            ++this_frame.skipped;
+            return;
+        }
+        blend_src = src;
+        blend_dst = dst;
+        gl::BlendFunc( src, dst );
+        issued();
+    }
+    /**
+     * \brief Turn depth testing on or off.
+     * \param enabled Whether to test depth
+     */
+    void    gl_state::depth_test( bool const enabled )
+    { toggle( gl::DEPTH_TEST, depth_test_v, enabled ); }
+    /**
+     * \brief Set the depth comparison function.
+     * \param func The comparison, such as LESS
+     */
+    void    gl_state::depth_func( GLenum const func )
+    {
+        if ( changes( depth_func_v, func ) ) {
+            gl::DepthFunc( func );
+            issued();
+        }
+    }
+    /**
+     * \brief Turn writing to the depth buffer on or off.
+     * \param write Whether depth is written
+     */
+    void    gl_state::depth_mask( bool const write )
+    {
+        if ( changes( depth_mask_v, write ) ) {
+            gl::DepthMask( write ? gl::TRUE_ : gl::FALSE_ );
+            issued();
+        }
+    }
+    /**
+     * \brief Turn face culling on or off.
+     * \param enabled Whether to cull
+     */
+    void    gl_state::cull( bool const enabled )
+    { toggle( gl::CULL_FACE, cull_v, enabled ); }
+    /**
+     * \brief Set which faces are culled.
+     * \param face FRONT, BACK or FRONT_AND_BACK
+     */
+    void    gl_state::cull_face( GLenum const face )
+    {
+        if ( changes( cull_face_v, face ) ) {
+            gl::CullFace( face );
+            issued();
+        }
+    }
+    /**
+     * \brief Forget everything the shadow knows.
+     *
+     * Every following call is made for real until the shadow catches up.
+     */
+    void    gl_state::invalidate()
+    {
+        prog_ID = unknown;
+        vao_ID = unknown;
+        array_ID = unknown;
+        element_IDs.clear();
+        blend_v = -1;
+        blend_src = unknown;
+        blend_dst = unknown;
+        depth_test_v = -1;
+        depth_func_v = unknown;
+        depth_mask_v = -1;
+        cull_v = -1;
+        cull_face_v = unknown;
+    }
+    /**
+     * \brief Compare the whole shadow against the state OpenGL reports.
+     *
+     * State the shadow has not seen set yet is not compared.
+     * \exception std::logic_error If the shadow and OpenGL disagree
+     */
+    void    gl_state::verify() const
+    {
+        GLint value = 0;
+        gl::GetIntegerv( gl::CURRENT_PROGRAM, &value );
+        check_value( prog_ID, value, "program in use" );
+        gl::GetIntegerv( gl::VERTEX_ARRAY_BINDING, &value );
+        check_value( vao_ID, value, "vertex array" );
+        gl::GetIntegerv( gl::ARRAY_BUFFER_BINDING, &value );
+        check_value( array_ID, value, "array buffer" );
+        if ( vao_ID != unknown ) {
+            std::map<GLuint, GLuint>::const_iterator found = element_IDs.find( vao_ID );
+            if ( found != element_IDs.end() ) {
+                gl::GetIntegerv( gl::ELEMENT_ARRAY_BUFFER_BINDING, &value );
+                check_value( found->second, value, "element array buffer" );
+            }
+        }
+        check_flag( blend_v, gl::IsEnabled( gl::BLEND ) != gl::FALSE_, "blending" );
+        gl::GetIntegerv( gl::BLEND_SRC_RGB, &value );
+        check_value( blend_src, value, "blend source factor" );
+        gl::GetIntegerv( gl::BLEND_DST_RGB, &value );
+        check_value( blend_dst, value, "blend destination factor" );
+        check_flag( depth_test_v, gl::IsEnabled( gl::DEPTH_TEST ) != gl::FALSE_, "depth test" );
+        gl::GetIntegerv( gl::DEPTH_FUNC, &value );
+        check_value( depth_func_v, value, "depth function" );
+        GLboolean mask = gl::FALSE_;
+        gl::GetBooleanv( gl::DEPTH_WRITEMASK, &mask );
+        check_flag( depth_mask_v, mask != gl::FALSE_, "depth mask" );
+        check_flag( cull_v, gl::IsEnabled( gl::CULL_FACE ) != gl::FALSE_, "face culling" );
+        gl::GetIntegerv( gl::CULL_FACE_MODE, &value );
+        check_value( cull_face_v, value, "culled face" );
+    }
+    /**
+     * \brief Start counting calls for a new frame.
+     *
+     * The counts of the frame just finished move to
+     * \ref last_frame() "last_frame()".
+     */
+    void    gl_state::begin_frame()
+    {
+        prev_frame = this_frame;
+        this_frame = frame_stats();
+    }
+    /**
+     * \brief Construct the state shadow of the active context, with
+     * everything unknown.
+     */
+    gl_state::gl_state() :
+                       prog_ID ( unknown ),
+                       vao_ID ( unknown ),
+                       array_ID ( unknown ),
+                       element_IDs (),
+                       blend_v ( -1 ),
+                       blend_src ( unknown ),
+                       blend_dst ( unknown ),
+                       depth_test_v ( -1 ),
+                       depth_func_v ( unknown ),
+                       depth_mask_v ( -1 ),
+                       cull_v ( -1 ),
+                       cull_face_v ( unknown ),
+#ifdef DEBUG
+                       checking_v ( true ),
+#else
+                       checking_v ( false ),
+#endif
+                       this_frame (),
+                       prev_frame () {}
+    /**
+     * \brief Return the state shadows of every context seen so far, keyed
+     * by context serial.
+     * \return The map of state shadows
+     */
+    gl_state::context_map&  gl_state::contexts()
+    {
+        static context_map states;
+        return states;
+    }
+    /**
+     * \brief Update a shadowed name or enum, counting a skip if it does not
+     * change.
+     * \param shadow The shadow value
+     * \param value The new value
+     * \return Whether the call must be made
+     */
+    bool    gl_state::changes( GLuint& shadow, GLuint const value )
+    {
+        if ( shadow == value ) {
+            ++this_frame.skipped;
+            return false;
+        }
+        shadow = value;
+        return true;
+    }
+    /**
+     * \brief Update a shadowed flag, counting a skip if it does not change.
+     * \param shadow The shadow flag; -1 if unknown
+     * \param value The new value
+     * \return Whether the call must be made
+     */
+    bool    gl_state::changes( int& shadow, bool const value )
+    {
+        int flag = ( value ? 1 : 0 );
+        if ( shadow == flag ) {
+            ++this_frame.skipped;
+            return false;
+        }
+        shadow = flag;
+        return true;
+    }
+    /**
+     * \brief Enable or disable a capability unless the shadow shows it is
+     * already so.
+     * \param cap The capability
+     * \param shadow The shadow flag of the capability
+     * \param enabled Whether to enable it
+     */
+    void    gl_state::toggle( GLenum const cap, int& shadow,
+                              bool const enabled )
+    {
+        if ( changes( shadow, enabled ) ) {
+            if ( enabled ) {
+                gl::Enable( cap );
+            } else {
+                gl::Disable( cap );
+            }
+            issued();
+        }
+    }
+    /**
+     * \brief Count a call that reached OpenGL, checking the shadow
+     * afterwards if asked to.
+     */
+    void    gl_state::issued()
+    {
+        ++this_frame.issued;
+        if ( checking_v ) {
+            verify();
+        }
+    }
+}
@@ -0,0 +1,128 @@
+#ifndef GL_STATE_HPP
+#define GL_STATE_HPP
+
+#include <map>
+#include <string>
+#include <stdexcept>
+
+#include "../gVideo/gl_core_3_3.hpp"
+#include "../gVideo/video.hpp"
+
+namespace gfx {
+    /**
+     * \class gfx::gl_state gl_state.hpp "gCore/gScene/gl_state.hpp"
+     * \brief Keeps a shadow copy of the context's bindings and fixed
+     * function state, and skips calls that would not change it.
+     *
+     * Each context gets its own gl_state through \ref current()
+     * "current()". It covers the program in use, the vertex array, the
+     * array and element array buffers, and the blend, depth test and face
+     * culling state; texture units have their own shadow in
+     * \ref gfx::texture_units "texture_units". The element array buffer
+     * belongs to the vertex array, so the shadow remembers it per vertex
+     * array.
+     *
+     * Nothing is assumed about a context before the shadow has seen it
+     * set, so the first call for each piece of state always reaches
+     * OpenGL. Code that changes this state itself should call
+     * \ref invalidate() "invalidate()" afterwards.
+     *
+     * With \ref checking() "checking" on, every call compares the whole
+     * shadow against what OpenGL reports and throws if they disagree. It
+     * is on by default in DEBUG builds.
+     */
+    class gl_state {
+    public:
+        /**
+         * \brief Counts of state calls made and skipped during one frame.
+         */
+        struct frame_stats {
+            size_t          issued;
+            size_t          skipped;
+        };
+
+        static gl_state&    current();
+        static void         forget_program( GLuint const prog_ID );
+        static void         forget_vertex_array( GLuint const vao_ID );
+        static void         forget_buffer( GLuint const buff_ID );
+        void                use_program( GLuint const prog_ID );
+        void                bind_vertex_array( GLuint const vao_ID );
+        void                bind_buffer( GLenum const target,
+                                         GLuint const buff_ID );
+        void                blend( bool const enabled );
+        void                blend_func( GLenum const src,
+                                        GLenum const dst );
+        void                depth_test( bool const enabled );
+        void                depth_func( GLenum const func );
+        void                depth_mask( bool const write );
+        void                cull( bool const enabled );
+        void                cull_face( GLenum const face );
+        void                invalidate();
+        void                checking( bool const on );
+        bool                checking() const;
+        void                verify() const;
+        void                begin_frame();
+        frame_stats const&  stats() const;
+        frame_stats const&  last_frame() const;
+    private:
+                            gl_state();
+
+        static GLuint const unknown = GLuint( -1 );
+        typedef std::map<size_t, gl_state*>     context_map;
+        static context_map& contexts();
+
+        GLuint              prog_ID;
+        GLuint              vao_ID;
+        GLuint              array_ID;
+        /*
+         * The element array buffer of each vertex array the shadow knows
+         * about. A vertex array missing from the map has an unknown one.
+         */
+        std::map<GLuint, GLuint>    element_IDs;
+        int                 blend_v;
+        GLenum              blend_src;
+        GLenum              blend_dst;
+        int                 depth_test_v;
+        GLenum              depth_func_v;
+        int                 depth_mask_v;
+        int                 cull_v;
+        GLenum              cull_face_v;
+        bool                checking_v;
+        frame_stats         this_frame;
+        frame_stats         prev_frame;
+
+        bool                changes( GLuint& shadow, GLuint const value );
+        bool                changes( int& shadow, bool const value );
+        void                toggle( GLenum const cap, int& shadow,
+                                    bool const enabled );
+        void                issued();
+    };
+    /**
+     * \brief Turn checking the shadow against OpenGL after every call on
+     * or off.
+     * \param on Whether to check
+     */
+    inline  void    gl_state::checking( bool const on )
+    { checking_v = on; }
+    /**
+     * \brief Query whether the shadow is checked after every call.
+     * \return Whether checking is on
+     */
+    inline  bool    gl_state::checking() const
+    { return checking_v; }
+    /**
+     * \brief Return the state call counts for the frame in progress.
+     * \return The counts since the last \ref begin_frame() "begin_frame()"
+     */
+    inline  gl_state::frame_stats const&    gl_state::stats() const
+    { return this_frame; }
+    /**
+     * \brief Return the state call counts for the last finished frame.
+     * \return The counts between the last two calls to \ref begin_frame()
+     * "begin_frame()"
+     */
+    inline  gl_state::frame_stats const&    gl_state::last_frame() const
+    { return prev_frame; }
+}
+
+#endif
@@ -0,0 +1,97 @@
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "../gVideo/video.hpp"
+#include "vertex_buffer.hpp"
+#include "program.hpp"
+#include "gl_state.hpp"
+#include "../../UnitTest++_src/UnitTest++.h"
+
+using namespace gfx;
+
+SUITE( GLStateTests )
+{
+    TEST( GLStateNoContext )
+    {
+        std::string excepted ( "Exception not caught." );
+        try {
+            gl_state::current();
+        } catch ( std::logic_error& e ) {
+            excepted = "Lack of context exception caught.";
+        }
+        CHECK_EQUAL( "Lack of context exception caught.", excepted );
+    }
+
+    TEST( GLStateRedundantCalls )
+    {
+        window test_wndw ( window::settings()
+                            .has_3D()         );
+        context test_cntx ( test_wndw );
+
+        gl_state& state = gl_state::current();
+        state.checking( true );
+        state.begin_frame();
+        state.depth_test( true );
+        state.depth_test( true );
+        state.depth_func( gl::LEQUAL );
+        state.depth_func( gl::LEQUAL );
+        state.blend( false );
+        state.blend_func( gl::SRC_ALPHA, gl::ONE_MINUS_SRC_ALPHA );
+        state.blend_func( gl::SRC_ALPHA, gl::ONE_MINUS_SRC_ALPHA );
+        state.cull( true );
+        state.cull_face( gl::BACK );
+        state.cull( true );
+        CHECK_EQUAL( 6u, state.stats().issued );
+        CHECK_EQUAL( 3u, state.stats().skipped );
+        state.verify();
+
+        // After invalidating, the next call is made again
+        state.invalidate();
+        state.depth_test( true );
+        CHECK_EQUAL( 7u, state.stats().issued );
+
+        state.begin_frame();
+        CHECK_EQUAL( 3u, state.last_frame().skipped );
+        CHECK_EQUAL( 0u, state.stats().issued );
+    }
+
+    TEST( GLStateBindings )
+    {
+        window test_wndw ( window::settings()
+                            .has_3D()         );
+        context test_cntx ( test_wndw );
+
+        gl_state& state = gl_state::current();
+        state.checking( true );
+        program test_prgm ( program::settings()
+                            .vertex_path( "./shader/testVert.glsl" )
+                            .fragment_path( "./shader/testFrag.glsl" ) );
+        test_prgm.compile();
+        test_prgm.link();
+
+        state.begin_frame();
+        test_prgm.use();
+        test_prgm.use();
+        CHECK_EQUAL( 1u, state.stats().issued );
+        CHECK_EQUAL( 1u, state.stats().skipped );
+
+        vertex_buffer test_vbo ( vertex_buffer::settings()
+                                 .blocks( 3 )      );
+        test_vbo.block_format( block_spec()
+                               .attribute( type<vec2>() ) );
+        test_vbo.upload_data();
+        test_vbo.align();
+        size_t issued = state.stats().issued;
+        // Aligning again only needs the vertex array, which is bound
+        test_vbo.align();
+        CHECK_EQUAL( issued, state.stats().issued );
+        state.verify();
+    }
+}
+
+int main( int argc, char** argv )
+{
+    video_system::get().initialize( video_system::settings() );
+    return UnitTest::RunAllTests();
+}
@@ -0,0 +1,293 @@
+#include "instance_buffer.hpp"
+
+#include <cstring>
+#include <string>
+
+#include "../gVideo/video.hpp"
+#include "gl_state.hpp"
+
+namespace gfx {
+
+    /**
+     * \brief Construct a new instance buffer with the given record layout.
+     * \param set The layout and capacity
+     * \exception std::invalid_argument If the record is empty or its
+     * fields need more than the sixteen attribute locations OpenGL 3.3
+     * promises
+     * \exception std::logic_error If there is no context to make the
+     * buffer in
+     */
+    instance_buffer::instance_buffer( settings const& set ) :
+                                        layout ( set.fields_v ),
+                                        locations (),
+                                        offsets (),
+                                        first_location ( set.location_v ),
+                                        record ( 0 ),
+                                        transform_field ( set.fields_v.size() ),
+                                        color_field ( set.fields_v.size() ),
+                                        serial ( next_serial() ),
+                                        count ( 0 ),
+                                        records (),
+                                        scratch (),
+                                        buff_ID ( 0 ),
+                                        changed ( false )
+    {
+        if ( layout.empty() ) {
+            throw std::invalid_argument( "An instance record needs at least one field." );
+        }
+        GLuint next = first_location;
+        for ( size_t f = 0; f < layout.size(); ++f ) {
+            locations.push_back( next );
+            offsets.push_back( record );
+            next += ( layout[f].kind == 1 ) ? 4 : ( layout[f].kind == 2 ) ? 3 : 1;
+            record += size_t( layout[f].components );
+            if ( layout[f].kind == 1 or layout[f].kind == 2 ) {
+                transform_field = f;
+            } else if ( layout[f].kind == 3 ) {
+                color_field = f;
+            }
+        }
+        if ( next > 16 ) {
+            throw std::invalid_argument( "Instance attributes reach past location 15." );
+        }
+        if ( not video_system::get().context_present() ) {
+            throw std::logic_error( "No OpenGL context available to create an instance buffer in." );
+        }
+        records.reserve( set.capacity_v * record );
+        gl::GenBuffers( 1, &buff_ID );
+    }
+    /**
+     * \brief Destroy the instance buffer and delete its OpenGL buffer.
+     */
+    instance_buffer::~instance_buffer()
+    {
+        gl_state::forget_buffer( buff_ID );
+        gl::DeleteBuffers( 1, &buff_ID );
+    }
+    /**
+     * \brief Set the number of instances.
+     *
+     * Records already loaded are kept; new ones are zeroed.
+     * \param number The number of instances
+     */
+    void    instance_buffer::instances( size_t const number )
+    {
+        count = number;
+        records.resize( count * record, 0.0f );
+        changed = true;
+    }
+    /**
+     * \brief Return the first attribute location of a field.
+     * \param field The field, numbered in the order the settings added it
+     * \return The location
+     * \exception std::out_of_range If there is no such field
+     */
+    GLuint  instance_buffer::location( size_t const field ) const
+    {
+        if ( field >= layout.size() ) {
+            throw std::out_of_range( "No such field in the instance record." );
+        }
+        return locations[field];
+    }
+    /**
+     * \brief Load transformations composed from streams of positions,
+     * rotations and scales, setting the number of instances to the number
+     * of transformations.
+     *
+     * When the record is a matrix alone the matrices are composed straight
+     * into the records.
+     * \param in The streams, as for
+     * \ref gfx::orientable::compose() "orientable::compose()"
+     * \param number The number of transformations
+     * \exception std::logic_error If the record has no transformation
+     */
+    void    instance_buffer::load_transforms( orientable::streams const& in,
+                                              size_t const number )
+    {
+        need_transform();
+        instances( number );
+        if ( number == 0 ) {
+            return;
+        }
+        if ( record == 16 and layout[transform_field].kind == 1 ) {
+            orientable::compose( in, number, &records[0] );
+            return;
+        }
+        scratch.resize( number * 16 );
+        orientable::compose( in, number, &scratch[0] );
+        for ( size_t n = 0; n < number; ++n ) {
+            store_transform( transform_at( n ), &scratch[n * 16] );
+        }
+    }
+    /**
+     * \brief Load a transformation matrix for each instance, setting the
+     * number of instances to the number of matrices.
+     * \param matrices The matrices; only the top three rows are kept for
+     * an affine transformation
+     * \exception std::logic_error If the record has no transformation
+     */
+    void    instance_buffer::load_transforms( std::vector<mat4> const& matrices )
+    {
+        need_transform();
+        instances( matrices.size() );
+        float matrix[16];
+        for ( size_t n = 0; n < matrices.size(); ++n ) {
+            for ( size_t col = 0; col < 4; ++col ) {
+                for ( size_t row = 0; row < 4; ++row ) {
+                    matrix[col * 4 + row] = matrices[n]( col, row );
+                }
+            }
+            store_transform( transform_at( n ), matrix );
+        }
+    }
+    /**
+     * \brief Load a colour for each instance, setting the number of
+     * instances to the number of colours.
+     * \param colors The colours
+     * \exception std::logic_error If the record has no colour
+     */
+    void    instance_buffer::load_colors( std::vector<vec4> const& colors )
+    {
+        if ( color_field == layout.size() ) {
+            throw std::logic_error( "The instance record has no colour." );
+        }
+        instances( colors.size() );
+        for ( size_t n = 0; n < colors.size(); ++n ) {
+            float* target = &records[n * record + offsets[color_field]];
+            for ( size_t c = 0; c < 4; ++c ) {
+                target[c] = colors[n][c];
+            }
+        }
+    }
+    /**
+     * \brief Load any field of every instance from an array, setting the
+     * number of instances to the number of values given.
+     *
+     * The values are packed one instance after another, with as many
+     * floats each as the field has: sixteen, column by column, for a
+     * matrix and twelve, row by row, for an affine transformation.
+     * \param field The field, numbered in the order the settings added it
+     * \param values The values
+     * \param number The number of instances the values are for
+     * \exception std::out_of_range If there is no such field
+     */
+    void    instance_buffer::load_attribute( size_t const field,
+                                             float const* values,
+                                             size_t const number )
+    {
+        if ( field >= layout.size() ) {
+            throw std::out_of_range( "No such field in the instance record." );
+        }
+        instances( number );
+        size_t const components = size_t( layout[field].components );
+        for ( size_t n = 0; n < number; ++n ) {
+            std::memcpy( &records[n * record + offsets[field]],
+                         values + n * components,
+                         components * sizeof( float ) );
+        }
+    }
+    /**
+     * \brief Write the records to OpenGL.
+     *
+     * The buffer is given new storage each time, so OpenGL can let draws
+     * still reading the old records finish while the new ones are written.
+     */
+    void    instance_buffer::upload()
+    {
+        gl_state::current().bind_buffer( gl::ARRAY_BUFFER, buff_ID );
+        gl::BufferData( gl::ARRAY_BUFFER,
+                        GLsizeiptr( records.size() * sizeof( float ) ),
+                        records.empty() ? 0 : &records[0],
+                        gl::STREAM_DRAW );
+        changed = false;
+    }
+    /**
+     * \brief Point a vertex buffer's vertex array at the records.
+     *
+     * Each location of each field is set up to advance once an instance.
+     * Nothing is set if the vertex array already points at this buffer.
+     * \param geometry The vertex buffer holding the mesh's vertices
+     * \exception std::invalid_argument If the vertex buffer's own
+     * attributes reach the first location of the records
+     */
+    void    instance_buffer::attach( vertex_buffer& geometry )
+    {
+        geometry.align();
+        if ( geometry.attributes->size() > first_location ) {
+            std::string msg = "The vertex buffer's attributes overlap the ";
+            msg += "instance attributes; start the instances at a later location.";
+            throw std::invalid_argument( msg );
+        }
+        if ( geometry.instanced_serial == serial ) {
+            return;
+        }
+        gl_state::current().bind_buffer( gl::ARRAY_BUFFER, buff_ID );
+        GLsizei const bytes = GLsizei( record * sizeof( float ) );
+        for ( size_t f = 0; f < layout.size(); ++f ) {
+            GLuint slots = 1;
+            GLint width = layout[f].components;
+            if ( layout[f].kind == 1 or layout[f].kind == 2 ) {
+                slots = GLuint( layout[f].components / 4 );
+                width = 4;
+            }
+            for ( GLuint s = 0; s < slots; ++s ) {
+                GLuint const index = locations[f] + s;
+                size_t const offset = ( offsets[f] + s * 4 ) * sizeof( float );
+                gl::VertexAttribPointer( index, width, gl::FLOAT, gl::FALSE_,
+                                         bytes, ( void* ) offset );
+                gl::EnableVertexAttribArray( index );
+                gl::VertexAttribDivisor( index, 1 );
+            }
+        }
+        geometry.instanced_serial = serial;
+    }
+    /**
+     * \brief Draw every instance of a mesh in one call.
+     *
+     * Records changed since the last upload are uploaded first, and the
+     * mesh's vertex array attached.
+     * \param shape The mesh to draw
+     */
+    void    instance_buffer::draw( mesh& shape )
+    {
+        if ( changed ) {
+            upload();
+        }
+        attach( shape.geometry() );
+        shape.draw( GLsizei( count ) );
+    }
+    /*
+     * Write a column-major matrix into a record's transformation, whole
+     * or as its top three rows.
+     */
+    void    instance_buffer::store_transform( float* target,
+                                              float const* matrix ) const
+    {
+        if ( layout[transform_field].kind == 1 ) {
+            std::memcpy( target, matrix, 16 * sizeof( float ) );
+            return;
+        }
+        for ( size_t row = 0; row < 3; ++row ) {
+            for ( size_t col = 0; col < 4; ++col ) {
+                target[row * 4 + col] = matrix[col * 4 + row];
+            }
+        }
+    }
+    /*
+     * Throw unless the record has a transformation.
+     */
+    void    instance_buffer::need_transform() const
+    {
+        if ( transform_field == layout.size() ) {
+            throw std::logic_error( "The instance record has no transformation." );
+        }
+    }
+    /*
+     * A serial number no other instance buffer has had, never zero.
+     */
+    size_t  instance_buffer::next_serial()
+    {
+        static size_t last = 0;
+        return ++last;
+    }
+}
@@ -0,0 +1,269 @@
+#ifndef INSTANCE_BUFFER_HPP
+#define INSTANCE_BUFFER_HPP
+
+#include <stdexcept>
+#include <vector>
+
+#include "../gVideo/gl_core_3_3.hpp"
+#include "../gMath/datatype.hpp"
+#include "orientable.hpp"
+#include "vertex_buffer.hpp"
+#include "mesh.hpp"
+
+namespace gfx {
+    /**
+     * \class gfx::instance_buffer instance_buffer.hpp "gCore/gScene/instance_buffer.hpp"
+     * \brief A buffer of per-instance attributes, for drawing many copies
+     * of one mesh in a single call.
+     *
+     * The settings lay out one record per instance from fields in the
+     * order they are asked for: a transformation, as a whole matrix or as
+     * the top three rows of an affine one, a colour, and any number of
+     * custom attributes of one to four floats. The fields take consecutive
+     * attribute locations from the first one given, after those of the
+     * mesh's own vertices; a matrix takes four locations, its columns, and
+     * an affine transformation three, its rows, so a vertex shader reads
+     * either as
+     *
+     *     in mat4 instance_matrix;
+     *     in vec4 instance_rows[3];
+     *
+     * and transforms a point with instance_matrix * p, or with the dot
+     * product of each row and p.
+     *
+     * Records are filled in bulk with the load functions, straight from
+     * \ref gfx::orientable "orientables", from streams handed to
+     * \ref gfx::orientable::compose() "orientable::compose()", or from
+     * plain arrays; each load sets the number of instances. The records
+     * are kept in memory and written to OpenGL in one call by
+     * \ref upload() "upload()", which orphans the old storage so a buffer
+     * can be refilled every frame without waiting on draws still reading
+     * it.
+     *
+     * \ref attach() "attach()" points a vertex buffer's vertex array at
+     * the records, with a divisor of one on each location so they advance
+     * once an instance rather than once a vertex. The vertex array keeps
+     * the pointers, so they are only set again when a different instance
+     * buffer is attached. Instance buffers are told apart by a serial
+     * number that is never reused, rather than by their OpenGL names,
+     * which are handed out again as soon as they are freed.
+     * \ref draw() "draw()" uploads what has changed, attaches a mesh and
+     * draws every instance of it in one call.
+     */
+    class instance_buffer {
+    public:
+        /**
+         * \class gfx::instance_buffer::settings
+         * \brief Lays out the per-instance records of an
+         * \ref gfx::instance_buffer "instance_buffer".
+         */
+        class settings {
+        public:
+                            settings();
+            settings&       location( GLuint const first );
+            settings&       transforms();
+            settings&       affine_transforms();
+            settings&       colors();
+            settings&       attribute( GLint const components );
+            settings&       capacity( size_t const instances );
+        private:
+            friend          class instance_buffer;
+            /* One field of the record; kind is 0 custom, 1 matrix, 2 affine, 3 colour. */
+            struct field {
+                int         kind;
+                GLint       components;
+            };
+            GLuint              location_v;
+            std::vector<field>  fields_v;
+            size_t              capacity_v;
+            settings&       add( int const kind,
+                                 GLint const components );
+        };
+
+                            instance_buffer( settings const& set = settings() );
+                            ~instance_buffer();
+        size_t              instances() const;
+        void                instances( size_t const number );
+        size_t              fields() const;
+        GLuint              location( size_t const field ) const;
+        size_t              stride() const;
+        std::vector<float> const&   instance_data() const;
+        template< typename OBJECT >
+        void                load_transforms( std::vector<OBJECT*> const& objects );
+        void                load_transforms( orientable::streams const& in,
+                                             size_t const number );
+        void                load_transforms( std::vector<mat4> const& matrices );
+        void                load_colors( std::vector<vec4> const& colors );
+        void                load_attribute( size_t const field,
+                                            float const* values,
+                                            size_t const number );
+        void                upload();
+        void                attach( vertex_buffer& geometry );
+        void                draw( mesh& shape );
+    private:
+                            instance_buffer( instance_buffer const& );
+        instance_buffer&    operator =( instance_buffer const& );
+
+        float*              transform_at( size_t const n );
+        void                store_transform( float* target,
+                                             float const* matrix ) const;
+        void                need_transform() const;
+        static size_t       next_serial();
+
+        std::vector<settings::field>    layout;
+        std::vector<GLuint>             locations;
+        std::vector<size_t>             offsets;
+        GLuint                          first_location;
+        size_t                          record;
+        size_t                          transform_field;
+        size_t                          color_field;
+        size_t                          serial;
+        size_t                          count;
+        std::vector<float>              records;
+        std::vector<float>              scratch;
+        GLuint                          buff_ID;
+        bool                            changed;
+    };
+    /**
+     * \brief Construct a new instance buffer settings object.
+     *
+     * The layout starts empty, at attribute location 1, with room for no
+     * instances.
+     */
+    inline  instance_buffer::settings::settings() : location_v ( 1 ),
+                                                    fields_v (),
+                                                    capacity_v ( 0 ) {}
+    /**
+     * \brief Set the attribute location of the first field.
+     *
+     * It must come after the locations of the attributes of every vertex
+     * buffer the instances are attached to.
+     * \param first The first location
+     * \return This settings object
+     */
+    inline  instance_buffer::settings&  instance_buffer::settings::location( GLuint const first )
+    {
+        location_v = first;
+        return *this;
+    }
+    /**
+     * \brief Add a whole 4x4 transformation matrix to the record, taking
+     * four attribute locations, one a column.
+     * \return This settings object
+     * \exception std::logic_error If the record already has a
+     * transformation
+     */
+    inline  instance_buffer::settings&  instance_buffer::settings::transforms()
+    { return add( 1, 16 ); }
+    /**
+     * \brief Add the top three rows of an affine transformation to the
+     * record, taking three attribute locations, one a row.
+     * \return This settings object
+     * \exception std::logic_error If the record already has a
+     * transformation
+     */
+    inline  instance_buffer::settings&  instance_buffer::settings::affine_transforms()
+    { return add( 2, 12 ); }
+    /**
+     * \brief Add an RGBA colour to the record.
+     * \return This settings object
+     * \exception std::logic_error If the record already has a colour
+     */
+    inline  instance_buffer::settings&  instance_buffer::settings::colors()
+    { return add( 3, 4 ); }
+    /**
+     * \brief Add a custom attribute to the record.
+     * \param components The number of floats in the attribute
+     * \return This settings object
+     * \exception std::invalid_argument If the attribute does not have
+     * one to four components
+     */
+    inline  instance_buffer::settings&  instance_buffer::settings::attribute( GLint const components )
+    {
+        if ( components < 1 or components > 4 ) {
+            throw std::invalid_argument( "An instance attribute has one to four components." );
+        }
+        return add( 0, components );
+    }
+    /**
+     * \brief Set the number of instances to make room for up front.
+     * \param instances The number of instances
+     * \return This settings object
+     */
+    inline  instance_buffer::settings&  instance_buffer::settings::capacity( size_t const instances )
+    {
+        capacity_v = instances;
+        return *this;
+    }
+    /*
+     * Append a field, allowing one transformation and one colour.
+     */
+    inline  instance_buffer::settings&  instance_buffer::settings::add( int const kind,
+                                                                       GLint const components )
+    {
+        bool const transform = kind == 1 or kind == 2;
+        for ( size_t f = 0; f < fields_v.size(); ++f ) {
+            int const other = fields_v[f].kind;
+            if ( ( kind == 3 and other == 3 ) or
+                 ( transform and ( other == 1 or other == 2 ) ) ) {
+                throw std::logic_error( "The instance record already has that field." );
+            }
+        }
+        field const added = { kind, components };
+        fields_v.push_back( added );
+        return *this;
+    }
+    /**
+     * \brief Return the number of instances loaded.
+     */
+    inline  size_t  instance_buffer::instances() const
+    { return count; }
+    /**
+     * \brief Return the number of fields in each record.
+     */
+    inline  size_t  instance_buffer::fields() const
+    { return layout.size(); }
+    /**
+     * \brief Return the number of floats in each record.
+     */
+    inline  size_t  instance_buffer::stride() const
+    { return record; }
+    /**
+     * \brief Return the records as they will be uploaded, one after
+     * another.
+     */
+    inline  std::vector<float> const&   instance_buffer::instance_data() const
+    { return records; }
+    /**
+     * \brief Load the transformation of each of a list of objects, in
+     * order, setting the number of instances to the length of the list.
+     *
+     * Each object's matrix is written straight into its record.
+     * \param objects The objects, of any type derived from
+     * \ref gfx::orientable "orientable"
+     * \exception std::logic_error If the record has no transformation
+     */
+    template< typename OBJECT >
+    inline  void    instance_buffer::load_transforms( std::vector<OBJECT*> const& objects )
+    {
+        need_transform();
+        instances( objects.size() );
+        float matrix[16];
+        for ( size_t n = 0; n < objects.size(); ++n ) {
+            orientable const& object = *objects[n];
+            if ( layout[transform_field].kind == 1 ) {
+                object.object_matrix( transform_at( n ) );
+            } else {
+                object.object_matrix( matrix );
+                store_transform( transform_at( n ), matrix );
+            }
+        }
+    }
+    /*
+     * The transformation of record n.
+     */
+    inline  float*  instance_buffer::transform_at( size_t const n )
+    { return &records[n * record + offsets[transform_field]]; }
+}
+
+#endif
@@ -0,0 +1,127 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "../gVideo/video.hpp"
+#include "../gMath/datatype.hpp"
+#include "instance_buffer.hpp"
+#include "mesh.hpp"
+#include "orientable.hpp"
+
+using namespace gfx;
+
+/*
+ * Draws a field of identical props against the null OpenGL backend, so
+ * only the CPU's side of the work is timed: once with a matrix uniform and
+ * a draw call for every prop, once through an instance buffer filled from
+ * the props themselves, and once through one filled by composing streams
+ * of positions, rotations and scales.
+ *
+ * Usage: instance_buffer_benchmark [props] [frames]
+ */
+namespace {
+    typedef std::chrono::high_resolution_clock  bench_clock;
+
+    double  since( bench_clock::time_point const start )
+    {
+        return std::chrono::duration<double, std::milli>( bench_clock::now() - start ).count();
+    }
+
+    float   random( float const low, float const high )
+    {
+        return low + ( high - low ) * float( std::rand() % 1000 ) / 999.0f;
+    }
+}
+
+int main( int argc, char** argv )
+{
+    size_t count = ( argc > 1 ) ? std::strtoul( argv[1], 0, 10 ) : 20000;
+    size_t frames = ( argc > 2 ) ? std::strtoul( argv[2], 0, 10 ) : 20;
+    if ( frames == 0 ) { frames = 1; }
+
+    video_system::get().initialize( video_system::settings().ver( 3, 3 ) );
+    gl_backend::use_null();
+    context cntx ( ( context::settings() ) );
+    mesh& shape = mesh::acquire( mesh::settings().sphere( 8, 16 ) );
+
+    std::srand( 5 );
+    std::vector<orientable*> props;
+    std::vector<float> components ( count * 10 );
+    orientable::streams in;
+    for ( size_t c = 0; c < 3; ++c ) {
+        in.position[c] = &components[c * count];
+        in.scale[c] = &components[( 7 + c ) * count];
+    }
+    for ( size_t c = 0; c < 4; ++c ) {
+        in.rotation[c] = &components[( 3 + c ) * count];
+    }
+    for ( size_t n = 0; n < count; ++n ) {
+        vec3 const pos ( random( -500.0f, 500.0f ), 0.0f, random( -500.0f, 500.0f ) );
+        qutn const rot = qutn::rotation( vec3( 0.0f, 1.0f, 0.0f ),
+                                         d_angle::in_degs( random( 0.0f, 360.0f ) ) );
+        vec3 const scl ( random( 0.5f, 2.0f ) );
+        props.push_back( new orientable( orientable::settings()
+                                         .position( pos )
+                                         .rotation( rot )
+                                         .scale( scl ) ) );
+        for ( size_t c = 0; c < 3; ++c ) {
+            components[c * count + n] = pos[c];
+            components[( 7 + c ) * count + n] = scl[c];
+        }
+        for ( size_t c = 0; c < 4; ++c ) {
+            components[( 3 + c ) * count + n] = rot[c];
+        }
+    }
+
+    instance_buffer from_props ( instance_buffer::settings()
+                                 .transforms()
+                                 .capacity( count ) );
+    instance_buffer from_streams ( instance_buffer::settings()
+                                   .transforms()
+                                   .capacity( count ) );
+    double single_ms = 0.0;
+    double props_ms = 0.0;
+    double streams_ms = 0.0;
+    size_t single_calls = 0;
+    size_t instanced_calls = 0;
+    gl_backend::recording( true );
+    for ( size_t f = 0; f < frames; ++f ) {
+        gl_backend::reset_stats();
+        bench_clock::time_point start = bench_clock::now();
+        float matrix[16];
+        for ( size_t n = 0; n < count; ++n ) {
+            props[n]->object_matrix( matrix );
+            gl::UniformMatrix4fv( 0, 1, gl::FALSE_, matrix );
+            shape.draw();
+        }
+        single_ms += since( start );
+        single_calls = gl_backend::stats( "DrawElements" ).calls;
+
+        start = bench_clock::now();
+        from_props.load_transforms( props );
+        from_props.draw( shape );
+        props_ms += since( start );
+
+        gl_backend::reset_stats();
+        start = bench_clock::now();
+        from_streams.load_transforms( in, count );
+        from_streams.draw( shape );
+        streams_ms += since( start );
+        instanced_calls = gl_backend::stats( "DrawElementsInstanced" ).calls;
+    }
+    gl_backend::recording( false );
+
+    std::cout << count << " props\n"
+              << "one draw each:              " << single_ms / frames << " ms/frame, "
+              << single_calls << " draw calls\n"
+              << "instanced, from the props:  " << props_ms / frames << " ms/frame\n"
+              << "instanced, from streams:    " << streams_ms / frames << " ms/frame, "
+              << instanced_calls << " draw call\n";
+
+    for ( size_t n = 0; n < props.size(); ++n ) {
+        delete props[n];
+    }
+    mesh::release( shape );
+    return 0;
+}
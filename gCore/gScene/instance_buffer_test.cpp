@@ -0,0 +1,261 @@
+#include <stdexcept>
+#include <vector>
+
+#include "../../UnitTest++_src/UnitTest++.h"
+
+#include "../gVideo/video.hpp"
+#include "../gMath/datatype.hpp"
+#include "instance_buffer.hpp"
+#include "mesh.hpp"
+#include "orientable.hpp"
+
+using namespace gfx;
+
+namespace {
+    /* A field of props, each placed, turned and scaled differently. */
+    std::vector<orientable*>    props( size_t const count )
+    {
+        std::vector<orientable*> field;
+        for ( size_t n = 0; n < count; ++n ) {
+            float const f = float( n );
+            field.push_back( new orientable( orientable::settings()
+                                             .position( vec3( f, 2.0f - f, 0.5f * f ) )
+                                             .rotation( qutn::rotation( vec3( 0.0f, 1.0f, 0.0f ),
+                                                                        d_angle::in_degs( 7.0 * f ) ) )
+                                             .scale( vec3( 1.0f + 0.1f * f ) ) ) );
+        }
+        return field;
+    }
+
+    /*
+     * Buffer names handed back out as soon as they are freed, as drivers
+     * do; the null backend never reuses a name by itself.
+     */
+    void ( CODEGEN_FUNCPTR *fresh_buffers )( GLsizei, GLuint* ) = 0;
+    std::vector<GLuint>     freed_buffers;
+
+    void CODEGEN_FUNCPTR    reuse_gen_buffers( GLsizei n, GLuint* names )
+    {
+        for ( GLsizei i = 0; i < n; ++i ) {
+            if ( freed_buffers.empty() ) {
+                fresh_buffers( 1, &names[i] );
+            } else {
+                names[i] = freed_buffers.back();
+                freed_buffers.pop_back();
+            }
+        }
+    }
+
+    void CODEGEN_FUNCPTR    reuse_delete_buffers( GLsizei n, GLuint const* names )
+    {
+        freed_buffers.insert( freed_buffers.end(), names, names + n );
+    }
+}
+
+SUITE( InstanceBufferTests )
+{
+    TEST( Layout )
+    {
+        CHECK_THROW( instance_buffer::settings().attribute( 0 ), std::invalid_argument );
+        CHECK_THROW( instance_buffer::settings().attribute( 5 ), std::invalid_argument );
+        CHECK_THROW( instance_buffer::settings().transforms().affine_transforms(), std::logic_error );
+        CHECK_THROW( instance_buffer::settings().colors().colors(), std::logic_error );
+
+        gl_backend::use_null();
+        context test_cntx ( ( context::settings() ) );
+
+        CHECK_THROW( instance_buffer(), std::invalid_argument );
+        CHECK_THROW( instance_buffer( instance_buffer::settings()
+                                      .location( 10 )
+                                      .transforms()
+                                      .colors()
+                                      .attribute( 2 )
+                                      .attribute( 1 ) ), std::invalid_argument );
+
+        instance_buffer set ( instance_buffer::settings()
+                              .location( 2 )
+                              .affine_transforms()
+                              .colors()
+                              .attribute( 2 ) );
+        CHECK_EQUAL( 3u, set.fields() );
+        CHECK_EQUAL( 18u, set.stride() );
+        CHECK_EQUAL( 2u, set.location( 0 ) );
+        CHECK_EQUAL( 5u, set.location( 1 ) );
+        CHECK_EQUAL( 6u, set.location( 2 ) );
+        CHECK_THROW( set.location( 3 ), std::out_of_range );
+    }
+
+    TEST( TransformsMatchTheObjects )
+    {
+        gl_backend::use_null();
+        context test_cntx ( ( context::settings() ) );
+
+        std::vector<orientable*> field = props( 9 );
+        instance_buffer whole ( instance_buffer::settings()
+                                .transforms() );
+        whole.load_transforms( field );
+        CHECK_EQUAL( 9u, whole.instances() );
+        bool same = true;
+        for ( size_t n = 0; n < field.size(); ++n ) {
+            mat4 const& matrix = field[n]->object_matrix();
+            for ( size_t e = 0; e < 16; ++e ) {
+                same = same and whole.instance_data()[n * 16 + e] == matrix( e / 4, e % 4 );
+            }
+        }
+        CHECK( same );
+
+        // Composing from streams gives the same records
+        std::vector<float> stream ( 10 * field.size() );
+        orientable::streams in;
+        for ( size_t c = 0; c < 10; ++c ) {
+            float* part = &stream[c * field.size()];
+            if ( c < 3 ) { in.position[c] = part; }
+            else if ( c < 7 ) { in.rotation[c - 3] = part; }
+            else { in.scale[c - 7] = part; }
+        }
+        for ( size_t n = 0; n < field.size(); ++n ) {
+            for ( size_t c = 0; c < 3; ++c ) {
+                stream[c * field.size() + n] = field[n]->position()[c];
+                stream[( c + 7 ) * field.size() + n] = field[n]->scale()[c];
+            }
+            for ( size_t c = 0; c < 4; ++c ) {
+                stream[( c + 3 ) * field.size() + n] = field[n]->rotation()[c];
+            }
+        }
+        instance_buffer composed ( instance_buffer::settings()
+                                   .transforms() );
+        composed.load_transforms( in, field.size() );
+        CHECK_ARRAY_CLOSE( &whole.instance_data()[0], &composed.instance_data()[0],
+                           int( whole.instance_data().size() ), 1.0e-5f );
+
+        // Affine records hold the top three rows beside the colour
+        instance_buffer affine ( instance_buffer::settings()
+                                 .colors()
+                                 .affine_transforms() );
+        affine.load_transforms( in, field.size() );
+        affine.load_colors( std::vector<vec4>( field.size(), vec4( 0.25f, 0.5f, 0.75f, 1.0f ) ) );
+        CHECK_EQUAL( 16u, affine.stride() );
+        bool rows = true;
+        for ( size_t n = 0; n < field.size(); ++n ) {
+            float const* rec = &affine.instance_data()[n * 16];
+            mat4 const& matrix = field[n]->object_matrix();
+            rows = rows and rec[0] == 0.25f and rec[3] == 1.0f;
+            for ( size_t row = 0; row < 3; ++row ) {
+                for ( size_t col = 0; col < 4; ++col ) {
+                    float const diff = rec[4 + row * 4 + col] - matrix( col, row );
+                    rows = rows and diff < 1.0e-5f and diff > -1.0e-5f;
+                }
+            }
+        }
+        CHECK( rows );
+
+        float const heights[3] = { 1.0f, 2.0f, 3.0f };
+        instance_buffer custom ( instance_buffer::settings()
+                                 .attribute( 1 ) );
+        CHECK_THROW( custom.load_transforms( field ), std::logic_error );
+        CHECK_THROW( custom.load_attribute( 1, heights, 3 ), std::out_of_range );
+        custom.load_attribute( 0, heights, 3 );
+        CHECK_EQUAL( 3u, custom.instances() );
+        CHECK_ARRAY_EQUAL( heights, &custom.instance_data()[0], 3 );
+
+        for ( size_t n = 0; n < field.size(); ++n ) {
+            delete field[n];
+        }
+    }
+
+    TEST( OneDrawCallAMesh )
+    {
+        gl_backend::use_null();
+        context test_cntx ( ( context::settings() ) );
+
+        mesh& shape = mesh::acquire( mesh::settings().sphere( 8, 16 ) );
+        std::vector<orientable*> field = props( 1000 );
+        instance_buffer set ( instance_buffer::settings()
+                              .transforms()
+                              .colors()
+                              .capacity( 1000 ) );
+        set.load_transforms( field );
+        set.load_colors( std::vector<vec4>( field.size(), vec4( 1.0f ) ) );
+
+        gl_backend::recording( true );
+        gl_backend::reset_stats();
+        set.draw( shape );
+        CHECK_EQUAL( 1u, gl_backend::stats( "DrawElementsInstanced" ).calls );
+        CHECK_EQUAL( 0u, gl_backend::stats( "DrawElements" ).calls );
+        CHECK_EQUAL( 1u, gl_backend::stats( "BufferData" ).calls );
+        CHECK_EQUAL( 5u, gl_backend::stats( "VertexAttribDivisor" ).calls );
+
+        // The vertex array keeps its pointers and nothing is re-uploaded
+        set.draw( shape );
+        CHECK_EQUAL( 2u, gl_backend::stats( "DrawElementsInstanced" ).calls );
+        CHECK_EQUAL( 1u, gl_backend::stats( "BufferData" ).calls );
+        CHECK_EQUAL( 5u, gl_backend::stats( "VertexAttribDivisor" ).calls );
+
+        set.load_transforms( field );
+        set.draw( shape );
+        CHECK_EQUAL( 2u, gl_backend::stats( "BufferData" ).calls );
+        CHECK_EQUAL( 5u, gl_backend::stats( "VertexAttribDivisor" ).calls );
+
+        // A buffer laid out differently points the vertex array again
+        instance_buffer other ( instance_buffer::settings()
+                                .transforms() );
+        other.load_transforms( field );
+        other.draw( shape );
+        CHECK_EQUAL( 9u, gl_backend::stats( "VertexAttribDivisor" ).calls );
+        gl_backend::recording( false );
+
+        instance_buffer early ( instance_buffer::settings()
+                                .location( 0 )
+                                .transforms() );
+        CHECK_THROW( early.draw( shape ), std::invalid_argument );
+
+        for ( size_t n = 0; n < field.size(); ++n ) {
+            delete field[n];
+        }
+        mesh::release( shape );
+    }
+
+    TEST( ReusedNamesAttachAgain )
+    {
+        gl_backend::use_null();
+        context test_cntx ( ( context::settings() ) );
+
+        mesh& shape = mesh::acquire( mesh::settings().sphere( 8, 16 ) );
+        std::vector<orientable*> field = props( 10 );
+        gl_backend::recording( true );
+        gl_backend::reset_stats();
+        fresh_buffers = gl::GenBuffers;
+        void ( CODEGEN_FUNCPTR *real_delete )( GLsizei, GLuint const* ) = gl::DeleteBuffers;
+        gl::GenBuffers = &reuse_gen_buffers;
+        gl::DeleteBuffers = &reuse_delete_buffers;
+
+        instance_buffer* first = new instance_buffer( instance_buffer::settings()
+                                                      .transforms() );
+        first->load_transforms( field );
+        first->draw( shape );
+        CHECK_EQUAL( 4u, gl_backend::stats( "VertexAttribDivisor" ).calls );
+        delete first;
+
+        // The same name and layout, but new storage to point at
+        instance_buffer second ( instance_buffer::settings()
+                                 .transforms() );
+        CHECK( freed_buffers.empty() );
+        second.load_transforms( field );
+        second.draw( shape );
+        CHECK_EQUAL( 8u, gl_backend::stats( "VertexAttribDivisor" ).calls );
+
+        gl::GenBuffers = fresh_buffers;
+        gl::DeleteBuffers = real_delete;
+        gl_backend::recording( false );
+        for ( size_t n = 0; n < field.size(); ++n ) {
+            delete field[n];
+        }
+        mesh::release( shape );
+    }
+}
+
+int main( int argc, char* argv[] )
+{
+    video_system::get().initialize( video_system::settings().ver( 3, 3 ) );
+    return UnitTest::RunAllTests();
+}
@@ -13,15 +13,39 @@ namespace gfx {
     /**
      * \brief Upload this light as a uniform to the given
      * \ref gfx::program "program".
-     * \todo The uniform class and programs aren't smart enough, yet,
-     * for this to work properly. Some shenanigans using an updated
-     * \ref gfx::info "info" and \ref gfx::type "type" system is needed.
+     * 
+     * The field handles are resolved on the first upload and reused
+     * afterwards.
      */
     void        light::upload_uniform( program& prgm,
                                        std::string const& name )
     {
+        static char const* const fields[] = { ".rad" };
         check_program( prgm );
-        prgm.upload_uniform( name + ".rad", rad );
+        uniform_handle const* field = handles.resolve( prgm, name, fields, 1 );
+        prgm.upload_uniform( field[0], rad );
+    }
+    /**
+     * \brief Return the std140 layout of the light struct, for declaring
+     * lights in a uniform block.
+     * \return The layout of the light struct
+     */
+    std140_block const&     light::layout()
+    {
+        static std140_block const fields = std140_block()
+                                           .member<float>( "rad" );
+        return fields;
+    }
+    /**
+     * \brief Write the light into a uniform block laid out with
+     * \ref layout() "layout()".
+     * \param block The block to write into
+     * \param member The index of the first field of the light in the block
+     */
+    void        light::serialize( std140_block& block,
+                                  size_t const member ) const
+    {
+        block.write( member, rad );
     }
     /**
      * \brief Set the radiance to the given value.
@@ -74,21 +98,44 @@ namespace gfx {
     /**
      * \brief Upload this point light as a uniform to the given
      * \ref gfx::program "program".
-     * \todo The uniform class and programs aren't smart enough, yet,
-     * for this to work properly. Some shenanigans using an updated
-     * \ref gfx::info "info" and \ref gfx::type "type" system is needed.
+     * 
+     * The field handles are resolved on the first upload and reused
+     * afterwards.
      */
     void        point_light::upload_uniform( program& prgm,
                                               std::string const& name )
     {
-        //std::cout << "Mark2" << std::endl;
-        //std::cout << name << std::endl;
-        //check_program( prgm );
-        //std::string rad_name = name + ".rad";
-        prgm.upload_uniform( name + ".rad", rad );
-        //checkGLError( "Loaded uniform light.rad" );
-        prgm.upload_uniform( name + ".pos", pos );
-        prgm.upload_uniform( name + ".col", col );
+        static char const* const fields[] = { ".rad", ".pos", ".col" };
+        uniform_handle const* field = handles.resolve( prgm, name, fields, 3 );
+        prgm.upload_uniform( field[0], rad );
+        prgm.upload_uniform( field[1], pos );
+        prgm.upload_uniform( field[2], col );
+    }
+    /**
+     * \brief Return the std140 layout of the point light struct, for declaring
+     * point lights in a uniform block.
+     * \return The layout of the point light struct
+     */
+    std140_block const&     point_light::layout()
+    {
+        static std140_block const fields = std140_block()
+                                           .member<float>( "rad" )
+                                           .member<vec3>( "pos" )
+                                           .member<vec3>( "col" );
+        return fields;
+    }
+    /**
+     * \brief Write the point light into a uniform block laid out with
+     * \ref layout() "layout()".
+     * \param block The block to write into
+     * \param member The index of the first field of the point light in the block
+     */
+    void        point_light::serialize( std140_block& block,
+                                        size_t const member ) const
+    {
+        block.write( member, rad );
+        block.write( member + 1, pos );
+        block.write( member + 2, col );
     }
     /**
      * \brief Construct a new spherical light object.
@@ -141,18 +188,48 @@ namespace gfx {
     /**
      * \brief Upload this spherical light as a uniform to the given
      * \ref gfx::program "program".
-     * \todo The uniform class and programs aren't smart enough, yet,
-     * for this to work properly. Some shenanigans using an updated
-     * \ref gfx::info "info" and \ref gfx::type "type" system is needed.
+     * 
+     * The field handles are resolved on the first upload and reused
+     * afterwards.
      */
     void        sphere_light::upload_uniform( program& prgm,
                                               std::string const& name )
     {
+        static char const* const fields[] = { ".rad", ".pos", ".col", ".rd" };
         check_program( prgm );
-        prgm.upload_uniform( name + ".rad", rad );
-        prgm.upload_uniform( name + ".pos", pos );
-        prgm.upload_uniform( name + ".col", col );
-        prgm.upload_uniform( name + ".rd", rd );
+        uniform_handle const* field = handles.resolve( prgm, name, fields, 4 );
+        prgm.upload_uniform( field[0], rad );
+        prgm.upload_uniform( field[1], pos );
+        prgm.upload_uniform( field[2], col );
+        prgm.upload_uniform( field[3], rd );
+    }
+    /**
+     * \brief Return the std140 layout of the spherical light struct, for declaring
+     * spherical lights in a uniform block.
+     * \return The layout of the spherical light struct
+     */
+    std140_block const&     sphere_light::layout()
+    {
+        static std140_block const fields = std140_block()
+                                           .member<float>( "rad" )
+                                           .member<vec3>( "pos" )
+                                           .member<vec3>( "col" )
+                                           .member<float>( "rd" );
+        return fields;
+    }
+    /**
+     * \brief Write the spherical light into a uniform block laid out with
+     * \ref layout() "layout()".
+     * \param block The block to write into
+     * \param member The index of the first field of the spherical light in the block
+     */
+    void        sphere_light::serialize( std140_block& block,
+                                         size_t const member ) const
+    {
+        block.write( member, rad );
+        block.write( member + 1, pos );
+        block.write( member + 2, col );
+        block.write( member + 3, rd );
     }
     /**
      * \brief Construct a new spot light object.
@@ -232,20 +309,57 @@ namespace gfx {
     /**
      * \brief Upload this spot light as a uniform to the given
      * \ref gfx::program "program".
-     * \todo The uniform class and programs aren't smart enough, yet,
-     * for this to work properly. Some shenanigans using an updated
-     * \ref gfx::info "info" and \ref gfx::type "type" system is needed.
+     * 
+     * The field handles are resolved on the first upload and reused
+     * afterwards.
      */
     void        spot_light::upload_uniform( program& prgm,
                                             std::string const& name )
     {
+        static char const* const fields[] = { ".rad", ".pos", ".dir",
+                                              ".col", ".swp", ".rd" };
         check_program( prgm );
-        prgm.upload_uniform( name + ".rad", rad );
-        prgm.upload_uniform( name + ".pos", pos );
-        prgm.upload_uniform( name + ".dir", dir );
-        prgm.upload_uniform( name + ".col", col );
-        prgm.upload_uniform( name + ".swp", swp );
-        prgm.upload_uniform( name + ".rd", rd );
+        uniform_handle const* field = handles.resolve( prgm, name, fields, 6 );
+        prgm.upload_uniform( field[0], rad );
+        prgm.upload_uniform( field[1], pos );
+        prgm.upload_uniform( field[2], dir );
+        prgm.upload_uniform( field[3], col );
+        prgm.upload_uniform( field[4], swp );
+        prgm.upload_uniform( field[5], rd );
+    }
+    /**
+     * \brief Return the std140 layout of the spot light struct, for declaring
+     * spot lights in a uniform block.
+     * \return The layout of the spot light struct
+     */
+    std140_block const&     spot_light::layout()
+    {
+        static std140_block const fields = std140_block()
+                                           .member<float>( "rad" )
+                                           .member<vec3>( "pos" )
+                                           .member<vec3>( "dir" )
+                                           .member<vec3>( "col" )
+                                           .member<float>( "swp" )
+                                           .member<float>( "rd" );
+        return fields;
+    }
+    /**
+     * \brief Write the spot light into a uniform block laid out with
+     * \ref layout() "layout()".
+     *
+     * The sweep is written in radians.
+     * \param block The block to write into
+     * \param member The index of the first field of the spot light in the block
+     */
+    void        spot_light::serialize( std140_block& block,
+                                       size_t const member ) const
+    {
+        block.write( member, rad );
+        block.write( member + 1, pos );
+        block.write( member + 2, dir );
+        block.write( member + 3, col );
+        block.write( member + 4, swp.to_rads() );
+        block.write( member + 5, rd );
     }
     /**
      * \brief Construct a new point light object.
@@ -284,16 +398,44 @@ namespace gfx {
     /**
      * \brief Upload this sun light as a uniform to the given
      * \ref gfx::program "program".
-     * \todo The uniform class and programs aren't smart enough, yet,
-     * for this to work properly. Some shenanigans using an updated
-     * \ref gfx::info "info" and \ref gfx::type "type" system is needed.
+     * 
+     * The field handles are resolved on the first upload and reused
+     * afterwards.
      */
     void        sun_light::upload_uniform( program& prgm,
                                            std::string const& name )
     {
+        static char const* const fields[] = { ".rad", ".dir", ".col" };
         check_program( prgm );
-        prgm.upload_uniform( name + ".rad", rad );
-        prgm.upload_uniform( name + ".dir", dir );
-        prgm.upload_uniform( name + ".col", col );
+        uniform_handle const* field = handles.resolve( prgm, name, fields, 3 );
+        prgm.upload_uniform( field[0], rad );
+        prgm.upload_uniform( field[1], dir );
+        prgm.upload_uniform( field[2], col );
+    }
+    /**
+     * \brief Return the std140 layout of the sun light struct, for declaring
+     * sun lights in a uniform block.
+     * \return The layout of the sun light struct
+     */
+    std140_block const&     sun_light::layout()
+    {
+        static std140_block const fields = std140_block()
+                                           .member<float>( "rad" )
+                                           .member<vec3>( "dir" )
+                                           .member<vec3>( "col" );
+        return fields;
+    }
+    /**
+     * \brief Write the sun light into a uniform block laid out with
+     * \ref layout() "layout()".
+     * \param block The block to write into
+     * \param member The index of the first field of the sun light in the block
+     */
+    void        sun_light::serialize( std140_block& block,
+                                      size_t const member ) const
+    {
+        block.write( member, rad );
+        block.write( member + 1, dir );
+        block.write( member + 2, col );
     }
 }
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include "../gMath/constant.hpp"
 #include "../gMath/datatype.hpp"
 #include "uniform.hpp"
+#include "std140.hpp"
 
 namespace gfx {
     
@@ -28,9 +29,13 @@ namespace gfx {
                                         std::string const& name );
         light&          radiance( float rad );
         float           radiance() const;
+        static std140_block const&  layout();
+        virtual void    serialize( std140_block& block,
+                                   size_t const member ) const;
 
     protected:
         float           rad;
+        uniform_cache   handles;
     };
     
     /*
@@ -68,6 +73,9 @@ namespace gfx {
         vec3 const&     color() const;
         virtual void    upload_uniform( program& prgm,
                                         std::string const& name );
+        static std140_block const&  layout();
+        virtual void    serialize( std140_block& block,
+                                   size_t const member ) const;
     protected:
         vec3            pos;
         vec3            col;
@@ -155,6 +163,9 @@ namespace gfx {
         float           radius() const;
         virtual void    upload_uniform( program& prgm,
                                         std::string const& name );
+        static std140_block const&  layout();
+        virtual void    serialize( std140_block& block,
+                                   size_t const member ) const;
     protected:
         vec3            pos;
         vec3            col;
@@ -256,6 +267,9 @@ namespace gfx {
         float           radius() const;
         virtual void    upload_uniform( program& prgm,
                                         std::string const& name );
+        static std140_block const&  layout();
+        virtual void    serialize( std140_block& block,
+                                   size_t const member ) const;
     protected:
         vec3            pos;
         vec3            dir;
@@ -362,6 +376,9 @@ namespace gfx {
         vec3 const&     color() const;
         virtual void    upload_uniform( program& prgm,
                                         std::string const& name );
+        static std140_block const&  layout();
+        virtual void    serialize( std140_block& block,
+                                   size_t const member ) const;
     protected:
         vec3            dir;
         vec3            col;
@@ -0,0 +1,541 @@
+#include "light_clusters.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#include "../gMath/constant.hpp"
+#include "gl_state.hpp"
+#include "program.hpp"
+#include "texture_units.hpp"
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+namespace gfx {
+
+    namespace {
+        float const     half_turn = lit<float>::pi;
+
+        void    column_major( mat4 const& matrix, float* out )
+        {
+            for ( size_t col = 0; col < 4; ++col ) {
+                for ( size_t row = 0; row < 4; ++row ) {
+                    out[col * 4 + row] = matrix( col, row );
+                }
+            }
+        }
+
+        /* How far a light shines before its radiance falls to the cutoff. */
+        float   reach( float const rad, float const cutoff )
+        {
+            return rad > 0.0f ? std::sqrt( rad / cutoff ) : 0.0f;
+        }
+
+        /* Write a row of the matrix less a part of its w row, scaled so it gives distances. */
+        void    plane( float const* m, size_t const row, float const at, float* out )
+        {
+            float eq[4];
+            for ( size_t col = 0; col < 4; ++col ) {
+                eq[col] = m[col * 4 + row] - at * m[col * 4 + 3];
+            }
+            float length = std::sqrt( eq[0] * eq[0] + eq[1] * eq[1] + eq[2] * eq[2] );
+            if ( length == 0.0f ) { length = 1.0f; }
+            for ( size_t n = 0; n < 4; ++n ) {
+                out[n] = eq[n] / length;
+            }
+        }
+
+#ifdef __SSE__
+        __m128  pick( __m128 const mask, __m128 const yes, __m128 const no )
+        {
+            return _mm_or_ps( _mm_and_ps( mask, yes ), _mm_andnot_ps( mask, no ) );
+        }
+
+        /*
+         * First and last slab between consecutive planes that each of four
+         * spheres may touch; a sphere that touches none gets first > last.
+         */
+        void    slabs( float const* planes, size_t const count,
+                       __m128 const x, __m128 const y, __m128 const z, __m128 const r,
+                       float* first, float* last )
+        {
+            __m128 const reach_out = _mm_sub_ps( _mm_setzero_ps(), r );
+            __m128 lo = _mm_set1_ps( float( count ) );
+            __m128 hi = _mm_set1_ps( -1.0f );
+            __m128 below = _mm_add_ps( _mm_add_ps( _mm_mul_ps( x, _mm_set1_ps( planes[0] ) ),
+                                                   _mm_mul_ps( y, _mm_set1_ps( planes[1] ) ) ),
+                                       _mm_add_ps( _mm_mul_ps( z, _mm_set1_ps( planes[2] ) ),
+                                                   _mm_set1_ps( planes[3] ) ) );
+            for ( size_t i = 0; i < count; ++i ) {
+                float const* next = planes + ( i + 1 ) * 4;
+                __m128 const above = _mm_add_ps( _mm_add_ps( _mm_mul_ps( x, _mm_set1_ps( next[0] ) ),
+                                                             _mm_mul_ps( y, _mm_set1_ps( next[1] ) ) ),
+                                                 _mm_add_ps( _mm_mul_ps( z, _mm_set1_ps( next[2] ) ),
+                                                             _mm_set1_ps( next[3] ) ) );
+                __m128 const touch = _mm_and_ps( _mm_cmpge_ps( below, reach_out ),
+                                                 _mm_cmple_ps( above, r ) );
+                __m128 const slab = _mm_set1_ps( float( i ) );
+                lo = _mm_min_ps( lo, pick( touch, slab, lo ) );
+                hi = _mm_max_ps( hi, pick( touch, slab, hi ) );
+                below = above;
+            }
+            _mm_storeu_ps( first, lo );
+            _mm_storeu_ps( last, hi );
+        }
+#else
+        void    slabs( float const* planes, size_t const count,
+                       float const x, float const y, float const z, float const r,
+                       float* first, float* last )
+        {
+            *first = float( count );
+            *last = -1.0f;
+            float below = planes[0] * x + planes[1] * y + planes[2] * z + planes[3];
+            for ( size_t i = 0; i < count; ++i ) {
+                float const* next = planes + ( i + 1 ) * 4;
+                float const above = next[0] * x + next[1] * y + next[2] * z + next[3];
+                if ( below >= -r and above <= r ) {
+                    *first = std::min( *first, float( i ) );
+                    *last = float( i );
+                }
+                below = above;
+            }
+        }
+#endif
+    }
+
+    /**
+     * \brief Construct a new, empty set of light clusters.
+     *
+     * No OpenGL objects are made until the first \ref upload() "upload()".
+     * \param set The settings for the clusters
+     */
+    light_clusters::light_clusters( settings const& set ) :
+                                    grid_x ( set.grid_x_v ),
+                                    grid_y ( set.grid_y_v ),
+                                    grid_z ( set.grid_z_v ),
+                                    cutoff_v ( set.cutoff_v ),
+                                    threads_v ( set.threads_v ),
+                                    near_v ( 1.0f ),
+                                    far_v ( 2.0f ),
+                                    depth_scale ( 0.0f ),
+                                    depth_bias ( 0.0f ),
+                                    depth_stretch ( 1.0f ),
+                                    planes ( ( grid_x + grid_y + 2 ) * 4, 0.0f ),
+                                    table ( grid_x * grid_y * grid_z * 2, 0 ),
+                                    light_buff ( 0 ),
+                                    light_tex ( 0 ),
+                                    cluster_buff ( 0 ),
+                                    cluster_tex ( 0 ),
+                                    handles ()
+    {
+        std::fill( depth_row, depth_row + 4, 0.0f );
+    }
+    /**
+     * \brief Destroy the light clusters and their buffer textures.
+     */
+    light_clusters::~light_clusters()
+    {
+        if ( light_buff != 0 ) {
+            texture_units::forget_texture( light_tex );
+            texture_units::forget_texture( cluster_tex );
+            gl::DeleteTextures( 1, &light_tex );
+            gl::DeleteTextures( 1, &cluster_tex );
+            gl_state::forget_buffer( light_buff );
+            gl_state::forget_buffer( cluster_buff );
+            gl::DeleteBuffers( 1, &light_buff );
+            gl::DeleteBuffers( 1, &cluster_buff );
+        }
+    }
+    /**
+     * \brief Add a point light.
+     * \param lght The light
+     * \return The light's index in the light table
+     */
+    size_t  light_clusters::add( point_light const& lght )
+    {
+        vec3 const& pos = lght.position();
+        vec3 const& col = lght.color();
+        float const range = reach( lght.radiance(), cutoff_v );
+        float const texels[16] = { pos[0], pos[1], pos[2], range,
+                                   col[0], col[1], col[2], lght.radiance(),
+                                   0.0f, 0.0f, 0.0f, -1.0f,
+                                   0.0f, 0.0f, 0.0f, 0.0f };
+        return add( texels, pos, range );
+    }
+    /**
+     * \brief Add a sphere light.
+     *
+     * The light's reach is measured from the surface of the sphere.
+     * \param lght The light
+     * \return The light's index in the light table
+     */
+    size_t  light_clusters::add( sphere_light const& lght )
+    {
+        vec3 const& pos = lght.position();
+        vec3 const& col = lght.color();
+        float const range = lght.radius() + reach( lght.radiance(), cutoff_v );
+        float const texels[16] = { pos[0], pos[1], pos[2], range,
+                                   col[0], col[1], col[2], lght.radiance(),
+                                   0.0f, 0.0f, 0.0f, -1.0f,
+                                   lght.radius(), 1.0f, 0.0f, 0.0f };
+        return add( texels, pos, range );
+    }
+    /**
+     * \brief Add a spot light.
+     *
+     * The light is bounded by the smallest sphere around its cone, grown
+     * by the radius of the light.
+     * \param lght The light
+     * \return The light's index in the light table
+     */
+    size_t  light_clusters::add( spot_light const& lght )
+    {
+        vec3 const& pos = lght.position();
+        vec3 const& col = lght.color();
+        vec3 dir ( lght.direction() );
+        float const length = std::sqrt( dir[0] * dir[0] + dir[1] * dir[1] + dir[2] * dir[2] );
+        float const sweep = std::min( std::fabs( float( lght.sweep().to_rads() ) ), half_turn );
+        float const far_end = reach( lght.radiance(), cutoff_v );
+        float const range = lght.radius() + far_end;
+        float along = 0.0f;
+        float around = far_end;
+        if ( length == 0.0f or sweep >= half_turn * 0.5f ) {
+            // Shines over a hemisphere or more, so bounded like a point
+            if ( length != 0.0f ) { dir.norm(); }
+        } else {
+            dir.norm();
+            if ( sweep > half_turn * 0.25f ) {
+                // The widest circle across the cone is its rim
+                along = std::cos( sweep ) * far_end;
+                around = std::sin( sweep ) * far_end;
+            } else {
+                along = far_end / ( 2.0f * std::cos( sweep ) );
+                around = along;
+            }
+        }
+        float const texels[16] = { pos[0], pos[1], pos[2], range,
+                                   col[0], col[1], col[2], lght.radiance(),
+                                   dir[0], dir[1], dir[2], std::cos( sweep ),
+                                   lght.radius(), 2.0f, 0.0f, 0.0f };
+        return add( texels,
+                    vec3( pos[0] + dir[0] * along,
+                          pos[1] + dir[1] * along,
+                          pos[2] + dir[2] * along ),
+                    around + lght.radius() );
+    }
+    /**
+     * \brief Remove every light, as at the start of a new frame.
+     *
+     * The cluster table is left as it is until the next
+     * \ref assign() "assign()".
+     */
+    void    light_clusters::clear()
+    {
+        light_v.clear();
+        sphere_x.clear();
+        sphere_y.clear();
+        sphere_z.clear();
+        sphere_r.clear();
+    }
+    /**
+     * \brief Sort the lights into the clusters of a camera's frustum.
+     *
+     * A camera's view matrix already has its projection folded in, as a
+     * \ref gfx::proj_cam "proj_cam" keeps it.
+     * \param cam The camera
+     */
+    void    light_clusters::assign( proj_cam& cam )
+    {
+        assign( cam.view_matrix(), float( cam.near_plane() ), float( cam.far_plane() ) );
+    }
+    /**
+     * \brief Sort the lights into the clusters of a frustum.
+     *
+     * The projection must be a perspective one, with w the distance in
+     * front of the eye.
+     * \param view_projection The combined view and projection matrix
+     * \param near The distance to the near plane
+     * \param far The distance to the far plane
+     * \exception std::invalid_argument If the planes are out of order or
+     * the near plane is not in front of the eye
+     */
+    void    light_clusters::assign( mat4 const& view_projection,
+                                    float const near,
+                                    float const far )
+    {
+        if ( not ( near > 0.0f and far > near ) ) {
+            throw std::invalid_argument( "Light clusters need a near plane in front of the eye and a far plane beyond it." );
+        }
+        near_v = near;
+        far_v = far;
+        depth_scale = float( grid_z ) / std::log( far / near );
+        depth_bias = std::log( near ) * depth_scale;
+
+        float m[16];
+        column_major( view_projection, m );
+        for ( size_t i = 0; i <= grid_x; ++i ) {
+            plane( m, 0, -1.0f + 2.0f * float( i ) / float( grid_x ), &planes[i * 4] );
+        }
+        for ( size_t i = 0; i <= grid_y; ++i ) {
+            plane( m, 1, -1.0f + 2.0f * float( i ) / float( grid_y ), &planes[( grid_x + 1 + i ) * 4] );
+        }
+        for ( size_t col = 0; col < 4; ++col ) {
+            depth_row[col] = m[col * 4 + 3];
+        }
+        depth_stretch = std::sqrt( depth_row[0] * depth_row[0]
+                                   + depth_row[1] * depth_row[1]
+                                   + depth_row[2] * depth_row[2] );
+
+        size_t const count = lights();
+        size_t const padded = ( count + 3 ) / 4 * 4;
+        sphere_x.resize( padded, 0.0f );
+        sphere_y.resize( padded, 0.0f );
+        sphere_z.resize( padded, 0.0f );
+        sphere_r.resize( padded, 0.0f );
+        ranges.resize( count * 6 );
+
+        // Bound the lights in runs of four, a share of runs to a thread
+        size_t threads = std::max( size_t( 1 ), std::min( threads_v, padded / 64 ) );
+        size_t const per_thread = ( padded / 4 + threads - 1 ) / threads * 4;
+        std::vector<std::thread> workers;
+        workers.reserve( threads_v );
+        for ( size_t t = 1; t < threads; ++t ) {
+            size_t const begin = std::min( t * per_thread, padded );
+            size_t const end = std::min( begin + per_thread, padded );
+            workers.push_back( std::thread( &light_clusters::bound_lights, this, begin, end ) );
+        }
+        bound_lights( 0, std::min( per_thread, padded ) );
+        for ( size_t t = 0; t < workers.size(); ++t ) {
+            workers[t].join();
+        }
+        workers.clear();
+        sphere_x.resize( count );
+        sphere_y.resize( count );
+        sphere_z.resize( count );
+        sphere_r.resize( count );
+
+        // Count each cluster's lights, lay the lists out, then fill them
+        size_t const cells = clusters();
+        table.assign( cells * 2, 0 );
+        threads = std::max( size_t( 1 ), std::min( threads_v, grid_z ) );
+        for ( size_t t = 1; t < threads; ++t ) {
+            workers.push_back( std::thread( &light_clusters::count_slices, this, t, threads ) );
+        }
+        count_slices( 0, threads );
+        for ( size_t t = 0; t < workers.size(); ++t ) {
+            workers[t].join();
+        }
+        workers.clear();
+        GLuint offset = 0;
+        for ( size_t c = 0; c < cells; ++c ) {
+            table[c * 2] = offset;
+            offset += table[c * 2 + 1];
+        }
+        table.resize( cells * 2 + offset );
+        for ( size_t t = 1; t < threads; ++t ) {
+            workers.push_back( std::thread( &light_clusters::fill_slices, this, t, threads ) );
+        }
+        fill_slices( 0, threads );
+        for ( size_t t = 0; t < workers.size(); ++t ) {
+            workers[t].join();
+        }
+    }
+    /**
+     * \brief Write the light and cluster tables into their buffer
+     * textures, making them on the first call.
+     *
+     * Needs a current context.
+     */
+    void    light_clusters::upload()
+    {
+        gl_state& state = gl_state::current();
+        bool const fresh = light_buff == 0;
+        if ( fresh ) {
+            gl::GenBuffers( 1, &light_buff );
+            gl::GenBuffers( 1, &cluster_buff );
+            gl::GenTextures( 1, &light_tex );
+            gl::GenTextures( 1, &cluster_tex );
+        }
+        state.bind_buffer( gl::TEXTURE_BUFFER, light_buff );
+        gl::BufferData( gl::TEXTURE_BUFFER,
+                        GLsizeiptr( light_v.size() * sizeof( float ) ),
+                        light_v.empty() ? 0 : &light_v[0],
+                        gl::STREAM_DRAW );
+        state.bind_buffer( gl::TEXTURE_BUFFER, cluster_buff );
+        gl::BufferData( gl::TEXTURE_BUFFER,
+                        GLsizeiptr( table.size() * sizeof( GLuint ) ),
+                        &table[0],
+                        gl::STREAM_DRAW );
+        if ( fresh ) {
+            texture_units& units = texture_units::current();
+            units.edit( light_tex, gl::TEXTURE_BUFFER );
+            gl::TexBuffer( gl::TEXTURE_BUFFER, gl::RGBA32F, light_buff );
+            units.edit( cluster_tex, gl::TEXTURE_BUFFER );
+            gl::TexBuffer( gl::TEXTURE_BUFFER, gl::R32UI, cluster_buff );
+        }
+    }
+    /**
+     * \brief Bind the buffer textures for the current draw and upload the
+     * grid to a struct uniform of the given program.
+     *
+     * The program must be in use, and the tables must have been
+     * \ref upload() "uploaded".
+     * \param prgm The program shading with the lights
+     * \param name The name of the struct in the shader source
+     * \exception std::logic_error If the tables were never uploaded
+     */
+    void    light_clusters::upload_uniform( program& prgm,
+                                            std::string const& name )
+    {
+        static char const* const fields[] = { ".grid", ".depth_scale", ".depth_bias",
+                                              ".lights", ".clusters" };
+        check_program( prgm );
+        if ( light_buff == 0 ) {
+            throw std::logic_error( "Light clusters must be uploaded before they are used." );
+        }
+        texture_units& units = texture_units::current();
+        GLuint const light_unit = units.assign( light_tex, gl::TEXTURE_BUFFER, 0 );
+        GLuint const cluster_unit = units.assign( cluster_tex, gl::TEXTURE_BUFFER, 0 );
+        uniform_handle const* field = handles.resolve( prgm, name, fields, 5 );
+        prgm.upload_uniform( field[0], uvec3( uint32_t( grid_x ),
+                                              uint32_t( grid_y ),
+                                              uint32_t( grid_z ) ) );
+        prgm.upload_uniform( field[1], depth_scale );
+        prgm.upload_uniform( field[2], depth_bias );
+        prgm.upload_uniform( field[3], (int) light_unit );
+        prgm.upload_uniform( field[4], (int) cluster_unit );
+    }
+    /*
+     * Append a light's texels and bounding sphere.
+     */
+    size_t  light_clusters::add( float const* texels,
+                                 vec3 const& center,
+                                 float const radius )
+    {
+        size_t const index = lights();
+        light_v.insert( light_v.end(), texels, texels + 16 );
+        sphere_x.push_back( center[0] );
+        sphere_y.push_back( center[1] );
+        sphere_z.push_back( center[2] );
+        sphere_r.push_back( radius );
+        return index;
+    }
+    /*
+     * Find the clusters each light in [begin, end) may touch. Both ends
+     * are multiples of four, and may run past the last light into the
+     * padding.
+     */
+    void    light_clusters::bound_lights( size_t const begin,
+                                          size_t const end )
+    {
+        size_t const count = lights();
+        float const* y_planes = &planes[( grid_x + 1 ) * 4];
+        for ( size_t n = begin; n < end; n += 4 ) {
+            float first_x[4];
+            float last_x[4];
+            float first_y[4];
+            float last_y[4];
+#ifdef __SSE__
+            __m128 const x = _mm_loadu_ps( &sphere_x[n] );
+            __m128 const y = _mm_loadu_ps( &sphere_y[n] );
+            __m128 const z = _mm_loadu_ps( &sphere_z[n] );
+            __m128 const r = _mm_loadu_ps( &sphere_r[n] );
+            slabs( &planes[0], grid_x, x, y, z, r, first_x, last_x );
+            slabs( y_planes, grid_y, x, y, z, r, first_y, last_y );
+#else
+            for ( size_t lane = 0; lane < 4; ++lane ) {
+                size_t const at = n + lane;
+                slabs( &planes[0], grid_x, sphere_x[at], sphere_y[at], sphere_z[at], sphere_r[at],
+                       first_x + lane, last_x + lane );
+                slabs( y_planes, grid_y, sphere_x[at], sphere_y[at], sphere_z[at], sphere_r[at],
+                       first_y + lane, last_y + lane );
+            }
+#endif
+            for ( size_t lane = 0; lane < 4 and n + lane < count; ++lane ) {
+                size_t const at = n + lane;
+                int* range = &ranges[at * 6];
+                float const depth = depth_row[0] * sphere_x[at] + depth_row[1] * sphere_y[at]
+                                    + depth_row[2] * sphere_z[at] + depth_row[3];
+                float const depth_reach = sphere_r[at] * depth_stretch;
+                range[0] = int( first_x[lane] );
+                range[1] = int( last_x[lane] );
+                range[2] = int( first_y[lane] );
+                range[3] = int( last_y[lane] );
+                if ( range[0] > range[1] or range[2] > range[3] or
+                     depth + depth_reach < near_v or depth - depth_reach > far_v ) {
+                    range[4] = 1;
+                    range[5] = 0;
+                } else {
+                    range[4] = int( slice( std::max( depth - depth_reach, near_v ) ) );
+                    range[5] = int( slice( std::min( depth + depth_reach, far_v ) ) );
+                }
+            }
+        }
+    }
+    /*
+     * Count the lights of the clusters in every step'th depth slice from
+     * first.
+     */
+    void    light_clusters::count_slices( size_t const first,
+                                          size_t const step )
+    {
+        size_t const count = lights();
+        for ( size_t n = 0; n < count; ++n ) {
+            int const* range = &ranges[n * 6];
+            if ( range[4] > range[5] ) { continue; }
+            size_t z = size_t( range[4] );
+            z += ( first + step - z % step ) % step;
+            for ( ; z <= size_t( range[5] ); z += step ) {
+                for ( int y = range[2]; y <= range[3]; ++y ) {
+                    size_t const row = ( z * grid_y + size_t( y ) ) * grid_x;
+                    for ( int x = range[0]; x <= range[1]; ++x ) {
+                        ++table[( row + size_t( x ) ) * 2 + 1];
+                    }
+                }
+            }
+        }
+    }
+    /*
+     * Write the light indices of the clusters in every step'th depth slice
+     * from first, once their offsets are known.
+     */
+    void    light_clusters::fill_slices( size_t const first,
+                                         size_t const step )
+    {
+        size_t const slice_size = grid_x * grid_y;
+        for ( size_t z = first; z < grid_z; z += step ) {
+            for ( size_t c = z * slice_size; c < ( z + 1 ) * slice_size; ++c ) {
+                table[c * 2 + 1] = 0;
+            }
+        }
+        GLuint* const indices = &table[0] + clusters() * 2;
+        size_t const count = lights();
+        for ( size_t n = 0; n < count; ++n ) {
+            int const* range = &ranges[n * 6];
+            if ( range[4] > range[5] ) { continue; }
+            size_t z = size_t( range[4] );
+            z += ( first + step - z % step ) % step;
+            for ( ; z <= size_t( range[5] ); z += step ) {
+                for ( int y = range[2]; y <= range[3]; ++y ) {
+                    size_t const row = ( z * grid_y + size_t( y ) ) * grid_x;
+                    for ( int x = range[0]; x <= range[1]; ++x ) {
+                        GLuint* const cell = &table[( row + size_t( x ) ) * 2];
+                        indices[cell[0] + cell[1]] = GLuint( n );
+                        ++cell[1];
+                    }
+                }
+            }
+        }
+    }
+    /*
+     * The depth slice a distance in front of the eye falls in.
+     */
+    size_t  light_clusters::slice( float const depth ) const
+    {
+        float const at = std::floor( std::log( depth ) * depth_scale - depth_bias );
+        if ( at < 0.0f ) { return 0; }
+        return std::min( size_t( at ), grid_z - 1 );
+    }
+}
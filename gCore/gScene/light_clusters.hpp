@@ -0,0 +1,255 @@
+#ifndef LIGHT_CLUSTERS_HPP
+#define LIGHT_CLUSTERS_HPP
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../gVideo/gl_core_3_3.hpp"
+#include "../gMath/datatype.hpp"
+#include "camera.hpp"
+#include "light.hpp"
+#include "uniform.hpp"
+
+namespace gfx {
+    /**
+     * \class gfx::light_clusters light_clusters.hpp "gCore/gScene/light_clusters.hpp"
+     * \brief Sorts many point, sphere and spot lights into a grid of
+     * clusters over the view frustum, so each fragment only shades the
+     * lights that can reach it.
+     *
+     * The frustum is cut into a grid of clusters: evenly across the
+     * screen, and into depth slices that grow exponentially from the near
+     * plane to the far plane. Lights are queued with \ref add() "add()"
+     * and \ref assign() "assign()" lists every light in every cluster its
+     * bounding sphere may touch. A light reaches as far as its radiance
+     * takes to fall, with the square of the distance, to the cutoff given
+     * in the settings; a spot light is bounded by a sphere around its
+     * cone, taking the sweep as the angle from the axis to the edge.
+     *
+     * The bounding spheres are measured against the planes between the
+     * clusters four lights at a time with SSE where it is available, and
+     * the lists are filled by threads that each own a share of the depth
+     * slices. Lights are always listed in the order they were added, so
+     * the tables do not depend on the number of threads. The test is
+     * conservative: a light may be listed in a cluster near its sphere it
+     * does not quite reach, but never left out of one it does.
+     *
+     * \ref upload() "upload()" writes two buffer textures, as OpenGL 3.3
+     * has no shader storage buffers:
+     *  - the lights, as four RGBA32F texels each: the position and range,
+     *    the colour and radiance, the spot direction and the cosine of the
+     *    sweep (-1 for lights that shine every way), and the radius of the
+     *    source with the kind of light (0 point, 1 sphere, 2 spot);
+     *  - the clusters, as R32UI: an offset and a count for every cluster,
+     *    numbered x + y * width + z * width * height, followed by the light
+     *    indices the offsets point into.
+     *
+     * \ref upload_uniform() "upload_uniform()" binds both and fills a
+     * struct with the fields grid (uvec3), depth_scale and depth_bias
+     * (float), lights and clusters (samplerBuffer and usamplerBuffer). A
+     * fragment's cluster is x = floor( gl_FragCoord.x / viewport width *
+     * grid.x ), likewise for y, and z = floor( log( 1.0 / gl_FragCoord.w )
+     * * depth_scale - depth_bias ).
+     */
+    class light_clusters : public uniform {
+    public:
+        /**
+         * \class gfx::light_clusters::settings
+         * \brief Used to configure a
+         * \ref gfx::light_clusters "light_clusters".
+         */
+        class settings {
+        public:
+                            settings();
+            settings&       grid( size_t const x,
+                                  size_t const y,
+                                  size_t const z );
+            settings&       cutoff( float const radiance );
+            settings&       threads( size_t const count );
+        private:
+            friend          class light_clusters;
+            size_t          grid_x_v;
+            size_t          grid_y_v;
+            size_t          grid_z_v;
+            float           cutoff_v;
+            size_t          threads_v;
+        };
+
+                            light_clusters( settings const& set = settings() );
+                            ~light_clusters();
+        size_t              add( point_light const& lght );
+        size_t              add( sphere_light const& lght );
+        size_t              add( spot_light const& lght );
+        void                clear();
+        void                assign( proj_cam& cam );
+        void                assign( mat4 const& view_projection,
+                                    float const near,
+                                    float const far );
+        void                upload();
+        virtual void        upload_uniform( program& prgm,
+                                            std::string const& name );
+        size_t              lights() const;
+        size_t              clusters() const;
+        size_t              cluster( size_t const x,
+                                     size_t const y,
+                                     size_t const z ) const;
+        size_t              references() const;
+        std::vector<float> const&   light_table() const;
+        std::vector<GLuint> const&  cluster_table() const;
+    private:
+                            light_clusters( light_clusters const& );
+        light_clusters&     operator =( light_clusters const& );
+
+        size_t              add( float const* texels,
+                                 vec3 const& center,
+                                 float const radius );
+        void                bound_lights( size_t const begin,
+                                          size_t const end );
+        void                count_slices( size_t const first,
+                                          size_t const step );
+        void                fill_slices( size_t const first,
+                                         size_t const step );
+        size_t              slice( float const depth ) const;
+
+        size_t              grid_x;
+        size_t              grid_y;
+        size_t              grid_z;
+        float               cutoff_v;
+        size_t              threads_v;
+        float               near_v;
+        float               far_v;
+        float               depth_scale;
+        float               depth_bias;
+        /* The w row of the view projection, and the length of its xyz. */
+        float               depth_row[4];
+        float               depth_stretch;
+        /* Four floats a plane, x planes first; all face toward +x or +y. */
+        std::vector<float>  planes;
+        /* The bounding spheres, apart so four can be loaded at a time. */
+        std::vector<float>  sphere_x;
+        std::vector<float>  sphere_y;
+        std::vector<float>  sphere_z;
+        std::vector<float>  sphere_r;
+        /* Six a light: first and last cluster in x, y and z. */
+        std::vector<int>    ranges;
+        std::vector<float>  light_v;
+        std::vector<GLuint> table;
+        GLuint              light_buff;
+        GLuint              light_tex;
+        GLuint              cluster_buff;
+        GLuint              cluster_tex;
+        uniform_cache       handles;
+    };
+    /**
+     * \brief Construct a new light clusters settings object with default
+     * settings.
+     *
+     * By default the grid is 16 by 9 by 24 clusters, lights reach until
+     * their radiance falls to 0.01, and clusters are filled on the calling
+     * thread alone.
+     */
+    inline light_clusters::settings::settings() : grid_x_v ( 16 ),
+                                                  grid_y_v ( 9 ),
+                                                  grid_z_v ( 24 ),
+                                                  cutoff_v ( 0.01f ),
+                                                  threads_v ( 1 ) {}
+    /**
+     * \brief Set the number of clusters across, up and into the frustum.
+     * \param x The number of clusters across the screen
+     * \param y The number of clusters up the screen
+     * \param z The number of depth slices
+     * \return This settings object
+     * \exception std::invalid_argument If any of them is zero
+     */
+    inline light_clusters::settings&    light_clusters::settings::grid( size_t const x,
+                                                                        size_t const y,
+                                                                        size_t const z )
+    {
+        if ( x == 0 or y == 0 or z == 0 ) {
+            throw std::invalid_argument( "A light cluster grid needs at least one cluster each way." );
+        }
+        grid_x_v = x;
+        grid_y_v = y;
+        grid_z_v = z;
+        return *this;
+    }
+    /**
+     * \brief Set the radiance below which a light is taken to reach no
+     * further.
+     * \param radiance The cutoff radiance
+     * \return This settings object
+     * \exception std::invalid_argument If the cutoff is not positive
+     */
+    inline light_clusters::settings&    light_clusters::settings::cutoff( float const radiance )
+    {
+        if ( not ( radiance > 0.0f ) ) {
+            throw std::invalid_argument( "A light cutoff must be greater than zero." );
+        }
+        cutoff_v = radiance;
+        return *this;
+    }
+    /**
+     * \brief Set how many threads \ref assign() "assign()" may use.
+     *
+     * The calling thread is one of them.
+     * \param count The number of threads; zero is taken as one
+     * \return This settings object
+     */
+    inline light_clusters::settings&    light_clusters::settings::threads( size_t const count )
+    {
+        threads_v = count == 0 ? 1 : count;
+        return *this;
+    }
+    /**
+     * \brief Return the number of lights added since the last
+     * \ref clear() "clear()".
+     */
+    inline size_t   light_clusters::lights() const
+    { return light_v.size() / 16; }
+    /**
+     * \brief Return the number of clusters in the grid.
+     */
+    inline size_t   light_clusters::clusters() const
+    { return grid_x * grid_y * grid_z; }
+    /**
+     * \brief Return the number a cluster has in the cluster table.
+     * \param x The cluster's column, from the left of the screen
+     * \param y The cluster's row, from the bottom of the screen
+     * \param z The cluster's depth slice, from the near plane
+     * \return The cluster's number
+     * \exception std::out_of_range If the cluster is not in the grid
+     */
+    inline size_t   light_clusters::cluster( size_t const x,
+                                             size_t const y,
+                                             size_t const z ) const
+    {
+        if ( x >= grid_x or y >= grid_y or z >= grid_z ) {
+            throw std::out_of_range( "Light cluster lies outside the grid." );
+        }
+        return x + grid_x * ( y + grid_y * z );
+    }
+    /**
+     * \brief Return how many light indices the clusters list between
+     * them, as of the last \ref assign() "assign()".
+     */
+    inline size_t   light_clusters::references() const
+    { return table.size() < clusters() * 2 ? 0 : table.size() - clusters() * 2; }
+    /**
+     * \brief Return the light data as \ref upload() "upload()" writes it,
+     * sixteen floats a light.
+     */
+    inline std::vector<float> const&    light_clusters::light_table() const
+    { return light_v; }
+    /**
+     * \brief Return the cluster table as \ref upload() "upload()" writes
+     * it, as of the last \ref assign() "assign()".
+     *
+     * Cluster n's lights are the \c table[2n + 1] entries starting at
+     * \c table[2 * clusters() + table[2n]].
+     */
+    inline std::vector<GLuint> const&   light_clusters::cluster_table() const
+    { return table; }
+}
+
+#endif
@@ -0,0 +1,106 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "../gMath/datatype.hpp"
+#include "light_clusters.hpp"
+
+using namespace gfx;
+
+/*
+ * Scatters point, sphere and spot lights through a camera's frustum and
+ * sorts them into clusters on one thread and then on several. Also reports
+ * how many lights a fragment in an average lit cluster has to shade,
+ * against shading every light everywhere.
+ *
+ * Usage: light_clusters_benchmark [lights] [frames] [threads]
+ */
+namespace {
+    typedef std::chrono::high_resolution_clock  bench_clock;
+
+    double  since( bench_clock::time_point const start )
+    {
+        return std::chrono::duration<double, std::milli>( bench_clock::now() - start ).count();
+    }
+
+    float   random( float const low, float const high )
+    {
+        return low + ( high - low ) * float( std::rand() % 1000 ) / 999.0f;
+    }
+
+    void    scatter( light_clusters& set, size_t const count )
+    {
+        std::srand( 5 );
+        for ( size_t n = 0; n < count; ++n ) {
+            vec3 const pos ( random( -100.0f, 100.0f ), random( -2.0f, 20.0f ), random( -200.0f, 0.0f ) );
+            float const rad = random( 0.05f, 1.0f );
+            if ( n % 3 == 0 ) {
+                set.add( point_light( point_light::settings()
+                                      .position( pos )
+                                      .radiance( rad ) ) );
+            } else if ( n % 3 == 1 ) {
+                set.add( sphere_light( sphere_light::settings()
+                                       .position( pos )
+                                       .radiance( rad )
+                                       .radius( 0.5f ) ) );
+            } else {
+                set.add( spot_light( spot_light::settings()
+                                     .position( pos )
+                                     .radiance( rad )
+                                     .direction( vec3( 0.0f, -1.0f, random( -1.0f, 1.0f ) ) )
+                                     .sweep( angle::in_degs( 30.0f ) ) ) );
+            }
+        }
+    }
+}
+
+int main( int argc, char** argv )
+{
+    size_t count = ( argc > 1 ) ? std::strtoul( argv[1], 0, 10 ) : 4096;
+    size_t frames = ( argc > 2 ) ? std::strtoul( argv[2], 0, 10 ) : 50;
+    size_t threads = ( argc > 3 ) ? std::strtoul( argv[3], 0, 10 ) : 4;
+    if ( frames == 0 ) { frames = 1; }
+
+    proj_cam cam ( proj_cam::settings()
+                   .position( vec3( 0.0f, 2.0f, 0.0f ) )
+                   .look_at( vec3( 0.0f, 2.0f, -1.0f ) )
+                   .field_of_view( d_angle::in_degs( 60.0 ) )
+                   .aspect_ratio( 16.0 / 9.0 )
+                   .near_plane( 0.1 )
+                   .far_plane( 200.0 ) );
+
+    light_clusters serial;
+    light_clusters threaded ( light_clusters::settings().threads( threads ) );
+    double serial_ms = 0.0;
+    double threaded_ms = 0.0;
+    for ( size_t f = 0; f < frames; ++f ) {
+        bench_clock::time_point start = bench_clock::now();
+        serial.clear();
+        scatter( serial, count );
+        serial.assign( cam );
+        serial_ms += since( start );
+
+        start = bench_clock::now();
+        threaded.clear();
+        scatter( threaded, count );
+        threaded.assign( cam );
+        threaded_ms += since( start );
+    }
+
+    std::vector<GLuint> const& table = serial.cluster_table();
+    size_t lit = 0;
+    size_t most = 0;
+    for ( size_t c = 0; c < serial.clusters(); ++c ) {
+        if ( table[c * 2 + 1] != 0 ) { ++lit; }
+        most = std::max( most, size_t( table[c * 2 + 1] ) );
+    }
+    std::cout << count << " lights, " << serial.clusters() << " clusters, "
+              << serial.references() << " listings\n"
+              << "add and assign, 1 thread:     " << serial_ms / frames << " ms/frame\n"
+              << "add and assign, " << threads << " thread(s): " << threaded_ms / frames << " ms/frame\n"
+              << "lights per lit cluster:       " << ( lit == 0 ? 0.0 : double( serial.references() ) / lit )
+              << " on average, " << most << " at most, against " << count << " unclustered\n";
+    return 0;
+}
@@ -0,0 +1,203 @@
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+#include <vector>
+
+#include "../../UnitTest++_src/UnitTest++.h"
+
+#include "../gVideo/video.hpp"
+#include "../gMath/datatype.hpp"
+#include "light_clusters.hpp"
+
+using namespace gfx;
+
+namespace {
+    proj_cam    eye()
+    {
+        return proj_cam( proj_cam::settings()
+                         .position( vec3( 0.0f, 0.0f, 0.0f ) )
+                         .look_at( vec3( 0.0f, 0.0f, -1.0f ) )
+                         .field_of_view( d_angle::in_degs( 60.0 ) )
+                         .aspect_ratio( 2.0 )
+                         .near_plane( 0.5 )
+                         .far_plane( 100.0 ) );
+    }
+
+    float   random( float const low, float const high )
+    {
+        return low + ( high - low ) * float( std::rand() % 1000 ) / 999.0f;
+    }
+
+    /* Point, sphere and spot lights scattered through the frustum. */
+    void    scatter( light_clusters& set, size_t const count )
+    {
+        for ( size_t n = 0; n < count; ++n ) {
+            vec3 const pos ( random( -40.0f, 40.0f ), random( -20.0f, 20.0f ), random( -90.0f, 5.0f ) );
+            vec3 const col ( random( 0.0f, 1.0f ), random( 0.0f, 1.0f ), random( 0.0f, 1.0f ) );
+            float const rad = random( 0.01f, 0.2f );
+            if ( n % 3 == 0 ) {
+                set.add( point_light( point_light::settings()
+                                      .position( pos )
+                                      .color( col )
+                                      .radiance( rad ) ) );
+            } else if ( n % 3 == 1 ) {
+                set.add( sphere_light( sphere_light::settings()
+                                       .position( pos )
+                                       .color( col )
+                                       .radiance( rad )
+                                       .radius( random( 0.1f, 1.0f ) ) ) );
+            } else {
+                set.add( spot_light( spot_light::settings()
+                                     .position( pos )
+                                     .color( col )
+                                     .radiance( rad )
+                                     .direction( vec3( random( -1.0f, 1.0f ), random( -1.0f, 1.0f ), -1.0f ) )
+                                     .sweep( angle::in_degs( random( 5.0f, 100.0f ) ) )
+                                     .radius( 0.0f ) ) );
+            }
+        }
+    }
+
+    /* Whether a light, as written in the light table, reaches a point. */
+    bool    lights( float const* texels, float const* point )
+    {
+        float const to[3] = { point[0] - texels[0], point[1] - texels[1], point[2] - texels[2] };
+        float const dist = std::sqrt( to[0] * to[0] + to[1] * to[1] + to[2] * to[2] );
+        if ( dist > texels[3] ) { return false; }
+        if ( texels[11] <= -1.0f or dist == 0.0f ) { return true; }
+        return ( to[0] * texels[8] + to[1] * texels[9] + to[2] * texels[10] ) / dist >= texels[11];
+    }
+
+    bool    listed( light_clusters const& set, size_t const cell, GLuint const light )
+    {
+        std::vector<GLuint> const& table = set.cluster_table();
+        GLuint const* first = &table[set.clusters() * 2 + table[cell * 2]];
+        for ( GLuint n = 0; n < table[cell * 2 + 1]; ++n ) {
+            if ( first[n] == light ) { return true; }
+        }
+        return false;
+    }
+}
+
+SUITE( LightClusterTests )
+{
+    TEST( Settings )
+    {
+        CHECK_THROW( light_clusters::settings().grid( 0, 4, 4 ), std::invalid_argument );
+        CHECK_THROW( light_clusters::settings().cutoff( 0.0f ), std::invalid_argument );
+
+        light_clusters set;
+        CHECK_EQUAL( 16u * 9u * 24u, set.clusters() );
+        CHECK_EQUAL( 0u, set.lights() );
+        CHECK_EQUAL( 17u, set.cluster( 1, 1, 0 ) );
+        CHECK_THROW( set.cluster( 16, 0, 0 ), std::out_of_range );
+
+        proj_cam cam = eye();
+        CHECK_THROW( set.assign( cam.view_matrix(), 0.0f, 100.0f ), std::invalid_argument );
+        CHECK_THROW( set.assign( cam.view_matrix(), 10.0f, 1.0f ), std::invalid_argument );
+        set.assign( cam );
+        CHECK_EQUAL( 0u, set.references() );
+        CHECK_EQUAL( set.clusters() * 2, set.cluster_table().size() );
+    }
+
+    TEST( LightsLandWhereTheyShine )
+    {
+        light_clusters set ( light_clusters::settings()
+                             .grid( 8, 4, 16 ) );
+        proj_cam cam = eye();
+        // One light in the middle of the view, one wholly behind the eye
+        CHECK_EQUAL( 0u, set.add( point_light( point_light::settings()
+                                               .position( vec3( 0.0f, 0.0f, -20.0f ) )
+                                               .radiance( 0.01f ) ) ) );
+        CHECK_EQUAL( 1u, set.add( point_light( point_light::settings()
+                                               .position( vec3( 0.0f, 0.0f, 20.0f ) )
+                                               .radiance( 0.01f ) ) ) );
+        CHECK_CLOSE( 1.0f, set.light_table()[3], 1.0e-5f );
+        set.assign( cam );
+        CHECK( listed( set, set.cluster( 3, 1, 10 ), 0 ) );
+        CHECK( listed( set, set.cluster( 4, 2, 11 ), 0 ) );
+        CHECK( not listed( set, set.cluster( 0, 0, 11 ), 0 ) );
+        CHECK( not listed( set, set.cluster( 4, 2, 8 ), 0 ) );
+        CHECK( not listed( set, set.cluster( 4, 2, 15 ), 0 ) );
+        CHECK( set.references() < 16 );
+
+        set.clear();
+        CHECK_EQUAL( 0u, set.lights() );
+        std::srand( 11 );
+        scatter( set, 300 );
+        set.assign( cam );
+        CHECK( set.references() < set.lights() * set.clusters() / 8 );
+
+        // Every point a light reaches is in a cluster that lists the light
+        mat4 const view = cam.view_matrix();
+        float const depth_scale = 16.0f / std::log( 100.0f / 0.5f );
+        bool found = true;
+        for ( size_t s = 0; s < 4000; ++s ) {
+            float const point[3] = { random( -50.0f, 50.0f ), random( -25.0f, 25.0f ), random( -99.0f, -0.5f ) };
+            float clip[4];
+            for ( size_t row = 0; row < 4; ++row ) {
+                clip[row] = view( 0, row ) * point[0] + view( 1, row ) * point[1]
+                            + view( 2, row ) * point[2] + view( 3, row );
+            }
+            if ( clip[3] < 0.5f or clip[3] > 100.0f or
+                 std::fabs( clip[0] ) >= clip[3] or std::fabs( clip[1] ) >= clip[3] ) {
+                continue;
+            }
+            size_t const x = size_t( ( clip[0] / clip[3] + 1.0f ) * 0.5f * 8.0f );
+            size_t const y = size_t( ( clip[1] / clip[3] + 1.0f ) * 0.5f * 4.0f );
+            size_t const z = std::min( size_t( 15 ),
+                                       size_t( std::log( clip[3] / 0.5f ) * depth_scale ) );
+            size_t const cell = set.cluster( x, y, z );
+            for ( size_t n = 0; n < set.lights(); ++n ) {
+                if ( lights( &set.light_table()[n * 16], point ) ) {
+                    found = found and listed( set, cell, GLuint( n ) );
+                }
+            }
+        }
+        CHECK( found );
+    }
+
+    TEST( ThreadsMatchOneThread )
+    {
+        light_clusters serial;
+        light_clusters threaded ( light_clusters::settings()
+                                  .threads( 4 ) );
+        std::srand( 7 );
+        scatter( serial, 1000 );
+        std::srand( 7 );
+        scatter( threaded, 1000 );
+        proj_cam cam = eye();
+        serial.assign( cam );
+        threaded.assign( cam );
+        CHECK( serial.references() > 0 );
+        CHECK( serial.light_table() == threaded.light_table() );
+        CHECK( serial.cluster_table() == threaded.cluster_table() );
+    }
+
+    TEST( UploadMakesBufferTextures )
+    {
+        gl_backend::use_null();
+        context test_cntx ( ( context::settings() ) );
+
+        light_clusters set;
+        std::srand( 3 );
+        scatter( set, 30 );
+        proj_cam cam = eye();
+        set.assign( cam );
+        gl_backend::recording( true );
+        gl_backend::reset_stats();
+        set.upload();
+        CHECK_EQUAL( 2u, gl_backend::stats( "TexBuffer" ).calls );
+        CHECK_EQUAL( 2u, gl_backend::stats( "BufferData" ).calls );
+        set.upload();
+        CHECK_EQUAL( 2u, gl_backend::stats( "TexBuffer" ).calls );
+        CHECK_EQUAL( 4u, gl_backend::stats( "BufferData" ).calls );
+        gl_backend::recording( false );
+    }
+}
+
+int main( int argc, char* argv[] )
+{
+    video_system::get().initialize( video_system::settings().ver( 3, 3 ) );
+    return UnitTest::RunAllTests();
+}
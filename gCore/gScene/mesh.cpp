@@ -0,0 +1,196 @@
+#include "mesh.hpp"
+
+#include <cmath>
+
+#include "../gMath/constant.hpp"
+#include "../gMath/datatype.hpp"
+#include "../gVideo/video.hpp"
+#include "gl_state.hpp"
+
+namespace gfx {
+
+    namespace {
+        /* The corners and faces of the box, wound as the box always was. */
+        float const     box_corners[8][3] = { {  1.0f,  1.0f,  1.0f }, { -1.0f,  1.0f,  1.0f },
+                                              { -1.0f,  1.0f, -1.0f }, {  1.0f,  1.0f, -1.0f },
+                                              {  1.0f, -1.0f,  1.0f }, { -1.0f, -1.0f,  1.0f },
+                                              { -1.0f, -1.0f, -1.0f }, {  1.0f, -1.0f, -1.0f } };
+        GLuint const    box_faces[36] = { 0, 4, 1,  4, 5, 1,  3, 7, 0,  0, 7, 4,
+                                          2, 6, 3,  3, 6, 7,  1, 5, 2,  2, 5, 6,
+                                          1, 3, 0,  1, 2, 3,  5, 7, 6,  5, 4, 7 };
+
+        /*
+         * A sphere of radius 0.5 with a vertex at each pole and a ring of
+         * vertices at each latitude between, wound counter-clockwise seen
+         * from outside.
+         */
+        void    sphere_shape( unsigned int const rings,
+                              unsigned int const segments,
+                              std::vector<vec3>& points,
+                              std::vector<GLuint>& faces )
+        {
+            float const pi = lit<float>::pi;
+            points.push_back( vec3( 0.0f, 0.5f, 0.0f ) );
+            for ( unsigned int r = 1; r < rings; ++r ) {
+                float const polar = pi * float( r ) / float( rings );
+                for ( unsigned int s = 0; s < segments; ++s ) {
+                    float const around = 2.0f * pi * float( s ) / float( segments );
+                    points.push_back( vec3( 0.5f * std::sin( polar ) * std::cos( around ),
+                                            0.5f * std::cos( polar ),
+                                            -0.5f * std::sin( polar ) * std::sin( around ) ) );
+                }
+            }
+            points.push_back( vec3( 0.0f, -0.5f, 0.0f ) );
+
+            GLuint const bottom = GLuint( points.size() - 1 );
+            for ( unsigned int s = 0; s < segments; ++s ) {
+                GLuint const next = ( s + 1 ) % segments;
+                faces.push_back( 0 );
+                faces.push_back( 1 + s );
+                faces.push_back( 1 + next );
+            }
+            for ( unsigned int r = 0; r + 2 < rings; ++r ) {
+                GLuint const upper = 1 + r * segments;
+                GLuint const lower = upper + segments;
+                for ( unsigned int s = 0; s < segments; ++s ) {
+                    GLuint const next = ( s + 1 ) % segments;
+                    faces.push_back( upper + s );
+                    faces.push_back( lower + s );
+                    faces.push_back( lower + next );
+                    faces.push_back( upper + s );
+                    faces.push_back( lower + next );
+                    faces.push_back( upper + next );
+                }
+            }
+            GLuint const last = 1 + ( rings - 2 ) * segments;
+            for ( unsigned int s = 0; s < segments; ++s ) {
+                GLuint const next = ( s + 1 ) % segments;
+                faces.push_back( last + s );
+                faces.push_back( bottom );
+                faces.push_back( last + next );
+            }
+        }
+    }
+
+    /**
+     * \brief Return the mesh shared for the given settings.
+     *
+     * If no mesh of this shape exists yet, one is generated and uploaded;
+     * otherwise the existing mesh is handed back.
+     * Every acquire() must be matched by a \ref release() "release()".
+     * \param set The shape and its tessellation
+     * \return The shared mesh
+     * \exception std::logic_error If there is no context to make the
+     * buffers in
+     */
+    mesh&   mesh::acquire( settings const& set )
+    {
+        if ( not video_system::get().context_present() ) {
+            throw std::logic_error( "No OpenGL context available to create a mesh in." );
+        }
+        mesh_map& meshes = cache();
+        mesh_map::iterator found = meshes.find( set );
+        if ( found == meshes.end() ) {
+            found = meshes.insert( std::make_pair( set,
+                                                   new mesh( set ) ) ).first;
+        }
+        ++(found->second->refs);
+        return *(found->second);
+    }
+    /**
+     * \brief Give up a reference to a shared mesh.
+     *
+     * The mesh is deleted once nothing references it.
+     * \param shape The mesh to release
+     */
+    void    mesh::release( mesh& shape )
+    {
+        if ( shape.refs > 1 ) {
+            --shape.refs;
+            return;
+        }
+        cache().erase( shape.state );
+        delete &shape;
+    }
+    /**
+     * \brief Return the number of distinct meshes currently shared.
+     * \return The number of live meshes
+     */
+    size_t  mesh::shared()
+    { return cache().size(); }
+    /**
+     * \brief Draw the mesh's triangles, once or many times over.
+     *
+     * More than one instance is drawn with DrawElementsInstanced(), in a
+     * single call; the shader tells the instances apart by gl_InstanceID
+     * or by attributes that advance once an instance.
+     * \param instances The number of copies to draw
+     */
+    void    mesh::draw( GLsizei const instances )
+    {
+        if ( instances <= 0 ) {
+            return;
+        }
+        geom->align();
+        if ( instances == 1 ) {
+            gl::DrawElements( gl::TRIANGLES, elements(), gl::UNSIGNED_INT, 0 );
+        } else {
+            gl::DrawElementsInstanced( gl::TRIANGLES, elements(), gl::UNSIGNED_INT, 0, instances );
+        }
+    }
+    /*
+     * Generate the shape and upload its vertices and elements.
+     */
+    mesh::mesh( settings const& set ) : state ( set ),
+                                        geom ( 0 ),
+                                        index_data (),
+                                        elem_ID ( 0 ),
+                                        extent (),
+                                        refs ( 0 )
+    {
+        std::vector<vec3> points;
+        if ( set.kind_v == 0 ) {
+            for ( size_t c = 0; c < 8; ++c ) {
+                points.push_back( vec3( box_corners[c][0], box_corners[c][1], box_corners[c][2] ) );
+            }
+            index_data.assign( box_faces, box_faces + 36 );
+        } else {
+            sphere_shape( set.rings_v, set.segments_v, points, index_data );
+        }
+
+        geom = new vertex_buffer( buffer::settings()
+                                  .blocks( GLsizeiptr( points.size() ) )
+                                  .static_draw() );
+        geom->block_format( block_spec()
+                            .attribute( type<vec3>() ) );
+        geom->load_attribute( 0, points );
+        extent = bounds::of_buffer( *geom, 0 );
+        geom->upload_data();
+        geom->align();
+
+        // Bound while the vertex array is, so the array keeps it
+        gl::GenBuffers( 1, &elem_ID );
+        gl_state::current().bind_buffer( gl::ELEMENT_ARRAY_BUFFER, elem_ID );
+        gl::BufferData( gl::ELEMENT_ARRAY_BUFFER,
+                        GLsizeiptr( index_data.size() * sizeof( GLuint ) ),
+                        &index_data[0],
+                        gl::STATIC_DRAW );
+    }
+    /*
+     * Delete the buffers; only reached through release().
+     */
+    mesh::~mesh()
+    {
+        gl_state::forget_buffer( elem_ID );
+        gl::DeleteBuffers( 1, &elem_ID );
+        delete geom;
+    }
+    /*
+     * The table of shared meshes.
+     */
+    mesh::mesh_map&     mesh::cache()
+    {
+        static mesh_map meshes;
+        return meshes;
+    }
+}
@@ -0,0 +1,175 @@
+#ifndef MESH_HPP
+#define MESH_HPP
+
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include "../gVideo/gl_core_3_3.hpp"
+#include "vertex_buffer.hpp"
+#include "culling.hpp"
+
+namespace gfx {
+    /**
+     * \class gfx::mesh mesh.hpp "gCore/gScene/mesh.hpp"
+     * \brief The geometry of a procedural shape, generated once and shared
+     * by every primitive that asks for the same shape.
+     *
+     * Meshes are handed out by \ref acquire() "acquire()", keyed by the
+     * kind of shape and its tessellation, in the same way
+     * \ref gfx::sampler "samplers" are shared. Each mesh holds a vertex
+     * buffer of positions and an element array buffer attached to its
+     * vertex array, both uploaded when the mesh is made, so a thousand
+     * spheres of one tessellation draw from one pair of buffers. Every
+     * acquire() must be matched by a \ref release() "release()"; the mesh
+     * and its buffers are deleted with the last reference.
+     *
+     * Since every user of a mesh draws the same vertices, identical shapes
+     * can be drawn in one call with \ref draw() "draw()", giving each
+     * instance its own transformation from an
+     * \ref gfx::instance_buffer "instance_buffer".
+     *
+     * Like the sampler table, the mesh table is shared by every context;
+     * contexts that do not share objects should not share meshes.
+     */
+    class mesh {
+    public:
+        /**
+         * \class gfx::mesh::settings
+         * \brief Names the shape and tessellation of a
+         * \ref gfx::mesh "mesh".
+         */
+        class settings {
+        public:
+                            settings();
+            settings&       box();
+            settings&       sphere( unsigned int const rings,
+                                    unsigned int const segments );
+            bool            operator ==( settings const& rhs ) const;
+            size_t          hash() const;
+        private:
+            friend          class mesh;
+            int             kind_v;
+            unsigned int    rings_v;
+            unsigned int    segments_v;
+        };
+
+        static mesh&        acquire( settings const& set = settings() );
+        static void         release( mesh& shape );
+        static size_t       shared();
+        vertex_buffer&      geometry();
+        vertex_buffer const&    geometry() const;
+        bounds const&       local_bounds() const;
+        size_t              vertices() const;
+        GLsizei             elements() const;
+        GLuint const*       indices() const;
+        void                draw( GLsizei const instances = 1 );
+    private:
+                            mesh( settings const& set );
+                            ~mesh();
+                            mesh( mesh const& );
+        mesh&               operator =( mesh const& );
+
+        struct settings_hash {
+            size_t operator ()( settings const& set ) const
+            { return set.hash(); }
+        };
+        typedef std::unordered_map< settings,
+                                    mesh*,
+                                    settings_hash >    mesh_map;
+        static mesh_map&    cache();
+
+        settings            state;
+        vertex_buffer*      geom;
+        std::vector<GLuint> index_data;
+        GLuint              elem_ID;
+        bounds              extent;
+        size_t              refs;
+    };
+    /**
+     * \brief Construct a new mesh settings object naming a box.
+     */
+    inline  mesh::settings::settings() : kind_v ( 0 ),
+                                         rings_v ( 0 ),
+                                         segments_v ( 0 ) {}
+    /**
+     * \brief Ask for a box reaching from -1 to 1 along each axis.
+     * \return This settings object
+     */
+    inline  mesh::settings&     mesh::settings::box()
+    {
+        kind_v = 0;
+        rings_v = 0;
+        segments_v = 0;
+        return *this;
+    }
+    /**
+     * \brief Ask for a sphere of radius 0.5 about the origin.
+     * \param rings The number of bands from pole to pole
+     * \param segments The number of slices around the poles
+     * \return This settings object
+     * \exception std::invalid_argument If there are fewer than two rings
+     * or three segments
+     */
+    inline  mesh::settings&     mesh::settings::sphere( unsigned int const rings,
+                                                        unsigned int const segments )
+    {
+        if ( rings < 2 or segments < 3 ) {
+            throw std::invalid_argument( "A sphere needs at least two rings and three segments." );
+        }
+        kind_v = 1;
+        rings_v = rings;
+        segments_v = segments;
+        return *this;
+    }
+    /**
+     * \brief Compare two mesh settings objects.
+     * \return Whether both name the same shape and tessellation
+     */
+    inline  bool    mesh::settings::operator ==( settings const& rhs ) const
+    {
+        return kind_v == rhs.kind_v and
+               rings_v == rhs.rings_v and
+               segments_v == rhs.segments_v;
+    }
+    /**
+     * \brief Compute a hash of the mesh settings, for keying the shared
+     * mesh table.
+     * \return The hash value
+     */
+    inline  size_t  mesh::settings::hash() const
+    { return ( size_t( kind_v ) * 31u + rings_v ) * 31u + segments_v; }
+    /**
+     * \brief Return the mesh's vertex buffer.
+     */
+    inline  vertex_buffer&  mesh::geometry()
+    { return *geom; }
+    /**
+     * \brief Return the mesh's vertex buffer.
+     */
+    inline  vertex_buffer const&    mesh::geometry() const
+    { return *geom; }
+    /**
+     * \brief Return the bounds of the mesh before any transformation.
+     */
+    inline  bounds const&   mesh::local_bounds() const
+    { return extent; }
+    /**
+     * \brief Return the number of vertices in the mesh.
+     */
+    inline  size_t  mesh::vertices() const
+    { return size_t( geom->size() ); }
+    /**
+     * \brief Return the number of indices in the mesh's element array,
+     * three a triangle.
+     */
+    inline  GLsizei mesh::elements() const
+    { return GLsizei( index_data.size() ); }
+    /**
+     * \brief Return a copy of the mesh's element array kept in memory.
+     */
+    inline  GLuint const*   mesh::indices() const
+    { return &index_data[0]; }
+}
+
+#endif
@@ -0,0 +1,107 @@
+#include <stdexcept>
+#include <vector>
+
+#include "../../UnitTest++_src/UnitTest++.h"
+
+#include "../gVideo/video.hpp"
+#include "../gMath/datatype.hpp"
+#include "mesh.hpp"
+#include "primitive.hpp"
+
+using namespace gfx;
+
+SUITE( MeshTests )
+{
+    TEST( SameShapeSharesOneMesh )
+    {
+        gl_backend::use_null();
+        context test_cntx ( ( context::settings() ) );
+        gl_backend::recording( true );
+        gl_backend::reset_stats();
+
+        std::vector<sphere*> field;
+        for ( size_t n = 0; n < 1000; ++n ) {
+            field.push_back( new sphere() );
+        }
+        CHECK_EQUAL( 1u, mesh::shared() );
+        CHECK_EQUAL( 1u, gl_backend::stats( "GenVertexArrays" ).calls );
+        CHECK_EQUAL( 2u, gl_backend::stats( "GenBuffers" ).calls );
+        CHECK( &field[0]->shape() == &field[999]->shape() );
+        CHECK( &field[0]->geometry() == &field[1]->geometry() );
+
+        sphere fine ( sphere::settings().tessellation( 16, 32 ) );
+        box first;
+        box second;
+        CHECK_EQUAL( 3u, mesh::shared() );
+        CHECK( &fine.shape() != &field[0]->shape() );
+        CHECK( &first.shape() == &second.shape() );
+        CHECK( first.draw_array() == second.draw_array() );
+
+        for ( size_t n = 0; n < field.size(); ++n ) {
+            delete field[n];
+        }
+        CHECK_EQUAL( 2u, mesh::shared() );
+        CHECK_EQUAL( 1u, gl_backend::stats( "DeleteVertexArrays" ).calls );
+        gl_backend::recording( false );
+
+        CHECK_THROW( sphere::settings().tessellation( 1, 8 ), std::invalid_argument );
+        CHECK_THROW( mesh::settings().sphere( 4, 2 ), std::invalid_argument );
+    }
+
+    TEST( ShapesAreWhereTheyAlwaysWere )
+    {
+        gl_backend::use_null();
+        context test_cntx ( ( context::settings() ) );
+
+        box cube;
+        CHECK_EQUAL( 8u, cube.shape().vertices() );
+        CHECK_EQUAL( 36, cube.shape().elements() );
+        CHECK_EQUAL( vec3( -1.0f ), cube.local_bounds().low() );
+        CHECK_EQUAL( vec3( 1.0f ), cube.local_bounds().high() );
+
+        sphere ball ( sphere::settings().tessellation( 6, 10 ) );
+        mesh& shape = ball.shape();
+        CHECK_EQUAL( 2u + 5u * 10u, shape.vertices() );
+        CHECK_EQUAL( 6 * 10 * 5, shape.elements() );
+        CHECK_CLOSE( -0.5f, ball.local_bounds().low()[1], 1.0e-5f );
+        CHECK_CLOSE( 0.5f, ball.local_bounds().high()[1], 1.0e-5f );
+
+        GLuint const* index = shape.indices();
+        bool in_range = true;
+        for ( GLsizei t = 0; t < shape.elements(); t += 3 ) {
+            in_range = in_range and index[t] < shape.vertices()
+                                and index[t + 1] < shape.vertices()
+                                and index[t + 2] < shape.vertices();
+        }
+        CHECK( in_range );
+
+        // A default mesh is the box the box primitives share
+        mesh& cube_mesh = mesh::acquire();
+        CHECK( &cube_mesh == &cube.shape() );
+        mesh::release( cube_mesh );
+    }
+
+    TEST( InstancesDrawInOneCall )
+    {
+        gl_backend::use_null();
+        context test_cntx ( ( context::settings() ) );
+
+        mesh& shape = mesh::acquire( mesh::settings().sphere( 8, 16 ) );
+        gl_backend::recording( true );
+        gl_backend::reset_stats();
+        shape.draw();
+        shape.draw( 500 );
+        shape.draw( 0 );
+        CHECK_EQUAL( 1u, gl_backend::stats( "DrawElements" ).calls );
+        CHECK_EQUAL( 1u, gl_backend::stats( "DrawElementsInstanced" ).calls );
+        gl_backend::recording( false );
+        mesh::release( shape );
+        CHECK_EQUAL( 0u, mesh::shared() );
+    }
+}
+
+int main( int argc, char* argv[] )
+{
+    video_system::get().initialize( video_system::settings().ver( 3, 3 ) );
+    return UnitTest::RunAllTests();
+}
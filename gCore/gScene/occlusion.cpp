@@ -0,0 +1,500 @@
+#include "occlusion.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <functional>
+#include <string>
+#include <thread>
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+namespace gfx {
+
+    namespace {
+        size_t const    tile = 16;
+        /* Corners closer to the eye than this are taken as behind it. */
+        float const     nearest_w = 1.0e-5f;
+
+        void    column_major( mat4 const& matrix, float* out )
+        {
+            for ( size_t col = 0; col < 4; ++col ) {
+                for ( size_t row = 0; row < 4; ++row ) {
+                    out[col * 4 + row] = matrix( col, row );
+                }
+            }
+        }
+
+#ifdef __SSE__
+        float   lowest( __m128 v )
+        {
+            v = _mm_min_ps( v, _mm_shuffle_ps( v, v, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+            v = _mm_min_ps( v, _mm_shuffle_ps( v, v, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+            return _mm_cvtss_f32( v );
+        }
+
+        float   highest( __m128 v )
+        {
+            v = _mm_max_ps( v, _mm_shuffle_ps( v, v, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+            v = _mm_max_ps( v, _mm_shuffle_ps( v, v, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+            return _mm_cvtss_f32( v );
+        }
+#endif
+
+        void    project( float const* m, float const* point, float* clip )
+        {
+            for ( size_t row = 0; row < 4; ++row ) {
+                clip[row] = m[row] * point[0] + m[4 + row] * point[1]
+                            + m[8 + row] * point[2] + m[12 + row];
+            }
+        }
+    }
+
+    /**
+     * \brief Construct a new occlusion buffer, cleared to the far plane.
+     * \param set The settings for the buffer
+     */
+    occlusion_buffer::occlusion_buffer( settings const& set ) :
+                                        width_v ( ( set.width_v + tile - 1 ) / tile * tile ),
+                                        height_v ( ( set.height_v + tile - 1 ) / tile * tile ),
+                                        tiles_x ( width_v / tile ),
+                                        tiles_y ( height_v / tile ),
+                                        threads_v ( set.threads_v ),
+                                        depths ( width_v * height_v, 1.0f ),
+                                        tile_far ( tiles_x * tiles_y, 1.0f ),
+                                        drawn ( 0 ),
+                                        bins ( tiles_x * tiles_y )
+    {
+        column_major( mat4::identity(), view_projection );
+    }
+    /**
+     * \brief Start a new frame: clear the buffer and forget last frame's
+     * occluders.
+     * \param view_projection The combined view and projection matrix
+     * occluders and bounds are seen through
+     */
+    void    occlusion_buffer::begin( mat4 const& view_projection )
+    {
+        column_major( view_projection, this->view_projection );
+        std::fill( depths.begin(), depths.end(), 1.0f );
+        std::fill( tile_far.begin(), tile_far.end(), 1.0f );
+        tris.clear();
+        drawn = 0;
+    }
+    /**
+     * \brief Start a new frame seen through a camera.
+     *
+     * A camera's view matrix already has its projection folded in, as a
+     * \ref gfx::proj_cam "proj_cam" keeps it.
+     * \param cam The camera
+     */
+    void    occlusion_buffer::begin( camera& cam )
+    {
+        begin( cam.view_matrix() );
+    }
+    /**
+     * \brief Add an occluder given as a list of triangles.
+     * \param points Three floats a point, every three points a triangle
+     * \param count The number of points; a partial triangle at the end is
+     * ignored
+     * \param model The occluder's world matrix
+     * \param stride The bytes from one point to the next
+     */
+    void    occlusion_buffer::occluder( float const* points,
+                                        size_t const count,
+                                        mat4 const& model,
+                                        size_t const stride )
+    {
+        float m[16];
+        float world[16];
+        column_major( model, world );
+        // The full transform, so each corner is only multiplied once
+        for ( size_t col = 0; col < 4; ++col ) {
+            for ( size_t row = 0; row < 4; ++row ) {
+                m[col * 4 + row] = view_projection[row] * world[col * 4]
+                                   + view_projection[4 + row] * world[col * 4 + 1]
+                                   + view_projection[8 + row] * world[col * 4 + 2]
+                                   + view_projection[12 + row] * world[col * 4 + 3];
+            }
+        }
+        float const half_w = float( width_v ) * 0.5f;
+        float const half_h = float( height_v ) * 0.5f;
+        unsigned char const* bytes = reinterpret_cast<unsigned char const*>( points );
+        for ( size_t n = 0; n + 3 <= count; n += 3 ) {
+            float screen[9];
+            bool keep = true;
+            for ( size_t v = 0; v < 3 and keep; ++v ) {
+                float clip[4];
+                project( m, reinterpret_cast<float const*>( bytes + ( n + v ) * stride ), clip );
+                keep = clip[3] > nearest_w and clip[2] >= -clip[3];
+                if ( not keep ) { break; }
+                float const inverse = 1.0f / clip[3];
+                screen[v * 3] = ( clip[0] * inverse + 1.0f ) * half_w;
+                screen[v * 3 + 1] = ( clip[1] * inverse + 1.0f ) * half_h;
+                screen[v * 3 + 2] = clip[2] * inverse * 0.5f + 0.5f;
+            }
+            if ( not keep ) { continue; }
+            float const area = ( screen[3] - screen[0] ) * ( screen[7] - screen[1] )
+                               - ( screen[6] - screen[0] ) * ( screen[4] - screen[1] );
+            float const low_x = std::min( std::min( screen[0], screen[3] ), screen[6] );
+            float const high_x = std::max( std::max( screen[0], screen[3] ), screen[6] );
+            float const low_y = std::min( std::min( screen[1], screen[4] ), screen[7] );
+            float const high_y = std::max( std::max( screen[1], screen[4] ), screen[7] );
+            if ( std::fabs( area ) < 1.0e-6f or high_x < 0.0f or high_y < 0.0f
+                 or low_x >= float( width_v ) or low_y >= float( height_v ) ) {
+                continue;
+            }
+            tris.insert( tris.end(), screen, screen + 9 );
+        }
+    }
+    /**
+     * \brief Add an occluder from the vec3 attribute of a buffer, taking
+     * every three blocks as a triangle.
+     * \param geom The buffer, with its data loaded
+     * \param index The index of the attribute holding positions
+     * \param model The occluder's world matrix
+     */
+    void    occlusion_buffer::occluder( buffer const& geom,
+                                        GLuint const index,
+                                        mat4 const& model )
+    {
+        if ( not geom.verts_specified or index >= geom.attributes->size() ) {
+            throw std::invalid_argument( "Occluder asked of a buffer attribute that does not exist." );
+        }
+        if ( (*(*geom.attributes)[index]) != type< vec3 >() ) {
+            std::string msg = "Occluders can only be drawn from vec3 attributes, but buffer index ";
+            msg += std::to_string( index );
+            msg += " holds ";
+            msg += (*geom.attributes)[index]->name();
+            msg += ".";
+            throw std::invalid_argument( msg );
+        }
+        if ( geom.data == 0 ) {
+            throw std::logic_error( "Occluder asked of a buffer with no data loaded." );
+        }
+        unsigned char const* first = geom.data + geom.attribute_offset( index );
+        occluder( reinterpret_cast<float const*>( first ),
+                  size_t( geom.n_blocks ), model, size_t( geom.stride ) );
+    }
+    /**
+     * \brief Draw every occluder added since \ref begin() "begin()".
+     *
+     * Occluders added afterwards are drawn by the next call, on top of
+     * what is already there.
+     */
+    void    occlusion_buffer::rasterize()
+    {
+        for ( size_t t = 0; t < bins.size(); ++t ) { bins[t].clear(); }
+        size_t const count = tris.size() / 9;
+        for ( size_t n = drawn; n < count; ++n ) {
+            float const* tri = &tris[n * 9];
+            float const low_x = std::min( std::min( tri[0], tri[3] ), tri[6] );
+            float const high_x = std::max( std::max( tri[0], tri[3] ), tri[6] );
+            float const low_y = std::min( std::min( tri[1], tri[4] ), tri[7] );
+            float const high_y = std::max( std::max( tri[1], tri[4] ), tri[7] );
+            size_t const first_x = low_x <= 0.0f ? 0 : size_t( low_x ) / tile;
+            size_t const first_y = low_y <= 0.0f ? 0 : size_t( low_y ) / tile;
+            size_t const last_x = std::min( size_t( high_x ) / tile, tiles_x - 1 );
+            size_t const last_y = std::min( size_t( high_y ) / tile, tiles_y - 1 );
+            for ( size_t ty = first_y; ty <= last_y; ++ty ) {
+                for ( size_t tx = first_x; tx <= last_x; ++tx ) {
+                    bins[ty * tiles_x + tx].push_back( static_cast<unsigned int>( n ) );
+                }
+            }
+        }
+
+        size_t const threads = std::min( threads_v, bins.size() );
+        std::vector<std::thread> workers;
+        workers.reserve( threads - 1 );
+        for ( size_t t = 1; t < threads; ++t ) {
+            workers.push_back( std::thread( &occlusion_buffer::raster_tiles, this,
+                                            t, threads ) );
+        }
+        raster_tiles( 0, threads );
+        for ( size_t t = 0; t < workers.size(); ++t ) { workers[t].join(); }
+        drawn = count;
+    }
+    /**
+     * \brief Return whether bounds are wholly hidden behind the
+     * occluders drawn so far.
+     *
+     * The box of the bounds is projected and the rectangle around it
+     * compared against the buffer at its nearest depth. Bounds reaching
+     * behind the near plane or lying wholly off the buffer are never
+     * hidden; the frustum is the place to cull those.
+     * \param volume The bounds, in world space
+     */
+    bool    occlusion_buffer::occluded( bounds const& volume ) const
+    {
+        if ( volume.empty() ) { return true; }
+        // The center is projected once and each corner reached from it
+        // along the box's three projected half sizes
+        vec3 const& center = volume.center();
+        vec3 const& extent = volume.extent();
+        float const point[3] = { center[0], center[1], center[2] };
+        float middle[4];
+        project( view_projection, point, middle );
+        float axes[3][4];
+        for ( size_t a = 0; a < 3; ++a ) {
+            for ( size_t row = 0; row < 4; ++row ) {
+                axes[a][row] = view_projection[a * 4 + row] * extent[a];
+            }
+        }
+        float const half_w = float( width_v ) * 0.5f;
+        float const half_h = float( height_v ) * 0.5f;
+        float low_x, high_x, low_y, high_y, nearest;
+#ifdef __SSE__
+        // Four corners to a register, one register per clip coordinate
+        __m128 const x_signs = _mm_set_ps( 1.0f, -1.0f, 1.0f, -1.0f );
+        __m128 const y_signs = _mm_set_ps( 1.0f, 1.0f, -1.0f, -1.0f );
+        __m128 clip[2][4];
+        for ( size_t row = 0; row < 4; ++row ) {
+            __m128 const base = _mm_add_ps( _mm_set1_ps( middle[row] ),
+                                            _mm_add_ps( _mm_mul_ps( x_signs, _mm_set1_ps( axes[0][row] ) ),
+                                                        _mm_mul_ps( y_signs, _mm_set1_ps( axes[1][row] ) ) ) );
+            clip[0][row] = _mm_sub_ps( base, _mm_set1_ps( axes[2][row] ) );
+            clip[1][row] = _mm_add_ps( base, _mm_set1_ps( axes[2][row] ) );
+        }
+        __m128 const one = _mm_set1_ps( 1.0f );
+        __m128 const half = _mm_set1_ps( 0.5f );
+        __m128 xs[2], ys[2], zs[2];
+        for ( size_t g = 0; g < 2; ++g ) {
+            __m128 const w = clip[g][3];
+            __m128 const behind = _mm_or_ps( _mm_cmple_ps( w, _mm_set1_ps( nearest_w ) ),
+                                             _mm_cmplt_ps( clip[g][2], _mm_sub_ps( _mm_setzero_ps(), w ) ) );
+            if ( _mm_movemask_ps( behind ) != 0 ) { return false; }
+            __m128 const inverse = _mm_div_ps( one, w );
+            xs[g] = _mm_mul_ps( _mm_add_ps( _mm_mul_ps( clip[g][0], inverse ), one ),
+                                _mm_set1_ps( half_w ) );
+            ys[g] = _mm_mul_ps( _mm_add_ps( _mm_mul_ps( clip[g][1], inverse ), one ),
+                                _mm_set1_ps( half_h ) );
+            zs[g] = _mm_add_ps( _mm_mul_ps( _mm_mul_ps( clip[g][2], inverse ), half ), half );
+        }
+        low_x = lowest( _mm_min_ps( xs[0], xs[1] ) );
+        high_x = highest( _mm_max_ps( xs[0], xs[1] ) );
+        low_y = lowest( _mm_min_ps( ys[0], ys[1] ) );
+        high_y = highest( _mm_max_ps( ys[0], ys[1] ) );
+        nearest = lowest( _mm_min_ps( zs[0], zs[1] ) );
+#else
+        low_x = low_y = nearest = FLT_MAX;
+        high_x = high_y = -FLT_MAX;
+        for ( size_t c = 0; c < 8; ++c ) {
+            float clip[4];
+            for ( size_t row = 0; row < 4; ++row ) {
+                clip[row] = middle[row] + ( ( c & 1 ) ? axes[0][row] : -axes[0][row] )
+                                        + ( ( c & 2 ) ? axes[1][row] : -axes[1][row] )
+                                        + ( ( c & 4 ) ? axes[2][row] : -axes[2][row] );
+            }
+            if ( clip[3] <= nearest_w or clip[2] < -clip[3] ) { return false; }
+            float const inverse = 1.0f / clip[3];
+            float const x = ( clip[0] * inverse + 1.0f ) * half_w;
+            float const y = ( clip[1] * inverse + 1.0f ) * half_h;
+            low_x = std::min( low_x, x );
+            high_x = std::max( high_x, x );
+            low_y = std::min( low_y, y );
+            high_y = std::max( high_y, y );
+            nearest = std::min( nearest, clip[2] * inverse * 0.5f + 0.5f );
+        }
+#endif
+        if ( high_x < 0.0f or high_y < 0.0f
+             or low_x >= float( width_v ) or low_y >= float( height_v ) ) {
+            return false;
+        }
+
+        // Every pixel the rectangle touches, whole or in part
+        size_t const x0 = low_x <= 0.0f ? 0 : size_t( low_x );
+        size_t const y0 = low_y <= 0.0f ? 0 : size_t( low_y );
+        size_t const x1 = std::min( size_t( high_x ) + 1, width_v );
+        size_t const y1 = std::min( size_t( high_y ) + 1, height_v );
+        for ( size_t ty = y0 / tile; ty * tile < y1; ++ty ) {
+            for ( size_t tx = x0 / tile; tx * tile < x1; ++tx ) {
+                if ( nearest > tile_far[ty * tiles_x + tx] ) { continue; }
+                size_t const row_begin = std::max( y0, ty * tile );
+                size_t const row_end = std::min( y1, ( ty + 1 ) * tile );
+                size_t const col_begin = std::max( x0, tx * tile );
+                size_t const col_end = std::min( x1, ( tx + 1 ) * tile );
+                for ( size_t y = row_begin; y < row_end; ++y ) {
+                    float const* row = &depths[y * width_v];
+                    size_t x = col_begin;
+#ifdef __SSE__
+                    __m128 const near4 = _mm_set1_ps( nearest );
+                    for ( ; x + 4 <= col_end; x += 4 ) {
+                        if ( _mm_movemask_ps( _mm_cmpge_ps( _mm_loadu_ps( row + x ),
+                                                            near4 ) ) != 0 ) {
+                            return false;
+                        }
+                    }
+#endif
+                    for ( ; x < col_end; ++x ) {
+                        if ( row[x] >= nearest ) { return false; }
+                    }
+                }
+            }
+        }
+        return true;
+    }
+    /**
+     * \brief Remove the hidden bounds from a list of candidates, such as
+     * the visible list from a \ref gfx::culler "culler".
+     *
+     * The candidates keep their order.
+     * \param all Every bound, in world space
+     * \param candidates Indices into all; the hidden ones are removed
+     * \return How many candidates were removed
+     */
+    size_t  occlusion_buffer::cull( std::vector<bounds> const& all,
+                                    std::vector<size_t>& candidates )
+    {
+        size_t const count = candidates.size();
+        hidden.assign( count, 0 );
+        size_t threads = std::max( size_t( 1 ), std::min( threads_v, count / 64 ) );
+        size_t const per_thread = ( count + threads - 1 ) / threads;
+        std::vector<std::thread> workers;
+        workers.reserve( threads - 1 );
+        for ( size_t t = 1; t < threads; ++t ) {
+            size_t const begin = t * per_thread;
+            size_t const end = std::min( begin + per_thread, count );
+            workers.push_back( std::thread( &occlusion_buffer::cull_range, this,
+                                            std::cref( all ), std::cref( candidates ),
+                                            begin, end ) );
+        }
+        cull_range( all, candidates, 0, std::min( per_thread, count ) );
+        for ( size_t t = 0; t < workers.size(); ++t ) { workers[t].join(); }
+
+        size_t kept = 0;
+        for ( size_t n = 0; n < count; ++n ) {
+            if ( not hidden[n] ) { candidates[kept++] = candidates[n]; }
+        }
+        candidates.resize( kept );
+        return count - kept;
+    }
+    /**
+     * \brief Return the depth held at a pixel, from 0 at the near plane
+     * to 1 at the far plane.
+     * \param x The column, from the left
+     * \param y The row, from the bottom
+     */
+    float   occlusion_buffer::depth( size_t const x, size_t const y ) const
+    {
+        if ( x >= width_v or y >= height_v ) {
+            throw std::invalid_argument( "Pixel asked of occlusion buffer is out of range." );
+        }
+        return depths[y * width_v + x];
+    }
+    /*
+     * Draws every tile from the first on, a step apart, and notes the
+     * farthest depth left in each.
+     */
+    void    occlusion_buffer::raster_tiles( size_t const first, size_t const step )
+    {
+        for ( size_t t = first; t < bins.size(); t += step ) {
+            size_t const tile_x = ( t % tiles_x ) * tile;
+            size_t const tile_y = ( t / tiles_x ) * tile;
+            std::vector<unsigned int> const& bin = bins[t];
+            for ( size_t n = 0; n < bin.size(); ++n ) {
+                raster_triangle( &tris[bin[n] * 9], tile_x, tile_y );
+            }
+            float farthest = 0.0f;
+            for ( size_t y = tile_y; y < tile_y + tile; ++y ) {
+                float const* row = &depths[y * width_v + tile_x];
+                for ( size_t x = 0; x < tile; ++x ) {
+                    farthest = std::max( farthest, row[x] );
+                }
+            }
+            tile_far[t] = farthest;
+        }
+    }
+    /*
+     * Fills the part of a triangle inside one tile. Each edge and the
+     * depth are planes over the screen, a x + b y + c, evaluated at pixel
+     * centers; a pixel is covered when it is on the inner side of all
+     * three edges, and keeps the nearer of its depth and the triangle's.
+     */
+    void    occlusion_buffer::raster_triangle( float const* tri,
+                                               size_t const tile_x,
+                                               size_t const tile_y )
+    {
+        float const* v0 = tri;
+        float const* v1 = tri + 3;
+        float const* v2 = tri + 6;
+        float area = ( v1[0] - v0[0] ) * ( v2[1] - v0[1] )
+                     - ( v2[0] - v0[0] ) * ( v1[1] - v0[1] );
+        if ( area < 0.0f ) {
+            std::swap( v1, v2 );
+            area = -area;
+        }
+        float const* from[3] = { v0, v1, v2 };
+        float const* to[3] = { v1, v2, v0 };
+        float a[3], b[3], c[3];
+        for ( size_t e = 0; e < 3; ++e ) {
+            a[e] = from[e][1] - to[e][1];
+            b[e] = to[e][0] - from[e][0];
+            c[e] = -a[e] * from[e][0] - b[e] * from[e][1];
+        }
+        // Edge 1 weighs the first corner, edge 2 the second
+        float const dz1 = ( v1[2] - v0[2] ) / area;
+        float const dz2 = ( v2[2] - v0[2] ) / area;
+        float const za = a[2] * dz1 + a[0] * dz2;
+        float const zb = b[2] * dz1 + b[0] * dz2;
+        float const zc = c[2] * dz1 + c[0] * dz2 + v0[2];
+
+        float const low_x = std::min( std::min( v0[0], v1[0] ), v2[0] );
+        float const high_x = std::max( std::max( v0[0], v1[0] ), v2[0] );
+        float const low_y = std::min( std::min( v0[1], v1[1] ), v2[1] );
+        float const high_y = std::max( std::max( v0[1], v1[1] ), v2[1] );
+        size_t const x0 = low_x <= float( tile_x ) ? tile_x : size_t( low_x );
+        size_t const y0 = low_y <= float( tile_y ) ? tile_y : size_t( low_y );
+        size_t const x1 = std::min( tile_x + tile, size_t( std::max( high_x, 0.0f ) ) + 1 );
+        size_t const y1 = std::min( tile_y + tile, size_t( std::max( high_y, 0.0f ) ) + 1 );
+        for ( size_t y = y0; y < y1; ++y ) {
+            float const py = float( y ) + 0.5f;
+            float* row = &depths[y * width_v];
+            size_t x = x0;
+#ifdef __SSE__
+            // Whole groups of four from the tile's edge; lanes outside the
+            // triangle fail the edge tests like any other pixel
+            x &= ~size_t( 3 );
+            __m128 const steps = _mm_set_ps( 3.5f, 2.5f, 1.5f, 0.5f );
+            __m128 const zero = _mm_setzero_ps();
+            for ( ; x < x1; x += 4 ) {
+                __m128 const px = _mm_add_ps( _mm_set1_ps( float( x ) ), steps );
+                __m128 inside = _mm_cmpeq_ps( zero, zero );
+                for ( size_t e = 0; e < 3; ++e ) {
+                    __m128 const edge = _mm_add_ps( _mm_mul_ps( _mm_set1_ps( a[e] ), px ),
+                                                    _mm_set1_ps( b[e] * py + c[e] ) );
+                    inside = _mm_and_ps( inside, _mm_cmpge_ps( edge, zero ) );
+                }
+                if ( _mm_movemask_ps( inside ) == 0 ) { continue; }
+                __m128 const z = _mm_add_ps( _mm_mul_ps( _mm_set1_ps( za ), px ),
+                                             _mm_set1_ps( zb * py + zc ) );
+                __m128 const old = _mm_loadu_ps( row + x );
+                __m128 const nearer = _mm_min_ps( old, z );
+                _mm_storeu_ps( row + x, _mm_or_ps( _mm_and_ps( inside, nearer ),
+                                                   _mm_andnot_ps( inside, old ) ) );
+            }
+#endif
+            for ( ; x < x1; ++x ) {
+                float const px = float( x ) + 0.5f;
+                if ( a[0] * px + b[0] * py + c[0] >= 0.0f
+                     and a[1] * px + b[1] * py + c[1] >= 0.0f
+                     and a[2] * px + b[2] * py + c[2] >= 0.0f ) {
+                    float const z = za * px + zb * py + zc;
+                    row[x] = std::min( row[x], z );
+                }
+            }
+        }
+    }
+    /* Marks which of a run of candidates are hidden. */
+    void    occlusion_buffer::cull_range( std::vector<bounds> const& all,
+                                          std::vector<size_t> const& candidates,
+                                          size_t const begin,
+                                          size_t const end )
+    {
+        for ( size_t n = begin; n < end; ++n ) {
+            hidden[n] = occluded( all[candidates[n]] ) ? 1 : 0;
+        }
+    }
+
+}
@@ -0,0 +1,171 @@
+#ifndef OCCLUSION_HPP
+#define OCCLUSION_HPP
+
+#include <stdexcept>
+#include <vector>
+
+#include "../gMath/datatype.hpp"
+#include "buffer.hpp"
+#include "camera.hpp"
+#include "culling.hpp"
+
+namespace gfx {
+    /**
+     * \class gfx::occlusion_buffer occlusion.hpp "gCore/gScene/occlusion.hpp"
+     * \brief A small depth buffer drawn on the CPU from a few large
+     * occluders, for finding objects hidden behind them before they are
+     * drawn.
+     *
+     * A frame starts with \ref begin() "begin()", which takes the camera's
+     * combined view and projection. Occluders are then given as triangle
+     * lists, from plain points or from a vec3 attribute of a
+     * \ref gfx::buffer "buffer", and \ref rasterize() "rasterize()" draws
+     * them. Bounds can then be tested against what was drawn.
+     *
+     * The buffer is split into tiles of sixteen by sixteen pixels. Every
+     * triangle is listed in the tiles its box touches, and the tiles are
+     * shared out among the threads, so no two threads write the same
+     * pixel. Within a tile four pixels are filled at a time with SSE where
+     * it is available. Each tile also keeps the farthest depth it holds,
+     * so a bound behind all of a tile is passed over without looking at
+     * its pixels.
+     *
+     * Occluders are only ever allowed to hide too little: a triangle that
+     * reaches behind the near plane is dropped rather than clipped, and a
+     * bound that does is never reported hidden. Nothing here touches
+     * OpenGL, so the buffer works without a context.
+     */
+    class occlusion_buffer {
+    public:
+        /**
+         * \class gfx::occlusion_buffer::settings
+         * \brief Used to configure an
+         * \ref gfx::occlusion_buffer "occlusion_buffer".
+         */
+        class settings {
+        public:
+                            settings();
+            settings&       width( size_t const pixels );
+            settings&       height( size_t const pixels );
+            settings&       threads( size_t const count );
+        private:
+            friend          class occlusion_buffer;
+            size_t          width_v;
+            size_t          height_v;
+            size_t          threads_v;
+        };
+
+                            occlusion_buffer( settings const& set = settings() );
+        void                begin( mat4 const& view_projection );
+        void                begin( camera& cam );
+        void                occluder( float const* points,
+                                      size_t const count,
+                                      mat4 const& model,
+                                      size_t const stride = sizeof( float ) * 3 );
+        void                occluder( buffer const& geom,
+                                      GLuint const index,
+                                      mat4 const& model );
+        void                rasterize();
+        bool                occluded( bounds const& volume ) const;
+        size_t              cull( std::vector<bounds> const& all,
+                                  std::vector<size_t>& candidates );
+        float               depth( size_t const x, size_t const y ) const;
+        size_t              width() const;
+        size_t              height() const;
+        size_t              triangles() const;
+    private:
+        void                raster_tiles( size_t const first, size_t const step );
+        void                raster_triangle( float const* tri,
+                                             size_t const tile_x,
+                                             size_t const tile_y );
+        void                cull_range( std::vector<bounds> const& all,
+                                        std::vector<size_t> const& candidates,
+                                        size_t const begin,
+                                        size_t const end );
+
+        size_t              width_v;
+        size_t              height_v;
+        size_t              tiles_x;
+        size_t              tiles_y;
+        size_t              threads_v;
+        float               view_projection[16];
+        /* Row by row, from 0 at the near plane to 1 at the far plane. */
+        std::vector<float>  depths;
+        std::vector<float>  tile_far;
+        /* Nine floats a triangle: x and y in pixels and depth, per corner. */
+        std::vector<float>  tris;
+        size_t              drawn;
+        std::vector< std::vector<unsigned int> >    bins;
+        std::vector<char>   hidden;
+    };
+    /**
+     * \brief Construct a new occlusion buffer settings object with
+     * default settings.
+     *
+     * By default the buffer is 256 by 128 pixels and is drawn on the
+     * calling thread alone.
+     */
+    inline occlusion_buffer::settings::settings() : width_v ( 256 ),
+                                                    height_v ( 128 ),
+                                                    threads_v ( 1 ) {}
+    /**
+     * \brief Set the width of the buffer.
+     * \param pixels The width, rounded up to a whole number of tiles
+     * \return This settings object
+     */
+    inline occlusion_buffer::settings&  occlusion_buffer::settings::width( size_t const pixels )
+    {
+        if ( pixels == 0 ) {
+            throw std::invalid_argument( "An occlusion buffer needs a width of at least one pixel." );
+        }
+        width_v = pixels;
+        return *this;
+    }
+    /**
+     * \brief Set the height of the buffer.
+     * \param pixels The height, rounded up to a whole number of tiles
+     * \return This settings object
+     */
+    inline occlusion_buffer::settings&  occlusion_buffer::settings::height( size_t const pixels )
+    {
+        if ( pixels == 0 ) {
+            throw std::invalid_argument( "An occlusion buffer needs a height of at least one pixel." );
+        }
+        height_v = pixels;
+        return *this;
+    }
+    /**
+     * \brief Set how many threads \ref rasterize() "rasterize()" and
+     * \ref cull() "cull()" may use.
+     *
+     * The calling thread is one of them.
+     * \param count The number of threads; zero is taken as one
+     * \return This settings object
+     */
+    inline occlusion_buffer::settings&  occlusion_buffer::settings::threads( size_t const count )
+    {
+        threads_v = count == 0 ? 1 : count;
+        return *this;
+    }
+    /**
+     * \brief Return the width of the buffer in pixels.
+     */
+    inline size_t   occlusion_buffer::width() const
+    { return width_v; }
+    /**
+     * \brief Return the height of the buffer in pixels.
+     */
+    inline size_t   occlusion_buffer::height() const
+    { return height_v; }
+    /**
+     * \brief Return how many occluder triangles are waiting to be, or
+     * have been, drawn this frame.
+     *
+     * Triangles dropped for reaching behind the near plane, lying wholly
+     * off the buffer or having no area are not counted.
+     */
+    inline size_t   occlusion_buffer::triangles() const
+    { return tris.size() / 9; }
+}
+
+#endif
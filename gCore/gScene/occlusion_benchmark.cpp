@@ -0,0 +1,113 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "../gMath/datatype.hpp"
+#include "culling.hpp"
+#include "occlusion.hpp"
+
+using namespace gfx;
+
+/*
+ * A street of large boxes standing in front of a field of small objects.
+ * The boxes are drawn into an occlusion buffer on one thread and then on
+ * several, and the objects the frustum keeps are tested against it.
+ *
+ * Usage: occlusion_benchmark [objects] [occluders] [frames] [threads]
+ */
+namespace {
+    typedef std::chrono::high_resolution_clock  bench_clock;
+
+    double  since( bench_clock::time_point const start )
+    {
+        return std::chrono::duration<double, std::milli>( bench_clock::now() - start ).count();
+    }
+
+    /* The twelve triangles of a box from low to high. */
+    void    box( vec3 const& low, vec3 const& high, std::vector<float>& out )
+    {
+        static size_t const faces[12][3] = { { 0, 1, 3 }, { 0, 3, 2 }, { 4, 6, 7 }, { 4, 7, 5 },
+                                             { 0, 4, 5 }, { 0, 5, 1 }, { 2, 3, 7 }, { 2, 7, 6 },
+                                             { 0, 2, 6 }, { 0, 6, 4 }, { 1, 5, 7 }, { 1, 7, 3 } };
+        for ( size_t f = 0; f < 12; ++f ) {
+            for ( size_t v = 0; v < 3; ++v ) {
+                size_t const c = faces[f][v];
+                out.push_back( ( c & 1 ) ? high[0] : low[0] );
+                out.push_back( ( c & 2 ) ? high[1] : low[1] );
+                out.push_back( ( c & 4 ) ? high[2] : low[2] );
+            }
+        }
+    }
+}
+
+int main( int argc, char** argv )
+{
+    size_t count = ( argc > 1 ) ? std::strtoul( argv[1], 0, 10 ) : 100000;
+    size_t occluders = ( argc > 2 ) ? std::strtoul( argv[2], 0, 10 ) : 40;
+    size_t frames = ( argc > 3 ) ? std::strtoul( argv[3], 0, 10 ) : 20;
+    size_t threads = ( argc > 4 ) ? std::strtoul( argv[4], 0, 10 ) : 4;
+    if ( frames == 0 ) { frames = 1; }
+
+    std::srand( 5 );
+    std::vector<float> street;
+    for ( size_t n = 0; n < occluders; ++n ) {
+        vec3 const low ( float( std::rand() % 160 ) - 80.0f, -5.0f,
+                         -5.0f - float( std::rand() % 40 ) );
+        box( low, low + vec3( 2.0f + float( std::rand() % 8 ),
+                              4.0f + float( std::rand() % 20 ),
+                              2.0f + float( std::rand() % 8 ) ), street );
+    }
+    std::vector<bounds> all;
+    culler field;
+    for ( size_t n = 0; n < count; ++n ) {
+        vec3 const center ( float( std::rand() % 4000 ) * 0.05f - 100.0f,
+                            float( std::rand() % 200 ) * 0.05f - 5.0f,
+                            -50.0f - float( std::rand() % 2000 ) * 0.05f );
+        all.push_back( bounds( center, 0.5f + float( std::rand() % 10 ) * 0.1f ) );
+        field.add( all.back() );
+    }
+
+    mat4 const view = mat4::perspective( d_angle::in_degs( 60.0 ), 2.0, 0.5, 200.0 )
+                      * mat4::translate( vec3( 0.0f, -1.0f, 0.0f ) );
+    std::vector<size_t> const in_view = field.cull( frustum( view ) );
+
+    occlusion_buffer serial;
+    occlusion_buffer threaded ( occlusion_buffer::settings().threads( threads ) );
+    double serial_ms = 0.0;
+    double threaded_ms = 0.0;
+    double test_ms = 0.0;
+    double threaded_test_ms = 0.0;
+    size_t hidden = 0;
+    for ( size_t f = 0; f < frames; ++f ) {
+        bench_clock::time_point start = bench_clock::now();
+        serial.begin( view );
+        serial.occluder( &street[0], street.size() / 3, mat4::identity() );
+        serial.rasterize();
+        serial_ms += since( start );
+
+        start = bench_clock::now();
+        threaded.begin( view );
+        threaded.occluder( &street[0], street.size() / 3, mat4::identity() );
+        threaded.rasterize();
+        threaded_ms += since( start );
+
+        std::vector<size_t> candidates = in_view;
+        start = bench_clock::now();
+        hidden = serial.cull( all, candidates );
+        test_ms += since( start );
+        candidates = in_view;
+        start = bench_clock::now();
+        threaded.cull( all, candidates );
+        threaded_test_ms += since( start );
+    }
+
+    std::cout << count << " objects, " << in_view.size() << " in view, "
+              << serial.triangles() << " occluder triangles\n"
+              << "rasterize, 1 thread:     " << serial_ms / frames << " ms/frame\n"
+              << "rasterize, " << threads << " thread(s):  " << threaded_ms / frames << " ms/frame\n"
+              << "test, 1 thread:          " << test_ms / frames << " ms/frame\n"
+              << "test, " << threads << " thread(s):       " << threaded_test_ms / frames << " ms/frame\n"
+              << "hidden:                  " << hidden << " of " << in_view.size() << "\n";
+    return 0;
+}
@@ -0,0 +1,176 @@
+#include <cstdlib>
+#include <stdexcept>
+#include <vector>
+
+#include "../../UnitTest++_src/UnitTest++.h"
+
+#include "../gVideo/video.hpp"
+#include "../gMath/datatype.hpp"
+#include "occlusion.hpp"
+#include "vertex_buffer.hpp"
+
+using namespace gfx;
+
+namespace {
+    /* A square wall facing the camera, as two triangles. */
+    std::vector<float>  wall( float const half, float const z )
+    {
+        float const corners[18] = { -half, -half, z,   half, -half, z,   half, half, z,
+                                    -half, -half, z,   half, half, z,   -half, half, z };
+        return std::vector<float>( corners, corners + 18 );
+    }
+
+    proj_cam    eye()
+    {
+        return proj_cam( proj_cam::settings()
+                         .position( vec3( 0.0f, 0.0f, 0.0f ) )
+                         .look_at( vec3( 0.0f, 0.0f, -1.0f ) )
+                         .field_of_view( d_angle::in_degs( 60.0 ) )
+                         .aspect_ratio( 2.0 )
+                         .near_plane( 0.5 )
+                         .far_plane( 100.0 ) );
+    }
+}
+
+SUITE( OcclusionTests )
+{
+    TEST( WallHidesWhatIsBehindIt )
+    {
+        proj_cam cam = eye();
+        occlusion_buffer depth_map;
+        CHECK_EQUAL( 256u, depth_map.width() );
+        CHECK_EQUAL( 128u, depth_map.height() );
+        depth_map.begin( cam );
+        std::vector<float> points = wall( 3.0f, -10.0f );
+        depth_map.occluder( &points[0], 6, mat4::identity() );
+        depth_map.rasterize();
+        CHECK_EQUAL( 2u, depth_map.triangles() );
+
+        CHECK( depth_map.depth( 128, 64 ) < 1.0f );
+        CHECK( depth_map.depth( 128, 64 ) > 0.0f );
+        CHECK_EQUAL( 1.0f, depth_map.depth( 0, 0 ) );
+        CHECK_THROW( depth_map.depth( 256, 0 ), std::invalid_argument );
+
+        vec3 const half ( 1.0f );
+        CHECK( depth_map.occluded( bounds( vec3( 0.0f, 0.0f, -20.0f ) - half,
+                                           vec3( 0.0f, 0.0f, -20.0f ) + half ) ) );
+        CHECK( not depth_map.occluded( bounds( vec3( 0.0f, 0.0f, -5.0f ), 1.0f ) ) );
+        // Partly past the wall's edge, and wholly past it
+        CHECK( not depth_map.occluded( bounds( vec3( 5.5f, 0.0f, -20.0f ), 1.0f ) ) );
+        CHECK( not depth_map.occluded( bounds( vec3( 8.0f, 0.0f, -20.0f ), 1.0f ) ) );
+        // Straddling the wall, and reaching behind the eye
+        CHECK( not depth_map.occluded( bounds( vec3( 0.0f, 0.0f, -10.0f ), 0.5f ) ) );
+        CHECK( not depth_map.occluded( bounds( vec3( 0.0f, 0.0f, 0.0f ), 1.0f ) ) );
+
+        // A new frame forgets the wall
+        depth_map.begin( cam );
+        depth_map.rasterize();
+        CHECK_EQUAL( 0u, depth_map.triangles() );
+        CHECK( not depth_map.occluded( bounds( vec3( 0.0f, 0.0f, -20.0f ), 1.0f ) ) );
+    }
+
+    TEST( WorldMatrixMovesOccluder )
+    {
+        proj_cam cam = eye();
+        occlusion_buffer depth_map;
+        depth_map.begin( cam );
+        std::vector<float> points = wall( 3.0f, 0.0f );
+        depth_map.occluder( &points[0], 6, mat4::translate( vec3( 0.0f, 0.0f, -10.0f ) ) );
+        // Behind the eye, so dropped rather than drawn
+        depth_map.occluder( &points[0], 6, mat4::translate( vec3( 0.0f, 0.0f, 10.0f ) ) );
+        depth_map.rasterize();
+        CHECK_EQUAL( 2u, depth_map.triangles() );
+        CHECK( depth_map.occluded( bounds( vec3( 0.0f, 0.0f, -20.0f ), 1.0f ) ) );
+    }
+
+    TEST( ThreadsMatchOneThread )
+    {
+        proj_cam cam = eye();
+        occlusion_buffer serial ( occlusion_buffer::settings()
+                                  .width( 200 )
+                                  .height( 100 ) );
+        occlusion_buffer threaded ( occlusion_buffer::settings()
+                                    .width( 200 )
+                                    .height( 100 )
+                                    .threads( 4 ) );
+        CHECK_EQUAL( 208u, serial.width() );
+        CHECK_EQUAL( 112u, serial.height() );
+        serial.begin( cam );
+        threaded.begin( cam );
+        std::srand( 9 );
+        for ( size_t n = 0; n < 40; ++n ) {
+            std::vector<float> points = wall( 0.5f + float( std::rand() % 20 ) * 0.1f,
+                                              -5.0f - float( std::rand() % 40 ) );
+            mat4 const place = mat4::translate( vec3( float( std::rand() % 30 ) - 15.0f,
+                                                      float( std::rand() % 14 ) - 7.0f,
+                                                      0.0f ) )
+                               * mat4::rotation( vec3( 0.0f, 1.0f, 0.0f ),
+                                                 d_angle::in_degs( double( std::rand() % 90 ) - 45.0 ) );
+            serial.occluder( &points[0], 6, place );
+            threaded.occluder( &points[0], 6, place );
+        }
+        serial.rasterize();
+        threaded.rasterize();
+        bool same = true;
+        for ( size_t y = 0; y < serial.height(); ++y ) {
+            for ( size_t x = 0; x < serial.width(); ++x ) {
+                same = same and serial.depth( x, y ) == threaded.depth( x, y );
+            }
+        }
+        CHECK( same );
+
+        std::vector<bounds> all;
+        std::vector<size_t> candidates;
+        for ( size_t n = 0; n < 2000; ++n ) {
+            vec3 const center ( float( std::rand() % 60 ) - 30.0f,
+                                float( std::rand() % 30 ) - 15.0f,
+                                -float( std::rand() % 60 ) - 1.0f );
+            all.push_back( bounds( center, 0.1f + float( std::rand() % 10 ) * 0.1f ) );
+            if ( n % 3 != 0 ) { candidates.push_back( n ); }
+        }
+        std::vector<size_t> expected;
+        for ( size_t n = 0; n < candidates.size(); ++n ) {
+            if ( not serial.occluded( all[candidates[n]] ) ) {
+                expected.push_back( candidates[n] );
+            }
+        }
+        CHECK( expected.size() < candidates.size() );
+        size_t const removed = candidates.size() - expected.size();
+        CHECK_EQUAL( removed, threaded.cull( all, candidates ) );
+        CHECK( expected == candidates );
+    }
+
+    TEST( OccluderFromBuffer )
+    {
+        gl_backend::use_null();
+        context test_cntx ( ( context::settings() ) );
+
+        std::vector<float> points = wall( 3.0f, -10.0f );
+        std::vector<vec3> corners;
+        for ( size_t n = 0; n < 6; ++n ) {
+            corners.push_back( vec3( points[n * 3], points[n * 3 + 1], points[n * 3 + 2] ) );
+        }
+        vertex_buffer geom ( vertex_buffer::settings()
+                             .blocks( 6 ) );
+        geom.block_format( block_spec()
+                           .attribute( type<vec3>() )
+                           .attribute( type<vec2>() ) );
+        geom.load_attribute( 0, corners );
+
+        proj_cam cam = eye();
+        occlusion_buffer depth_map;
+        depth_map.begin( cam );
+        depth_map.occluder( geom, 0, mat4::identity() );
+        depth_map.rasterize();
+        CHECK_EQUAL( 2u, depth_map.triangles() );
+        CHECK( depth_map.occluded( bounds( vec3( 0.0f, 0.0f, -20.0f ), 1.0f ) ) );
+        CHECK_THROW( depth_map.occluder( geom, 1, mat4::identity() ), std::invalid_argument );
+        CHECK_THROW( depth_map.occluder( geom, 2, mat4::identity() ), std::invalid_argument );
+    }
+}
+
+int main( int argc, char* argv[] )
+{
+    video_system::get().initialize( video_system::settings().ver( 3, 3 ) );
+    return UnitTest::RunAllTests();
+}
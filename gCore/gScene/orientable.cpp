@@ -1,69 +1,142 @@
 #include "orientable.hpp"
 
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
 namespace gfx {
+
+    namespace {
+        /*
+         * translate * rotation * scale written out directly: the rotation
+         * matrix of the quaternion with each column multiplied by its
+         * scale, and the position in the last column. The same sums
+         * mat4::rotation() does, and nothing else.
+         */
+        void    compose_one( float const px, float const py, float const pz,
+                             float const qi, float const qj,
+                             float const qk, float const qm,
+                             float const sx, float const sy, float const sz,
+                             float* out )
+        {
+            float const ii = qi * qi * 2.0f;
+            float const ij = qi * qj * 2.0f;
+            float const ik = qi * qk * 2.0f;
+            float const im = qi * qm * 2.0f;
+            float const jj = qj * qj * 2.0f;
+            float const jk = qj * qk * 2.0f;
+            float const jm = qj * qm * 2.0f;
+            float const kk = qk * qk * 2.0f;
+            float const km = qk * qm * 2.0f;
+
+            out[0] = ( 1.0f - ( jj + kk ) ) * sx;
+            out[1] = ( ij + km ) * sx;
+            out[2] = ( ik - jm ) * sx;
+            out[3] = 0.0f;
+            out[4] = ( ij - km ) * sy;
+            out[5] = ( 1.0f - ( ii + kk ) ) * sy;
+            out[6] = ( jk + im ) * sy;
+            out[7] = 0.0f;
+            out[8] = ( ik + jm ) * sz;
+            out[9] = ( jk - im ) * sz;
+            out[10] = ( 1.0f - ( ii + jj ) ) * sz;
+            out[11] = 0.0f;
+            out[12] = px;
+            out[13] = py;
+            out[14] = pz;
+            out[15] = 1.0f;
+        }
+
+#ifdef __SSE__
+        /*
+         * Stores one column for four objects: a, b and c hold rows 0 to 2
+         * of the column for each object in turn, and w the last row.
+         */
+        inline void store_column( __m128 a, __m128 b, __m128 c, __m128 w,
+                                  float* first, size_t const column )
+        {
+            _MM_TRANSPOSE4_PS( a, b, c, w );
+            _mm_storeu_ps( first + column * 4, a );
+            _mm_storeu_ps( first + 16 + column * 4, b );
+            _mm_storeu_ps( first + 32 + column * 4, c );
+            _mm_storeu_ps( first + 48 + column * 4, w );
+        }
+#endif
+    }
+
     /**
      * \brief Construct a new orientable object.
      */
-    orientable::orientable( settings const& set ) : orientation_changed( false ),
+    orientable::orientable( settings const& set ) : orientation_changed( true ),
                                                     scl ( set.scl_v ),
                                                     rot ( set.rot_v ),
                                                     pos ( set.pos_v ),
                                                     obj_mtrx( mat4::identity() )
-    {
-        obj_mtrx = update_obj_mtrx();
-    }
-    /**
-     * \brief Return the scale of the orientable object.
-     * \return The scale of the orientable object.
-     */
-    vec3 const& orientable::scale() 
-    { return scl; }
+    {}
     /**
      * \brief Set the scale of the orientable object.
-     * \param stc The scale of the orientable object.
+     * \param scl The scale of the orientable object.
      * \return This orientable object
      */
-    orientable& orientable::stretch( vec3 const& stc ) 
+    orientable& orientable::scale( vec3 const& scl )
     {
         orientation_changed = true;
-        this->scl *= stc;
+        this->scl = scl;
         return *this;
     }
     /**
-     * \brief Return the rotiation of the orientable object.
-     * \return The rotation of the orientable object.
+     * \brief Multiply the scale of the orientable object.
+     * \param stc The factors to multiply the scale by.
+     * \return This orientable object
      */
-    vec3 const& orientable::rotation() 
-    { return rot; }
+    orientable& orientable::stretch( vec3 const& stc )
+    {
+        orientation_changed = true;
+        this->scl = this->scl * stc;
+        return *this;
+    }
     /**
      * \brief Set the rotation of the orientable object.
-     * \param stc The rotation of the orientable object.
+     * \param rot The rotation of the orientable object.
      * \return This orientable object
      */
-    orientable& orientable::rotate( qutn const& rot ) 
+    orientable& orientable::rotation( qutn const& rot )
     {
         orientation_changed = true;
-        this->rot *= rot;
+        this->rot = rot;
         return *this;
     }
     /**
-     * \brief Return the position of the orientable object.
-     * \return The position of the orientable object.
+     * \brief Compose a rotation with that of the orientable object.
+     * \param rot The rotation to compose.
+     * \return This orientable object
      */
-    orientable& orientable::position( vec3 const& pos ) 
+    orientable& orientable::rotate( qutn const& rot )
     {
         orientation_changed = true;
-        this->pos = pos;
+        this->rot = this->rot * rot;
+        return *this;
     }
     /**
      * \brief Set the position of the orientable object.
-     * \param stc The position of the orientable object.
+     * \param pos The position of the orientable object.
      * \return This orientable object
      */
-    orientable& orientable::move( vec3 const& mov ) 
+    orientable& orientable::position( vec3 const& pos )
     {
         orientation_changed = true;
-        this->pos += mov;
+        this->pos = pos;
+        return *this;
+    }
+    /**
+     * \brief Move the orientable object.
+     * \param mov The offset to move the orientable object by.
+     * \return This orientable object
+     */
+    orientable& orientable::move( vec3 const& mov )
+    {
+        orientation_changed = true;
+        this->pos = this->pos + mov;
         return *this;
     }
     /**
@@ -77,15 +150,104 @@ namespace gfx {
         }
         return obj_mtrx;
     }
+    /**
+     * \brief Write the transformation matrix of this orientable object as
+     * sixteen column major floats.
+     *
+     * This builds the matrix straight from the scale, rotation and
+     * position, and leaves the matrix kept by the object alone.
+     * \param matrix Where to write the matrix
+     */
+    void    orientable::object_matrix( float* matrix ) const
+    {
+        compose_one( pos[0], pos[1], pos[2],
+                     rot[0], rot[1], rot[2], rot[3],
+                     scl[0], scl[1], scl[2], matrix );
+    }
+    /**
+     * \brief Build the transformation matrices of many objects at once.
+     *
+     * Each matrix is what \ref object_matrix() "object_matrix()" would
+     * give for the same scale, rotation and position. Four objects are
+     * done at a time with SSE where it is available.
+     * \param in The streams of positions, rotations and scales
+     * \param count The number of objects
+     * \param matrices Where to write the matrices, sixteen column major
+     * floats each
+     */
+    void    orientable::compose( streams const& in,
+                                 size_t const count,
+                                 float* matrices )
+    {
+        size_t n = 0;
+#ifdef __SSE__
+        __m128 const zero = _mm_setzero_ps();
+        __m128 const one = _mm_set1_ps( 1.0f );
+        __m128 const two = _mm_set1_ps( 2.0f );
+        for ( ; n + 4 <= count; n += 4 ) {
+            __m128 const qi = _mm_loadu_ps( in.rotation[0] + n );
+            __m128 const qj = _mm_loadu_ps( in.rotation[1] + n );
+            __m128 const qk = _mm_loadu_ps( in.rotation[2] + n );
+            __m128 const qm = _mm_loadu_ps( in.rotation[3] + n );
+            __m128 const i2 = _mm_mul_ps( qi, two );
+            __m128 const j2 = _mm_mul_ps( qj, two );
+            __m128 const k2 = _mm_mul_ps( qk, two );
+            __m128 const ii = _mm_mul_ps( qi, i2 );
+            __m128 const ij = _mm_mul_ps( qi, j2 );
+            __m128 const ik = _mm_mul_ps( qi, k2 );
+            __m128 const im = _mm_mul_ps( qm, i2 );
+            __m128 const jj = _mm_mul_ps( qj, j2 );
+            __m128 const jk = _mm_mul_ps( qj, k2 );
+            __m128 const jm = _mm_mul_ps( qm, j2 );
+            __m128 const kk = _mm_mul_ps( qk, k2 );
+            __m128 const km = _mm_mul_ps( qm, k2 );
+            __m128 const sx = _mm_loadu_ps( in.scale[0] + n );
+            __m128 const sy = _mm_loadu_ps( in.scale[1] + n );
+            __m128 const sz = _mm_loadu_ps( in.scale[2] + n );
+
+            float* first = matrices + n * 16;
+            store_column( _mm_mul_ps( _mm_sub_ps( one, _mm_add_ps( jj, kk ) ), sx ),
+                          _mm_mul_ps( _mm_add_ps( ij, km ), sx ),
+                          _mm_mul_ps( _mm_sub_ps( ik, jm ), sx ),
+                          zero, first, 0 );
+            store_column( _mm_mul_ps( _mm_sub_ps( ij, km ), sy ),
+                          _mm_mul_ps( _mm_sub_ps( one, _mm_add_ps( ii, kk ) ), sy ),
+                          _mm_mul_ps( _mm_add_ps( jk, im ), sy ),
+                          zero, first, 1 );
+            store_column( _mm_mul_ps( _mm_add_ps( ik, jm ), sz ),
+                          _mm_mul_ps( _mm_sub_ps( jk, im ), sz ),
+                          _mm_mul_ps( _mm_sub_ps( one, _mm_add_ps( ii, jj ) ), sz ),
+                          zero, first, 2 );
+            store_column( _mm_loadu_ps( in.position[0] + n ),
+                          _mm_loadu_ps( in.position[1] + n ),
+                          _mm_loadu_ps( in.position[2] + n ),
+                          one, first, 3 );
+        }
+#endif
+        for ( ; n < count; ++n ) {
+            compose_one( in.position[0][n], in.position[1][n], in.position[2][n],
+                         in.rotation[0][n], in.rotation[1][n],
+                         in.rotation[2][n], in.rotation[3][n],
+                         in.scale[0][n], in.scale[1][n], in.scale[2][n],
+                         matrices + n * 16 );
+        }
+    }
     /**
      * \brief Generate the trnasformation matrix from current settings.
+     *
+     * Matrices multiply column vectors, so the scale is applied first and
+     * the translation last. The product is written out directly rather
+     * than built from three matrices.
      */
-    void    orientable::update_obj_mtrx()
+    void    orientable::update_obj_mtrx() const
     {
-        obj_mtrx = mat4::scale( scl )
-                   * mat4::rotation( rot )
-                   * mat4::position( pos );
+        float c[16];
+        object_matrix( c );
+        obj_mtrx = mat4( c[0], c[4], c[8],  c[12],
+                         c[1], c[5], c[9],  c[13],
+                         c[2], c[6], c[10], c[14],
+                         c[3], c[7], c[11], c[15] );
         orientation_changed = false;
     }
-    
-}
\ No newline at end of file
+
+}
@@ -23,9 +23,25 @@ namespace gfx {
      * or effects objects which have non-euclidean properties (such as a sky
      * box). Orientable does NOT imply that the object is collidable, though.
      * That would be the job of the (as yet unwritten) collidable class.
+     *
+     * Many transforms can be turned into matrices at once with
+     * \ref compose() "compose()", which works on separate streams of
+     * positions, rotations and scales four objects at a time.
      */
     class orientable {
     public:
+        /**
+         * \brief The transforms of many objects, one stream per component.
+         *
+         * Entry n of every stream belongs to object n; rotation holds the
+         * i, j, k and real parts of each quaternion.
+         */
+        struct streams {
+            float const*    position[3];
+            float const*    rotation[4];
+            float const*    scale[3];
+        };
+
         class settings {
         public:
                         settings();
@@ -33,6 +49,7 @@ namespace gfx {
             settings&   rotation( qutn const& rot );
             settings&   position( vec3 const& pos );
         protected:
+            friend      class orientable;
             vec3        scl_v;
             qutn        rot_v;
             vec3        pos_v;
@@ -48,14 +65,18 @@ namespace gfx {
         orientable&     move( vec3 const& mov );
         vec3 const&     position() const;
         mat4 const&     object_matrix() const;
+        void            object_matrix( float* matrix ) const;
+        static void     compose( streams const& in,
+                                 size_t const count,
+                                 float* matrices );
     protected:
-        bool        orientation_changed;
-        void        update_obj_mtrx();
+        mutable bool    orientation_changed;
+        void            update_obj_mtrx() const;
     private:
-        vec3        scl;
-        qutn        rot;
-        vec3        pos;
-        mat4        obj_mtrx;
+        vec3            scl;
+        qutn            rot;
+        vec3            pos;
+        mutable mat4    obj_mtrx;
     };
     /**
      * \brief Construct a new orientable settings object with default settings.
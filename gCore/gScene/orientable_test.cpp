@@ -0,0 +1,83 @@
+#include <cmath>
+#include <vector>
+
+#include "../../UnitTest++_src/UnitTest++.h"
+
+#include "../gMath/datatype.hpp"
+#include "orientable.hpp"
+
+using namespace gfx;
+
+SUITE( OrientableTests )
+{
+    TEST( DirectMatchesProduct )
+    {
+        vec3 pos ( 1.0f, -2.0f, 3.5f );
+        qutn rot ( 0.1825742f, 0.3651484f, 0.5477226f, 0.7302967f );
+        vec3 scl ( 2.0f, 0.5f, 1.5f );
+        orientable thing ( orientable::settings()
+                           .position( pos )
+                           .rotation( rot )
+                           .scale( scl ) );
+
+        mat4 product = mat4::translate( pos )
+                       * mat4::rotation( rot )
+                       * mat4::scale( scl );
+        CHECK( product == thing.object_matrix() );
+
+        thing.move( vec3( 1.0f, 1.0f, 1.0f ) );
+        CHECK_CLOSE( 2.0f, thing.object_matrix()( 3, 0 ), 0.00001f );
+        CHECK_CLOSE( 1.0f, thing.object_matrix()( 3, 3 ), 0.00001f );
+    }
+
+    TEST( BatchMatchesSingle )
+    {
+        // Seven objects: one batch of four and three left over
+        size_t const count = 7;
+        std::vector<orientable> things;
+        std::vector<float> components ( count * 10 );
+        orientable::streams in;
+        for ( size_t s = 0; s < 3; ++s ) {
+            in.position[s] = &components[s * count];
+            in.scale[s] = &components[( 7 + s ) * count];
+        }
+        for ( size_t s = 0; s < 4; ++s ) {
+            in.rotation[s] = &components[( 3 + s ) * count];
+        }
+        for ( size_t n = 0; n < count; ++n ) {
+            float const angle = 0.4f * float( n );
+            vec3 pos ( float( n ), 2.0f * float( n ), -1.0f );
+            qutn rot ( std::sin( angle ) * 0.6f, 0.0f,
+                       std::sin( angle ) * 0.8f, std::cos( angle ) );
+            vec3 scl ( 1.0f + float( n ), 1.0f, 0.5f );
+            things.push_back( orientable( orientable::settings()
+                                          .position( pos )
+                                          .rotation( rot )
+                                          .scale( scl ) ) );
+            for ( size_t s = 0; s < 3; ++s ) {
+                components[s * count + n] = pos[s];
+                components[( 7 + s ) * count + n] = scl[s];
+            }
+            for ( size_t s = 0; s < 4; ++s ) {
+                components[( 3 + s ) * count + n] = rot[s];
+            }
+        }
+
+        std::vector<float> matrices ( count * 16 );
+        orientable::compose( in, count, &matrices[0] );
+        for ( size_t n = 0; n < count; ++n ) {
+            float single[16];
+            things[n].object_matrix( single );
+            for ( size_t e = 0; e < 16; ++e ) {
+                CHECK_CLOSE( single[e], matrices[n * 16 + e], 0.00001f );
+            }
+            mat4 const& kept = things[n].object_matrix();
+            CHECK_CLOSE( kept( 1, 2 ), matrices[n * 16 + 6], 0.00001f );
+        }
+    }
+}
+
+int main( int argc, char* argv[] )
+{
+    return UnitTest::RunAllTests();
+}
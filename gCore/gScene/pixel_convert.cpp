@@ -0,0 +1,560 @@
+#include <cmath>
+#include <cstring>
+#include "pixel_convert.hpp"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#ifdef __SSSE3__
+#include <tmmintrin.h>
+#endif
+
+namespace gfx {
+
+    namespace {
+        /*
+         * Lookup tables shared by the kernels. Every eight bit input has
+         * exactly 256 possible values, so the curves are computed once
+         * and indexed from then on.
+         */
+        struct conversion_tables {
+            uint16_t        half[256];
+            float           srgb_float[256];
+            unsigned char   srgb_linear[256];
+            unsigned char   linear_srgb[256];
+
+            conversion_tables()
+            {
+                for ( unsigned i = 0; i < 256u; ++i ) {
+                    float value = float( i ) / 255.0f;
+                    half[i] = float_to_half( value );
+
+                    float linear = value <= 0.04045f ?
+                                        value / 12.92f :
+                                        std::pow( ( value + 0.055f ) / 1.055f, 2.4f );
+                    srgb_float[i] = linear;
+                    srgb_linear[i] = (unsigned char)( linear * 255.0f + 0.5f );
+
+                    float encoded = value <= 0.0031308f ?
+                                        value * 12.92f :
+                                        1.055f * std::pow( value, 1.0f / 2.4f ) - 0.055f;
+                    linear_srgb[i] = (unsigned char)( encoded * 255.0f + 0.5f );
+                }
+            }
+            /*
+             * Only finite values in [0,1] come through here, so there is no
+             * need to handle infinities or NaNs.
+             */
+            static uint16_t float_to_half( float value )
+            {
+                uint32_t bits;
+                std::memcpy( &bits, &value, sizeof( bits ) );
+                uint32_t sign = ( bits >> 16 ) & 0x8000u;
+                int32_t exponent = int32_t( ( bits >> 23 ) & 0xFFu ) - 127 + 15;
+                uint32_t mantissa = bits & 0x7FFFFFu;
+                if ( exponent <= 0 ) {
+                    if ( exponent < -10 ) { return uint16_t( sign ); }
+                    mantissa |= 0x800000u;
+                    uint32_t shift = uint32_t( 14 - exponent );
+                    uint32_t rounded = ( mantissa + ( 1u << ( shift - 1 ) ) ) >> shift;
+                    return uint16_t( sign | rounded );
+                }
+                uint32_t rounded = ( uint32_t( exponent ) << 10 ) | ( mantissa >> 13 );
+                rounded += ( mantissa >> 12 ) & 1u;
+                return uint16_t( sign | rounded );
+            }
+        };
+
+        conversion_tables const& tables()
+        {
+            static conversion_tables const lut;
+            return lut;
+        }
+        /*
+         * Exact division of a product of two bytes by 255, rounded.
+         */
+        inline unsigned char mul_255( unsigned const a, unsigned const b )
+        {
+            unsigned t = a * b + 128u;
+            return (unsigned char)( ( t + ( t >> 8 ) ) >> 8 );
+        }
+#ifdef __SSE2__
+        /*
+         * Spread the first four three-byte texels of a block into one
+         * 32 bit lane each, the fourth byte of every lane being junk.
+         */
+        inline __m128i spread_rgb( __m128i const v )
+        {
+            __m128i const front = _mm_unpacklo_epi32( v, _mm_srli_si128( v, 3 ) );
+            __m128i const back = _mm_unpacklo_epi32( _mm_srli_si128( v, 6 ),
+                                                     _mm_srli_si128( v, 9 ) );
+            return _mm_unpacklo_epi64( front, back );
+        }
+#endif
+    }
+    /**
+     * \brief Swap the red and blue channels of three or four channel
+     * pixels in place.
+     *
+     * This turns FreeImage's BGR(A) ordering into RGB(A).
+     * \param pixels The pixel data
+     * \param texels The number of texels
+     * \param channels The number of channels, three or four
+     */
+    void    swap_red_blue( unsigned char* pixels,
+                           size_t const texels,
+                           size_t const channels )
+    {
+        size_t i = 0;
+        if ( channels == 4 ) {
+#ifdef __SSE2__
+            __m128i const keep = _mm_set1_epi32( int( 0xFF00FF00u ) );
+            __m128i const low = _mm_set1_epi32( 0x000000FF );
+            for ( ; i + 4 <= texels; i += 4 ) {
+                __m128i* block = (__m128i*)( pixels + i * 4 );
+                __m128i v = _mm_loadu_si128( block );
+                __m128i ga = _mm_and_si128( v, keep );
+                __m128i r = _mm_and_si128( _mm_srli_epi32( v, 16 ), low );
+                __m128i b = _mm_slli_epi32( _mm_and_si128( v, low ), 16 );
+                _mm_storeu_si128( block, _mm_or_si128( ga, _mm_or_si128( r, b ) ) );
+            }
+#endif
+        } else if ( channels == 3 ) {
+#ifdef __SSSE3__
+            /*
+             * Four texels a block. Each block loads sixteen bytes, so it
+             * stops while at least six texels are left rather than read
+             * past the end, but stores only its own twelve: a store
+             * reaching into the next block's load would stall it. Plain
+             * SSE2 has no byte shuffle, and spreading the texels into
+             * lanes and back costs more than the scalar loop below.
+             */
+            __m128i const order = _mm_setr_epi8( 2, 1, 0, 5, 4, 3, 8, 7,
+                                                 6, 11, 10, 9, 12, 13, 14, 15 );
+            for ( ; i + 6 <= texels; i += 4 ) {
+                unsigned char* block = pixels + i * 3;
+                __m128i v = _mm_shuffle_epi8( _mm_loadu_si128( (__m128i const*)( block ) ), order );
+                _mm_storel_epi64( (__m128i*)( block ), v );
+                int32_t const last = _mm_cvtsi128_si32( _mm_srli_si128( v, 8 ) );
+                std::memcpy( block + 8, &last, sizeof( last ) );
+            }
+#endif
+        } else {
+            return;
+        }
+        for ( ; i < texels; ++i ) {
+            unsigned char* texel = pixels + i * channels;
+            unsigned char red = texel[2];
+            texel[2] = texel[0];
+            texel[0] = red;
+        }
+    }
+    /**
+     * \brief Widen three channel pixels to four channels.
+     * \param rgb The three channel source
+     * \param rgba The four channel destination
+     * \param texels The number of texels
+     * \param alpha The alpha value to fill in
+     */
+    void    expand_to_rgba( unsigned char const* rgb,
+                            unsigned char* rgba,
+                            size_t const texels,
+                            unsigned char const alpha )
+    {
+        size_t i = 0;
+#ifdef __SSE2__
+        /*
+         * Four texels a block, each loading sixteen bytes, so it stops
+         * while at least six texels are left rather than read past the end.
+         */
+        __m128i const fill = _mm_set1_epi32( int( uint32_t( alpha ) << 24 ) );
+#if defined( __SSSE3__ )
+        __m128i const order = _mm_setr_epi8( 0, 1, 2, -128, 3, 4, 5, -128,
+                                             6, 7, 8, -128, 9, 10, 11, -128 );
+#else
+        __m128i const color = _mm_set1_epi32( 0x00FFFFFF );
+#endif
+        for ( ; i + 6 <= texels; i += 4 ) {
+            __m128i v = _mm_loadu_si128( (__m128i const*)( rgb + i * 3 ) );
+#if defined( __SSSE3__ )
+            v = _mm_shuffle_epi8( v, order );
+#else
+            v = _mm_and_si128( spread_rgb( v ), color );
+#endif
+            _mm_storeu_si128( (__m128i*)( rgba + i * 4 ), _mm_or_si128( v, fill ) );
+        }
+        rgb += i * 3;
+        rgba += i * 4;
+#endif
+        for ( ; i < texels; ++i ) {
+            rgba[0] = rgb[0];
+            rgba[1] = rgb[1];
+            rgba[2] = rgb[2];
+            rgba[3] = alpha;
+            rgb += 3;
+            rgba += 4;
+        }
+    }
+    /**
+     * \brief Widen eight bit normalized components to sixteen bits.
+     *
+     * Multiplying by 257 maps 255 onto 65535 exactly; it is the same as
+     * repeating the byte.
+     * \param src The eight bit components
+     * \param dst The sixteen bit components
+     * \param components The number of components
+     */
+    void    widen_to_16bit( unsigned char const* src,
+                            uint16_t* dst,
+                            size_t const components )
+    {
+        size_t i = 0;
+#ifdef __SSE2__
+        for ( ; i + 16 <= components; i += 16 ) {
+            __m128i v = _mm_loadu_si128( (__m128i const*)( src + i ) );
+            _mm_storeu_si128( (__m128i*)( dst + i ), _mm_unpacklo_epi8( v, v ) );
+            _mm_storeu_si128( (__m128i*)( dst + i + 8 ), _mm_unpackhi_epi8( v, v ) );
+        }
+#endif
+        for ( ; i < components; ++i ) {
+            dst[i] = uint16_t( src[i] ) * 257u;
+        }
+    }
+    /**
+     * \brief Convert eight bit normalized components to floats in [0,1].
+     * \param src The eight bit components
+     * \param dst The float components
+     * \param components The number of components
+     */
+    void    to_float( unsigned char const* src,
+                      float* dst,
+                      size_t const components )
+    {
+        size_t i = 0;
+#ifdef __SSE2__
+        __m128i const zero = _mm_setzero_si128();
+        __m128 const scale = _mm_set1_ps( 1.0f / 255.0f );
+        for ( ; i + 16 <= components; i += 16 ) {
+            __m128i v = _mm_loadu_si128( (__m128i const*)( src + i ) );
+            __m128i lo = _mm_unpacklo_epi8( v, zero );
+            __m128i hi = _mm_unpackhi_epi8( v, zero );
+            _mm_storeu_ps( dst + i,
+                           _mm_mul_ps( _mm_cvtepi32_ps( _mm_unpacklo_epi16( lo, zero ) ), scale ) );
+            _mm_storeu_ps( dst + i + 4,
+                           _mm_mul_ps( _mm_cvtepi32_ps( _mm_unpackhi_epi16( lo, zero ) ), scale ) );
+            _mm_storeu_ps( dst + i + 8,
+                           _mm_mul_ps( _mm_cvtepi32_ps( _mm_unpacklo_epi16( hi, zero ) ), scale ) );
+            _mm_storeu_ps( dst + i + 12,
+                           _mm_mul_ps( _mm_cvtepi32_ps( _mm_unpackhi_epi16( hi, zero ) ), scale ) );
+        }
+#endif
+        for ( ; i < components; ++i ) {
+            dst[i] = float( src[i] ) * ( 1.0f / 255.0f );
+        }
+    }
+    /**
+     * \brief Convert eight bit normalized components to half floats.
+     * \param src The eight bit components
+     * \param dst The half float components, as raw bits
+     * \param components The number of components
+     */
+    void    to_half( unsigned char const* src,
+                     uint16_t* dst,
+                     size_t const components )
+    {
+        uint16_t const* lut = tables().half;
+        for ( size_t i = 0; i < components; ++i ) {
+            dst[i] = lut[src[i]];
+        }
+    }
+    /**
+     * \brief Multiply the color channels of RGBA pixels by their alpha.
+     * \param rgba The four channel pixel data
+     * \param texels The number of texels
+     */
+    void    premultiply_alpha( unsigned char* rgba,
+                               size_t const texels )
+    {
+        size_t i = 0;
+#ifdef __SSE2__
+        /*
+         * Four texels a block, two to a register once widened to sixteen
+         * bits. Alpha is multiplied by 255, which leaves it as it was, and
+         * the division by 255 is the same exact rounding as mul_255().
+         */
+        __m128i const zero = _mm_setzero_si128();
+        __m128i const alpha_lanes = _mm_set_epi16( -1, 0, 0, 0, -1, 0, 0, 0 );
+        __m128i const opaque = _mm_set_epi16( 255, 0, 0, 0, 255, 0, 0, 0 );
+        __m128i const half = _mm_set1_epi16( 128 );
+        for ( ; i + 4 <= texels; i += 4 ) {
+            __m128i* block = (__m128i*)( rgba + i * 4 );
+            __m128i v = _mm_loadu_si128( block );
+            __m128i wide[2] = { _mm_unpacklo_epi8( v, zero ), _mm_unpackhi_epi8( v, zero ) };
+            for ( size_t w = 0; w < 2; ++w ) {
+                __m128i a = _mm_shufflehi_epi16( _mm_shufflelo_epi16( wide[w], 0xFF ), 0xFF );
+                a = _mm_or_si128( _mm_andnot_si128( alpha_lanes, a ), opaque );
+                __m128i t = _mm_add_epi16( _mm_mullo_epi16( wide[w], a ), half );
+                wide[w] = _mm_srli_epi16( _mm_add_epi16( t, _mm_srli_epi16( t, 8 ) ), 8 );
+            }
+            _mm_storeu_si128( block, _mm_packus_epi16( wide[0], wide[1] ) );
+        }
+        rgba += i * 4;
+#endif
+        for ( ; i < texels; ++i ) {
+            unsigned alpha = rgba[3];
+            rgba[0] = mul_255( rgba[0], alpha );
+            rgba[1] = mul_255( rgba[1], alpha );
+            rgba[2] = mul_255( rgba[2], alpha );
+            rgba += 4;
+        }
+    }
+    /**
+     * \brief Multiply the color channels of sRGB encoded RGBA pixels by
+     * their alpha.
+     *
+     * The multiplication has to happen on linear values, so each channel
+     * is decoded, scaled and encoded again.
+     * \param rgba The four channel pixel data
+     * \param texels The number of texels
+     */
+    void    premultiply_alpha_srgb( unsigned char* rgba,
+                                    size_t const texels )
+    {
+        conversion_tables const& lut = tables();
+        for ( size_t i = 0; i < texels; ++i ) {
+            unsigned alpha = rgba[3];
+            for ( size_t c = 0; c < 3; ++c ) {
+                rgba[c] = lut.linear_srgb[ mul_255( lut.srgb_linear[rgba[c]], alpha ) ];
+            }
+            rgba += 4;
+        }
+    }
+    /**
+     * \brief Decode sRGB components to eight bit linear values.
+     *
+     * Eight bits is too few to hold dark linear values accurately; use
+     * the float version when precision matters.
+     * \param src The sRGB encoded components
+     * \param dst The linear components
+     * \param components The number of components
+     */
+    void    srgb_to_linear( unsigned char const* src,
+                            unsigned char* dst,
+                            size_t const components )
+    {
+        unsigned char const* lut = tables().srgb_linear;
+        for ( size_t i = 0; i < components; ++i ) {
+            dst[i] = lut[src[i]];
+        }
+    }
+    /**
+     * \brief Decode sRGB components to linear floats in [0,1].
+     * \param src The sRGB encoded components
+     * \param dst The linear components
+     * \param components The number of components
+     */
+    void    srgb_to_linear( unsigned char const* src,
+                            float* dst,
+                            size_t const components )
+    {
+        float const* lut = tables().srgb_float;
+        for ( size_t i = 0; i < components; ++i ) {
+            dst[i] = lut[src[i]];
+        }
+    }
+    /**
+     * \brief Encode eight bit linear components as sRGB.
+     * \param src The linear components
+     * \param dst The sRGB encoded components
+     * \param components The number of components
+     */
+    void    linear_to_srgb( unsigned char const* src,
+                            unsigned char* dst,
+                            size_t const components )
+    {
+        unsigned char const* lut = tables().linear_srgb;
+        for ( size_t i = 0; i < components; ++i ) {
+            dst[i] = lut[src[i]];
+        }
+    }
+    /**
+     * \brief Work out the upload format for an internal format.
+     * \param internal_format The texture's internal image format
+     * \param src_channels The number of eight bit channels decoded
+     * \param src_bgr Whether the decoded data is in BGR(A) order
+     * \param premultiply Whether to premultiply color by alpha
+     */
+    pixel_transfer::pixel_transfer( GLenum const internal_format,
+                                    size_t const src_channels,
+                                    bool const src_bgr,
+                                    bool const premultiply ) :
+                                        kind ( UNORM_8 ),
+                                        src_channels ( src_channels ),
+                                        up_channels ( src_channels ),
+                                        src_bgr ( src_bgr ),
+                                        premultiply ( premultiply ),
+                                        srgb ( false )
+    {
+        size_t internal_channels = src_channels;
+        switch ( internal_format ) {
+            case gl::SRGB8:
+                srgb = true;
+            case gl::RGB8: case gl::R3_G3_B2: case gl::RGB4: case gl::RGB5:
+            case gl::RGB8_SNORM:
+                kind = UNORM_8; internal_channels = 3; break;
+            case gl::SRGB8_ALPHA8:
+                srgb = true;
+            case gl::RGBA8: case gl::RGBA2: case gl::RGBA4: case gl::RGB5_A1:
+            case gl::RGBA8_SNORM:
+                kind = UNORM_8; internal_channels = 4; break;
+            case gl::R8: case gl::R8_SNORM:
+                kind = UNORM_8; internal_channels = 1; break;
+            case gl::RG8: case gl::RG8_SNORM:
+                kind = UNORM_8; internal_channels = 2; break;
+
+            case gl::R16: case gl::R16_SNORM:
+                kind = UNORM_16; internal_channels = 1; break;
+            case gl::RG16: case gl::RG16_SNORM:
+                kind = UNORM_16; internal_channels = 2; break;
+            case gl::RGB16: case gl::RGB16_SNORM: case gl::RGB10: case gl::RGB12:
+                kind = UNORM_16; internal_channels = 3; break;
+            case gl::RGBA16: case gl::RGBA16_SNORM: case gl::RGBA12: case gl::RGB10_A2:
+                kind = UNORM_16; internal_channels = 4; break;
+
+            case gl::R16F:
+                kind = HALF; internal_channels = 1; break;
+            case gl::RG16F:
+                kind = HALF; internal_channels = 2; break;
+            case gl::RGB16F: case gl::R11F_G11F_B10F: case gl::RGB9_E5:
+                kind = HALF; internal_channels = 3; break;
+            case gl::RGBA16F:
+                kind = HALF; internal_channels = 4; break;
+
+            case gl::R32F:
+                kind = FULL_FLOAT; internal_channels = 1; break;
+            case gl::RG32F:
+                kind = FULL_FLOAT; internal_channels = 2; break;
+            case gl::RGB32F:
+                kind = FULL_FLOAT; internal_channels = 3; break;
+            case gl::RGBA32F:
+                kind = FULL_FLOAT; internal_channels = 4; break;
+
+            case gl::R8I: case gl::R8UI: case gl::R16I: case gl::R16UI:
+            case gl::R32I: case gl::R32UI:
+                kind = INTEGER; internal_channels = 1; break;
+            case gl::RG8I: case gl::RG8UI: case gl::RG16I: case gl::RG16UI:
+            case gl::RG32I: case gl::RG32UI:
+                kind = INTEGER; internal_channels = 2; break;
+            case gl::RGB8I: case gl::RGB8UI: case gl::RGB16I: case gl::RGB16UI:
+            case gl::RGB32I: case gl::RGB32UI:
+                kind = INTEGER; internal_channels = 3; break;
+            case gl::RGBA8I: case gl::RGBA8UI: case gl::RGBA16I: case gl::RGBA16UI:
+            case gl::RGBA32I: case gl::RGBA32UI: case gl::RGB10_A2UI:
+                kind = INTEGER; internal_channels = 4; break;
+            default:
+                break;
+        }
+        if ( src_channels == 3 and ( internal_channels == 4 or kind == UNORM_8 ) ) {
+            up_channels = 4;
+        }
+    }
+    /**
+     * \brief Return the pixel format to hand OpenGL.
+     * \return The pixel format enum
+     */
+    GLenum  pixel_transfer::format() const
+    {
+        if ( kind == INTEGER ) {
+            switch ( up_channels ) {
+                case 1: return gl::RED_INTEGER;
+                case 2: return gl::RG_INTEGER;
+                case 3: return gl::RGB_INTEGER;
+                default: return gl::RGBA_INTEGER;
+            }
+        }
+        switch ( up_channels ) {
+            case 1: return gl::RED;
+            case 2: return gl::RG;
+            case 3: return gl::RGB;
+            default: return gl::RGBA;
+        }
+    }
+    /**
+     * \brief Return the component type to hand OpenGL.
+     * \return The component type enum
+     */
+    GLenum  pixel_transfer::type() const
+    {
+        switch ( kind ) {
+            case UNORM_16: return gl::UNSIGNED_SHORT;
+            case HALF: return gl::HALF_FLOAT;
+            case FULL_FLOAT: return gl::FLOAT;
+            default: return gl::UNSIGNED_BYTE;
+        }
+    }
+    /**
+     * \brief Return the size of one converted texel.
+     * \return The number of bytes per texel
+     */
+    size_t  pixel_transfer::texel_bytes() const
+    {
+        switch ( kind ) {
+            case UNORM_16: case HALF: return up_channels * 2;
+            case FULL_FLOAT: return up_channels * 4;
+            default: return up_channels;
+        }
+    }
+    /**
+     * \brief Convert decoded data into the upload format.
+     * \param src The decoded eight bit data
+     * \param texels The number of texels
+     * \param dst Filled with the converted data
+     */
+    void    pixel_transfer::convert( unsigned char const* src,
+                                     size_t const texels,
+                                     std::vector<unsigned char>& dst ) const
+    {
+        size_t components = texels * up_channels;
+        std::vector<unsigned char> staged;
+        std::vector<unsigned char>& bytes = kind == UNORM_8 or kind == INTEGER ?
+                                                dst : staged;
+        bytes.resize( components );
+        if ( components == 0 ) {
+            dst.clear();
+            return;
+        }
+
+        if ( up_channels == 4 and src_channels == 3 ) {
+            expand_to_rgba( src, &bytes[0], texels );
+        } else {
+            std::memcpy( &bytes[0], src, components );
+        }
+        if ( src_bgr and up_channels >= 3 ) {
+            swap_red_blue( &bytes[0], texels, up_channels );
+        }
+        if ( premultiply and up_channels == 4 and kind != INTEGER ) {
+            if ( srgb ) {
+                premultiply_alpha_srgb( &bytes[0], texels );
+            } else {
+                premultiply_alpha( &bytes[0], texels );
+            }
+        }
+
+        switch ( kind ) {
+            case UNORM_16:
+                dst.resize( components * 2 );
+                widen_to_16bit( &bytes[0], (uint16_t*) &dst[0], components );
+                break;
+            case HALF:
+                dst.resize( components * 2 );
+                to_half( &bytes[0], (uint16_t*) &dst[0], components );
+                break;
+            case FULL_FLOAT:
+                dst.resize( components * 4 );
+                to_float( &bytes[0], (float*) &dst[0], components );
+                break;
+            default:
+                break;
+        }
+    }
+}
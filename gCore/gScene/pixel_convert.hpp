@@ -0,0 +1,96 @@
+#ifndef PIXEL_CONVERT_HPP
+#define PIXEL_CONVERT_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "../gVideo/gl_core_3_3.hpp"
+
+namespace gfx {
+    /*
+     * Conversion kernels for decoded image data. All of them work on
+     * tightly packed eight bit channels, which is what FreeImage hands
+     * back; the SSE2 paths are used where the compiler targets it, the
+     * three channel shuffles use SSSE3 byte shuffles when it is targeted
+     * too, and the scalar loops cover the rest.
+     */
+    void        swap_red_blue( unsigned char* pixels,
+                               size_t const texels,
+                               size_t const channels );
+    void        expand_to_rgba( unsigned char const* rgb,
+                                unsigned char* rgba,
+                                size_t const texels,
+                                unsigned char const alpha = 255u );
+    void        widen_to_16bit( unsigned char const* src,
+                                uint16_t* dst,
+                                size_t const components );
+    void        to_float( unsigned char const* src,
+                          float* dst,
+                          size_t const components );
+    void        to_half( unsigned char const* src,
+                         uint16_t* dst,
+                         size_t const components );
+    void        premultiply_alpha( unsigned char* rgba,
+                                   size_t const texels );
+    void        premultiply_alpha_srgb( unsigned char* rgba,
+                                        size_t const texels );
+    void        srgb_to_linear( unsigned char const* src,
+                                unsigned char* dst,
+                                size_t const components );
+    void        srgb_to_linear( unsigned char const* src,
+                                float* dst,
+                                size_t const components );
+    void        linear_to_srgb( unsigned char const* src,
+                                unsigned char* dst,
+                                size_t const components );
+    /**
+     * \class gfx::pixel_transfer pixel_convert.hpp "gCore/gScene/pixel_convert.hpp"
+     * \brief Picks the upload format for an image format and converts
+     * decoded data to match it.
+     *
+     * Handing OpenGL data whose format and type do not match the texture's
+     * internal format makes the driver convert it texel by texel on the
+     * way in, usually slowly. A pixel transfer looks at the internal
+     * format and the decoded channel count, decides the format and type
+     * the driver can take directly, and converts eight bit decoded data
+     * into exactly that. Three channel eight bit data is widened to four
+     * channels, since four byte texels are the fast path everywhere.
+     */
+    class pixel_transfer {
+    public:
+                            pixel_transfer( GLenum const internal_format,
+                                            size_t const src_channels,
+                                            bool const src_bgr = true,
+                                            bool const premultiply = false );
+        GLenum              format() const;
+        GLenum              type() const;
+        size_t              channels() const;
+        size_t              texel_bytes() const;
+        void                convert( unsigned char const* src,
+                                     size_t const texels,
+                                     std::vector<unsigned char>& dst ) const;
+    private:
+        enum component_kind {
+            UNORM_8,
+            UNORM_16,
+            HALF,
+            FULL_FLOAT,
+            INTEGER
+        };
+        component_kind      kind;
+        size_t              src_channels;
+        size_t              up_channels;
+        bool                src_bgr;
+        bool                premultiply;
+        bool                srgb;
+    };
+    /**
+     * \brief Return the number of channels handed to OpenGL.
+     * \return The upload channel count
+     */
+    inline  size_t  pixel_transfer::channels() const
+    { return up_channels; }
+}
+
+#endif
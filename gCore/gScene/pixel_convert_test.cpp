@@ -0,0 +1,155 @@
+#include <vector>
+#include <cstdint>
+
+#include "pixel_convert.hpp"
+#include "../../UnitTest++_src/UnitTest++.h"
+
+using namespace gfx;
+
+SUITE( PixelConvertTests )
+{
+    TEST( SwapRedBlue )
+    {
+        // Odd texel counts exercise both the vector and the scalar tail
+        std::vector<unsigned char> bgra;
+        std::vector<unsigned char> bgr;
+        size_t i;
+        for ( i = 0; i < 7u; ++i ) {
+            bgra.push_back( 1u ); bgra.push_back( 2u );
+            bgra.push_back( 3u ); bgra.push_back( 4u );
+            bgr.push_back( 5u ); bgr.push_back( 6u ); bgr.push_back( 7u );
+        }
+        swap_red_blue( &bgra[0], 7u, 4u );
+        swap_red_blue( &bgr[0], 7u, 3u );
+        for ( i = 0; i < 7u; ++i ) {
+            CHECK_EQUAL( 3u, bgra[i * 4] );
+            CHECK_EQUAL( 2u, bgra[i * 4 + 1] );
+            CHECK_EQUAL( 1u, bgra[i * 4 + 2] );
+            CHECK_EQUAL( 4u, bgra[i * 4 + 3] );
+            CHECK_EQUAL( 7u, bgr[i * 3] );
+            CHECK_EQUAL( 6u, bgr[i * 3 + 1] );
+            CHECK_EQUAL( 5u, bgr[i * 3 + 2] );
+        }
+    }
+
+    TEST( WidenAndFloat )
+    {
+        std::vector<unsigned char> src;
+        size_t i;
+        for ( i = 0; i < 256u; ++i ) { src.push_back( (unsigned char) i ); }
+        std::vector<uint16_t> wide ( 256u );
+        std::vector<float> flt ( 256u );
+        std::vector<uint16_t> half ( 256u );
+        widen_to_16bit( &src[0], &wide[0], 256u );
+        to_float( &src[0], &flt[0], 256u );
+        to_half( &src[0], &half[0], 256u );
+
+        CHECK_EQUAL( 0u, wide[0] );
+        CHECK_EQUAL( 65535u, wide[255] );
+        CHECK_EQUAL( 128u * 257u, wide[128] );
+        CHECK_CLOSE( 0.0f, flt[0], 0.00001f );
+        CHECK_CLOSE( 1.0f, flt[255], 0.00001f );
+        CHECK_CLOSE( 51.0f / 255.0f, flt[51], 0.00001f );
+        // 1.0 and 0.5 are exact in half precision
+        CHECK_EQUAL( 0x3C00u, half[255] );
+        CHECK_EQUAL( 0x0000u, half[0] );
+    }
+
+    TEST( PremultiplyAndSRGB )
+    {
+        unsigned char rgba[8] = { 255u, 128u, 0u, 128u,
+                                  200u, 100u, 50u, 255u };
+        premultiply_alpha( rgba, 2u );
+        CHECK_EQUAL( 128u, rgba[0] );
+        CHECK_EQUAL( 64u, rgba[1] );
+        CHECK_EQUAL( 0u, rgba[2] );
+        CHECK_EQUAL( 128u, rgba[3] );
+        CHECK_EQUAL( 200u, rgba[4] );
+        CHECK_EQUAL( 50u, rgba[6] );
+
+        unsigned char ends[3] = { 0u, 255u, 188u };
+        unsigned char linear[3];
+        unsigned char back[3];
+        srgb_to_linear( ends, linear, 3u );
+        linear_to_srgb( linear, back, 3u );
+        CHECK_EQUAL( 0u, linear[0] );
+        CHECK_EQUAL( 255u, linear[1] );
+        // sRGB 188 is about half intensity
+        CHECK( linear[2] > 120u and linear[2] < 135u );
+        CHECK_EQUAL( 255u, back[1] );
+    }
+
+    TEST( KernelsMatchScalar )
+    {
+        // Every length up to a few blocks, so each vector path meets
+        // every tail length and block boundary
+        for ( size_t texels = 0; texels < 40u; ++texels ) {
+            std::vector<unsigned char> rgb ( texels * 3 + 1 );
+            std::vector<unsigned char> rgba ( texels * 4 + 1 );
+            for ( size_t b = 0; b < rgb.size(); ++b ) { rgb[b] = (unsigned char)( b * 37u + texels ); }
+            for ( size_t b = 0; b < rgba.size(); ++b ) { rgba[b] = (unsigned char)( b * 91u + 7u ); }
+            std::vector<unsigned char> swapped ( rgb );
+            std::vector<unsigned char> expanded ( texels * 4 + 1, 9u );
+            std::vector<unsigned char> scaled ( rgba );
+            swap_red_blue( &swapped[0], texels, 3u );
+            expand_to_rgba( &rgb[0], &expanded[0], texels, 200u );
+            premultiply_alpha( &scaled[0], texels );
+
+            bool same = true;
+            for ( size_t t = 0; t < texels; ++t ) {
+                for ( size_t c = 0; c < 3u; ++c ) {
+                    same = same and swapped[t * 3 + c] == rgb[t * 3 + 2 - c];
+                    same = same and expanded[t * 4 + c] == rgb[t * 3 + c];
+                    unsigned product = unsigned( rgba[t * 4 + c] ) * rgba[t * 4 + 3];
+                    same = same and scaled[t * 4 + c] == ( product + 127u ) / 255u;
+                }
+                same = same and expanded[t * 4 + 3] == 200u;
+                same = same and scaled[t * 4 + 3] == rgba[t * 4 + 3];
+            }
+            // Nothing past the last texel is touched
+            same = same and swapped.back() == rgb.back();
+            same = same and expanded.back() == 9u;
+            same = same and scaled.back() == rgba.back();
+            CHECK( same );
+        }
+    }
+
+    TEST( TransferFormats )
+    {
+        pixel_transfer rgb8 ( gl::RGB8, 3u );
+        CHECK_EQUAL( GLenum( gl::RGBA ), rgb8.format() );
+        CHECK_EQUAL( GLenum( gl::UNSIGNED_BYTE ), rgb8.type() );
+        CHECK_EQUAL( 4u, rgb8.texel_bytes() );
+
+        pixel_transfer rgba16f ( gl::RGBA16F, 4u );
+        CHECK_EQUAL( GLenum( gl::HALF_FLOAT ), rgba16f.type() );
+        CHECK_EQUAL( 8u, rgba16f.texel_bytes() );
+
+        pixel_transfer rgb32f ( gl::RGB32F, 3u );
+        CHECK_EQUAL( GLenum( gl::RGB ), rgb32f.format() );
+        CHECK_EQUAL( GLenum( gl::FLOAT ), rgb32f.type() );
+
+        pixel_transfer r8ui ( gl::R8UI, 1u );
+        CHECK_EQUAL( GLenum( gl::RED_INTEGER ), r8ui.format() );
+
+        unsigned char bgr[6] = { 10u, 20u, 30u, 40u, 50u, 60u };
+        std::vector<unsigned char> out;
+        rgb8.convert( bgr, 2u, out );
+        CHECK_EQUAL( 8u, out.size() );
+        CHECK_EQUAL( 30u, out[0] );
+        CHECK_EQUAL( 20u, out[1] );
+        CHECK_EQUAL( 10u, out[2] );
+        CHECK_EQUAL( 255u, out[3] );
+        CHECK_EQUAL( 60u, out[4] );
+
+        pixel_transfer rgb16 ( gl::RGB16, 3u, false );
+        rgb16.convert( bgr, 2u, out );
+        CHECK_EQUAL( 12u, out.size() );
+        CHECK_EQUAL( 10u * 257u, ((uint16_t*) &out[0])[0] );
+    }
+}
+
+int main( int argc, char** argv )
+{
+    return UnitTest::RunAllTests();
+}
@@ -1,8 +1,12 @@
 #ifndef PRIMITIVE_HPP
 #define PRIMITIVE_HPP
 
+#include <stdexcept>
+
 #include "../gVideo/gl_core_3_3.hpp"
 #include "buffer.hpp"
+#include "culling.hpp"
+#include "mesh.hpp"
 #include "orientable.hpp"
 
 namespace gfx {
@@ -12,7 +16,9 @@ namespace gfx {
      * 
      * Primitives have geometry that is set and can only be manipulated
      * by changing the transformation matrix provided by the base class
-     * \ref gfx::orientable "orientable".
+     * \ref gfx::orientable "orientable". Primitives of the same shape
+     * share one \ref gfx::mesh "mesh", so many of them cost one set of
+     * buffers and can be drawn together through \ref shape() "shape()".
      */
     class primitive : public orientable {
     public:
@@ -25,6 +31,9 @@ namespace gfx {
         virtual             ~primitive();
         
         virtual buffer const&     geometry() const = 0;
+        virtual bounds const&     local_bounds() const = 0;
+        virtual mesh&             shape() const = 0;
+        bounds                    world_bounds() const;
     };
     /**
      * \brief Construct a new default primtive settings object.
@@ -34,6 +43,15 @@ namespace gfx {
      */
     inline primitive::settings::settings( orientable::settings const& super )
                                             : orientable::settings( super ) {}
+    /**
+     * \brief Return the bounds of the primitive where its transformation
+     * puts it.
+     *
+     * These are what a \ref gfx::culler "culler" should be given for a
+     * primitive that is not part of a \ref gfx::scene_graph "scene graph".
+     */
+    inline bounds   primitive::world_bounds() const
+    { return local_bounds().transformed( object_matrix() ); }
     /**
      * \class gfx::box primitive.hpp "gCore/gScene/primitive.hpp"
      * \brief A six sided volume with all sides perpendicular to adjacent sides.
@@ -47,11 +65,15 @@ namespace gfx {
                                 box( settings const& set = settings() );
                                 ~box();
         virtual buffer const&   geometry() const;
+        virtual bounds const&   local_bounds() const;
+        virtual mesh&           shape() const;
         // THIS IS JUST A HACK!!!!!!
-        GLuint*                 draw_array();
+        GLuint const*           draw_array();
     private:
-        buffer*                 geom;
-        GLuint*                 draw_elements;
+                                box( box const& );
+        box&                    operator =( box const& );
+
+        mesh*                   shared;
     };
     /**
      * \brief Construct a new box settings object.
@@ -68,14 +90,26 @@ namespace gfx {
      * how geometry is provided.
      */
     inline buffer const&  box::geometry() const
-    { return *geom; }
+    { return shared->geometry(); }
+    /**
+     * \brief Return the bounds of the box before its transformation.
+     */
+    inline bounds const&  box::local_bounds() const
+    { return shared->local_bounds(); }
+    /**
+     * \brief Return the mesh shared by every box.
+     */
+    inline mesh&    box::shape() const
+    { return *shared; }
     
     /**
      * \brief AHHHHHHHHHHHHHHHHHHHH!!!!!!!!!!!!!!!!!!!
      * The is just a HACK. See comments for \ref gfx::box::geometry geometry().
+     * The indices are shared with every other box, so they cannot be
+     * changed through here.
      */
-    inline GLuint*  box::draw_array()
-    { return draw_elements; }
+    inline GLuint const*    box::draw_array()
+    { return shared->indices(); }
     /**
      * \class gfx::sphere primitive.hpp "gCore/gScene/primitive.hpp"
      * \brief A spherical volume.
@@ -85,18 +119,52 @@ namespace gfx {
         class settings : public primitive::settings {
         public:
                     settings( primitive::settings const& super = primitive::settings() );
+            settings&       tessellation( unsigned int const rings,
+                                          unsigned int const segments );
+        private:
+            friend          class sphere;
+            unsigned int    rings_v;
+            unsigned int    segments_v;
         };
                                 sphere( settings const& set = settings() );
                                 ~sphere();
         virtual buffer const&   geometry() const;
+        virtual bounds const&   local_bounds() const;
+        virtual mesh&           shape() const;
     private:
-        buffer*                 geom;
+                                sphere( sphere const& );
+        sphere&                 operator =( sphere const& );
+
+        mesh*                   shared;
     };
     /**
      * \brief Construct a new sphere settings object.
+     *
+     * A default sphere has 8 rings and 16 segments.
      */
     inline sphere::settings::settings( primitive::settings const& super )
-                                       : primitive::settings( super ) {}
+                                       : primitive::settings( super ),
+                                         rings_v ( 8 ),
+                                         segments_v ( 16 ) {}
+    /**
+     * \brief Set how finely the sphere is divided.
+     *
+     * Spheres of the same tessellation share their mesh.
+     * \param rings The number of bands from pole to pole, at least two
+     * \param segments The number of slices around the poles, at least three
+     * \return This settings object
+     * \exception std::invalid_argument If there are too few of either
+     */
+    inline sphere::settings&    sphere::settings::tessellation( unsigned int const rings,
+                                                                unsigned int const segments )
+    {
+        if ( rings < 2 or segments < 3 ) {
+            throw std::invalid_argument( "A sphere needs at least two rings and three segments." );
+        }
+        rings_v = rings;
+        segments_v = segments;
+        return *this;
+    }
     /**
      * \brief Return the buffer of the sphere.
      * 
@@ -107,7 +175,17 @@ namespace gfx {
      * how geometry is provided.
      */
     inline buffer const&  sphere::geometry() const
-    { return *geom; }
+    { return shared->geometry(); }
+    /**
+     * \brief Return the bounds of the sphere before its transformation.
+     */
+    inline bounds const&  sphere::local_bounds() const
+    { return shared->local_bounds(); }
+    /**
+     * \brief Return the mesh shared by every sphere of this tessellation.
+     */
+    inline mesh&    sphere::shape() const
+    { return *shared; }
     
     /* class cone : public primitive {
     public:
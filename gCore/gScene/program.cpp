@@ -1,7 +1,9 @@
 #include <stdexcept>
 #include <fstream>
 #include <iostream>
+#include <algorithm>
 #include "./program.hpp"
+#include "./gl_state.hpp"
 
 //#define GL3_PROTOTYPES 1
 //#include "gl3.h"
@@ -9,11 +11,16 @@
 namespace gfx {
     
     program*    program::current_prgm = 0;
+    size_t      program::next_link_serial = 1;
     /**
      * \brief Construct a new \ref gfx::program "program" object.
      * \param set The \ref gfx::program::settings "settings" for the new program
      */
-    program::program( program::settings const& set ) : uniform_map( new program::key_map() ),
+    program::program( program::settings const& set ) : uniforms (),
+                                                      shadow_values (),
+                                                      uploads_issued_v ( 0 ),
+                                                      uploads_skipped_v ( 0 ),
+                                                      link_serial_v ( 0 ),
                                                       vert_path( set.vert_path ),
                                                       frag_path( set.frag_path ),
                                                       geom_path( set.geom_path ),
@@ -27,7 +34,17 @@ namespace gfx {
                                                       geom_ID( 0 ),
                                                       tess_ID( 0 ),
                                                       prog_ID( 0 ),
-                                                      in_use_v ( false )
+                                                      in_use_v ( false ),
+                                                      cache ( set.cache_v ),
+                                                      cache_key (),
+                                                      from_cache ( false ),
+                                                      build_start ( 0.0 ),
+                                                      queued ( false ),
+                                                      build_queue ( 0 ),
+                                                      loader ( set.loader_v != 0 ?
+                                                               set.loader_v :
+                                                               &shader_loader::shared() ),
+                                                      defines ( set.defines_v )
     {
 
         if ( video_system::get().get_version() < opengl_2_0 ) {
@@ -82,87 +99,230 @@ namespace gfx {
             gl::DeleteShader( tess_ID );
         }
         if ( gl::IsProgram( prog_ID ) ) {
+                gl_state::forget_program( prog_ID );
                 gl::DeleteProgram( prog_ID );
         }
-        uniform_map->clear();
     }
     /**
      * \brief Specify that this program has a uniform slot with the given
      * name.
      * 
-     * The program class is not smart enough to knwo about the various fields
-     * within a \ref gfx::light "light" or \ref gfx::camera "camera", so for
-     * now these fields must be specified manually.
+     * Every active uniform is now found when the program is linked, so this
+     * does nothing; it is kept so older code still compiles.
      * \param name The name of the uniform slot in the shader source.
      */
     void    program::uniform_name( std::string const& name )
-    { (*uniform_map)[name] = -1;}
+    {}
+    /**
+     * \brief Resolve the uniform with the given name to a handle.
+     * 
+     * The name is looked up in the table of active uniforms built at link
+     * time. Individual array elements such as "lights[2]" are not in the
+     * table, so they fall back to asking OpenGL for the location, and the
+     * handle remembers which array they belong to. A name the program does
+     * not use gives an invalid handle.
+     * \param name The name of the uniform in the shader source
+     * \return The handle for the uniform
+     */
+    uniform_handle  program::find_uniform( std::string const& name ) const
+    {
+        uniform_handle handle;
+        uniform_info key;
+        key.name = name;
+        std::vector<uniform_info>::const_iterator found;
+        found = std::lower_bound( uniforms.begin(), uniforms.end(), key );
+        if ( found != uniforms.end() and found->name == name ) {
+            handle.loc = found->location;
+            handle.type_v = found->type;
+            handle.size_v = found->size;
+            handle.index = found - uniforms.begin();
+        } else if ( link_serial_v != 0 and
+                    name.size() > 0 and name[name.size() - 1] == ']' ) {
+            handle.loc = gl::GetUniformLocation( prog_ID, name.c_str() );
+            if ( handle.loc != -1 ) {
+                handle.size_v = 1;
+                key.name = name.substr( 0, name.find( '[' ) );
+                found = std::lower_bound( uniforms.begin(), uniforms.end(), key );
+                if ( found != uniforms.end() and found->name == key.name ) {
+                    handle.type_v = found->type;
+                    handle.array_index = found - uniforms.begin();
+                }
+            }
+        }
+        return handle;
+    }
     /**
      * \brief Compile the shader source associated with this program.
      * 
      * If no shader source paths have been specified, this function
      * compiles nothing and does not generate an error state.
-     * \todo Review this function's implementation, as it should be
-     * impossible for the program to think it has a vertex shader but
-     * the path is an empty string.
-     * \exception gfx::compilation_error If the program thinks it has
-     * a particular shader stage but the path is somehow empty, a
-     * compilation error is thrown.
+     * 
+     * If the program has a \ref gfx::program_cache "program_cache", the
+     * sources are read first and the cache is asked for a binary of them.
+     * A binary the driver accepts leaves the program linked already, and
+     * nothing is compiled.
+     * 
+     * This waits for the driver to finish compiling; a
+     * \ref gfx::program_queue "program_queue" builds programs without
+     * waiting.
+     * \exception gfx::compilation_error If a source path is somehow empty
+     * or a stage fails to compile, a compilation error is thrown.
      */
     void    program::compile()
     {
+        start_build( read_sources() );
+        if ( not from_cache ) {
+            check_stages();
+        }
+    }
+    /**
+     * \brief Link compiled shader stages into one program.
+     * 
+     * Linking the compiled shader stages allow uniforms and atributes
+     * to be uploaded to OpenGL. Every active uniform is looked up once
+     * here, so handles can be resolved without asking OpenGL again.
+     * 
+     * A program loaded from its cache is already linked. Otherwise the
+     * newly linked binary is handed to the cache, if there is one.
+     * \exception gfx::compilaton_error If shader linking fails, a
+     * compilation error is thrown.
+     */
+    void    program::link()
+    {   
+        /**gl::AttachShader( prog_ID, vert_ID );
+        gl::AttachShader( prog_ID, frag_ID );
+        if ( geom_ID != 0 ) {
+            gl::AttachShader( prog_ID, geom_ID );
+        }*/
+        
+        if ( not from_cache ) {
+            gl::LinkProgram( prog_ID );
+        }
+        finish_link();
+    }
+    /**
+     * \brief Query whether the program is linked and can be used.
+     * 
+     * This never waits on the driver. A program given to a
+     * \ref gfx::program_queue "program_queue" becomes ready once the queue
+     * has seen it finish linking.
+     * \return Whether the program is ready to use
+     */
+    bool    program::ready() const
+    { return link_serial_v != 0 and not queued; }
+    /**
+     * \brief Read the source of every stage the program has.
+     * 
+     * Sources go through the program's \ref gfx::shader_loader
+     * "shader_loader", which expands includes and adds the defines.
+     * This touches no OpenGL state, so it may run on any thread.
+     * \return The sources, in vertex, fragment, geometry, tesselation order
+     * \exception gfx::compilation_error If a stage's source path is empty
+     * or a source cannot be loaded
+     */
+    std::vector<std::string>    program::read_sources() const
+    {
+        std::vector<std::string> sources;
         if ( has_vert ) {
             if ( vert_path == "" ) {
                 throw compilation_error( "Vertex program source path uninitialized.");
-            } else {
-                compile( this->vert_ID, vert_path );
-                gl::AttachShader( prog_ID, vert_ID );
             }
+            sources.push_back( loader->load( vert_path, defines ) );
         }
         if ( has_frag ) {
             if ( frag_path == "" ) {
                 throw compilation_error( "Fragment program source path uninitialized.");
-            } else {
-                compile( this->frag_ID, frag_path );
-                gl::AttachShader( prog_ID, frag_ID );
             }
+            sources.push_back( loader->load( frag_path, defines ) );
         }
         if ( has_geom ) {
             if ( geom_path == "" ) {
                 throw compilation_error( "Geometry program source path uninitialized.");
-            } else {
-                compile( this->geom_ID, geom_path );
-                gl::AttachShader( prog_ID, geom_ID );
             }
+            sources.push_back( loader->load( geom_path, defines ) );
         }
         if ( has_tess ) {
             if ( tess_path == "" ) {
                 throw compilation_error( "Tesselation program source path uninitialized.");
-            } else {
-                compile( this->tess_ID, tess_path );
-                gl::AttachShader( prog_ID, tess_ID );
             }
+            sources.push_back( loader->load( tess_path, defines ) );
         }
-        
+        return sources;
     }
     /**
-     * \brief Link compiled shader stages into one program.
+     * \brief Hand the stage sources to the driver without waiting for the
+     * result.
      * 
-     * Linking the compiled shader stages allow uniforms and atributes
-     * to be uploaded to OpenGL.
-     * \exception gfx::compilaton_error If shader linking fails, a
-     * compilation error is thrown.
+     * The cache is tried first; a binary it loads leaves the program linked.
+     * Otherwise every stage is compiled and attached, and nothing is asked
+     * of the driver, so a driver that compiles in the background is not
+     * made to finish.
+     * \param sources The stage sources, as from \ref read_sources()
+     * "read_sources()"
      */
-    void    program::link()
-    {   
-        /**gl::AttachShader( prog_ID, vert_ID );
-        gl::AttachShader( prog_ID, frag_ID );
-        if ( geom_ID != 0 ) {
+    void    program::start_build( std::vector<std::string> const& sources )
+    {
+        from_cache = false;
+        build_start = program_cache::now();
+        if ( cache != 0 ) {
+            std::string define_text;
+            for ( size_t i = 0; i < defines.size(); ++i ) {
+                define_text += defines[i].first + "=" + defines[i].second + ";";
+            }
+            cache_key = cache->key( sources, define_text );
+            if ( cache->load( prog_ID, cache_key ) ) {
+                from_cache = true;
+                return;
+            }
+            if ( cache->supported() ) {
+                gl::ProgramParameteri( prog_ID, gl::PROGRAM_BINARY_RETRIEVABLE_HINT,
+                                       gl::TRUE_ );
+            }
+        }
+
+        size_t stage = 0;
+        if ( has_vert ) {
+            compile( this->vert_ID, sources[stage++] );
+            gl::AttachShader( prog_ID, vert_ID );
+        }
+        if ( has_frag ) {
+            compile( this->frag_ID, sources[stage++] );
+            gl::AttachShader( prog_ID, frag_ID );
+        }
+        if ( has_geom ) {
+            compile( this->geom_ID, sources[stage++] );
             gl::AttachShader( prog_ID, geom_ID );
-        }*/
-        
-        gl::LinkProgram( prog_ID );
-        
+        }
+        if ( has_tess ) {
+            compile( this->tess_ID, sources[stage++] );
+            gl::AttachShader( prog_ID, tess_ID );
+        }
+    }
+    /**
+     * \brief Check that every stage compiled.
+     * \exception gfx::compilation_error If a stage failed to compile
+     */
+    void    program::check_stages() const
+    {
+        if ( has_vert ) { check_stage( vert_ID, loader->source_names( vert_path ) ); }
+        if ( has_frag ) { check_stage( frag_ID, loader->source_names( frag_path ) ); }
+        if ( has_geom ) { check_stage( geom_ID, loader->source_names( geom_path ) ); }
+        if ( has_tess ) { check_stage( tess_ID, loader->source_names( tess_path ) ); }
+    }
+    /**
+     * \brief Check the result of linking and find the active uniforms.
+     * 
+     * A newly linked binary is handed to the cache, if there is one.
+     * \exception gfx::compilation_error If linking failed
+     */
+    void    program::finish_link()
+    {
+        if ( from_cache ) {
+            reflect_uniforms();
+            link_serial_v = next_link_serial++;
+            return;
+        }
+
         GLint status = 0;
         gl::GetProgramiv( prog_ID, gl::LINK_STATUS, &status );
         if ( status == gl::FALSE_ ) {
@@ -180,18 +340,19 @@ namespace gfx {
             
             throw compilation_error( msg );
         }
-        
-        key_map::iterator unfm;
-        for ( unfm = uniform_map->begin();
-              unfm != uniform_map->end();
-              ++unfm                       ) {
-            (*uniform_map)[unfm->first] = gl::GetUniformLocation( prog_ID,
-                                                                  unfm->first.c_str() );
+        if ( cache != 0 ) {
+            cache->store( prog_ID, cache_key, program_cache::now() - build_start );
         }
+        
+        reflect_uniforms();
+        link_serial_v = next_link_serial++;
     }
     /**
      * \brief Set OpenGL to use this program for all subsquent drawing
      * instructions.
+     * 
+     * The call goes through the context's \ref gfx::gl_state "gl_state",
+     * so using the program already in use costs nothing.
      */
     void    program::use()
     {  
@@ -201,7 +362,7 @@ namespace gfx {
             program::current_prgm->in_use_v = false;
             program::current_prgm = this;
         }
-        gl::UseProgram( prog_ID );
+        gl_state::current().use_program( prog_ID );
         in_use_v = true;
     }
     /**
@@ -222,39 +383,29 @@ namespace gfx {
         return out;
     }
     /**
-     * \brief Compile the given shader stage using the source at the given
-     * path.
+     * \brief Compile the given shader stage from the given source.
      * 
      * This is an internal utility function, used by the parameterless
      * function of the same name.
      * \param stage_ID The OpenGL id corresponding to the stage to be compiled
-     * \param stage_path The path to the shader source for the stage indicated
+     * \param stage_source The shader source for the stage indicated
      */
-    void    program::compile( GLuint stage_ID, std::string const& stage_path )
+    void    program::compile( GLuint stage_ID, std::string const& stage_source )
     {
-        std::fstream program_in( stage_path.c_str(),
-                                std::ios_base::in );
-        size_t buffer_size = 128;
-        char* buffer = new char[buffer_size];
-        std::string program_file;
-
-        while( program_in.good() ) {
-            // This looks ugly, I know.  Translation:
-            // "read a number of bytes equal to the size of the read
-            // buffer minus one then assign the character after the end
-            // of that read to a null terminating character."
-            // The expression can't execute until the index to the array
-            // is known, so that expression will always execute first.
-            // Still terrifying.
-            buffer[ program_in.read( buffer, buffer_size - 1 ).gcount() ] = '\0';
-            program_file += buffer;
-        }
-        // std::cout << program_file << std::endl;
-
-        const char* stage_file_ptr = program_file.c_str();
+        const char* stage_file_ptr = stage_source.c_str();
         gl::ShaderSource( stage_ID, 1, &stage_file_ptr, 0 );
         gl::CompileShader( stage_ID );
-        
+    }
+    /**
+     * \brief Check that the given shader stage compiled.
+     * \param stage_ID The OpenGL id of the stage
+     * \param source_names Which file each source string number in the log
+     * stands for, added to the error message
+     * \exception gfx::compilation_error If the stage failed to compile
+     */
+    void    program::check_stage( GLuint stage_ID,
+                                  std::string const& source_names )
+    {
         GLint status = 0;
         gl::GetShaderiv( stage_ID, gl::COMPILE_STATUS, &status );
 
@@ -283,9 +434,52 @@ namespace gfx {
             gl::GetShaderInfoLog( stage_ID, log_length, &returned_length, info_log );
             msg += info_log;
             delete[] info_log;
+            if ( not source_names.empty() ) {
+                msg += "\n" + source_names;
+            }
 
             throw compilation_error( msg );
         }
     }
 
+    /**
+     * \brief Build the table of active uniforms of the linked program.
+     * 
+     * Uniforms inside uniform blocks have no location and are left out.
+     * Linking resets every uniform to zero, so the shadow values start out
+     * empty.
+     */
+    void    program::reflect_uniforms()
+    {
+        uniforms.clear();
+        shadow_values.clear();
+        GLint count = 0;
+        GLint max_length = 0;
+        gl::GetProgramiv( prog_ID, gl::ACTIVE_UNIFORMS, &count );
+        gl::GetProgramiv( prog_ID, gl::ACTIVE_UNIFORM_MAX_LENGTH, &max_length );
+        if ( count <= 0 ) {
+            return;
+        }
+        std::vector<char> name_buffer ( max_length + 1, '\0' );
+        uniforms.reserve( count );
+        for ( GLint i = 0; i < count; ++i ) {
+            GLsizei length = 0;
+            uniform_info info;
+            info.shadowed = false;
+            gl::GetActiveUniform( prog_ID, i, name_buffer.size(), &length,
+                                  &info.size, &info.type, &name_buffer[0] );
+            info.name.assign( &name_buffer[0], length );
+            info.location = gl::GetUniformLocation( prog_ID, info.name.c_str() );
+            if ( info.location == -1 ) {
+                continue;
+            }
+            if ( info.name.size() > 3 and
+                 info.name.compare( info.name.size() - 3, 3, "[0]" ) == 0 ) {
+                info.name.erase( info.name.size() - 3 );
+            }
+            uniforms.push_back( info );
+        }
+        std::sort( uniforms.begin(), uniforms.end() );
+        shadow_values.assign( uniforms.size() * shadow_stride, 0 );
+    }
 }
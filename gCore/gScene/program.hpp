@@ -5,13 +5,17 @@
 #include <iostream>
 #include <map>
 #include <set>
+#include <vector>
 #include <cstdlib>
+#include <cstring>
 
 //#define GL3_PROTOTYPES
 //#include "gl3.h"
 
 #include "../gVideo/gl_core_3_3.hpp"
 #include "../gVideo/video.hpp"
+#include "program_cache.hpp"
+#include "shader_loader.hpp"
 //#include "videoManager.hpp"
 //PFNGLCREATESHADERPROC glCreateShader;
 //PFNGLCREATEPROGRAMPROC glCreateProgram;
@@ -194,6 +198,66 @@ namespace gfx {
  * the associated Shader objects.
  * 
  * */
+    /**
+     * \class gfx::uniform_handle program.hpp "gCore/gScene/program.hpp"
+     * \brief A resolved reference to a uniform of a linked program.
+     * 
+     * Handles come from \ref gfx::program::find_uniform() "find_uniform()"
+     * after the program is linked. Uploading through a handle goes straight
+     * to the uniform's location, with no string handling or lookups, so
+     * anything uploaded every frame should resolve its handles once and keep
+     * them. Handles stay good until the program is linked again. A handle
+     * for a name the program does not use is invalid, and uploads through
+     * it do nothing, just as OpenGL ignores location -1.
+     */
+    class uniform_handle {
+    public:
+                        uniform_handle();
+        bool            valid() const;
+        GLint           location() const;
+        GLenum          type() const;
+        GLint           size() const;
+    private:
+        GLint           loc;
+        GLenum          type_v;
+        GLint           size_v;
+        size_t          index;
+        size_t          array_index;
+        friend          class program;
+    };
+    /**
+     * \brief Construct an invalid uniform handle.
+     */
+    inline  uniform_handle::uniform_handle() :
+                                           loc ( -1 ),
+                                           type_v ( 0 ),
+                                           size_v ( 0 ),
+                                           index ( size_t( -1 ) ),
+                                           array_index ( size_t( -1 ) ) {}
+    /**
+     * \brief Return whether the handle refers to an active uniform.
+     * \return Whether the handle is valid
+     */
+    inline  bool    uniform_handle::valid() const
+    { return loc != -1; }
+    /**
+     * \brief Return the location of the uniform.
+     * \return The uniform location, or -1 if the handle is invalid
+     */
+    inline  GLint   uniform_handle::location() const
+    { return loc; }
+    /**
+     * \brief Return the OpenGL type of the uniform, such as FLOAT_VEC3.
+     * \return The uniform's type
+     */
+    inline  GLenum  uniform_handle::type() const
+    { return type_v; }
+    /**
+     * \brief Return the number of array elements in the uniform.
+     * \return The uniform's array size, 1 if it is not an array
+     */
+    inline  GLint   uniform_handle::size() const
+    { return size_v; }
     /**
      * \class gfx::program program.hpp "gCore/gScene/program.hpp"
      * \brief A representation of an OpenGL shading program.
@@ -204,8 +268,10 @@ namespace gfx {
      * 
      * For now, program objects are in charge of opening their own
      * source files and the given paths refer to the file system and not
-     * a virtual file system stowed off-line in a container file. There
-     * is no pre-preprocessor implemented, which has effects on other
+     * a virtual file system stowed off-line in a container file. Sources
+     * are read through a \ref gfx::shader_loader "shader_loader", which
+     * handles <tt>#include</tt> and defines, but the block pre-preprocessor
+     * described above is not implemented, which has effects on other
      * parts of the gScene module. Specifically, shading abstractions like
      * lights, cameras, and primitives that align themselves with uniform
      * variables and structures require that that appropriate uniform blocks
@@ -218,6 +284,8 @@ namespace gfx {
      * future is compilation.
      * 
      */
+    class program_queue;
+
     class program {
 
     public:
@@ -236,6 +304,11 @@ namespace gfx {
             settings&       fragment_path( std::string const& path );
             settings&       tesselation_path( std::string const& path );
             settings&       geometry_path( std::string const& path );
+            settings&       cache( program_cache& prgm_cache );
+            settings&       loader( shader_loader& source_loader );
+            settings&       define( std::string const& name,
+                                    std::string const& value = "1" );
+            settings&       feature( std::string const& keyword );
         private:
             std::string     vert_path;
             std::string     frag_path;
@@ -246,12 +319,23 @@ namespace gfx {
             bool            has_frag;
             bool            has_tess;
             bool            has_geom;
+            program_cache*  cache_v;
+            shader_loader*  loader_v;
+            shader_loader::define_list  defines_v;
+            std::vector<std::string>    features_v;
             friend          class program;
+            friend          class program_variants;
         };
         
                         program( settings const& set = settings() );
                         ~program();
         void            uniform_name( std::string const& name );
+        uniform_handle  find_uniform( std::string const& name ) const;
+        size_t          active_uniforms() const;
+        size_t          link_serial() const;
+        size_t          uploads_issued() const;
+        size_t          uploads_skipped() const;
+        void            reset_upload_counts();
         std::string     vertex_path() const { return vert_path; }
         std::string     fragment_path() const { return frag_path; }
         std::string     tesselation_path() const { return tess_path; }
@@ -265,9 +349,13 @@ namespace gfx {
 #endif
         void            compile();
         void            link();
+        bool            ready() const;
+        template< typename T >
+        void            upload_uniform( uniform_handle const& handle,
+                                        T const& val                 );
         template< typename T >
         void            upload_uniform( std::string const& name,
-                                      T const& val             );
+                                        T const& val             );
         void            use();
         bool            in_use() const;
         bool            operator ==( program const& rhs ) const;
@@ -276,9 +364,35 @@ namespace gfx {
 
     private:
         friend              class uniform;
-        typedef
-        std::map<std::string, GLint>    key_map;
-        key_map*                        uniform_map;
+        friend              class uniform_buffer;
+        friend              class program_queue;
+        friend              class render_queue;
+        friend              class command_list;
+        friend              class program_variants;
+        /*
+         * One entry per active uniform, sorted by name. Array uniforms
+         * are listed without their "[0]" suffix.
+         */
+        struct uniform_info {
+            std::string     name;
+            GLint           location;
+            GLenum          type;
+            GLint           size;
+            bool            shadowed;
+            bool            operator <( uniform_info const& rhs ) const
+            { return name < rhs.name; }
+        };
+        std::vector<uniform_info>       uniforms;
+        /*
+         * The last value uploaded through each entry of the uniform table,
+         * shadow_stride bytes apiece; enough for a mat4.
+         */
+        static size_t const shadow_stride = 16 * sizeof( GLfloat );
+        std::vector<unsigned char>      shadow_values;
+        size_t              uploads_issued_v;
+        size_t              uploads_skipped_v;
+        size_t              link_serial_v;
+        static size_t       next_link_serial;
         std::string         vert_path;
         std::string         frag_path;
         std::string         geom_path;
@@ -294,7 +408,30 @@ namespace gfx {
         GLuint              prog_ID;
         static program*     current_prgm;
         bool                in_use_v;
-        void                compile( GLuint stage_ID, std::string const& stage_path );
+        program_cache*      cache;
+        std::string         cache_key;
+        bool                from_cache;
+        double              build_start;
+        bool                queued;
+        program_queue*      build_queue;
+        shader_loader*      loader;
+        shader_loader::define_list  defines;
+        std::vector<std::string>    read_sources() const;
+        void                start_build( std::vector<std::string> const& sources );
+        void                check_stages() const;
+        void                finish_link();
+        void                compile( GLuint stage_ID, std::string const& stage_source );
+        static void         check_stage( GLuint stage_ID,
+                                         std::string const& source_names );
+        void                reflect_uniforms();
+        bool                shadow_changed( uniform_handle const& handle,
+                                            void const* val,
+                                            size_t const bytes );
+        template< typename M >
+        static void         column_major( M const& val,
+                                          size_t const cols,
+                                          size_t const rows,
+                                          GLfloat* out );
     };
     /**
      * \brief Query this \ref gfx::program "program" object to see
@@ -303,6 +440,42 @@ namespace gfx {
      */
     inline bool     program::in_use() const
     { return in_use_v; }
+    /**
+     * \brief Return the number of active uniforms found when the program
+     * was last linked.
+     * \return The number of active uniforms
+     */
+    inline size_t   program::active_uniforms() const
+    { return uniforms.size(); }
+    /**
+     * \brief Return a number identifying this program's last link.
+     * 
+     * Every link of every program gets a new serial, so anything that caches
+     * \ref gfx::uniform_handle "uniform handles" can tell when they must be
+     * resolved again. An unlinked program has serial zero.
+     * \return The link serial
+     */
+    inline size_t   program::link_serial() const
+    { return link_serial_v; }
+    /**
+     * \brief Return the number of uniform uploads that reached OpenGL.
+     * \return The uploads issued since the counts were last reset
+     */
+    inline size_t   program::uploads_issued() const
+    { return uploads_issued_v; }
+    /**
+     * \brief Return the number of uniform uploads skipped because the
+     * value had not changed.
+     * \return The uploads skipped since the counts were last reset
+     */
+    inline size_t   program::uploads_skipped() const
+    { return uploads_skipped_v; }
+    /**
+     * \brief Reset the issued and skipped upload counts, usually once a
+     * frame.
+     */
+    inline void     program::reset_upload_counts()
+    { uploads_issued_v = 0; uploads_skipped_v = 0; }
     /**
      * \brief Compare this \ref gfx::program "program" to the given one
      * to see if it does represent the same OpenGL shader program as the one
@@ -339,7 +512,11 @@ namespace gfx {
                                           has_vert( false ),
                                           has_frag( false ),
                                           has_tess( false ),
-                                          has_geom( false ){}
+                                          has_geom( false ),
+                                          cache_v( 0 ),
+                                          loader_v( 0 ),
+                                          defines_v(),
+                                          features_v(){}
     /**
      * \brief Set the new \ref gfx::program "program's" vertex shader source
      * path.
@@ -408,6 +585,53 @@ namespace gfx {
         }
         return *this;
     }
+    /**
+     * \brief Set the cache the new \ref gfx::program "program" looks for
+     * a linked binary in before compiling, and stores its binary in after
+     * linking.
+     * 
+     * The cache must outlive the program's compilation and linking.
+     * \param prgm_cache The program cache
+     * \return This settings object
+     */
+    inline program::settings&  program::settings::cache( program_cache& prgm_cache )
+    { cache_v = &prgm_cache; return *this; }
+    /**
+     * \brief Set the loader the new \ref gfx::program "program" reads its
+     * sources through.
+     * 
+     * Without one, the \ref gfx::shader_loader::shared() "shared" loader is
+     * used. The loader must outlive the program.
+     * \param source_loader The shader loader
+     * \return This settings object
+     */
+    inline program::settings&  program::settings::loader( shader_loader& source_loader )
+    { loader_v = &source_loader; return *this; }
+    /**
+     * \brief Add a preprocessor define to every stage of the new
+     * \ref gfx::program "program".
+     * 
+     * Defines are written just after the <tt>#version</tt> line, in the
+     * order they are given.
+     * \param name The name of the macro
+     * \param value The value of the macro
+     * \return This settings object
+     */
+    inline program::settings&  program::settings::define( std::string const& name,
+                                                          std::string const& value )
+    { defines_v.push_back( std::make_pair( name, value ) ); return *this; }
+    /**
+     * \brief Declare a feature keyword the shader sources can be built with.
+     * 
+     * Features only matter to a \ref gfx::program_variants
+     * "program_variants", which defines the keywords of each variant it
+     * builds; a plain program is built with none of them. Each keyword
+     * takes the next bit of a variant key, starting from the lowest.
+     * \param keyword The name the sources test with <tt>#ifdef</tt>
+     * \return This settings object
+     */
+    inline program::settings&  program::settings::feature( std::string const& keyword )
+    { features_v.push_back( keyword ); return *this; }
     /**
      * \brief Upload the given data as a uniform to the OpenGL
      * program object.
@@ -415,278 +639,465 @@ namespace gfx {
      * This is the generic template, which actually just throws an exception
      * because there are template specializations for all the supported data
      * types.
-     * \param name The name of the uniform
+     * \param handle The handle of the uniform
      * \param val The value of the uniform
      * \exception  std::invalid_argument Always throw when this version is called.
      */
     template< typename T > inline
-    void    program::upload_uniform( std::string const& name,
-                                   T const& val     )
+    void    program::upload_uniform( uniform_handle const& handle,
+                                     T const& val                 )
     {
         throw std::invalid_argument( "No support for given type of uniform." );
     }
+    /**
+     * \brief Upload the given data as the uniform with the given name.
+     * 
+     * This is the slow path: the name is looked up in the program's uniform
+     * table on every call. Unknown names are ignored, as OpenGL would.
+     * Prefer resolving a \ref gfx::uniform_handle "handle" once with
+     * \ref find_uniform() "find_uniform()" for anything uploaded often.
+     * \param name The name of the uniform
+     * \param val The value of the uniform
+     */
+    template< typename T > inline
+    void    program::upload_uniform( std::string const& name,
+                                     T const& val             )
+    { upload_uniform( find_uniform( name ), val ); }
+    /**
+     * \brief Compare a value about to be uploaded with the program's shadow
+     * copy of the uniform, and record it if it differs.
+     * 
+     * OpenGL keeps uniform values with the program, so a value that matches
+     * what was last uploaded through the same handle needs no call at all.
+     * Handles that are not in the reflected table, such as individual array
+     * elements, are never shadowed and always upload; an element upload
+     * also drops the shadow of its whole array, since both write the same
+     * locations. Neither are uploads
+     * made while another program is in use, since OpenGL sets the uniform
+     * of that program instead and this program's value is unchanged.
+     * \param handle The handle of the uniform
+     * \param val The value in the form passed to OpenGL
+     * \param bytes The size of the value
+     * \return Whether the OpenGL call must be made
+     */
+    inline  bool    program::shadow_changed( uniform_handle const& handle,
+                                             void const* val,
+                                             size_t const bytes )
+    {
+        if ( handle.loc == -1 ) {
+            return false;
+        }
+        if ( handle.array_index < uniforms.size() ) {
+            uniforms[handle.array_index].shadowed = false;
+        }
+        if ( not in_use_v or
+             handle.index >= uniforms.size() or bytes > shadow_stride ) {
+            ++uploads_issued_v;
+            return true;
+        }
+        uniform_info& info = uniforms[handle.index];
+        unsigned char* shadow = &shadow_values[handle.index * shadow_stride];
+        if ( info.shadowed and std::memcmp( shadow, val, bytes ) == 0 ) {
+            ++uploads_skipped_v;
+            return false;
+        }
+        std::memcpy( shadow, val, bytes );
+        info.shadowed = true;
+        ++uploads_issued_v;
+        return true;
+    }
+    /**
+     * \brief Copy a matrix into a plain column major array.
+     * 
+     * The matrix types are not laid out for handing straight to OpenGL, and
+     * going through to_map() allocates, so the components are copied out
+     * onto the caller's stack instead.
+     * \param val The matrix
+     * \param cols The number of columns
+     * \param rows The number of rows
+     * \param out The array to fill, cols * rows long
+     */
+    template< typename M > inline
+    void    program::column_major( M const& val,
+                                   size_t const cols,
+                                   size_t const rows,
+                                   GLfloat* out )
+    {
+        for ( size_t col = 0; col < cols; ++col ) {
+            for ( size_t row = 0; row < rows; ++row ) {
+                out[col * rows + row] = val( col, row );
+            }
+        }
+    }
     /**
      * \brief Upload the given \ref gfx::float "float" as a uniform to the OpenGL
      * program object.
-     * \param name The name of the uniform
+     * \param handle The handle of the uniform
      * \param val The value of the float
      */
     template<> inline
-    void    program::upload_uniform( std::string const& name,
-                                   float32 const& val  )
-    { gl::Uniform1f( (*uniform_map)[name], val ); }
+    void    program::upload_uniform( uniform_handle const& handle,
+                                     float32 const& val                 )
+    {
+        GLfloat v = val;
+        if ( shadow_changed( handle, &v, sizeof( v ) ) ) {
+            gl::Uniform1f( handle.loc, v );
+        }
+    }
     /**
      * \brief Upload the given primitive float as a uniform to the OpenGL
      * program object.
-     * \param name The name of the uniform
+     * \param handle The handle of the uniform
      * \param val The value of the float
      */
     template<> inline
-    void    program::upload_uniform( std::string const& name,
-                                   float const& val  )
-    { //std::cout << "Mark1.1" << std::endl;
-      //std::cout << name << std::endl;
-      //std::cout << (*uniform_map)[name] << std::endl;
-      //std::cout << gl::GetUniformLocation( prog_ID, name.c_str() ) << std::endl;
-        gl::Uniform1f( (*uniform_map)[name], val ); }
+    void    program::upload_uniform( uniform_handle const& handle,
+                                     float const& val                 )
+    {
+        GLfloat v = val;
+        if ( shadow_changed( handle, &v, sizeof( v ) ) ) {
+            gl::Uniform1f( handle.loc, v );
+        }
+    }
     /**
      * \brief Upload the given \ref gfx::vec2 "vector" as a uniform to the OpenGL
      * program object.
-     * \param name The name of the uniform
-     * \param val The value of the float
+     * \param handle The handle of the uniform
+     * \param val The value of the vector
      */
     template<> inline
-    void    program::upload_uniform( std::string const& name,
-                                   vec2 const& val  )
-    { gl::Uniform2f( (*uniform_map)[name], val[0], val[1] ); }
+    void    program::upload_uniform( uniform_handle const& handle,
+                                     vec2 const& val                 )
+    {
+        GLfloat v[2] = { val[0], val[1] };
+        if ( shadow_changed( handle, v, sizeof( v ) ) ) {
+            gl::Uniform2f( handle.loc, v[0], v[1] );
+        }
+    }
     /**
      * \brief Upload the given \ref gfx::vec3 "vector" as a uniform to the OpenGL
      * program object.
-     * \param name The name of the uniform
+     * \param handle The handle of the uniform
      * \param val The value of the vector
      */
     template<> inline
-    void    program::upload_uniform( std::string const& name,
-                                   vec3 const& val  )
-    { gl::Uniform3f( (*uniform_map)[name], val[0], val[1], val[2] ); }
+    void    program::upload_uniform( uniform_handle const& handle,
+                                     vec3 const& val                 )
+    {
+        GLfloat v[3] = { val[0], val[1], val[2] };
+        if ( shadow_changed( handle, v, sizeof( v ) ) ) {
+            gl::Uniform3f( handle.loc, v[0], v[1], v[2] );
+        }
+    }
     /**
      * \brief Upload the given \ref gfx::vec4 "vector" as a uniform to the OpenGL
      * program object.
-     * \param name The name of the uniform
+     * \param handle The handle of the uniform
      * \param val The value of the vector
      */
     template<> inline
-    void    program::upload_uniform( std::string const& name,
-                                   vec4 const& val  )
-    { gl::Uniform4f( (*uniform_map)[name], val[0], val[1], val[2], val[3] ); }
+    void    program::upload_uniform( uniform_handle const& handle,
+                                     vec4 const& val                 )
+    {
+        GLfloat v[4] = { val[0], val[1], val[2], val[3] };
+        if ( shadow_changed( handle, v, sizeof( v ) ) ) {
+            gl::Uniform4f( handle.loc, v[0], v[1], v[2], v[3] );
+        }
+    }
     /**
      * \brief Upload the given \ref gfx::int32 "integer" as a uniform to the OpenGL
      * program object.
-     * \param name The name of the uniform
+     * \param handle The handle of the uniform
      * \param val The value of the integer
      */
     template<> inline
-    void    program::upload_uniform( std::string const& name,
-                                   int32 const& val  )
-    { gl::Uniform1i( (*uniform_map)[name], val ); }
+    void    program::upload_uniform( uniform_handle const& handle,
+                                     int32 const& val                 )
+    {
+        GLint v = val;
+        if ( shadow_changed( handle, &v, sizeof( v ) ) ) {
+            gl::Uniform1i( handle.loc, v );
+        }
+    }
     /**
      * \brief Upload the given primitive integer as a uniform to the OpenGL
      * program object.
-     * \param name The name of the uniform
+     * \param handle The handle of the uniform
      * \param val The value of the integer
      */
     template<> inline
-    void    program::upload_uniform( std::string const& name,
-                                   int const& val  )
-    { gl::Uniform1i( (*uniform_map)[name], val ); }
+    void    program::upload_uniform( uniform_handle const& handle,
+                                     int const& val                 )
+    {
+        GLint v = val;
+        if ( shadow_changed( handle, &v, sizeof( v ) ) ) {
+            gl::Uniform1i( handle.loc, v );
+        }
+    }
     /**
      * \brief Upload the given \ref gfx::ivec2 "vector" as a uniform to the OpenGL
      * program object.
-     * \param name The name of the uniform
+     * \param handle The handle of the uniform
      * \param val The value of the integer vector
      */
     template<> inline
-    void    program::upload_uniform( std::string const& name,
-                                   ivec2 const& val  )
-    { gl::Uniform2i( (*uniform_map)[name], val[0], val[1] ); }
+    void    program::upload_uniform( uniform_handle const& handle,
+                                     ivec2 const& val                 )
+    {
+        GLint v[2] = { val[0], val[1] };
+        if ( shadow_changed( handle, v, sizeof( v ) ) ) {
+            gl::Uniform2i( handle.loc, v[0], v[1] );
+        }
+    }
     /**
      * \brief Upload the given \ref gfx::ivec3 "vector" as a uniform to the OpenGL
      * program object.
-     * \param name The name of the uniform
+     * \param handle The handle of the uniform
      * \param val The value of the integer vector
      */
     template<> inline
-    void    program::upload_uniform( std::string const& name,
-                                   ivec3 const& val  )
-    { gl::Uniform3i( (*uniform_map)[name], val[0], val[1], val[2] ); }
+    void    program::upload_uniform( uniform_handle const& handle,
+                                     ivec3 const& val                 )
+    {
+        GLint v[3] = { val[0], val[1], val[2] };
+        if ( shadow_changed( handle, v, sizeof( v ) ) ) {
+            gl::Uniform3i( handle.loc, v[0], v[1], v[2] );
+        }
+    }
     /**
      * \brief Upload the given \ref gfx::ivec4 "vector" as a uniform to the OpenGL
      * program object.
-     * \param name The name of the uniform
+     * \param handle The handle of the uniform
      * \param val The value of the integer vector
      */
     template<> inline
-    void    program::upload_uniform( std::string const& name,
-                                   ivec4 const& val  )
-    { gl::Uniform4i( (*uniform_map)[name], val[0], val[1], val[2], val[3] ); }
+    void    program::upload_uniform( uniform_handle const& handle,
+                                     ivec4 const& val                 )
+    {
+        GLint v[4] = { val[0], val[1], val[2], val[3] };
+        if ( shadow_changed( handle, v, sizeof( v ) ) ) {
+            gl::Uniform4i( handle.loc, v[0], v[1], v[2], v[3] );
+        }
+    }
     /**
      * \brief Upload the given \ref gfx::uint32 "integer" as a uniform to the OpenGL
      * program object.
-     * \param name The name of the uniform
+     * \param handle The handle of the uniform
      * \param val The value of the unsigned integer
      */
     template<> inline
-    void    program::upload_uniform( std::string const& name,
-                                   uint32 const& val  )
-    { gl::Uniform1ui( (*uniform_map)[name], val ); }
+    void    program::upload_uniform( uniform_handle const& handle,
+                                     uint32 const& val                 )
+    {
+        GLuint v = val;
+        if ( shadow_changed( handle, &v, sizeof( v ) ) ) {
+            gl::Uniform1ui( handle.loc, v );
+        }
+    }
     /**
      * \brief Upload the given primitive integer as a uniform to the OpenGL
      * program object.
-     * \param name The name of the uniform
+     * \param handle The handle of the uniform
      * \param val The value of the unsigned integer
      */
     template<> inline
-    void    program::upload_uniform( std::string const& name,
-                                   uint32_t const& val  )
-    { gl::Uniform1ui( (*uniform_map)[name], val ); }
+    void    program::upload_uniform( uniform_handle const& handle,
+                                     uint32_t const& val                 )
+    {
+        GLuint v = val;
+        if ( shadow_changed( handle, &v, sizeof( v ) ) ) {
+            gl::Uniform1ui( handle.loc, v );
+        }
+    }
     /**
      * \brief Upload the given \ref gfx::uvec2 "vector" as a uniform to the OpenGL
      * program object.
-     * \param name The name of the uniform
+     * \param handle The handle of the uniform
      * \param val The value of the unsigned integer vector
      */
     template<> inline
-    void    program::upload_uniform( std::string const& name,
-                                   uvec2 const& val  )
-    { gl::Uniform2ui( (*uniform_map)[name], val[0], val[1] ); }
+    void    program::upload_uniform( uniform_handle const& handle,
+                                     uvec2 const& val                 )
+    {
+        GLuint v[2] = { val[0], val[1] };
+        if ( shadow_changed( handle, v, sizeof( v ) ) ) {
+            gl::Uniform2ui( handle.loc, v[0], v[1] );
+        }
+    }
     /**
      * \brief Upload the given \ref gfx::uvec3 "vector" as a uniform to the OpenGL
      * program object.
-     * \param name The name of the uniform
+     * \param handle The handle of the uniform
      * \param val The value of the unsigned integer vector
      */
     template<> inline
-    void    program::upload_uniform( std::string const& name,
-                                   uvec3 const& val  )
-    { gl::Uniform3ui( (*uniform_map)[name], val[0], val[1], val[2] ); }
+    void    program::upload_uniform( uniform_handle const& handle,
+                                     uvec3 const& val                 )
+    {
+        GLuint v[3] = { val[0], val[1], val[2] };
+        if ( shadow_changed( handle, v, sizeof( v ) ) ) {
+            gl::Uniform3ui( handle.loc, v[0], v[1], v[2] );
+        }
+    }
     /**
      * \brief Upload the given \ref gfx::uvec4 "vector" as a uniform to the OpenGL
      * program object.
-     * \param name The name of the uniform
+     * \param handle The handle of the uniform
      * \param val The value of the unsigned integer vector
      */
     template<> inline
-    void    program::upload_uniform( std::string const& name,
-                                   uvec4 const& val  )
-    { gl::Uniform4ui( (*uniform_map)[name], val[0], val[1], val[2], val[3] ); }
+    void    program::upload_uniform( uniform_handle const& handle,
+                                     uvec4 const& val                 )
+    {
+        GLuint v[4] = { val[0], val[1], val[2], val[3] };
+        if ( shadow_changed( handle, v, sizeof( v ) ) ) {
+            gl::Uniform4ui( handle.loc, v[0], v[1], v[2], v[3] );
+        }
+    }
     /**
      * \brief Upload the given \ref gfx::mat2 "matrix" as a uniform to the OpenGL
      * program object.
-     * \param name The name of the uniform
+     * \param handle The handle of the uniform
      * \param val The value of the matrix
      */
     template<> inline
-    void    program::upload_uniform( std::string const& name,
-                                   mat2 const& val         )
-    { gl::UniformMatrix2fv( (*uniform_map)[name],
-                            1, gl::FALSE_,
-                            (GLfloat*) val.to_map().bytes ); }
+    void    program::upload_uniform( uniform_handle const& handle,
+                                     mat2 const& val                 )
+    {
+        GLfloat m[4];
+        column_major( val, 2, 2, m );
+        if ( shadow_changed( handle, m, sizeof( m ) ) ) {
+            gl::UniformMatrix2fv( handle.loc, 1, gl::FALSE_, m );
+        }
+    }
     /**
      * \brief Upload the given \ref gfx::mat3 "matrix" as a uniform to the OpenGL
      * program object.
-     * \param name The name of the uniform
+     * \param handle The handle of the uniform
      * \param val The value of the matrix
      */
     template<> inline
-    void    program::upload_uniform( std::string const& name,
-                                   mat3 const& val         )
-    { gl::UniformMatrix3fv( (*uniform_map)[name],
-                            1, gl::FALSE_,
-                            (GLfloat*) val.to_map().bytes ); }
+    void    program::upload_uniform( uniform_handle const& handle,
+                                     mat3 const& val                 )
+    {
+        GLfloat m[9];
+        column_major( val, 3, 3, m );
+        if ( shadow_changed( handle, m, sizeof( m ) ) ) {
+            gl::UniformMatrix3fv( handle.loc, 1, gl::FALSE_, m );
+        }
+    }
     /**
      * \brief Upload the given \ref gfx::mat4 "matrix" as a uniform to the OpenGL
      * program object.
-     * \param name The name of the uniform
+     * \param handle The handle of the uniform
      * \param val The value of the matrix
      */
     template<> inline
-    void    program::upload_uniform( std::string const& name,
-                                   mat4 const& val         )
-    { gl::UniformMatrix4fv( (*uniform_map)[name],
-                            1, gl::FALSE_,
-                            (GLfloat*) val.to_map().bytes ); }
+    void    program::upload_uniform( uniform_handle const& handle,
+                                     mat4 const& val                 )
+    {
+        GLfloat m[16];
+        column_major( val, 4, 4, m );
+        if ( shadow_changed( handle, m, sizeof( m ) ) ) {
+            gl::UniformMatrix4fv( handle.loc, 1, gl::FALSE_, m );
+        }
+    }
     /**
      * \brief Upload the given \ref gfx::mat2x3 "matrix" as a uniform to the OpenGL
      * program object.
-     * \param name The name of the uniform
+     * \param handle The handle of the uniform
      * \param val The value of the matrix
      */
     template<> inline
-    void    program::upload_uniform( std::string const& name,
-                                   mat2x3 const& val         )
-    { gl::UniformMatrix2x3fv( (*uniform_map)[name],
-                              1, gl::FALSE_,
-                              (GLfloat*) val.to_map().bytes ); }
+    void    program::upload_uniform( uniform_handle const& handle,
+                                     mat2x3 const& val                 )
+    {
+        GLfloat m[6];
+        column_major( val, 2, 3, m );
+        if ( shadow_changed( handle, m, sizeof( m ) ) ) {
+            gl::UniformMatrix2x3fv( handle.loc, 1, gl::FALSE_, m );
+        }
+    }
     /**
      * \brief Upload the given \ref gfx::mat3x2 "matrix" as a uniform to the OpenGL
      * program object.
-     * \param name The name of the uniform
+     * \param handle The handle of the uniform
      * \param val The value of the matrix
      */
     template<> inline
-    void    program::upload_uniform( std::string const& name,
-                                   mat3x2 const& val         )
-    { gl::UniformMatrix3x2fv( (*uniform_map)[name],
-                              1, gl::FALSE_,
-                              (GLfloat*) val.to_map().bytes ); }
+    void    program::upload_uniform( uniform_handle const& handle,
+                                     mat3x2 const& val                 )
+    {
+        GLfloat m[6];
+        column_major( val, 3, 2, m );
+        if ( shadow_changed( handle, m, sizeof( m ) ) ) {
+            gl::UniformMatrix3x2fv( handle.loc, 1, gl::FALSE_, m );
+        }
+    }
     /**
      * \brief Upload the given \ref gfx::mat2x4 "matrix" as a uniform to the OpenGL
      * program object.
-     * \param name The name of the uniform
+     * \param handle The handle of the uniform
      * \param val The value of the matrix
      */
     template<> inline
-    void    program::upload_uniform( std::string const& name,
-                                   mat2x4 const& val         )
-    { gl::UniformMatrix2x4fv( (*uniform_map)[name],
-                              1, gl::FALSE_,
-                              (GLfloat*) val.to_map().bytes ); }
+    void    program::upload_uniform( uniform_handle const& handle,
+                                     mat2x4 const& val                 )
+    {
+        GLfloat m[8];
+        column_major( val, 2, 4, m );
+        if ( shadow_changed( handle, m, sizeof( m ) ) ) {
+            gl::UniformMatrix2x4fv( handle.loc, 1, gl::FALSE_, m );
+        }
+    }
     /**
      * \brief Upload the given \ref gfx::mat4x2 "matrix" as a uniform to the OpenGL
      * program object.
-     * \param name The name of the uniform
+     * \param handle The handle of the uniform
      * \param val The value of the matrix
      */
     template<> inline
-    void    program::upload_uniform( std::string const& name,
-                                   mat4x2 const& val         )
-    { gl::UniformMatrix4x2fv( (*uniform_map)[name],
-                              1, gl::FALSE_,
-                              (GLfloat*) val.to_map().bytes ); }
+    void    program::upload_uniform( uniform_handle const& handle,
+                                     mat4x2 const& val                 )
+    {
+        GLfloat m[8];
+        column_major( val, 4, 2, m );
+        if ( shadow_changed( handle, m, sizeof( m ) ) ) {
+            gl::UniformMatrix4x2fv( handle.loc, 1, gl::FALSE_, m );
+        }
+    }
     /**
      * \brief Upload the given \ref gfx::mat3x4 "matrix" as a uniform to the OpenGL
      * program object.
-     * \param name The name of the uniform
+     * \param handle The handle of the uniform
      * \param val The value of the matrix
      */
     template<> inline
-    void    program::upload_uniform( std::string const& name,
-                                   mat3x4 const& val         )
-    { gl::UniformMatrix3x4fv( (*uniform_map)[name],
-                              1, gl::FALSE_,
-                              (GLfloat*) val.to_map().bytes ); }
+    void    program::upload_uniform( uniform_handle const& handle,
+                                     mat3x4 const& val                 )
+    {
+        GLfloat m[12];
+        column_major( val, 3, 4, m );
+        if ( shadow_changed( handle, m, sizeof( m ) ) ) {
+            gl::UniformMatrix3x4fv( handle.loc, 1, gl::FALSE_, m );
+        }
+    }
     /**
      * \brief Upload the given \ref gfx::mat4x3 "matrix" as a uniform to the OpenGL
      * program object.
-     * \param name The name of the uniform
+     * \param handle The handle of the uniform
      * \param val The value of the matrix
      */
     template<> inline
-    void    program::upload_uniform( std::string const& name,
-                                   mat4x3 const& val         )
-    { gl::UniformMatrix4x3fv( (*uniform_map)[name],
-                              1, gl::FALSE_,
-                              (GLfloat*) val.to_map().bytes ); }
+    void    program::upload_uniform( uniform_handle const& handle,
+                                     mat4x3 const& val                 )
+    {
+        GLfloat m[12];
+        column_major( val, 4, 3, m );
+        if ( shadow_changed( handle, m, sizeof( m ) ) ) {
+            gl::UniformMatrix4x3fv( handle.loc, 1, gl::FALSE_, m );
+        }
+    }
     
 }
 
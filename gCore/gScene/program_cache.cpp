@@ -0,0 +1,210 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <sys/stat.h>
+#include <sys/types.h>
+#ifdef _WIN32
+#include <direct.h>
+#endif
+
+#include "program_cache.hpp"
+
+namespace gfx {
+    namespace {
+        /*
+         * Every cache file starts with this header, followed by the
+         * binary itself.
+         */
+        struct blob_header {
+            char        magic[4];
+            GLenum      format;
+            GLsizei     length;
+            double      build_seconds;
+        };
+        char const  blob_magic[4] = { 'g', 'f', 'x', 'b' };
+        /*
+         * 64 bit FNV-1a, folded over each string in turn.
+         */
+        void    fnv1a( unsigned long long& hash, std::string const& text )
+        {
+            for ( size_t i = 0; i < text.size(); ++i ) {
+                hash ^= (unsigned char) text[i];
+                hash *= 1099511628211ull;
+            }
+            // Keep "ab" + "c" apart from "a" + "bc"
+            hash ^= 0xFFu;
+            hash *= 1099511628211ull;
+        }
+
+        std::string gl_string( GLenum const name )
+        {
+            GLubyte const* text = gl::GetString( name );
+            return text == 0 ? std::string() : std::string( (char const*) text );
+        }
+    }
+    /**
+     * \brief Construct a program cache.
+     * \param set The settings for the cache
+     */
+    program_cache::program_cache( settings const& set ) :
+                                  dir ( set.dir_v ),
+                                  counts (),
+                                  support ( -1 ) {}
+    /**
+     * \brief Return a steady time in seconds, for timing builds.
+     * \return The time in seconds since some fixed point
+     */
+    double  program_cache::now()
+    {
+        typedef std::chrono::high_resolution_clock  clock;
+        return std::chrono::duration<double>( clock::now().time_since_epoch() ).count();
+    }
+    /**
+     * \brief Query whether the active context can save and load program
+     * binaries.
+     *
+     * The answer is worked out once, the first time it is needed.
+     * \return Whether program binaries are supported
+     */
+    bool    program_cache::supported()
+    {
+        if ( support < 0 ) {
+            support = 0;
+            if ( video_system::get().context_present() ) {
+                bool available = video_system::get().get_version() >= opengl_4_1;
+                if ( not available ) {
+                    gl::sys::CheckExtensions();
+                    available = gl::exts::var_ARB_get_program_binary;
+                }
+                GLint formats = 0;
+                if ( available ) {
+                    gl::GetIntegerv( gl::NUM_PROGRAM_BINARY_FORMATS, &formats );
+                }
+                support = ( formats > 0 ? 1 : 0 );
+            }
+        }
+        return support == 1;
+    }
+    /**
+     * \brief Build the cache key for a program.
+     * \param sources The source of every stage, in a fixed stage order
+     * \param defines The preprocessor defines the sources are built with
+     * \return The key, as sixteen hexadecimal digits
+     */
+    std::string program_cache::key( std::vector<std::string> const& sources,
+                                    std::string const& defines ) const
+    {
+        unsigned long long hash = 14695981039346656037ull;
+        fnv1a( hash, gl_string( gl::VENDOR ) );
+        fnv1a( hash, gl_string( gl::RENDERER ) );
+        fnv1a( hash, gl_string( gl::VERSION ) );
+        fnv1a( hash, defines );
+        for ( size_t i = 0; i < sources.size(); ++i ) {
+            fnv1a( hash, sources[i] );
+        }
+        std::ostringstream hex;
+        hex << std::hex << std::setw( 16 ) << std::setfill( '0' ) << hash;
+        return hex.str();
+    }
+    /**
+     * \brief Load the binary stored under the given key into a program.
+     *
+     * On success the program is linked and ready to use. A binary the
+     * driver rejects is deleted so it is not tried again.
+     * \param prog_ID The OpenGL name of the program
+     * \param key The key of the program
+     * \return Whether the program was loaded from the cache
+     */
+    bool    program_cache::load( GLuint const prog_ID,
+                                 std::string const& key )
+    {
+        if ( not supported() ) {
+            ++counts.misses;
+            return false;
+        }
+        double start = now();
+        std::string file_path = path( key );
+        std::ifstream in ( file_path.c_str(), std::ios_base::in | std::ios_base::binary );
+        blob_header header;
+        if ( not in.read( (char*) &header, sizeof( header ) ) or
+             std::memcmp( header.magic, blob_magic, sizeof( blob_magic ) ) != 0 or
+             header.length <= 0 ) {
+            ++counts.misses;
+            return false;
+        }
+        std::vector<char> binary ( header.length );
+        if ( not in.read( &binary[0], header.length ) ) {
+            ++counts.misses;
+            return false;
+        }
+        in.close();
+
+        gl::ProgramBinary( prog_ID, header.format, &binary[0], header.length );
+        GLint status = gl::FALSE_;
+        gl::GetProgramiv( prog_ID, gl::LINK_STATUS, &status );
+        if ( status == gl::FALSE_ ) {
+            std::remove( file_path.c_str() );
+            ++counts.rejected;
+            ++counts.misses;
+            return false;
+        }
+        ++counts.hits;
+        double saved = header.build_seconds - ( now() - start );
+        if ( saved > 0.0 ) {
+            counts.seconds_saved += saved;
+        }
+        return true;
+    }
+    /**
+     * \brief Write the binary of a linked program to the cache.
+     *
+     * The program should have been linked with
+     * PROGRAM_BINARY_RETRIEVABLE_HINT set. Failing to write the file is
+     * not an error; the program is simply built from source next time.
+     * \param prog_ID The OpenGL name of the program
+     * \param key The key of the program
+     * \param build_seconds How long compiling and linking took, reported
+     * as saved time on later hits
+     */
+    void    program_cache::store( GLuint const prog_ID,
+                                  std::string const& key,
+                                  double const build_seconds )
+    {
+        if ( not supported() ) {
+            return;
+        }
+        GLint length = 0;
+        gl::GetProgramiv( prog_ID, gl::PROGRAM_BINARY_LENGTH, &length );
+        if ( length <= 0 ) {
+            return;
+        }
+        blob_header header;
+        std::memcpy( header.magic, blob_magic, sizeof( blob_magic ) );
+        header.build_seconds = build_seconds;
+        std::vector<char> binary ( length );
+        gl::GetProgramBinary( prog_ID, length, &header.length,
+                              &header.format, &binary[0] );
+        if ( header.length <= 0 ) {
+            return;
+        }
+#ifdef _WIN32
+        _mkdir( dir.c_str() );
+#else
+        mkdir( dir.c_str(), 0755 );
+#endif
+        std::ofstream out ( path( key ).c_str(),
+                            std::ios_base::out | std::ios_base::binary | std::ios_base::trunc );
+        out.write( (char const*) &header, sizeof( header ) );
+        out.write( &binary[0], header.length );
+    }
+    /**
+     * \brief Return the path of the file for the given key.
+     * \param key The key of a program
+     * \return The path of its cache file
+     */
+    std::string program_cache::path( std::string const& key ) const
+    { return dir + "/" + key + ".bin"; }
+}
@@ -0,0 +1,98 @@
+#ifndef PROGRAM_CACHE_HPP
+#define PROGRAM_CACHE_HPP
+
+#include <string>
+#include <vector>
+
+#include "../gVideo/gl_core_3_3.hpp"
+#include "../gVideo/video.hpp"
+
+namespace gfx {
+    /**
+     * \class gfx::program_cache program_cache.hpp "gCore/gScene/program_cache.hpp"
+     * \brief Keeps linked program binaries on disk so later launches can
+     * skip compiling shader source.
+     *
+     * A program given a cache through its settings asks the cache for a
+     * binary before compiling. Binaries are keyed by a hash of every stage
+     * source, the preprocessor defines and the driver's vendor, renderer
+     * and version strings, so editing a shader or updating the driver
+     * simply misses. A driver may still refuse a binary it wrote itself;
+     * the file is then deleted and the program is built from source as if
+     * nothing had been cached.
+     *
+     * Binaries need ARB_get_program_binary or OpenGL 4.1; without them
+     * every lookup misses and nothing is written.
+     */
+    class program_cache {
+    public:
+        class settings {
+        public:
+                            settings();
+            settings&       directory( std::string const& path );
+        private:
+            std::string     dir_v;
+            friend          class program_cache;
+        };
+        /**
+         * \brief Counts of cache lookups and the build time they saved.
+         */
+        struct cache_stats {
+            size_t          hits;
+            size_t          misses;
+            size_t          rejected;
+            double          seconds_saved;
+        };
+                            program_cache( settings const& set = settings() );
+        static double       now();
+        bool                supported();
+        std::string         key( std::vector<std::string> const& sources,
+                                 std::string const& defines ) const;
+        bool                load( GLuint const prog_ID,
+                                  std::string const& key );
+        void                store( GLuint const prog_ID,
+                                   std::string const& key,
+                                   double const build_seconds );
+        std::string const&  directory() const;
+        cache_stats const&  stats() const;
+    private:
+        std::string         dir;
+        cache_stats         counts;
+        int                 support;
+
+        std::string         path( std::string const& key ) const;
+    };
+    /**
+     * \brief Construct a default \ref gfx::program_cache::settings
+     * "settings" object.
+     *
+     * Binaries go in a "shader_cache" directory under the working
+     * directory.
+     */
+    inline  program_cache::settings::settings() :
+                                     dir_v ( "shader_cache" ) {}
+    /**
+     * \brief Set the directory binaries are kept in.
+     *
+     * It is created when the first binary is stored.
+     * \param path The cache directory
+     * \return This settings object
+     */
+    inline  program_cache::settings&
+    program_cache::settings::directory( std::string const& path )
+    { dir_v = path; return *this; }
+    /**
+     * \brief Return the directory binaries are kept in.
+     * \return The cache directory
+     */
+    inline  std::string const&  program_cache::directory() const
+    { return dir; }
+    /**
+     * \brief Return the hit, miss and rejection counts so far.
+     * \return The cache statistics
+     */
+    inline  program_cache::cache_stats const&   program_cache::stats() const
+    { return counts; }
+}
+
+#endif
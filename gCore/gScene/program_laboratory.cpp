@@ -135,7 +135,7 @@ SUITE( GLSLShadingTests )
         
         texture_2D test_txtr ( texture_2D::settings()
                                .file( "./tex/caves/cavemossshader01_n.png" )
-                               .unsigned_norm_3( eight_bit, b, g, r )
+                               .unsigned_norm_3( eight_bit )
                                .sample_magnification( linear ) );
         test_txtr.decode_file();
         test_txtr.load_data();
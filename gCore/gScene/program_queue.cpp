@@ -0,0 +1,307 @@
+#include "program_queue.hpp"
+
+#include <algorithm>
+
+namespace gfx {
+    /**
+     * \brief Construct a program queue and start its worker threads.
+     *
+     * Parallel compilation is switched on here if the driver offers it,
+     * so the queue should be made after the context.
+     * \param set The settings for the queue
+     */
+    program_queue::program_queue( settings const& set ) :
+                                  threads (),
+                                  lock (),
+                                  work_ready (),
+                                  read_ready (),
+                                  to_read (),
+                                  read_done (),
+                                  in_flight (),
+                                  reading ( 0 ),
+                                  stopping ( false ),
+                                  linking (),
+                                  errors (),
+                                  checks_v ( set.checks_v ),
+                                  parallel_v ( false )
+    {
+        if ( video_system::get().context_present() ) {
+            gl::sys::CheckExtensions();
+            if ( gl::exts::var_KHR_parallel_shader_compile ) {
+                // Let the driver use as many threads as it likes
+                gl::MaxShaderCompilerThreadsKHR( 0xFFFFFFFFu );
+                parallel_v = true;
+            }
+        }
+        for ( size_t i = 0; i < set.workers_v; ++i ) {
+            threads.push_back( std::thread( &program_queue::work, this ) );
+        }
+    }
+    /**
+     * \brief Stop the worker threads and drop any unfinished builds.
+     */
+    program_queue::~program_queue()
+    {
+        {
+            std::lock_guard<std::mutex> guard ( lock );
+            stopping = true;
+        }
+        work_ready.notify_all();
+        for ( size_t i = 0; i < threads.size(); ++i ) {
+            threads[i].join();
+        }
+        for ( size_t i = 0; i < to_read.size(); ++i ) { drop( to_read[i] ); }
+        for ( size_t i = 0; i < read_done.size(); ++i ) { drop( read_done[i] ); }
+        for ( size_t i = 0; i < linking.size(); ++i ) { drop( linking[i] ); }
+    }
+    /**
+     * \brief Add a program to be built.
+     *
+     * The program is not ready until the queue has finished with it,
+     * even if it was linked before.
+     * \param prgm The program to build
+     */
+    void    program_queue::submit( program& prgm )
+    {
+        if ( prgm.build_queue != 0 ) {
+            prgm.build_queue->cancel( prgm );
+        }
+        build_job* job = new build_job();
+        job->prgm = &prgm;
+        prgm.queued = true;
+        prgm.build_queue = this;
+        errors.erase( &prgm );
+        {
+            std::lock_guard<std::mutex> guard ( lock );
+            to_read.push_back( job );
+            ++reading;
+        }
+        work_ready.notify_one();
+    }
+    /**
+     * \brief Take a program out of the queue, wherever its build has got
+     * to.
+     *
+     * If a worker is reading the program's sources this waits for it to
+     * finish, so the program may be destroyed as soon as this returns.
+     * The program is left as it was before it was submitted, except that
+     * it is not linked. Call this from the thread that owns the context.
+     * \param prgm The program to take out; nothing happens if it is not
+     * in this queue
+     */
+    void    program_queue::cancel( program& prgm )
+    {
+        if ( prgm.build_queue != this ) {
+            return;
+        }
+        std::unique_lock<std::mutex> guard ( lock );
+        bool being_read = true;
+        while ( being_read ) {
+            being_read = false;
+            for ( size_t i = 0; i < in_flight.size(); ++i ) {
+                being_read = being_read or in_flight[i]->prgm == &prgm;
+            }
+            if ( being_read ) {
+                read_ready.wait( guard );
+            }
+        }
+        for ( size_t i = 0; i < to_read.size(); ) {
+            if ( to_read[i]->prgm == &prgm ) {
+                delete to_read[i];
+                to_read.erase( to_read.begin() + i );
+                --reading;
+            } else {
+                ++i;
+            }
+        }
+        for ( size_t i = 0; i < read_done.size(); ) {
+            if ( read_done[i]->prgm == &prgm ) {
+                delete read_done[i];
+                read_done.erase( read_done.begin() + i );
+            } else {
+                ++i;
+            }
+        }
+        for ( size_t i = 0; i < linking.size(); ) {
+            if ( linking[i]->prgm == &prgm ) {
+                delete linking[i];
+                linking.erase( linking.begin() + i );
+            } else {
+                ++i;
+            }
+        }
+        errors.erase( &prgm );
+        prgm.link_serial_v = 0;
+        prgm.queued = false;
+        prgm.build_queue = 0;
+    }
+    /**
+     * \brief Move builds along without waiting on the driver more than
+     * the settings allow.
+     *
+     * Call this once a frame from the thread that owns the context.
+     */
+    void    program_queue::update()
+    { advance( checks_v ); }
+    /**
+     * \brief Build everything submitted so far, waiting as long as it
+     * takes.
+     */
+    void    program_queue::finish()
+    {
+        while ( pending() > 0 ) {
+            {
+                std::unique_lock<std::mutex> guard ( lock );
+                while ( read_done.empty() and reading > 0 and linking.empty() ) {
+                    read_ready.wait( guard );
+                }
+            }
+            advance( size_t( -1 ) );
+        }
+    }
+    /**
+     * \brief Return the number of programs not yet ready or failed.
+     * \return The number of unfinished builds
+     */
+    size_t  program_queue::pending() const
+    {
+        std::lock_guard<std::mutex> guard ( lock );
+        return reading + read_done.size() + linking.size();
+    }
+    /**
+     * \brief Query whether building the given program failed.
+     * \param prgm A submitted program
+     * \return Whether its sources could not be read, compiled or linked
+     */
+    bool    program_queue::failed( program const& prgm ) const
+    { return errors.find( &prgm ) != errors.end(); }
+    /**
+     * \brief Return why building the given program failed.
+     * \param prgm A submitted program
+     * \return The error message, or an empty string if it has not failed
+     */
+    std::string const&  program_queue::error( program const& prgm ) const
+    {
+        static std::string const none;
+        error_map::const_iterator found = errors.find( &prgm );
+        return found == errors.end() ? none : found->second;
+    }
+    /**
+     * \brief The loop each worker thread runs, reading sources until the
+     * queue is destroyed.
+     */
+    void    program_queue::work()
+    {
+        while ( true ) {
+            build_job* job = 0;
+            {
+                std::unique_lock<std::mutex> guard ( lock );
+                while ( to_read.empty() and not stopping ) {
+                    work_ready.wait( guard );
+                }
+                if ( stopping ) {
+                    return;
+                }
+                job = to_read.front();
+                to_read.pop_front();
+                in_flight.push_back( job );
+            }
+            try {
+                job->sources = job->prgm->read_sources();
+            } catch ( std::exception& e ) {
+                job->error = e.what();
+            }
+            {
+                std::lock_guard<std::mutex> guard ( lock );
+                in_flight.erase( std::find( in_flight.begin(), in_flight.end(), job ) );
+                read_done.push_back( job );
+                --reading;
+            }
+            read_ready.notify_all();
+        }
+    }
+    /**
+     * \brief Hand read sources to the driver and check on programs it is
+     * building.
+     * \param checks How many programs may be checked when the driver
+     * cannot say whether it is done
+     */
+    void    program_queue::advance( size_t const checks )
+    {
+        std::deque<build_job*> arrived;
+        {
+            std::lock_guard<std::mutex> guard ( lock );
+            arrived.swap( read_done );
+        }
+        for ( size_t i = 0; i < arrived.size(); ++i ) {
+            build_job* job = arrived[i];
+            if ( not job->error.empty() ) {
+                fail( job, job->error );
+                continue;
+            }
+            job->prgm->start_build( job->sources );
+            if ( not job->prgm->from_cache ) {
+                gl::LinkProgram( job->prgm->prog_ID );
+            }
+            job->sources.clear();
+            std::lock_guard<std::mutex> guard ( lock );
+            linking.push_back( job );
+        }
+
+        size_t checks_left = checks;
+        size_t kept = 0;
+        for ( size_t i = 0; i < linking.size(); ++i ) {
+            build_job* job = linking[i];
+            bool done = job->prgm->from_cache;
+            if ( not done and parallel_v ) {
+                GLint complete = gl::FALSE_;
+                gl::GetProgramiv( job->prgm->prog_ID, gl::COMPLETION_STATUS_KHR, &complete );
+                done = ( complete != gl::FALSE_ );
+            } else if ( not done and checks_left > 0 ) {
+                --checks_left;
+                done = true;
+            }
+            if ( not done ) {
+                linking[kept++] = job;
+                continue;
+            }
+            try {
+                if ( not job->prgm->from_cache ) {
+                    job->prgm->check_stages();
+                }
+                job->prgm->finish_link();
+                job->prgm->queued = false;
+                job->prgm->build_queue = 0;
+                delete job;
+            } catch ( compilation_error& e ) {
+                fail( job, e.what() );
+            }
+        }
+        std::lock_guard<std::mutex> guard ( lock );
+        linking.resize( kept );
+    }
+    /**
+     * \brief Record a failed build and drop it from the queue.
+     * \param job The failed build
+     * \param msg Why it failed
+     */
+    void    program_queue::fail( build_job* job, std::string const& msg )
+    {
+        errors[job->prgm] = msg;
+        // Whatever the program was linked to before is gone
+        job->prgm->link_serial_v = 0;
+        job->prgm->queued = false;
+        job->prgm->build_queue = 0;
+        delete job;
+    }
+    /**
+     * \brief Drop a build when the queue is destroyed, leaving its
+     * program unbuilt but no longer pointing at the queue.
+     * \param job The unfinished build
+     */
+    void    program_queue::drop( build_job* job )
+    {
+        job->prgm->build_queue = 0;
+        delete job;
+    }
+}
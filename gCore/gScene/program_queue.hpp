@@ -0,0 +1,128 @@
+#ifndef PROGRAM_QUEUE_HPP
+#define PROGRAM_QUEUE_HPP
+
+#include <map>
+#include <deque>
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "../gVideo/gl_core_3_3.hpp"
+#include "../gVideo/video.hpp"
+#include "program.hpp"
+
+namespace gfx {
+    /**
+     * \class gfx::program_queue program_queue.hpp "gCore/gScene/program_queue.hpp"
+     * \brief Builds programs in the background while the application keeps
+     * rendering.
+     *
+     * Every program is submitted up front. Worker threads read the shader
+     * sources, and \ref update() "update()", called once a frame on the
+     * thread that owns the context, hands finished sources to the driver
+     * and checks on programs the driver is still working on. A program is
+     * usable once its \ref gfx::program::ready() "ready()" says so.
+     *
+     * Checking whether a program compiled normally makes the driver finish
+     * compiling it there and then. With KHR_parallel_shader_compile the
+     * queue asks the driver if it is done instead, which never waits.
+     * Without it, \ref update() "update()" only checks a few programs each
+     * call, so the waiting is spread over several frames.
+     *
+     * Submitted programs must not be destroyed before they are ready or
+     * have failed unless they are taken out of the queue first with
+     * \ref cancel() "cancel()", which waits for a worker still reading
+     * their sources.
+     */
+    class program_queue {
+    public:
+        class settings {
+        public:
+                            settings();
+            settings&       workers( size_t const threads );
+            settings&       checks_per_update( size_t const checks );
+        private:
+            size_t          workers_v;
+            size_t          checks_v;
+            friend          class program_queue;
+        };
+                            program_queue( settings const& set = settings() );
+                            ~program_queue();
+        void                submit( program& prgm );
+        void                cancel( program& prgm );
+        void                update();
+        void                finish();
+        size_t              pending() const;
+        bool                parallel() const;
+        bool                failed( program const& prgm ) const;
+        std::string const&  error( program const& prgm ) const;
+    private:
+                            program_queue( program_queue const& );
+        program_queue&      operator =( program_queue const& );
+
+        struct build_job {
+            program*                    prgm;
+            std::vector<std::string>    sources;
+            std::string                 error;
+        };
+        typedef std::map<program const*, std::string>   error_map;
+
+        std::vector<std::thread>    threads;
+        mutable std::mutex          lock;
+        std::condition_variable     work_ready;
+        std::condition_variable     read_ready;
+        std::deque<build_job*>      to_read;
+        std::deque<build_job*>      read_done;
+        std::vector<build_job*>     in_flight;
+        size_t                      reading;
+        bool                        stopping;
+
+        std::vector<build_job*>     linking;
+        error_map                   errors;
+        size_t                      checks_v;
+        bool                        parallel_v;
+
+        void                work();
+        void                advance( size_t const checks );
+        void                fail( build_job* job, std::string const& msg );
+        void                drop( build_job* job );
+    };
+    /**
+     * \brief Construct a default \ref gfx::program_queue::settings
+     * "settings" object.
+     *
+     * By default two worker threads read sources and, without parallel
+     * compilation, one program is checked per update.
+     */
+    inline  program_queue::settings::settings() :
+                                     workers_v ( 2 ),
+                                     checks_v ( 1 ) {}
+    /**
+     * \brief Set the number of worker threads reading sources.
+     * \param threads The number of threads, at least one
+     * \return This settings object
+     */
+    inline  program_queue::settings&
+    program_queue::settings::workers( size_t const threads )
+    { workers_v = ( threads == 0 ? 1 : threads ); return *this; }
+    /**
+     * \brief Set how many programs an update may wait on when the driver
+     * cannot report whether it has finished.
+     * \param checks The number of programs checked per update
+     * \return This settings object
+     */
+    inline  program_queue::settings&
+    program_queue::settings::checks_per_update( size_t const checks )
+    { checks_v = ( checks == 0 ? 1 : checks ); return *this; }
+    /**
+     * \brief Query whether the driver compiles in parallel and reports
+     * completion without waiting.
+     * \return Whether KHR_parallel_shader_compile is in use
+     */
+    inline  bool    program_queue::parallel() const
+    { return parallel_v; }
+}
+
+#endif
@@ -9,6 +9,8 @@
 #include "../gVideo/video.hpp"
 #include "vertex_buffer.hpp"
 #include "program.hpp"
+#include "program_queue.hpp"
+#include "program_variants.hpp"
 
 using namespace gfx;
 
@@ -127,6 +129,272 @@ SUITE( ProgramTests )
      
     }
     
+    TEST( UniformReflection )
+    {
+        window test_wndw ( window::settings()
+                           .has_3D()          );
+        context test_cntx ( test_wndw );
+        
+        program test_prgm ( program::settings()
+                           .vertex_path( "./shader/scene_test_vert.glsl" )
+                           .fragment_path( "./shader/scene_test_frag.glsl" ) );
+        test_prgm.compile();
+        CHECK_EQUAL( 0u, test_prgm.link_serial() );
+        test_prgm.link();
+        CHECK( test_prgm.link_serial() != 0u );
+        
+        // No uniform_name() calls needed; everything is found at link time
+        CHECK_EQUAL( 5u, test_prgm.active_uniforms() );
+        uniform_handle obj_mat = test_prgm.find_uniform( "obj_mat" );
+        CHECK( obj_mat.valid() );
+        CHECK_EQUAL( GLenum( gl::FLOAT_MAT4 ), obj_mat.type() );
+        CHECK( test_prgm.find_uniform( "light.pos" ).valid() );
+        CHECK( not test_prgm.find_uniform( "no_such_uniform" ).valid() );
+        
+        test_prgm.use();
+        test_prgm.upload_uniform( obj_mat, mat4() );
+        test_prgm.upload_uniform( "no_such_uniform", 1.0f );
+        CHECK( not test_prgm.find_uniform( "no_such_uniform" ).valid() );
+    }
+    
+    TEST( UniformShadowing )
+    {
+        window test_wndw ( window::settings()
+                           .has_3D()          );
+        context test_cntx ( test_wndw );
+        
+        program test_prgm ( program::settings()
+                           .vertex_path( "./shader/scene_test_vert.glsl" )
+                           .fragment_path( "./shader/scene_test_frag.glsl" ) );
+        test_prgm.compile();
+        test_prgm.link();
+        test_prgm.use();
+        
+        uniform_handle obj_mat = test_prgm.find_uniform( "obj_mat" );
+        uniform_handle rad = test_prgm.find_uniform( "light.rad" );
+        test_prgm.upload_uniform( obj_mat, mat4() );
+        test_prgm.upload_uniform( rad, 2.0f );
+        CHECK_EQUAL( 2u, test_prgm.uploads_issued() );
+        CHECK_EQUAL( 0u, test_prgm.uploads_skipped() );
+        
+        // Same values again; nothing reaches OpenGL
+        test_prgm.upload_uniform( obj_mat, mat4() );
+        test_prgm.upload_uniform( rad, 2.0f );
+        CHECK_EQUAL( 2u, test_prgm.uploads_issued() );
+        CHECK_EQUAL( 2u, test_prgm.uploads_skipped() );
+        
+        test_prgm.upload_uniform( rad, 3.0f );
+        CHECK_EQUAL( 3u, test_prgm.uploads_issued() );
+        
+        // While another program is in use the value lands there instead,
+        // so it must not be taken as this program's
+        program other_prgm ( program::settings()
+                            .vertex_path( "./shader/scene_test_vert.glsl" )
+                            .fragment_path( "./shader/scene_test_frag.glsl" ) );
+        other_prgm.compile();
+        other_prgm.link();
+        other_prgm.use();
+        test_prgm.upload_uniform( rad, 4.0f );
+        test_prgm.upload_uniform( rad, 4.0f );
+        CHECK_EQUAL( 5u, test_prgm.uploads_issued() );
+        test_prgm.use();
+        test_prgm.upload_uniform( rad, 4.0f );
+        CHECK_EQUAL( 6u, test_prgm.uploads_issued() );
+        test_prgm.upload_uniform( rad, 4.0f );
+        CHECK_EQUAL( 6u, test_prgm.uploads_issued() );
+        
+        // Relinking resets the uniforms, so the shadow must be dropped
+        test_prgm.link();
+        test_prgm.reset_upload_counts();
+        test_prgm.upload_uniform( test_prgm.find_uniform( "light.rad" ), 3.0f );
+        CHECK_EQUAL( 1u, test_prgm.uploads_issued() );
+    }
+    
+    TEST( ArrayElementsDropTheShadow )
+    {
+        window test_wndw ( window::settings()
+                           .has_3D()          );
+        context test_cntx ( test_wndw );
+        
+        program test_prgm ( program::settings()
+                           .vertex_path( "./shader/uniform_array_vert.glsl" )
+                           .fragment_path( "./shader/testFrag.glsl" ) );
+        test_prgm.compile();
+        test_prgm.link();
+        test_prgm.use();
+        
+        // The element and the whole array write the same location, so
+        // going back to the array's last value must still be uploaded
+        uniform_handle weights = test_prgm.find_uniform( "weights" );
+        uniform_handle first = test_prgm.find_uniform( "weights[0]" );
+        CHECK( first.valid() );
+        CHECK_EQUAL( weights.location(), first.location() );
+        test_prgm.upload_uniform( weights, 1.0f );
+        test_prgm.upload_uniform( first, 2.0f );
+        test_prgm.upload_uniform( weights, 1.0f );
+        CHECK_EQUAL( 3u, test_prgm.uploads_issued() );
+        CHECK_EQUAL( 0u, test_prgm.uploads_skipped() );
+        
+        test_prgm.upload_uniform( weights, 1.0f );
+        CHECK_EQUAL( 1u, test_prgm.uploads_skipped() );
+    }
+    
+    TEST( ProgramBinaryCache )
+    {
+        window test_wndw ( window::settings()
+                           .has_3D()          );
+        context test_cntx ( test_wndw );
+        
+        program_cache test_cache ( program_cache::settings()
+                                   .directory( "./shader_cache_test" ) );
+        std::vector<std::string> sources ( 1, "void main() {}" );
+        CHECK_EQUAL( test_cache.key( sources, "" ), test_cache.key( sources, "" ) );
+        CHECK( test_cache.key( sources, "" ) != test_cache.key( sources, "SHADOWS" ) );
+        
+        for ( size_t i = 0; i < 2; ++i ) {
+            program test_prgm ( program::settings()
+                               .vertex_path( "./shader/scene_test_vert.glsl" )
+                               .fragment_path( "./shader/scene_test_frag.glsl" )
+                               .cache( test_cache ) );
+            test_prgm.compile();
+            test_prgm.link();
+            CHECK( test_prgm.active_uniforms() > 0u );
+        }
+        // The second program finds the first one's binary, if the
+        // driver can hand out binaries at all
+        if ( test_cache.supported() ) {
+            CHECK( test_cache.stats().hits >= 1u );
+        } else {
+            CHECK_EQUAL( 2u, test_cache.stats().misses );
+        }
+    }
+    
+    TEST( ProgramQueue )
+    {
+        window test_wndw ( window::settings()
+                           .has_3D()          );
+        context test_cntx ( test_wndw );
+        
+        program_queue test_queue ( program_queue::settings()
+                                   .workers( 2 )
+                                   .checks_per_update( 1 ) );
+        program first ( program::settings()
+                        .vertex_path( "./shader/scene_test_vert.glsl" )
+                        .fragment_path( "./shader/scene_test_frag.glsl" ) );
+        program second ( program::settings()
+                         .vertex_path( "./shader/scene_test_vert.glsl" )
+                         .fragment_path( "./shader/scene_test_frag.glsl" ) );
+        program missing ( program::settings()
+                          .vertex_path( "./shader/no_such_vert.glsl" )
+                          .fragment_path( "./shader/scene_test_frag.glsl" ) );
+        test_queue.submit( first );
+        test_queue.submit( second );
+        test_queue.submit( missing );
+        CHECK( not first.ready() );
+        CHECK( not second.ready() );
+        
+        test_queue.finish();
+        CHECK_EQUAL( 0u, test_queue.pending() );
+        CHECK( first.ready() );
+        CHECK( second.ready() );
+        CHECK( first.active_uniforms() > 0u );
+        CHECK( not missing.ready() );
+        CHECK( test_queue.failed( missing ) );
+        CHECK( not test_queue.error( missing ).empty() );
+        CHECK( not test_queue.failed( first ) );
+        
+        // A cancelled build is gone, whether or not a worker had it
+        test_queue.submit( first );
+        test_queue.submit( second );
+        test_queue.cancel( first );
+        test_queue.cancel( second );
+        test_queue.cancel( missing );
+        CHECK_EQUAL( 0u, test_queue.pending() );
+        CHECK( not first.ready() );
+        CHECK( not test_queue.failed( first ) );
+        test_queue.finish();
+    }
+    
+    TEST( VariantKeys )
+    {
+        program_variants test_variants ( program::settings()
+                                         .vertex_path( "./shader/testVert_features.glsl" )
+                                         .fragment_path( "./shader/testFrag_features.glsl" )
+                                         .feature( "COLORED" )
+                                         .feature( "TEXTURED_2D" ) );
+        CHECK_EQUAL( 2u, test_variants.features() );
+        CHECK_EQUAL( "TEXTURED_2D", test_variants.feature( 1 ) );
+        CHECK_EQUAL( 0u, test_variants.key( "" ) );
+        CHECK_EQUAL( 1u, test_variants.key( "COLORED" ) );
+        CHECK_EQUAL( 3u, test_variants.key( "TEXTURED_2D COLORED" ) );
+        CHECK_EQUAL( 0u, test_variants.size() );
+        
+        std::string excepted ( "Exception not caught." );
+        try {
+            test_variants.key( "SHADOWS" );
+        } catch ( std::invalid_argument& e ) {
+            excepted = "Unknown keyword exception caught.";
+        }
+        CHECK_EQUAL( "Unknown keyword exception caught.", excepted );
+        
+        excepted = "Exception not caught.";
+        try {
+            program_variants twice ( program::settings()
+                                     .feature( "COLORED" )
+                                     .feature( "COLORED" ) );
+        } catch ( std::invalid_argument& e ) {
+            excepted = "Duplicate keyword exception caught.";
+        }
+        CHECK_EQUAL( "Duplicate keyword exception caught.", excepted );
+    }
+    
+    TEST( ProgramVariants )
+    {
+        window test_wndw ( window::settings()
+                           .has_3D()          );
+        context test_cntx ( test_wndw );
+        
+        program_variants test_variants ( program::settings()
+                                         .vertex_path( "./shader/testVert_features.glsl" )
+                                         .fragment_path( "./shader/testFrag_features.glsl" )
+                                         .feature( "COLORED" )
+                                         .feature( "TEXTURED_2D" ) );
+        program& textured = test_variants.get( "TEXTURED_2D" );
+        CHECK( textured.ready() );
+        CHECK( textured.find_uniform( "smilie" ).valid() );
+        // The same key gives back the same program
+        CHECK( &textured == &test_variants.get( test_variants.key( "TEXTURED_2D" ) ) );
+        CHECK( not test_variants.get( 0 ).find_uniform( "smilie" ).valid() );
+        CHECK_EQUAL( 2u, test_variants.size() );
+        
+        program_queue test_queue;
+        std::vector<program_variants::key_type> warm;
+        warm.push_back( test_variants.key( "COLORED" ) );
+        warm.push_back( test_variants.key( "TEXTURED_2D" ) );
+        test_variants.prewarm( warm, test_queue );
+        test_queue.finish();
+        CHECK_EQUAL( 3u, test_variants.size() );
+        CHECK( test_variants.get( "COLORED" ).ready() );
+        
+        test_variants.release( 0 );
+        CHECK( not test_variants.resident( 0 ) );
+        
+        // Variants destroyed while still queued are taken out of the queue
+        program_queue late_queue;
+        {
+            program_variants dropped ( program::settings()
+                                       .vertex_path( "./shader/testVert_features.glsl" )
+                                       .fragment_path( "./shader/testFrag_features.glsl" )
+                                       .feature( "COLORED" )
+                                       .feature( "TEXTURED_2D" ) );
+            dropped.prewarm( warm, late_queue );
+            dropped.release( warm[0] );
+            CHECK( late_queue.pending() <= 1u );
+        }
+        CHECK_EQUAL( 0u, late_queue.pending() );
+        late_queue.finish();
+    }
+    
 }
 
 SUITE( IntegratedTests )
@@ -0,0 +1,178 @@
+#include <sstream>
+
+#include "program_variants.hpp"
+
+namespace gfx {
+    /**
+     * \brief Construct the variants of a program.
+     *
+     * Nothing is built until a variant is asked for.
+     * \param set The settings every variant is built from, including the
+     * feature keywords
+     * \exception std::out_of_range If there are more features than a key
+     * has bits
+     * \exception std::invalid_argument If a keyword is declared twice
+     */
+    program_variants::program_variants( program::settings const& set ) :
+                                        base ( set ),
+                                        built ()
+    {
+        std::vector<std::string> const& keywords = base.features_v;
+        if ( keywords.size() > sizeof( key_type ) * 8 ) {
+            throw std::out_of_range( "Too many feature keywords for a variant key." );
+        }
+        for ( size_t i = 0; i < keywords.size(); ++i ) {
+            for ( size_t j = 0; j < i; ++j ) {
+                if ( keywords[i] == keywords[j] ) {
+                    throw std::invalid_argument( "Feature keyword '" + keywords[i] +
+                                                 "' declared twice." );
+                }
+            }
+        }
+    }
+    /**
+     * \brief Destroy every variant, taking any still being built out of
+     * their queue.
+     */
+    program_variants::~program_variants()
+    {
+        for ( variant_map::iterator it = built.begin(); it != built.end(); ++it ) {
+            discard( it->second );
+        }
+    }
+    /**
+     * \brief Return the variant key for the given feature keywords.
+     * \param keywords Feature keywords separated by spaces
+     * \return The variant key
+     * \exception std::invalid_argument If a keyword is not a feature
+     */
+    program_variants::key_type  program_variants::key( std::string const& keywords ) const
+    {
+        key_type variant = 0;
+        std::istringstream in ( keywords );
+        std::string keyword;
+        while ( in >> keyword ) {
+            size_t bit = 0;
+            while ( bit < base.features_v.size() and base.features_v[bit] != keyword ) {
+                ++bit;
+            }
+            if ( bit == base.features_v.size() ) {
+                throw std::invalid_argument( "'" + keyword + "' is not a feature keyword." );
+            }
+            variant |= key_type( 1 ) << bit;
+        }
+        return variant;
+    }
+    /**
+     * \brief Return the given variant, compiling and linking it if it has
+     * not been built yet.
+     *
+     * A variant handed to a \ref gfx::program_queue "program_queue" by
+     * \ref prewarm() "prewarm()" is returned as it is, and may not be
+     * \ref gfx::program::ready() "ready()" yet.
+     * \param variant The variant key
+     * \return The program for the variant
+     * \exception std::out_of_range If the key has a bit with no feature
+     * \exception gfx::compilation_error If the variant fails to build
+     */
+    program&    program_variants::get( key_type const variant )
+    {
+        variant_map::iterator found = built.find( variant );
+        if ( found != built.end() ) {
+            return *found->second;
+        }
+        program* prgm = create( variant );
+        try {
+            prgm->compile();
+            prgm->link();
+        } catch ( ... ) {
+            release( variant );
+            throw;
+        }
+        return *prgm;
+    }
+    /**
+     * \brief Build the given variants now, so they are not compiled the
+     * first time they are drawn with.
+     *
+     * Variants already kept are skipped.
+     * \param variants The variant keys
+     * \exception std::out_of_range If a key has a bit with no feature
+     * \exception gfx::compilation_error If a variant fails to build
+     */
+    void    program_variants::prewarm( std::vector<key_type> const& variants )
+    {
+        for ( size_t i = 0; i < variants.size(); ++i ) {
+            get( variants[i] );
+        }
+    }
+    /**
+     * \brief Hand the given variants to a queue to be built in the
+     * background.
+     *
+     * Variants already kept are skipped. Each is usable once it is
+     * \ref gfx::program::ready() "ready()"; one that fails stays kept
+     * until it is \ref release() "released", and the queue holds the
+     * reason.
+     * \param variants The variant keys
+     * \param queue The queue to build them with
+     * \exception std::out_of_range If a key has a bit with no feature
+     */
+    void    program_variants::prewarm( std::vector<key_type> const& variants,
+                                       program_queue& queue )
+    {
+        for ( size_t i = 0; i < variants.size(); ++i ) {
+            if ( not resident( variants[i] ) ) {
+                queue.submit( *create( variants[i] ) );
+            }
+        }
+    }
+    /**
+     * \brief Destroy the given variant, if it is kept.
+     *
+     * A variant still in a \ref gfx::program_queue "program_queue" is
+     * taken out of it first.
+     * \param variant The variant key
+     */
+    void    program_variants::release( key_type const variant )
+    {
+        variant_map::iterator found = built.find( variant );
+        if ( found != built.end() ) {
+            discard( found->second );
+            built.erase( found );
+        }
+    }
+    /*
+     * Delete a variant, taking it out of the queue building it first.
+     */
+    void    program_variants::discard( program* prgm )
+    {
+        if ( prgm->build_queue != 0 ) {
+            prgm->build_queue->cancel( *prgm );
+        }
+        delete prgm;
+    }
+    /**
+     * \brief Make the program for a variant, with its keywords defined,
+     * and keep it.
+     * \param variant The variant key
+     * \return The new, unbuilt program
+     * \exception std::out_of_range If the key has a bit with no feature
+     */
+    program*    program_variants::create( key_type const variant )
+    {
+        size_t count = base.features_v.size();
+        if ( count < sizeof( key_type ) * 8 and ( variant >> count ) != 0 ) {
+            throw std::out_of_range( "Variant key has bits with no feature keyword." );
+        }
+        program::settings set ( base );
+        for ( size_t bit = 0; bit < count; ++bit ) {
+            if ( variant & ( key_type( 1 ) << bit ) ) {
+                set.define( base.features_v[bit] );
+            }
+        }
+        program* prgm = new program( set );
+        built[variant] = prgm;
+        return prgm;
+    }
+}
@@ -0,0 +1,103 @@
+#ifndef PROGRAM_VARIANTS_HPP
+#define PROGRAM_VARIANTS_HPP
+
+#include <map>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#include "program.hpp"
+#include "program_queue.hpp"
+
+namespace gfx {
+    /**
+     * \class gfx::program_variants program_variants.hpp "gCore/gScene/program_variants.hpp"
+     * \brief Builds the permutations of one set of shader sources on
+     * demand and keeps them, keyed by which features they have.
+     *
+     * The sources are written once, with <tt>#ifdef</tt> around the code
+     * for each feature keyword declared in the
+     * \ref gfx::program::settings "program settings". A variant key has
+     * one bit per keyword, in the order they were declared, and the
+     * variant for a key is built with just those keywords defined. Only
+     * the variants actually asked for are compiled, and each is compiled
+     * once; variants that will be needed can be built ahead of time with
+     * \ref prewarm() "prewarm()".
+     */
+    class program_variants {
+    public:
+        /**
+         * \brief A set of features, one bit per keyword.
+         */
+        typedef unsigned long long  key_type;
+
+                            program_variants( program::settings const& set );
+                            ~program_variants();
+        size_t              features() const;
+        std::string const&  feature( size_t const bit ) const;
+        key_type            key( std::string const& keywords ) const;
+        program&            get( key_type const variant );
+        program&            get( std::string const& keywords );
+        bool                resident( key_type const variant ) const;
+        size_t              size() const;
+        void                prewarm( std::vector<key_type> const& variants );
+        void                prewarm( std::vector<key_type> const& variants,
+                                     program_queue& queue );
+        void                release( key_type const variant );
+    private:
+                            program_variants( program_variants const& );
+        program_variants&   operator =( program_variants const& );
+
+        typedef std::map<key_type, program*>    variant_map;
+
+        program::settings   base;
+        variant_map         built;
+
+        program*            create( key_type const variant );
+        void                discard( program* prgm );
+    };
+    /**
+     * \brief Return the number of feature keywords.
+     * \return The number of features
+     */
+    inline  size_t  program_variants::features() const
+    { return base.features_v.size(); }
+    /**
+     * \brief Return the keyword of the given feature bit.
+     * \param bit The bit of the feature
+     * \return The feature keyword
+     * \exception std::out_of_range If there is no such feature
+     */
+    inline  std::string const&  program_variants::feature( size_t const bit ) const
+    {
+        if ( bit >= base.features_v.size() ) {
+            throw std::out_of_range( "Program variants have no feature with that bit." );
+        }
+        return base.features_v[bit];
+    }
+    /**
+     * \brief Query whether the given variant has been built or is being
+     * built.
+     * \param variant The variant key
+     * \return Whether the variant is kept
+     */
+    inline  bool    program_variants::resident( key_type const variant ) const
+    { return built.find( variant ) != built.end(); }
+    /**
+     * \brief Return the number of variants kept.
+     * \return The number of resident variants
+     */
+    inline  size_t  program_variants::size() const
+    { return built.size(); }
+    /**
+     * \brief Return the variant with the given feature keywords, building
+     * it if need be.
+     * \param keywords Feature keywords separated by spaces
+     * \return The program for the variant
+     * \exception std::invalid_argument If a keyword is not a feature
+     */
+    inline  program&    program_variants::get( std::string const& keywords )
+    { return get( key( keywords ) ); }
+}
+
+#endif
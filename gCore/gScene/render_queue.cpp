@@ -0,0 +1,213 @@
+#include "render_queue.hpp"
+
+#include "gl_state.hpp"
+#include "texture_units.hpp"
+
+namespace gfx {
+
+    namespace {
+        render_queue::sort_key const    state_mask = 0xFFF;
+        render_queue::sort_key const    depth_buckets = 0xFFFF;
+    }
+
+    /**
+     * \brief Construct a new, empty render queue.
+     */
+    render_queue::render_queue() : sorted ( true )
+    {
+        stats_v.draws = 0;
+        count_changes( true );
+        count_changes( false );
+    }
+    /**
+     * \brief Add a draw to the queue.
+     *
+     * The draw is copied; the objects it names are not, and must outlive
+     * the next \ref execute() "execute()".
+     * \param item The draw
+     */
+    void    render_queue::submit( draw const& item )
+    {
+        if ( item.prgm == 0 or item.vbo == 0 ) {
+            throw std::invalid_argument( "A queued draw needs a program and a vertex buffer." );
+        }
+        keys.push_back( make_key( item.layer_v, item.translucent_v,
+                                  item.prgm->prog_ID, texture_ID( item ),
+                                  item.vbo->vao_ID, item.depth_v ) );
+        order.push_back( items.size() );
+        items.push_back( item );
+        sorted = false;
+    }
+    /**
+     * \brief Put the draws in key order and count the state changes each
+     * order needs.
+     */
+    void    render_queue::sort()
+    {
+        size_t const n = keys.size();
+        if ( not sorted and n > 1 ) {
+            // Every byte's histogram in one pass over the keys
+            size_t counts[8][256] = { { 0 } };
+            for ( size_t i = 0; i < n; ++i ) {
+                sort_key const k = keys[i];
+                for ( size_t byte = 0; byte < 8; ++byte ) {
+                    ++counts[byte][( k >> ( byte * 8 ) ) & 0xFF];
+                }
+            }
+            key_scratch.resize( n );
+            order_scratch.resize( n );
+            for ( size_t byte = 0; byte < 8; ++byte ) {
+                size_t const shift = byte * 8;
+                if ( counts[byte][( keys[0] >> shift ) & 0xFF] == n ) {
+                    continue;
+                }
+                size_t starts[256];
+                size_t total = 0;
+                for ( size_t d = 0; d < 256; ++d ) {
+                    starts[d] = total;
+                    total += counts[byte][d];
+                }
+                for ( size_t i = 0; i < n; ++i ) {
+                    size_t const at = starts[( keys[i] >> shift ) & 0xFF]++;
+                    key_scratch[at] = keys[i];
+                    order_scratch[at] = order[i];
+                }
+                keys.swap( key_scratch );
+                order.swap( order_scratch );
+            }
+        }
+        sorted = true;
+        stats_v.draws = n;
+        count_changes( true );
+        count_changes( false );
+    }
+    /**
+     * \brief Submit every draw, sorting first if needed.
+     *
+     * The queue keeps its draws afterwards, so the same frame can be
+     * drawn again; call \ref clear() "clear()" before queueing the next
+     * one. Call this from the thread that owns the context.
+     */
+    void    render_queue::execute()
+    {
+        sort();
+        texture_units& units = texture_units::current();
+        program* last_prgm = 0;
+        texture_2D const* last_tex = 0;
+        GLuint last_unit = 0;
+        vertex_buffer* last_vbo = 0;
+        for ( size_t i = 0; i < order.size(); ++i ) {
+            draw const& item = items[order[i]];
+            if ( item.prgm != last_prgm ) {
+                item.prgm->use();
+                last_prgm = item.prgm;
+            }
+            if ( item.tex != 0 and ( item.tex != last_tex or item.unit != last_unit ) ) {
+                units.bind( item.unit, *item.tex );
+                last_tex = item.tex;
+                last_unit = item.unit;
+            }
+            if ( item.vbo != last_vbo ) {
+                item.vbo->align();
+                last_vbo = item.vbo;
+            }
+            if ( item.indexed ) {
+                gl::DrawElements( item.mode, item.count, item.index_type,
+                                  reinterpret_cast<void const*>( item.offset ) );
+            } else {
+                gl::DrawArrays( item.mode, item.first, item.count );
+            }
+        }
+    }
+    /**
+     * \brief Forget every draw, keeping the memory for the next frame.
+     */
+    void    render_queue::clear()
+    {
+        items.clear();
+        keys.clear();
+        order.clear();
+        sorted = true;
+    }
+    /**
+     * \brief Return the key of a draw.
+     * \param n The place of the draw in the current order: the order of
+     * submission until the next \ref sort() "sort()", sorted after it
+     */
+    render_queue::sort_key  render_queue::key( size_t const n ) const
+    {
+        if ( n >= keys.size() ) {
+            throw std::invalid_argument( "Index given to render queue is out of range." );
+        }
+        return keys[n];
+    }
+    /**
+     * \brief Pack the sort key of a draw.
+     * \param layer The layer, from 0 to 15
+     * \param translucent Whether the draw blends
+     * \param prog_ID The name of the program
+     * \param tex_ID The name of the texture, or 0 for none
+     * \param vao_ID The name of the vertex array
+     * \param depth The depth from 0 to 1, clamped
+     * \return The key
+     */
+    render_queue::sort_key  render_queue::make_key( unsigned int const layer,
+                                                    bool const translucent,
+                                                    GLuint const prog_ID,
+                                                    GLuint const tex_ID,
+                                                    GLuint const vao_ID,
+                                                    float const depth )
+    {
+        float const clamped = depth < 0.0f ? 0.0f : ( depth > 1.0f ? 1.0f : depth );
+        sort_key const bucket = sort_key( clamped * float( depth_buckets ) + 0.5f );
+        sort_key key = sort_key( layer & 0xF ) << 60;
+        if ( translucent ) {
+            key |= sort_key( 1 ) << 59;
+            key |= ( depth_buckets - bucket ) << 43;
+            key |= ( prog_ID & state_mask ) << 31;
+            key |= ( tex_ID & state_mask ) << 19;
+            key |= ( vao_ID & state_mask ) << 7;
+        } else {
+            key |= ( prog_ID & state_mask ) << 47;
+            key |= ( tex_ID & state_mask ) << 35;
+            key |= ( vao_ID & state_mask ) << 23;
+            key |= bucket << 7;
+        }
+        return key;
+    }
+    /* The texture's name, or 0 for a draw without one. */
+    GLuint  render_queue::texture_ID( draw const& item )
+    { return item.tex == 0 ? 0 : item.tex->tex_ID; }
+    /*
+     * Counts the times the program, texture or vertex buffer differs
+     * from the draw before, walking the sorted order or the order of
+     * submission. The first draw counts as a change of each it uses.
+     */
+    void    render_queue::count_changes( bool const sorted_order )
+    {
+        size_t programs = 0;
+        size_t textures = 0;
+        size_t arrays = 0;
+        draw const* last = 0;
+        for ( size_t i = 0; i < items.size(); ++i ) {
+            draw const& item = items[sorted_order ? order[i] : i];
+            if ( last == 0 or item.prgm != last->prgm ) { ++programs; }
+            if ( item.tex != 0 and ( last == 0 or item.tex != last->tex
+                                     or item.unit != last->unit ) ) {
+                ++textures;
+            }
+            if ( last == 0 or item.vbo != last->vbo ) { ++arrays; }
+            last = &item;
+        }
+        if ( sorted_order ) {
+            stats_v.program_changes = programs;
+            stats_v.texture_changes = textures;
+            stats_v.vertex_array_changes = arrays;
+        } else {
+            stats_v.unsorted_program_changes = programs;
+            stats_v.unsorted_texture_changes = textures;
+            stats_v.unsorted_vertex_array_changes = arrays;
+        }
+    }
+
+}
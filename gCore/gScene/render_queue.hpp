@@ -0,0 +1,246 @@
+#ifndef RENDER_QUEUE_HPP
+#define RENDER_QUEUE_HPP
+
+#include <stdexcept>
+#include <vector>
+
+#include "../gVideo/gl_core_3_3.hpp"
+#include "program.hpp"
+#include "texture.hpp"
+#include "vertex_buffer.hpp"
+
+namespace gfx {
+    /**
+     * \class gfx::render_queue render_queue.hpp "gCore/gScene/render_queue.hpp"
+     * \brief Collects a frame's draws, sorts them so draws sharing state
+     * run together, and submits them in that order.
+     *
+     * Every draw gets a 64 bit key. From the top bit down it holds:
+     *
+     * - the layer, four bits, so layer 0 is drawn first;
+     * - one bit set for translucent draws, which come after opaque ones;
+     * - for opaque draws, the program, texture and vertex array, twelve
+     *   bits each, then a sixteen bit depth bucket, nearest first;
+     * - for translucent draws, the depth bucket farthest first, then the
+     *   program, texture and vertex array, since blending needs the
+     *   depth order more than it needs fewer state changes.
+     *
+     * The state fields hold the low twelve bits of the OpenGL names. Two
+     * objects with the same low bits only sort less well together; each
+     * draw remembers its own objects, so nothing is drawn wrongly.
+     *
+     * \ref sort() "sort()" is a least significant digit radix sort over
+     * the keys a byte at a time, which skips any byte every key shares.
+     * It is stable, so equal keys keep the order they were submitted in.
+     * \ref execute() "execute()" then uses programs, binds textures and
+     * aligns vertex buffers only when they differ from the last draw's.
+     */
+    class render_queue {
+    public:
+        typedef unsigned long long  sort_key;
+
+        /**
+         * \brief State changes counted by the last \ref sort() "sort()",
+         * in sorted order and in the order the draws were submitted.
+         */
+        struct frame_stats {
+            size_t          draws;
+            size_t          program_changes;
+            size_t          texture_changes;
+            size_t          vertex_array_changes;
+            size_t          unsorted_program_changes;
+            size_t          unsorted_texture_changes;
+            size_t          unsorted_vertex_array_changes;
+        };
+
+        /**
+         * \class gfx::render_queue::draw
+         * \brief Describes one draw for a \ref gfx::render_queue
+         * "render_queue".
+         */
+        class draw {
+        public:
+                            draw();
+            draw&           layer( unsigned int const n );
+            draw&           translucent( bool const on = true );
+            draw&           depth( float const d );
+            draw&           use( program& prgm );
+            draw&           bind( texture_2D const& tex,
+                                  GLuint const unit = 0 );
+            draw&           geometry( vertex_buffer& vbo );
+            draw&           arrays( GLenum const mode,
+                                    GLint const first,
+                                    GLsizei const count );
+            draw&           elements( GLenum const mode,
+                                      GLsizei const count,
+                                      GLenum const index_type,
+                                      GLsizeiptr const offset );
+        private:
+            friend          class render_queue;
+            program*        prgm;
+            texture_2D const*   tex;
+            GLuint          unit;
+            vertex_buffer*  vbo;
+            GLenum          mode;
+            GLint           first;
+            GLsizei         count;
+            GLenum          index_type;
+            GLsizeiptr      offset;
+            bool            indexed;
+            unsigned int    layer_v;
+            bool            translucent_v;
+            float           depth_v;
+        };
+
+                            render_queue();
+        void                submit( draw const& item );
+        void                sort();
+        void                execute();
+        void                clear();
+        size_t              size() const;
+        sort_key            key( size_t const n ) const;
+        frame_stats const&  stats() const;
+        static sort_key     make_key( unsigned int const layer,
+                                      bool const translucent,
+                                      GLuint const prog_ID,
+                                      GLuint const tex_ID,
+                                      GLuint const vao_ID,
+                                      float const depth );
+    private:
+        static GLuint       texture_ID( draw const& item );
+        void                count_changes( bool const sorted_order );
+
+        std::vector<draw>       items;
+        /* The keys and the draws they belong to, in the current order. */
+        std::vector<sort_key>   keys;
+        std::vector<size_t>     order;
+        std::vector<sort_key>   key_scratch;
+        std::vector<size_t>     order_scratch;
+        bool                    sorted;
+        frame_stats             stats_v;
+    };
+    /**
+     * \brief Construct a draw with nothing to draw yet.
+     *
+     * A draw is opaque, in layer 0 and at depth 0 until told otherwise.
+     * It needs a program, geometry and either
+     * \ref arrays() "arrays()" or \ref elements() "elements()" before it
+     * can be submitted; the texture is optional.
+     */
+    inline render_queue::draw::draw() : prgm ( 0 ),
+                                        tex ( 0 ),
+                                        unit ( 0 ),
+                                        vbo ( 0 ),
+                                        mode ( gl::TRIANGLES ),
+                                        first ( 0 ),
+                                        count ( 0 ),
+                                        index_type ( gl::UNSIGNED_INT ),
+                                        offset ( 0 ),
+                                        indexed ( false ),
+                                        layer_v ( 0 ),
+                                        translucent_v ( false ),
+                                        depth_v ( 0.0f ) {}
+    /**
+     * \brief Set the layer of the draw; lower layers are drawn first.
+     * \param n The layer, from 0 to 15
+     * \return This draw
+     */
+    inline render_queue::draw&  render_queue::draw::layer( unsigned int const n )
+    {
+        if ( n > 15 ) {
+            throw std::invalid_argument( "Render queue layers run from 0 to 15." );
+        }
+        layer_v = n;
+        return *this;
+    }
+    /**
+     * \brief Set whether the draw blends with what is behind it.
+     * \param on Whether the draw is translucent
+     * \return This draw
+     */
+    inline render_queue::draw&  render_queue::draw::translucent( bool const on )
+    { translucent_v = on; return *this; }
+    /**
+     * \brief Set how far away the draw is.
+     * \param d The depth, from 0 at the near plane to 1 at the far plane;
+     * anything outside is clamped
+     * \return This draw
+     */
+    inline render_queue::draw&  render_queue::draw::depth( float const d )
+    { depth_v = d; return *this; }
+    /**
+     * \brief Set the program to draw with.
+     * \param prgm The program
+     * \return This draw
+     */
+    inline render_queue::draw&  render_queue::draw::use( program& prgm )
+    { this->prgm = &prgm; return *this; }
+    /**
+     * \brief Set the texture to draw with.
+     * \param tex The texture
+     * \param unit The texture unit to bind it to
+     * \return This draw
+     */
+    inline render_queue::draw&  render_queue::draw::bind( texture_2D const& tex,
+                                                          GLuint const unit )
+    { this->tex = &tex; this->unit = unit; return *this; }
+    /**
+     * \brief Set the vertex buffer to draw from.
+     * \param vbo The vertex buffer
+     * \return This draw
+     */
+    inline render_queue::draw&  render_queue::draw::geometry( vertex_buffer& vbo )
+    { this->vbo = &vbo; return *this; }
+    /**
+     * \brief Draw vertices in order, as DrawArrays() does.
+     * \param mode The kind of primitive
+     * \param first The first vertex
+     * \param count The number of vertices
+     * \return This draw
+     */
+    inline render_queue::draw&  render_queue::draw::arrays( GLenum const mode,
+                                                            GLint const first,
+                                                            GLsizei const count )
+    {
+        this->mode = mode;
+        this->first = first;
+        this->count = count;
+        indexed = false;
+        return *this;
+    }
+    /**
+     * \brief Draw with the vertex array's element array buffer, as
+     * DrawElements() does.
+     * \param mode The kind of primitive
+     * \param count The number of indices
+     * \param index_type The type of the indices
+     * \param offset The byte offset of the first index
+     * \return This draw
+     */
+    inline render_queue::draw&  render_queue::draw::elements( GLenum const mode,
+                                                              GLsizei const count,
+                                                              GLenum const index_type,
+                                                              GLsizeiptr const offset )
+    {
+        this->mode = mode;
+        this->count = count;
+        this->index_type = index_type;
+        this->offset = offset;
+        indexed = true;
+        return *this;
+    }
+    /**
+     * \brief Return the number of draws submitted since the last
+     * \ref clear() "clear()".
+     */
+    inline size_t   render_queue::size() const
+    { return items.size(); }
+    /**
+     * \brief Return the state changes counted by the last
+     * \ref sort() "sort()".
+     */
+    inline render_queue::frame_stats const&     render_queue::stats() const
+    { return stats_v; }
+}
+
+#endif
@@ -0,0 +1,145 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "../gVideo/video.hpp"
+#include "../gMath/datatype.hpp"
+#include "texture.hpp"
+#include "vertex_buffer.hpp"
+#include "program.hpp"
+#include "gl_state.hpp"
+#include "texture_units.hpp"
+#include "render_queue.hpp"
+
+using namespace gfx;
+
+/*
+ * Queues a frame of draws spread over a few programs, textures and vertex
+ * buffers in random order, and compares the radix sort with
+ * std::stable_sort on the same keys, then submitting the frame sorted
+ * with submitting it in the order it was queued. Runs against the null OpenGL backend, so the
+ * submission times are the CPU cost of the scene classes alone.
+ *
+ * Usage: render_queue_benchmark [draws] [frames]
+ */
+namespace {
+    typedef std::chrono::high_resolution_clock  bench_clock;
+
+    double  since( bench_clock::time_point const start )
+    {
+        return std::chrono::duration<double, std::milli>( bench_clock::now() - start ).count();
+    }
+}
+
+int main( int argc, char** argv )
+{
+    size_t draws = ( argc > 1 ) ? std::strtoul( argv[1], 0, 10 ) : 20000;
+    size_t frames = ( argc > 2 ) ? std::strtoul( argv[2], 0, 10 ) : 20;
+    size_t const programs = 4;
+    size_t const textures = 16;
+    size_t const buffers = 32;
+    if ( frames == 0 ) { frames = 1; }
+
+    gl_backend::use_null();
+    video_system::get().initialize( video_system::settings().ver( 3, 3 ) );
+    context bench_cntx ( ( context::settings() ) );
+    gl_state& state = gl_state::current();
+    state.checking( false );
+
+    std::vector<program*> prgms;
+    for ( size_t i = 0; i < programs; ++i ) {
+        prgms.push_back( new program( program::settings()
+                                      .vertex_path( "./shader/testVertCam.glsl" )
+                                      .fragment_path( "./shader/testFragCam.glsl" ) ) );
+        prgms.back()->compile();
+        prgms.back()->link();
+    }
+    std::vector<texture_2D*> txtrs;
+    for ( size_t i = 0; i < textures; ++i ) {
+        txtrs.push_back( new texture_2D( texture_2D::settings()
+                                         .dimensions( 16u, 16u )
+                                         .unsigned_norm_3( eight_bit ) ) );
+    }
+    std::vector<vertex_buffer*> vbos;
+    for ( size_t i = 0; i < buffers; ++i ) {
+        vbos.push_back( new vertex_buffer( vertex_buffer::settings()
+                                           .blocks( 64 ) ) );
+        vbos.back()->block_format( block_spec()
+                                   .attribute( type<vec3>() ) );
+        vbos.back()->upload_data();
+    }
+
+    std::srand( 3 );
+    std::vector<render_queue::draw> frame;
+    std::vector<size_t> picks;
+    for ( size_t i = 0; i < draws; ++i ) {
+        picks.push_back( std::rand() % programs );
+        picks.push_back( std::rand() % textures );
+        picks.push_back( std::rand() % buffers );
+        frame.push_back( render_queue::draw()
+                         .use( *prgms[picks[i * 3]] )
+                         .bind( *txtrs[picks[i * 3 + 1]] )
+                         .geometry( *vbos[picks[i * 3 + 2]] )
+                         .translucent( std::rand() % 8 == 0 )
+                         .depth( float( std::rand() % 1000 ) / 1000.0f )
+                         .arrays( gl::TRIANGLES, 0, 64 ) );
+    }
+    texture_units& units = texture_units::current();
+
+    render_queue queue;
+    double radix_ms = 0.0;
+    double std_ms = 0.0;
+    double sorted_ms = 0.0;
+    double unsorted_ms = 0.0;
+    std::vector<render_queue::sort_key> keys;
+    for ( size_t f = 0; f < frames; ++f ) {
+        queue.clear();
+        keys.clear();
+        for ( size_t i = 0; i < draws; ++i ) {
+            queue.submit( frame[i] );
+            keys.push_back( queue.key( i ) );
+        }
+        bench_clock::time_point start = bench_clock::now();
+        queue.sort();
+        radix_ms += since( start );
+        start = bench_clock::now();
+        std::stable_sort( keys.begin(), keys.end() );
+        std_ms += since( start );
+
+        state.begin_frame();
+        start = bench_clock::now();
+        queue.execute();
+        sorted_ms += since( start );
+
+        // The same frame drawn in the order it was queued
+        state.begin_frame();
+        start = bench_clock::now();
+        for ( size_t i = 0; i < draws; ++i ) {
+            prgms[picks[i * 3]]->use();
+            units.bind( 0, *txtrs[picks[i * 3 + 1]] );
+            vbos[picks[i * 3 + 2]]->align();
+            gl::DrawArrays( gl::TRIANGLES, 0, 64 );
+        }
+        unsorted_ms += since( start );
+    }
+
+    render_queue::frame_stats const& stats = queue.stats();
+    std::cout << draws << " draws, " << frames << " frames\n"
+              << "radix sort:         " << radix_ms / frames << " ms/frame\n"
+              << "std::stable_sort:   " << std_ms / frames << " ms/frame\n"
+              << "submit sorted:      " << sorted_ms / frames << " ms/frame\n"
+              << "submit as queued:   " << unsorted_ms / frames << " ms/frame\n"
+              << "program changes:    " << stats.program_changes << " sorted, "
+              << stats.unsorted_program_changes << " as queued\n"
+              << "texture changes:    " << stats.texture_changes << " sorted, "
+              << stats.unsorted_texture_changes << " as queued\n"
+              << "vertex arrays:      " << stats.vertex_array_changes << " sorted, "
+              << stats.unsorted_vertex_array_changes << " as queued\n";
+
+    for ( size_t i = 0; i < vbos.size(); ++i ) { delete vbos[i]; }
+    for ( size_t i = 0; i < txtrs.size(); ++i ) { delete txtrs[i]; }
+    for ( size_t i = 0; i < prgms.size(); ++i ) { delete prgms[i]; }
+    return 0;
+}
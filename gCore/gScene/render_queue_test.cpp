@@ -0,0 +1,160 @@
+#include <stdexcept>
+#include <vector>
+
+#include "../gVideo/video.hpp"
+#include "texture.hpp"
+#include "vertex_buffer.hpp"
+#include "program.hpp"
+#include "gl_state.hpp"
+#include "render_queue.hpp"
+#include "../../UnitTest++_src/UnitTest++.h"
+
+using namespace gfx;
+
+SUITE( RenderQueueTests )
+{
+    TEST( RenderQueueKeyOrder )
+    {
+        typedef render_queue::sort_key key;
+        // Layers come first, then opaque before translucent
+        key const back = render_queue::make_key( 0, true, 9, 9, 9, 0.0f );
+        key const front = render_queue::make_key( 1, false, 1, 1, 1, 0.0f );
+        CHECK( back < front );
+        CHECK( render_queue::make_key( 0, false, 9, 9, 9, 1.0f ) < back );
+
+        // Opaque draws group by program, then texture, then vertex array,
+        // and only then go nearest first
+        CHECK( render_queue::make_key( 0, false, 1, 9, 9, 1.0f )
+               < render_queue::make_key( 0, false, 2, 1, 1, 0.0f ) );
+        CHECK( render_queue::make_key( 0, false, 1, 1, 9, 1.0f )
+               < render_queue::make_key( 0, false, 1, 2, 1, 0.0f ) );
+        CHECK( render_queue::make_key( 0, false, 1, 1, 1, 0.25f )
+               < render_queue::make_key( 0, false, 1, 1, 1, 0.5f ) );
+
+        // Translucent draws go farthest first whatever their state
+        CHECK( render_queue::make_key( 0, true, 9, 9, 9, 0.75f )
+               < render_queue::make_key( 0, true, 1, 1, 1, 0.5f ) );
+        CHECK_EQUAL( render_queue::make_key( 0, true, 1, 1, 1, -3.0f ),
+                     render_queue::make_key( 0, true, 1, 1, 1, 0.0f ) );
+        CHECK_THROW( render_queue::draw().layer( 16 ), std::invalid_argument );
+    }
+
+    TEST( RenderQueueSortsAndCounts )
+    {
+        gl_backend::use_null();
+        context test_cntx ( ( context::settings() ) );
+        gl_state::current().checking( false );
+
+        program first_prgm ( program::settings()
+                             .vertex_path( "./shader/testVertCam.glsl" )
+                             .fragment_path( "./shader/testFragCam.glsl" ) );
+        first_prgm.compile();
+        first_prgm.link();
+        program second_prgm ( program::settings()
+                              .vertex_path( "./shader/testVertCam.glsl" )
+                              .fragment_path( "./shader/testFragCam.glsl" ) );
+        second_prgm.compile();
+        second_prgm.link();
+        program* prgms[2] = { &first_prgm, &second_prgm };
+
+        texture_2D first_txtr ( texture_2D::settings()
+                                .dimensions( 16u, 16u )
+                                .unsigned_norm_3( eight_bit ) );
+        texture_2D second_txtr ( texture_2D::settings()
+                                 .dimensions( 16u, 16u )
+                                 .unsigned_norm_3( eight_bit ) );
+        texture_2D* txtrs[2] = { &first_txtr, &second_txtr };
+
+        std::vector<vertex_buffer*> vbos;
+        for ( size_t i = 0; i < 3; ++i ) {
+            vbos.push_back( new vertex_buffer( vertex_buffer::settings()
+                                               .blocks( 3 ) ) );
+            vbos.back()->block_format( block_spec()
+                                       .attribute( type<vec3>() ) );
+            vbos.back()->upload_data();
+        }
+
+        render_queue queue;
+        CHECK_THROW( queue.submit( render_queue::draw() ), std::invalid_argument );
+        // Interleaved so that every draw differs from the one before
+        for ( size_t i = 0; i < 60; ++i ) {
+            queue.submit( render_queue::draw()
+                          .use( *prgms[i % 2] )
+                          .bind( *txtrs[( i / 2 ) % 2] )
+                          .geometry( *vbos[i % 3] )
+                          .translucent( i % 10 == 9 )
+                          .depth( float( i % 7 ) / 7.0f )
+                          .arrays( gl::TRIANGLES, 0, 3 ) );
+        }
+        CHECK_EQUAL( 60u, queue.size() );
+        queue.sort();
+        for ( size_t i = 1; i < queue.size(); ++i ) {
+            CHECK( queue.key( i - 1 ) <= queue.key( i ) );
+        }
+        CHECK_THROW( queue.key( queue.size() ), std::invalid_argument );
+
+        render_queue::frame_stats const& stats = queue.stats();
+        CHECK_EQUAL( 60u, stats.draws );
+        CHECK_EQUAL( 60u, stats.unsorted_program_changes );
+        CHECK_EQUAL( 60u, stats.unsorted_vertex_array_changes );
+        CHECK( stats.program_changes < stats.unsorted_program_changes / 4 );
+        CHECK( stats.texture_changes < stats.unsorted_texture_changes / 4 );
+        CHECK( stats.vertex_array_changes < stats.unsorted_vertex_array_changes / 2 );
+
+        gl_backend::recording( true );
+        gl_backend::reset_stats();
+        queue.execute();
+        CHECK_EQUAL( 60u, gl_backend::stats( "DrawArrays" ).calls );
+        CHECK_EQUAL( stats.program_changes, gl_backend::stats( "UseProgram" ).calls );
+        gl_backend::recording( false );
+
+        queue.clear();
+        CHECK_EQUAL( 0u, queue.size() );
+        for ( size_t i = 0; i < vbos.size(); ++i ) { delete vbos[i]; }
+    }
+
+    TEST( RenderQueueLayers )
+    {
+        gl_backend::use_null();
+        context test_cntx ( ( context::settings() ) );
+        gl_state::current().checking( false );
+
+        program test_prgm ( program::settings()
+                            .vertex_path( "./shader/testVertCam.glsl" )
+                            .fragment_path( "./shader/testFragCam.glsl" ) );
+        test_prgm.compile();
+        test_prgm.link();
+        vertex_buffer test_vbo ( vertex_buffer::settings()
+                                 .blocks( 3 ) );
+        test_vbo.block_format( block_spec()
+                               .attribute( type<vec3>() ) );
+        test_vbo.upload_data();
+
+        render_queue queue;
+        for ( GLint i = 0; i < 20; ++i ) {
+            queue.submit( render_queue::draw()
+                          .use( test_prgm )
+                          .geometry( test_vbo )
+                          .layer( i % 2 == 0 ? 1 : 0 )
+                          .arrays( gl::POINTS, i, 1 ) );
+        }
+        queue.sort();
+        CHECK_EQUAL( queue.key( 0 ), queue.key( 9 ) );
+        CHECK( queue.key( 9 ) < queue.key( 10 ) );
+
+        gl_backend::recording( true );
+        gl_backend::reset_stats();
+        queue.execute();
+        CHECK_EQUAL( 20u, gl_backend::stats( "DrawArrays" ).calls );
+        CHECK_EQUAL( 1u, gl_backend::stats( "UseProgram" ).calls );
+        CHECK_EQUAL( 1u, queue.stats().program_changes );
+        CHECK_EQUAL( 1u, queue.stats().vertex_array_changes );
+        gl_backend::recording( false );
+    }
+}
+
+int main( int argc, char** argv )
+{
+    video_system::get().initialize( video_system::settings().ver( 3, 3 ) );
+    return UnitTest::RunAllTests();
+}
@@ -0,0 +1,465 @@
+#include <algorithm>
+#include <thread>
+
+#include "scene_graph.hpp"
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+namespace gfx {
+
+    namespace {
+        size_t const    no_slot = ~size_t( 0 );
+
+        /*
+         * Orders slots by the tree they belong to, then by depth, so
+         * parents always come first and every tree is one run.
+         */
+        struct tree_order {
+            std::vector<size_t> const&  roots;
+            std::vector<size_t> const&  depths;
+
+            bool    operator()( size_t const lhs, size_t const rhs ) const
+            {
+                if ( roots[lhs] != roots[rhs] ) {
+                    return roots[lhs] < roots[rhs];
+                }
+                if ( depths[lhs] != depths[rhs] ) {
+                    return depths[lhs] < depths[rhs];
+                }
+                return lhs < rhs;
+            }
+        };
+
+        /*
+         * out = lhs * rhs for column major matrices. Each column of the
+         * result is the columns of lhs weighted by a column of rhs, which
+         * is four multiplies and three adds on whole SSE registers.
+         */
+        template< typename M >
+        void    multiply( M const& lhs, M const& rhs, M& out )
+        {
+#ifdef __SSE__
+            __m128 const col0 = _mm_loadu_ps( lhs.c );
+            __m128 const col1 = _mm_loadu_ps( lhs.c + 4 );
+            __m128 const col2 = _mm_loadu_ps( lhs.c + 8 );
+            __m128 const col3 = _mm_loadu_ps( lhs.c + 12 );
+            for ( size_t j = 0; j < 16; j += 4 ) {
+                __m128 sum = _mm_mul_ps( col0, _mm_set1_ps( rhs.c[j] ) );
+                sum = _mm_add_ps( sum, _mm_mul_ps( col1, _mm_set1_ps( rhs.c[j + 1] ) ) );
+                sum = _mm_add_ps( sum, _mm_mul_ps( col2, _mm_set1_ps( rhs.c[j + 2] ) ) );
+                sum = _mm_add_ps( sum, _mm_mul_ps( col3, _mm_set1_ps( rhs.c[j + 3] ) ) );
+                _mm_storeu_ps( out.c + j, sum );
+            }
+#else
+            for ( size_t j = 0; j < 16; j += 4 ) {
+                for ( size_t r = 0; r < 4; ++r ) {
+                    out.c[j + r] = lhs.c[r] * rhs.c[j]
+                                 + lhs.c[r + 4] * rhs.c[j + 1]
+                                 + lhs.c[r + 8] * rhs.c[j + 2]
+                                 + lhs.c[r + 12] * rhs.c[j + 3];
+                }
+            }
+#endif
+        }
+    }
+
+    scene_graph::node const scene_graph::no_node;
+
+    /**
+     * \brief Construct a new, empty scene graph.
+     * \param set The settings for the graph
+     */
+    scene_graph::scene_graph( settings const& set ) : live ( 0 ),
+                                                      threads_v ( set.threads_v ),
+                                                      updated_v ( 0 ),
+                                                      layout_changed ( false )
+    {
+        locals.reserve( set.reserve_v );
+        worlds.reserve( set.reserve_v );
+        local_mtrxs.reserve( set.reserve_v );
+        ids.reserve( set.reserve_v );
+        parents.reserve( set.reserve_v );
+        parent_slots.reserve( set.reserve_v );
+        dirty.reserve( set.reserve_v );
+        changed_v.reserve( set.reserve_v );
+        dead.reserve( set.reserve_v );
+        slots.reserve( set.reserve_v );
+        tree_starts.push_back( 0 );
+    }
+    /**
+     * \brief Add a node to the graph.
+     *
+     * The new node's world matrix is computed at the next
+     * \ref update() "update()".
+     * \param set The local transform of the node
+     * \param parent The parent of the node, or no_node for a new root
+     * \return The handle of the new node
+     * @exception std::invalid_argument If the parent is not in the graph,
+     * a standard invalid argument exception is thrown.
+     */
+    scene_graph::node   scene_graph::add( orientable::settings const& set,
+                                          node const parent )
+    {
+        size_t const parent_slot = parent == no_node ? no_slot : slot( parent );
+        node id = slots.size();
+        if ( not free_ids.empty() ) {
+            id = free_ids.back();
+            free_ids.pop_back();
+            slots[id] = locals.size();
+        } else {
+            slots.push_back( locals.size() );
+        }
+        matrix identity = { { 1.0f, 0.0f, 0.0f, 0.0f,
+                              0.0f, 1.0f, 0.0f, 0.0f,
+                              0.0f, 0.0f, 1.0f, 0.0f,
+                              0.0f, 0.0f, 0.0f, 1.0f } };
+        locals.push_back( orientable( set ) );
+        worlds.push_back( identity );
+        local_mtrxs.push_back( identity );
+        ids.push_back( id );
+        parents.push_back( parent );
+        parent_slots.push_back( parent_slot );
+        dirty.push_back( 1 );
+        changed_v.push_back( 0 );
+        dead.push_back( 0 );
+        ++live;
+        layout_changed = true;
+        return id;
+    }
+    /**
+     * \brief Remove a node and everything below it from the graph.
+     *
+     * The handles of the removed nodes stop being valid at once.
+     * \param n The node to remove
+     * @exception std::invalid_argument If the node is not in the graph, a
+     * standard invalid argument exception is thrown.
+     */
+    void    scene_graph::remove( node const n )
+    {
+        dead[slot( n )] = 1;
+        resolve();
+        for ( size_t s = 0; s < ids.size(); ++s ) {
+            if ( dead[s] and slots[ids[s]] == s ) {
+                slots[ids[s]] = no_slot;
+                free_ids.push_back( ids[s] );
+                --live;
+            }
+        }
+        layout_changed = true;
+    }
+    /**
+     * \brief Move a node, with everything below it, under a new parent.
+     *
+     * The node keeps its local transform, so its world matrix changes.
+     * \param child The node to move
+     * \param new_parent The new parent, or no_node to make the child a root
+     * @exception std::invalid_argument If either node is not in the graph,
+     * or the new parent is below the child, a standard invalid argument
+     * exception is thrown.
+     */
+    void    scene_graph::parent( node const child, node const new_parent )
+    {
+        size_t const child_slot = slot( child );
+        for ( node up = new_parent; up != no_node; up = parents[slot( up )] ) {
+            if ( up == child ) {
+                throw std::invalid_argument( "A scene graph node cannot be moved below itself." );
+            }
+        }
+        parents[child_slot] = new_parent;
+        dirty[child_slot] = 1;
+        layout_changed = true;
+    }
+    /**
+     * \brief Return the parent of a node.
+     * \param n The node
+     * \return The parent, or no_node if the node is a root
+     * @exception std::invalid_argument If the node is not in the graph, a
+     * standard invalid argument exception is thrown.
+     */
+    scene_graph::node   scene_graph::parent( node const n ) const
+    { return parents[slot( n )]; }
+    /**
+     * \brief Return whether a handle names a node in the graph.
+     * \param n The handle
+     */
+    bool    scene_graph::contains( node const n ) const
+    { return n < slots.size() and slots[n] != no_slot; }
+    /**
+     * \brief Return the local transform of a node for changing, and mark
+     * the node dirty.
+     * \param n The node
+     * \return The node's local transform
+     * @exception std::invalid_argument If the node is not in the graph, a
+     * standard invalid argument exception is thrown.
+     */
+    orientable&     scene_graph::local( node const n )
+    {
+        size_t const s = slot( n );
+        dirty[s] = 1;
+        return locals[s];
+    }
+    /**
+     * \brief Return the local transform of a node.
+     * \param n The node
+     * \return The node's local transform
+     * @exception std::invalid_argument If the node is not in the graph, a
+     * standard invalid argument exception is thrown.
+     */
+    orientable const&   scene_graph::local( node const n ) const
+    { return locals[slot( n )]; }
+    /**
+     * \brief Bring the world matrix of every dirty node, and of everything
+     * below it, up to date.
+     *
+     * Nodes whose world matrix changed are reported by
+     * \ref changed() "changed()" until the next update.
+     */
+    void    scene_graph::update()
+    {
+        if ( layout_changed ) {
+            sort();
+            layout_changed = false;
+        }
+        size_t const trees = tree_starts.size() - 1;
+        if ( threads_v <= 1 or trees < 2 ) {
+            updated_v = update_range( 0, locals.size() );
+            return;
+        }
+
+        // Share whole trees out so that each thread gets about as many
+        // nodes as the others
+        size_t const chunks = std::min( threads_v, trees );
+        size_t const target = ( locals.size() + chunks - 1 ) / chunks;
+        std::vector<size_t> bounds ( 1, 0 );
+        for ( size_t t = 1; t < trees and bounds.size() < chunks; ++t ) {
+            if ( tree_starts[t] - bounds.back() >= target ) {
+                bounds.push_back( tree_starts[t] );
+            }
+        }
+        bounds.push_back( locals.size() );
+
+        std::vector<size_t> counts ( bounds.size() - 1, 0 );
+        std::vector<std::thread> workers;
+        for ( size_t c = 1; c < counts.size(); ++c ) {
+            workers.push_back( std::thread( [this, &bounds, &counts, c]() {
+                counts[c] = update_range( bounds[c], bounds[c + 1] );
+            } ) );
+        }
+        counts[0] = update_range( bounds[0], bounds[1] );
+        for ( size_t w = 0; w < workers.size(); ++w ) {
+            workers[w].join();
+        }
+        updated_v = 0;
+        for ( size_t c = 0; c < counts.size(); ++c ) {
+            updated_v += counts[c];
+        }
+    }
+    /**
+     * \brief Return whether the last \ref update() "update()" changed a
+     * node's world matrix.
+     * \param n The node
+     * @exception std::invalid_argument If the node is not in the graph, a
+     * standard invalid argument exception is thrown.
+     */
+    bool    scene_graph::changed( node const n ) const
+    { return changed_v[slot( n )] != 0; }
+    /**
+     * \brief Return the world matrix of a node as sixteen column major
+     * floats, ready for uploading.
+     *
+     * The pointer is good until nodes are next added, removed or
+     * reparented.
+     * \param n The node
+     * @exception std::invalid_argument If the node is not in the graph, a
+     * standard invalid argument exception is thrown.
+     */
+    float const*    scene_graph::world_data( node const n ) const
+    { return worlds[slot( n )].c; }
+    /**
+     * \brief Return the world matrix of a node.
+     * \param n The node
+     * @exception std::invalid_argument If the node is not in the graph, a
+     * standard invalid argument exception is thrown.
+     */
+    mat4    scene_graph::world( node const n ) const
+    {
+        float const* c = world_data( n );
+        return mat4( c[0], c[4], c[8],  c[12],
+                     c[1], c[5], c[9],  c[13],
+                     c[2], c[6], c[10], c[14],
+                     c[3], c[7], c[11], c[15] );
+    }
+
+    size_t  scene_graph::slot( node const n ) const
+    {
+        if ( not contains( n ) ) {
+            throw std::invalid_argument( "Scene graph node is not in the graph." );
+        }
+        return slots[n];
+    }
+    /*
+     * Work out every slot's depth and tree, and mark the descendants of
+     * removed nodes as removed too. Each slot is visited once: the walk up
+     * from a slot stops at the first one already worked out.
+     */
+    void    scene_graph::resolve()
+    {
+        size_t const count = locals.size();
+        depths.assign( count, 0 );
+        roots.assign( count, 0 );
+        std::vector<unsigned char> done ( count, 0 );
+        std::vector<size_t> chain;
+        for ( size_t s = 0; s < count; ++s ) {
+            chain.clear();
+            for ( size_t up = s; not done[up]; ) {
+                chain.push_back( up );
+                if ( dead[up] or parents[up] == no_node ) {
+                    break;
+                }
+                up = slots[parents[up]];
+            }
+            while ( not chain.empty() ) {
+                size_t const c = chain.back();
+                chain.pop_back();
+                if ( dead[c] ) {
+                    // Nothing below a removed node needs a depth
+                } else if ( parents[c] == no_node ) {
+                    roots[c] = c;
+                } else {
+                    size_t const up = slots[parents[c]];
+                    dead[c] = dead[up];
+                    depths[c] = depths[up] + 1;
+                    roots[c] = roots[up];
+                }
+                done[c] = 1;
+            }
+        }
+    }
+    /*
+     * Drop removed slots and put the rest in update order.
+     */
+    void    scene_graph::sort()
+    {
+        resolve();
+        std::vector<size_t> order;
+        order.reserve( live );
+        for ( size_t s = 0; s < locals.size(); ++s ) {
+            if ( not dead[s] ) {
+                order.push_back( s );
+            }
+        }
+        tree_order const by_tree = { roots, depths };
+        std::sort( order.begin(), order.end(), by_tree );
+
+        std::vector<orientable> new_locals;
+        std::vector<matrix> new_worlds;
+        std::vector<matrix> new_local_mtrxs;
+        std::vector<node> new_ids;
+        std::vector<node> new_parents;
+        std::vector<unsigned char> new_dirty;
+        std::vector<unsigned char> new_changed;
+        new_locals.reserve( locals.capacity() );
+        new_worlds.reserve( locals.capacity() );
+        new_local_mtrxs.reserve( locals.capacity() );
+        new_ids.reserve( locals.capacity() );
+        new_parents.reserve( locals.capacity() );
+        new_dirty.reserve( locals.capacity() );
+        new_changed.reserve( locals.capacity() );
+        for ( size_t i = 0; i < order.size(); ++i ) {
+            size_t const s = order[i];
+            new_locals.push_back( locals[s] );
+            new_worlds.push_back( worlds[s] );
+            new_local_mtrxs.push_back( local_mtrxs[s] );
+            new_ids.push_back( ids[s] );
+            new_parents.push_back( parents[s] );
+            new_dirty.push_back( dirty[s] );
+            new_changed.push_back( changed_v[s] );
+            slots[ids[s]] = i;
+        }
+        locals.swap( new_locals );
+        worlds.swap( new_worlds );
+        local_mtrxs.swap( new_local_mtrxs );
+        ids.swap( new_ids );
+        parents.swap( new_parents );
+        dirty.swap( new_dirty );
+        changed_v.swap( new_changed );
+        dead.assign( order.size(), 0 );
+
+        parent_slots.resize( order.size() );
+        tree_starts.clear();
+        for ( size_t i = 0; i < order.size(); ++i ) {
+            if ( parents[i] == no_node ) {
+                parent_slots[i] = no_slot;
+                tree_starts.push_back( i );
+            } else {
+                parent_slots[i] = slots[parents[i]];
+            }
+        }
+        tree_starts.push_back( order.size() );
+    }
+    /*
+     * The update pass over one run of whole trees. The local matrices of
+     * the changed nodes are built first, in one batch. Then a node's world
+     * matrix is recomputed if it was changed or its parent was just
+     * recomputed; parents come first, so one pass settles the run.
+     */
+    size_t  scene_graph::update_range( size_t const begin, size_t const end )
+    {
+        std::vector<size_t> changed_slots;
+        for ( size_t i = begin; i < end; ++i ) {
+            if ( dirty[i] != 0 ) {
+                changed_slots.push_back( i );
+            }
+        }
+        size_t const moved_count = changed_slots.size();
+        // With nothing changed there is no batch to build, but the pass
+        // below still has to clear the changed flags of the last update
+        if ( moved_count != 0 ) {
+            std::vector<float> components ( moved_count * 10 );
+            orientable::streams in;
+            for ( size_t s = 0; s < 3; ++s ) {
+                in.position[s] = &components[0] + s * moved_count;
+                in.scale[s] = &components[0] + ( 7 + s ) * moved_count;
+            }
+            for ( size_t s = 0; s < 4; ++s ) {
+                in.rotation[s] = &components[0] + ( 3 + s ) * moved_count;
+            }
+            for ( size_t n = 0; n < moved_count; ++n ) {
+                orientable const& source = locals[changed_slots[n]];
+                for ( size_t s = 0; s < 3; ++s ) {
+                    components[s * moved_count + n] = source.position()[s];
+                    components[( 7 + s ) * moved_count + n] = source.scale()[s];
+                }
+                for ( size_t s = 0; s < 4; ++s ) {
+                    components[( 3 + s ) * moved_count + n] = source.rotation()[s];
+                }
+            }
+            std::vector<matrix> composed ( moved_count );
+            orientable::compose( in, moved_count, composed[0].c );
+            for ( size_t n = 0; n < moved_count; ++n ) {
+                local_mtrxs[changed_slots[n]] = composed[n];
+            }
+        }
+
+        size_t count = 0;
+        for ( size_t i = begin; i < end; ++i ) {
+            size_t const up = parent_slots[i];
+            bool const moved = dirty[i] != 0 or
+                               ( up != no_slot and changed_v[up] != 0 );
+            changed_v[i] = moved ? 1 : 0;
+            if ( not moved ) {
+                continue;
+            }
+            dirty[i] = 0;
+            if ( up == no_slot ) {
+                worlds[i] = local_mtrxs[i];
+            } else {
+                multiply( worlds[up], local_mtrxs[i], worlds[i] );
+            }
+            ++count;
+        }
+        return count;
+    }
+}
@@ -0,0 +1,146 @@
+#ifndef SCENE_GRAPH_HPP
+#define SCENE_GRAPH_HPP
+
+#include <stdexcept>
+#include <vector>
+
+#include "../gMath/datatype.hpp"
+#include "orientable.hpp"
+
+namespace gfx {
+    /**
+     * \class gfx::scene_graph scene_graph.hpp "gCore/gScene/scene_graph.hpp"
+     * \brief A hierarchy of \ref gfx::orientable "orientable" transforms
+     * whose world matrices are brought up to date in one pass.
+     *
+     * Every node has a local transform relative to its parent; a node
+     * without a parent is a root. Nodes are named by handles that stay the
+     * same while the graph rearranges itself, and a removed node's handle
+     * may be handed out again later.
+     *
+     * Internally nodes sit in flat arrays ordered by their root and then by
+     * depth, so every parent comes before its children and every tree is a
+     * contiguous run. Changing a node through \ref local() "local()" marks
+     * it dirty, and \ref update() "update()" walks the arrays once,
+     * recomputing the world matrix of each dirty node and everything below
+     * it while skipping the rest. With more than one thread in the
+     * settings, whole trees are shared out between threads.
+     *
+     * Adding, removing and reparenting nodes only takes effect in the
+     * arrays at the next update, which then sorts them again.
+     */
+    class scene_graph {
+    public:
+        typedef size_t  node;
+        static node const   no_node = ~size_t( 0 );
+
+        /**
+         * \class gfx::scene_graph::settings
+         * \brief Used to configure a \ref gfx::scene_graph "scene graph".
+         */
+        class settings {
+        public:
+                            settings();
+            settings&       threads( size_t const count );
+            settings&       reserve( size_t const nodes );
+        private:
+            friend          class scene_graph;
+            size_t          threads_v;
+            size_t          reserve_v;
+        };
+
+                            scene_graph( settings const& set = settings() );
+        node                add( orientable::settings const& set = orientable::settings(),
+                                 node const parent = no_node );
+        void                remove( node const n );
+        void                parent( node const child, node const new_parent );
+        node                parent( node const n ) const;
+        bool                contains( node const n ) const;
+        size_t              size() const;
+        orientable&         local( node const n );
+        orientable const&   local( node const n ) const;
+        void                update();
+        size_t              updated() const;
+        bool                changed( node const n ) const;
+        float const*        world_data( node const n ) const;
+        mat4                world( node const n ) const;
+    private:
+        /* A column major matrix the update pass can work on directly. */
+        struct matrix {
+            float           c[16];
+        };
+
+        size_t              slot( node const n ) const;
+        void                resolve();
+        void                sort();
+        size_t              update_range( size_t const begin, size_t const end );
+
+        /* Indexed by slot, in update order once sorted. */
+        std::vector<orientable>     locals;
+        std::vector<matrix>         worlds;
+        std::vector<matrix>         local_mtrxs;
+        std::vector<node>           ids;
+        std::vector<node>           parents;
+        std::vector<size_t>         parent_slots;
+        std::vector<unsigned char>  dirty;
+        std::vector<unsigned char>  changed_v;
+        std::vector<unsigned char>  dead;
+        std::vector<size_t>         depths;
+        std::vector<size_t>         roots;
+        /* Where each tree starts, plus the end of the last one. */
+        std::vector<size_t>         tree_starts;
+        /* Indexed by node. */
+        std::vector<size_t>         slots;
+        std::vector<node>           free_ids;
+        size_t                      live;
+        size_t                      threads_v;
+        size_t                      updated_v;
+        bool                        layout_changed;
+    };
+    /**
+     * \brief Construct a new scene graph settings object with default
+     * settings.
+     *
+     * By default updates run on the calling thread alone and no room is
+     * reserved up front.
+     */
+    inline scene_graph::settings::settings() : threads_v ( 1 ),
+                                               reserve_v ( 0 ) {}
+    /**
+     * \brief Set how many threads \ref update() "update()" may use.
+     *
+     * The calling thread is one of them. Threads only help once there are
+     * many trees with plenty of moving nodes, since starting them costs
+     * tens of microseconds.
+     * \param count The number of threads; zero is taken as one
+     * \return This settings object
+     */
+    inline scene_graph::settings& scene_graph::settings::threads( size_t const count )
+    {
+        threads_v = count == 0 ? 1 : count;
+        return *this;
+    }
+    /**
+     * \brief Set how many nodes to make room for up front.
+     * \param nodes The number of nodes
+     * \return This settings object
+     */
+    inline scene_graph::settings& scene_graph::settings::reserve( size_t const nodes )
+    {
+        reserve_v = nodes;
+        return *this;
+    }
+    /**
+     * \brief Return the number of nodes in the graph.
+     */
+    inline size_t   scene_graph::size() const
+    { return live; }
+    /**
+     * \brief Return how many world matrices the last
+     * \ref update() "update()" recomputed.
+     */
+    inline size_t   scene_graph::updated() const
+    { return updated_v; }
+}
+
+#endif
@@ -0,0 +1,113 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "../gMath/datatype.hpp"
+#include "scene_graph.hpp"
+
+using namespace gfx;
+
+/*
+ * Measures scene_graph::update() on a large graph where a small share of
+ * the nodes move every frame. The graph is a forest of trees a hundred
+ * nodes each, four levels deep, which is roughly what a level full of
+ * articulated props looks like. The moving nodes are spread evenly so
+ * their subtrees don't overlap much. Afterwards it times building local
+ * matrices one orientable at a time against the batch path.
+ *
+ * Usage: scene_graph_benchmark [nodes] [percent moving] [frames] [threads]
+ */
+namespace {
+    typedef std::chrono::high_resolution_clock  bench_clock;
+}
+
+int main( int argc, char** argv )
+{
+    size_t nodes = ( argc > 1 ) ? std::strtoul( argv[1], 0, 10 ) : 100000;
+    double moving = ( argc > 2 ) ? std::strtod( argv[2], 0 ) : 1.0;
+    size_t frames = ( argc > 3 ) ? std::strtoul( argv[3], 0, 10 ) : 100;
+    size_t threads = ( argc > 4 ) ? std::strtoul( argv[4], 0, 10 ) : 1;
+
+    scene_graph graph ( scene_graph::settings()
+                        .threads( threads )
+                        .reserve( nodes ) );
+    std::vector<scene_graph::node> handles;
+    handles.reserve( nodes );
+    for ( size_t i = 0; i < nodes; ++i ) {
+        // Within each tree of a hundred, node k hangs off node k / 4
+        size_t const k = i % 100;
+        scene_graph::node up = k == 0 ? scene_graph::no_node
+                                      : handles[i - k + k / 4];
+        handles.push_back( graph.add( orientable::settings()
+                                      .position( vec3( float( k % 10 ), float( k / 10 ), 1.0f ) ),
+                                      up ) );
+    }
+
+    bench_clock::time_point start = bench_clock::now();
+    graph.update();
+    double first_ms = std::chrono::duration<double, std::milli>( bench_clock::now() - start ).count();
+
+    size_t const step = moving > 0.0 ? size_t( 100.0 / moving ) : nodes + 1;
+    double total_ms = 0.0;
+    size_t recomputed = 0;
+    for ( size_t frame = 0; frame < frames; ++frame ) {
+        for ( size_t i = frame % step; i < nodes; i += step ) {
+            graph.local( handles[i] ).move( vec3( 0.0f, 0.01f, 0.0f ) );
+        }
+        start = bench_clock::now();
+        graph.update();
+        total_ms += std::chrono::duration<double, std::milli>( bench_clock::now() - start ).count();
+        recomputed += graph.updated();
+    }
+
+    std::cout << nodes << " nodes, " << moving << "% moving, "
+              << frames << " frames, " << threads << " thread(s)\n"
+              << "first update (sort and every node): " << first_ms << " ms\n"
+              << "update with movers: " << total_ms / frames << " ms, "
+              << recomputed / ( frames == 0 ? 1 : frames ) << " world matrices per frame\n";
+
+    // The same transforms through each path; the sink keeps the work alive
+    size_t const objects = nodes < 10000 ? nodes : 10000;
+    std::vector<float> components ( objects * 10, 0.0f );
+    orientable::streams in;
+    for ( size_t s = 0; s < 3; ++s ) {
+        in.position[s] = &components[s * objects];
+        in.scale[s] = &components[( 7 + s ) * objects];
+    }
+    for ( size_t s = 0; s < 4; ++s ) {
+        in.rotation[s] = &components[( 3 + s ) * objects];
+    }
+    for ( size_t n = 0; n < objects; ++n ) {
+        components[n] = float( n );
+        components[6 * objects + n] = 1.0f;
+        components[7 * objects + n] = 1.0f;
+        components[8 * objects + n] = 1.0f;
+        components[9 * objects + n] = 1.0f;
+    }
+    std::vector<float> matrices ( objects * 16 );
+    float sink = 0.0f;
+
+    start = bench_clock::now();
+    for ( size_t frame = 0; frame < frames; ++frame ) {
+        for ( size_t n = 0; n < objects; ++n ) {
+            graph.local( handles[n] ).move( vec3( 0.0f, 0.0f, 0.001f ) );
+            sink += graph.local( handles[n] ).object_matrix()( 3, 2 );
+        }
+    }
+    double single_ns = std::chrono::duration<double, std::nano>( bench_clock::now() - start ).count();
+
+    start = bench_clock::now();
+    for ( size_t frame = 0; frame < frames; ++frame ) {
+        components[2 * objects] += 0.001f;
+        orientable::compose( in, objects, &matrices[0] );
+        sink += matrices[14];
+    }
+    double batch_ns = std::chrono::duration<double, std::nano>( bench_clock::now() - start ).count();
+
+    size_t const built = objects * ( frames == 0 ? 1 : frames );
+    std::cout << "orientable::object_matrix(): " << single_ns / built << " ns/object\n"
+              << "orientable::compose():       " << batch_ns / built << " ns/object\n"
+              << "(" << sink << ")\n";
+    return 0;
+}
@@ -0,0 +1,166 @@
+#include <stdexcept>
+#include <vector>
+
+#include "../../UnitTest++_src/UnitTest++.h"
+
+#include "../gMath/datatype.hpp"
+#include "scene_graph.hpp"
+
+using namespace gfx;
+
+SUITE( SceneGraphTests )
+{
+    TEST( ChildrenFollowParents )
+    {
+        scene_graph graph;
+        scene_graph::node parent = graph.add( orientable::settings()
+                                              .position( vec3( 1.0f, 0.0f, 0.0f ) )
+                                              .scale( vec3( 2.0f, 2.0f, 2.0f ) ) );
+        scene_graph::node child = graph.add( orientable::settings()
+                                             .position( vec3( 0.0f, 1.0f, 0.0f ) ),
+                                             parent );
+        graph.update();
+
+        CHECK_EQUAL( 2u, graph.updated() );
+        mat4 world = graph.world( child );
+        CHECK_CLOSE( 1.0f, world( 3, 0 ), 0.0001f );
+        CHECK_CLOSE( 2.0f, world( 3, 1 ), 0.0001f );
+        CHECK_CLOSE( 2.0f, world( 0, 0 ), 0.0001f );
+        CHECK( world == graph.world( parent ) * graph.local( child ).object_matrix() );
+
+        graph.local( parent ).move( vec3( 0.0f, 0.0f, 3.0f ) );
+        graph.update();
+        CHECK_EQUAL( 2u, graph.updated() );
+        CHECK_CLOSE( 3.0f, graph.world( child )( 3, 2 ), 0.0001f );
+    }
+
+    TEST( OnlyDirtySubtreesUpdate )
+    {
+        scene_graph graph;
+        scene_graph::node first = graph.add();
+        scene_graph::node second = graph.add();
+        scene_graph::node below = graph.add( orientable::settings(), second );
+        graph.add( orientable::settings(), below );
+        graph.add( orientable::settings(), first );
+        graph.update();
+        CHECK_EQUAL( 5u, graph.updated() );
+
+        graph.update();
+        CHECK_EQUAL( 0u, graph.updated() );
+
+        graph.local( below ).rotate( qutn( 0.0f, 0.0f, 0.7071068f, 0.7071068f ) );
+        graph.update();
+        CHECK_EQUAL( 2u, graph.updated() );
+        CHECK( graph.changed( below ) );
+        CHECK( not graph.changed( second ) );
+        CHECK( not graph.changed( first ) );
+    }
+
+    TEST( RemoveTakesSubtree )
+    {
+        scene_graph graph;
+        scene_graph::node root = graph.add();
+        scene_graph::node child = graph.add( orientable::settings(), root );
+        scene_graph::node grandchild = graph.add( orientable::settings(), child );
+        scene_graph::node other = graph.add( orientable::settings()
+                                             .position( vec3( 5.0f, 0.0f, 0.0f ) ) );
+        graph.update();
+
+        graph.remove( child );
+        CHECK_EQUAL( 2u, graph.size() );
+        CHECK( not graph.contains( child ) );
+        CHECK( not graph.contains( grandchild ) );
+        CHECK_THROW( graph.local( grandchild ), std::invalid_argument );
+
+        scene_graph::node again = graph.add( orientable::settings(), other );
+        graph.update();
+        CHECK_EQUAL( 3u, graph.size() );
+        CHECK_CLOSE( 5.0f, graph.world( again )( 3, 0 ), 0.0001f );
+    }
+
+    TEST( Reparenting )
+    {
+        scene_graph graph;
+        scene_graph::node left = graph.add( orientable::settings()
+                                            .position( vec3( -1.0f, 0.0f, 0.0f ) ) );
+        scene_graph::node right = graph.add( orientable::settings()
+                                             .position( vec3( 1.0f, 0.0f, 0.0f ) ) );
+        scene_graph::node leaf = graph.add( orientable::settings(), left );
+        graph.update();
+        CHECK_CLOSE( -1.0f, graph.world( leaf )( 3, 0 ), 0.0001f );
+
+        graph.parent( leaf, right );
+        graph.update();
+        CHECK_EQUAL( right, graph.parent( leaf ) );
+        CHECK_CLOSE( 1.0f, graph.world( leaf )( 3, 0 ), 0.0001f );
+        CHECK_THROW( graph.parent( right, leaf ), std::invalid_argument );
+        CHECK_THROW( graph.parent( right, right ), std::invalid_argument );
+
+        graph.parent( leaf, scene_graph::no_node );
+        graph.update();
+        CHECK( graph.parent( leaf ) == scene_graph::no_node );
+        CHECK_CLOSE( 0.0f, graph.world( leaf )( 3, 0 ), 0.0001f );
+    }
+
+    TEST( UnchangedUpdatesAreIdle )
+    {
+        // Runs of trees on other threads have nothing to compose
+        scene_graph graph ( scene_graph::settings().threads( 4 ) );
+        std::vector<scene_graph::node> roots;
+        for ( size_t i = 0; i < 8; ++i ) {
+            roots.push_back( graph.add( orientable::settings()
+                                        .position( vec3( float( i ), 0.0f, 0.0f ) ) ) );
+            graph.add( orientable::settings(), roots.back() );
+        }
+        graph.update();
+        CHECK_EQUAL( 16u, graph.updated() );
+        mat4 const before = graph.world( roots[5] );
+
+        graph.update();
+        graph.update();
+        CHECK_EQUAL( 0u, graph.updated() );
+        CHECK( not graph.changed( roots[5] ) );
+        CHECK( before == graph.world( roots[5] ) );
+
+        graph.local( roots[0] ).move( vec3( 0.0f, 1.0f, 0.0f ) );
+        graph.update();
+        CHECK_EQUAL( 2u, graph.updated() );
+        CHECK( graph.changed( roots[0] ) );
+        CHECK( not graph.changed( roots[5] ) );
+        graph.update();
+        CHECK_EQUAL( 0u, graph.updated() );
+        CHECK( not graph.changed( roots[0] ) );
+    }
+
+    TEST( ThreadsMatchOneThread )
+    {
+        scene_graph serial;
+        scene_graph threaded ( scene_graph::settings().threads( 4 ) );
+        std::vector<scene_graph::node> nodes;
+        for ( size_t i = 0; i < 400; ++i ) {
+            orientable::settings set = orientable::settings()
+                                       .position( vec3( float( i % 7 ), 1.0f, 0.0f ) );
+            // Trees of ten, each node under one about half its index
+            scene_graph::node up = i % 10 == 0 ?
+                                       scene_graph::no_node :
+                                       nodes[i - i % 10 + ( i % 10 - 1 ) / 2];
+            nodes.push_back( serial.add( set, up ) );
+            CHECK_EQUAL( nodes.back(), threaded.add( set, up ) );
+        }
+        serial.update();
+        threaded.update();
+        serial.local( nodes[21] ).move( vec3( 0.0f, 0.0f, 1.0f ) );
+        threaded.local( nodes[21] ).move( vec3( 0.0f, 0.0f, 1.0f ) );
+        serial.update();
+        threaded.update();
+        CHECK_EQUAL( serial.updated(), threaded.updated() );
+        for ( size_t i = 0; i < nodes.size(); ++i ) {
+            CHECK( serial.world( nodes[i] ) == threaded.world( nodes[i] ) );
+        }
+    }
+}
+
+int main( int argc, char* argv[] )
+{
+    return UnitTest::RunAllTests();
+}
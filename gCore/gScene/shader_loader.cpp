@@ -0,0 +1,397 @@
+#include <cctype>
+#include <sstream>
+#include <sys/stat.h>
+#include <sys/types.h>
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+#include "shader_loader.hpp"
+
+namespace gfx {
+    namespace {
+        /*
+         * Collapse "." and ".." so one file always has one path.
+         */
+        std::string normalize( std::string const& path )
+        {
+            std::vector<std::string> parts;
+            size_t start = 0;
+            while ( start <= path.size() ) {
+                size_t end = path.find( '/', start );
+                if ( end == std::string::npos ) {
+                    end = path.size();
+                }
+                std::string part = path.substr( start, end - start );
+                if ( part == ".." and not parts.empty() and parts.back() != ".." ) {
+                    parts.pop_back();
+                } else if ( part != "." and ( part != "" or start == 0 ) ) {
+                    parts.push_back( part );
+                }
+                start = end + 1;
+            }
+            std::string out;
+            for ( size_t i = 0; i < parts.size(); ++i ) {
+                out += ( i == 0 ? "" : "/" ) + parts[i];
+            }
+            return out;
+        }
+
+        bool    file_info( std::string const& path,
+                           long long& mtime,
+                           long long& size )
+        {
+            struct stat info;
+            if ( stat( path.c_str(), &info ) != 0 ) {
+                return false;
+            }
+            mtime = (long long) info.st_mtime;
+            size = (long long) info.st_size;
+            return true;
+        }
+
+        std::string line_directive( size_t const line, int const number )
+        {
+            std::ostringstream out;
+            out << "#line " << line << " " << number << "\n";
+            return out.str();
+        }
+        /*
+         * If the line is a preprocessor directive, return its name and
+         * leave pos just after it.
+         */
+        std::string directive( std::string const& line, size_t& pos )
+        {
+            pos = line.find_first_not_of( " \t" );
+            if ( pos == std::string::npos or line[pos] != '#' ) {
+                return "";
+            }
+            pos = line.find_first_not_of( " \t", pos + 1 );
+            if ( pos == std::string::npos ) {
+                return "";
+            }
+            size_t end = pos;
+            while ( end < line.size() and
+                    ( std::isalnum( (unsigned char) line[end] ) or line[end] == '_' ) ) {
+                ++end;
+            }
+            std::string name = line.substr( pos, end - pos );
+            pos = end;
+            return name;
+        }
+    }
+    /**
+     * \brief Construct a shader loader.
+     * \param set The settings for the loader
+     */
+    shader_loader::shader_loader( settings const& set ) :
+                                  dirs ( set.dirs_v ),
+                                  expanded (),
+                                  numbers (),
+                                  lock (),
+                                  hits_v ( 0 ),
+                                  misses_v ( 0 ) {}
+    /**
+     * \brief Return the loader programs use when they are not given one.
+     *
+     * It has no include directories, so includes are only found next to
+     * the including file.
+     * \return The shared loader
+     */
+    shader_loader&  shader_loader::shared()
+    {
+        static shader_loader loader;
+        return loader;
+    }
+    /**
+     * \brief Read the whole of a file at once.
+     *
+     * Where the platform allows, the file is mapped into memory rather
+     * than read through a stream.
+     * \param path The path of the file
+     * \return The contents of the file
+     * \exception gfx::compilation_error If the file cannot be read
+     */
+    std::string shader_loader::read_file( std::string const& path )
+    {
+#ifdef _WIN32
+        std::ifstream in ( path.c_str(), std::ios_base::in | std::ios_base::binary );
+        if ( not in ) {
+            throw compilation_error( "Shader source '" + path + "' could not be read." );
+        }
+        in.seekg( 0, std::ios_base::end );
+        std::string text ( (size_t) in.tellg(), '\0' );
+        in.seekg( 0, std::ios_base::beg );
+        if ( not text.empty() ) {
+            in.read( &text[0], text.size() );
+        }
+        return text;
+#else
+        int file = open( path.c_str(), O_RDONLY );
+        struct stat info;
+        if ( file < 0 or fstat( file, &info ) != 0 ) {
+            if ( file >= 0 ) {
+                close( file );
+            }
+            throw compilation_error( "Shader source '" + path + "' could not be read." );
+        }
+        std::string text;
+        if ( info.st_size > 0 ) {
+            void* mapped = mmap( 0, info.st_size, PROT_READ, MAP_PRIVATE, file, 0 );
+            if ( mapped == MAP_FAILED ) {
+                close( file );
+                throw compilation_error( "Shader source '" + path + "' could not be read." );
+            }
+            text.assign( (char const*) mapped, info.st_size );
+            munmap( mapped, info.st_size );
+        }
+        close( file );
+        return text;
+#endif
+    }
+    /**
+     * \brief Return the source of a shader with its includes expanded and
+     * the given defines added.
+     *
+     * The expansion is cached, and used again as long as none of the
+     * files that went into it have been modified.
+     * \param path The path of the shader source
+     * \param defines The defines to write after the <tt>#version</tt> line
+     * \return The source, ready to hand to OpenGL
+     * \exception gfx::compilation_error If a file cannot be read, an
+     * include cannot be found or includes form a cycle
+     */
+    std::string shader_loader::load( std::string const& path,
+                                     define_list const& defines )
+    {
+        std::string key = normalize( path );
+        expansion source;
+        bool found = false;
+        {
+            std::lock_guard<std::mutex> guard ( lock );
+            expansion_map::const_iterator cached = expanded.find( key );
+            if ( cached != expanded.end() ) {
+                source = cached->second;
+                found = true;
+            }
+        }
+        if ( found and current( source ) ) {
+            std::lock_guard<std::mutex> guard ( lock );
+            ++hits_v;
+        } else {
+            source = expansion();
+            std::vector<std::string> stack;
+            std::set<std::string> once;
+            expand( key, source, stack, once );
+            std::lock_guard<std::mutex> guard ( lock );
+            expanded[key] = source;
+            ++misses_v;
+        }
+
+        std::string text;
+        if ( not source.version.empty() ) {
+            text += source.version + "\n";
+        }
+        for ( size_t i = 0; i < defines.size(); ++i ) {
+            text += "#define " + defines[i].first + " " + defines[i].second + "\n";
+        }
+        return text + source.body;
+    }
+    /**
+     * \brief Say which file each source string number in an expanded
+     * shader stands for.
+     * \param path The path the shader was loaded from
+     * \return A line naming each file, or an empty string if the shader
+     * has not been loaded
+     */
+    std::string shader_loader::source_names( std::string const& path ) const
+    {
+        std::lock_guard<std::mutex> guard ( lock );
+        expansion_map::const_iterator cached = expanded.find( normalize( path ) );
+        if ( cached == expanded.end() ) {
+            return "";
+        }
+        std::ostringstream out;
+        out << "Source strings:";
+        std::vector<dependency> const& files = cached->second.files;
+        for ( size_t i = 0; i < files.size(); ++i ) {
+            out << ( i == 0 ? " " : ", " ) << files[i].number << " " << files[i].path;
+        }
+        return out.str();
+    }
+    /**
+     * \brief Forget every cached expansion.
+     */
+    void    shader_loader::clear()
+    {
+        std::lock_guard<std::mutex> guard ( lock );
+        expanded.clear();
+    }
+    /**
+     * \brief Return the number of loads served from the cache.
+     * \return The cache hits so far
+     */
+    size_t  shader_loader::hits() const
+    {
+        std::lock_guard<std::mutex> guard ( lock );
+        return hits_v;
+    }
+    /**
+     * \brief Return the number of loads that had to read files.
+     * \return The cache misses so far
+     */
+    size_t  shader_loader::misses() const
+    {
+        std::lock_guard<std::mutex> guard ( lock );
+        return misses_v;
+    }
+    /**
+     * \brief Check whether every file of a cached expansion is unchanged.
+     * \param cached The expansion
+     * \return Whether it can be used again
+     */
+    bool    shader_loader::current( expansion const& cached ) const
+    {
+        for ( size_t i = 0; i < cached.files.size(); ++i ) {
+            long long mtime = 0;
+            long long size = 0;
+            if ( not file_info( cached.files[i].path, mtime, size ) or
+                 mtime != cached.files[i].mtime or
+                 size != cached.files[i].size ) {
+                return false;
+            }
+        }
+        return true;
+    }
+    /**
+     * \brief Return the source string number of a file, giving it one if
+     * it has none yet.
+     * \param path The normalized path of the file
+     * \return The file's number
+     */
+    int     shader_loader::number( std::string const& path )
+    {
+        std::lock_guard<std::mutex> guard ( lock );
+        std::map<std::string, int>::const_iterator found = numbers.find( path );
+        if ( found != numbers.end() ) {
+            return found->second;
+        }
+        int next = (int) numbers.size();
+        numbers[path] = next;
+        return next;
+    }
+    /**
+     * \brief Find the file an include refers to.
+     * \param name The name given in the include
+     * \param from The path of the including file
+     * \param quoted Whether the name was in quotes rather than brackets
+     * \return The normalized path of the included file
+     * \exception gfx::compilation_error If the file cannot be found
+     */
+    std::string shader_loader::resolve( std::string const& name,
+                                        std::string const& from,
+                                        bool const quoted ) const
+    {
+        long long mtime = 0;
+        long long size = 0;
+        if ( quoted ) {
+            size_t slash = from.rfind( '/' );
+            std::string local = normalize( ( slash == std::string::npos ?
+                                             "" : from.substr( 0, slash + 1 ) ) + name );
+            if ( file_info( local, mtime, size ) ) {
+                return local;
+            }
+        }
+        for ( size_t i = 0; i < dirs.size(); ++i ) {
+            std::string candidate = normalize( dirs[i] + "/" + name );
+            if ( file_info( candidate, mtime, size ) ) {
+                return candidate;
+            }
+        }
+        throw compilation_error( "Included shader source '" + name +
+                                 "' not found from '" + from + "'." );
+    }
+    /**
+     * \brief Append the given file to an expansion, expanding its includes
+     * in turn.
+     * \param path The normalized path of the file
+     * \param out The expansion being built
+     * \param stack The files currently being expanded, outermost first
+     * \param once The files that have asked to be included only once
+     */
+    void    shader_loader::expand( std::string const& path,
+                                   expansion& out,
+                                   std::vector<std::string>& stack,
+                                   std::set<std::string>& once )
+    {
+        dependency file;
+        file.path = path;
+        if ( not file_info( path, file.mtime, file.size ) ) {
+            throw compilation_error( "Shader source '" + path + "' could not be read." );
+        }
+        file.number = number( path );
+        out.files.push_back( file );
+        std::string text = read_file( path );
+        bool root = stack.empty();
+        stack.push_back( path );
+
+        out.body += line_directive( 1, file.number );
+        size_t line_no = 0;
+        size_t start = 0;
+        while ( start < text.size() ) {
+            size_t end = text.find( '\n', start );
+            if ( end == std::string::npos ) {
+                end = text.size();
+            }
+            std::string line = text.substr( start, end - start );
+            start = end + 1;
+            ++line_no;
+            if ( not line.empty() and line[line.size() - 1] == '\r' ) {
+                line.erase( line.size() - 1 );
+            }
+
+            size_t pos = 0;
+            std::string name = directive( line, pos );
+            if ( name == "version" and root and out.version.empty() ) {
+                // Kept out of the body so defines can follow it
+                out.version = line;
+                out.body += "\n";
+            } else if ( name == "pragma" and
+                        line.find( "once", pos ) != std::string::npos ) {
+                once.insert( path );
+                out.body += "\n";
+            } else if ( name == "include" ) {
+                size_t open = line.find_first_of( "\"<", pos );
+                size_t close = ( open == std::string::npos ? open :
+                                 line.find( line[open] == '"' ? '"' : '>', open + 1 ) );
+                if ( close == std::string::npos ) {
+                    throw compilation_error( "Malformed include in '" + path + "': " + line );
+                }
+                std::string included = resolve( line.substr( open + 1, close - open - 1 ),
+                                                path, line[open] == '"' );
+                if ( once.count( included ) > 0 ) {
+                    out.body += "\n";
+                    continue;
+                }
+                for ( size_t i = 0; i < stack.size(); ++i ) {
+                    if ( stack[i] == included ) {
+                        std::string cycle;
+                        for ( size_t j = i; j < stack.size(); ++j ) {
+                            cycle += stack[j] + " -> ";
+                        }
+                        throw compilation_error( "Shader include cycle: " + cycle + included );
+                    }
+                }
+                expand( included, out, stack, once );
+                out.body += line_directive( line_no + 1, file.number );
+            } else {
+                out.body += line + "\n";
+            }
+        }
+        stack.pop_back();
+    }
+}
@@ -0,0 +1,117 @@
+#ifndef SHADER_LOADER_HPP
+#define SHADER_LOADER_HPP
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <utility>
+#include <mutex>
+
+#include "../gVideo/gfx_exception.hpp"
+
+namespace gfx {
+    /**
+     * \class gfx::shader_loader shader_loader.hpp "gCore/gScene/shader_loader.hpp"
+     * \brief Reads shader source files, expands their includes and keeps
+     * the result in memory.
+     *
+     * A line of the form <tt>#include "file"</tt> or
+     * <tt>#include &lt;file&gt;</tt> is replaced by the contents of that
+     * file. Quoted names are looked for next to the including file first;
+     * both forms then try each include directory in the order they were
+     * given. A file containing <tt>#pragma once</tt> is only pasted in the
+     * first time it is included, and an include cycle is an error. Ordinary
+     * <tt>#ifndef</tt> guards also work, since the GLSL preprocessor sees
+     * them after expansion.
+     *
+     * Every file is given a number, and <tt>#line</tt> directives are
+     * written around each include so the driver's error log names the
+     * right line of the right file; \ref source_names() "source_names()"
+     * says which number is which file.
+     *
+     * Defines given to \ref load() "load()" are written just after the
+     * <tt>#version</tt> line. They are not part of the cached text, so
+     * every set of defines shares one cached expansion. An entry is used
+     * again until any file that went into it is modified.
+     *
+     * Loading is safe from several threads at once.
+     */
+    class shader_loader {
+    public:
+        class settings {
+        public:
+                                        settings();
+            settings&                   include_path( std::string const& dir );
+        private:
+            std::vector<std::string>    dirs_v;
+            friend                      class shader_loader;
+        };
+        /**
+         * \brief Preprocessor defines, as name and value pairs.
+         */
+        typedef std::vector< std::pair<std::string, std::string> >  define_list;
+
+                            shader_loader( settings const& set = settings() );
+        static shader_loader&   shared();
+        static std::string  read_file( std::string const& path );
+        std::string         load( std::string const& path,
+                                  define_list const& defines = define_list() );
+        std::string         source_names( std::string const& path ) const;
+        void                clear();
+        size_t              hits() const;
+        size_t              misses() const;
+    private:
+                            shader_loader( shader_loader const& );
+        shader_loader&      operator =( shader_loader const& );
+        /*
+         * A file that went into an expansion, with the modification time
+         * and size it had when it was read.
+         */
+        struct dependency {
+            std::string     path;
+            long long       mtime;
+            long long       size;
+            int             number;
+        };
+        struct expansion {
+            std::string                 version;
+            std::string                 body;
+            std::vector<dependency>     files;
+        };
+        typedef std::map<std::string, expansion>    expansion_map;
+
+        std::vector<std::string>    dirs;
+        expansion_map               expanded;
+        std::map<std::string, int>  numbers;
+        mutable std::mutex          lock;
+        size_t                      hits_v;
+        size_t                      misses_v;
+
+        bool                current( expansion const& cached ) const;
+        int                 number( std::string const& path );
+        std::string         resolve( std::string const& name,
+                                     std::string const& from,
+                                     bool const quoted ) const;
+        void                expand( std::string const& path,
+                                    expansion& out,
+                                    std::vector<std::string>& stack,
+                                    std::set<std::string>& once );
+    };
+    /**
+     * \brief Construct a default \ref gfx::shader_loader::settings
+     * "settings" object, with no include directories.
+     */
+    inline  shader_loader::settings::settings() :
+                                      dirs_v () {}
+    /**
+     * \brief Add a directory to search for included files.
+     * \param dir The directory
+     * \return This settings object
+     */
+    inline  shader_loader::settings&
+    shader_loader::settings::include_path( std::string const& dir )
+    { dirs_v.push_back( dir ); return *this; }
+}
+
+#endif
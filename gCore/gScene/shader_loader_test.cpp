@@ -0,0 +1,138 @@
+#include <iostream>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <utime.h>
+
+#include "../gVideo/gfx_exception.hpp"
+#include "shader_loader.hpp"
+#include "../../UnitTest++_src/UnitTest++.h"
+
+using namespace gfx;
+
+namespace {
+    std::string const   test_dir = "./shader_loader_files";
+
+    void    write_file( std::string const& name, std::string const& text )
+    {
+        std::ofstream out ( ( test_dir + "/" + name ).c_str(),
+                            std::ios_base::out | std::ios_base::trunc );
+        out << text;
+    }
+    /*
+     * Step a file's modification time, since the file system may not
+     * see two writes in the same second as different.
+     */
+    void    touch( std::string const& name, time_t const when )
+    {
+        struct utimbuf times;
+        times.actime = when;
+        times.modtime = when;
+        utime( ( test_dir + "/" + name ).c_str(), &times );
+    }
+
+    size_t  count( std::string const& text, std::string const& piece )
+    {
+        size_t found = 0;
+        for ( size_t at = text.find( piece ); at != std::string::npos;
+              at = text.find( piece, at + 1 ) ) {
+            ++found;
+        }
+        return found;
+    }
+}
+
+SUITE( ShaderLoaderTests )
+{
+    TEST( IncludesAndLines )
+    {
+        mkdir( test_dir.c_str(), 0755 );
+        mkdir( ( test_dir + "/lib" ).c_str(), 0755 );
+        write_file( "main.glsl", "#version 330\n"
+                                 "#include \"common.glsl\"\n"
+                                 "#include <lib/light.glsl>\n"
+                                 "void main() {}\n" );
+        write_file( "common.glsl", "#pragma once\n"
+                                   "float half_of( float x ) { return x * 0.5; }\n" );
+        write_file( "lib/light.glsl", "#include \"../common.glsl\"\n"
+                                      "vec3 lit() { return vec3( half_of( 1.0 ) ); }\n" );
+
+        shader_loader test_loader ( shader_loader::settings()
+                                    .include_path( test_dir ) );
+        shader_loader::define_list defines;
+        defines.push_back( std::make_pair( std::string( "SHADOWS" ), std::string( "1" ) ) );
+        std::string text = test_loader.load( test_dir + "/main.glsl", defines );
+
+        // The version stays first, with the defines straight after it
+        CHECK_EQUAL( 0u, text.find( "#version 330\n#define SHADOWS 1\n#line 1 " ) );
+        CHECK_EQUAL( 1u, count( text, "float half_of" ) );
+        CHECK_EQUAL( 1u, count( text, "vec3 lit()" ) );
+        CHECK_EQUAL( 0u, count( text, "#include" ) );
+        CHECK_EQUAL( 0u, count( text, "#pragma once" ) );
+        // Back in main.glsl at line 3 after the first include
+        CHECK( text.find( "#line 3 0\n" ) != std::string::npos );
+        CHECK( test_loader.source_names( test_dir + "/main.glsl" ).find( "common.glsl" ) !=
+               std::string::npos );
+    }
+
+    TEST( SourceCache )
+    {
+        write_file( "cached.glsl", "#version 330\n"
+                                   "#include \"part.glsl\"\n" );
+        write_file( "part.glsl", "float a;\n" );
+        touch( "part.glsl", 1000000 );
+
+        shader_loader test_loader;
+        std::string first = test_loader.load( test_dir + "/cached.glsl" );
+        std::string second = test_loader.load( "./" + test_dir + "/cached.glsl" );
+        CHECK_EQUAL( first, second );
+        CHECK_EQUAL( 1u, test_loader.misses() );
+        CHECK_EQUAL( 1u, test_loader.hits() );
+
+        // Changing an included file invalidates the expansion
+        write_file( "part.glsl", "float b;\n" );
+        touch( "part.glsl", 2000000 );
+        std::string third = test_loader.load( test_dir + "/cached.glsl" );
+        CHECK_EQUAL( 2u, test_loader.misses() );
+        CHECK( third.find( "float b;" ) != std::string::npos );
+    }
+
+    TEST( IncludeErrors )
+    {
+        write_file( "cycle_a.glsl", "#include \"cycle_b.glsl\"\n" );
+        write_file( "cycle_b.glsl", "#include \"cycle_a.glsl\"\n" );
+        write_file( "missing.glsl", "#include \"nowhere.glsl\"\n" );
+        shader_loader test_loader;
+
+        std::string excepted ( "Exception not caught." );
+        try {
+            test_loader.load( test_dir + "/cycle_a.glsl" );
+        } catch ( compilation_error& e ) {
+            excepted = "Include cycle exception caught.";
+        }
+        CHECK_EQUAL( "Include cycle exception caught.", excepted );
+
+        excepted = "Exception not caught.";
+        try {
+            test_loader.load( test_dir + "/missing.glsl" );
+        } catch ( compilation_error& e ) {
+            excepted = "Missing include exception caught.";
+        }
+        CHECK_EQUAL( "Missing include exception caught.", excepted );
+
+        excepted = "Exception not caught.";
+        try {
+            shader_loader::read_file( test_dir + "/no_such_file.glsl" );
+        } catch ( compilation_error& e ) {
+            excepted = "Missing file exception caught.";
+        }
+        CHECK_EQUAL( "Missing file exception caught.", excepted );
+    }
+}
+
+int main( int argc, char** argv )
+{
+    return UnitTest::RunAllTests();
+}
@@ -0,0 +1,436 @@
+#ifndef STD140_HPP
+#define STD140_HPP
+
+#include <string>
+#include <vector>
+#include <sstream>
+#include <cstring>
+#include <stdexcept>
+
+#include "../gMath/datatype.hpp"
+#include "../gUtility/datatypeinfo.hpp"
+
+namespace gfx {
+    /**
+     * \class gfx::std140_traits std140.hpp "gCore/gScene/std140.hpp"
+     * \brief Describes how a type is laid out as columns of components.
+     *
+     * Scalars and vectors are a single column; matrices are stored column
+     * by column, as in GLSL. The component count and size come from
+     * \ref gfx::type "type", this only adds the column count and the way
+     * to read a component out of a value.
+     */
+    template< typename T >
+    struct std140_traits {
+        typedef T               comp_t;
+        static size_t const     columns = 1;
+        static size_t const     rows = 1;
+        static comp_t           component( T const& val,
+                                           size_t const col,
+                                           size_t const row )
+        { return val; }
+    };
+
+    template< typename T >
+    struct std140_traits< scalar<T> > {
+        typedef T               comp_t;
+        static size_t const     columns = 1;
+        static size_t const     rows = 1;
+        static comp_t           component( scalar<T> const& val,
+                                           size_t const col,
+                                           size_t const row )
+        { return val; }
+    };
+
+#define STD140_VECTOR( VEC_T, ROWS ) \
+    template< typename T > \
+    struct std140_traits< VEC_T<T> > { \
+        typedef T               comp_t; \
+        static size_t const     columns = 1; \
+        static size_t const     rows = ROWS; \
+        static comp_t           component( VEC_T<T> const& val, \
+                                           size_t const col, \
+                                           size_t const row ) \
+        { return val[row]; } \
+    };
+
+#define STD140_MATRIX( MAT_T, COLUMNS, ROWS ) \
+    template< typename T > \
+    struct std140_traits< MAT_T<T> > { \
+        typedef T               comp_t; \
+        static size_t const     columns = COLUMNS; \
+        static size_t const     rows = ROWS; \
+        static comp_t           component( MAT_T<T> const& val, \
+                                           size_t const col, \
+                                           size_t const row ) \
+        { return val( col, row ); } \
+    };
+
+    STD140_VECTOR( vec2_t, 2 )
+    STD140_VECTOR( vec3_t, 3 )
+    STD140_VECTOR( vec4_t, 4 )
+    STD140_MATRIX( mat2_t, 2, 2 )
+    STD140_MATRIX( mat3_t, 3, 3 )
+    STD140_MATRIX( mat4_t, 4, 4 )
+    STD140_MATRIX( mat2x3_t, 2, 3 )
+    STD140_MATRIX( mat3x2_t, 3, 2 )
+    STD140_MATRIX( mat2x4_t, 2, 4 )
+    STD140_MATRIX( mat4x2_t, 4, 2 )
+    STD140_MATRIX( mat3x4_t, 3, 4 )
+    STD140_MATRIX( mat4x3_t, 4, 3 )
+
+#undef STD140_VECTOR
+#undef STD140_MATRIX
+
+    /**
+     * \class gfx::std140_block std140.hpp "gCore/gScene/std140.hpp"
+     * \brief The layout and contents of a uniform block in std140 form.
+     *
+     * Members are declared in the order they appear in the shader's block
+     * and are given the offsets the std140 rules require:
+     *  - scalars are aligned to their size, two component vectors to twice
+     *    that and three and four component vectors to four times that;
+     *  - the elements of arrays and the columns of matrices are each
+     *    aligned and padded to a vec4;
+     *  - structs are aligned to a vec4 and padded out to a multiple of one.
+     *
+     * A struct member is declared with another block describing the struct,
+     * and its fields become members of their own, named like "lights[2].pos"
+     * for an array of structs or "cam.view" for a single one.
+     *
+     * Values are written into a copy of the block held here. Writes that do
+     * not change the stored bytes are dropped, and the block remembers
+     * whether anything did change, so a buffer only needs uploading when
+     * \ref dirty() "dirty()" says so. Look members up by name once with
+     * \ref index() "index()" and write through the index afterwards.
+     */
+    class std140_block {
+    public:
+                                std140_block();
+        template< typename T >
+        std140_block&           member( std::string const& name,
+                                        size_t const count = 1 );
+        std140_block&           member( std::string const& name,
+                                        std140_block const& structure );
+        std140_block&           member( std::string const& name,
+                                        std140_block const& structure,
+                                        size_t const count );
+        size_t                  size() const;
+        size_t                  members() const;
+        size_t                  index( std::string const& name ) const;
+        size_t                  offset( size_t const member,
+                                        size_t const element = 0 ) const;
+        size_t                  offset( std::string const& name,
+                                        size_t const element = 0 ) const;
+        size_t                  array_stride( size_t const member ) const;
+        template< typename T >
+        void                    write( size_t const member,
+                                       T const& val,
+                                       size_t const element = 0 );
+        template< typename T >
+        void                    write( std::string const& name,
+                                       T const& val,
+                                       size_t const element = 0 );
+        unsigned char const*    bytes() const;
+        bool                    dirty() const;
+        void                    clean();
+    private:
+        struct entry {
+            std::string         name;
+            size_t              offset;
+            size_t              count;
+            size_t              array_stride;
+            size_t              columns;
+            size_t              rows;
+            size_t              column_stride;
+        };
+        std::vector<entry>          entries;
+        std::vector<unsigned char>  storage;
+        size_t                      end;
+        bool                        dirty_v;
+
+        static size_t           round_up( size_t const bytes,
+                                          size_t const align );
+        void                    place( std::string const& name,
+                                       size_t const columns,
+                                       size_t const rows,
+                                       size_t const count );
+        void                    place( std::string const& name,
+                                       std140_block const& structure,
+                                       size_t const count,
+                                       bool const is_array );
+        void                    grow();
+    };
+    /**
+     * \brief Construct an empty block.
+     */
+    inline  std140_block::std140_block() :
+                                       entries (),
+                                       storage (),
+                                       end ( 0 ),
+                                       dirty_v ( false ) {}
+    /**
+     * \brief Add a member, or an array of them, to the end of the block.
+     *
+     * Only 32 bit components are allowed, which covers every type
+     * a uniform block can hold before double precision arrived.
+     * \param name The name of the member
+     * \param count The number of array elements; one for a plain member
+     * \return This block
+     * \exception std::invalid_argument If the type cannot be put in a block
+     */
+    template< typename T > inline
+    std140_block&   std140_block::member( std::string const& name,
+                                          size_t const count )
+    {
+        type<T> info;
+        if ( info.mapping() == DOUBLE or
+             info.component_size() != 4 ) {
+            throw std::invalid_argument( "Uniform block members must have 32 bit components." );
+        }
+        size_t columns = std140_traits<T>::columns;
+        place( name, columns, info.n_components() / columns, count );
+        return *this;
+    }
+    /**
+     * \brief Add a struct member to the end of the block.
+     *
+     * Its fields are named "name.field".
+     * \param name The name of the struct member
+     * \param structure A block whose members are the struct's fields
+     * \return This block
+     */
+    inline  std140_block&   std140_block::member( std::string const& name,
+                                                  std140_block const& structure )
+    { place( name, structure, 1, false ); return *this; }
+    /**
+     * \brief Add an array of structs to the end of the block.
+     *
+     * Its fields are named "name[i].field" for each element i.
+     * \param name The name of the array
+     * \param structure A block whose members are the struct's fields
+     * \param count The number of elements
+     * \return This block
+     */
+    inline  std140_block&   std140_block::member( std::string const& name,
+                                                  std140_block const& structure,
+                                                  size_t const count )
+    { place( name, structure, count, true ); return *this; }
+    /**
+     * \brief Return the size of the block in bytes.
+     *
+     * This is the size a buffer must have to back the block.
+     * \return The size of the block
+     */
+    inline  size_t  std140_block::size() const
+    { return storage.size(); }
+    /**
+     * \brief Return the number of members, counting each field of a struct
+     * member separately.
+     * \return The number of members
+     */
+    inline  size_t  std140_block::members() const
+    { return entries.size(); }
+    /**
+     * \brief Find the index of the member with the given name.
+     *
+     * The fields of a struct come one after the other in the order they
+     * were declared, so the index of the first field locates the rest.
+     * \param name The name of the member
+     * \return The index of the member
+     * \exception std::invalid_argument If there is no such member
+     */
+    inline  size_t  std140_block::index( std::string const& name ) const
+    {
+        for ( size_t i = 0; i < entries.size(); ++i ) {
+            if ( entries[i].name == name ) {
+                return i;
+            }
+        }
+        throw std::invalid_argument( "No member named " + name + " in uniform block." );
+    }
+    /**
+     * \brief Return the byte offset of a member within the block.
+     * \param member The index of the member
+     * \param element The array element
+     * \return The offset in bytes
+     * \exception std::out_of_range If the member or element does not exist
+     */
+    inline  size_t  std140_block::offset( size_t const member,
+                                          size_t const element ) const
+    {
+        if ( member >= entries.size() ) {
+            throw std::out_of_range( "Uniform block member index out of range." );
+        }
+        if ( element >= entries[member].count ) {
+            throw std::out_of_range( "Uniform block array element out of range." );
+        }
+        return entries[member].offset + element * entries[member].array_stride;
+    }
+    /**
+     * \brief Return the byte offset of a member within the block.
+     * \param name The name of the member
+     * \param element The array element
+     * \return The offset in bytes
+     */
+    inline  size_t  std140_block::offset( std::string const& name,
+                                          size_t const element ) const
+    { return offset( index( name ), element ); }
+    /**
+     * \brief Return the distance in bytes between array elements of
+     * a member.
+     * \param member The index of the member
+     * \return The array stride
+     */
+    inline  size_t  std140_block::array_stride( size_t const member ) const
+    { return entries.at( member ).array_stride; }
+    /**
+     * \brief Write a value into a member of the block.
+     *
+     * The block is only marked dirty if the bytes actually change.
+     * \param member The index of the member
+     * \param val The value
+     * \param element The array element
+     * \exception std::out_of_range If the member or element does not exist
+     * \exception std::invalid_argument If the value does not have the
+     * member's shape
+     */
+    template< typename T > inline
+    void    std140_block::write( size_t const member,
+                                 T const& val,
+                                 size_t const element )
+    {
+        typedef std140_traits<T>                traits;
+        typedef typename traits::comp_t         comp_t;
+        size_t start = offset( member, element );
+        entry const& target = entries[member];
+        if ( target.columns != traits::columns or
+             target.rows != traits::rows or
+             sizeof( comp_t ) != 4 ) {
+            throw std::invalid_argument( "Value does not match the type of uniform block member " + target.name + "." );
+        }
+        comp_t column[4];
+        for ( size_t col = 0; col < traits::columns; ++col ) {
+            for ( size_t row = 0; row < traits::rows; ++row ) {
+                column[row] = traits::component( val, col, row );
+            }
+            unsigned char* dst = &storage[start + col * target.column_stride];
+            if ( std::memcmp( dst, column, traits::rows * sizeof( comp_t ) ) != 0 ) {
+                std::memcpy( dst, column, traits::rows * sizeof( comp_t ) );
+                dirty_v = true;
+            }
+        }
+    }
+    /**
+     * \brief Write a value into the named member of the block.
+     * \param name The name of the member
+     * \param val The value
+     * \param element The array element
+     */
+    template< typename T > inline
+    void    std140_block::write( std::string const& name,
+                                 T const& val,
+                                 size_t const element )
+    { write( index( name ), val, element ); }
+    /**
+     * \brief Return the contents of the block.
+     * \return The first of \ref size() "size()" bytes
+     */
+    inline  unsigned char const*    std140_block::bytes() const
+    { return storage.empty() ? 0 : &storage[0]; }
+    /**
+     * \brief Query whether any write has changed the block since it was
+     * last marked clean.
+     * \return Whether the block has changed
+     */
+    inline  bool    std140_block::dirty() const
+    { return dirty_v; }
+    /**
+     * \brief Mark the block as matching what was last uploaded.
+     */
+    inline  void    std140_block::clean()
+    { dirty_v = false; }
+    /**
+     * \brief Round a byte count up to a multiple of an alignment.
+     */
+    inline  size_t  std140_block::round_up( size_t const bytes,
+                                            size_t const align )
+    { return ( bytes + align - 1 ) / align * align; }
+    /**
+     * \brief Lay out a member made of 32 bit components.
+     * \param name The name of the member
+     * \param columns The number of columns; one unless it is a matrix
+     * \param rows The number of components in each column
+     * \param count The number of array elements
+     */
+    inline  void    std140_block::place( std::string const& name,
+                                         size_t const columns,
+                                         size_t const rows,
+                                         size_t const count )
+    {
+        if ( count == 0 ) {
+            throw std::invalid_argument( "Uniform block arrays must have at least one element." );
+        }
+        size_t column_bytes = rows * 4;
+        size_t align = ( rows == 1 ? 4 : ( rows == 2 ? 8 : 16 ) );
+        entry added = { name, 0, count, column_bytes, columns, rows, column_bytes };
+        size_t bytes = column_bytes;
+        if ( columns > 1 or count > 1 ) {
+            // Array elements and matrix columns are each padded to a vec4
+            align = 16;
+            added.column_stride = 16;
+            added.array_stride = columns * 16;
+            bytes = count * added.array_stride;
+        }
+        added.offset = round_up( end, align );
+        end = added.offset + bytes;
+        entries.push_back( added );
+        grow();
+    }
+    /**
+     * \brief Lay out a struct member, or an array of them.
+     * \param name The name of the member
+     * \param structure The block describing the struct
+     * \param count The number of array elements
+     * \param is_array Whether the fields are named with an element index
+     */
+    inline  void    std140_block::place( std::string const& name,
+                                         std140_block const& structure,
+                                         size_t const count,
+                                         bool const is_array )
+    {
+        if ( count == 0 or structure.entries.empty() ) {
+            throw std::invalid_argument( "Uniform block structs must have fields and at least one element." );
+        }
+        size_t stride = round_up( structure.end, 16 );
+        size_t base = round_up( end, 16 );
+        for ( size_t i = 0; i < count; ++i ) {
+            std::ostringstream prefix;
+            prefix << name;
+            if ( is_array ) {
+                prefix << '[' << i << ']';
+            }
+            prefix << '.';
+            for ( size_t f = 0; f < structure.entries.size(); ++f ) {
+                entry field = structure.entries[f];
+                field.name = prefix.str() + field.name;
+                field.offset += base + i * stride;
+                entries.push_back( field );
+            }
+        }
+        // Whatever follows a struct starts on a vec4 boundary
+        end = base + count * stride;
+        grow();
+    }
+    /**
+     * \brief Extend the stored contents to cover every member, padded to
+     * a vec4.
+     */
+    inline  void    std140_block::grow()
+    {
+        storage.resize( round_up( end, 16 ), 0 );
+        dirty_v = true;
+    }
+}
+
+#endif
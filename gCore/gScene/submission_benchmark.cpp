@@ -0,0 +1,116 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "../gVideo/video.hpp"
+#include "../gMath/datatype.hpp"
+#include "vertex_buffer.hpp"
+#include "program.hpp"
+#include "gl_state.hpp"
+
+using namespace gfx;
+
+/*
+ * Measures the CPU side of draw submission, buffer uploads and state
+ * changes against the null OpenGL backend, so it runs without a display or
+ * GPU and its call counts are the same on every machine. The timings are
+ * the cost of the scene classes and the loader alone; the driver's own
+ * cost is left out by design.
+ *
+ * Usage: submission_benchmark [objects] [frames]
+ */
+namespace {
+    typedef std::chrono::high_resolution_clock  bench_clock;
+
+    double  nanoseconds( bench_clock::time_point const start, size_t const ops )
+    {
+        return std::chrono::duration<double, std::nano>( bench_clock::now() - start ).count() /
+               double( ops == 0 ? 1 : ops );
+    }
+}
+
+int main( int argc, char** argv )
+{
+    size_t objects = ( argc > 1 ) ? std::strtoul( argv[1], 0, 10 ) : 10000;
+    size_t frames = ( argc > 2 ) ? std::strtoul( argv[2], 0, 10 ) : 20;
+    size_t const buffers = 8;
+
+    gl_backend::use_null();
+    video_system::get().initialize( video_system::settings().ver( 3, 3 ) );
+    context bench_cntx ( ( context::settings() ) );
+    gl_state& state = gl_state::current();
+    state.checking( false );
+
+    program prgm ( program::settings()
+                   .vertex_path( "./shader/testVertCam.glsl" )
+                   .fragment_path( "./shader/testFragCam.glsl" ) );
+    prgm.compile();
+    prgm.link();
+    uniform_handle view = prgm.find_uniform( "view" );
+
+    std::vector<vertex_buffer*> vbos;
+    for ( size_t i = 0; i < buffers; ++i ) {
+        vbos.push_back( new vertex_buffer( vertex_buffer::settings()
+                                           .blocks( 64 ) ) );
+        vbos.back()->block_format( block_spec()
+                                   .attribute( type<vec3>() ) );
+        vbos.back()->upload_data();
+    }
+
+    double draw_ns = 0.0;
+    double uniform_ns = 0.0;
+    double upload_ns = 0.0;
+    double state_ns = 0.0;
+    mat4 transform;
+    for ( size_t frame = 0; frame <= frames; ++frame ) {
+        // The last frame is recorded rather than timed
+        gl_backend::reset_stats();
+        gl_backend::recording( frame == frames );
+        state.begin_frame();
+
+        bench_clock::time_point start = bench_clock::now();
+        for ( size_t i = 0; i < objects; ++i ) {
+            prgm.use();
+            vbos[i % buffers]->align();
+            gl::DrawArrays( gl::TRIANGLES, 0, 64 );
+        }
+        draw_ns += nanoseconds( start, objects );
+
+        start = bench_clock::now();
+        for ( size_t i = 0; i < objects; ++i ) {
+            transform( 3, 0 ) = float( i );
+            prgm.upload_uniform( view, transform );
+        }
+        uniform_ns += nanoseconds( start, objects );
+
+        start = bench_clock::now();
+        for ( size_t i = 0; i < buffers; ++i ) {
+            vbos[i]->upload_data();
+        }
+        upload_ns += nanoseconds( start, buffers );
+
+        start = bench_clock::now();
+        for ( size_t i = 0; i < objects; ++i ) {
+            state.blend( i % 4 == 0 );
+            state.depth_test( true );
+            state.cull( i % 2 == 0 );
+        }
+        state_ns += nanoseconds( start, objects );
+    }
+    gl_backend::recording( false );
+
+    std::cout << objects << " objects, " << frames << " frames, null backend\n"
+              << "draw submission  " << draw_ns / frames << " ns/object\n"
+              << "uniform upload   " << uniform_ns / frames << " ns/object\n"
+              << "buffer upload    " << upload_ns / frames << " ns/buffer\n"
+              << "state changes    " << state_ns / frames << " ns/object\n"
+              << "state calls skipped: " << state.stats().skipped << "\n\n"
+              << "Calls in one frame:\n";
+    gl_backend::report( std::cout );
+
+    for ( size_t i = 0; i < buffers; ++i ) {
+        delete vbos[i];
+    }
+    return 0;
+}
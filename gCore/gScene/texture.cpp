@@ -1,5 +1,7 @@
 #include <FreeImage.h>
 #include "texture.hpp"
+#include "pixel_convert.hpp"
+#include "texture_units.hpp"
 
 
 namespace gfx {
@@ -373,6 +375,228 @@ namespace gfx {
 //             uint32_t color;
 //         };
 //     }; 
+    /**
+     * \brief Compute a hash of the sampler settings.
+     * 
+     * Only used to key the shared sampler table, so a simple combination
+     * of the fields is enough.
+     * \return The hash value
+     */
+    size_t  sampler::settings::hash() const
+    {
+        std::hash<float> hash_f;
+        std::hash<GLint> hash_i;
+        size_t h = hash_f( base_lod_v );
+        h = h * 31u + hash_f( max_lod_v );
+        h = h * 31u + hash_f( lod_bias_v );
+        h = h * 31u + hash_i( min_filter_v );
+        h = h * 31u + hash_i( mag_filter_v );
+        h = h * 31u + hash_i( wrap_s_v );
+        h = h * 31u + hash_i( wrap_t_v );
+        h = h * 31u + hash_i( wrap_r_v );
+        h = h * 31u + hash_i( compare_func_v );
+        return h;
+    }
+    /**
+     * \brief Return the sampler shared for the given settings.
+     * 
+     * If no sampler with these settings exists yet, one is created and its
+     * state is set once; otherwise the existing sampler is handed back.
+     * Every acquire() must be matched by a \ref release() "release()".
+     * \param set The sampling settings
+     * \return The shared sampler
+     */
+    sampler&    sampler::acquire( settings const& set )
+    {
+        if ( not video_system::get().context_present() ) {
+            throw std::logic_error( "No OpenGL context available to create a sampler in." );
+        }
+        if ( not supported() ) {
+            throw std::logic_error( "Sampler objects require OpenGL 3.3." );
+        }
+        sampler_map& samplers = cache();
+        sampler_map::iterator found = samplers.find( set );
+        if ( found == samplers.end() ) {
+            found = samplers.insert( std::make_pair( set,
+                                                     new sampler( set ) ) ).first;
+        }
+        ++(found->second->refs);
+        return *(found->second);
+    }
+    /**
+     * \brief Give up a reference to a shared sampler.
+     * 
+     * The sampler is deleted once nothing references it.
+     * \param smplr The sampler to release
+     */
+    void    sampler::release( sampler& smplr )
+    {
+        if ( smplr.refs > 1 ) {
+            --smplr.refs;
+            return;
+        }
+        sampler_map& samplers = cache();
+        sampler_map::iterator found = samplers.find( smplr.state_v );
+        if ( found != samplers.end() and found->second == &smplr ) {
+            samplers.erase( found );
+        }
+        delete &smplr;
+    }
+    /**
+     * \brief Return the number of distinct samplers currently shared.
+     * \return The number of live samplers
+     */
+    size_t  sampler::shared()
+    { return cache().size(); }
+    /**
+     * \brief Return whether the current context supports sampler objects.
+     * \return Whether sampler objects are available
+     */
+    bool    sampler::supported()
+    { return not ( video_system::get().get_version() < opengl_3_3 ); }
+    /**
+     * \brief Change the sampler's state in place.
+     * 
+     * Only the parameters that differ are written, and every texture
+     * sharing the sampler is sampled with the new state from then on; the
+     * sampler stays bound wherever it was. The sampler is handed out by
+     * \ref acquire() "acquire()" for the new settings afterwards, unless
+     * another sampler already has them, in which case that one keeps
+     * being handed out and this one is left to the textures holding it.
+     * \param set The new sampling settings
+     */
+    void    sampler::change( settings const& set )
+    {
+        if ( set == state_v ) {
+            return;
+        }
+        sampler_map& samplers = cache();
+        sampler_map::iterator found = samplers.find( state_v );
+        if ( found != samplers.end() and found->second == this ) {
+            samplers.erase( found );
+        }
+        if ( set.base_lod_v != state_v.base_lod_v ) {
+            gl::SamplerParameterf( smplr_ID, gl::TEXTURE_MIN_LOD, set.base_lod_v );
+        }
+        if ( set.max_lod_v != state_v.max_lod_v ) {
+            gl::SamplerParameterf( smplr_ID, gl::TEXTURE_MAX_LOD, set.max_lod_v );
+        }
+        if ( set.lod_bias_v != state_v.lod_bias_v ) {
+            gl::SamplerParameterf( smplr_ID, gl::TEXTURE_LOD_BIAS, set.lod_bias_v );
+        }
+        if ( set.min_filter_v != state_v.min_filter_v ) {
+            gl::SamplerParameteri( smplr_ID, gl::TEXTURE_MIN_FILTER, set.min_filter_v );
+        }
+        if ( set.mag_filter_v != state_v.mag_filter_v ) {
+            gl::SamplerParameteri( smplr_ID, gl::TEXTURE_MAG_FILTER, set.mag_filter_v );
+        }
+        if ( set.wrap_s_v != state_v.wrap_s_v ) {
+            gl::SamplerParameteri( smplr_ID, gl::TEXTURE_WRAP_S, set.wrap_s_v );
+        }
+        if ( set.wrap_t_v != state_v.wrap_t_v ) {
+            gl::SamplerParameteri( smplr_ID, gl::TEXTURE_WRAP_T, set.wrap_t_v );
+        }
+        if ( set.wrap_r_v != state_v.wrap_r_v ) {
+            gl::SamplerParameteri( smplr_ID, gl::TEXTURE_WRAP_R, set.wrap_r_v );
+        }
+        if ( set.compare_func_v != state_v.compare_func_v ) {
+            if ( set.compare_func_v == 0 ) {
+                gl::SamplerParameteri( smplr_ID, gl::TEXTURE_COMPARE_MODE, gl::NONE );
+            } else {
+                if ( state_v.compare_func_v == 0 ) {
+                    gl::SamplerParameteri( smplr_ID,
+                                           gl::TEXTURE_COMPARE_MODE,
+                                           gl::COMPARE_REF_TO_TEXTURE );
+                }
+                gl::SamplerParameteri( smplr_ID,
+                                       gl::TEXTURE_COMPARE_FUNC,
+                                       set.compare_func_v );
+            }
+        }
+        state_v = set;
+        samplers.insert( std::make_pair( set, this ) );
+    }
+    /**
+     * \brief Bind this sampler to a texture unit.
+     * \param unit The texture unit, counted from zero
+     */
+    void    sampler::bind( GLuint const unit ) const
+    { gl::BindSampler( unit, smplr_ID ); }
+    /**
+     * \brief Write sampling settings into the parameters of a bound texture.
+     * 
+     * This is the fallback for contexts without sampler objects.
+     * \param set The sampling settings
+     * \param target The target the texture is bound to
+     */
+    void    sampler::apply( settings const& set,
+                            GLenum const target )
+    {
+        gl::TexParameterf( target, gl::TEXTURE_MIN_LOD, set.base_lod_v );
+        gl::TexParameterf( target, gl::TEXTURE_MAX_LOD, set.max_lod_v );
+        gl::TexParameterf( target, gl::TEXTURE_LOD_BIAS, set.lod_bias_v );
+        gl::TexParameteri( target, gl::TEXTURE_MIN_FILTER, set.min_filter_v );
+        gl::TexParameteri( target, gl::TEXTURE_MAG_FILTER, set.mag_filter_v );
+        gl::TexParameteri( target, gl::TEXTURE_WRAP_S, set.wrap_s_v );
+        gl::TexParameteri( target, gl::TEXTURE_WRAP_T, set.wrap_t_v );
+        gl::TexParameteri( target, gl::TEXTURE_WRAP_R, set.wrap_r_v );
+        if ( set.compare_func_v == 0 ) {
+            gl::TexParameteri( target, gl::TEXTURE_COMPARE_MODE, gl::NONE );
+        } else {
+            gl::TexParameteri( target,
+                               gl::TEXTURE_COMPARE_MODE,
+                               gl::COMPARE_REF_TO_TEXTURE );
+            gl::TexParameteri( target,
+                               gl::TEXTURE_COMPARE_FUNC,
+                               set.compare_func_v );
+        }
+    }
+    /**
+     * \brief Construct a new sampler object and set its state.
+     * \param set The sampling settings
+     */
+    sampler::sampler( settings const& set ) :
+                      state_v ( set ),
+                      smplr_ID ( 0 ),
+                      refs ( 0 )
+    {
+        gl::GenSamplers( 1, &smplr_ID );
+        gl::SamplerParameterf( smplr_ID, gl::TEXTURE_MIN_LOD, set.base_lod_v );
+        gl::SamplerParameterf( smplr_ID, gl::TEXTURE_MAX_LOD, set.max_lod_v );
+        gl::SamplerParameterf( smplr_ID, gl::TEXTURE_LOD_BIAS, set.lod_bias_v );
+        gl::SamplerParameteri( smplr_ID, gl::TEXTURE_MIN_FILTER, set.min_filter_v );
+        gl::SamplerParameteri( smplr_ID, gl::TEXTURE_MAG_FILTER, set.mag_filter_v );
+        gl::SamplerParameteri( smplr_ID, gl::TEXTURE_WRAP_S, set.wrap_s_v );
+        gl::SamplerParameteri( smplr_ID, gl::TEXTURE_WRAP_T, set.wrap_t_v );
+        gl::SamplerParameteri( smplr_ID, gl::TEXTURE_WRAP_R, set.wrap_r_v );
+        if ( set.compare_func_v != 0 ) {
+            gl::SamplerParameteri( smplr_ID,
+                                   gl::TEXTURE_COMPARE_MODE,
+                                   gl::COMPARE_REF_TO_TEXTURE );
+            gl::SamplerParameteri( smplr_ID,
+                                   gl::TEXTURE_COMPARE_FUNC,
+                                   set.compare_func_v );
+        }
+    }
+    /**
+     * \brief Destruct the sampler and free its OpenGL object.
+     */
+    sampler::~sampler()
+    {
+        if ( video_system::get().context_present() ) {
+            gl::DeleteSamplers( 1, &smplr_ID );
+        }
+        texture_units::forget_sampler( smplr_ID );
+    }
+    /**
+     * \brief Return the table of shared samplers.
+     * \return The sampler table
+     */
+    sampler::sampler_map&   sampler::cache()
+    {
+        static sampler_map samplers;
+        return samplers;
+    }
     /**
      * \brief Construct a new one dimensional texture.
      * \param set The settings for the new texture.
@@ -380,10 +604,12 @@ namespace gfx {
     texture_1D::texture_1D( settings const& set ) :
                             tex_ID ( 0 ),
                             target ( 0 ),
+                            smplr ( 0 ),
                             width_v ( set.dw_v ),
                             pixels_v ( set.pixels_v ),
                             pixel_bits_v ( set.pixel_size_v ),
                             image_format ( set.image_format_v ),
+                            premultiply ( set.premultiply_v ),
                             path ( set.path_v ),
                             data ( 0 )
     {
@@ -393,42 +619,43 @@ namespace gfx {
         } else {
             target = gl::TEXTURE_1D;
         }
-        gl::ActiveTexture( gl::TEXTURE0 );
-        gl::BindTexture( target, tex_ID );
+        if ( video_system::get().context_present() ) {
+            texture_units::current().edit( *this );
+        } else {
+            gl::ActiveTexture( gl::TEXTURE0 );
+            gl::BindTexture( target, tex_ID );
+        }
         
-        gl::TexParameteri( target, gl::TEXTURE_BASE_LEVEL, set.base_level_v );
+        if ( set.base_level_v != 0 ) {
+            gl::TexParameteri( target, gl::TEXTURE_BASE_LEVEL, set.base_level_v );
+        }
         gl::TexParameteri( target, gl::TEXTURE_MAX_LEVEL, set.max_level_v );
-        gl::TexParameteri( target, gl::TEXTURE_SWIZZLE_R, set.r_src_v );
-        if ( set.channels_v > 1 ) {
+        /*
+         * Only swizzles that differ from the identity need setting; a new
+         * texture object already reads each channel from itself.
+         */
+        if ( set.r_src_v != gl::RED ) {
+            gl::TexParameteri( target, gl::TEXTURE_SWIZZLE_R, set.r_src_v );
+        }
+        if ( set.channels_v > 1 and set.g_src_v != gl::GREEN ) {
             gl::TexParameteri( target, gl::TEXTURE_SWIZZLE_G, set.g_src_v );
-            if ( set.channels_v > 2 ) {
-                gl::TexParameteri( target, gl::TEXTURE_SWIZZLE_B, set.b_src_v );
-                if ( set.channels_v > 3 ) {
-                    gl::TexParameteri( target, gl::TEXTURE_SWIZZLE_A, set.a_src_v );
-                }
-            }
         }
-        gl::TexParameterf( target, gl::TEXTURE_MIN_LOD, set.base_lod_v );
-        gl::TexParameterf( target, gl::TEXTURE_MAX_LOD, set.max_lod_v );
-        gl::TexParameterf( target, gl::TEXTURE_LOD_BIAS, set.lod_bias_v );
-        
-        gl::TexParameteri( target, gl::TEXTURE_MIN_FILTER, set.min_filter_v );
-        gl::TexParameteri( target, gl::TEXTURE_MAG_FILTER, set.mag_filter_v );
-        
-        gl::TexParameteri( target, gl::TEXTURE_WRAP_S, set.wrap_s_v );
-        gl::TexParameteri( target, gl::TEXTURE_WRAP_T, set.wrap_t_v );
-        
-        if ( set.compare_func_v == 0 ) {
-            gl::TexParameteri( target, gl::TEXTURE_COMPARE_MODE, gl::NONE );
-        } else {
-            gl::TexParameteri( target,
-                               gl::TEXTURE_COMPARE_MODE,
-                               gl::COMPARE_REF_TO_TEXTURE );
-            gl::TexParameteri( target,
-                               gl::TEXTURE_COMPARE_FUNC,
-                               set.compare_func_v );
+        if ( set.channels_v > 2 and set.b_src_v != gl::BLUE ) {
+            gl::TexParameteri( target, gl::TEXTURE_SWIZZLE_B, set.b_src_v );
         }
-        gl::BindTexture( target, 0 );
+        if ( set.channels_v > 3 and set.a_src_v != gl::ALPHA ) {
+            gl::TexParameteri( target, gl::TEXTURE_SWIZZLE_A, set.a_src_v );
+        }
+        sampler::settings sample_set;
+        sample_set.base_lod_v = set.base_lod_v;
+        sample_set.max_lod_v = set.max_lod_v;
+        sample_set.lod_bias_v = set.lod_bias_v;
+        sample_set.min_filter_v = set.min_filter_v;
+        sample_set.mag_filter_v = set.mag_filter_v;
+        sample_set.wrap_s_v = set.wrap_s_v;
+        sample_set.wrap_t_v = set.wrap_t_v;
+        sample_set.compare_func_v = set.compare_func_v;
+        sampling( sample_set );
     }
     /**
      * \brief Destruct this one dimensional texture.
@@ -436,6 +663,9 @@ namespace gfx {
      */
     texture_1D::~texture_1D()
     {
+        if ( smplr != 0 ) {
+            sampler::release( *smplr );
+        }
         delete[] data;
     }
     /**
@@ -501,8 +731,11 @@ namespace gfx {
      * \brief Upload the texture's data to OpenGL.
      * 
      * This function requires that \ref gfx::texture_1D::decode_file "decode_file()"
-     * has been called on this one dimensional texture.
-     * \todo Does this take into account the pxiel formatting options are all?
+     * has been called on this one dimensional texture. The decoded data
+     * is converted to the format and type matching the image format before
+     * it is handed over, so the driver does not have to convert it. That
+     * includes undoing FreeImage's BGR ordering, so no channel swizzle is
+     * needed for it.
      */
     void    texture_1D::load_data()
     {
@@ -512,33 +745,69 @@ namespace gfx {
         if ( data == 0 ) {
             throw std::logic_error( "Texture data not initialized." );
         }
-        gl::ActiveTexture( gl::TEXTURE0 );
-        gl::BindTexture( target, tex_ID );
+        pixel_transfer transfer ( image_format, pixel_bits_v / 8, true, premultiply );
+        std::vector<unsigned char> converted;
+        transfer.convert( data, pixels_v, converted );
+        
+        texture_units::current().edit( *this );
+        gl::PixelStorei( gl::UNPACK_ALIGNMENT, 1 );
         gl::TexImage1D( target,
                         0,
                         image_format,
                         width_v,
                         0,
-                        gl::RGB,
-                        gl::UNSIGNED_BYTE,
-                        data              );
+                        transfer.format(),
+                        transfer.type(),
+                        &converted[0]     );
+        gl::PixelStorei( gl::UNPACK_ALIGNMENT, 4 );
         //video_system::get().check_acceleration_error("Texture_1D load_data");
         
     }
     /**
      * \brief Activate use of this texture in the current state of OpenGL.
-     * \todo This function is not very "intelligent", it assumes things about
-     * what texture bindings the texture should use (specifically it assigns
-     * this texture to binding 0). This is a relative of the uniform problem
-     * over in lights and cameras. These issues must be resolved.
+     * 
+     * The texture and its sampler are bound to unit 0, skipping any call
+     * that would not change the bound state. Drawing with more than one
+     * texture should go through \ref gfx::texture_units::assign()
+     * "texture_units::assign()" instead, which picks the units.
      */
     void    texture_1D::use()
     {
         if ( not video_system::get().context_present() ) {
             throw std::logic_error( "No OpenGL context available to bind texture to." );
         }
-        gl::ActiveTexture( gl::TEXTURE0 );
-        gl::BindTexture( target, tex_ID );
+        if ( smplr == 0 and sampler::supported() ) {
+            smplr = &sampler::acquire( smplr_set );
+        }
+        texture_units::current().bind( 0, *this );
+    }
+    /**
+     * \brief Change how this texture is sampled.
+     * 
+     * The texture gives up its current sampler and takes the shared sampler
+     * for the new settings. Without sampler object support the state is
+     * written into the texture's own parameters instead. If there is no
+     * context yet, the sampler is acquired the first time the texture is
+     * used. To change every texture sharing a sampler at once, change the
+     * sampler itself with \ref gfx::sampler::change() "sampler::change()".
+     * \param set The new sampling settings
+     */
+    void    texture_1D::sampling( sampler::settings const& set )
+    {
+        smplr_set = set;
+        if ( smplr != 0 ) {
+            sampler::release( *smplr );
+            smplr = 0;
+        }
+        if ( not video_system::get().context_present() ) {
+            return;
+        }
+        if ( sampler::supported() ) {
+            smplr = &sampler::acquire( set );
+        } else {
+            texture_units::current().edit( *this );
+            sampler::apply( set, target );
+        }
     }
     /**
      * \brief Return the number of bytes in the texture.
@@ -560,11 +829,14 @@ namespace gfx {
     texture_2D::texture_2D( settings const& set ) :
                             tex_ID ( 0 ),
                             target ( 0 ),
+                            smplr ( 0 ),
                             width_v ( set.dw_v ),
                             height_v ( set.dh_v ),
                             pixels_v ( set.pixels_v ),
                             pixel_bits_v ( set.pixel_size_v ),
+                            layers_v ( set.layers_v ),
                             image_format ( set.image_format_v ),
+                            premultiply ( set.premultiply_v ),
                             path ( set.path_v ),
                             data ( 0 )
     {
@@ -574,42 +846,43 @@ namespace gfx {
         } else {
             target = gl::TEXTURE_2D;
         }
-        gl::ActiveTexture( gl::TEXTURE0 );
-        gl::BindTexture( target, tex_ID );
+        if ( video_system::get().context_present() ) {
+            texture_units::current().edit( *this );
+        } else {
+            gl::ActiveTexture( gl::TEXTURE0 );
+            gl::BindTexture( target, tex_ID );
+        }
         
-        gl::TexParameteri( target, gl::TEXTURE_BASE_LEVEL, set.base_level_v );
+        if ( set.base_level_v != 0 ) {
+            gl::TexParameteri( target, gl::TEXTURE_BASE_LEVEL, set.base_level_v );
+        }
         gl::TexParameteri( target, gl::TEXTURE_MAX_LEVEL, set.max_level_v );
-        gl::TexParameteri( target, gl::TEXTURE_SWIZZLE_R, set.r_src_v );
-        if ( set.channels_v > 1 ) {
+        /*
+         * Only swizzles that differ from the identity need setting; a new
+         * texture object already reads each channel from itself.
+         */
+        if ( set.r_src_v != gl::RED ) {
+            gl::TexParameteri( target, gl::TEXTURE_SWIZZLE_R, set.r_src_v );
+        }
+        if ( set.channels_v > 1 and set.g_src_v != gl::GREEN ) {
             gl::TexParameteri( target, gl::TEXTURE_SWIZZLE_G, set.g_src_v );
-            if ( set.channels_v > 2 ) {
-                gl::TexParameteri( target, gl::TEXTURE_SWIZZLE_B, set.b_src_v );
-                if ( set.channels_v > 3 ) {
-                    gl::TexParameteri( target, gl::TEXTURE_SWIZZLE_A, set.a_src_v );
-                }
-            }
         }
-        gl::TexParameterf( target, gl::TEXTURE_MIN_LOD, set.base_lod_v );
-        gl::TexParameterf( target, gl::TEXTURE_MAX_LOD, set.max_lod_v );
-        gl::TexParameterf( target, gl::TEXTURE_LOD_BIAS, set.lod_bias_v );
-        
-        gl::TexParameteri( target, gl::TEXTURE_MIN_FILTER, set.min_filter_v );
-        gl::TexParameteri( target, gl::TEXTURE_MAG_FILTER, set.mag_filter_v );
-        
-        gl::TexParameteri( target, gl::TEXTURE_WRAP_S, set.wrap_s_v );
-        gl::TexParameteri( target, gl::TEXTURE_WRAP_T, set.wrap_t_v );
-        
-        if ( set.compare_func_v == 0 ) {
-            gl::TexParameteri( target, gl::TEXTURE_COMPARE_MODE, gl::NONE );
-        } else {
-            gl::TexParameteri( target,
-                               gl::TEXTURE_COMPARE_MODE,
-                               gl::COMPARE_REF_TO_TEXTURE );
-            gl::TexParameteri( target,
-                               gl::TEXTURE_COMPARE_FUNC,
-                               set.compare_func_v );
+        if ( set.channels_v > 2 and set.b_src_v != gl::BLUE ) {
+            gl::TexParameteri( target, gl::TEXTURE_SWIZZLE_B, set.b_src_v );
         }
-        gl::BindTexture( target, 0 );
+        if ( set.channels_v > 3 and set.a_src_v != gl::ALPHA ) {
+            gl::TexParameteri( target, gl::TEXTURE_SWIZZLE_A, set.a_src_v );
+        }
+        sampler::settings sample_set;
+        sample_set.base_lod_v = set.base_lod_v;
+        sample_set.max_lod_v = set.max_lod_v;
+        sample_set.lod_bias_v = set.lod_bias_v;
+        sample_set.min_filter_v = set.min_filter_v;
+        sample_set.mag_filter_v = set.mag_filter_v;
+        sample_set.wrap_s_v = set.wrap_s_v;
+        sample_set.wrap_t_v = set.wrap_t_v;
+        sample_set.compare_func_v = set.compare_func_v;
+        sampling( sample_set );
     }
     /**
      * \brief Destruct this one dimensional texture.
@@ -617,6 +890,9 @@ namespace gfx {
      */
     texture_2D::~texture_2D()
     {
+        if ( smplr != 0 ) {
+            sampler::release( *smplr );
+        }
         delete[] data;
     }
     /**
@@ -686,8 +962,11 @@ namespace gfx {
      * \brief Upload the texture's data to OpenGL.
      * 
      * This function requires that \ref gfx::texture_1D::decode_file "decode_file()"
-     * has been called on this two dimensional texture.
-     * \todo Does this take into account the pxiel formatting options are all?
+     * has been called on this two dimensional texture. The decoded data
+     * is converted to the format and type matching the image format before
+     * it is handed over, so the driver does not have to convert it. That
+     * includes undoing FreeImage's BGR ordering, so no channel swizzle is
+     * needed for it.
      */
     void    texture_2D::load_data()
     {
@@ -697,33 +976,69 @@ namespace gfx {
         if ( data == 0 ) {
             throw std::logic_error( "Texture data not initialized." );
         }
-        gl::ActiveTexture( gl::TEXTURE0 );
-        gl::BindTexture( target, tex_ID );
+        pixel_transfer transfer ( image_format, pixel_bits_v / 8, true, premultiply );
+        std::vector<unsigned char> converted;
+        transfer.convert( data, pixels_v, converted );
+        
+        texture_units::current().edit( *this );
+        gl::PixelStorei( gl::UNPACK_ALIGNMENT, 1 );
         gl::TexImage2D( target,
                         0,
                         image_format,
                         width_v,
                         height_v,
                         0,
-                        gl::RGB,
-                        gl::UNSIGNED_BYTE,
-                        data              );
+                        transfer.format(),
+                        transfer.type(),
+                        &converted[0]     );
+        gl::PixelStorei( gl::UNPACK_ALIGNMENT, 4 );
         //video_system::get().check_acceleration_error("Texture_2D load_data");
     }
     /**
      * \brief Activate use of this texture in the current state of OpenGL.
-     * \todo This function is not very "intelligent", it assumes things about
-     * what texture bindings the texture should use (specifically it assigns
-     * this texture to binding 0). This is a relative of the uniform problem
-     * over in lights and cameras. These issues must be resolved.
+     * 
+     * The texture and its sampler are bound to unit 0, skipping any call
+     * that would not change the bound state. Drawing with more than one
+     * texture should go through \ref gfx::texture_units::assign()
+     * "texture_units::assign()" instead, which picks the units.
      */
     void    texture_2D::use()
     {
         if ( not video_system::get().context_present() ) {
             throw std::logic_error( "No OpenGL context available to bind texture to." );
         }
-        gl::ActiveTexture( gl::TEXTURE0 );
-        gl::BindTexture( target, tex_ID );
+        if ( smplr == 0 and sampler::supported() ) {
+            smplr = &sampler::acquire( smplr_set );
+        }
+        texture_units::current().bind( 0, *this );
+    }
+    /**
+     * \brief Change how this texture is sampled.
+     * 
+     * The texture gives up its current sampler and takes the shared sampler
+     * for the new settings. Without sampler object support the state is
+     * written into the texture's own parameters instead. If there is no
+     * context yet, the sampler is acquired the first time the texture is
+     * used. To change every texture sharing a sampler at once, change the
+     * sampler itself with \ref gfx::sampler::change() "sampler::change()".
+     * \param set The new sampling settings
+     */
+    void    texture_2D::sampling( sampler::settings const& set )
+    {
+        smplr_set = set;
+        if ( smplr != 0 ) {
+            sampler::release( *smplr );
+            smplr = 0;
+        }
+        if ( not video_system::get().context_present() ) {
+            return;
+        }
+        if ( sampler::supported() ) {
+            smplr = &sampler::acquire( set );
+        } else {
+            texture_units::current().edit( *this );
+            sampler::apply( set, target );
+        }
     }
     /**
      * \brief Return the number of bytes in the texture.
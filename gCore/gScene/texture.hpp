@@ -5,6 +5,7 @@
 #include <stdexcept>
 #include <cstdint>
 #include <iostream>
+#include <unordered_map>
 
 #include "../gVideo/gl_core_3_3.hpp"
 #include "../gMath/datatype.hpp"
@@ -257,8 +258,10 @@ namespace gfx {
      */
     class filter_t {
         protected: virtual GLint   val() const = 0;
+        private:   GLint           value() const { return val(); }
         friend                      class texture_1D;
         friend                      class texture_2D;
+        friend                      class sampler;
     };
     /**
      * \class gfx::min_filter_t texture.hpp "gCore/gVideo/texture.hpp"
@@ -377,8 +380,10 @@ namespace gfx {
      */
     class wrap_mode_t {
         protected: virtual GLint   val() const = 0;
+        private:   GLint           value() const { return val(); }
         friend                      class texture_1D;
         friend                      class texture_2D;
+        friend                      class sampler;
     };
     /**
      * \class gfx::clamp_to_border_t texture.hpp "gCore/gVideo/texture.hpp"
@@ -455,8 +460,10 @@ namespace gfx {
      */
     class comparison_function_t {
         protected: virtual GLint   val() const = 0;
+        private:   GLint           value() const { return val(); }
         friend                      class texture_1D;
         friend                      class texture_2D;
+        friend                      class sampler;
     };
     
     /**
@@ -579,6 +586,193 @@ namespace gfx {
      */
     never_t const never;
     
+    /**
+     * \class gfx::sampler texture.hpp "gCore/gScene/texture.hpp"
+     * \brief A shared OpenGL sampler object.
+     * 
+     * Sampling state (filters, wrap modes, level of detail range and bias,
+     * and the comparison function) lives in sampler objects rather than in
+     * each texture. Samplers are never constructed directly; \ref acquire()
+     * "acquire()" hashes the \ref gfx::sampler::settings "settings" and hands
+     * back the one sampler with that state, creating it the first time.
+     * Textures with the same sampling settings therefore share a sampler,
+     * and creating a texture no longer costs a dozen parameter calls.
+     * 
+     * \ref change() "change()" rewrites a shared sampler's state in place,
+     * so every texture sampled through it follows at once, without any of
+     * them re-acquiring a sampler or being bound again.
+     * 
+     * Samplers need OpenGL 3.3. On older versions \ref apply() "apply()"
+     * writes the same state into a texture's own parameters instead.
+     */
+    class sampler {
+    public:
+        
+        class settings {
+        public:
+                            settings();
+            settings&       sample_range( float const base,
+                                          float const max );
+            settings&       sample_bias( float const bias );
+            settings&       sample_minification( min_filter_t const& min );
+            settings&       sample_magnification( mag_filter_t const& mag );
+            settings&       wrap_s( wrap_mode_t const& mode );
+            settings&       wrap_t( wrap_mode_t const& mode );
+            settings&       wrap_r( wrap_mode_t const& mode );
+            settings&       comparison_function( comparison_function_t const& func );
+            bool            operator ==( settings const& rhs ) const;
+            size_t          hash() const;
+        private:
+            float           base_lod_v;
+            float           max_lod_v;
+            float           lod_bias_v;
+            GLint           min_filter_v;
+            GLint           mag_filter_v;
+            GLint           wrap_s_v;
+            GLint           wrap_t_v;
+            GLint           wrap_r_v;
+            GLint           compare_func_v;
+            friend          class sampler;
+            friend          class texture_1D;
+            friend          class texture_2D;
+        };
+        static sampler&     acquire( settings const& set = settings() );
+        static void         release( sampler& smplr );
+        static size_t       shared();
+        static bool         supported();
+        GLuint              ID() const;
+        settings const&     state() const;
+        void                change( settings const& set );
+        void                bind( GLuint const unit ) const;
+        static void         apply( settings const& set,
+                                   GLenum const target );
+    private:
+                            sampler( settings const& set );
+                            ~sampler();
+                            sampler( sampler const& );
+        sampler&            operator =( sampler const& );
+        
+        struct settings_hash {
+            size_t operator ()( settings const& set ) const
+            { return set.hash(); }
+        };
+        typedef std::unordered_map< settings,
+                                    sampler*,
+                                    settings_hash >    sampler_map;
+        static sampler_map& cache();
+        
+        settings            state_v;
+        GLuint              smplr_ID;
+        size_t              refs;
+    };
+    /**
+     * \brief Construct a default \ref gfx::sampler::settings "settings" object.
+     * 
+     * The defaults match those of the texture settings objects: nearest
+     * filtering, clamping to the edge, and a level of detail range that
+     * covers only the base level.
+     */
+    inline  sampler::settings::settings() :
+                                base_lod_v ( 0.0f ),
+                                max_lod_v ( 0.0f ),
+                                lod_bias_v ( 0.0f ),
+                                min_filter_v ( gl::NEAREST ),
+                                mag_filter_v ( gl::NEAREST ),
+                                wrap_s_v ( gl::CLAMP_TO_EDGE ),
+                                wrap_t_v ( gl::CLAMP_TO_EDGE ),
+                                wrap_r_v ( gl::CLAMP_TO_EDGE ),
+                                compare_func_v ( 0 ) {}
+    /**
+     * \brief Set the sampler's level of detail range.
+     * \param base The lowest level of sampling
+     * \param max The highest level of sampling
+     */
+    inline  sampler::settings&
+    sampler::settings::sample_range( float const base,
+                                     float const max )
+    {
+        base_lod_v = base;
+        max_lod_v = max;
+        return *this;
+    }
+    /**
+     * \brief Set the sampler's level of detail bias.
+     * \param bias The sampling bias
+     */
+    inline  sampler::settings&
+    sampler::settings::sample_bias( float const bias )
+    { lod_bias_v = bias; return *this; }
+    /**
+     * \brief Set the sampler's minification filter.
+     * \param min The minification filter
+     */
+    inline  sampler::settings&
+    sampler::settings::sample_minification( min_filter_t const& min )
+    { min_filter_v = min.value(); return *this; }
+    /**
+     * \brief Set the sampler's magnification filter.
+     * \param mag The magnification filter
+     */
+    inline  sampler::settings&
+    sampler::settings::sample_magnification( mag_filter_t const& mag )
+    { mag_filter_v = mag.value(); return *this; }
+    /**
+     * \brief Set the sampler's wrap mode along the s-axis.
+     * \param mode The wrap mode
+     */
+    inline  sampler::settings&
+    sampler::settings::wrap_s( wrap_mode_t const& mode )
+    { wrap_s_v = mode.value(); return *this; }
+    /**
+     * \brief Set the sampler's wrap mode along the t-axis.
+     * \param mode The wrap mode
+     */
+    inline  sampler::settings&
+    sampler::settings::wrap_t( wrap_mode_t const& mode )
+    { wrap_t_v = mode.value(); return *this; }
+    /**
+     * \brief Set the sampler's wrap mode along the r-axis.
+     * \param mode The wrap mode
+     */
+    inline  sampler::settings&
+    sampler::settings::wrap_r( wrap_mode_t const& mode )
+    { wrap_r_v = mode.value(); return *this; }
+    /**
+     * \brief Set the sampler's comparison function for depth textures.
+     * \param func The comparison function
+     */
+    inline  sampler::settings&
+    sampler::settings::comparison_function( comparison_function_t const& func )
+    { compare_func_v = func.value(); return *this; }
+    /**
+     * \brief Compare two sets of sampler settings.
+     * \return Whether they describe identical sampling state
+     */
+    inline  bool    sampler::settings::operator ==( settings const& rhs ) const
+    {
+        return base_lod_v == rhs.base_lod_v and
+               max_lod_v == rhs.max_lod_v and
+               lod_bias_v == rhs.lod_bias_v and
+               min_filter_v == rhs.min_filter_v and
+               mag_filter_v == rhs.mag_filter_v and
+               wrap_s_v == rhs.wrap_s_v and
+               wrap_t_v == rhs.wrap_t_v and
+               wrap_r_v == rhs.wrap_r_v and
+               compare_func_v == rhs.compare_func_v;
+    }
+    /**
+     * \brief Return the OpenGL name of the sampler.
+     * \return The sampler object's ID
+     */
+    inline  GLuint  sampler::ID() const
+    { return smplr_ID; }
+    /**
+     * \brief Return the sampler's current settings.
+     * \return The sampling settings
+     */
+    inline  sampler::settings const&    sampler::state() const
+    { return state_v; }
+    
     /**
      * \class gfx::texture_1D texture.hpp "gCore/gScene/texture.hpp"
      * \brief Represents a one dimenstional texture.
@@ -681,6 +875,7 @@ namespace gfx {
             settings&       wrap_s( wrap_mode_t const& mode );
             settings&       wrap_t( wrap_mode_t const& mode );
             settings&       comparison_function( comparison_function_t const& func );
+            settings&       premultiplied_alpha();
             settings&       file( std::string const& path );
         private:
             size_t          dw_v;
@@ -706,6 +901,7 @@ namespace gfx {
             GLint           g_src_v;
             GLint           b_src_v;
             GLint           a_src_v;
+            bool            premultiply_v;
             std::string     path_v;
             friend          class texture_1D;
         };
@@ -718,21 +914,26 @@ namespace gfx {
         void                decode_file();
         void                load_data();
         void                use();
+        void                sampling( sampler::settings const& set );
 //         sub_tex_1D          get_sub_texture( size_t const w_start = 0,
 //                                              size_t const w_end   = 0 );
     private:    
         
         GLuint              tex_ID;
         GLuint              target;
+        sampler*            smplr;
+        sampler::settings   smplr_set;
         size_t              width_v;
         size_t              pixels_v;
         size_t              pixel_bits_v;
         GLuint              image_format;
+        bool                premultiply;
         std::string         path;
         
         unsigned char*      data;
         
         size_t              bytes();
+        friend              class texture_units;
     };
     
     /**
@@ -767,6 +968,7 @@ namespace gfx {
                                     g_src_v ( gl::GREEN ),
                                     b_src_v ( gl::BLUE ),
                                     a_src_v ( gl::ALPHA ),
+                                    premultiply_v ( false ),
                                     path_v ( "" ) {}
     /**
      * \brief Set the new one dimensional texture's dimension.
@@ -2173,6 +2375,16 @@ namespace gfx {
     inline  texture_1D::settings&
     texture_1D::settings::comparison_function( comparison_function_t const& func )
     { compare_func_v = func.val(); return *this; }
+    /**
+     * \brief Premultiply the new one dimensional texture's color channels
+     * by alpha when its data is loaded.
+     *
+     * Only four channel data is affected. For sRGB formats the
+     * multiplication is done on linear values.
+     */
+    inline  texture_1D::settings&
+    texture_1D::settings::premultiplied_alpha()
+    { premultiply_v = true; return *this; }
     /**
      * \brief Set the new one dimensional texture's source file.
      * \param path The file path
@@ -2280,6 +2492,7 @@ namespace gfx {
             settings&       wrap_s( wrap_mode_t const& mode );
             settings&       wrap_t( wrap_mode_t const& mode );
             settings&       comparison_function( comparison_function_t const& func );
+            settings&       premultiplied_alpha();
             settings&       file( std::string const& path );
         private:
             size_t          dw_v;
@@ -2305,6 +2518,7 @@ namespace gfx {
             GLint           g_src_v;
             GLint           b_src_v;
             GLint           a_src_v;
+            bool            premultiply_v;
             std::string     path_v;
             friend          class texture_2D;
         };
@@ -2318,22 +2532,31 @@ namespace gfx {
         void                decode_file();
         void                load_data();
         void                use();
+        void                sampling( sampler::settings const& set );
 //         sub_tex_1D          get_sub_texture( size_t const w_start = 0,
 //                                              size_t const w_end   = 0 );
     private:    
         
         GLuint              tex_ID;
         GLuint              target;
+        sampler*            smplr;
+        sampler::settings   smplr_set;
         size_t              width_v;
         size_t              height_v;
         size_t              pixels_v;
         size_t              pixel_bits_v;
+        size_t              layers_v;
         GLuint              image_format;
+        bool                premultiply;
         std::string         path;
         
         unsigned char*      data;
         
         size_t              bytes();
+        friend              class texture_atlas;
+        friend              class texture_streamer;
+        friend              class texture_units;
+        friend              class render_queue;
     };
     /**
      * \brief Construct a new default two dimensional texture settings object.
@@ -2367,6 +2590,7 @@ namespace gfx {
                                     g_src_v ( gl::GREEN ),
                                     b_src_v ( gl::BLUE ),
                                     a_src_v ( gl::ALPHA ),
+                                    premultiply_v ( false ),
                                     path_v ( "" ) {}
     /**
      * \brief Set the new two dimensional texture's dimension.
@@ -3772,6 +3996,16 @@ namespace gfx {
     inline  texture_2D::settings&
     texture_2D::settings::comparison_function( comparison_function_t const& func )
     { compare_func_v = func.val(); return *this; }
+    /**
+     * \brief Premultiply the new two dimensional texture's color channels
+     * by alpha when its data is loaded.
+     *
+     * Only four channel data is affected. For sRGB formats the
+     * multiplication is done on linear values.
+     */
+    inline  texture_2D::settings&
+    texture_2D::settings::premultiplied_alpha()
+    { premultiply_v = true; return *this; }
     /**
      * \brief Set the new two dimensional texture's source file.
      * \param path The file path
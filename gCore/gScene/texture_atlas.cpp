@@ -0,0 +1,373 @@
+#include <cstring>
+#include "texture_atlas.hpp"
+#include "pixel_convert.hpp"
+#include "texture_units.hpp"
+
+namespace gfx {
+    /**
+     * \brief Construct a new, empty texture atlas.
+     *
+     * No OpenGL resources are touched until \ref build() "build()" is
+     * called, so an atlas may be packed before any context exists.
+     * \param set The settings for the atlas
+     */
+    texture_atlas::texture_atlas( settings const& set ) :
+                                width_v ( set.dw_v ),
+                                height_v ( set.dh_v ),
+                                channels_v ( set.channels_v ),
+                                padding_v ( set.padding_v ),
+                                mip_levels_v ( set.mip_levels_v ),
+                                used_v ( 0 ),
+                                skyline (),
+                                table (),
+                                data ( 0 )
+    {
+        if ( channels_v < 1 or channels_v > 4 ) {
+            throw std::invalid_argument( "Texture atlas must have between one and four channels." );
+        }
+        // Bilinear sampling at mip level n reads one texel of that level
+        // past the edge, which is 2^n texels of the base image.
+        size_t block = size_t(1) << mip_levels_v;
+        if ( padding_v < block and mip_levels_v > 0 ) {
+            padding_v = block;
+        }
+        size_t bytes = width_v * height_v * channels_v;
+        data = new unsigned char[bytes];
+        std::memset( data, 0, bytes );
+        skyline_node first = { 0, 0, width_v };
+        skyline.push_back( first );
+    }
+    /**
+     * \brief Destruct the texture atlas.
+     */
+    texture_atlas::~texture_atlas()
+    {
+        delete[] data;
+    }
+    /**
+     * \brief Pack an image into the atlas.
+     *
+     * The pixels are copied, so the source may be released afterwards.
+     * Rows are expected bottom to top with no row padding and channels
+     * in RGB(A) order.
+     * \param pixels The image data, with as many channels as the atlas
+     * \param w The width of the image in texels
+     * \param h The height of the image in texels
+     * \return The index of the image's \ref region "region"
+     */
+    size_t  texture_atlas::add( unsigned char const* pixels,
+                                size_t const w,
+                                size_t const h )
+    {
+        if ( pixels == 0 or w == 0 or h == 0 ) {
+            throw std::invalid_argument( "Cannot pack an empty image into a texture atlas." );
+        }
+        size_t outer_w = aligned( w + 2 * padding_v );
+        size_t outer_h = aligned( h + 2 * padding_v );
+
+        size_t best_node = skyline.size();
+        size_t best_y = height_v;
+        size_t best_w = width_v + 1;
+        size_t y = 0;
+        for ( size_t node = 0; node < skyline.size(); ++node ) {
+            if ( fit( node, outer_w, outer_h, y ) ) {
+                if ( y < best_y or
+                     ( y == best_y and skyline[node].w < best_w ) ) {
+                    best_node = node;
+                    best_y = y;
+                    best_w = skyline[node].w;
+                }
+            }
+        }
+        if ( best_node == skyline.size() ) {
+            throw std::out_of_range( "Image does not fit in the remaining texture atlas space." );
+        }
+        size_t outer_x = skyline[best_node].x;
+        place( best_node, outer_x, best_y, outer_w, outer_h );
+
+        region packed;
+        packed.x = outer_x + padding_v;
+        packed.y = best_y + padding_v;
+        packed.w = w;
+        packed.h = h;
+        packed.uv_min = vec2( float( packed.x ) / float( width_v ),
+                              float( packed.y ) / float( height_v ) );
+        packed.uv_max = vec2( float( packed.x + w ) / float( width_v ),
+                              float( packed.y + h ) / float( height_v ) );
+
+        // Fill the whole padded block, clamping into the image so the
+        // border repeats the edge texels.
+        unsigned char* row;
+        for ( size_t ty = 0; ty < outer_h; ++ty ) {
+            size_t sy = ty < padding_v ? 0 : ty - padding_v;
+            if ( sy >= h ) { sy = h - 1; }
+            row = data + ( ( best_y + ty ) * width_v + outer_x ) * channels_v;
+            for ( size_t tx = 0; tx < outer_w; ++tx ) {
+                size_t sx = tx < padding_v ? 0 : tx - padding_v;
+                if ( sx >= w ) { sx = w - 1; }
+                std::memcpy( row + tx * channels_v,
+                             pixels + ( sy * w + sx ) * channels_v,
+                             channels_v );
+            }
+        }
+        used_v += outer_w * outer_h;
+        table.push_back( packed );
+        return table.size() - 1;
+    }
+    /**
+     * \brief Pack a decoded texture into the atlas.
+     *
+     * The texture must have had \ref gfx::texture_2D::decode_file()
+     * "decode_file()" called on it and must have as many eight bit
+     * channels as the atlas. Its channels are put in RGB(A) order on
+     * the way in.
+     * \param source The texture to copy from
+     * \return The index of the texture's \ref region "region"
+     */
+    size_t  texture_atlas::add( texture_2D const& source )
+    {
+        if ( source.data == 0 ) {
+            throw std::logic_error( "Texture data not initialized." );
+        }
+        if ( source.pixel_bits_v != channels_v * 8 ) {
+            throw std::invalid_argument( "Texture pixel format does not match the texture atlas." );
+        }
+        // Decoded data is in FreeImage's BGR(A) order; the atlas is RGB(A)
+        size_t texels = source.width_v * source.height_v;
+        std::vector<unsigned char> pixels ( source.data, source.data + texels * channels_v );
+        swap_red_blue( &pixels[0], texels, channels_v );
+        return add( &pixels[0], source.width_v, source.height_v );
+    }
+    /**
+     * \brief Upload the packed image to a two dimensional texture.
+     *
+     * The texture's dimensions are replaced by the atlas's. If the atlas
+     * is mip safe the mipmap chain is generated afterwards.
+     * \param target The texture to upload to
+     */
+    void    texture_atlas::build( texture_2D& target ) const
+    {
+        if ( not video_system::get().context_present() ) {
+            throw std::logic_error( "No OpenGL context available to load texture atlas to." );
+        }
+        if ( target.target != gl::TEXTURE_2D ) {
+            throw std::invalid_argument( "Texture atlas must be built into a plain two dimensional texture; use a layer for arrays." );
+        }
+        target.width_v = width_v;
+        target.height_v = height_v;
+        target.pixels_v = width_v * height_v;
+        target.pixel_bits_v = channels_v * 8;
+
+        pixel_transfer transfer ( target.image_format, channels_v, false, target.premultiply );
+        std::vector<unsigned char> converted;
+        transfer.convert( data, width_v * height_v, converted );
+
+        texture_units::current().edit( target );
+        gl::PixelStorei( gl::UNPACK_ALIGNMENT, 1 );
+        gl::TexImage2D( target.target,
+                        0,
+                        target.image_format,
+                        width_v,
+                        height_v,
+                        0,
+                        transfer.format(),
+                        transfer.type(),
+                        &converted[0] );
+        gl::PixelStorei( gl::UNPACK_ALIGNMENT, 4 );
+        if ( mip_levels_v > 0 ) {
+            gl::GenerateMipmap( target.target );
+        }
+    }
+    /**
+     * \brief Upload the packed image to one layer of a texture array.
+     *
+     * If the array has no storage yet it is allocated at the atlas's
+     * dimensions with as many layers as the texture was configured with;
+     * otherwise the array must already match the atlas's dimensions.
+     * \param target The texture array to upload to
+     * \param layer The layer to fill
+     */
+    void    texture_atlas::build( texture_2D& target,
+                                  size_t const layer ) const
+    {
+        if ( not video_system::get().context_present() ) {
+            throw std::logic_error( "No OpenGL context available to load texture atlas to." );
+        }
+        if ( target.target != gl::TEXTURE_2D_ARRAY ) {
+            throw std::invalid_argument( "Texture atlas layers can only be built into a texture array." );
+        }
+        if ( layer >= target.layers_v ) {
+            throw std::out_of_range( "Texture array layer out of range." );
+        }
+        pixel_transfer transfer ( target.image_format, channels_v, false, target.premultiply );
+        std::vector<unsigned char> converted;
+        transfer.convert( data, width_v * height_v, converted );
+
+        texture_units::current().edit( target );
+        gl::PixelStorei( gl::UNPACK_ALIGNMENT, 1 );
+
+        GLint allocated = 0;
+        gl::GetTexLevelParameteriv( target.target, 0, gl::TEXTURE_WIDTH, &allocated );
+        if ( allocated == 0 ) {
+            gl::TexImage3D( target.target,
+                            0,
+                            target.image_format,
+                            width_v,
+                            height_v,
+                            target.layers_v,
+                            0,
+                            transfer.format(),
+                            transfer.type(),
+                            0 );
+            target.width_v = width_v;
+            target.height_v = height_v;
+            target.pixels_v = width_v * height_v;
+            target.pixel_bits_v = channels_v * 8;
+        } else if ( size_t( allocated ) != width_v ) {
+            gl::PixelStorei( gl::UNPACK_ALIGNMENT, 4 );
+            throw std::invalid_argument( "Texture array dimensions do not match the texture atlas." );
+        }
+        gl::TexSubImage3D( target.target,
+                           0,
+                           0, 0, layer,
+                           width_v, height_v, 1,
+                           transfer.format(),
+                           transfer.type(),
+                           &converted[0] );
+        gl::PixelStorei( gl::UNPACK_ALIGNMENT, 4 );
+        if ( mip_levels_v > 0 ) {
+            gl::GenerateMipmap( target.target );
+        }
+    }
+    /**
+     * \brief Rewrite a mesh's texture coordinates into a packed region.
+     *
+     * Coordinates in [0,1] are mapped onto the region's rectangle in the
+     * atlas. Only the client side copy is changed; the buffer must be
+     * uploaded again afterwards.
+     * \param mesh The buffer holding the mesh
+     * \param uv_index The attribute index of the texture coordinates,
+     * which must be a vec2
+     * \param index The region to map into
+     */
+    void    texture_atlas::remap( buffer& mesh,
+                                  GLuint const uv_index,
+                                  size_t const index ) const
+    {
+        region const& packed = (*this)[index];
+        if ( not mesh.verts_specified or uv_index >= mesh.attributes->size() ) {
+            throw std::out_of_range( "Texture coordinate attribute index out of range." );
+        }
+        if ( (*(*mesh.attributes)[uv_index]) != type<vec2>() ) {
+            throw std::invalid_argument( "Texture coordinate attribute must be a vec2." );
+        }
+        if ( mesh.data == 0 ) {
+            throw std::logic_error( "Buffer data not initialized." );
+        }
+        float u_scale = packed.uv_max[0] - packed.uv_min[0];
+        float v_scale = packed.uv_max[1] - packed.uv_min[1];
+        float u_offset = packed.uv_min[0];
+        float v_offset = packed.uv_min[1];
+
+        unsigned char* cursor = mesh.data + mesh.attribute_offset( uv_index );
+        GLfloat uv[2];
+        for ( GLsizeiptr block = 0; block < mesh.n_blocks; ++block ) {
+            std::memcpy( uv, cursor, sizeof( uv ) );
+            uv[0] = u_offset + uv[0] * u_scale;
+            uv[1] = v_offset + uv[1] * v_scale;
+            std::memcpy( cursor, uv, sizeof( uv ) );
+            cursor += mesh.stride;
+        }
+        mesh.data_loaded = false;
+    }
+    /**
+     * \brief Map a single texture coordinate into a packed region.
+     * \param uv The coordinate relative to the original image
+     * \param index The region to map into
+     * \return The coordinate in the atlas
+     */
+    vec2    texture_atlas::remap( vec2 const& uv,
+                                  size_t const index ) const
+    {
+        region const& packed = (*this)[index];
+        return packed.uv_min + uv * ( packed.uv_max - packed.uv_min );
+    }
+    /**
+     * \brief Round a length up to the mipmap alignment block.
+     * \param texels The length in texels
+     * \return The aligned length
+     */
+    size_t  texture_atlas::aligned( size_t const texels ) const
+    {
+        size_t block = size_t(1) << mip_levels_v;
+        return ( ( texels + block - 1 ) / block ) * block;
+    }
+    /**
+     * \brief Test whether a block fits with its left edge on a skyline node.
+     * \param node The skyline node to start at
+     * \param w The width of the block
+     * \param h The height of the block
+     * \param y Set to the lowest height the block can rest at
+     * \return Whether the block fits inside the atlas
+     */
+    bool    texture_atlas::fit( size_t const node,
+                                size_t const w,
+                                size_t const h,
+                                size_t& y ) const
+    {
+        size_t x = skyline[node].x;
+        if ( x + w > width_v ) { return false; }
+        y = skyline[node].y;
+        size_t remaining = w;
+        size_t i = node;
+        while ( remaining > 0 ) {
+            if ( skyline[i].y > y ) { y = skyline[i].y; }
+            if ( y + h > height_v ) { return false; }
+            remaining -= remaining < skyline[i].w ? remaining : skyline[i].w;
+            ++i;
+        }
+        return true;
+    }
+    /**
+     * \brief Raise the skyline over a newly placed block.
+     * \param node The skyline node the block rests on
+     * \param x The left edge of the block
+     * \param y The bottom edge of the block
+     * \param w The width of the block
+     * \param h The height of the block
+     */
+    void    texture_atlas::place( size_t const node,
+                                  size_t const x,
+                                  size_t const y,
+                                  size_t const w,
+                                  size_t const h )
+    {
+        skyline_node raised = { x, y + h, w };
+        skyline.insert( skyline.begin() + node, raised );
+
+        // Trim or remove the nodes now covered by the new one
+        size_t i = node + 1;
+        while ( i < skyline.size() ) {
+            size_t edge = skyline[i-1].x + skyline[i-1].w;
+            if ( skyline[i].x >= edge ) { break; }
+            size_t shrink = edge - skyline[i].x;
+            if ( skyline[i].w <= shrink ) {
+                skyline.erase( skyline.begin() + i );
+            } else {
+                skyline[i].x += shrink;
+                skyline[i].w -= shrink;
+                break;
+            }
+        }
+        // Merge neighbours at the same height
+        i = 0;
+        while ( i + 1 < skyline.size() ) {
+            if ( skyline[i].y == skyline[i+1].y ) {
+                skyline[i].w += skyline[i+1].w;
+                skyline.erase( skyline.begin() + i + 1 );
+            } else {
+                ++i;
+            }
+        }
+    }
+}
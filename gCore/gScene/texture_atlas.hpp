@@ -0,0 +1,216 @@
+#ifndef TEXTURE_ATLAS_HPP
+#define TEXTURE_ATLAS_HPP
+
+#include <vector>
+#include <stdexcept>
+
+#include "../gVideo/gl_core_3_3.hpp"
+#include "../gMath/datatype.hpp"
+#include "../gVideo/video.hpp"
+#include "texture.hpp"
+#include "buffer.hpp"
+
+namespace gfx {
+    /**
+     * \class gfx::texture_atlas texture_atlas.hpp "gCore/gScene/texture_atlas.hpp"
+     * \brief Packs many small images into one two dimensional texture.
+     *
+     * Every small texture bound on its own costs a bind; an atlas packs
+     * them into a single image so a whole batch of sprites or decals can
+     * be drawn with one texture. Images are placed with a skyline
+     * bottom-left packer as they are added. Each one gets a border of
+     * padding that is filled by extruding its edge pixels, so bilinear
+     * filtering never pulls in a neighbour. When mipmapping is requested
+     * every region is also aligned to the block size of the smallest
+     * mip level so regions do not share texels down the chain.
+     *
+     * The packed image lives on the client side until it is handed to
+     * a \ref gfx::texture_2D "texture_2D" with \ref build() "build()".
+     * The \ref region "region" table gives the texel rectangle and
+     * texture coordinates of each image, and \ref remap() "remap()"
+     * rewrites the texture coordinate attribute of a
+     * \ref gfx::buffer "buffer" into the packed region.
+     */
+    class texture_atlas {
+    public:
+
+        class settings {
+        public:
+                            settings();
+            settings&       dimensions( size_t const dw,
+                                        size_t const dh );
+            settings&       channels( size_t const n );
+            settings&       padding( size_t const texels );
+            settings&       mip_safe( size_t const levels );
+        private:
+            size_t          dw_v;
+            size_t          dh_v;
+            size_t          channels_v;
+            size_t          padding_v;
+            size_t          mip_levels_v;
+            friend          class texture_atlas;
+        };
+        /**
+         * \brief The placement of one packed image.
+         *
+         * The texel rectangle excludes the padding; the texture
+         * coordinates are those of the rectangle's edges.
+         */
+        struct region {
+            size_t          x;
+            size_t          y;
+            size_t          w;
+            size_t          h;
+            vec2            uv_min;
+            vec2            uv_max;
+        };
+                            texture_atlas( settings const& set = settings() );
+                            ~texture_atlas();
+        size_t              width() const;
+        size_t              height() const;
+        size_t              regions() const;
+        size_t              used_texels() const;
+        region const&       operator []( size_t const index ) const;
+        size_t              add( unsigned char const* pixels,
+                                 size_t const w,
+                                 size_t const h );
+        size_t              add( texture_2D const& source );
+        void                build( texture_2D& target ) const;
+        void                build( texture_2D& target,
+                                   size_t const layer ) const;
+        void                remap( buffer& mesh,
+                                   GLuint const uv_index,
+                                   size_t const index ) const;
+        vec2                remap( vec2 const& uv,
+                                   size_t const index ) const;
+    private:
+                            texture_atlas( texture_atlas const& );
+        texture_atlas&      operator =( texture_atlas const& );
+
+        struct skyline_node {
+            size_t          x;
+            size_t          y;
+            size_t          w;
+        };
+        typedef std::vector<skyline_node>   skyline_vector;
+        typedef std::vector<region>         region_vector;
+
+        size_t              width_v;
+        size_t              height_v;
+        size_t              channels_v;
+        size_t              padding_v;
+        size_t              mip_levels_v;
+        size_t              used_v;
+        skyline_vector      skyline;
+        region_vector       table;
+        unsigned char*      data;
+
+        size_t              aligned( size_t const texels ) const;
+        bool                fit( size_t const node,
+                                 size_t const w,
+                                 size_t const h,
+                                 size_t& y ) const;
+        void                place( size_t const node,
+                                   size_t const x,
+                                   size_t const y,
+                                   size_t const w,
+                                   size_t const h );
+    };
+    /**
+     * \brief Construct a default \ref gfx::texture_atlas::settings "settings"
+     * object.
+     *
+     * The default atlas is 1024 by 1024 texels with three eight bit
+     * channels, one texel of padding, and no mipmap alignment.
+     */
+    inline  texture_atlas::settings::settings() :
+                                        dw_v ( 1024u ),
+                                        dh_v ( 1024u ),
+                                        channels_v ( 3u ),
+                                        padding_v ( 1u ),
+                                        mip_levels_v ( 0u ) {}
+    /**
+     * \brief Set the dimensions of the packed image in texels.
+     * \param dw The width of the atlas
+     * \param dh The height of the atlas
+     * \return This settings object
+     */
+    inline  texture_atlas::settings&
+    texture_atlas::settings::dimensions( size_t const dw,
+                                         size_t const dh )
+    {
+        dw_v = dw;
+        dh_v = dh;
+        return *this;
+    }
+    /**
+     * \brief Set the number of eight bit channels in each texel.
+     *
+     * Every image added to the atlas must have this many channels.
+     * \param n The number of channels, from one to four
+     * \return This settings object
+     */
+    inline  texture_atlas::settings&
+    texture_atlas::settings::channels( size_t const n )
+    { channels_v = n; return *this; }
+    /**
+     * \brief Set the width of the extruded border around each image.
+     * \param texels The border width in texels
+     * \return This settings object
+     */
+    inline  texture_atlas::settings&
+    texture_atlas::settings::padding( size_t const texels )
+    { padding_v = texels; return *this; }
+    /**
+     * \brief Keep regions separate down to the given mipmap level.
+     *
+     * Regions are aligned to blocks of two to the power of the given
+     * level in texels, and the padding is widened to match, so no texel
+     * of a mip level up to that one mixes two images.
+     * \param levels The number of mipmap levels to protect
+     * \return This settings object
+     */
+    inline  texture_atlas::settings&
+    texture_atlas::settings::mip_safe( size_t const levels )
+    { mip_levels_v = levels; return *this; }
+    /**
+     * \brief Return the width of the atlas.
+     * \return The width of the atlas in texels
+     */
+    inline  size_t  texture_atlas::width() const
+    { return width_v; }
+    /**
+     * \brief Return the height of the atlas.
+     * \return The height of the atlas in texels
+     */
+    inline  size_t  texture_atlas::height() const
+    { return height_v; }
+    /**
+     * \brief Return the number of images packed into the atlas.
+     * \return The number of entries in the region table
+     */
+    inline  size_t  texture_atlas::regions() const
+    { return table.size(); }
+    /**
+     * \brief Return the number of texels covered by packed images,
+     * including their padding.
+     * \return The number of used texels
+     */
+    inline  size_t  texture_atlas::used_texels() const
+    { return used_v; }
+    /**
+     * \brief Look up the placement of a packed image.
+     * \param index The index returned by \ref add() "add()"
+     * \return The region of the packed image
+     */
+    inline  texture_atlas::region const&
+    texture_atlas::operator []( size_t const index ) const
+    {
+        if ( index >= table.size() ) {
+            throw std::out_of_range( "Texture atlas region index out of range." );
+        }
+        return table[index];
+    }
+}
+
+#endif
@@ -0,0 +1,109 @@
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../gVideo/video.hpp"
+#include "texture_atlas.hpp"
+#include "../gMath/datatype.hpp"
+#include "../../UnitTest++_src/UnitTest++.h"
+
+using namespace gfx;
+
+SUITE( TextureAtlasTests )
+{
+    TEST( TextureAtlasCreation )
+    {
+        texture_atlas test_atls ( texture_atlas::settings()
+                                    .dimensions( 64u, 32u )
+                                    .channels( 4u ) );
+        CHECK_EQUAL( 64u, test_atls.width() );
+        CHECK_EQUAL( 32u, test_atls.height() );
+        CHECK_EQUAL( 0u, test_atls.regions() );
+    }
+
+    TEST( TextureAtlasPacking )
+    {
+        texture_atlas test_atls ( texture_atlas::settings()
+                                    .dimensions( 64u, 64u )
+                                    .channels( 1u )
+                                    .padding( 1u ) );
+        std::vector<unsigned char> pixels ( 14u * 14u, 255u );
+
+        size_t i;
+        for ( i = 0; i < 16u; ++i ) {
+            CHECK_EQUAL( i, test_atls.add( &pixels[0], 14u, 14u ) );
+        }
+        CHECK_EQUAL( 64u * 64u, test_atls.used_texels() );
+
+        // No two regions may overlap, padding included
+        size_t j;
+        for ( i = 0; i < test_atls.regions(); ++i ) {
+            texture_atlas::region const& a = test_atls[i];
+            CHECK( a.x + a.w + 1u <= 64u );
+            CHECK( a.y + a.h + 1u <= 64u );
+            for ( j = i + 1; j < test_atls.regions(); ++j ) {
+                texture_atlas::region const& b = test_atls[j];
+                bool apart = a.x + a.w + 1u <= b.x - 1u or
+                             b.x + b.w + 1u <= a.x - 1u or
+                             a.y + a.h + 1u <= b.y - 1u or
+                             b.y + b.h + 1u <= a.y - 1u;
+                CHECK( apart );
+            }
+        }
+
+        std::string excepted ( "Exception not caught." );
+        try {
+            test_atls.add( &pixels[0], 14u, 14u );
+        } catch ( std::out_of_range& e ) {
+            excepted = "Full atlas exception caught.";
+        }
+        CHECK_EQUAL( "Full atlas exception caught.", excepted );
+    }
+
+    TEST( TextureAtlasMipSafe )
+    {
+        texture_atlas test_atls ( texture_atlas::settings()
+                                    .dimensions( 128u, 128u )
+                                    .channels( 3u )
+                                    .mip_safe( 2u ) );
+        std::vector<unsigned char> pixels ( 10u * 5u * 3u, 7u );
+        test_atls.add( &pixels[0], 10u, 5u );
+        test_atls.add( &pixels[0], 10u, 5u );
+
+        // Padding grows to one texel of mip level two, and the padded
+        // block is aligned to four texels.
+        CHECK_EQUAL( 4u, test_atls[0].x );
+        CHECK_EQUAL( 4u, test_atls[0].y );
+        CHECK_EQUAL( 0u, ( test_atls[1].x - 4u ) % 4u );
+        CHECK_EQUAL( 0u, ( test_atls[1].y - 4u ) % 4u );
+    }
+
+    TEST( TextureAtlasRemap )
+    {
+        texture_atlas test_atls ( texture_atlas::settings()
+                                    .dimensions( 32u, 32u )
+                                    .channels( 1u )
+                                    .padding( 0u ) );
+        std::vector<unsigned char> pixels ( 16u * 8u, 1u );
+        size_t index = test_atls.add( &pixels[0], 16u, 8u );
+
+        CHECK_EQUAL( vec2( 0.0f, 0.0f ), test_atls[index].uv_min );
+        CHECK_EQUAL( vec2( 0.5f, 0.25f ), test_atls[index].uv_max );
+        CHECK_EQUAL( vec2( 0.25f, 0.25f ),
+                     test_atls.remap( vec2( 0.5f, 1.0f ), index ) );
+
+        std::string excepted ( "Exception not caught." );
+        try {
+            test_atls[index + 1];
+        } catch ( std::out_of_range& e ) {
+            excepted = "Bad region exception caught.";
+        }
+        CHECK_EQUAL( "Bad region exception caught.", excepted );
+    }
+}
+
+int main( int argc, char** argv )
+{
+    return UnitTest::RunAllTests();
+}
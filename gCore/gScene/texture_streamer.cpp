@@ -0,0 +1,356 @@
+#include "texture_streamer.hpp"
+#include "pixel_convert.hpp"
+#include "texture_units.hpp"
+
+namespace gfx {
+    /**
+     * \brief Construct a new texture streamer with no textures.
+     * \param set The settings for the streamer
+     */
+    texture_streamer::texture_streamer( settings const& set ) :
+                                        entries (),
+                                        budget_v ( set.budget_v ),
+                                        uploads_v ( set.uploads_v ),
+                                        frame ( 0 ),
+                                        resident_bytes_v ( 0 ),
+                                        evictions_v ( 0 ) {}
+    /**
+     * \brief Destruct the texture streamer.
+     *
+     * The textures themselves are left as they are.
+     */
+    texture_streamer::~texture_streamer() {}
+    /**
+     * \brief Hand a texture over to the streamer.
+     *
+     * The texture must have had \ref gfx::texture_2D::decode_file()
+     * "decode_file()" called on it. Its mipmap chain is built on the
+     * client side and the smallest level is uploaded straight away, so
+     * the texture can be sampled as soon as this returns.
+     * \param tex The texture to stream
+     */
+    void    texture_streamer::add( texture_2D& tex )
+    {
+        if ( not video_system::get().context_present() ) {
+            throw std::logic_error( "No OpenGL context available to stream texture to." );
+        }
+        if ( tex.data == 0 ) {
+            throw std::logic_error( "Texture data not initialized." );
+        }
+        if ( tex.target != gl::TEXTURE_2D ) {
+            throw std::invalid_argument( "Only plain two dimensional textures can be streamed." );
+        }
+        size_t channels = tex.pixel_bits_v / 8;
+        if ( channels < 1 or channels > 4 or tex.pixel_bits_v % 8 != 0 ) {
+            throw std::invalid_argument( "Streamed textures must have one to four eight bit channels." );
+        }
+        if ( entries.count( &tex ) != 0 ) {
+            return;
+        }
+
+        stream_entry& entry = entries[&tex];
+        entry.tex = &tex;
+        entry.channels = channels;
+        entry.texel_bytes = pixel_transfer( tex.image_format, channels, false ).texel_bytes();
+        entry.last_used = frame;
+
+        // Level zero is the decoded image in RGB(A) order, premultiplied
+        // before filtering if asked for; each further level is a 2x2 box
+        // filter of the one before, down to a single texel.
+        size_t w = tex.width_v;
+        size_t h = tex.height_v;
+        entry.levels.push_back( level_data( tex.data, tex.data + w * h * channels ) );
+        swap_red_blue( &entry.levels[0][0], w * h, channels );
+        if ( tex.premultiply and channels == 4 ) {
+            if ( tex.image_format == gl::SRGB8_ALPHA8 ) {
+                premultiply_alpha_srgb( &entry.levels[0][0], w * h );
+            } else {
+                premultiply_alpha( &entry.levels[0][0], w * h );
+            }
+        }
+        while ( w > 1 or h > 1 ) {
+            size_t nw = w > 1 ? w / 2 : 1;
+            size_t nh = h > 1 ? h / 2 : 1;
+            level_data const& src = entry.levels.back();
+            level_data dst ( nw * nh * channels );
+            for ( size_t y = 0; y < nh; ++y ) {
+                size_t y0 = y * 2 < h ? y * 2 : h - 1;
+                size_t y1 = y * 2 + 1 < h ? y * 2 + 1 : h - 1;
+                for ( size_t x = 0; x < nw; ++x ) {
+                    size_t x0 = x * 2 < w ? x * 2 : w - 1;
+                    size_t x1 = x * 2 + 1 < w ? x * 2 + 1 : w - 1;
+                    for ( size_t c = 0; c < channels; ++c ) {
+                        unsigned sum = src[( y0 * w + x0 ) * channels + c]
+                                     + src[( y0 * w + x1 ) * channels + c]
+                                     + src[( y1 * w + x0 ) * channels + c]
+                                     + src[( y1 * w + x1 ) * channels + c];
+                        dst[( y * nw + x ) * channels + c] = (unsigned char)( ( sum + 2 ) / 4 );
+                    }
+                }
+            }
+            entry.levels.push_back( dst );
+            w = nw;
+            h = nh;
+        }
+        entry.resident = entry.levels.size();
+        entry.wanted = entry.levels.size() - 1;
+
+        texture_units::current().edit( tex );
+        gl::TexParameteri( tex.target, gl::TEXTURE_MAX_LEVEL, entry.levels.size() - 1 );
+        upload_level( entry );
+    }
+    /**
+     * \brief Stop streaming a texture.
+     *
+     * Whatever levels are resident stay resident, but no longer count
+     * against the budget.
+     * \param tex The texture to stop streaming
+     */
+    void    texture_streamer::remove( texture_2D& tex )
+    {
+        entry_map::iterator found = entries.find( &tex );
+        if ( found == entries.end() ) { return; }
+        stream_entry& entry = found->second;
+        for ( size_t level = entry.resident; level < entry.levels.size(); ++level ) {
+            resident_bytes_v -= level_bytes( entry, level );
+        }
+        entries.erase( found );
+    }
+    /**
+     * \brief Report the finest mipmap level a texture needs this frame.
+     *
+     * This is the feedback that drives streaming; usually it comes from
+     * the screen size of whatever the texture is drawn on. Requesting a
+     * texture also marks it as used for the eviction order.
+     * \param tex The texture
+     * \param lod The finest level wanted; zero is the full image
+     */
+    void    texture_streamer::request( texture_2D& tex, float const lod )
+    {
+        stream_entry& entry = find( tex );
+        size_t coarsest = entry.levels.size() - 1;
+        if ( lod <= 0.0f ) {
+            entry.wanted = 0;
+        } else if ( size_t( lod ) > coarsest ) {
+            entry.wanted = coarsest;
+        } else {
+            entry.wanted = size_t( lod );
+        }
+        entry.last_used = frame;
+    }
+    /**
+     * \brief Upload and evict mipmap levels for this frame.
+     *
+     * First the budget is enforced, then up to the configured number of
+     * levels is uploaded, one level per texture per round so no single
+     * large texture starves the rest. Call this once per frame on the
+     * thread that owns the context.
+     */
+    void    texture_streamer::update()
+    {
+        if ( not video_system::get().context_present() ) {
+            throw std::logic_error( "No OpenGL context available to stream textures to." );
+        }
+        while ( resident_bytes_v > budget_v and evict_level( 0 ) ) {}
+
+        size_t uploads = 0;
+        bool progress = true;
+        while ( uploads < uploads_v and progress ) {
+            progress = false;
+            entry_map::iterator e;
+            for ( e = entries.begin(); e != entries.end() and uploads < uploads_v; ++e ) {
+                stream_entry& entry = e->second;
+                if ( entry.resident <= entry.wanted ) { continue; }
+                size_t bytes = level_bytes( entry, entry.resident - 1 );
+                bool room = true;
+                while ( resident_bytes_v + bytes > budget_v ) {
+                    if ( not evict_level( &entry ) ) {
+                        room = false;
+                        break;
+                    }
+                }
+                if ( not room ) { continue; }
+                upload_level( entry );
+                ++uploads;
+                progress = true;
+            }
+        }
+        ++frame;
+    }
+    /**
+     * \brief Return the finest mipmap level of a texture that is resident.
+     * \param tex The texture
+     * \return The texture's current base level
+     */
+    size_t  texture_streamer::resident_level( texture_2D const& tex ) const
+    { return find( tex ).resident; }
+    /**
+     * \brief Return the number of mipmap levels still waiting to upload.
+     *
+     * A level is pending when a texture has requested it but it, or a
+     * coarser level it depends on, is not yet resident.
+     * \return The number of pending levels
+     */
+    size_t  texture_streamer::pending_loads() const
+    {
+        size_t pending = 0;
+        entry_map::const_iterator e;
+        for ( e = entries.begin(); e != entries.end(); ++e ) {
+            if ( e->second.resident > e->second.wanted ) {
+                pending += e->second.resident - e->second.wanted;
+            }
+        }
+        return pending;
+    }
+    /**
+     * \brief Look up the streaming state of a texture.
+     * \param tex The texture
+     * \return The texture's entry
+     */
+    texture_streamer::stream_entry&
+    texture_streamer::find( texture_2D const& tex )
+    {
+        entry_map::iterator found = entries.find( &tex );
+        if ( found == entries.end() ) {
+            throw std::invalid_argument( "Texture is not being streamed." );
+        }
+        return found->second;
+    }
+    /**
+     * \brief Look up the streaming state of a texture.
+     * \param tex The texture
+     * \return The texture's entry
+     */
+    texture_streamer::stream_entry const&
+    texture_streamer::find( texture_2D const& tex ) const
+    {
+        entry_map::const_iterator found = entries.find( &tex );
+        if ( found == entries.end() ) {
+            throw std::invalid_argument( "Texture is not being streamed." );
+        }
+        return found->second;
+    }
+    /**
+     * \brief Return the width of one mipmap level of a texture.
+     */
+    size_t  texture_streamer::level_width( stream_entry const& entry,
+                                           size_t const level ) const
+    {
+        size_t w = entry.tex->width_v >> level;
+        return w > 0 ? w : 1;
+    }
+    /**
+     * \brief Return the height of one mipmap level of a texture.
+     */
+    size_t  texture_streamer::level_height( stream_entry const& entry,
+                                            size_t const level ) const
+    {
+        size_t h = entry.tex->height_v >> level;
+        return h > 0 ? h : 1;
+    }
+    /**
+     * \brief Return the size of one mipmap level of a texture as uploaded.
+     *
+     * The level is kept with eight bits a channel, but it is converted to
+     * the texture's format on the way up: RGB is widened to RGBA for eight
+     * bit formats, and sixteen bit and float formats take two or four
+     * bytes a channel.
+     */
+    size_t  texture_streamer::level_bytes( stream_entry const& entry,
+                                           size_t const level ) const
+    { return level_width( entry, level ) * level_height( entry, level ) * entry.texel_bytes; }
+    /**
+     * \brief Upload the next finer mipmap level of a texture.
+     * \param entry The texture's entry
+     */
+    void    texture_streamer::upload_level( stream_entry& entry )
+    {
+        size_t level = entry.resident - 1;
+        texture_2D& tex = *entry.tex;
+        pixel_transfer transfer ( tex.image_format, entry.channels, false );
+        std::vector<unsigned char> converted;
+        transfer.convert( &entry.levels[level][0],
+                          level_width( entry, level ) * level_height( entry, level ),
+                          converted );
+
+        texture_units::current().edit( tex );
+        gl::PixelStorei( gl::UNPACK_ALIGNMENT, 1 );
+        gl::TexImage2D( tex.target,
+                        level,
+                        tex.image_format,
+                        level_width( entry, level ),
+                        level_height( entry, level ),
+                        0,
+                        transfer.format(),
+                        transfer.type(),
+                        &converted[0] );
+        gl::PixelStorei( gl::UNPACK_ALIGNMENT, 4 );
+        entry.resident = level;
+        resident_bytes_v += level_bytes( entry, level );
+        clamp( entry );
+    }
+    /**
+     * \brief Release the finest resident level of the best eviction
+     * candidate.
+     *
+     * Levels finer than a texture currently wants go first; after that,
+     * the least recently requested texture that was not requested this
+     * frame loses its finest level.
+     * \param keep A texture that must not be evicted from, or null
+     * \return Whether a level was released
+     */
+    bool    texture_streamer::evict_level( stream_entry const* keep )
+    {
+        stream_entry* victim = 0;
+        bool victim_unwanted = false;
+        entry_map::iterator e;
+        for ( e = entries.begin(); e != entries.end(); ++e ) {
+            stream_entry& entry = e->second;
+            if ( &entry == keep ) { continue; }
+            if ( entry.resident + 1 >= entry.levels.size() ) { continue; }
+            bool unwanted = entry.resident < entry.wanted;
+            if ( not unwanted and entry.last_used >= frame ) { continue; }
+            if ( victim == 0 or
+                 ( unwanted and not victim_unwanted ) or
+                 ( unwanted == victim_unwanted and entry.last_used < victim->last_used ) ) {
+                victim = &entry;
+                victim_unwanted = unwanted;
+            }
+        }
+        if ( victim == 0 ) { return false; }
+
+        size_t level = victim->resident;
+        texture_2D& tex = *victim->tex;
+        victim->resident = level + 1;
+        clamp( *victim );
+        // Respecifying the level as empty gives its storage back; it is
+        // below the base level now, so the texture stays complete.
+        gl::TexImage2D( tex.target,
+                        level,
+                        tex.image_format,
+                        0,
+                        0,
+                        0,
+                        gl::RED,
+                        gl::UNSIGNED_BYTE,
+                        0 );
+        resident_bytes_v -= level_bytes( *victim, level );
+        ++evictions_v;
+        return true;
+    }
+    /**
+     * \brief Clamp sampling of a texture to its resident levels.
+     *
+     * Only the base level moves; the minimum and maximum level of detail
+     * set through \ref gfx::texture_2D::settings::sample_range()
+     * "sample_range()" are relative to the base level, so they keep
+     * working on top of the clamp.
+     * \param entry The texture's entry
+     */
+    void    texture_streamer::clamp( stream_entry& entry )
+    {
+        texture_2D& tex = *entry.tex;
+        texture_units::current().edit( tex );
+        gl::TexParameteri( tex.target, gl::TEXTURE_BASE_LEVEL, entry.resident );
+    }
+}
@@ -0,0 +1,145 @@
+#ifndef TEXTURE_STREAMER_HPP
+#define TEXTURE_STREAMER_HPP
+
+#include <map>
+#include <vector>
+#include <stdexcept>
+
+#include "../gVideo/gl_core_3_3.hpp"
+#include "../gVideo/video.hpp"
+#include "texture.hpp"
+
+namespace gfx {
+    /**
+     * \class gfx::texture_streamer texture_streamer.hpp "gCore/gScene/texture_streamer.hpp"
+     * \brief Keeps the mipmap levels of many textures resident on demand.
+     *
+     * Textures handed to the streamer have their full mipmap chain built
+     * on the client side, but only the smallest level is uploaded at
+     * first. Each frame the renderer reports the finest level it wants
+     * for a texture with \ref request() "request()"; \ref update()
+     * "update()" then uploads finer levels one at a time, coarse to fine.
+     *
+     * Residency is expressed through the texture's base level: levels
+     * finer than the base are released, so sampling never touches them.
+     * When the resident bytes go over the budget the least recently
+     * requested textures lose their finest level first. The smallest
+     * level of every texture is never evicted.
+     */
+    class texture_streamer {
+    public:
+
+        class settings {
+        public:
+                            settings();
+            settings&       budget( size_t const bytes );
+            settings&       uploads_per_update( size_t const levels );
+        private:
+            size_t          budget_v;
+            size_t          uploads_v;
+            friend          class texture_streamer;
+        };
+                            texture_streamer( settings const& set = settings() );
+                            ~texture_streamer();
+        void                add( texture_2D& tex );
+        void                remove( texture_2D& tex );
+        void                request( texture_2D& tex, float const lod );
+        void                update();
+        size_t              resident_level( texture_2D const& tex ) const;
+        size_t              budget() const;
+        void                budget( size_t const bytes );
+        size_t              resident_bytes() const;
+        size_t              pending_loads() const;
+        size_t              evictions() const;
+    private:
+                            texture_streamer( texture_streamer const& );
+        texture_streamer&   operator =( texture_streamer const& );
+
+        typedef std::vector<unsigned char>  level_data;
+        struct stream_entry {
+            texture_2D*                 tex;
+            std::vector<level_data>     levels;
+            size_t                      channels;
+            size_t                      texel_bytes;
+            size_t                      resident;
+            size_t                      wanted;
+            size_t                      last_used;
+        };
+        typedef std::map<texture_2D const*, stream_entry>   entry_map;
+
+        entry_map           entries;
+        size_t              budget_v;
+        size_t              uploads_v;
+        size_t              frame;
+        size_t              resident_bytes_v;
+        size_t              evictions_v;
+
+        stream_entry&       find( texture_2D const& tex );
+        stream_entry const& find( texture_2D const& tex ) const;
+        size_t              level_width( stream_entry const& entry,
+                                         size_t const level ) const;
+        size_t              level_height( stream_entry const& entry,
+                                          size_t const level ) const;
+        size_t              level_bytes( stream_entry const& entry,
+                                         size_t const level ) const;
+        void                upload_level( stream_entry& entry );
+        bool                evict_level( stream_entry const* keep );
+        void                clamp( stream_entry& entry );
+    };
+    /**
+     * \brief Construct a default \ref gfx::texture_streamer::settings
+     * "settings" object.
+     *
+     * The default budget is 256 megabytes, with four mipmap levels
+     * uploaded per update.
+     */
+    inline  texture_streamer::settings::settings() :
+                                        budget_v ( 256u * 1024u * 1024u ),
+                                        uploads_v ( 4u ) {}
+    /**
+     * \brief Set the number of bytes of texture memory the streamer may use.
+     * \param bytes The budget in bytes
+     * \return This settings object
+     */
+    inline  texture_streamer::settings&
+    texture_streamer::settings::budget( size_t const bytes )
+    { budget_v = bytes; return *this; }
+    /**
+     * \brief Set how many mipmap levels may be uploaded in one update.
+     * \param levels The number of levels
+     * \return This settings object
+     */
+    inline  texture_streamer::settings&
+    texture_streamer::settings::uploads_per_update( size_t const levels )
+    { uploads_v = levels; return *this; }
+    /**
+     * \brief Return the streamer's memory budget.
+     * \return The budget in bytes
+     */
+    inline  size_t  texture_streamer::budget() const
+    { return budget_v; }
+    /**
+     * \brief Change the streamer's memory budget.
+     *
+     * Going under the current residency takes effect at the next
+     * \ref update() "update()".
+     * \param bytes The budget in bytes
+     */
+    inline  void    texture_streamer::budget( size_t const bytes )
+    { budget_v = bytes; }
+    /**
+     * \brief Return the number of bytes of mipmap data currently resident,
+     * counted in the format they were uploaded in.
+     * \return The resident bytes
+     */
+    inline  size_t  texture_streamer::resident_bytes() const
+    { return resident_bytes_v; }
+    /**
+     * \brief Return the number of mipmap levels evicted so far.
+     * \return The number of evictions
+     */
+    inline  size_t  texture_streamer::evictions() const
+    { return evictions_v; }
+}
+
+#endif
@@ -0,0 +1,140 @@
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "../gVideo/video.hpp"
+#include "texture.hpp"
+#include "texture_streamer.hpp"
+#include "../../UnitTest++_src/UnitTest++.h"
+
+using namespace gfx;
+
+SUITE( TextureStreamerTests )
+{
+    TEST( TextureStreamerNoContext )
+    {
+        texture_streamer test_strm;
+        CHECK_EQUAL( 0u, test_strm.resident_bytes() );
+        CHECK_EQUAL( 0u, test_strm.pending_loads() );
+        CHECK_EQUAL( 0u, test_strm.evictions() );
+
+        std::string excepted ( "Exception not caught." );
+        try {
+            test_strm.update();
+        } catch ( std::logic_error& e ) {
+            excepted = "Lack of context exception caught.";
+        }
+        CHECK_EQUAL( "Lack of context exception caught.", excepted );
+    }
+
+    TEST( TextureStreamerResidency )
+    {
+        window test_wndw ( window::settings()
+                            .has_3D()         );
+        context test_cntx ( test_wndw );
+
+        texture_2D test_txtr ( texture_2D::settings()
+                                .dimensions( 128u, 128u )
+                                .unsigned_norm_3( eight_bit )
+                                .sample_minification( linear_mipmap )
+                                .file( "./tex/test_2D.png" ) );
+        test_txtr.decode_file();
+
+        texture_streamer test_strm ( texture_streamer::settings()
+                                        .uploads_per_update( 2u ) );
+        test_strm.add( test_txtr );
+
+        // Only the single texel level is resident after adding, widened
+        // to RGBA for the upload
+        CHECK_EQUAL( 7u, test_strm.resident_level( test_txtr ) );
+        CHECK_EQUAL( 4u, test_strm.resident_bytes() );
+        CHECK_EQUAL( 0u, test_strm.pending_loads() );
+
+        test_strm.request( test_txtr, 0.0f );
+        CHECK_EQUAL( 7u, test_strm.pending_loads() );
+        test_strm.update();
+        CHECK_EQUAL( 5u, test_strm.resident_level( test_txtr ) );
+        CHECK_EQUAL( 5u, test_strm.pending_loads() );
+    }
+
+    TEST( TextureStreamerBudget )
+    {
+        window test_wndw ( window::settings()
+                            .has_3D()         );
+        context test_cntx ( test_wndw );
+
+        texture_2D near_txtr ( texture_2D::settings()
+                                .dimensions( 128u, 128u )
+                                .unsigned_norm_3( eight_bit )
+                                .file( "./tex/test_2D.png" ) );
+        texture_2D far_txtr ( texture_2D::settings()
+                                .dimensions( 128u, 128u )
+                                .unsigned_norm_3( eight_bit )
+                                .file( "./tex/test_2D.png" ) );
+        near_txtr.decode_file();
+        far_txtr.decode_file();
+
+        // Enough for one full chain, widened to RGBA, and the tail of another
+        texture_streamer test_strm ( texture_streamer::settings()
+                                        .budget( 95000u )
+                                        .uploads_per_update( 16u ) );
+        test_strm.add( near_txtr );
+        test_strm.add( far_txtr );
+
+        test_strm.request( far_txtr, 0.0f );
+        test_strm.update();
+        CHECK_EQUAL( 0u, test_strm.resident_level( far_txtr ) );
+
+        test_strm.request( near_txtr, 0.0f );
+        test_strm.update();
+        CHECK_EQUAL( 0u, test_strm.resident_level( near_txtr ) );
+        CHECK( test_strm.resident_level( far_txtr ) > 0u );
+        CHECK( test_strm.evictions() > 0u );
+        CHECK( test_strm.resident_bytes() <= test_strm.budget() );
+    }
+
+    TEST( TextureStreamerCountsUploadedBytes )
+    {
+        window test_wndw ( window::settings()
+                            .has_3D()         );
+        context test_cntx ( test_wndw );
+
+        // Eight bit channels decoded, half floats uploaded
+        texture_2D half_txtr ( texture_2D::settings()
+                                .dimensions( 128u, 128u )
+                                .floating_point_3( sixteen_bit )
+                                .file( "./tex/test_2D.png" ) );
+        half_txtr.decode_file();
+
+        texture_streamer test_strm ( texture_streamer::settings()
+                                        .uploads_per_update( 16u ) );
+        test_strm.add( half_txtr );
+        CHECK_EQUAL( 6u, test_strm.resident_bytes() );
+
+        test_strm.request( half_txtr, 0.0f );
+        test_strm.update();
+        CHECK_EQUAL( 0u, test_strm.resident_level( half_txtr ) );
+        // 128x128 down to 1x1 is 21845 texels
+        CHECK_EQUAL( 21845u * 6u, test_strm.resident_bytes() );
+
+        // The budget holds back levels by their uploaded size
+        texture_2D tight_txtr ( texture_2D::settings()
+                                 .dimensions( 128u, 128u )
+                                 .floating_point_3( sixteen_bit )
+                                 .file( "./tex/test_2D.png" ) );
+        tight_txtr.decode_file();
+        texture_streamer tight_strm ( texture_streamer::settings()
+                                         .budget( 21845u * 3u )
+                                         .uploads_per_update( 16u ) );
+        tight_strm.add( tight_txtr );
+        tight_strm.request( tight_txtr, 0.0f );
+        tight_strm.update();
+        CHECK( tight_strm.resident_level( tight_txtr ) > 0u );
+        CHECK( tight_strm.resident_bytes() <= tight_strm.budget() );
+    }
+}
+
+int main( int argc, char** argv )
+{
+    return UnitTest::RunAllTests();
+}
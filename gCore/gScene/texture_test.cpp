@@ -138,6 +138,90 @@ SUITE( Texture2DTests )
     }
 }
 
+SUITE( SamplerTests )
+{
+    TEST( SamplerSharing )
+    {
+        window test_wndw ( window::settings()
+                            .has_3D()         );
+        context test_cntx ( test_wndw );
+        
+        size_t before = sampler::shared();
+        {
+            texture_2D first_txtr ( texture_2D::settings()
+                                    .dimensions( 16u, 16u )
+                                    .unsigned_norm_3( eight_bit )
+                                    .sample_minification( linear ) );
+            texture_2D second_txtr ( texture_2D::settings()
+                                     .dimensions( 32u, 32u )
+                                     .unsigned_norm_3( eight_bit )
+                                     .sample_minification( linear ) );
+            CHECK_EQUAL( before + 1u, sampler::shared() );
+            
+            texture_2D third_txtr ( texture_2D::settings()
+                                    .dimensions( 16u, 16u )
+                                    .unsigned_norm_3( eight_bit )
+                                    .wrap_s( repeat ) );
+            CHECK_EQUAL( before + 2u, sampler::shared() );
+            
+            third_txtr.sampling( sampler::settings()
+                                 .sample_minification( linear ) );
+            CHECK_EQUAL( before + 1u, sampler::shared() );
+        }
+        CHECK_EQUAL( before, sampler::shared() );
+    }
+    
+    TEST( SamplerChangesInPlace )
+    {
+        window test_wndw ( window::settings()
+                            .has_3D()         );
+        context test_cntx ( test_wndw );
+        
+        size_t before = sampler::shared();
+        {
+            texture_2D first_txtr ( texture_2D::settings()
+                                    .dimensions( 16u, 16u )
+                                    .unsigned_norm_3( eight_bit )
+                                    .wrap_s( repeat ) );
+            texture_2D second_txtr ( texture_2D::settings()
+                                     .dimensions( 32u, 32u )
+                                     .unsigned_norm_3( eight_bit )
+                                     .wrap_s( repeat ) );
+            
+            // Both textures follow the one sampler they share
+            sampler& group = sampler::acquire( sampler::settings()
+                                               .wrap_s( repeat ) );
+            GLuint const group_ID = group.ID();
+            group.change( sampler::settings()
+                          .wrap_s( repeat )
+                          .sample_minification( linear )
+                          .sample_magnification( linear ) );
+            CHECK_EQUAL( group_ID, group.ID() );
+            CHECK( group.state() == sampler::settings()
+                                    .wrap_s( repeat )
+                                    .sample_minification( linear )
+                                    .sample_magnification( linear ) );
+            CHECK_EQUAL( before + 1u, sampler::shared() );
+            CHECK_EQUAL( &group, &sampler::acquire( group.state() ) );
+            sampler::release( group );
+            sampler::release( group );
+            
+            // A sampler changed to settings another already has stays with
+            // its textures, but is no longer handed out
+            texture_2D third_txtr ( texture_2D::settings()
+                                    .dimensions( 16u, 16u )
+                                    .unsigned_norm_3( eight_bit ) );
+            sampler& plain = sampler::acquire( sampler::settings() );
+            plain.change( group.state() );
+            CHECK_EQUAL( before + 1u, sampler::shared() );
+            CHECK( &plain != &sampler::acquire( group.state() ) );
+            sampler::release( group );
+            sampler::release( plain );
+        }
+        CHECK_EQUAL( before, sampler::shared() );
+    }
+}
+
 int main( int argc, char** argv )
 {
     video_system::get().initialize( video_system::settings() );
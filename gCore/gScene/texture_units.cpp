@@ -0,0 +1,393 @@
+#include "texture_units.hpp"
+
+namespace gfx {
+    /**
+     * \brief Return the texture units of the active context.
+     *
+     * The first call in a context queries how many units it has and sets
+     * up an empty shadow for them.
+     * \return The texture units of the active context
+     * \exception std::logic_error If there is no active context
+     */
+    texture_units&  texture_units::current()
+    {
+        if ( not video_system::get().context_present() ) {
+            throw std::logic_error( "No OpenGL context available to bind textures in." );
+        }
+        size_t serial = video_system::get().get_active_context().serial();
+        context_map& units = contexts();
+        context_map::iterator found = units.find( serial );
+        if ( found == units.end() ) {
+            found = units.insert( std::make_pair( serial,
+                                                  new texture_units() ) ).first;
+        }
+        return *(found->second);
+    }
+    /**
+     * \brief Drop a texture from the shadow of every context.
+     *
+     * Deleting a texture unbinds it, and its name may be handed out again,
+     * so the shadow must not go on believing it is bound.
+     * \param tex_ID The OpenGL name of the deleted texture
+     */
+    void    texture_units::forget_texture( GLuint const tex_ID )
+    {
+        context_map& units = contexts();
+        for ( context_map::iterator it = units.begin();
+              it != units.end(); ++it ) {
+            std::vector<unit_state>& bound = it->second->bound;
+            for ( size_t i = 0; i < bound.size(); ++i ) {
+                if ( bound[i].tex_ID == tex_ID ) {
+                    bound[i].tex_ID = 0;
+                }
+            }
+        }
+    }
+    /**
+     * \brief Drop a sampler from the shadow of every context.
+     * \param smplr_ID The OpenGL name of the deleted sampler
+     */
+    void    texture_units::forget_sampler( GLuint const smplr_ID )
+    {
+        context_map& units = contexts();
+        for ( context_map::iterator it = units.begin();
+              it != units.end(); ++it ) {
+            std::vector<unit_state>& bound = it->second->bound;
+            for ( size_t i = 0; i < bound.size(); ++i ) {
+                if ( bound[i].smplr_ID == smplr_ID ) {
+                    bound[i].smplr_ID = 0;
+                }
+            }
+        }
+    }
+    /**
+     * \brief Bind a one dimensional texture to the given unit.
+     * \param unit The texture unit, counted from zero
+     * \param tex The texture to bind
+     * \exception std::out_of_range If the unit does not exist
+     */
+    void    texture_units::bind( GLuint const unit,
+                                 texture_1D const& tex )
+    { bind( unit, tex.tex_ID, tex.target, tex.smplr ); }
+    /**
+     * \brief Bind a two dimensional texture to the given unit.
+     * \param unit The texture unit, counted from zero
+     * \param tex The texture to bind
+     * \exception std::out_of_range If the unit does not exist
+     */
+    void    texture_units::bind( GLuint const unit,
+                                 texture_2D const& tex )
+    { bind( unit, tex.tex_ID, tex.target, tex.smplr ); }
+    /**
+     * \brief Bind a one dimensional texture so it can be modified.
+     * \param tex The texture to bind
+     */
+    void    texture_units::edit( texture_1D const& tex )
+    { edit( tex.tex_ID, tex.target ); }
+    /**
+     * \brief Bind a two dimensional texture so it can be modified.
+     * \param tex The texture to bind
+     */
+    void    texture_units::edit( texture_2D const& tex )
+    { edit( tex.tex_ID, tex.target ); }
+    /**
+     * \brief Give a one dimensional texture a unit for the current draw.
+     * \param tex The texture to bind
+     * \return The unit the texture is bound to
+     * \exception std::out_of_range If every unit is already taken this draw
+     */
+    GLuint  texture_units::assign( texture_1D const& tex )
+    { return assign( tex.tex_ID, tex.target, tex.smplr ); }
+    /**
+     * \brief Give a two dimensional texture a unit for the current draw.
+     * \param tex The texture to bind
+     * \return The unit the texture is bound to
+     * \exception std::out_of_range If every unit is already taken this draw
+     */
+    GLuint  texture_units::assign( texture_2D const& tex )
+    { return assign( tex.tex_ID, tex.target, tex.smplr ); }
+    /**
+     * \brief Give a one dimensional texture a unit for the current draw
+     * and point a sampler uniform of the given program at it.
+     *
+     * The program must be in use.
+     * \param tex The texture to bind
+     * \param prgm The program sampling the texture
+     * \param uniform The name of the sampler uniform
+     * \return The unit the texture is bound to
+     */
+    GLuint  texture_units::assign( texture_1D const& tex,
+                                   program& prgm,
+                                   std::string const& uniform )
+    {
+        GLuint unit = assign( tex );
+        prgm.upload_uniform( uniform, (int) unit );
+        return unit;
+    }
+    /**
+     * \brief Give a two dimensional texture a unit for the current draw
+     * and point a sampler uniform of the given program at it.
+     *
+     * The program must be in use.
+     * \param tex The texture to bind
+     * \param prgm The program sampling the texture
+     * \param uniform The name of the sampler uniform
+     * \return The unit the texture is bound to
+     */
+    GLuint  texture_units::assign( texture_2D const& tex,
+                                   program& prgm,
+                                   std::string const& uniform )
+    {
+        GLuint unit = assign( tex );
+        prgm.upload_uniform( uniform, (int) unit );
+        return unit;
+    }
+    /**
+     * \brief Free every unit assignment for the next draw.
+     *
+     * Textures stay bound; if the next draw uses them again they keep their
+     * units and no calls are made.
+     */
+    void    texture_units::begin_draw()
+    {
+        for ( size_t i = 0; i < bound.size(); ++i ) {
+            bound[i].claimed = false;
+        }
+        ++draw;
+    }
+    /**
+     * \brief Start counting binds for a new frame.
+     *
+     * The counts so far become \ref last_frame() "last_frame()" and unit
+     * assignments are freed as by \ref begin_draw() "begin_draw()".
+     */
+    void    texture_units::begin_frame()
+    {
+        prev_frame = this_frame;
+        this_frame = frame_stats();
+        begin_draw();
+    }
+    /**
+     * \brief Forget everything the shadow knows about bound state.
+     *
+     * Every following bind is made for real until the shadow catches up.
+     */
+    void    texture_units::invalidate()
+    {
+        for ( size_t i = 0; i < bound.size(); ++i ) {
+            bound[i].tex_ID = 0;
+            bound[i].target = 0;
+            bound[i].smplr_ID = 0;
+        }
+        active_unit = GLuint( -1 );
+    }
+    /**
+     * \brief Compare the shadow against the bindings OpenGL reports.
+     *
+     * Units the shadow has not seen bound are not compared. The active
+     * unit is put back afterwards.
+     * \exception std::logic_error If the shadow and OpenGL disagree
+     */
+    void    texture_units::verify() const
+    {
+        GLint active = 0;
+        gl::GetIntegerv( gl::ACTIVE_TEXTURE, &active );
+        if ( active_unit != GLuint( -1 ) and
+             GLuint( active ) != gl::TEXTURE0 + active_unit ) {
+            throw std::logic_error( "Texture unit shadow out of step with OpenGL: active unit." );
+        }
+        std::string mismatch;
+        for ( size_t i = 0; i < bound.size() and mismatch.empty(); ++i ) {
+            GLenum binding = 0;
+            switch ( bound[i].target ) {
+            case gl::TEXTURE_1D :       binding = gl::TEXTURE_BINDING_1D; break;
+            case gl::TEXTURE_2D :       binding = gl::TEXTURE_BINDING_2D; break;
+            case gl::TEXTURE_1D_ARRAY : binding = gl::TEXTURE_BINDING_1D_ARRAY; break;
+            case gl::TEXTURE_2D_ARRAY : binding = gl::TEXTURE_BINDING_2D_ARRAY; break;
+            default :                   continue;
+            }
+            GLint value = 0;
+            gl::ActiveTexture( gl::TEXTURE0 + i );
+            gl::GetIntegerv( binding, &value );
+            if ( GLuint( value ) != bound[i].tex_ID ) {
+                mismatch = "texture";
+            }
+            gl::GetIntegerv( gl::SAMPLER_BINDING, &value );
+            if ( GLuint( value ) != bound[i].smplr_ID ) {
+                mismatch = "sampler";
+            }
+        }
+        gl::ActiveTexture( active );
+        if ( not mismatch.empty() ) {
+            throw std::logic_error( "Texture unit shadow out of step with OpenGL: " +
+                                    mismatch + "." );
+        }
+    }
+    /**
+     * \brief Construct the texture units of the active context.
+     */
+    texture_units::texture_units() :
+                                 bound (),
+                                 active_unit ( GLuint( -1 ) ),
+                                 draw ( 0 ),
+                                 this_frame (),
+                                 prev_frame ()
+    {
+        GLint max_units = 0;
+        gl::GetIntegerv( gl::MAX_COMBINED_TEXTURE_IMAGE_UNITS, &max_units );
+        if ( max_units < 1 ) {
+            max_units = 16;
+        }
+        unit_state empty = { 0, 0, 0, false, 0 };
+        bound.assign( max_units, empty );
+    }
+    /**
+     * \brief Return the table of texture units, one entry per context.
+     * \return The texture unit table
+     */
+    texture_units::context_map& texture_units::contexts()
+    {
+        static context_map units;
+        return units;
+    }
+    /**
+     * \brief Bind a texture and its sampler to a unit, skipping any call
+     * the shadow shows to be redundant.
+     * \param unit The texture unit, counted from zero
+     * \param tex_ID The OpenGL name of the texture
+     * \param target The texture's target
+     * \param smplr The texture's sampler, if it has one
+     * \exception std::out_of_range If the unit does not exist
+     */
+    void    texture_units::bind( GLuint const unit,
+                                 GLuint const tex_ID,
+                                 GLenum const target,
+                                 sampler const* smplr )
+    {
+        if ( unit >= bound.size() ) {
+            throw std::out_of_range( "Texture unit exceeds the units available." );
+        }
+        unit_state& state = bound[unit];
+        GLuint smplr_ID = ( smplr == 0 ? 0 : smplr->ID() );
+        if ( state.tex_ID == tex_ID and state.target == target ) {
+            ++this_frame.skipped_binds;
+        } else {
+            if ( active_unit != unit ) {
+                gl::ActiveTexture( gl::TEXTURE0 + unit );
+                active_unit = unit;
+                ++this_frame.unit_switches;
+            }
+            gl::BindTexture( target, tex_ID );
+            state.tex_ID = tex_ID;
+            state.target = target;
+            ++this_frame.texture_binds;
+        }
+        if ( state.smplr_ID != smplr_ID ) {
+            gl::BindSampler( unit, smplr_ID );
+            state.smplr_ID = smplr_ID;
+            ++this_frame.sampler_binds;
+        }
+    }
+    /**
+     * \brief Find a unit for a texture in the current draw and bind it.
+     *
+     * A unit the texture is already bound to is reused. Otherwise the
+     * texture goes to the free unit that has gone longest unclaimed, so
+     * textures used every draw tend to keep their units.
+     * \param tex_ID The OpenGL name of the texture
+     * \param target The texture's target
+     * \param smplr The texture's sampler, if it has one
+     * \return The unit the texture is bound to
+     * \exception std::out_of_range If every unit is already taken this draw
+     */
+    GLuint  texture_units::assign( GLuint const tex_ID,
+                                   GLenum const target,
+                                   sampler const* smplr )
+    {
+        size_t unit = bound.size();
+        for ( size_t i = 0; i < bound.size(); ++i ) {
+            if ( bound[i].tex_ID == tex_ID and bound[i].target == target ) {
+                unit = i;
+                break;
+            }
+        }
+        if ( unit == bound.size() ) {
+            unit = least_recent();
+        }
+        if ( unit == bound.size() ) {
+            throw std::out_of_range( "No free texture unit left for this draw." );
+        }
+        bind( unit, tex_ID, target, smplr );
+        bound[unit].claimed = true;
+        bound[unit].last_claim = draw;
+        return unit;
+    }
+    /**
+     * \brief Bind a texture for modification on the cheapest unit.
+     *
+     * If the texture is bound already, its unit is made active. Otherwise
+     * it replaces whatever is bound to the active unit, so no unit switch
+     * is needed, unless that unit is assigned to the current draw; then
+     * it goes to the free unit that has gone longest unclaimed, as in
+     * \ref assign() "assign()". The unit is not claimed for the draw. The
+     * sampler binding is left alone, since it has no effect on uploads.
+     * \param tex_ID The OpenGL name of the texture
+     * \param target The texture's target
+     * \exception std::out_of_range If the texture is not bound and every
+     * unit is taken this draw
+     */
+    void    texture_units::edit( GLuint const tex_ID,
+                                 GLenum const target )
+    {
+        size_t unit = bound.size();
+        for ( size_t i = 0; i < bound.size(); ++i ) {
+            if ( bound[i].tex_ID == tex_ID and bound[i].target == target ) {
+                unit = i;
+                break;
+            }
+        }
+        if ( unit == bound.size() ) {
+            if ( active_unit < bound.size() and not bound[active_unit].claimed ) {
+                unit = active_unit;
+            } else {
+                unit = least_recent();
+            }
+        }
+        if ( unit == bound.size() ) {
+            throw std::out_of_range( "No free texture unit left to edit a texture on." );
+        }
+        if ( active_unit != unit ) {
+            gl::ActiveTexture( gl::TEXTURE0 + unit );
+            active_unit = GLuint( unit );
+            ++this_frame.unit_switches;
+        }
+        unit_state& state = bound[unit];
+        if ( state.tex_ID == tex_ID and state.target == target ) {
+            ++this_frame.skipped_binds;
+        } else {
+            gl::BindTexture( target, tex_ID );
+            state.tex_ID = tex_ID;
+            state.target = target;
+            ++this_frame.texture_binds;
+        }
+    }
+    /**
+     * \brief Find the unit not assigned to the current draw that has gone
+     * longest unclaimed.
+     * \return The unit, or the number of units if every one is taken
+     */
+    size_t  texture_units::least_recent() const
+    {
+        size_t unit = bound.size();
+        for ( size_t i = 0; i < bound.size(); ++i ) {
+            if ( bound[i].claimed ) {
+                continue;
+            }
+            if ( unit == bound.size() or
+                 bound[i].last_claim < bound[unit].last_claim ) {
+                unit = i;
+            }
+        }
+        return unit;
+    }
+}
@@ -0,0 +1,128 @@
+#ifndef TEXTURE_UNITS_HPP
+#define TEXTURE_UNITS_HPP
+
+#include <map>
+#include <vector>
+#include <string>
+#include <stdexcept>
+
+#include "../gVideo/gl_core_3_3.hpp"
+#include "../gVideo/video.hpp"
+#include "texture.hpp"
+#include "program.hpp"
+
+namespace gfx {
+    /**
+     * \class gfx::texture_units texture_units.hpp "gCore/gScene/texture_units.hpp"
+     * \brief Hands out texture units and skips redundant texture binds.
+     *
+     * Each context has its own texture units, so each context gets its own
+     * texture_units object through \ref current() "current()". It keeps a
+     * shadow copy of which texture and sampler are bound to every unit and
+     * which unit is active, and only calls ActiveTexture(), BindTexture()
+     * and BindSampler() when the shadow says the state actually changes.
+     *
+     * For a draw, \ref assign() "assign()" gives each texture a unit,
+     * reusing the unit it is already bound to if there is one, and can hand
+     * that unit to a program's sampler uniform. \ref begin_draw()
+     * "begin_draw()" frees the assignments (but not the bindings) for the
+     * next draw, and \ref begin_frame() "begin_frame()" rolls the counters
+     * over so the last frame's binds can be read back.
+     *
+     * Binding a texture only to modify it goes through \ref edit() "edit()",
+     * which uses whatever unit is cheapest without disturbing the units
+     * assigned to the current draw. The shadow is only correct if
+     * every texture bind goes through this object; code that binds textures
+     * itself should call \ref invalidate() "invalidate()" afterwards, and
+     * \ref verify() "verify()" can check that nothing has been missed.
+     * The other shadowed bindings live in \ref gfx::gl_state "gl_state".
+     */
+    class texture_units {
+    public:
+        /**
+         * \brief Counts of the binding work done during one frame.
+         */
+        struct frame_stats {
+            size_t          texture_binds;
+            size_t          sampler_binds;
+            size_t          unit_switches;
+            size_t          skipped_binds;
+        };
+
+        static texture_units&   current();
+        static void             forget_texture( GLuint const tex_ID );
+        static void             forget_sampler( GLuint const smplr_ID );
+        size_t                  units() const;
+        void                    bind( GLuint const unit,
+                                      texture_1D const& tex );
+        void                    bind( GLuint const unit,
+                                      texture_2D const& tex );
+        void                    edit( texture_1D const& tex );
+        void                    edit( texture_2D const& tex );
+        GLuint                  assign( texture_1D const& tex );
+        GLuint                  assign( texture_2D const& tex );
+        GLuint                  assign( texture_1D const& tex,
+                                        program& prgm,
+                                        std::string const& uniform );
+        GLuint                  assign( texture_2D const& tex,
+                                        program& prgm,
+                                        std::string const& uniform );
+        void                    begin_draw();
+        void                    begin_frame();
+        void                    invalidate();
+        void                    verify() const;
+        frame_stats const&      stats() const;
+        frame_stats const&      last_frame() const;
+    private:
+        friend                  class light_clusters;
+                                texture_units();
+
+        struct unit_state {
+            GLuint          tex_ID;
+            GLenum          target;
+            GLuint          smplr_ID;
+            bool            claimed;
+            size_t          last_claim;
+        };
+        typedef std::map<size_t, texture_units*>   context_map;
+        static context_map&     contexts();
+
+        std::vector<unit_state> bound;
+        GLuint                  active_unit;
+        size_t                  draw;
+        frame_stats             this_frame;
+        frame_stats             prev_frame;
+
+        void                    bind( GLuint const unit,
+                                      GLuint const tex_ID,
+                                      GLenum const target,
+                                      sampler const* smplr );
+        GLuint                  assign( GLuint const tex_ID,
+                                        GLenum const target,
+                                        sampler const* smplr );
+        void                    edit( GLuint const tex_ID,
+                                      GLenum const target );
+        size_t                  least_recent() const;
+    };
+    /**
+     * \brief Return the number of texture units available in this context.
+     * \return The number of combined texture image units
+     */
+    inline  size_t  texture_units::units() const
+    { return bound.size(); }
+    /**
+     * \brief Return the binding counts for the frame in progress.
+     * \return The counts since the last \ref begin_frame() "begin_frame()"
+     */
+    inline  texture_units::frame_stats const&   texture_units::stats() const
+    { return this_frame; }
+    /**
+     * \brief Return the binding counts for the last finished frame.
+     * \return The counts between the last two calls to \ref begin_frame()
+     * "begin_frame()"
+     */
+    inline  texture_units::frame_stats const&   texture_units::last_frame() const
+    { return prev_frame; }
+}
+
+#endif
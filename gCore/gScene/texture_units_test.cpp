@@ -0,0 +1,107 @@
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "../gVideo/video.hpp"
+#include "texture.hpp"
+#include "texture_units.hpp"
+#include "../../UnitTest++_src/UnitTest++.h"
+
+using namespace gfx;
+
+SUITE( TextureUnitsTests )
+{
+    TEST( TextureUnitsNoContext )
+    {
+        std::string excepted ( "Exception not caught." );
+        try {
+            texture_units::current();
+        } catch ( std::logic_error& e ) {
+            excepted = "Lack of context exception caught.";
+        }
+        CHECK_EQUAL( "Lack of context exception caught.", excepted );
+    }
+
+    TEST( TextureUnitsRedundantBinds )
+    {
+        window test_wndw ( window::settings()
+                            .has_3D()         );
+        context test_cntx ( test_wndw );
+
+        texture_2D test_txtr ( texture_2D::settings()
+                                .dimensions( 16u, 16u )
+                                .unsigned_norm_3( eight_bit ) );
+        texture_units& units = texture_units::current();
+        CHECK( units.units() > 1u );
+
+        units.begin_frame();
+        test_txtr.use();
+        test_txtr.use();
+        test_txtr.use();
+        // The constructor left the texture bound, so nothing is rebound
+        CHECK_EQUAL( 0u, units.stats().texture_binds );
+        CHECK_EQUAL( 3u, units.stats().skipped_binds );
+
+        units.begin_frame();
+        CHECK_EQUAL( 3u, units.last_frame().skipped_binds );
+        CHECK_EQUAL( 0u, units.stats().skipped_binds );
+    }
+
+    TEST( TextureUnitsAssignment )
+    {
+        window test_wndw ( window::settings()
+                            .has_3D()         );
+        context test_cntx ( test_wndw );
+
+        texture_2D first_txtr ( texture_2D::settings()
+                                .dimensions( 16u, 16u )
+                                .unsigned_norm_3( eight_bit ) );
+        texture_2D second_txtr ( texture_2D::settings()
+                                 .dimensions( 16u, 16u )
+                                 .unsigned_norm_3( eight_bit ) );
+        texture_units& units = texture_units::current();
+
+        units.begin_frame();
+        GLuint first_unit = units.assign( first_txtr );
+        GLuint second_unit = units.assign( second_txtr );
+        CHECK( first_unit != second_unit );
+
+        // The next draw finds both textures where it left them
+        units.begin_draw();
+        size_t binds = units.stats().texture_binds;
+        CHECK_EQUAL( second_unit, units.assign( second_txtr ) );
+        CHECK_EQUAL( first_unit, units.assign( first_txtr ) );
+        CHECK_EQUAL( binds, units.stats().texture_binds );
+    }
+
+    TEST( TextureUnitsEditSparesAssigned )
+    {
+        window test_wndw ( window::settings()
+                            .has_3D()         );
+        context test_cntx ( test_wndw );
+
+        texture_2D drawn_txtr ( texture_2D::settings()
+                                .dimensions( 16u, 16u )
+                                .unsigned_norm_3( eight_bit ) );
+        texture_2D edited_txtr ( texture_2D::settings()
+                                 .dimensions( 16u, 16u )
+                                 .unsigned_norm_3( eight_bit ) );
+        texture_units& units = texture_units::current();
+        units.invalidate();
+
+        // The drawn texture's unit is active when the other is edited
+        units.begin_frame();
+        GLuint drawn_unit = units.assign( drawn_txtr );
+        units.edit( edited_txtr );
+        size_t binds = units.stats().texture_binds;
+        CHECK_EQUAL( drawn_unit, units.assign( drawn_txtr ) );
+        CHECK( units.assign( edited_txtr ) != drawn_unit );
+        CHECK_EQUAL( binds, units.stats().texture_binds );
+    }
+}
+
+int main( int argc, char** argv )
+{
+    video_system::get().initialize( video_system::settings() );
+    return UnitTest::RunAllTests();
+}
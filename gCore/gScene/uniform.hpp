@@ -2,6 +2,7 @@
 #define UNIFORM
 
 #include <string>
+#include <vector>
 #include <stdexcept>
 //#include "../gVideo/gfx_exception.hpp"
 #include "program.hpp"
@@ -22,6 +23,65 @@ namespace gfx {
         virtual void    register_uniform() = 0;
         virtual void    upload_uniform() = 0;
     };
+    /**
+     * \class gfx::uniform_cache uniform.hpp "gCore/gScene/uniform.hpp"
+     * \brief Keeps the resolved handles for the fields of a structured
+     * uniform.
+     * 
+     * Lights and cameras are uploaded as structs whose fields are named
+     * like "light.pos". Building those names and looking them up every
+     * frame is wasted work, so the handles are resolved the first time and
+     * reused until the program is relinked or the struct is uploaded under
+     * another name or to another program.
+     */
+    class uniform_cache {
+    public:
+                                uniform_cache();
+        uniform_handle const*   resolve( program const& prgm,
+                                         std::string const& name,
+                                         char const* const* fields,
+                                         size_t const count );
+    private:
+        size_t                  link_serial;
+        std::string             prefix;
+        std::vector<uniform_handle> handles;
+    };
+    /**
+     * \brief Construct an empty uniform cache.
+     */
+    inline  uniform_cache::uniform_cache() :
+                                         link_serial ( 0 ),
+                                         prefix (),
+                                         handles () {}
+    /**
+     * \brief Return the handles for the given fields of a struct uniform.
+     * 
+     * Nothing is looked up if the handles were resolved for the same link
+     * of the program and the same struct name.
+     * \param prgm The program the struct is uploaded to
+     * \param name The name of the struct in the shader source
+     * \param fields The field suffixes, such as ".pos"
+     * \param count The number of fields
+     * \return The handles, in the order of the fields
+     */
+    inline  uniform_handle const*
+    uniform_cache::resolve( program const& prgm,
+                            std::string const& name,
+                            char const* const* fields,
+                            size_t const count )
+    {
+        if ( link_serial != prgm.link_serial() or
+             handles.size() != count or
+             prefix != name ) {
+            link_serial = prgm.link_serial();
+            prefix = name;
+            handles.resize( count );
+            for ( size_t i = 0; i < count; ++i ) {
+                handles[i] = prgm.find_uniform( name + fields[i] );
+            }
+        }
+        return &handles[0];
+    }
     /**
      * \class gfx::uniform uniform.hpp "gCore/gScene/uniform.hpp"
      * \brief An interface for data types that can be uploaded as
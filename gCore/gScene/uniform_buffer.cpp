@@ -1,15 +1,96 @@
 #include "uniform_buffer.hpp"
+#include "gl_state.hpp"
 
 namespace gfx {
-
+    /**
+     * \brief Construct a new uniform buffer.
+     * \param set The settings for the buffer
+     * \exception gfx::version_error If uniform buffers are not supported
+     * \exception std::invalid_argument If the binding point does not exist
+     */
     uniform_buffer::uniform_buffer( settings const& set ) :
-                                    buffer::buffer( set ) 
-    {}
-    
+                                    buffer::buffer( set ),
+                                    block ( set.layout_v ),
+                                    binding_point ( set.binding_v ),
+                                    allocated ( 0 )
+    {
+        if ( video_system::get().get_version() < opengl_3_1 ) {
+            throw version_error( "Uniform buffer cannot be created: video system version insufficient (requires 3.1+).");
+        }
+        GLint max_bindings = 0;
+        gl::GetIntegerv( gl::MAX_UNIFORM_BUFFER_BINDINGS, &max_bindings );
+        if ( binding_point >= GLuint( max_bindings ) ) {
+            throw std::invalid_argument( "Uniform buffer binding point exceeds the binding points available." );
+        }
+        n_blocks = 1;
+        stride = block.size();
+    }
+    /**
+     * \brief Destruct the uniform buffer.
+     */
     uniform_buffer::~uniform_buffer()
     {}
-    
-    void uniform_buffer::align()
-    {}
-
-}
\ No newline at end of file
+    /**
+     * \brief Point the named uniform block of a program at this buffer's
+     * binding point.
+     *
+     * This only has to be done once after the program is linked; the
+     * program keeps reading whatever is bound at the binding point.
+     * \param prgm The program declaring the block
+     * \param block_name The name of the block in the shader source
+     * \exception std::invalid_argument If the program has no such block
+     * \exception std::logic_error If the program's block is larger than
+     * the layout of this buffer
+     */
+    void    uniform_buffer::attach( program const& prgm,
+                                    std::string const& block_name ) const
+    {
+        GLuint block_index = gl::GetUniformBlockIndex( prgm.prog_ID,
+                                                       block_name.c_str() );
+        if ( block_index == gl::INVALID_INDEX ) {
+            throw std::invalid_argument( "Program has no uniform block named " + block_name + "." );
+        }
+        GLint block_size = 0;
+        gl::GetActiveUniformBlockiv( prgm.prog_ID, block_index,
+                                     gl::UNIFORM_BLOCK_DATA_SIZE, &block_size );
+        if ( GLsizeiptr( block_size ) > GLsizeiptr( block.size() ) ) {
+            throw std::logic_error( "Uniform block " + block_name + " is larger than the buffer's layout." );
+        }
+        gl::UniformBlockBinding( prgm.prog_ID, block_index, binding_point );
+    }
+    /**
+     * \brief Upload the contents of the block if they have changed.
+     *
+     * The first upload allocates the buffer's storage; later ones replace
+     * the data in place.
+     */
+    void    uniform_buffer::upload_data()
+    {
+        if ( data_loaded and not block.dirty() ) {
+            return;
+        }
+        GLsizeiptr bytes = block.size();
+        gl_state::current().bind_buffer( intended_target, buff_ID );
+        if ( allocated != bytes ) {
+            gl::BufferData( intended_target, bytes, block.bytes(), usage );
+            allocated = bytes;
+        } else {
+            gl::BufferSubData( intended_target, 0, bytes, block.bytes() );
+        }
+        stride = bytes;
+        block.clean();
+        data_loaded = true;
+    }
+    /**
+     * \brief Bind the whole buffer to its binding point.
+     * \exception std::logic_error If the data has never been uploaded
+     */
+    void    uniform_buffer::align()
+    {
+        if ( not data_loaded ) {
+            throw std::logic_error( "Uniform buffer data has not been uploaded to OpenGL." );
+        }
+        gl::BindBufferRange( intended_target, binding_point, buff_ID,
+                             0, allocated );
+    }
+}
@@ -1,36 +1,102 @@
 #ifndef UNIFORM_BUFFER_HPP
 #define UNIFORM_BUFFER_HPP
 
+#include <string>
+#include <stdexcept>
+
 #include "buffer.hpp"
+#include "program.hpp"
+#include "std140.hpp"
 
 namespace gfx {
-
+    /**
+     * \class gfx::uniform_buffer uniform_buffer.hpp "gCore/gScene/uniform_buffer.hpp"
+     * \brief A buffer backing a uniform block laid out by the std140 rules.
+     *
+     * The layout is given as a \ref gfx::std140_block "std140_block" and
+     * values are written into \ref contents() "contents()". Blocks shared by
+     * many programs, like the camera or the lights, are written once per
+     * frame and every program sharing them reads the same buffer:
+     * \ref attach() "attach()" points a program's block at this buffer's
+     * binding point and \ref align() "align()" binds the buffer there.
+     *
+     * \ref upload_data() "upload_data()" does nothing unless a write has
+     * changed the contents, and once the buffer has storage it only
+     * replaces the data instead of reallocating it.
+     */
     class uniform_buffer : public buffer {
     public:
         class settings : public buffer::settings {
         public:
-                        settings( buffer::settings const& set
-                                    = buffer::settings() );
-            settings&   use_std140();
-            friend      class uniform_buffer;
+                            settings( buffer::settings const& set
+                                        = buffer::settings() );
+            settings&       layout( std140_block const& lyt );
+            settings&       binding( GLuint const point );
+            friend          class uniform_buffer;
         protected:
-            bool        use_std140_v;
+            std140_block    layout_v;
+            GLuint          binding_v;
         };
-        
-                        uniform_buffer( settings const& set = settings();
-        virtual         ~uniform_buffer();
-        virtual void    align();
-    protected:
-        
 
+                                uniform_buffer( settings const& set = settings() );
+        virtual                 ~uniform_buffer();
+        std140_block&           contents();
+        std140_block const&     contents() const;
+        GLuint                  binding() const;
+        void                    attach( program const& prgm,
+                                        std::string const& block_name ) const;
+        virtual void            upload_data();
+        virtual void            align();
+    protected:
+        std140_block            block;
+        GLuint                  binding_point;
+        GLsizeiptr              allocated;
     };
-
-    uniform_buffer::settings::settings( buffer::settings const& set ) :
-                                            buffer::settings( set ),
-                                            use_std140_v ( false ) {}
-
-    uniform_buffer::settings&   uniform_buffer::settings::use_std140()
-    { use_std140_v = true; }
-
+    /**
+     * \brief Construct a uniform buffer settings object.
+     *
+     * The buffer always uses the uniform buffer target and starts out at
+     * binding point zero with an empty layout.
+     * \param set General buffer settings, such as the usage
+     */
+    inline  uniform_buffer::settings::settings( buffer::settings const& set ) :
+                                                buffer::settings( set ),
+                                                layout_v (),
+                                                binding_v ( 0 )
+    { for_uniform(); }
+    /**
+     * \brief Set the layout of the block the buffer holds.
+     * \param lyt The layout, possibly with initial values written in
+     * \return This settings object
+     */
+    inline  uniform_buffer::settings&
+    uniform_buffer::settings::layout( std140_block const& lyt )
+    { layout_v = lyt; return *this; }
+    /**
+     * \brief Set the uniform buffer binding point the buffer is bound to.
+     * \param point The binding point
+     * \return This settings object
+     */
+    inline  uniform_buffer::settings&
+    uniform_buffer::settings::binding( GLuint const point )
+    { binding_v = point; return *this; }
+    /**
+     * \brief Return the contents of the block, to write values into.
+     * \return The block held by this buffer
+     */
+    inline  std140_block&   uniform_buffer::contents()
+    { return block; }
+    /**
+     * \brief Return the contents of the block.
+     * \return The block held by this buffer
+     */
+    inline  std140_block const&     uniform_buffer::contents() const
+    { return block; }
+    /**
+     * \brief Return the binding point the buffer is bound to.
+     * \return The binding point
+     */
+    inline  GLuint  uniform_buffer::binding() const
+    { return binding_point; }
 }
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,128 @@
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "../gVideo/video.hpp"
+#include "../gMath/datatype.hpp"
+#include "std140.hpp"
+#include "light.hpp"
+#include "camera.hpp"
+#include "uniform_buffer.hpp"
+#include "../../UnitTest++_src/UnitTest++.h"
+
+using namespace gfx;
+
+SUITE( UniformBufferTests )
+{
+    TEST( Std140Offsets )
+    {
+        std140_block test_block;
+        test_block.member<mat4>( "view" )
+                  .member<float>( "f" )
+                  .member<vec2>( "v2" )
+                  .member<vec3>( "v3" )
+                  .member<float>( "arr", 3 )
+                  .member<mat2x3>( "m" )
+                  .member<int>( "n" );
+
+        CHECK_EQUAL( 0u, test_block.offset( "view" ) );
+        CHECK_EQUAL( 64u, test_block.offset( "f" ) );
+        CHECK_EQUAL( 72u, test_block.offset( "v2" ) );
+        CHECK_EQUAL( 80u, test_block.offset( "v3" ) );
+        // Array elements are padded to a vec4
+        CHECK_EQUAL( 96u, test_block.offset( "arr" ) );
+        CHECK_EQUAL( 128u, test_block.offset( "arr", 2 ) );
+        CHECK_EQUAL( 16u, test_block.array_stride( test_block.index( "arr" ) ) );
+        CHECK_EQUAL( 144u, test_block.offset( "m" ) );
+        CHECK_EQUAL( 176u, test_block.offset( "n" ) );
+        CHECK_EQUAL( 192u, test_block.size() );
+    }
+
+    TEST( Std140StructArrays )
+    {
+        std140_block test_block;
+        test_block.member<int>( "count" )
+                  .member( "lights", point_light::layout(), 4 );
+
+        CHECK_EQUAL( 48u, point_light::layout().size() );
+        CHECK_EQUAL( 1u + 4u * 3u, test_block.members() );
+        CHECK_EQUAL( 16u, test_block.offset( "lights[0].rad" ) );
+        CHECK_EQUAL( 32u, test_block.offset( "lights[0].pos" ) );
+        CHECK_EQUAL( 48u, test_block.offset( "lights[0].col" ) );
+        CHECK_EQUAL( 64u, test_block.offset( "lights[1].rad" ) );
+        CHECK_EQUAL( 16u + 4u * 48u, test_block.size() );
+
+        std::string excepted ( "Exception not caught." );
+        try {
+            test_block.index( "lights[4].rad" );
+        } catch ( std::invalid_argument& e ) {
+            excepted = "Unknown member exception caught.";
+        }
+        CHECK_EQUAL( "Unknown member exception caught.", excepted );
+    }
+
+    TEST( Std140Writes )
+    {
+        std140_block test_block;
+        test_block.member<float>( "rad" )
+                  .member( "lights", sphere_light::layout(), 2 );
+        test_block.clean();
+
+        sphere_light test_light ( sphere_light::settings()
+                                  .radiance( 2.0f )
+                                  .position( vec3( 1.0f, 2.0f, 3.0f ) )
+                                  .radius( 0.5f ) );
+        size_t second = test_block.index( "lights[1].rad" );
+        test_light.serialize( test_block, second );
+        CHECK( test_block.dirty() );
+
+        float const* pos = (float const*) ( test_block.bytes() +
+                                            test_block.offset( "lights[1].pos" ) );
+        CHECK_CLOSE( 1.0f, pos[0], 0.00001f );
+        CHECK_CLOSE( 3.0f, pos[2], 0.00001f );
+        float const* rd = (float const*) ( test_block.bytes() +
+                                           test_block.offset( "lights[1].rd" ) );
+        CHECK_CLOSE( 0.5f, *rd, 0.00001f );
+
+        // Writing the same values again leaves the block clean
+        test_block.clean();
+        test_light.serialize( test_block, second );
+        CHECK( not test_block.dirty() );
+
+        std::string excepted ( "Exception not caught." );
+        try {
+            test_block.write( "rad", vec3() );
+        } catch ( std::invalid_argument& e ) {
+            excepted = "Type mismatch exception caught.";
+        }
+        CHECK_EQUAL( "Type mismatch exception caught.", excepted );
+    }
+
+    TEST( UniformBufferUpload )
+    {
+        window test_wndw ( window::settings()
+                            .has_3D()         );
+        context test_cntx ( test_wndw );
+
+        std140_block frame_block;
+        frame_block.member( "cam", camera::layout() );
+        uniform_buffer test_ubo ( uniform_buffer::settings()
+                                  .layout( frame_block )
+                                  .binding( 1 ) );
+        CHECK_EQUAL( 64u, test_ubo.contents().size() );
+        CHECK_EQUAL( 1u, test_ubo.binding() );
+
+        proj_cam test_cam;
+        test_cam.serialize( test_ubo.contents(),
+                            test_ubo.contents().index( "cam.view" ) );
+        test_ubo.upload_data();
+        CHECK( not test_ubo.contents().dirty() );
+        test_ubo.align();
+    }
+}
+
+int main( int argc, char** argv )
+{
+    video_system::get().initialize( video_system::settings() );
+    return UnitTest::RunAllTests();
+}
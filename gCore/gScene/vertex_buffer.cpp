@@ -3,17 +3,24 @@
 namespace gfx {
 
     vertex_buffer::vertex_buffer( settings const& set ) :
-                                    buffer::buffer( set ) 
+                                    buffer::buffer( set ),
+                                    vao_ID ( 0 ),
+                                    aligned_stride ( 0 ),
+                                    aligned_attribs ( 0 ),
+                                    instanced_serial ( 0 )
     { gl::GenVertexArrays( 1, &vao_ID ); }
     
     vertex_buffer::~vertex_buffer()
-    { gl::DeleteVertexArrays( 1, &vao_ID ); }
+    {
+        gl_state::forget_vertex_array( vao_ID );
+        gl::DeleteVertexArrays( 1, &vao_ID );
+    }
     
     void    vertex_buffer::upload_data()
     {
         if( intended_target == gl::ELEMENT_ARRAY_BUFFER ){
-            gl::BindVertexArray( vao_ID );
-            checkGLError( "vao bound for element data load" );
+            gl_state::current().bind_vertex_array( vao_ID );
+            GFX_GL_CHECK( "vao bound for element data load" );
         }
         buffer::upload_data();
     }
@@ -32,11 +39,17 @@ namespace gfx {
             throw std::logic_error( msg );
         }
 
-        std::cout << "Buffer ID: " << buff_ID << std::endl;
-        gl::BindBuffer( gl::ARRAY_BUFFER, buff_ID );
-        checkGLError( "buffer bound to ARRAY_BUFFER" );
-        gl::BindVertexArray( vao_ID );
-        checkGLError( "vao bound for vertex alignment" );
+        gl_state& state = gl_state::current();
+        state.bind_vertex_array( vao_ID );
+        GFX_GL_CHECK( "vao bound for vertex alignment" );
+        // The vertex array keeps its attribute pointers, so they only
+        // need setting when the format changes
+        if ( aligned_stride == stride and
+             aligned_attribs == attributes->size() ) {
+            return;
+        }
+        state.bind_buffer( gl::ARRAY_BUFFER, buff_ID );
+        GFX_GL_CHECK( "buffer bound to ARRAY_BUFFER" );
 
         attrib_vector::iterator a;
         GLuint index = 0;
@@ -52,15 +65,9 @@ namespace gfx {
                                         gl::FALSE_,
                                         stride,
                                         ( void* ) offset );
-                checkGLError( "VertexAttribPointer called" );
-                std::cout << "VertexAttribPointer called." << std::endl;
-                std::cout << "\tindex: " << index << '\n';
-                std::cout << "\tsize: " << (*a)->n_components() << '\n';
-                std::cout << "\ttype: " << (*a)->component_to_GL() << '\n';
-                std::cout << "\tstride: " << stride << '\n';
-                std::cout << "\toffset: " << offset << std::endl;
+                GFX_GL_CHECK( "VertexAttribPointer called" );
                 gl::EnableVertexAttribArray( index );
-                checkGLError( "Enabled Vertex Attribute Array" );
+                GFX_GL_CHECK( "Enabled Vertex Attribute Array" );
                 break;
             case INTEGER :
                 gl::VertexAttribIPointer( index,
@@ -81,6 +88,8 @@ namespace gfx {
             }
             ++index;
         }
+        aligned_stride = stride;
+        aligned_attribs = attributes->size();
     }
 
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 #define VERTEX_BUFFER_HPP
 
 #include "buffer.hpp"
+#include "gl_state.hpp"
 
 namespace gfx {
 
@@ -18,8 +19,21 @@ namespace gfx {
         virtual         ~vertex_buffer();
         virtual void    upload_data();
         virtual void    align();
+        friend          class render_queue;
+        friend          class instance_buffer;
     protected:
         GLuint          vao_ID;
+        /*
+         * The format the vertex array's attribute pointers were last set
+         * up for; the pointers are only set again when it changes.
+         */
+        GLsizeiptr      aligned_stride;
+        size_t          aligned_attribs;
+        /*
+         * The serial of the instance buffer the per-instance attribute
+         * pointers were last set up for, likewise; zero for none.
+         */
+        size_t          instanced_serial;
 
     };
     
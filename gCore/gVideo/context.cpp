@@ -1,5 +1,6 @@
 namespace gfx {
-
+    
+    size_t  context::next_serial = 1;
     /**
      * \brief Construct a new gfx::context targeting the given
      * window with the given settings.
@@ -11,7 +12,10 @@ namespace gfx {
      */
     context::context( window const& window,
                       settings const& set  ) :
-                          target_window( &window )
+                          target_window( &window ),
+                          sys_context ( 0 ),
+                          settings_v ( set ),
+                          serial_v ( next_serial++ )
     {
         if ( not window.has_3D() ) {
             std::string msg = "The creation of a context current in window '";
@@ -24,13 +28,44 @@ namespace gfx {
         SDL_GL_SetAttribute( SDL_GL_DOUBLEBUFFER, doubleBuffered );
 
         SDL_GL_SetAttribute( SDL_GL_DEPTH_SIZE, (int) set.n_depth_bits );
+        // Drivers only report debug messages reliably to debug contexts
+        if ( gl_trace::compiled_level == gl_trace::trace_callback ) {
+            SDL_GL_SetAttribute( SDL_GL_CONTEXT_FLAGS, SDL_GL_CONTEXT_DEBUG_FLAG );
+        }
         
         sys_context = SDL_GL_CreateContext( window.sys_window );
         
         video_system::get().register_context( this );
         video_system::get().activate_context( *this );        
+        gl_trace::attach();
     }
     
+    /**
+     * \brief Construct a gfx::context with no window, for use with the
+     * null OpenGL backend.
+     *
+     * The context becomes the active one like any other, so everything
+     * that needs an active context works, but there is nothing to draw to
+     * and every OpenGL call goes to the \ref gfx::gl_backend "null backend".
+     * Its version is 3.3; its depth bits and double buffering are whatever
+     * the settings ask for.
+     * \param set The settings for the new context
+     * @exception std::logic_error If the null backend is not in use, a
+     * standard logic error is thrown.
+     */
+    context::context( settings const& set ) :
+                          target_window( 0 ),
+                          sys_context ( 0 ),
+                          settings_v ( set ),
+                          serial_v ( next_serial++ )
+    {
+        if ( gl_backend::active() != gl_backend::null_backend ) {
+            throw std::logic_error( "A context without a window needs the null OpenGL backend." );
+        }
+        video_system::get().register_context( this );
+        video_system::get().activate_context( *this );
+        gl_trace::attach();
+    }
     /**
      * \brief Destruct the gfx::context object.
      * \todo Review the 'zombie flag'.
@@ -53,7 +88,9 @@ namespace gfx {
         if ( not video_system::get().zombie ) {
             video_system::get().unregister_context( this );
         }
-        SDL_GL_DeleteContext( sys_context );
+        if ( sys_context != 0 ) {
+            SDL_GL_DeleteContext( sys_context );
+        }
     }
     /**
      * \brief Clear the gfx::context framebuffer to the given
@@ -75,8 +112,10 @@ namespace gfx {
         gl::ClearColor( red, green, blue, alpha );
         gl::Clear( gl::COLOR_BUFFER_BIT );
         
-        int isDoubleBuffered = 0;
-        SDL_GL_GetAttribute( SDL_GL_DOUBLEBUFFER, &isDoubleBuffered );
+        int isDoubleBuffered = ( settings_v.is_double_buffered ? 1 : 0 );
+        if ( target_window != 0 ) {
+            SDL_GL_GetAttribute( SDL_GL_DOUBLEBUFFER, &isDoubleBuffered );
+        }
         if (isDoubleBuffered ) {
             gl::Clear( gl::DEPTH_BUFFER_BIT );
         }
@@ -104,6 +143,9 @@ namespace gfx {
         if ( not this->is_active() ) {
             throw std::logic_error( "Property query 'major_version()' called on Context that is not active." );
         }
+        if ( target_window == 0 ) {
+            return 3u;
+        }
         int maj_ver;
         int ret = SDL_GL_GetAttribute( SDL_GL_CONTEXT_MAJOR_VERSION, &maj_ver );
         if ( ret != 0 ) {
@@ -129,6 +171,9 @@ namespace gfx {
         if ( not this->is_active() ) {
             throw std::logic_error( "Property query 'minor_version()' called on Context that is not active." );
         }
+        if ( target_window == 0 ) {
+            return 3u;
+        }
         int min_ver;
         int ret = SDL_GL_GetAttribute( SDL_GL_CONTEXT_MINOR_VERSION, &min_ver );
         if ( ret != 0 ) {
@@ -155,6 +200,9 @@ namespace gfx {
         if ( not this->is_active() ) {
             throw std::logic_error( "Property query 'version()' called on Context that is not active." );
         }
+        if ( target_window == 0 ) {
+            return uvec2( 3u, 3u );
+        }
         int maj_ver;
         int ret = SDL_GL_GetAttribute( SDL_GL_CONTEXT_MAJOR_VERSION, &maj_ver );
         if ( ret != 0 ) {
@@ -187,6 +235,9 @@ namespace gfx {
         if ( not this->is_active() ) {
             throw std::logic_error( "Property query 'depth_bits()' called on Context that is not active." );
         }
+        if ( target_window == 0 ) {
+            return settings_v.n_depth_bits;
+        }
         int bits;
         int ret = SDL_GL_GetAttribute( SDL_GL_DEPTH_SIZE, &bits );
         if ( ret != 0 ) {
@@ -211,6 +262,9 @@ namespace gfx {
         if ( not this->is_active() ) {
             throw std::logic_error( "Property query 'double_buffered()' called on Context that is not active." );
         }
+        if ( target_window == 0 ) {
+            return settings_v.is_double_buffered;
+        }
         int buffed;
         int ret = SDL_GL_GetAttribute( SDL_GL_DOUBLEBUFFER, &buffed );
         if ( ret != 0 ) {
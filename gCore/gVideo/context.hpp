@@ -51,6 +51,7 @@ namespace gfx {
         
                                 context( window const& target_window,
                                          settings const& set = settings() );
+        explicit                context( settings const& set );
                                 ~context();
         void                    clear_color( float red, float green,
                                             float blue, float alpha = 1.0f );
@@ -60,6 +61,7 @@ namespace gfx {
         uvec2                   version() const;
         unsigned int            depth_bits() const;
         bool                    double_buffered() const;
+        size_t                  serial() const;
         bool                    operator ==( context const& rhs ) const;
         
         void                    draw_triangles( size_t const tris,
@@ -70,6 +72,9 @@ namespace gfx {
                                 
         window const*           target_window;
         SDL_GLContext           sys_context;
+        settings                settings_v;
+        size_t                  serial_v;
+        static size_t           next_serial;
         friend                  class video_system;
     };
 
@@ -109,17 +114,29 @@ namespace gfx {
      */
     inline context::settings& context::settings::depth_bits( unsigned int bits )
     { n_depth_bits = bits; return *this; }
+    /**
+     * \brief Return the serial number of this \ref gfx::context "context".
+     * 
+     * Every context gets a distinct serial number for the life of the
+     * program. Unlike the context's address, it is never reused once the
+     * context is destroyed, so it is safe to key per-context state on it.
+     * \return The serial number of the context
+     */
+    inline  size_t  context::serial() const
+    { return serial_v; }
     /**
      * \brief Compare this \ref gfx::context "context" to another for equality.
      * 
      * The comparison is down using internal OpenGL system values; it is feasible
      * that two contexts could compare equal, but extremely extremely unlikely
      * as it would require ill-advised hacking of how the \ref gfx::video_system
-     * "video system" works.
+     * "video system" works. Contexts without a window have no system
+     * context, so serial numbers are compared as well.
      * \param rhs The context to compare this context to
      */
     inline  bool    context::operator ==( context const& rhs ) const
-    { return this->sys_context == rhs.sys_context; }
+    { return this->sys_context == rhs.sys_context and
+             this->serial_v == rhs.serial_v; }
     /**
      * \brief Draw triangles using the indices given.
      * 
@@ -0,0 +1,1472 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <map>
+#include <set>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#include "gl_backend.hpp"
+#include "gl_entry_points.hpp"
+
+namespace gfx {
+    namespace {
+        enum entry_index {
+#define GFX_GL_ENTRY( name ) name##_entry,
+            GFX_GL_ENTRY_POINTS
+#undef GFX_GL_ENTRY
+            entry_count
+        };
+
+        char const* const   entry_names[entry_count] = {
+#define GFX_GL_ENTRY( name ) #name,
+            GFX_GL_ENTRY_POINTS
+#undef GFX_GL_ENTRY
+        };
+
+        gl_backend::call_stats  entry_stats[entry_count];
+        gl_backend::kind        backend_v = gl_backend::driver_backend;
+        bool                    recording_v = false;
+        bool                    driver_saved = false;
+        /*
+         * The bytes of client memory a pixel transfer reads.
+         */
+        size_t  pixel_bytes( GLenum const format, GLenum const type )
+        {
+            switch ( type ) {
+            case gl::UNSIGNED_BYTE_3_3_2 :
+            case gl::UNSIGNED_BYTE_2_3_3_REV :
+                return 1;
+            case gl::UNSIGNED_SHORT_5_6_5 :
+            case gl::UNSIGNED_SHORT_5_6_5_REV :
+            case gl::UNSIGNED_SHORT_4_4_4_4 :
+            case gl::UNSIGNED_SHORT_4_4_4_4_REV :
+            case gl::UNSIGNED_SHORT_5_5_5_1 :
+            case gl::UNSIGNED_SHORT_1_5_5_5_REV :
+                return 2;
+            case gl::UNSIGNED_INT_8_8_8_8 :
+            case gl::UNSIGNED_INT_8_8_8_8_REV :
+            case gl::UNSIGNED_INT_10_10_10_2 :
+            case gl::UNSIGNED_INT_2_10_10_10_REV :
+            case gl::UNSIGNED_INT_24_8 :
+            case gl::UNSIGNED_INT_10F_11F_11F_REV :
+            case gl::UNSIGNED_INT_5_9_9_9_REV :
+                return 4;
+            case gl::FLOAT_32_UNSIGNED_INT_24_8_REV :
+                return 8;
+            default :
+                break;
+            }
+            size_t components = 4;
+            switch ( format ) {
+            case gl::RED :
+            case gl::RED_INTEGER :
+            case gl::GREEN :
+            case gl::BLUE :
+            case gl::DEPTH_COMPONENT :
+                components = 1;
+                break;
+            case gl::RG :
+            case gl::RG_INTEGER :
+            case gl::DEPTH_STENCIL :
+                components = 2;
+                break;
+            case gl::RGB :
+            case gl::BGR :
+            case gl::RGB_INTEGER :
+            case gl::BGR_INTEGER :
+                components = 3;
+                break;
+            default :
+                break;
+            }
+            switch ( type ) {
+            case gl::BYTE :
+            case gl::UNSIGNED_BYTE :
+                return components;
+            case gl::SHORT :
+            case gl::UNSIGNED_SHORT :
+            case gl::HALF_FLOAT :
+                return components * 2;
+            default :
+                return components * 4;
+            }
+        }
+        /*
+         * How many bytes a call through entry point N hands to OpenGL. Most
+         * carry nothing worth counting.
+         */
+        template< size_t N >
+        struct payload {
+            template< typename... A >
+            static size_t   bytes( A... ) { return 0; }
+        };
+
+        template< size_t B >
+        struct fixed_payload {
+            template< typename... A >
+            static size_t   bytes( A... ) { return B; }
+        };
+
+        template< size_t B >
+        struct counted_payload {
+            template< typename P >
+            static size_t   bytes( GLint, GLsizei count, P )
+            { return count * B; }
+            template< typename P >
+            static size_t   bytes( GLint, GLsizei count, GLboolean, P )
+            { return count * B; }
+        };
+
+#define GFX_GL_PAYLOAD( name, params, size ) \
+        template<> struct payload< name##_entry > { \
+            static size_t   bytes params { return size; } \
+        };
+#define GFX_GL_FIXED( name, size ) \
+        template<> struct payload< name##_entry > : fixed_payload< size > {};
+#define GFX_GL_COUNTED( name, size ) \
+        template<> struct payload< name##_entry > : counted_payload< size > {};
+
+        GFX_GL_PAYLOAD( BufferData, ( GLenum, GLsizeiptr size, GLvoid const*, GLenum ),
+                        size )
+        GFX_GL_PAYLOAD( BufferSubData, ( GLenum, GLintptr, GLsizeiptr size, GLvoid const* ),
+                        size )
+        GFX_GL_PAYLOAD( TexImage1D, ( GLenum, GLint, GLint, GLsizei w, GLint,
+                                      GLenum f, GLenum t, GLvoid const* ),
+                        w * pixel_bytes( f, t ) )
+        GFX_GL_PAYLOAD( TexImage2D, ( GLenum, GLint, GLint, GLsizei w, GLsizei h, GLint,
+                                      GLenum f, GLenum t, GLvoid const* ),
+                        w * h * pixel_bytes( f, t ) )
+        GFX_GL_PAYLOAD( TexImage3D, ( GLenum, GLint, GLint, GLsizei w, GLsizei h, GLsizei d,
+                                      GLint, GLenum f, GLenum t, GLvoid const* ),
+                        w * h * d * pixel_bytes( f, t ) )
+        GFX_GL_PAYLOAD( TexSubImage1D, ( GLenum, GLint, GLint, GLsizei w,
+                                         GLenum f, GLenum t, GLvoid const* ),
+                        w * pixel_bytes( f, t ) )
+        GFX_GL_PAYLOAD( TexSubImage2D, ( GLenum, GLint, GLint, GLint, GLsizei w, GLsizei h,
+                                         GLenum f, GLenum t, GLvoid const* ),
+                        w * h * pixel_bytes( f, t ) )
+        GFX_GL_PAYLOAD( TexSubImage3D, ( GLenum, GLint, GLint, GLint, GLint,
+                                         GLsizei w, GLsizei h, GLsizei d,
+                                         GLenum f, GLenum t, GLvoid const* ),
+                        w * h * d * pixel_bytes( f, t ) )
+        GFX_GL_PAYLOAD( ProgramBinary, ( GLuint, GLenum, GLvoid const*, GLsizei length ),
+                        length )
+        GFX_GL_FIXED( Uniform1f, 4 )
+        GFX_GL_FIXED( Uniform2f, 8 )
+        GFX_GL_FIXED( Uniform3f, 12 )
+        GFX_GL_FIXED( Uniform4f, 16 )
+        GFX_GL_FIXED( Uniform1i, 4 )
+        GFX_GL_FIXED( Uniform2i, 8 )
+        GFX_GL_FIXED( Uniform3i, 12 )
+        GFX_GL_FIXED( Uniform4i, 16 )
+        GFX_GL_FIXED( Uniform1ui, 4 )
+        GFX_GL_FIXED( Uniform2ui, 8 )
+        GFX_GL_FIXED( Uniform3ui, 12 )
+        GFX_GL_FIXED( Uniform4ui, 16 )
+        GFX_GL_COUNTED( Uniform1fv, 4 )
+        GFX_GL_COUNTED( Uniform2fv, 8 )
+        GFX_GL_COUNTED( Uniform3fv, 12 )
+        GFX_GL_COUNTED( Uniform4fv, 16 )
+        GFX_GL_COUNTED( Uniform1iv, 4 )
+        GFX_GL_COUNTED( Uniform2iv, 8 )
+        GFX_GL_COUNTED( Uniform3iv, 12 )
+        GFX_GL_COUNTED( Uniform4iv, 16 )
+        GFX_GL_COUNTED( Uniform1uiv, 4 )
+        GFX_GL_COUNTED( Uniform2uiv, 8 )
+        GFX_GL_COUNTED( Uniform3uiv, 12 )
+        GFX_GL_COUNTED( Uniform4uiv, 16 )
+        GFX_GL_COUNTED( UniformMatrix2fv, 16 )
+        GFX_GL_COUNTED( UniformMatrix3fv, 36 )
+        GFX_GL_COUNTED( UniformMatrix4fv, 64 )
+        GFX_GL_COUNTED( UniformMatrix2x3fv, 24 )
+        GFX_GL_COUNTED( UniformMatrix3x2fv, 24 )
+        GFX_GL_COUNTED( UniformMatrix2x4fv, 32 )
+        GFX_GL_COUNTED( UniformMatrix4x2fv, 32 )
+        GFX_GL_COUNTED( UniformMatrix3x4fv, 48 )
+        GFX_GL_COUNTED( UniformMatrix4x3fv, 48 )
+
+#undef GFX_GL_PAYLOAD
+#undef GFX_GL_FIXED
+#undef GFX_GL_COUNTED
+        /*
+         * The bookkeeping for one entry point P. driver is what P pointed
+         * to before any backend was chosen; next is what a counted call
+         * goes on to.
+         */
+        template< size_t N, typename F, F* P >
+        struct entry;
+
+        template< size_t N, typename R, typename... A, R (CODEGEN_FUNCPTR **P)( A... ) >
+        struct entry< N, R (CODEGEN_FUNCPTR *)( A... ), P > {
+            typedef R (CODEGEN_FUNCPTR *pointer)( A... );
+
+            static pointer  driver;
+            static pointer  next;
+
+            static R CODEGEN_FUNCPTR    none( A... )
+            { return R(); }
+
+            static R CODEGEN_FUNCPTR    counted( A... args )
+            {
+                gl_backend::call_stats& stats = entry_stats[N];
+                ++stats.calls;
+                stats.bytes += payload< N >::bytes( args... );
+                rehook keep;
+                return next( args... );
+            }
+            /*
+             * The loader replaces an entry point with the driver's function
+             * the first time it is called, which would unhook the count.
+             */
+            struct rehook {
+                ~rehook()
+                {
+                    if ( *P != &counted ) {
+                        next = *P;
+                        *P = &counted;
+                    }
+                }
+            };
+        };
+
+        template< size_t N, typename R, typename... A, R (CODEGEN_FUNCPTR **P)( A... ) >
+        typename entry< N, R (CODEGEN_FUNCPTR *)( A... ), P >::pointer
+        entry< N, R (CODEGEN_FUNCPTR *)( A... ), P >::driver = 0;
+
+        template< size_t N, typename R, typename... A, R (CODEGEN_FUNCPTR **P)( A... ) >
+        typename entry< N, R (CODEGEN_FUNCPTR *)( A... ), P >::pointer
+        entry< N, R (CODEGEN_FUNCPTR *)( A... ), P >::next = 0;
+
+#define GFX_GL_HOOK( name ) entry< name##_entry, decltype( gl::name ), &gl::name >
+
+        /*
+         * Object names the null backend has handed out, by kind.
+         */
+        enum object_kind {
+            buffer_names,
+            vertex_array_names,
+            texture_names,
+            sampler_names,
+            framebuffer_names,
+            renderbuffer_names,
+            query_names,
+            shader_names,
+            program_names,
+            sync_names,
+            kind_count
+        };
+
+        struct null_uniform {
+            std::string     name;
+            GLint           size;
+            GLenum          type;
+            GLint           location;
+        };
+
+        struct null_program {
+            std::vector<GLuint>         shaders;
+            std::vector<null_uniform>   uniforms;
+            std::vector<std::string>    blocks;
+        };
+
+        struct null_extent {
+            GLsizei         width;
+            GLsizei         height;
+            GLsizei         depth;
+        };
+
+        typedef std::pair<GLuint, GLenum>   unit_target;
+        typedef std::pair<GLuint, GLint>    texture_level;
+        /*
+         * Everything the null backend remembers between calls.
+         */
+        struct null_state {
+            GLuint                              next_name;
+            GLenum                              error;
+            std::set<GLuint>                    live[kind_count];
+            std::map<GLuint, std::vector<unsigned char> >   buffer_data;
+            std::map<GLenum, GLuint>            buffer_bindings;
+            std::map<GLuint, GLuint>            element_bindings;
+            GLuint                              prog_ID;
+            GLuint                              vao_ID;
+            GLuint                              unit;
+            std::map<unit_target, GLuint>       texture_bindings;
+            std::map<GLuint, GLuint>            sampler_bindings;
+            std::map<texture_level, null_extent>    extents;
+            std::set<GLenum>                    enabled;
+            GLenum                              blend_src;
+            GLenum                              blend_dst;
+            GLenum                              depth_func;
+            GLboolean                           depth_mask;
+            GLenum                              cull_face;
+            std::map<GLuint, std::string>       sources;
+            std::map<GLuint, GLenum>            shader_types;
+            std::map<GLuint, null_program>      programs;
+
+            null_state() : next_name ( 1 ),
+                           error ( gl::NO_ERROR_ ),
+                           prog_ID ( 0 ),
+                           vao_ID ( 0 ),
+                           unit ( 0 ),
+                           blend_src ( gl::ONE ),
+                           blend_dst ( gl::ZERO ),
+                           depth_func ( gl::LESS ),
+                           depth_mask ( gl::TRUE_ ),
+                           cull_face ( gl::BACK )
+            { enabled.insert( gl::DITHER ); }
+        };
+
+        null_state& null()
+        {
+            static null_state state;
+            return state;
+        }
+
+        void    null_error( GLenum const error )
+        {
+            if ( null().error == gl::NO_ERROR_ ) {
+                null().error = error;
+            }
+        }
+
+        bool    null_alive( object_kind const kind, GLuint const name )
+        { return null().live[kind].count( name ) > 0; }
+        /*
+         * The buffer a target reaches; the element array buffer belongs to
+         * the bound vertex array.
+         */
+        GLuint  null_bound_buffer( GLenum const target )
+        {
+            null_state& state = null();
+            std::map<GLuint, GLuint>& elements = state.element_bindings;
+            if ( target == gl::ELEMENT_ARRAY_BUFFER ) {
+                std::map<GLuint, GLuint>::iterator found = elements.find( state.vao_ID );
+                return found == elements.end() ? 0 : found->second;
+            }
+            std::map<GLenum, GLuint>::iterator found = state.buffer_bindings.find( target );
+            return found == state.buffer_bindings.end() ? 0 : found->second;
+        }
+
+        std::vector<unsigned char>* null_storage( GLenum const target )
+        {
+            GLuint buff_ID = null_bound_buffer( target );
+            if ( buff_ID == 0 ) {
+                null_error( gl::INVALID_OPERATION );
+                return 0;
+            }
+            return &null().buffer_data[buff_ID];
+        }
+        /*
+         * Cube map faces are bound through the cube map target.
+         */
+        GLenum  null_binding_target( GLenum const target )
+        {
+            if ( target >= gl::TEXTURE_CUBE_MAP_POSITIVE_X and
+                 target <= gl::TEXTURE_CUBE_MAP_NEGATIVE_Z ) {
+                return gl::TEXTURE_CUBE_MAP;
+            }
+            return target;
+        }
+
+        GLuint  null_bound_texture( GLenum const target )
+        {
+            null_state& state = null();
+            std::map<unit_target, GLuint>::iterator found =
+                state.texture_bindings.find( unit_target( state.unit,
+                                                          null_binding_target( target ) ) );
+            return found == state.texture_bindings.end() ? 0 : found->second;
+        }
+
+        void    null_extent_of( GLenum const target, GLint const level,
+                                GLsizei const width, GLsizei const height,
+                                GLsizei const depth )
+        {
+            null_extent extent = { width, height, depth };
+            null().extents[texture_level( null_bound_texture( target ), level )] = extent;
+        }
+        /*
+         * Forget every binding of a deleted name.
+         */
+        void    null_unbind( object_kind const kind, GLuint const name )
+        {
+            null_state& state = null();
+            if ( kind == buffer_names ) {
+                for ( std::map<GLenum, GLuint>::iterator it = state.buffer_bindings.begin();
+                      it != state.buffer_bindings.end(); ++it ) {
+                    if ( it->second == name ) {
+                        it->second = 0;
+                    }
+                }
+                for ( std::map<GLuint, GLuint>::iterator it = state.element_bindings.begin();
+                      it != state.element_bindings.end(); ++it ) {
+                    if ( it->second == name ) {
+                        it->second = 0;
+                    }
+                }
+                state.buffer_data.erase( name );
+            } else if ( kind == vertex_array_names ) {
+                if ( state.vao_ID == name ) {
+                    state.vao_ID = 0;
+                }
+                state.element_bindings.erase( name );
+            } else if ( kind == texture_names ) {
+                for ( std::map<unit_target, GLuint>::iterator it = state.texture_bindings.begin();
+                      it != state.texture_bindings.end(); ++it ) {
+                    if ( it->second == name ) {
+                        it->second = 0;
+                    }
+                }
+            } else if ( kind == sampler_names ) {
+                for ( std::map<GLuint, GLuint>::iterator it = state.sampler_bindings.begin();
+                      it != state.sampler_bindings.end(); ++it ) {
+                    if ( it->second == name ) {
+                        it->second = 0;
+                    }
+                }
+            } else if ( kind == shader_names ) {
+                state.sources.erase( name );
+                state.shader_types.erase( name );
+            } else if ( kind == program_names ) {
+                state.programs.erase( name );
+            }
+        }
+
+        template< object_kind K >
+        void CODEGEN_FUNCPTR        null_gen( GLsizei n, GLuint* names )
+        {
+            for ( GLsizei i = 0; i < n; ++i ) {
+                names[i] = null().next_name++;
+                null().live[K].insert( names[i] );
+            }
+        }
+
+        template< object_kind K >
+        void CODEGEN_FUNCPTR        null_delete( GLsizei n, GLuint const* names )
+        {
+            for ( GLsizei i = 0; i < n; ++i ) {
+                if ( names[i] != 0 and null().live[K].erase( names[i] ) > 0 ) {
+                    null_unbind( K, names[i] );
+                }
+            }
+        }
+
+        template< object_kind K >
+        GLboolean CODEGEN_FUNCPTR   null_is( GLuint name )
+        { return null_alive( K, name ) ? gl::TRUE_ : gl::FALSE_; }
+
+        GLuint CODEGEN_FUNCPTR      null_create_shader( GLenum type )
+        {
+            GLuint name = null().next_name++;
+            null().live[shader_names].insert( name );
+            null().shader_types[name] = type;
+            return name;
+        }
+
+        GLuint CODEGEN_FUNCPTR      null_create_program()
+        {
+            GLuint name = null().next_name++;
+            null().live[program_names].insert( name );
+            null().programs[name] = null_program();
+            return name;
+        }
+
+        void CODEGEN_FUNCPTR        null_delete_shader( GLuint shader )
+        { null_delete<shader_names>( 1, &shader ); }
+
+        void CODEGEN_FUNCPTR        null_delete_program( GLuint program )
+        { null_delete<program_names>( 1, &program ); }
+
+        void CODEGEN_FUNCPTR        null_shader_source( GLuint shader, GLsizei count,
+                                                        GLchar const* const* string,
+                                                        GLint const* length )
+        {
+            if ( not null_alive( shader_names, shader ) ) {
+                null_error( gl::INVALID_VALUE );
+                return;
+            }
+            std::string& source = null().sources[shader];
+            source.clear();
+            for ( GLsizei i = 0; i < count; ++i ) {
+                if ( length != 0 and length[i] >= 0 ) {
+                    source.append( string[i], length[i] );
+                } else {
+                    source.append( string[i] );
+                }
+            }
+        }
+
+        void CODEGEN_FUNCPTR        null_attach_shader( GLuint program, GLuint shader )
+        {
+            if ( not null_alive( program_names, program ) or
+                 not null_alive( shader_names, shader ) ) {
+                null_error( gl::INVALID_VALUE );
+                return;
+            }
+            null().programs[program].shaders.push_back( shader );
+        }
+
+        void CODEGEN_FUNCPTR        null_detach_shader( GLuint program, GLuint shader )
+        {
+            std::vector<GLuint>& shaders = null().programs[program].shaders;
+            shaders.erase( std::remove( shaders.begin(), shaders.end(), shader ),
+                           shaders.end() );
+        }
+
+        bool    ident_char( char const c )
+        {
+            return ( c >= 'a' and c <= 'z' ) or ( c >= 'A' and c <= 'Z' ) or
+                   ( c >= '0' and c <= '9' ) or c == '_';
+        }
+
+        std::string strip_comments( std::string const& source )
+        {
+            std::string text ( source );
+            size_t at = 0;
+            while ( at < text.size() ) {
+                if ( text.compare( at, 2, "//" ) == 0 ) {
+                    size_t end = text.find( '\n', at );
+                    end = ( end == std::string::npos ) ? text.size() : end;
+                    text.replace( at, end - at, end - at, ' ' );
+                    at = end;
+                } else if ( text.compare( at, 2, "/*" ) == 0 ) {
+                    size_t end = text.find( "*/", at + 2 );
+                    end = ( end == std::string::npos ) ? text.size() : end + 2;
+                    text.replace( at, end - at, end - at, ' ' );
+                    at = end;
+                } else {
+                    ++at;
+                }
+            }
+            return text;
+        }
+
+        GLenum  uniform_type( std::string const& name )
+        {
+            static std::map<std::string, GLenum> types;
+            if ( types.empty() ) {
+                types["float"] = gl::FLOAT;
+                types["vec2"] = gl::FLOAT_VEC2;
+                types["vec3"] = gl::FLOAT_VEC3;
+                types["vec4"] = gl::FLOAT_VEC4;
+                types["int"] = gl::INT;
+                types["ivec2"] = gl::INT_VEC2;
+                types["ivec3"] = gl::INT_VEC3;
+                types["ivec4"] = gl::INT_VEC4;
+                types["uint"] = gl::UNSIGNED_INT;
+                types["uvec2"] = gl::UNSIGNED_INT_VEC2;
+                types["uvec3"] = gl::UNSIGNED_INT_VEC3;
+                types["uvec4"] = gl::UNSIGNED_INT_VEC4;
+                types["bool"] = gl::BOOL;
+                types["bvec2"] = gl::BOOL_VEC2;
+                types["bvec3"] = gl::BOOL_VEC3;
+                types["bvec4"] = gl::BOOL_VEC4;
+                types["mat2"] = gl::FLOAT_MAT2;
+                types["mat3"] = gl::FLOAT_MAT3;
+                types["mat4"] = gl::FLOAT_MAT4;
+                types["mat2x2"] = gl::FLOAT_MAT2;
+                types["mat3x3"] = gl::FLOAT_MAT3;
+                types["mat4x4"] = gl::FLOAT_MAT4;
+                types["mat2x3"] = gl::FLOAT_MAT2x3;
+                types["mat2x4"] = gl::FLOAT_MAT2x4;
+                types["mat3x2"] = gl::FLOAT_MAT3x2;
+                types["mat3x4"] = gl::FLOAT_MAT3x4;
+                types["mat4x2"] = gl::FLOAT_MAT4x2;
+                types["mat4x3"] = gl::FLOAT_MAT4x3;
+                types["sampler1D"] = gl::SAMPLER_1D;
+                types["sampler2D"] = gl::SAMPLER_2D;
+                types["sampler3D"] = gl::SAMPLER_3D;
+                types["samplerCube"] = gl::SAMPLER_CUBE;
+                types["sampler1DArray"] = gl::SAMPLER_1D_ARRAY;
+                types["sampler2DArray"] = gl::SAMPLER_2D_ARRAY;
+                types["sampler2DShadow"] = gl::SAMPLER_2D_SHADOW;
+            }
+            std::map<std::string, GLenum>::const_iterator found = types.find( name );
+            return found == types.end() ? 0 : found->second;
+        }
+        /*
+         * Find the uniforms and uniform blocks a shader declares. This is
+         * no compiler: preprocessor conditionals are ignored, so a uniform
+         * is reported whether or not its #ifdef is taken, and uniforms of
+         * struct type are left out.
+         */
+        void    scan_uniforms( std::string const& source, null_program& prog,
+                               GLint& next_location )
+        {
+            std::string text = strip_comments( source );
+            size_t at = 0;
+            while ( ( at = text.find( "uniform", at ) ) != std::string::npos ) {
+                bool word = ( at == 0 or not ident_char( text[at - 1] ) ) and
+                            ( at + 7 == text.size() or not ident_char( text[at + 7] ) );
+                at += 7;
+                if ( not word ) {
+                    continue;
+                }
+                size_t end = text.find( ';', at );
+                size_t brace = text.find( '{', at );
+                if ( end == std::string::npos ) {
+                    return;
+                }
+                if ( brace < end ) {
+                    std::istringstream block ( text.substr( at, brace - at ) );
+                    std::string name;
+                    if ( block >> name and
+                         std::find( prog.blocks.begin(), prog.blocks.end(), name ) == prog.blocks.end() ) {
+                        prog.blocks.push_back( name );
+                    }
+                    at = text.find( '}', brace );
+                    if ( at == std::string::npos ) {
+                        return;
+                    }
+                    continue;
+                }
+                std::string decl = text.substr( at, end - at );
+                for ( size_t i = 0; i < decl.size(); ++i ) {
+                    if ( decl[i] == ',' or decl[i] == '[' or decl[i] == ']' ) {
+                        decl.insert( i + 1, " " );
+                        decl.insert( i, " " );
+                        i += 2;
+                    }
+                }
+                std::istringstream tokens ( decl );
+                std::string type;
+                while ( tokens >> type and
+                        ( type == "lowp" or type == "mediump" or type == "highp" ) ) {}
+                GLenum gl_type = uniform_type( type );
+                if ( gl_type == 0 ) {
+                    at = end;
+                    continue;
+                }
+                std::string token;
+                while ( tokens >> token ) {
+                    null_uniform info = { token, 1, gl_type, next_location };
+                    std::string next;
+                    if ( tokens >> next and next == "[" ) {
+                        tokens >> next;
+                        info.size = std::atoi( next.c_str() );
+                        info.name += "[0]";
+                        tokens >> next;
+                        next.clear();
+                        tokens >> next;
+                    }
+                    bool known = false;
+                    for ( size_t u = 0; u < prog.uniforms.size(); ++u ) {
+                        known = known or prog.uniforms[u].name == info.name;
+                    }
+                    if ( not known and info.size > 0 ) {
+                        next_location += info.size;
+                        prog.uniforms.push_back( info );
+                    }
+                    if ( next != "," ) {
+                        break;
+                    }
+                }
+                at = end;
+            }
+        }
+
+        void CODEGEN_FUNCPTR        null_link_program( GLuint program )
+        {
+            if ( not null_alive( program_names, program ) ) {
+                null_error( gl::INVALID_VALUE );
+                return;
+            }
+            null_program& prog = null().programs[program];
+            prog.uniforms.clear();
+            prog.blocks.clear();
+            GLint next_location = 0;
+            for ( size_t i = 0; i < prog.shaders.size(); ++i ) {
+                scan_uniforms( null().sources[prog.shaders[i]], prog, next_location );
+            }
+        }
+
+        void CODEGEN_FUNCPTR        null_get_shaderiv( GLuint shader, GLenum pname,
+                                                       GLint* params )
+        {
+            switch ( pname ) {
+            case gl::SHADER_TYPE :
+                *params = GLint( null().shader_types[shader] );
+                break;
+            case gl::COMPILE_STATUS :
+                *params = gl::TRUE_;
+                break;
+            case gl::INFO_LOG_LENGTH :
+                *params = 1;
+                break;
+            case gl::SHADER_SOURCE_LENGTH :
+                *params = GLint( null().sources[shader].size() + 1 );
+                break;
+            case gl::COMPLETION_STATUS_KHR :
+                *params = gl::TRUE_;
+                break;
+            default :
+                *params = 0;
+                break;
+            }
+        }
+
+        void CODEGEN_FUNCPTR        null_get_programiv( GLuint program, GLenum pname,
+                                                        GLint* params )
+        {
+            null_program& prog = null().programs[program];
+            switch ( pname ) {
+            case gl::LINK_STATUS :
+            case gl::VALIDATE_STATUS :
+            case gl::COMPLETION_STATUS_KHR :
+                *params = gl::TRUE_;
+                break;
+            case gl::INFO_LOG_LENGTH :
+                *params = 1;
+                break;
+            case gl::ATTACHED_SHADERS :
+                *params = GLint( prog.shaders.size() );
+                break;
+            case gl::ACTIVE_UNIFORMS :
+                *params = GLint( prog.uniforms.size() );
+                break;
+            case gl::ACTIVE_UNIFORM_MAX_LENGTH : {
+                size_t longest = 0;
+                for ( size_t i = 0; i < prog.uniforms.size(); ++i ) {
+                    longest = std::max( longest, prog.uniforms[i].name.size() );
+                }
+                *params = GLint( longest + 1 );
+                break;
+            }
+            case gl::ACTIVE_UNIFORM_BLOCKS :
+                *params = GLint( prog.blocks.size() );
+                break;
+            default :
+                *params = 0;
+                break;
+            }
+        }
+
+        void    null_info_log( GLsizei buf_size, GLsizei* length, GLchar* info_log )
+        {
+            if ( length != 0 ) {
+                *length = 0;
+            }
+            if ( buf_size > 0 ) {
+                info_log[0] = '\0';
+            }
+        }
+
+        void CODEGEN_FUNCPTR        null_get_shader_info_log( GLuint, GLsizei buf_size,
+                                                              GLsizei* length, GLchar* info_log )
+        { null_info_log( buf_size, length, info_log ); }
+
+        void CODEGEN_FUNCPTR        null_get_program_info_log( GLuint, GLsizei buf_size,
+                                                               GLsizei* length, GLchar* info_log )
+        { null_info_log( buf_size, length, info_log ); }
+
+        void CODEGEN_FUNCPTR        null_get_active_uniform( GLuint program, GLuint index,
+                                                             GLsizei buf_size, GLsizei* length,
+                                                             GLint* size, GLenum* type,
+                                                             GLchar* name )
+        {
+            null_program& prog = null().programs[program];
+            if ( index >= prog.uniforms.size() ) {
+                null_error( gl::INVALID_VALUE );
+                return;
+            }
+            null_uniform const& info = prog.uniforms[index];
+            GLsizei copied = 0;
+            if ( buf_size > 0 ) {
+                copied = std::min( GLsizei( info.name.size() ), buf_size - 1 );
+                std::memcpy( name, info.name.c_str(), copied );
+                name[copied] = '\0';
+            }
+            if ( length != 0 ) {
+                *length = copied;
+            }
+            *size = info.size;
+            *type = info.type;
+        }
+
+        GLint CODEGEN_FUNCPTR       null_get_uniform_location( GLuint program,
+                                                               GLchar const* name )
+        {
+            std::string wanted ( name );
+            GLint element = 0;
+            size_t bracket = wanted.find( '[' );
+            if ( bracket != std::string::npos ) {
+                element = std::atoi( wanted.c_str() + bracket + 1 );
+                wanted.erase( bracket );
+            }
+            null_program& prog = null().programs[program];
+            for ( size_t i = 0; i < prog.uniforms.size(); ++i ) {
+                null_uniform const& info = prog.uniforms[i];
+                std::string base = info.name.substr( 0, info.name.find( '[' ) );
+                if ( base == wanted and element < info.size ) {
+                    return info.location + element;
+                }
+            }
+            return -1;
+        }
+
+        GLuint CODEGEN_FUNCPTR      null_get_uniform_block_index( GLuint program,
+                                                                  GLchar const* name )
+        {
+            std::vector<std::string>& blocks = null().programs[program].blocks;
+            std::vector<std::string>::iterator found = std::find( blocks.begin(),
+                                                                  blocks.end(),
+                                                                  std::string( name ) );
+            return found == blocks.end() ? gl::INVALID_INDEX : GLuint( found - blocks.begin() );
+        }
+
+        GLubyte const* CODEGEN_FUNCPTR  null_get_string( GLenum name )
+        {
+            switch ( name ) {
+            case gl::VENDOR :
+                return (GLubyte const*) "gfx";
+            case gl::RENDERER :
+                return (GLubyte const*) "gfx null backend";
+            case gl::VERSION :
+                return (GLubyte const*) "3.3 null";
+            case gl::SHADING_LANGUAGE_VERSION :
+                return (GLubyte const*) "3.30";
+            default :
+                return (GLubyte const*) "";
+            }
+        }
+
+        GLubyte const* CODEGEN_FUNCPTR  null_get_stringi( GLenum, GLuint )
+        {
+            null_error( gl::INVALID_VALUE );
+            return 0;
+        }
+
+        GLenum  texture_binding_target( GLenum const pname )
+        {
+            switch ( pname ) {
+            case gl::TEXTURE_BINDING_1D :
+                return gl::TEXTURE_1D;
+            case gl::TEXTURE_BINDING_2D :
+                return gl::TEXTURE_2D;
+            case gl::TEXTURE_BINDING_3D :
+                return gl::TEXTURE_3D;
+            case gl::TEXTURE_BINDING_1D_ARRAY :
+                return gl::TEXTURE_1D_ARRAY;
+            case gl::TEXTURE_BINDING_2D_ARRAY :
+                return gl::TEXTURE_2D_ARRAY;
+            case gl::TEXTURE_BINDING_CUBE_MAP :
+                return gl::TEXTURE_CUBE_MAP;
+            case gl::TEXTURE_BINDING_RECTANGLE :
+                return gl::TEXTURE_RECTANGLE;
+            default :
+                return 0;
+            }
+        }
+
+        void CODEGEN_FUNCPTR        null_get_integerv( GLenum pname, GLint* params )
+        {
+            null_state& state = null();
+            GLenum texture_target = texture_binding_target( pname );
+            if ( texture_target != 0 ) {
+                *params = GLint( null_bound_texture( texture_target ) );
+                return;
+            }
+            switch ( pname ) {
+            case gl::MAJOR_VERSION :
+            case gl::MINOR_VERSION :
+                *params = 3;
+                break;
+            case gl::CURRENT_PROGRAM :
+                *params = GLint( state.prog_ID );
+                break;
+            case gl::VERTEX_ARRAY_BINDING :
+                *params = GLint( state.vao_ID );
+                break;
+            case gl::ARRAY_BUFFER_BINDING :
+                *params = GLint( null_bound_buffer( gl::ARRAY_BUFFER ) );
+                break;
+            case gl::ELEMENT_ARRAY_BUFFER_BINDING :
+                *params = GLint( null_bound_buffer( gl::ELEMENT_ARRAY_BUFFER ) );
+                break;
+            case gl::UNIFORM_BUFFER_BINDING :
+                *params = GLint( null_bound_buffer( gl::UNIFORM_BUFFER ) );
+                break;
+            case gl::PIXEL_UNPACK_BUFFER_BINDING :
+                *params = GLint( null_bound_buffer( gl::PIXEL_UNPACK_BUFFER ) );
+                break;
+            case gl::PIXEL_PACK_BUFFER_BINDING :
+                *params = GLint( null_bound_buffer( gl::PIXEL_PACK_BUFFER ) );
+                break;
+            case gl::ACTIVE_TEXTURE :
+                *params = GLint( gl::TEXTURE0 + state.unit );
+                break;
+            case gl::SAMPLER_BINDING :
+                *params = GLint( state.sampler_bindings[state.unit] );
+                break;
+            case gl::BLEND_SRC :
+            case gl::BLEND_SRC_RGB :
+            case gl::BLEND_SRC_ALPHA :
+                *params = GLint( state.blend_src );
+                break;
+            case gl::BLEND_DST :
+            case gl::BLEND_DST_RGB :
+            case gl::BLEND_DST_ALPHA :
+                *params = GLint( state.blend_dst );
+                break;
+            case gl::DEPTH_FUNC :
+                *params = GLint( state.depth_func );
+                break;
+            case gl::DEPTH_WRITEMASK :
+                *params = GLint( state.depth_mask );
+                break;
+            case gl::CULL_FACE_MODE :
+                *params = GLint( state.cull_face );
+                break;
+            case gl::MAX_TEXTURE_IMAGE_UNITS :
+            case gl::MAX_VERTEX_TEXTURE_IMAGE_UNITS :
+            case gl::MAX_VERTEX_ATTRIBS :
+                *params = 16;
+                break;
+            case gl::MAX_COMBINED_TEXTURE_IMAGE_UNITS :
+                *params = 48;
+                break;
+            case gl::MAX_UNIFORM_BUFFER_BINDINGS :
+                *params = 36;
+                break;
+            case gl::MAX_UNIFORM_BLOCK_SIZE :
+                *params = 65536;
+                break;
+            case gl::MAX_TEXTURE_SIZE :
+                *params = 8192;
+                break;
+            case gl::MAX_3D_TEXTURE_SIZE :
+            case gl::MAX_ARRAY_TEXTURE_LAYERS :
+                *params = 2048;
+                break;
+            case gl::UNIFORM_BUFFER_OFFSET_ALIGNMENT :
+                *params = 256;
+                break;
+            default :
+                *params = 0;
+                break;
+            }
+        }
+
+        void CODEGEN_FUNCPTR        null_get_booleanv( GLenum pname, GLboolean* params )
+        {
+            GLint value = 0;
+            null_get_integerv( pname, &value );
+            *params = value != 0 ? gl::TRUE_ : gl::FALSE_;
+        }
+
+        void CODEGEN_FUNCPTR        null_get_floatv( GLenum pname, GLfloat* params )
+        {
+            GLint value = 0;
+            null_get_integerv( pname, &value );
+            *params = GLfloat( value );
+        }
+
+        GLboolean CODEGEN_FUNCPTR   null_is_enabled( GLenum cap )
+        { return null().enabled.count( cap ) > 0 ? gl::TRUE_ : gl::FALSE_; }
+
+        void CODEGEN_FUNCPTR        null_enable( GLenum cap )
+        { null().enabled.insert( cap ); }
+
+        void CODEGEN_FUNCPTR        null_disable( GLenum cap )
+        { null().enabled.erase( cap ); }
+
+        void CODEGEN_FUNCPTR        null_blend_func( GLenum src, GLenum dst )
+        {
+            null().blend_src = src;
+            null().blend_dst = dst;
+        }
+
+        void CODEGEN_FUNCPTR        null_blend_func_separate( GLenum src_rgb, GLenum dst_rgb,
+                                                              GLenum, GLenum )
+        { null_blend_func( src_rgb, dst_rgb ); }
+
+        void CODEGEN_FUNCPTR        null_depth_func( GLenum func )
+        { null().depth_func = func; }
+
+        void CODEGEN_FUNCPTR        null_depth_mask( GLboolean flag )
+        { null().depth_mask = flag; }
+
+        void CODEGEN_FUNCPTR        null_cull_face( GLenum mode )
+        { null().cull_face = mode; }
+
+        void CODEGEN_FUNCPTR        null_use_program( GLuint program )
+        {
+            if ( program != 0 and not null_alive( program_names, program ) ) {
+                null_error( gl::INVALID_VALUE );
+                return;
+            }
+            null().prog_ID = program;
+        }
+
+        void CODEGEN_FUNCPTR        null_bind_vertex_array( GLuint vao )
+        {
+            if ( vao != 0 and not null_alive( vertex_array_names, vao ) ) {
+                null_error( gl::INVALID_OPERATION );
+                return;
+            }
+            null().vao_ID = vao;
+        }
+
+        void CODEGEN_FUNCPTR        null_bind_buffer( GLenum target, GLuint buffer )
+        {
+            null_state& state = null();
+            if ( buffer != 0 and not null_alive( buffer_names, buffer ) ) {
+                null_error( gl::INVALID_OPERATION );
+                return;
+            }
+            if ( target == gl::ELEMENT_ARRAY_BUFFER ) {
+                state.element_bindings[state.vao_ID] = buffer;
+            } else {
+                state.buffer_bindings[target] = buffer;
+            }
+        }
+
+        void CODEGEN_FUNCPTR        null_bind_buffer_base( GLenum target, GLuint,
+                                                           GLuint buffer )
+        { null_bind_buffer( target, buffer ); }
+
+        void CODEGEN_FUNCPTR        null_bind_buffer_range( GLenum target, GLuint,
+                                                            GLuint buffer, GLintptr,
+                                                            GLsizeiptr )
+        { null_bind_buffer( target, buffer ); }
+
+        void CODEGEN_FUNCPTR        null_active_texture( GLenum texture )
+        { null().unit = texture - gl::TEXTURE0; }
+
+        void CODEGEN_FUNCPTR        null_bind_texture( GLenum target, GLuint texture )
+        {
+            null_state& state = null();
+            if ( texture != 0 and not null_alive( texture_names, texture ) ) {
+                null_error( gl::INVALID_OPERATION );
+                return;
+            }
+            state.texture_bindings[unit_target( state.unit, target )] = texture;
+        }
+
+        void CODEGEN_FUNCPTR        null_bind_sampler( GLuint unit, GLuint sampler )
+        {
+            if ( sampler != 0 and not null_alive( sampler_names, sampler ) ) {
+                null_error( gl::INVALID_OPERATION );
+                return;
+            }
+            null().sampler_bindings[unit] = sampler;
+        }
+
+        void CODEGEN_FUNCPTR        null_buffer_data( GLenum target, GLsizeiptr size,
+                                                      GLvoid const* data, GLenum )
+        {
+            std::vector<unsigned char>* storage = null_storage( target );
+            if ( storage == 0 ) {
+                return;
+            }
+            storage->assign( size_t( size ), 0 );
+            if ( data != 0 and size > 0 ) {
+                std::memcpy( &(*storage)[0], data, size_t( size ) );
+            }
+        }
+
+        void CODEGEN_FUNCPTR        null_buffer_sub_data( GLenum target, GLintptr offset,
+                                                          GLsizeiptr size, GLvoid const* data )
+        {
+            std::vector<unsigned char>* storage = null_storage( target );
+            if ( storage == 0 ) {
+                return;
+            }
+            if ( offset < 0 or size < 0 or size_t( offset + size ) > storage->size() ) {
+                null_error( gl::INVALID_VALUE );
+                return;
+            }
+            if ( size > 0 ) {
+                std::memcpy( &(*storage)[offset], data, size_t( size ) );
+            }
+        }
+
+        void CODEGEN_FUNCPTR        null_get_buffer_sub_data( GLenum target, GLintptr offset,
+                                                              GLsizeiptr size, GLvoid* data )
+        {
+            std::vector<unsigned char>* storage = null_storage( target );
+            if ( storage == 0 ) {
+                return;
+            }
+            if ( offset < 0 or size < 0 or size_t( offset + size ) > storage->size() ) {
+                null_error( gl::INVALID_VALUE );
+                return;
+            }
+            if ( size > 0 ) {
+                std::memcpy( data, &(*storage)[offset], size_t( size ) );
+            }
+        }
+
+        void CODEGEN_FUNCPTR        null_copy_buffer_sub_data( GLenum read_target,
+                                                               GLenum write_target,
+                                                               GLintptr read_offset,
+                                                               GLintptr write_offset,
+                                                               GLsizeiptr size )
+        {
+            std::vector<unsigned char>* source = null_storage( read_target );
+            std::vector<unsigned char>* dest = null_storage( write_target );
+            if ( source == 0 or dest == 0 ) {
+                return;
+            }
+            if ( read_offset < 0 or write_offset < 0 or size < 0 or
+                 size_t( read_offset + size ) > source->size() or
+                 size_t( write_offset + size ) > dest->size() ) {
+                null_error( gl::INVALID_VALUE );
+                return;
+            }
+            if ( size > 0 ) {
+                std::memmove( &(*dest)[write_offset], &(*source)[read_offset], size_t( size ) );
+            }
+        }
+
+        GLvoid* CODEGEN_FUNCPTR     null_map_buffer_range( GLenum target, GLintptr offset,
+                                                           GLsizeiptr length, GLbitfield )
+        {
+            std::vector<unsigned char>* storage = null_storage( target );
+            if ( storage == 0 ) {
+                return 0;
+            }
+            if ( offset < 0 or length <= 0 or size_t( offset + length ) > storage->size() ) {
+                null_error( gl::INVALID_VALUE );
+                return 0;
+            }
+            return &(*storage)[offset];
+        }
+
+        GLvoid* CODEGEN_FUNCPTR     null_map_buffer( GLenum target, GLenum )
+        {
+            std::vector<unsigned char>* storage = null_storage( target );
+            if ( storage == 0 or storage->empty() ) {
+                return 0;
+            }
+            return &(*storage)[0];
+        }
+
+        GLboolean CODEGEN_FUNCPTR   null_unmap_buffer( GLenum )
+        { return gl::TRUE_; }
+
+        void CODEGEN_FUNCPTR        null_get_buffer_parameteriv( GLenum target, GLenum pname,
+                                                                 GLint* params )
+        {
+            std::vector<unsigned char>* storage = null_storage( target );
+            *params = ( storage != 0 and pname == gl::BUFFER_SIZE ) ? GLint( storage->size() ) : 0;
+        }
+
+        void CODEGEN_FUNCPTR        null_tex_image_1D( GLenum target, GLint level, GLint,
+                                                       GLsizei width, GLint, GLenum,
+                                                       GLenum, GLvoid const* )
+        { null_extent_of( target, level, width, 1, 1 ); }
+
+        void CODEGEN_FUNCPTR        null_tex_image_2D( GLenum target, GLint level, GLint,
+                                                       GLsizei width, GLsizei height, GLint,
+                                                       GLenum, GLenum, GLvoid const* )
+        { null_extent_of( target, level, width, height, 1 ); }
+
+        void CODEGEN_FUNCPTR        null_tex_image_3D( GLenum target, GLint level, GLint,
+                                                       GLsizei width, GLsizei height,
+                                                       GLsizei depth, GLint, GLenum,
+                                                       GLenum, GLvoid const* )
+        { null_extent_of( target, level, width, height, depth ); }
+
+        void CODEGEN_FUNCPTR        null_get_tex_level_parameteriv( GLenum target, GLint level,
+                                                                    GLenum pname, GLint* params )
+        {
+            std::map<texture_level, null_extent>::iterator found =
+                null().extents.find( texture_level( null_bound_texture( target ), level ) );
+            *params = 0;
+            if ( found == null().extents.end() ) {
+                return;
+            }
+            if ( pname == gl::TEXTURE_WIDTH ) {
+                *params = found->second.width;
+            } else if ( pname == gl::TEXTURE_HEIGHT ) {
+                *params = found->second.height;
+            } else if ( pname == gl::TEXTURE_DEPTH ) {
+                *params = found->second.depth;
+            }
+        }
+
+        GLsync CODEGEN_FUNCPTR      null_fence_sync( GLenum, GLbitfield )
+        {
+            GLuint name = null().next_name++;
+            null().live[sync_names].insert( name );
+            return reinterpret_cast<GLsync>( size_t( name ) );
+        }
+
+        GLenum CODEGEN_FUNCPTR      null_client_wait_sync( GLsync, GLbitfield, GLuint64 )
+        { return gl::ALREADY_SIGNALED; }
+
+        void CODEGEN_FUNCPTR        null_delete_sync( GLsync sync )
+        { null().live[sync_names].erase( GLuint( reinterpret_cast<size_t>( sync ) ) ); }
+
+        GLboolean CODEGEN_FUNCPTR   null_is_sync( GLsync sync )
+        { return null_is<sync_names>( GLuint( reinterpret_cast<size_t>( sync ) ) ); }
+
+        void CODEGEN_FUNCPTR        null_get_synciv( GLsync, GLenum pname, GLsizei buf_size,
+                                                     GLsizei* length, GLint* values )
+        {
+            if ( buf_size > 0 ) {
+                values[0] = ( pname == gl::SYNC_STATUS ) ? GLint( gl::SIGNALED ) : 0;
+            }
+            if ( length != 0 ) {
+                *length = buf_size > 0 ? 1 : 0;
+            }
+        }
+
+        GLenum CODEGEN_FUNCPTR      null_check_framebuffer_status( GLenum )
+        { return gl::FRAMEBUFFER_COMPLETE; }
+
+        GLenum CODEGEN_FUNCPTR      null_get_error()
+        {
+            GLenum error = null().error;
+            null().error = gl::NO_ERROR_;
+            return error;
+        }
+        /*
+         * Point the entry points with behaviour of their own at the null
+         * backend; the rest were already pointed at functions that do
+         * nothing.
+         */
+        void    bind_null_functions()
+        {
+            gl::GenBuffers = &null_gen<buffer_names>;
+            gl::DeleteBuffers = &null_delete<buffer_names>;
+            gl::IsBuffer = &null_is<buffer_names>;
+            gl::GenVertexArrays = &null_gen<vertex_array_names>;
+            gl::DeleteVertexArrays = &null_delete<vertex_array_names>;
+            gl::IsVertexArray = &null_is<vertex_array_names>;
+            gl::GenTextures = &null_gen<texture_names>;
+            gl::DeleteTextures = &null_delete<texture_names>;
+            gl::IsTexture = &null_is<texture_names>;
+            gl::GenSamplers = &null_gen<sampler_names>;
+            gl::DeleteSamplers = &null_delete<sampler_names>;
+            gl::IsSampler = &null_is<sampler_names>;
+            gl::GenFramebuffers = &null_gen<framebuffer_names>;
+            gl::DeleteFramebuffers = &null_delete<framebuffer_names>;
+            gl::IsFramebuffer = &null_is<framebuffer_names>;
+            gl::GenRenderbuffers = &null_gen<renderbuffer_names>;
+            gl::DeleteRenderbuffers = &null_delete<renderbuffer_names>;
+            gl::IsRenderbuffer = &null_is<renderbuffer_names>;
+            gl::GenQueries = &null_gen<query_names>;
+            gl::DeleteQueries = &null_delete<query_names>;
+            gl::IsQuery = &null_is<query_names>;
+            gl::CreateShader = &null_create_shader;
+            gl::DeleteShader = &null_delete_shader;
+            gl::IsShader = &null_is<shader_names>;
+            gl::CreateProgram = &null_create_program;
+            gl::DeleteProgram = &null_delete_program;
+            gl::IsProgram = &null_is<program_names>;
+            gl::ShaderSource = &null_shader_source;
+            gl::AttachShader = &null_attach_shader;
+            gl::DetachShader = &null_detach_shader;
+            gl::LinkProgram = &null_link_program;
+            gl::GetShaderiv = &null_get_shaderiv;
+            gl::GetProgramiv = &null_get_programiv;
+            gl::GetShaderInfoLog = &null_get_shader_info_log;
+            gl::GetProgramInfoLog = &null_get_program_info_log;
+            gl::GetActiveUniform = &null_get_active_uniform;
+            gl::GetUniformLocation = &null_get_uniform_location;
+            gl::GetUniformBlockIndex = &null_get_uniform_block_index;
+            gl::GetString = &null_get_string;
+            gl::GetStringi = &null_get_stringi;
+            gl::GetIntegerv = &null_get_integerv;
+            gl::GetBooleanv = &null_get_booleanv;
+            gl::GetFloatv = &null_get_floatv;
+            gl::IsEnabled = &null_is_enabled;
+            gl::Enable = &null_enable;
+            gl::Disable = &null_disable;
+            gl::BlendFunc = &null_blend_func;
+            gl::BlendFuncSeparate = &null_blend_func_separate;
+            gl::DepthFunc = &null_depth_func;
+            gl::DepthMask = &null_depth_mask;
+            gl::CullFace = &null_cull_face;
+            gl::UseProgram = &null_use_program;
+            gl::BindVertexArray = &null_bind_vertex_array;
+            gl::BindBuffer = &null_bind_buffer;
+            gl::BindBufferBase = &null_bind_buffer_base;
+            gl::BindBufferRange = &null_bind_buffer_range;
+            gl::ActiveTexture = &null_active_texture;
+            gl::BindTexture = &null_bind_texture;
+            gl::BindSampler = &null_bind_sampler;
+            gl::BufferData = &null_buffer_data;
+            gl::BufferSubData = &null_buffer_sub_data;
+            gl::GetBufferSubData = &null_get_buffer_sub_data;
+            gl::CopyBufferSubData = &null_copy_buffer_sub_data;
+            gl::MapBuffer = &null_map_buffer;
+            gl::MapBufferRange = &null_map_buffer_range;
+            gl::UnmapBuffer = &null_unmap_buffer;
+            gl::GetBufferParameteriv = &null_get_buffer_parameteriv;
+            gl::TexImage1D = &null_tex_image_1D;
+            gl::TexImage2D = &null_tex_image_2D;
+            gl::TexImage3D = &null_tex_image_3D;
+            gl::GetTexLevelParameteriv = &null_get_tex_level_parameteriv;
+            gl::FenceSync = &null_fence_sync;
+            gl::ClientWaitSync = &null_client_wait_sync;
+            gl::DeleteSync = &null_delete_sync;
+            gl::IsSync = &null_is_sync;
+            gl::GetSynciv = &null_get_synciv;
+            gl::CheckFramebufferStatus = &null_check_framebuffer_status;
+            gl::GetError = &null_get_error;
+        }
+        /*
+         * Point every entry point at the chosen backend, through the
+         * counting layer if recording.
+         */
+        void    install()
+        {
+            if ( not driver_saved ) {
+#define GFX_GL_ENTRY( name ) GFX_GL_HOOK( name )::driver = gl::name;
+                GFX_GL_ENTRY_POINTS
+#undef GFX_GL_ENTRY
+                driver_saved = true;
+            }
+            if ( backend_v == gl_backend::null_backend ) {
+#define GFX_GL_ENTRY( name ) gl::name = &GFX_GL_HOOK( name )::none;
+                GFX_GL_ENTRY_POINTS
+#undef GFX_GL_ENTRY
+                bind_null_functions();
+            } else {
+#define GFX_GL_ENTRY( name ) gl::name = GFX_GL_HOOK( name )::driver;
+                GFX_GL_ENTRY_POINTS
+#undef GFX_GL_ENTRY
+            }
+            if ( recording_v ) {
+#define GFX_GL_ENTRY( name ) GFX_GL_HOOK( name )::next = gl::name; \
+                             gl::name = &GFX_GL_HOOK( name )::counted;
+                GFX_GL_ENTRY_POINTS
+#undef GFX_GL_ENTRY
+            }
+        }
+    }
+    /**
+     * \brief Send every gl:: call to the driver, as the loader does on its
+     * own.
+     */
+    void    gl_backend::use_driver()
+    {
+        backend_v = driver_backend;
+        install();
+    }
+    /**
+     * \brief Send every gl:: call to the null backend, starting it from a
+     * fresh context's default state with no objects.
+     */
+    void    gl_backend::use_null()
+    {
+        null() = null_state();
+        backend_v = null_backend;
+        install();
+    }
+    /**
+     * \brief Return the backend the gl:: entry points reach.
+     * \return The backend in use
+     */
+    gl_backend::kind    gl_backend::active()
+    { return backend_v; }
+    /**
+     * \brief Turn counting calls through every entry point on or off.
+     *
+     * The counts are kept when recording is turned off; use
+     * \ref reset_stats() "reset_stats()" to clear them.
+     * \param on Whether to count
+     */
+    void    gl_backend::recording( bool const on )
+    {
+        if ( on != recording_v ) {
+            recording_v = on;
+            install();
+        }
+    }
+    /**
+     * \brief Query whether calls are being counted.
+     * \return Whether recording is on
+     */
+    bool    gl_backend::recording()
+    { return recording_v; }
+    /**
+     * \brief Return the counts for one entry point.
+     * \param entry_point The name of the entry point without its gl
+     * prefix, such as "DrawElements"
+     * \return The calls made through it and the bytes they carried
+     * \exception std::invalid_argument If there is no such entry point
+     */
+    gl_backend::call_stats const&   gl_backend::stats( std::string const& entry_point )
+    {
+        for ( size_t i = 0; i < entry_count; ++i ) {
+            if ( entry_point == entry_names[i] ) {
+                return entry_stats[i];
+            }
+        }
+        throw std::invalid_argument( "No OpenGL entry point named " + entry_point + "." );
+    }
+    /**
+     * \brief Return the counts summed over every entry point.
+     * \return All calls made and all bytes carried
+     */
+    gl_backend::call_stats  gl_backend::totals()
+    {
+        call_stats sum = { 0, 0 };
+        for ( size_t i = 0; i < entry_count; ++i ) {
+            sum.calls += entry_stats[i].calls;
+            sum.bytes += entry_stats[i].bytes;
+        }
+        return sum;
+    }
+    /**
+     * \brief Set every count back to zero.
+     */
+    void    gl_backend::reset_stats()
+    {
+        for ( size_t i = 0; i < entry_count; ++i ) {
+            entry_stats[i].calls = 0;
+            entry_stats[i].bytes = 0;
+        }
+    }
+    /**
+     * \brief Write the counts of every entry point that was called, most
+     * called first.
+     * \param out The stream to write to
+     */
+    void    gl_backend::report( std::ostream& out )
+    {
+        std::vector<std::pair<size_t, size_t> > called;
+        for ( size_t i = 0; i < entry_count; ++i ) {
+            if ( entry_stats[i].calls > 0 ) {
+                called.push_back( std::make_pair( entry_stats[i].calls, i ) );
+            }
+        }
+        std::sort( called.rbegin(), called.rend() );
+        out << std::left << std::setw( 32 ) << "entry point"
+            << std::right << std::setw( 12 ) << "calls"
+            << std::setw( 14 ) << "bytes" << "\n";
+        for ( size_t i = 0; i < called.size(); ++i ) {
+            call_stats const& stats = entry_stats[called[i].second];
+            out << std::left << std::setw( 32 ) << entry_names[called[i].second]
+                << std::right << std::setw( 12 ) << stats.calls
+                << std::setw( 14 ) << stats.bytes << "\n";
+        }
+        call_stats sum = totals();
+        out << std::left << std::setw( 32 ) << "total"
+            << std::right << std::setw( 12 ) << sum.calls
+            << std::setw( 14 ) << sum.bytes << std::endl;
+    }
+    /**
+     * \brief Return how many objects the null backend has made and not yet
+     * deleted.
+     *
+     * A leak check for code run against the null backend.
+     * \return The number of live buffers, vertex arrays, textures,
+     * samplers, framebuffers, renderbuffers, queries, shaders, programs
+     * and syncs
+     */
+    size_t  gl_backend::live_objects()
+    {
+        size_t count = 0;
+        for ( size_t i = 0; i < kind_count; ++i ) {
+            count += null().live[i].size();
+        }
+        return count;
+    }
+}
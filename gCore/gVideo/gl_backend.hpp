@@ -0,0 +1,72 @@
+#ifndef GL_BACKEND_HPP
+#define GL_BACKEND_HPP
+
+#include <iostream>
+#include <string>
+#include <stdexcept>
+
+#include "gl_core_3_3.hpp"
+
+namespace gfx {
+    /**
+     * \class gfx::gl_backend gl_backend.hpp "gCore/gVideo/gl_backend.hpp"
+     * \brief Chooses what the gl:: entry points call: the driver, or a null
+     * backend that needs no window or GPU, optionally with every call
+     * counted.
+     *
+     * \ref use_null() "use_null()" points every entry point at a null
+     * implementation. It hands out object names and keeps track of which
+     * are alive, remembers bindings, enabled capabilities and the other
+     * state the scene classes query, keeps buffer contents so mapping
+     * works, and reports successful compiles and links. Uniforms declared
+     * in shader sources are reported as active after a link, so programs
+     * reflect and upload as they would with a driver. Every other call does
+     * nothing and returns zero. \ref use_driver() "use_driver()" puts the
+     * driver back.
+     *
+     * With \ref recording() "recording" on, every call through a gl::
+     * entry point is counted on its way to whichever backend is in use,
+     * along with the bytes it hands to OpenGL: buffer data, pixels,
+     * uniform values and program binaries. Over the null backend this
+     * measures the CPU cost of the scene classes on their own,
+     * deterministically, which is what the benchmarks and CI want.
+     *
+     * The null backend's state is shared by every context; a
+     * \ref gfx::context "context" built without a window is the usual
+     * companion to it. Switching backends is not thread safe and should
+     * happen before any OpenGL objects are made.
+     */
+    class gl_backend {
+    public:
+        /**
+         * \brief What the gl:: entry points reach.
+         */
+        enum kind {
+            driver_backend,
+            null_backend
+        };
+        /**
+         * \brief The calls made through one entry point and the bytes they
+         * carried.
+         */
+        struct call_stats {
+            size_t          calls;
+            size_t          bytes;
+        };
+
+        static void         use_driver();
+        static void         use_null();
+        static kind         active();
+        static void         recording( bool const on );
+        static bool         recording();
+        static call_stats const&    stats( std::string const& entry_point );
+        static call_stats   totals();
+        static void         reset_stats();
+        static void         report( std::ostream& out );
+        static size_t       live_objects();
+    private:
+                            gl_backend();
+    };
+}
+
+#endif
@@ -0,0 +1,140 @@
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "../../UnitTest++_src/UnitTest++.h"
+
+#include "video.hpp"
+
+using namespace gfx;
+
+SUITE( GLBackendTests )
+{
+    TEST( HeadlessContextNeedsNullBackend )
+    {
+        gl_backend::use_driver();
+        std::string excepted ( "Exception not caught." );
+        try {
+            context test_cntx ( ( context::settings() ) );
+        } catch ( std::logic_error& e ) {
+            excepted = "Driver backend exception caught.";
+        }
+        CHECK_EQUAL( "Driver backend exception caught.", excepted );
+    }
+
+    TEST( NullBackendObjects )
+    {
+        gl_backend::use_null();
+        context test_cntx ( ( context::settings() ) );
+        CHECK( video_system::get().context_present() );
+        CHECK_EQUAL( 3u, test_cntx.major_version() );
+
+        GLuint names[2] = { 0, 0 };
+        gl::GenBuffers( 2, names );
+        CHECK( names[0] != 0 and names[1] != 0 and names[0] != names[1] );
+        CHECK( gl::IsBuffer( names[0] ) == gl::TRUE_ );
+        CHECK_EQUAL( 2u, gl_backend::live_objects() );
+
+        gl::BindBuffer( gl::ARRAY_BUFFER, names[0] );
+        GLint bound = 0;
+        gl::GetIntegerv( gl::ARRAY_BUFFER_BINDING, &bound );
+        CHECK_EQUAL( GLint( names[0] ), bound );
+
+        float data[4] = { 1.0f, 2.0f, 3.0f, 4.0f };
+        gl::BufferData( gl::ARRAY_BUFFER, sizeof( data ), data, gl::STATIC_DRAW );
+        float changed = 5.0f;
+        gl::BufferSubData( gl::ARRAY_BUFFER, 4, sizeof( changed ), &changed );
+        float read[4] = { 0.0f };
+        gl::GetBufferSubData( gl::ARRAY_BUFFER, 0, sizeof( read ), read );
+        CHECK_EQUAL( 5.0f, read[1] );
+        CHECK_EQUAL( GLenum( gl::NO_ERROR_ ), gl::GetError() );
+        gl::BufferSubData( gl::ARRAY_BUFFER, 12, sizeof( data ), data );
+        CHECK_EQUAL( GLenum( gl::INVALID_VALUE ), gl::GetError() );
+
+        gl::DeleteBuffers( 2, names );
+        CHECK_EQUAL( 0u, gl_backend::live_objects() );
+        gl::GetIntegerv( gl::ARRAY_BUFFER_BINDING, &bound );
+        CHECK_EQUAL( 0, bound );
+        gl::BindBuffer( gl::ARRAY_BUFFER, names[0] );
+        CHECK_EQUAL( GLenum( gl::INVALID_OPERATION ), gl::GetError() );
+    }
+
+    TEST( NullBackendUniforms )
+    {
+        gl_backend::use_null();
+        context test_cntx ( ( context::settings() ) );
+
+        char const* source = "#version 330\n"
+                             "uniform mat4 model; // the transform\n"
+                             "uniform vec4 tint, lights[4];\n"
+                             "/* uniform float unused; */\n"
+                             "uniform camera { mat4 view; };\n"
+                             "void main() {}\n";
+        GLuint vert = gl::CreateShader( gl::VERTEX_SHADER );
+        gl::ShaderSource( vert, 1, &source, 0 );
+        gl::CompileShader( vert );
+        GLint status = gl::FALSE_;
+        gl::GetShaderiv( vert, gl::COMPILE_STATUS, &status );
+        CHECK_EQUAL( GLint( gl::TRUE_ ), status );
+
+        GLuint prog = gl::CreateProgram();
+        gl::AttachShader( prog, vert );
+        gl::LinkProgram( prog );
+        GLint count = 0;
+        gl::GetProgramiv( prog, gl::ACTIVE_UNIFORMS, &count );
+        CHECK_EQUAL( 3, count );
+        CHECK_EQUAL( 0, gl::GetUniformLocation( prog, "model" ) );
+        CHECK_EQUAL( 1, gl::GetUniformLocation( prog, "tint" ) );
+        CHECK_EQUAL( 4, gl::GetUniformLocation( prog, "lights[2]" ) );
+        CHECK_EQUAL( -1, gl::GetUniformLocation( prog, "unused" ) );
+        CHECK_EQUAL( 0u, gl::GetUniformBlockIndex( prog, "camera" ) );
+
+        GLchar name[16];
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        gl::GetActiveUniform( prog, 2, sizeof( name ), &length, &size, &type, name );
+        CHECK_EQUAL( "lights[0]", std::string( name, length ) );
+        CHECK_EQUAL( 4, size );
+        CHECK_EQUAL( GLenum( gl::FLOAT_VEC4 ), type );
+
+        gl::DeleteProgram( prog );
+        gl::DeleteShader( vert );
+        CHECK_EQUAL( 0u, gl_backend::live_objects() );
+    }
+
+    TEST( RecordingCounts )
+    {
+        gl_backend::use_null();
+        context test_cntx ( ( context::settings() ) );
+        gl_backend::reset_stats();
+        gl_backend::recording( true );
+
+        GLuint buff_ID = 0;
+        gl::GenBuffers( 1, &buff_ID );
+        gl::BindBuffer( gl::ARRAY_BUFFER, buff_ID );
+        gl::BufferData( gl::ARRAY_BUFFER, 256, 0, gl::DYNAMIC_DRAW );
+        float matrices[32] = { 0.0f };
+        gl::UniformMatrix4fv( 0, 2, gl::FALSE_, matrices );
+        for ( size_t i = 0; i < 3; ++i ) {
+            gl::DrawArrays( gl::TRIANGLES, 0, 3 );
+        }
+        gl_backend::recording( false );
+        gl::DrawArrays( gl::TRIANGLES, 0, 3 );
+
+        CHECK_EQUAL( 3u, gl_backend::stats( "DrawArrays" ).calls );
+        CHECK_EQUAL( 256u, gl_backend::stats( "BufferData" ).bytes );
+        CHECK_EQUAL( 128u, gl_backend::stats( "UniformMatrix4fv" ).bytes );
+        CHECK_EQUAL( 7u, gl_backend::totals().calls );
+        CHECK_EQUAL( 384u, gl_backend::totals().bytes );
+        // The null backend still saw the calls
+        CHECK( gl::IsBuffer( buff_ID ) == gl::TRUE_ );
+        CHECK_THROW( gl_backend::stats( "NoSuchCall" ), std::invalid_argument );
+        gl::DeleteBuffers( 1, &buff_ID );
+    }
+}
+
+int main( int argc, char* argv[] )
+{
+    return UnitTest::RunAllTests();
+}
@@ -98,6 +98,9 @@ namespace gl
 {
 	namespace exts
 	{
+		bool var_ARB_get_program_binary = false;
+		bool var_KHR_parallel_shader_compile = false;
+		bool var_KHR_debug = false;
 	}
 	
 	// Extension: 1.1
@@ -489,6 +492,19 @@ namespace gl
 	// Extension: 3.3
 	typedef void (CODEGEN_FUNCPTR *PFNVERTEXATTRIBDIVISORPROC)(GLuint , GLuint );
 	
+	// Extension: ARB_get_program_binary
+	typedef void (CODEGEN_FUNCPTR *PFNGETPROGRAMBINARYPROC)(GLuint , GLsizei , GLsizei *, GLenum *, GLvoid *);
+	typedef void (CODEGEN_FUNCPTR *PFNPROGRAMBINARYPROC)(GLuint , GLenum , const GLvoid *, GLsizei );
+	typedef void (CODEGEN_FUNCPTR *PFNPROGRAMPARAMETERIPROC)(GLuint , GLenum , GLint );
+	
+	// Extension: KHR_parallel_shader_compile
+	typedef void (CODEGEN_FUNCPTR *PFNMAXSHADERCOMPILERTHREADSKHRPROC)(GLuint );
+	
+	// Extension: KHR_debug
+	typedef void (CODEGEN_FUNCPTR *PFNDEBUGMESSAGECONTROLPROC)(GLenum , GLenum , GLenum , GLsizei , const GLuint *, GLboolean );
+	typedef void (CODEGEN_FUNCPTR *PFNDEBUGMESSAGEINSERTPROC)(GLenum , GLenum , GLuint , GLenum , GLsizei , const GLchar *);
+	typedef void (CODEGEN_FUNCPTR *PFNDEBUGMESSAGECALLBACKPROC)(GLDEBUGPROC , const GLvoid *);
+	
 	
 	// Extension: 1.1
 	PFNCULLFACEPROC CullFace;
@@ -879,6 +895,19 @@ namespace gl
 	// Extension: 3.3
 	PFNVERTEXATTRIBDIVISORPROC VertexAttribDivisor;
 	
+	// Extension: ARB_get_program_binary
+	PFNGETPROGRAMBINARYPROC GetProgramBinary;
+	PFNPROGRAMBINARYPROC ProgramBinary;
+	PFNPROGRAMPARAMETERIPROC ProgramParameteri;
+	
+	// Extension: KHR_parallel_shader_compile
+	PFNMAXSHADERCOMPILERTHREADSKHRPROC MaxShaderCompilerThreadsKHR;
+	
+	// Extension: KHR_debug
+	PFNDEBUGMESSAGECONTROLPROC DebugMessageControl;
+	PFNDEBUGMESSAGEINSERTPROC DebugMessageInsert;
+	PFNDEBUGMESSAGECALLBACKPROC DebugMessageCallback;
+	
 	
 	// Extension: 1.1
 	static void CODEGEN_FUNCPTR Switch_CullFace(GLenum mode)
@@ -2974,6 +3003,54 @@ namespace gl
 	}
 
 	
+	// Extension: ARB_get_program_binary
+	static void CODEGEN_FUNCPTR Switch_GetProgramBinary(GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, GLvoid *binary)
+	{
+		GetProgramBinary = (PFNGETPROGRAMBINARYPROC)IntGetProcAddress("glGetProgramBinary");
+		GetProgramBinary(program, bufSize, length, binaryFormat, binary);
+	}
+
+	static void CODEGEN_FUNCPTR Switch_ProgramBinary(GLuint program, GLenum binaryFormat, const GLvoid *binary, GLsizei length)
+	{
+		ProgramBinary = (PFNPROGRAMBINARYPROC)IntGetProcAddress("glProgramBinary");
+		ProgramBinary(program, binaryFormat, binary, length);
+	}
+
+	static void CODEGEN_FUNCPTR Switch_ProgramParameteri(GLuint program, GLenum pname, GLint value)
+	{
+		ProgramParameteri = (PFNPROGRAMPARAMETERIPROC)IntGetProcAddress("glProgramParameteri");
+		ProgramParameteri(program, pname, value);
+	}
+
+	
+	// Extension: KHR_parallel_shader_compile
+	static void CODEGEN_FUNCPTR Switch_MaxShaderCompilerThreadsKHR(GLuint count)
+	{
+		MaxShaderCompilerThreadsKHR = (PFNMAXSHADERCOMPILERTHREADSKHRPROC)IntGetProcAddress("glMaxShaderCompilerThreadsKHR");
+		MaxShaderCompilerThreadsKHR(count);
+	}
+
+	
+	// Extension: KHR_debug
+	static void CODEGEN_FUNCPTR Switch_DebugMessageControl(GLenum source, GLenum type, GLenum severity, GLsizei count, const GLuint *ids, GLboolean enabled)
+	{
+		DebugMessageControl = (PFNDEBUGMESSAGECONTROLPROC)IntGetProcAddress("glDebugMessageControl");
+		DebugMessageControl(source, type, severity, count, ids, enabled);
+	}
+
+	static void CODEGEN_FUNCPTR Switch_DebugMessageInsert(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar *buf)
+	{
+		DebugMessageInsert = (PFNDEBUGMESSAGEINSERTPROC)IntGetProcAddress("glDebugMessageInsert");
+		DebugMessageInsert(source, type, id, severity, length, buf);
+	}
+
+	static void CODEGEN_FUNCPTR Switch_DebugMessageCallback(GLDEBUGPROC callback, const GLvoid *userParam)
+	{
+		DebugMessageCallback = (PFNDEBUGMESSAGECALLBACKPROC)IntGetProcAddress("glDebugMessageCallback");
+		DebugMessageCallback(callback, userParam);
+	}
+
+	
 	
 	namespace 
 	{
@@ -3370,6 +3447,19 @@ namespace gl
 				// Extension: 3.3
 				VertexAttribDivisor = Switch_VertexAttribDivisor;
 				
+				// Extension: ARB_get_program_binary
+				GetProgramBinary = Switch_GetProgramBinary;
+				ProgramBinary = Switch_ProgramBinary;
+				ProgramParameteri = Switch_ProgramParameteri;
+				
+				// Extension: KHR_parallel_shader_compile
+				MaxShaderCompilerThreadsKHR = Switch_MaxShaderCompilerThreadsKHR;
+				
+				// Extension: KHR_debug
+				DebugMessageControl = Switch_DebugMessageControl;
+				DebugMessageInsert = Switch_DebugMessageInsert;
+				DebugMessageCallback = Switch_DebugMessageCallback;
+				
 			}
 		};
 
@@ -3382,6 +3472,9 @@ namespace gl
 		{
 			void ClearExtensionVariables()
 			{
+				exts::var_ARB_get_program_binary = false;
+				exts::var_KHR_parallel_shader_compile = false;
+				exts::var_KHR_debug = false;
 			}
 			
 			struct MapEntry
@@ -3402,13 +3495,16 @@ namespace gl
 			  void operator()(MapEntry &entry) { *(entry.extVariable) = false;}
 			};
 			
-			MapEntry g_mappingTable[1] =
+			MapEntry g_mappingTable[3] =
 			{
+				{"GL_ARB_get_program_binary", &exts::var_ARB_get_program_binary},
+				{"GL_KHR_parallel_shader_compile", &exts::var_KHR_parallel_shader_compile},
+				{"GL_KHR_debug", &exts::var_KHR_debug},
 			};
 			
 			void LoadExtByName(const char *extensionName)
 			{
-				MapEntry *tableEnd = &g_mappingTable[0];
+				MapEntry *tableEnd = &g_mappingTable[3];
 				MapEntry *entry = std::find_if(&g_mappingTable[0], tableEnd, MapCompare(extensionName));
 				
 				if(entry != tableEnd)
@@ -3431,7 +3527,7 @@ namespace gl
 		void CheckExtensions()
 		{
 			ClearExtensionVariables();
-			std::for_each(&g_mappingTable[0], &g_mappingTable[0], ClearEntry());
+			std::for_each(&g_mappingTable[0], &g_mappingTable[3], ClearEntry());
 			
 			ProcExtsFromExtList();
 		}
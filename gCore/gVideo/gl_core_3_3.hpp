@@ -171,6 +171,9 @@ namespace gl
 	// Extension Variables
 	namespace exts
 	{
+		extern bool var_ARB_get_program_binary;
+		extern bool var_KHR_parallel_shader_compile;
+		extern bool var_KHR_debug;
 	}
 	
 	enum
@@ -1121,6 +1124,37 @@ namespace gl
 		// Version: 3.3
 		VERTEX_ATTRIB_ARRAY_DIVISOR      = 0x88FE,
 		
+		// Extension: ARB_get_program_binary
+		PROGRAM_BINARY_RETRIEVABLE_HINT  = 0x8257,
+		PROGRAM_BINARY_LENGTH            = 0x8741,
+		NUM_PROGRAM_BINARY_FORMATS       = 0x87FE,
+		PROGRAM_BINARY_FORMATS           = 0x87FF,
+		
+		// Extension: KHR_parallel_shader_compile
+		MAX_SHADER_COMPILER_THREADS_KHR  = 0x91B0,
+		COMPLETION_STATUS_KHR            = 0x91B1,
+		
+		// Extension: KHR_debug
+		DEBUG_OUTPUT_SYNCHRONOUS         = 0x8242,
+		DEBUG_SOURCE_API                 = 0x8246,
+		DEBUG_SOURCE_WINDOW_SYSTEM       = 0x8247,
+		DEBUG_SOURCE_SHADER_COMPILER     = 0x8248,
+		DEBUG_SOURCE_THIRD_PARTY         = 0x8249,
+		DEBUG_SOURCE_APPLICATION         = 0x824A,
+		DEBUG_SOURCE_OTHER               = 0x824B,
+		DEBUG_TYPE_ERROR                 = 0x824C,
+		DEBUG_TYPE_DEPRECATED_BEHAVIOR   = 0x824D,
+		DEBUG_TYPE_UNDEFINED_BEHAVIOR    = 0x824E,
+		DEBUG_TYPE_PORTABILITY           = 0x824F,
+		DEBUG_TYPE_PERFORMANCE           = 0x8250,
+		DEBUG_TYPE_OTHER                 = 0x8251,
+		DEBUG_TYPE_MARKER                = 0x8268,
+		DEBUG_SEVERITY_NOTIFICATION      = 0x826B,
+		DEBUG_SEVERITY_HIGH              = 0x9146,
+		DEBUG_SEVERITY_MEDIUM            = 0x9147,
+		DEBUG_SEVERITY_LOW               = 0x9148,
+		DEBUG_OUTPUT                     = 0x92E0,
+		
 	};
 	
 	// Extension: 1.1
@@ -1512,6 +1546,19 @@ namespace gl
 	// Extension: 3.3
 	extern void (CODEGEN_FUNCPTR *VertexAttribDivisor)(GLuint index, GLuint divisor);
 	
+	// Extension: ARB_get_program_binary
+	extern void (CODEGEN_FUNCPTR *GetProgramBinary)(GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, GLvoid *binary);
+	extern void (CODEGEN_FUNCPTR *ProgramBinary)(GLuint program, GLenum binaryFormat, const GLvoid *binary, GLsizei length);
+	extern void (CODEGEN_FUNCPTR *ProgramParameteri)(GLuint program, GLenum pname, GLint value);
+	
+	// Extension: KHR_parallel_shader_compile
+	extern void (CODEGEN_FUNCPTR *MaxShaderCompilerThreadsKHR)(GLuint count);
+	
+	// Extension: KHR_debug
+	extern void (CODEGEN_FUNCPTR *DebugMessageControl)(GLenum source, GLenum type, GLenum severity, GLsizei count, const GLuint *ids, GLboolean enabled);
+	extern void (CODEGEN_FUNCPTR *DebugMessageInsert)(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar *buf);
+	extern void (CODEGEN_FUNCPTR *DebugMessageCallback)(GLDEBUGPROC callback, const GLvoid *userParam);
+	
 	namespace sys
 	{
 		void CheckExtensions();
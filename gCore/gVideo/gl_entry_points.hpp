@@ -0,0 +1,387 @@
+#ifndef GL_ENTRY_POINTS_HPP
+#define GL_ENTRY_POINTS_HPP
+
+/*
+ * Every entry point gl_core_3_3 loads, as one GFX_GL_ENTRY( name ) per
+ * line, for code that has to visit all of them. Define GFX_GL_ENTRY, then
+ * expand GFX_GL_ENTRY_POINTS. Keep this in step with gl_core_3_3.hpp when
+ * the loader is regenerated.
+ */
+#define GFX_GL_ENTRY_POINTS \
+    /* 1.1 */ \
+    GFX_GL_ENTRY( CullFace ) \
+    GFX_GL_ENTRY( FrontFace ) \
+    GFX_GL_ENTRY( Hint ) \
+    GFX_GL_ENTRY( LineWidth ) \
+    GFX_GL_ENTRY( PointSize ) \
+    GFX_GL_ENTRY( PolygonMode ) \
+    GFX_GL_ENTRY( Scissor ) \
+    GFX_GL_ENTRY( TexParameterf ) \
+    GFX_GL_ENTRY( TexParameterfv ) \
+    GFX_GL_ENTRY( TexParameteri ) \
+    GFX_GL_ENTRY( TexParameteriv ) \
+    GFX_GL_ENTRY( TexImage1D ) \
+    GFX_GL_ENTRY( TexImage2D ) \
+    GFX_GL_ENTRY( DrawBuffer ) \
+    GFX_GL_ENTRY( Clear ) \
+    GFX_GL_ENTRY( ClearColor ) \
+    GFX_GL_ENTRY( ClearStencil ) \
+    GFX_GL_ENTRY( ClearDepth ) \
+    GFX_GL_ENTRY( StencilMask ) \
+    GFX_GL_ENTRY( ColorMask ) \
+    GFX_GL_ENTRY( DepthMask ) \
+    GFX_GL_ENTRY( Disable ) \
+    GFX_GL_ENTRY( Enable ) \
+    GFX_GL_ENTRY( Finish ) \
+    GFX_GL_ENTRY( Flush ) \
+    GFX_GL_ENTRY( BlendFunc ) \
+    GFX_GL_ENTRY( LogicOp ) \
+    GFX_GL_ENTRY( StencilFunc ) \
+    GFX_GL_ENTRY( StencilOp ) \
+    GFX_GL_ENTRY( DepthFunc ) \
+    GFX_GL_ENTRY( PixelStoref ) \
+    GFX_GL_ENTRY( PixelStorei ) \
+    GFX_GL_ENTRY( ReadBuffer ) \
+    GFX_GL_ENTRY( ReadPixels ) \
+    GFX_GL_ENTRY( GetBooleanv ) \
+    GFX_GL_ENTRY( GetDoublev ) \
+    GFX_GL_ENTRY( GetError ) \
+    GFX_GL_ENTRY( GetFloatv ) \
+    GFX_GL_ENTRY( GetIntegerv ) \
+    GFX_GL_ENTRY( GetString ) \
+    GFX_GL_ENTRY( GetTexImage ) \
+    GFX_GL_ENTRY( GetTexParameterfv ) \
+    GFX_GL_ENTRY( GetTexParameteriv ) \
+    GFX_GL_ENTRY( GetTexLevelParameterfv ) \
+    GFX_GL_ENTRY( GetTexLevelParameteriv ) \
+    GFX_GL_ENTRY( IsEnabled ) \
+    GFX_GL_ENTRY( DepthRange ) \
+    GFX_GL_ENTRY( Viewport ) \
+    GFX_GL_ENTRY( DrawArrays ) \
+    GFX_GL_ENTRY( DrawElements ) \
+    GFX_GL_ENTRY( GetPointerv ) \
+    GFX_GL_ENTRY( PolygonOffset ) \
+    GFX_GL_ENTRY( CopyTexImage1D ) \
+    GFX_GL_ENTRY( CopyTexImage2D ) \
+    GFX_GL_ENTRY( CopyTexSubImage1D ) \
+    GFX_GL_ENTRY( CopyTexSubImage2D ) \
+    GFX_GL_ENTRY( TexSubImage1D ) \
+    GFX_GL_ENTRY( TexSubImage2D ) \
+    GFX_GL_ENTRY( BindTexture ) \
+    GFX_GL_ENTRY( DeleteTextures ) \
+    GFX_GL_ENTRY( GenTextures ) \
+    GFX_GL_ENTRY( IsTexture ) \
+    GFX_GL_ENTRY( Indexub ) \
+    GFX_GL_ENTRY( Indexubv ) \
+    /* 1.2 */ \
+    GFX_GL_ENTRY( BlendColor ) \
+    GFX_GL_ENTRY( BlendEquation ) \
+    GFX_GL_ENTRY( DrawRangeElements ) \
+    GFX_GL_ENTRY( TexImage3D ) \
+    GFX_GL_ENTRY( TexSubImage3D ) \
+    GFX_GL_ENTRY( CopyTexSubImage3D ) \
+    /* 1.3 */ \
+    GFX_GL_ENTRY( ActiveTexture ) \
+    GFX_GL_ENTRY( SampleCoverage ) \
+    GFX_GL_ENTRY( CompressedTexImage3D ) \
+    GFX_GL_ENTRY( CompressedTexImage2D ) \
+    GFX_GL_ENTRY( CompressedTexImage1D ) \
+    GFX_GL_ENTRY( CompressedTexSubImage3D ) \
+    GFX_GL_ENTRY( CompressedTexSubImage2D ) \
+    GFX_GL_ENTRY( CompressedTexSubImage1D ) \
+    GFX_GL_ENTRY( GetCompressedTexImage ) \
+    /* 1.4 */ \
+    GFX_GL_ENTRY( BlendFuncSeparate ) \
+    GFX_GL_ENTRY( MultiDrawArrays ) \
+    GFX_GL_ENTRY( MultiDrawElements ) \
+    GFX_GL_ENTRY( PointParameterf ) \
+    GFX_GL_ENTRY( PointParameterfv ) \
+    GFX_GL_ENTRY( PointParameteri ) \
+    GFX_GL_ENTRY( PointParameteriv ) \
+    /* 1.5 */ \
+    GFX_GL_ENTRY( GenQueries ) \
+    GFX_GL_ENTRY( DeleteQueries ) \
+    GFX_GL_ENTRY( IsQuery ) \
+    GFX_GL_ENTRY( BeginQuery ) \
+    GFX_GL_ENTRY( EndQuery ) \
+    GFX_GL_ENTRY( GetQueryiv ) \
+    GFX_GL_ENTRY( GetQueryObjectiv ) \
+    GFX_GL_ENTRY( GetQueryObjectuiv ) \
+    GFX_GL_ENTRY( BindBuffer ) \
+    GFX_GL_ENTRY( DeleteBuffers ) \
+    GFX_GL_ENTRY( GenBuffers ) \
+    GFX_GL_ENTRY( IsBuffer ) \
+    GFX_GL_ENTRY( BufferData ) \
+    GFX_GL_ENTRY( BufferSubData ) \
+    GFX_GL_ENTRY( GetBufferSubData ) \
+    GFX_GL_ENTRY( MapBuffer ) \
+    GFX_GL_ENTRY( UnmapBuffer ) \
+    GFX_GL_ENTRY( GetBufferParameteriv ) \
+    GFX_GL_ENTRY( GetBufferPointerv ) \
+    /* 2.0 */ \
+    GFX_GL_ENTRY( BlendEquationSeparate ) \
+    GFX_GL_ENTRY( DrawBuffers ) \
+    GFX_GL_ENTRY( StencilOpSeparate ) \
+    GFX_GL_ENTRY( StencilFuncSeparate ) \
+    GFX_GL_ENTRY( StencilMaskSeparate ) \
+    GFX_GL_ENTRY( AttachShader ) \
+    GFX_GL_ENTRY( BindAttribLocation ) \
+    GFX_GL_ENTRY( CompileShader ) \
+    GFX_GL_ENTRY( CreateProgram ) \
+    GFX_GL_ENTRY( CreateShader ) \
+    GFX_GL_ENTRY( DeleteProgram ) \
+    GFX_GL_ENTRY( DeleteShader ) \
+    GFX_GL_ENTRY( DetachShader ) \
+    GFX_GL_ENTRY( DisableVertexAttribArray ) \
+    GFX_GL_ENTRY( EnableVertexAttribArray ) \
+    GFX_GL_ENTRY( GetActiveAttrib ) \
+    GFX_GL_ENTRY( GetActiveUniform ) \
+    GFX_GL_ENTRY( GetAttachedShaders ) \
+    GFX_GL_ENTRY( GetAttribLocation ) \
+    GFX_GL_ENTRY( GetProgramiv ) \
+    GFX_GL_ENTRY( GetProgramInfoLog ) \
+    GFX_GL_ENTRY( GetShaderiv ) \
+    GFX_GL_ENTRY( GetShaderInfoLog ) \
+    GFX_GL_ENTRY( GetShaderSource ) \
+    GFX_GL_ENTRY( GetUniformLocation ) \
+    GFX_GL_ENTRY( GetUniformfv ) \
+    GFX_GL_ENTRY( GetUniformiv ) \
+    GFX_GL_ENTRY( GetVertexAttribdv ) \
+    GFX_GL_ENTRY( GetVertexAttribfv ) \
+    GFX_GL_ENTRY( GetVertexAttribiv ) \
+    GFX_GL_ENTRY( GetVertexAttribPointerv ) \
+    GFX_GL_ENTRY( IsProgram ) \
+    GFX_GL_ENTRY( IsShader ) \
+    GFX_GL_ENTRY( LinkProgram ) \
+    GFX_GL_ENTRY( ShaderSource ) \
+    GFX_GL_ENTRY( UseProgram ) \
+    GFX_GL_ENTRY( Uniform1f ) \
+    GFX_GL_ENTRY( Uniform2f ) \
+    GFX_GL_ENTRY( Uniform3f ) \
+    GFX_GL_ENTRY( Uniform4f ) \
+    GFX_GL_ENTRY( Uniform1i ) \
+    GFX_GL_ENTRY( Uniform2i ) \
+    GFX_GL_ENTRY( Uniform3i ) \
+    GFX_GL_ENTRY( Uniform4i ) \
+    GFX_GL_ENTRY( Uniform1fv ) \
+    GFX_GL_ENTRY( Uniform2fv ) \
+    GFX_GL_ENTRY( Uniform3fv ) \
+    GFX_GL_ENTRY( Uniform4fv ) \
+    GFX_GL_ENTRY( Uniform1iv ) \
+    GFX_GL_ENTRY( Uniform2iv ) \
+    GFX_GL_ENTRY( Uniform3iv ) \
+    GFX_GL_ENTRY( Uniform4iv ) \
+    GFX_GL_ENTRY( UniformMatrix2fv ) \
+    GFX_GL_ENTRY( UniformMatrix3fv ) \
+    GFX_GL_ENTRY( UniformMatrix4fv ) \
+    GFX_GL_ENTRY( ValidateProgram ) \
+    GFX_GL_ENTRY( VertexAttribPointer ) \
+    /* 2.1 */ \
+    GFX_GL_ENTRY( UniformMatrix2x3fv ) \
+    GFX_GL_ENTRY( UniformMatrix3x2fv ) \
+    GFX_GL_ENTRY( UniformMatrix2x4fv ) \
+    GFX_GL_ENTRY( UniformMatrix4x2fv ) \
+    GFX_GL_ENTRY( UniformMatrix3x4fv ) \
+    GFX_GL_ENTRY( UniformMatrix4x3fv ) \
+    /* ARB_vertex_array_object */ \
+    GFX_GL_ENTRY( BindVertexArray ) \
+    GFX_GL_ENTRY( DeleteVertexArrays ) \
+    GFX_GL_ENTRY( GenVertexArrays ) \
+    GFX_GL_ENTRY( IsVertexArray ) \
+    /* ARB_map_buffer_range */ \
+    GFX_GL_ENTRY( MapBufferRange ) \
+    GFX_GL_ENTRY( FlushMappedBufferRange ) \
+    /* ARB_framebuffer_object */ \
+    GFX_GL_ENTRY( IsRenderbuffer ) \
+    GFX_GL_ENTRY( BindRenderbuffer ) \
+    GFX_GL_ENTRY( DeleteRenderbuffers ) \
+    GFX_GL_ENTRY( GenRenderbuffers ) \
+    GFX_GL_ENTRY( RenderbufferStorage ) \
+    GFX_GL_ENTRY( GetRenderbufferParameteriv ) \
+    GFX_GL_ENTRY( IsFramebuffer ) \
+    GFX_GL_ENTRY( BindFramebuffer ) \
+    GFX_GL_ENTRY( DeleteFramebuffers ) \
+    GFX_GL_ENTRY( GenFramebuffers ) \
+    GFX_GL_ENTRY( CheckFramebufferStatus ) \
+    GFX_GL_ENTRY( FramebufferTexture1D ) \
+    GFX_GL_ENTRY( FramebufferTexture2D ) \
+    GFX_GL_ENTRY( FramebufferTexture3D ) \
+    GFX_GL_ENTRY( FramebufferRenderbuffer ) \
+    GFX_GL_ENTRY( GetFramebufferAttachmentParameteriv ) \
+    GFX_GL_ENTRY( GenerateMipmap ) \
+    GFX_GL_ENTRY( BlitFramebuffer ) \
+    GFX_GL_ENTRY( RenderbufferStorageMultisample ) \
+    GFX_GL_ENTRY( FramebufferTextureLayer ) \
+    /* 3.0 */ \
+    GFX_GL_ENTRY( ColorMaski ) \
+    GFX_GL_ENTRY( GetBooleani_v ) \
+    GFX_GL_ENTRY( GetIntegeri_v ) \
+    GFX_GL_ENTRY( Enablei ) \
+    GFX_GL_ENTRY( Disablei ) \
+    GFX_GL_ENTRY( IsEnabledi ) \
+    GFX_GL_ENTRY( BeginTransformFeedback ) \
+    GFX_GL_ENTRY( EndTransformFeedback ) \
+    GFX_GL_ENTRY( BindBufferRange ) \
+    GFX_GL_ENTRY( BindBufferBase ) \
+    GFX_GL_ENTRY( TransformFeedbackVaryings ) \
+    GFX_GL_ENTRY( GetTransformFeedbackVarying ) \
+    GFX_GL_ENTRY( ClampColor ) \
+    GFX_GL_ENTRY( BeginConditionalRender ) \
+    GFX_GL_ENTRY( EndConditionalRender ) \
+    GFX_GL_ENTRY( VertexAttribIPointer ) \
+    GFX_GL_ENTRY( GetVertexAttribIiv ) \
+    GFX_GL_ENTRY( GetVertexAttribIuiv ) \
+    GFX_GL_ENTRY( VertexAttribI1i ) \
+    GFX_GL_ENTRY( VertexAttribI2i ) \
+    GFX_GL_ENTRY( VertexAttribI3i ) \
+    GFX_GL_ENTRY( VertexAttribI4i ) \
+    GFX_GL_ENTRY( VertexAttribI1ui ) \
+    GFX_GL_ENTRY( VertexAttribI2ui ) \
+    GFX_GL_ENTRY( VertexAttribI3ui ) \
+    GFX_GL_ENTRY( VertexAttribI4ui ) \
+    GFX_GL_ENTRY( VertexAttribI1iv ) \
+    GFX_GL_ENTRY( VertexAttribI2iv ) \
+    GFX_GL_ENTRY( VertexAttribI3iv ) \
+    GFX_GL_ENTRY( VertexAttribI4iv ) \
+    GFX_GL_ENTRY( VertexAttribI1uiv ) \
+    GFX_GL_ENTRY( VertexAttribI2uiv ) \
+    GFX_GL_ENTRY( VertexAttribI3uiv ) \
+    GFX_GL_ENTRY( VertexAttribI4uiv ) \
+    GFX_GL_ENTRY( VertexAttribI4bv ) \
+    GFX_GL_ENTRY( VertexAttribI4sv ) \
+    GFX_GL_ENTRY( VertexAttribI4ubv ) \
+    GFX_GL_ENTRY( VertexAttribI4usv ) \
+    GFX_GL_ENTRY( GetUniformuiv ) \
+    GFX_GL_ENTRY( BindFragDataLocation ) \
+    GFX_GL_ENTRY( GetFragDataLocation ) \
+    GFX_GL_ENTRY( Uniform1ui ) \
+    GFX_GL_ENTRY( Uniform2ui ) \
+    GFX_GL_ENTRY( Uniform3ui ) \
+    GFX_GL_ENTRY( Uniform4ui ) \
+    GFX_GL_ENTRY( Uniform1uiv ) \
+    GFX_GL_ENTRY( Uniform2uiv ) \
+    GFX_GL_ENTRY( Uniform3uiv ) \
+    GFX_GL_ENTRY( Uniform4uiv ) \
+    GFX_GL_ENTRY( TexParameterIiv ) \
+    GFX_GL_ENTRY( TexParameterIuiv ) \
+    GFX_GL_ENTRY( GetTexParameterIiv ) \
+    GFX_GL_ENTRY( GetTexParameterIuiv ) \
+    GFX_GL_ENTRY( ClearBufferiv ) \
+    GFX_GL_ENTRY( ClearBufferuiv ) \
+    GFX_GL_ENTRY( ClearBufferfv ) \
+    GFX_GL_ENTRY( ClearBufferfi ) \
+    GFX_GL_ENTRY( GetStringi ) \
+    /* ARB_uniform_buffer_object */ \
+    GFX_GL_ENTRY( GetUniformIndices ) \
+    GFX_GL_ENTRY( GetActiveUniformsiv ) \
+    GFX_GL_ENTRY( GetActiveUniformName ) \
+    GFX_GL_ENTRY( GetUniformBlockIndex ) \
+    GFX_GL_ENTRY( GetActiveUniformBlockiv ) \
+    GFX_GL_ENTRY( GetActiveUniformBlockName ) \
+    GFX_GL_ENTRY( UniformBlockBinding ) \
+    /* ARB_copy_buffer */ \
+    GFX_GL_ENTRY( CopyBufferSubData ) \
+    /* 3.1 */ \
+    GFX_GL_ENTRY( DrawArraysInstanced ) \
+    GFX_GL_ENTRY( DrawElementsInstanced ) \
+    GFX_GL_ENTRY( TexBuffer ) \
+    GFX_GL_ENTRY( PrimitiveRestartIndex ) \
+    /* ARB_draw_elements_base_vertex */ \
+    GFX_GL_ENTRY( DrawElementsBaseVertex ) \
+    GFX_GL_ENTRY( DrawRangeElementsBaseVertex ) \
+    GFX_GL_ENTRY( DrawElementsInstancedBaseVertex ) \
+    GFX_GL_ENTRY( MultiDrawElementsBaseVertex ) \
+    /* ARB_provoking_vertex */ \
+    GFX_GL_ENTRY( ProvokingVertex ) \
+    /* ARB_sync */ \
+    GFX_GL_ENTRY( FenceSync ) \
+    GFX_GL_ENTRY( IsSync ) \
+    GFX_GL_ENTRY( DeleteSync ) \
+    GFX_GL_ENTRY( ClientWaitSync ) \
+    GFX_GL_ENTRY( WaitSync ) \
+    GFX_GL_ENTRY( GetInteger64v ) \
+    GFX_GL_ENTRY( GetSynciv ) \
+    /* ARB_texture_multisample */ \
+    GFX_GL_ENTRY( TexImage2DMultisample ) \
+    GFX_GL_ENTRY( TexImage3DMultisample ) \
+    GFX_GL_ENTRY( GetMultisamplefv ) \
+    GFX_GL_ENTRY( SampleMaski ) \
+    /* 3.2 */ \
+    GFX_GL_ENTRY( GetInteger64i_v ) \
+    GFX_GL_ENTRY( GetBufferParameteri64v ) \
+    GFX_GL_ENTRY( FramebufferTexture ) \
+    /* ARB_timer_query */ \
+    GFX_GL_ENTRY( QueryCounter ) \
+    GFX_GL_ENTRY( GetQueryObjecti64v ) \
+    GFX_GL_ENTRY( GetQueryObjectui64v ) \
+    /* ARB_vertex_type_2_10_10_10_rev */ \
+    GFX_GL_ENTRY( VertexP2ui ) \
+    GFX_GL_ENTRY( VertexP2uiv ) \
+    GFX_GL_ENTRY( VertexP3ui ) \
+    GFX_GL_ENTRY( VertexP3uiv ) \
+    GFX_GL_ENTRY( VertexP4ui ) \
+    GFX_GL_ENTRY( VertexP4uiv ) \
+    GFX_GL_ENTRY( TexCoordP1ui ) \
+    GFX_GL_ENTRY( TexCoordP1uiv ) \
+    GFX_GL_ENTRY( TexCoordP2ui ) \
+    GFX_GL_ENTRY( TexCoordP2uiv ) \
+    GFX_GL_ENTRY( TexCoordP3ui ) \
+    GFX_GL_ENTRY( TexCoordP3uiv ) \
+    GFX_GL_ENTRY( TexCoordP4ui ) \
+    GFX_GL_ENTRY( TexCoordP4uiv ) \
+    GFX_GL_ENTRY( MultiTexCoordP1ui ) \
+    GFX_GL_ENTRY( MultiTexCoordP1uiv ) \
+    GFX_GL_ENTRY( MultiTexCoordP2ui ) \
+    GFX_GL_ENTRY( MultiTexCoordP2uiv ) \
+    GFX_GL_ENTRY( MultiTexCoordP3ui ) \
+    GFX_GL_ENTRY( MultiTexCoordP3uiv ) \
+    GFX_GL_ENTRY( MultiTexCoordP4ui ) \
+    GFX_GL_ENTRY( MultiTexCoordP4uiv ) \
+    GFX_GL_ENTRY( NormalP3ui ) \
+    GFX_GL_ENTRY( NormalP3uiv ) \
+    GFX_GL_ENTRY( ColorP3ui ) \
+    GFX_GL_ENTRY( ColorP3uiv ) \
+    GFX_GL_ENTRY( ColorP4ui ) \
+    GFX_GL_ENTRY( ColorP4uiv ) \
+    GFX_GL_ENTRY( SecondaryColorP3ui ) \
+    GFX_GL_ENTRY( SecondaryColorP3uiv ) \
+    GFX_GL_ENTRY( VertexAttribP1ui ) \
+    GFX_GL_ENTRY( VertexAttribP1uiv ) \
+    GFX_GL_ENTRY( VertexAttribP2ui ) \
+    GFX_GL_ENTRY( VertexAttribP2uiv ) \
+    GFX_GL_ENTRY( VertexAttribP3ui ) \
+    GFX_GL_ENTRY( VertexAttribP3uiv ) \
+    GFX_GL_ENTRY( VertexAttribP4ui ) \
+    GFX_GL_ENTRY( VertexAttribP4uiv ) \
+    /* ARB_blend_func_extended */ \
+    GFX_GL_ENTRY( BindFragDataLocationIndexed ) \
+    GFX_GL_ENTRY( GetFragDataIndex ) \
+    /* ARB_sampler_objects */ \
+    GFX_GL_ENTRY( GenSamplers ) \
+    GFX_GL_ENTRY( DeleteSamplers ) \
+    GFX_GL_ENTRY( IsSampler ) \
+    GFX_GL_ENTRY( BindSampler ) \
+    GFX_GL_ENTRY( SamplerParameteri ) \
+    GFX_GL_ENTRY( SamplerParameteriv ) \
+    GFX_GL_ENTRY( SamplerParameterf ) \
+    GFX_GL_ENTRY( SamplerParameterfv ) \
+    GFX_GL_ENTRY( SamplerParameterIiv ) \
+    GFX_GL_ENTRY( SamplerParameterIuiv ) \
+    GFX_GL_ENTRY( GetSamplerParameteriv ) \
+    GFX_GL_ENTRY( GetSamplerParameterIiv ) \
+    GFX_GL_ENTRY( GetSamplerParameterfv ) \
+    GFX_GL_ENTRY( GetSamplerParameterIuiv ) \
+    /* 3.3 */ \
+    GFX_GL_ENTRY( VertexAttribDivisor ) \
+    /* ARB_get_program_binary */ \
+    GFX_GL_ENTRY( GetProgramBinary ) \
+    GFX_GL_ENTRY( ProgramBinary ) \
+    GFX_GL_ENTRY( ProgramParameteri ) \
+    /* KHR_parallel_shader_compile */ \
+    GFX_GL_ENTRY( MaxShaderCompilerThreadsKHR ) \
+    /* KHR_debug */ \
+    GFX_GL_ENTRY( DebugMessageControl ) \
+    GFX_GL_ENTRY( DebugMessageInsert ) \
+    GFX_GL_ENTRY( DebugMessageCallback )
+
+#endif
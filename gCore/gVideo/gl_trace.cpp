@@ -0,0 +1,269 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+#include "gl_trace.hpp"
+
+namespace gfx {
+    namespace {
+        /*
+         * One message. The sequence number says whose turn the slot is:
+         * it equals the position a producer may claim, or one past it once
+         * the text is written and the consumer may take it.
+         */
+        struct trace_slot {
+            std::atomic<size_t> sequence;
+            char                text[gl_trace::message_bytes];
+        };
+
+        /*
+         * A bounded multi-producer ring. Producers claim positions with a
+         * compare-and-swap on the head; the consumer side is serialized by
+         * a mutex that producers never touch. The flusher thread is joined
+         * when the program exits, after one last drain.
+         */
+        struct trace_ring {
+            trace_slot                  slots[gl_trace::capacity];
+            std::atomic<size_t>         head;
+            size_t                      tail;
+            std::atomic<size_t>         dropped;
+            std::atomic<std::ostream*>  sink;
+            std::mutex                  drain_lock;
+            std::atomic<bool>           flusher_started;
+            std::atomic<bool>           running;
+            std::thread                 flusher;
+
+            trace_ring() : head ( 0 ), tail ( 0 ), dropped ( 0 ),
+                           sink ( &std::cerr ), flusher_started ( false ),
+                           running ( true )
+            {
+                for ( size_t i = 0; i < gl_trace::capacity; ++i ) {
+                    slots[i].sequence.store( i, std::memory_order_relaxed );
+                }
+            }
+
+            ~trace_ring()
+            {
+                running.store( false );
+                if ( flusher.joinable() ) {
+                    flusher.join();
+                }
+                drain();
+            }
+
+            size_t  drain()
+            {
+                std::lock_guard<std::mutex> guard ( drain_lock );
+                std::ostream& out = *sink.load();
+                size_t taken = 0;
+                for (;;) {
+                    trace_slot& slot = slots[tail % gl_trace::capacity];
+                    if ( slot.sequence.load( std::memory_order_acquire ) != tail + 1 ) {
+                        break;
+                    }
+                    out << slot.text << '\n';
+                    slot.sequence.store( tail + gl_trace::capacity,
+                                         std::memory_order_release );
+                    ++tail;
+                    ++taken;
+                }
+                if ( taken != 0 ) {
+                    out.flush();
+                }
+                return taken;
+            }
+
+            void    start_flusher()
+            {
+                if ( flusher_started.exchange( true ) ) {
+                    return;
+                }
+                flusher = std::thread( [this]() {
+                    while ( running.load() ) {
+                        drain();
+                        std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+                    }
+                } );
+            }
+        };
+
+        trace_ring  trace_messages;
+
+        char const* trace_error_name( GLenum const error )
+        {
+            switch ( error ) {
+            case gl::INVALID_ENUM:                  return "INVALID_ENUM";
+            case gl::INVALID_VALUE:                 return "INVALID_VALUE";
+            case gl::INVALID_OPERATION:             return "INVALID_OPERATION";
+            case gl::OUT_OF_MEMORY:                 return "OUT_OF_MEMORY";
+            case gl::TABLE_TOO_LARGE:               return "TABLE_TOO_LARGE";
+            case gl::INVALID_FRAMEBUFFER_OPERATION: return "INVALID_FRAMEBUFFER_OPERATION";
+            default:                                return "unknown error";
+            }
+        }
+
+        char const* trace_source_name( GLenum const source )
+        {
+            switch ( source ) {
+            case gl::DEBUG_SOURCE_API:              return "api";
+            case gl::DEBUG_SOURCE_WINDOW_SYSTEM:    return "window system";
+            case gl::DEBUG_SOURCE_SHADER_COMPILER:  return "shader compiler";
+            case gl::DEBUG_SOURCE_THIRD_PARTY:      return "third party";
+            case gl::DEBUG_SOURCE_APPLICATION:      return "application";
+            default:                                return "other";
+            }
+        }
+
+        char const* trace_type_name( GLenum const type )
+        {
+            switch ( type ) {
+            case gl::DEBUG_TYPE_ERROR:                  return "error";
+            case gl::DEBUG_TYPE_DEPRECATED_BEHAVIOR:    return "deprecated";
+            case gl::DEBUG_TYPE_UNDEFINED_BEHAVIOR:     return "undefined behavior";
+            case gl::DEBUG_TYPE_PORTABILITY:            return "portability";
+            case gl::DEBUG_TYPE_PERFORMANCE:            return "performance";
+            case gl::DEBUG_TYPE_MARKER:                 return "marker";
+            default:                                    return "other";
+            }
+        }
+
+        char const* trace_severity_name( GLenum const severity )
+        {
+            switch ( severity ) {
+            case gl::DEBUG_SEVERITY_HIGH:   return "high";
+            case gl::DEBUG_SEVERITY_MEDIUM: return "medium";
+            case gl::DEBUG_SEVERITY_LOW:    return "low";
+            default:                        return "note";
+            }
+        }
+
+        /*
+         * May be called on a thread the driver owns, so it only formats
+         * into the stack and posts.
+         */
+        void APIENTRY   trace_debug_callback( GLenum source, GLenum type,
+                                              GLuint id, GLenum severity,
+                                              GLsizei length,
+                                              GLchar const* message,
+                                              GLvoid* user_param )
+        {
+            char text[gl_trace::message_bytes];
+            std::snprintf( text, sizeof( text ), "GL %s %s from %s (%u): %.*s",
+                           trace_severity_name( severity ),
+                           trace_type_name( type ),
+                           trace_source_name( source ),
+                           id,
+                           length < 0 ? int( std::strlen( message ) ) : int( length ),
+                           message );
+            gl_trace::post( text );
+        }
+    }
+
+    /**
+     * \brief Hook tracing up to the active \ref gfx::context "context".
+     *
+     * At level 1 this installs the KHR_debug callback, leaving out
+     * notifications, if the driver has the extension; at level 2 it only
+     * starts the flusher. Contexts call this themselves when they are made.
+     */
+    void    gl_trace::attach()
+    {
+        if ( compiled_level == trace_off ) {
+            return;
+        }
+        trace_messages.start_flusher();
+        if ( compiled_level != trace_callback ) {
+            return;
+        }
+        gl::sys::CheckExtensions();
+        if ( not gl::exts::var_KHR_debug ) {
+            post( "GL tracing: KHR_debug is not available; no messages will be reported." );
+            return;
+        }
+        gl::Enable( gl::DEBUG_OUTPUT );
+        gl::DebugMessageCallback( trace_debug_callback, 0 );
+        gl::DebugMessageControl( gl::DONT_CARE, gl::DONT_CARE,
+                                 gl::DEBUG_SEVERITY_NOTIFICATION,
+                                 0, 0, gl::FALSE_ );
+    }
+    /**
+     * \brief Post every pending OpenGL error, tagged with where it was found.
+     *
+     * This waits on the driver; call it through \ref GFX_GL_CHECK so that it
+     * disappears from builds that do not trace synchronously.
+     * \param tag Names the code that ran before the check
+     */
+    void    gl_trace::check( char const* tag )
+    {
+        trace_messages.start_flusher();
+        // A lost context can keep reporting errors, so don't wait on it forever
+        for ( size_t i = 0; i < 8; ++i ) {
+            GLenum error = gl::GetError();
+            if ( error == gl::NO_ERROR_ ) {
+                return;
+            }
+            char text[message_bytes];
+            std::snprintf( text, sizeof( text ), "GL error %s after %s",
+                           trace_error_name( error ), tag );
+            post( text );
+        }
+    }
+    /**
+     * \brief Add a message to the ring without blocking.
+     *
+     * Text beyond \ref message_bytes is cut off.
+     * \param text The message
+     * \return False if the ring was full and the message was dropped
+     */
+    bool    gl_trace::post( char const* text )
+    {
+        size_t position = trace_messages.head.load( std::memory_order_relaxed );
+        trace_slot* slot = 0;
+        for (;;) {
+            slot = &trace_messages.slots[position % capacity];
+            size_t sequence = slot->sequence.load( std::memory_order_acquire );
+            if ( sequence == position ) {
+                if ( trace_messages.head.compare_exchange_weak( position, position + 1,
+                                                                std::memory_order_relaxed ) ) {
+                    break;
+                }
+            } else if ( sequence < position ) {
+                trace_messages.dropped.fetch_add( 1, std::memory_order_relaxed );
+                return false;
+            } else {
+                position = trace_messages.head.load( std::memory_order_relaxed );
+            }
+        }
+        std::strncpy( slot->text, text, message_bytes - 1 );
+        slot->text[message_bytes - 1] = '\0';
+        slot->sequence.store( position + 1, std::memory_order_release );
+        return true;
+    }
+    /**
+     * \brief Set the stream messages are flushed to; std::cerr until then.
+     *
+     * Pending messages go to the old stream first. The stream has to
+     * outlive tracing, or be replaced before it is destroyed.
+     * \param out The stream to write to
+     */
+    void    gl_trace::sink( std::ostream& out )
+    {
+        trace_messages.drain();
+        std::lock_guard<std::mutex> guard ( trace_messages.drain_lock );
+        trace_messages.sink.store( &out );
+    }
+    /**
+     * \brief Write every message in the ring to the sink now.
+     * \return How many messages were written
+     */
+    size_t  gl_trace::flush()
+    { return trace_messages.drain(); }
+    /**
+     * \brief Return how many messages were lost to a full ring.
+     */
+    size_t  gl_trace::dropped()
+    { return trace_messages.dropped.load(); }
+}
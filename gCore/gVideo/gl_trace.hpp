@@ -0,0 +1,84 @@
+#ifndef GL_TRACE_HPP
+#define GL_TRACE_HPP
+
+#include <cstddef>
+#include <iostream>
+
+#include "gl_core_3_3.hpp"
+
+/**
+ * \def GFX_GL_TRACE
+ * \brief How OpenGL errors are looked for, fixed when the code is compiled.
+ *
+ * 0 turns tracing off and every \ref GFX_GL_CHECK compiles to nothing. 1
+ * asks for a debug context and has the driver report errors, warnings and
+ * performance hints through a KHR_debug callback, without stalling the
+ * render thread. 2 calls gl::GetError() at every \ref GFX_GL_CHECK, which
+ * pins an error to the call that caused it but waits on the driver each
+ * time. Builds with DEBUG defined default to 2, everything else to 0.
+ */
+#ifndef GFX_GL_TRACE
+#ifdef DEBUG
+#define GFX_GL_TRACE 2
+#else
+#define GFX_GL_TRACE 0
+#endif
+#endif
+
+/**
+ * \def GFX_GL_CHECK( tag )
+ * \brief Report any pending OpenGL errors, naming the code that just ran.
+ *
+ * Only does anything when \ref GFX_GL_TRACE is 2; otherwise the tag is not
+ * even evaluated.
+ */
+#if GFX_GL_TRACE == 2
+#define GFX_GL_CHECK( tag ) ::gfx::gl_trace::check( tag )
+#else
+#define GFX_GL_CHECK( tag ) ((void) 0)
+#endif
+
+namespace gfx {
+    /**
+     * \class gfx::gl_trace gl_trace.hpp "gCore/gVideo/gl_trace.hpp"
+     * \brief Collects OpenGL errors and debug messages without writing to
+     * a stream on the thread that found them.
+     *
+     * Messages go into a fixed ring of slots. Posting one never takes a
+     * lock or allocates, so it is safe from the render thread, worker
+     * threads and a driver's debug callback alike; when the ring is full
+     * the message is counted as dropped instead. A background thread
+     * empties the ring into the \ref sink() "sink" every few milliseconds,
+     * and \ref flush() "flush()" empties it at once.
+     *
+     * Which messages arrive is set by \ref GFX_GL_TRACE. Every
+     * \ref gfx::context "context" calls \ref attach() "attach()" when it
+     * is made, which installs the debug callback at level 1 if the driver
+     * offers KHR_debug.
+     */
+    class gl_trace {
+    public:
+        /**
+         * \brief The tracing levels \ref GFX_GL_TRACE chooses between.
+         */
+        enum level {
+            trace_off = 0,
+            trace_callback = 1,
+            trace_synchronous = 2
+        };
+        static level const  compiled_level = level( GFX_GL_TRACE );
+        static size_t const capacity = 1024;
+        static size_t const message_bytes = 248;
+
+        static void         attach();
+        static void         check( char const* tag );
+        static bool         post( char const* text );
+        static void         sink( std::ostream& out );
+        static size_t       flush();
+        static size_t       dropped();
+    private:
+                            gl_trace();
+    };
+}
+
+#endif
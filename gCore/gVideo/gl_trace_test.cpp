@@ -0,0 +1,90 @@
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../UnitTest++_src/UnitTest++.h"
+
+#include "video.hpp"
+
+using namespace gfx;
+
+SUITE( GLTraceTests )
+{
+    // Runs first: nothing has started the flusher yet, so the ring only
+    // empties when told to
+    TEST( FullRingDropsMessages )
+    {
+        std::ostringstream out;
+        gl_trace::sink( out );
+        size_t const before = gl_trace::dropped();
+        for ( size_t i = 0; i < gl_trace::capacity + 10; ++i ) {
+            gl_trace::post( "filler" );
+        }
+        CHECK_EQUAL( 10u, gl_trace::dropped() - before );
+        CHECK_EQUAL( size_t( gl_trace::capacity ), gl_trace::flush() );
+        CHECK( gl_trace::post( "room again" ) );
+        CHECK_EQUAL( 1u, gl_trace::flush() );
+        gl_trace::sink( std::cerr );
+    }
+
+    TEST( LongMessagesAreCut )
+    {
+        std::ostringstream out;
+        gl_trace::sink( out );
+        std::string const text ( 2 * gl_trace::message_bytes, 'x' );
+        gl_trace::post( text.c_str() );
+        gl_trace::flush();
+        CHECK_EQUAL( size_t( gl_trace::message_bytes ), out.str().size() );
+        gl_trace::sink( std::cerr );
+    }
+
+    TEST( CheckReportsErrors )
+    {
+        gl_backend::use_null();
+        context test_cntx ( ( context::settings() ) );
+        std::ostringstream out;
+        gl_trace::sink( out );
+
+        gl_trace::check( "nothing wrong" );
+        gl::BindBuffer( gl::ARRAY_BUFFER, 12345 );
+        gl_trace::check( "bad bind" );
+        gl_trace::flush();
+        CHECK_EQUAL( "GL error INVALID_OPERATION after bad bind\n", out.str() );
+        gl_trace::sink( std::cerr );
+    }
+
+    TEST( ManyProducers )
+    {
+        std::ostringstream out;
+        gl_trace::sink( out );
+        size_t const before = gl_trace::dropped();
+        std::vector<std::thread> producers;
+        for ( size_t t = 0; t < 4; ++t ) {
+            producers.push_back( std::thread( []() {
+                for ( size_t i = 0; i < 200; ++i ) {
+                    gl_trace::post( "worker" );
+                }
+            } ) );
+        }
+        for ( size_t t = 0; t < producers.size(); ++t ) {
+            producers[t].join();
+        }
+        gl_trace::flush();
+        gl_trace::sink( std::cerr );
+
+        std::istringstream lines ( out.str() );
+        std::string line;
+        size_t count = 0;
+        while ( std::getline( lines, line ) ) {
+            CHECK_EQUAL( "worker", line );
+            ++count;
+        }
+        CHECK_EQUAL( 800u, count + gl_trace::dropped() - before );
+    }
+}
+
+int main( int argc, char* argv[] )
+{
+    return UnitTest::RunAllTests();
+}
@@ -399,7 +399,7 @@ SUITE( GLSLShadingTests )
 //         
 //         texture_1D test_txtr ( texture_1D::settings()
 //                                .file( "./tex/test_1D.png" )
-//                                .unsigned_norm_3( eight_bit, b, g, r ) );
+//                                .unsigned_norm_3( eight_bit ) );
 //         test_txtr.decode_file();
 //         test_txtr.load_data();
 //         
@@ -469,7 +469,7 @@ SUITE( GLSLShadingTests )
         
         texture_2D test_txtr ( texture_2D::settings()
                                .file( "./tex/test_2D.png" )
-                               .unsigned_norm_3( eight_bit, b, g, r )
+                               .unsigned_norm_3( eight_bit )
                                .sample_magnification( linear ) );
         test_txtr.decode_file();
         test_txtr.load_data();
@@ -7,4 +7,6 @@
 
 #include "window.cpp"
 #include "context.cpp"
-#include "video_system.cpp"
\ No newline at end of file
+#include "video_system.cpp"
+#include "gl_backend.cpp"
+#include "gl_trace.cpp"
\ No newline at end of file
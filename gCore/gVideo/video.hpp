@@ -9,6 +9,8 @@
 #include "checkError.hpp"
 #include "SDL.h"
 #include "gl_core_3_3.hpp"
+#include "gl_backend.hpp"
+#include "gl_trace.hpp"
 #include "../gUtility/datatypeinfo.hpp"
 #include "../gMath/datatype.hpp"
 
@@ -14,11 +14,19 @@ namespace gfx {
      * and OpenGL with the desired settings. The
      * \ref gfx::video_system:settings "settings" object default construtor is
      * called if no argument is given, and so the default settings are version
-     * 1.4 of OpenGl using the core profile.
+     * 1.4 of OpenGl using the core profile. With the \ref gfx::gl_backend
+     * "null backend" in use, only the version is recorded and SDL is not
+     * initialized, so no display is needed.
      * @param set The video system settings; defaults to version 1.4 using core profile
      */
     video_system&  video_system::initialize( video_system::settings const& set )
     {
+        if ( gl_backend::active() == gl_backend::null_backend ) {
+            video_system::instance->vid_ver = version( set.maj_ver_v,
+                                                        set.min_ver_v,
+                                                        set.sub_ver_v );
+            return *video_system::instance;
+        }
         if ( not SDL_WasInit( SDL_INIT_VIDEO ) ) {
             if ( SDL_Init( SDL_INIT_VIDEO ) < 0 ) {
                 std::string msg ("Cannot initialize SDL Video subsystem:\n");
@@ -140,7 +148,9 @@ namespace gfx {
      */
     void video_system::activate_context( context& cntx )
     {
-        SDL_GL_MakeCurrent( cntx.target_window->sys_window, cntx.sys_context );
+        if ( cntx.target_window != 0 ) {
+            SDL_GL_MakeCurrent( cntx.target_window->sys_window, cntx.sys_context );
+        }
         active_context = &cntx;
     }    
 }
\ No newline at end of file
@@ -0,0 +1,20 @@
+#version 330
+
+#if defined( COLORED )
+in vec4 color;
+#elif defined( TEXTURED_2D )
+uniform sampler2D smilie;
+in vec2 uv;
+#endif
+layout( location = 0 ) out vec4 color_out;
+
+void main()
+{
+#if defined( COLORED )
+    color_out = color;
+#elif defined( TEXTURED_2D )
+    color_out = vec4( texture( smilie, uv ).rgb, 1.0 );
+#else
+    color_out = vec4( 1.0, 0.0, 1.0, 1.0 );
+#endif
+}
\ No newline at end of file
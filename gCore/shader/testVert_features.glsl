@@ -0,0 +1,20 @@
+#version 330
+
+layout( location = 0 ) in vec2 pos;
+#if defined( COLORED )
+layout( location = 1 ) in vec3 color_in;
+out vec4 color;
+#elif defined( TEXTURED_2D )
+layout( location = 1 ) in vec2 uv_in;
+out vec2 uv;
+#endif
+
+void main()
+{
+    gl_Position = vec4( pos.xy, 0.0, 1.0 );
+#if defined( COLORED )
+    color = vec4( color_in, 1.0 );
+#elif defined( TEXTURED_2D )
+    uv = uv_in;
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,11 @@
+#version 330
+
+uniform float weights[4];
+
+layout( location = 0 ) in vec2 pos;
+
+void main()
+{
+    float scale = weights[0] + weights[1] + weights[2] + weights[3];
+    gl_Position = vec4( scale * pos.xy, 0.0, 1.0 );
+}